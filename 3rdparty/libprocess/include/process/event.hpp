@@ -13,12 +13,15 @@
 #ifndef __PROCESS_EVENT_HPP__
 #define __PROCESS_EVENT_HPP__
 
+#include <stdint.h>
+
 #include <memory> // TODO(benh): Replace shared_ptr with unique_ptr.
 
 #include <process/future.hpp>
 #include <process/http.hpp>
 #include <process/message.hpp>
 #include <process/socket.hpp>
+#include <process/time.hpp>
 
 #include <stout/abort.hpp>
 #include <stout/lambda.hpp>
@@ -81,6 +84,17 @@ struct Event
     }
     return *result;
   }
+
+  // Time at which the event was enqueued on the receiving process
+  // (set by ProcessBase::enqueue); used by the scheduling
+  // instrumentation to compute how long the event waited in the
+  // queue before being served.
+  Time enqueued;
+
+  // Identifier of the sampled dispatch trace this event belongs to,
+  // or 0 if the event is not being traced (see the Tracer in
+  // process.cpp).
+  uint64_t trace = 0;
 };
 
 
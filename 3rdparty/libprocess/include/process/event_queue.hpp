@@ -0,0 +1,288 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_EVENT_QUEUE_HPP__
+#define __PROCESS_EVENT_QUEUE_HPP__
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include <process/event.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/synchronized.hpp>
+
+namespace process {
+
+// A multiple producer single consumer queue of events. Enqueuing is
+// lock free (we use an intrusive linked list where producers push by
+// atomically exchanging the head, see Dmitry Vyukov's non-intrusive
+// MPSC queue for the technique) so that the I/O threads and worker
+// threads delivering events to a busy process don't serialize on a
+// per-process mutex. Only a single thread may consume at a time (in
+// practice the worker thread that is currently resuming the
+// process). Injected events (i.e., events that should be delivered
+// ahead of any regular pending events, which are rare) and the
+// introspection helpers used for metrics and the /__processes__
+// endpoint take a lock, but that lock is never taken while enqueuing
+// a regular event so the hot path remains lock free.
+class EventQueue
+{
+public:
+  EventQueue()
+    : comissioned(true),
+      size(0)
+  {
+    tail = new Node();
+    head.store(tail);
+  }
+
+  ~EventQueue()
+  {
+    // Delete any events that got enqueued after the queue was
+    // decomissioned (see 'enqueue' for how that can happen).
+    Node* node = tail;
+    while (node != nullptr) {
+      Node* next = node->next.load();
+      delete node->event;
+      delete node;
+      node = next;
+    }
+
+    foreach (Event* event, injected) {
+      delete event;
+    }
+  }
+
+  // Enqueues the event, returning false if the queue has been
+  // decomissioned, in which case the caller retains ownership of the
+  // event. If 'inject' is true the event will be dequeued before any
+  // regular pending events.
+  bool enqueue(Event* event, bool inject = false)
+  {
+    if (!comissioned.load()) {
+      return false;
+    }
+
+    if (inject) {
+      synchronized (mutex) {
+        injected.push_back(event);
+      }
+    } else {
+      Node* node = new Node(event);
+
+      // Exchange the head and then link the previous head to us. In
+      // between these two steps the queue is in a transient state
+      // where the consumer cannot reach this (or a subsequent) node;
+      // 'dequeue' may return nullptr even though 'empty' returns
+      // false, and the consumer is expected to retry (see
+      // ProcessManager::resume).
+      Node* prev = head.exchange(node);
+      prev->next.store(node);
+    }
+
+    // NOTE: the size is incremented after the event is visible to
+    // the consumer so that once a producer observes the process as
+    // blocked (see ProcessBase::enqueue) the consumer is guaranteed
+    // to observe a non-empty queue, and vice versa.
+    size.fetch_add(1);
+
+    return true;
+  }
+
+  // Returns the next event, or nullptr if there is no event ready to
+  // be dequeued. NOTE: nullptr does not imply the queue is empty
+  // since a producer might be in the middle of enqueuing; use 'empty'
+  // to determine emptiness.
+  Event* dequeue()
+  {
+    synchronized (mutex) {
+      if (!injected.empty()) {
+        Event* event = injected.front();
+        injected.pop_front();
+        size.fetch_sub(1);
+        return event;
+      }
+
+      Node* node = tail->next.load();
+
+      if (node == nullptr) {
+        return nullptr;
+      }
+
+      // The old tail is always a consumed (or stub) node, so it's
+      // safe to delete it and make the dequeued node the new stub.
+      Event* event = node->event;
+      node->event = nullptr;
+
+      delete tail;
+      tail = node;
+
+      size.fetch_sub(1);
+
+      return event;
+    }
+  }
+
+  // Dequeues up to 'max' events in a single critical section,
+  // appending them to 'events' and returning the number of events
+  // dequeued. This amortizes the consume side synchronization when a
+  // busy process has many pending events. As with 'dequeue', a return
+  // of 0 does not imply the queue is empty since a producer might be
+  // in the middle of enqueuing; use 'empty' to determine emptiness.
+  size_t dequeue(std::deque<Event*>* events, size_t max)
+  {
+    size_t dequeued = 0;
+
+    synchronized (mutex) {
+      while (dequeued < max && !injected.empty()) {
+        events->push_back(injected.front());
+        injected.pop_front();
+        dequeued++;
+      }
+
+      while (dequeued < max) {
+        Node* node = tail->next.load();
+
+        if (node == nullptr) {
+          break;
+        }
+
+        events->push_back(node->event);
+        node->event = nullptr;
+
+        delete tail;
+        tail = node;
+
+        dequeued++;
+      }
+
+      if (dequeued > 0) {
+        size.fetch_sub(dequeued);
+      }
+    }
+
+    return dequeued;
+  }
+
+  // Whether or not there are any events. Note that this is precise
+  // even when 'dequeue' is transiently returning nullptr (see above).
+  bool empty() const
+  {
+    return size.load() == 0;
+  }
+
+  // Returns the number of pending events.
+  size_t pending() const
+  {
+    return size.load();
+  }
+
+  // Prevents any further events from being enqueued (enqueue will
+  // return false) and deletes all the pending events. Must only be
+  // called by the consumer. Note that a producer racing with the
+  // decomission may still get an event into the queue; such stray
+  // events get deleted when the queue is destructed.
+  void decomission()
+  {
+    comissioned.store(false);
+
+    while (!empty()) {
+      // Dequeue and delete the pending events. Note that we don't
+      // break on a nullptr return since a producer might be in the
+      // middle of enqueuing (in which case we just spin, the producer
+      // is only ever two stores away from completing).
+      delete dequeue();
+    }
+  }
+
+  // Returns the number of pending events of the specified type.
+  template <typename T>
+  size_t count()
+  {
+    size_t count = 0;
+
+    synchronized (mutex) {
+      foreach (Event* event, injected) {
+        if (event->is<T>()) {
+          count++;
+        }
+      }
+
+      Node* node = tail->next.load();
+      while (node != nullptr) {
+        if (node->event != nullptr && node->event->is<T>()) {
+          count++;
+        }
+        node = node->next.load();
+      }
+    }
+
+    return count;
+  }
+
+  // Invokes the visitor for every pending event. Note that this is
+  // best effort: events that a producer is in the middle of enqueuing
+  // may not be visited.
+  void visit(EventVisitor* visitor)
+  {
+    synchronized (mutex) {
+      foreach (Event* event, injected) {
+        event->visit(visitor);
+      }
+
+      Node* node = tail->next.load();
+      while (node != nullptr) {
+        if (node->event != nullptr) {
+          node->event->visit(visitor);
+        }
+        node = node->next.load();
+      }
+    }
+  }
+
+private:
+  struct Node
+  {
+    explicit Node(Event* _event = nullptr)
+      : event(_event),
+        next(nullptr) {}
+
+    Event* event;
+    std::atomic<Node*> next;
+  };
+
+  // Whether or not the queue is still accepting events.
+  std::atomic<bool> comissioned;
+
+  // Number of pending events (in 'injected' and in the linked list).
+  std::atomic<size_t> size;
+
+  // Producers push by exchanging 'head'; the consumer pops starting
+  // from 'tail' which always points at a stub (already consumed)
+  // node. Only the consumer reads or writes 'tail'.
+  std::atomic<Node*> head;
+  Node* tail;
+
+  // Guards 'injected', the consume side of the linked list, and
+  // queue introspection ('count' and 'visit'); never taken when
+  // enqueuing a regular event.
+  std::mutex mutex;
+
+  // Events that should be delivered ahead of any regular events.
+  std::deque<Event*> injected;
+};
+
+} // namespace process {
+
+#endif // __PROCESS_EVENT_QUEUE_HPP__
@@ -62,6 +62,201 @@ struct wrap;
 template <typename T>
 struct unwrap;
 
+
+// A move only, type erased callable with inline ("small buffer")
+// storage: a callable that fits in the buffer gets stored (and later
+// invoked) in place rather than on the heap. This is what the future
+// machinery stores callbacks in; the capture state of a typical
+// continuation (e.g., a 'then' link, which captures a function and a
+// shared promise) fits in the buffer so registering it does not
+// allocate, unlike with std::function.
+template <typename S>
+class Callback;
+
+
+template <typename R, typename... Args>
+class Callback<R(Args...)>
+{
+public:
+  Callback() : invoke(nullptr), manage(nullptr) {}
+
+  template <
+      typename F,
+      typename = typename std::enable_if<
+          !std::is_same<typename std::decay<F>::type, Callback>::value>::type>
+  /*implicit*/ Callback(F&& f)
+  {
+    typedef typename std::decay<F>::type Functor;
+    typedef Handler<Functor, sizeof(Functor) <= STORAGE_SIZE> H;
+
+    H::construct(&storage, std::forward<F>(f));
+
+    invoke = &H::invoke;
+    manage = &H::manage;
+  }
+
+  Callback(Callback&& that)
+    : invoke(that.invoke),
+      manage(that.manage)
+  {
+    if (manage != nullptr) {
+      manage(&that.storage, &storage);
+    }
+
+    that.invoke = nullptr;
+    that.manage = nullptr;
+  }
+
+  Callback& operator=(Callback&& that)
+  {
+    if (this != &that) {
+      if (manage != nullptr) {
+        manage(&storage, nullptr);
+      }
+
+      invoke = that.invoke;
+      manage = that.manage;
+
+      if (manage != nullptr) {
+        manage(&that.storage, &storage);
+      }
+
+      that.invoke = nullptr;
+      that.manage = nullptr;
+    }
+
+    return *this;
+  }
+
+  Callback(const Callback&) = delete;
+  Callback& operator=(const Callback&) = delete;
+
+  ~Callback()
+  {
+    if (manage != nullptr) {
+      manage(&storage, nullptr);
+    }
+  }
+
+  explicit operator bool() const
+  {
+    return invoke != nullptr;
+  }
+
+  R operator()(Args... args)
+  {
+    return invoke(&storage, std::forward<Args>(args)...);
+  }
+
+private:
+  static constexpr size_t STORAGE_SIZE = 64;
+
+  // Handles the type specific operations on the storage: 'invoke'
+  // calls the callable and 'manage' either relocates it into 'to'
+  // (destroying the source) or, if 'to' is a nullptr, just destroys
+  // it. The 'Inline' specialization holds the callable in the buffer
+  // itself; the fallback holds a pointer to a heap allocated callable.
+  template <typename Functor, bool Inline>
+  struct Handler
+  {
+    template <typename F>
+    static void construct(void* storage, F&& f)
+    {
+      new (storage) Functor(std::forward<F>(f));
+    }
+
+    static R invoke(void* storage, Args&&... args)
+    {
+      return (*static_cast<Functor*>(storage))(std::forward<Args>(args)...);
+    }
+
+    static void manage(void* from, void* to)
+    {
+      if (to != nullptr) {
+        new (to) Functor(std::move(*static_cast<Functor*>(from)));
+      }
+      static_cast<Functor*>(from)->~Functor();
+    }
+  };
+
+  template <typename Functor>
+  struct Handler<Functor, false>
+  {
+    template <typename F>
+    static void construct(void* storage, F&& f)
+    {
+      *static_cast<Functor**>(storage) = new Functor(std::forward<F>(f));
+    }
+
+    static R invoke(void* storage, Args&&... args)
+    {
+      return (**static_cast<Functor**>(storage))(std::forward<Args>(args)...);
+    }
+
+    static void manage(void* from, void* to)
+    {
+      if (to != nullptr) {
+        *static_cast<Functor**>(to) = *static_cast<Functor**>(from);
+      } else {
+        delete *static_cast<Functor**>(from);
+      }
+    }
+  };
+
+  R (*invoke)(void*, Args&&...);
+  void (*manage)(void*, void*);
+
+  typename std::aligned_storage<STORAGE_SIZE>::type storage;
+};
+
+
+// The list of callbacks registered on a future for one kind of event
+// (ready, failed, etc). The common case, at most one callback of each
+// kind (e.g., a future with a single 'then' link), lives inline in
+// the future's data; additional callbacks overflow to the heap.
+template <typename S>
+class Callbacks
+{
+public:
+  template <typename F>
+  void emplace(F&& f)
+  {
+    if (!inlined) {
+      inlined = Callback<S>(std::forward<F>(f));
+    } else {
+      overflow.emplace_back(std::forward<F>(f));
+    }
+  }
+
+  // Invokes all the callbacks in registration order.
+  template <typename... Arguments>
+  void run(Arguments&&... arguments)
+  {
+    if (inlined) {
+      inlined(std::forward<Arguments>(arguments)...);
+    }
+
+    for (size_t i = 0; i < overflow.size(); ++i) {
+      overflow[i](std::forward<Arguments>(arguments)...);
+    }
+  }
+
+  bool empty() const
+  {
+    return !inlined && overflow.empty();
+  }
+
+  void clear()
+  {
+    inlined = Callback<S>();
+    overflow.clear();
+  }
+
+private:
+  Callback<S> inlined;
+  std::vector<Callback<S>> overflow;
+};
+
 } // namespace internal {
 
 
@@ -210,13 +405,122 @@ private:
   struct LessPrefer {};
   struct Prefer : LessPrefer {};
 
+  // The actual registration logic: stores the callback (any callable,
+  // not just a std::function, so that small callables get stored
+  // inline, see internal::Callback) unless the event has already
+  // occurred, in which case the callback runs immediately.
+  template <typename F>
+  const Future<T>& _onDiscard(F&& callback) const
+  {
+    bool run = false;
+
+    synchronized (data->lock) {
+      if (data->discard) {
+        run = true;
+      } else if (data->state == PENDING) {
+        data->onDiscardCallbacks.emplace(std::forward<F>(callback));
+      }
+    }
+
+    // TODO(*): Invoke callback in another execution context.
+    if (run) {
+      callback();
+    }
+
+    return *this;
+  }
+
+  template <typename F>
+  const Future<T>& _onReady(F&& callback) const
+  {
+    bool run = false;
+
+    synchronized (data->lock) {
+      if (data->state == READY) {
+        run = true;
+      } else if (data->state == PENDING) {
+        data->onReadyCallbacks.emplace(std::forward<F>(callback));
+      }
+    }
+
+    // TODO(*): Invoke callback in another execution context.
+    if (run) {
+      callback(data->result.get());
+    }
+
+    return *this;
+  }
+
+  template <typename F>
+  const Future<T>& _onFailed(F&& callback) const
+  {
+    bool run = false;
+
+    synchronized (data->lock) {
+      if (data->state == FAILED) {
+        run = true;
+      } else if (data->state == PENDING) {
+        data->onFailedCallbacks.emplace(std::forward<F>(callback));
+      }
+    }
+
+    // TODO(*): Invoke callback in another execution context.
+    if (run) {
+      callback(data->result.error());
+    }
+
+    return *this;
+  }
+
+  template <typename F>
+  const Future<T>& _onDiscarded(F&& callback) const
+  {
+    bool run = false;
+
+    synchronized (data->lock) {
+      if (data->state == DISCARDED) {
+        run = true;
+      } else if (data->state == PENDING) {
+        data->onDiscardedCallbacks.emplace(std::forward<F>(callback));
+      }
+    }
+
+    // TODO(*): Invoke callback in another execution context.
+    if (run) {
+      callback();
+    }
+
+    return *this;
+  }
+
+  template <typename F>
+  const Future<T>& _onAny(F&& callback) const
+  {
+    bool run = false;
+
+    synchronized (data->lock) {
+      if (data->state == PENDING) {
+        data->onAnyCallbacks.emplace(std::forward<F>(callback));
+      } else {
+        run = true;
+      }
+    }
+
+    // TODO(*): Invoke callback in another execution context.
+    if (run) {
+      callback(*this);
+    }
+
+    return *this;
+  }
+
   template <typename F, typename = typename result_of<F(const T&)>::type>
   const Future<T>& onReady(F&& f, Prefer) const
   {
-    return onReady(std::function<void(const T&)>(
+    return _onReady(
         [=](const T& t) mutable {
           f(t);
-        }));
+        });
   }
 
   // This is the less prefered `onReady`, we prefer the `onReady` method which
@@ -234,19 +538,19 @@ private:
           F>::type()>::type>
   const Future<T>& onReady(F&& f, LessPrefer) const
   {
-    return onReady(std::function<void(const T&)>(
+    return _onReady(
         [=](const T&) mutable {
           f();
-        }));
+        });
   }
 
   template <typename F, typename = typename result_of<F(const std::string&)>::type> // NOLINT(whitespace/line_length)
   const Future<T>& onFailed(F&& f, Prefer) const
   {
-    return onFailed(std::function<void(const std::string&)>(
+    return _onFailed(
         [=](const std::string& message) mutable {
           f(message);
-        }));
+        });
   }
 
   // Refer to the less preferred version of `onReady` for why these SFINAE
@@ -258,19 +562,19 @@ private:
           F>::type()>::type>
   const Future<T>& onFailed(F&& f, LessPrefer) const
   {
-    return onFailed(std::function<void(const std::string&)>(
+    return _onFailed(
         [=](const std::string&) mutable {
           f();
-        }));
+        });
   }
 
   template <typename F, typename = typename result_of<F(const Future<T>&)>::type> // NOLINT(whitespace/line_length)
   const Future<T>& onAny(F&& f, Prefer) const
   {
-    return onAny(std::function<void(const Future<T>&)>(
+    return _onAny(
         [=](const Future<T>& future) mutable {
           f(future);
-        }));
+        });
   }
 
   // Refer to the less preferred version of `onReady` for why these SFINAE
@@ -282,20 +586,20 @@ private:
           F>::type()>::type>
   const Future<T>& onAny(F&& f, LessPrefer) const
   {
-    return onAny(std::function<void(const Future<T>&)>(
+    return _onAny(
         [=](const Future<T>&) mutable {
           f();
-        }));
+        });
   }
 
 public:
   template <typename F>
   const Future<T>& onDiscard(F&& f) const
   {
-    return onDiscard(std::function<void()>(
+    return _onDiscard(
         [=]() mutable {
           f();
-        }));
+        });
   }
 
   template <typename F>
@@ -313,10 +617,10 @@ public:
   template <typename F>
   const Future<T>& onDiscarded(F&& f) const
   {
-    return onDiscarded(std::function<void()>(
+    return _onDiscarded(
         [=]() mutable {
           f();
-        }));
+        });
   }
 
   template <typename F>
@@ -451,11 +755,11 @@ private:
     //   3. Error, the state is FAILED; 'error()' stores the message.
     Result<T> result;
 
-    std::vector<DiscardCallback> onDiscardCallbacks;
-    std::vector<ReadyCallback> onReadyCallbacks;
-    std::vector<FailedCallback> onFailedCallbacks;
-    std::vector<DiscardedCallback> onDiscardedCallbacks;
-    std::vector<AnyCallback> onAnyCallbacks;
+    internal::Callbacks<void()> onDiscardCallbacks;
+    internal::Callbacks<void(const T&)> onReadyCallbacks;
+    internal::Callbacks<void(const std::string&)> onFailedCallbacks;
+    internal::Callbacks<void()> onDiscardedCallbacks;
+    internal::Callbacks<void(const Future<T>&)> onAnyCallbacks;
   };
 
   // Sets the value for this future, unless the future is already set,
@@ -474,22 +778,6 @@ private:
 };
 
 
-namespace internal {
-
-// Helper for executing callbacks that have been registered.
-//
-// TODO(*): Invoke callbacks in another execution context.
-template <typename C, typename... Arguments>
-void run(const std::vector<C>& callbacks, Arguments&&... arguments)
-{
-  for (size_t i = 0; i < callbacks.size(); ++i) {
-    callbacks[i](std::forward<Arguments>(arguments)...);
-  }
-}
-
-} // namespace internal {
-
-
 // Represents a weak reference to a future. This class is used to
 // break cyclic dependencies between futures.
 template <typename T>
@@ -859,8 +1147,8 @@ bool Promise<T>::discard(Future<T> future)
   // DISCARDED. We don't need a lock because the state is now in
   // DISCARDED so there should not be any concurrent modifications.
   if (result) {
-    internal::run(future.data->onDiscardedCallbacks);
-    internal::run(future.data->onAnyCallbacks, future);
+    future.data->onDiscardedCallbacks.run();
+    future.data->onAnyCallbacks.run(future);
 
     future.data->clearAllCallbacks();
   }
@@ -985,20 +1273,20 @@ bool Future<T>::discard()
 {
   bool result = false;
 
-  std::vector<DiscardCallback> callbacks;
+  internal::Callbacks<void()> callbacks;
   synchronized (data->lock) {
     if (!data->discard && data->state == PENDING) {
       result = data->discard = true;
 
-      // NOTE: We make a copy of the onDiscard callbacks here
-      // because it is possible that another thread completes this
-      // future (ready, failed or discarded) when the current thread
-      // is out of this critical section but *before* it executed the
-      // onDiscard callbacks. If that happens, the other thread might
-      // be clearing the onDiscard callbacks (via clearAllCallbacks())
+      // NOTE: We move the onDiscard callbacks out here because it is
+      // possible that another thread completes this future (ready,
+      // failed or discarded) when the current thread is out of this
+      // critical section but *before* it executed the onDiscard
+      // callbacks. If that happens, the other thread might be
+      // clearing the onDiscard callbacks (via clearAllCallbacks())
       // while the current thread is executing or clearing the
       // onDiscard callbacks, causing thread safety issue.
-      callbacks = data->onDiscardCallbacks;
+      callbacks = std::move(data->onDiscardCallbacks);
       data->onDiscardCallbacks.clear();
     }
   }
@@ -1008,7 +1296,7 @@ bool Future<T>::discard()
   // be set so we won't be adding anything else to
   // 'Data::onDiscardCallbacks'.
   if (result) {
-    internal::run(callbacks);
+    callbacks.run();
   }
 
   return result;
@@ -1082,7 +1370,7 @@ bool Future<T>::await(const Duration& duration) const
   synchronized (data->lock) {
     if (data->state == PENDING) {
       pending = true;
-      data->onAnyCallbacks.push_back(lambda::bind(&internal::awaited, latch));
+      data->onAnyCallbacks.emplace(lambda::bind(&internal::awaited, latch));
     }
   }
 
@@ -1135,110 +1423,35 @@ const std::string& Future<T>::failure() const
 template <typename T>
 const Future<T>& Future<T>::onDiscard(DiscardCallback&& callback) const
 {
-  bool run = false;
-
-  synchronized (data->lock) {
-    if (data->discard) {
-      run = true;
-    } else if (data->state == PENDING) {
-      data->onDiscardCallbacks.emplace_back(std::move(callback));
-    }
-  }
-
-  // TODO(*): Invoke callback in another execution context.
-  if (run) {
-    callback();
-  }
-
-  return *this;
+  return _onDiscard(std::move(callback));
 }
 
 
 template <typename T>
 const Future<T>& Future<T>::onReady(ReadyCallback&& callback) const
 {
-  bool run = false;
-
-  synchronized (data->lock) {
-    if (data->state == READY) {
-      run = true;
-    } else if (data->state == PENDING) {
-      data->onReadyCallbacks.emplace_back(std::move(callback));
-    }
-  }
-
-  // TODO(*): Invoke callback in another execution context.
-  if (run) {
-    callback(data->result.get());
-  }
-
-  return *this;
+  return _onReady(std::move(callback));
 }
 
 
 template <typename T>
 const Future<T>& Future<T>::onFailed(FailedCallback&& callback) const
 {
-  bool run = false;
-
-  synchronized (data->lock) {
-    if (data->state == FAILED) {
-      run = true;
-    } else if (data->state == PENDING) {
-      data->onFailedCallbacks.emplace_back(std::move(callback));
-    }
-  }
-
-  // TODO(*): Invoke callback in another execution context.
-  if (run) {
-    callback(data->result.error());
-  }
-
-  return *this;
+  return _onFailed(std::move(callback));
 }
 
 
 template <typename T>
 const Future<T>& Future<T>::onDiscarded(DiscardedCallback&& callback) const
 {
-  bool run = false;
-
-  synchronized (data->lock) {
-    if (data->state == DISCARDED) {
-      run = true;
-    } else if (data->state == PENDING) {
-      data->onDiscardedCallbacks.emplace_back(std::move(callback));
-    }
-  }
-
-  // TODO(*): Invoke callback in another execution context.
-  if (run) {
-    callback();
-  }
-
-  return *this;
+  return _onDiscarded(std::move(callback));
 }
 
 
 template <typename T>
 const Future<T>& Future<T>::onAny(AnyCallback&& callback) const
 {
-  bool run = false;
-
-  synchronized (data->lock) {
-    if (data->state == PENDING) {
-      data->onAnyCallbacks.emplace_back(std::move(callback));
-    } else {
-      run = true;
-    }
-  }
-
-  // TODO(*): Invoke callback in another execution context.
-  if (run) {
-    callback(*this);
-  }
-
-  return *this;
+  return _onAny(std::move(callback));
 }
 
 namespace internal {
@@ -1342,10 +1555,7 @@ Future<X> Future<T>::then(const lambda::function<Future<X>(const T&)>& f) const
 {
   std::shared_ptr<Promise<X>> promise(new Promise<X>());
 
-  lambda::function<void(const Future<T>&)> thenf =
-    lambda::bind(&internal::thenf<T, X>, f, promise, lambda::_1);
-
-  onAny(thenf);
+  _onAny(lambda::bind(&internal::thenf<T, X>, f, promise, lambda::_1));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
@@ -1362,10 +1572,7 @@ Future<X> Future<T>::then(const lambda::function<X(const T&)>& f) const
 {
   std::shared_ptr<Promise<X>> promise(new Promise<X>());
 
-  lambda::function<void(const Future<T>&)> then =
-    lambda::bind(&internal::then<T, X>, f, promise, lambda::_1);
-
-  onAny(then);
+  _onAny(lambda::bind(&internal::then<T, X>, f, promise, lambda::_1));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
@@ -1382,7 +1589,7 @@ Future<T> Future<T>::repair(
 {
   std::shared_ptr<Promise<T>> promise(new Promise<T>());
 
-  onAny(lambda::bind(&internal::repair<T>, f, promise, lambda::_1));
+  _onAny(lambda::bind(&internal::repair<T>, f, promise, lambda::_1));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
@@ -1412,7 +1619,7 @@ Future<T> Future<T>::after(
       duration,
       lambda::bind(&internal::expired<T>, f, latch, promise, *this));
 
-  onAny(lambda::bind(&internal::after<T>, latch, promise, timer, lambda::_1));
+  _onAny(lambda::bind(&internal::after<T>, latch, promise, timer, lambda::_1));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
@@ -1455,8 +1662,8 @@ bool Future<T>::_set(U&& u)
   // don't need a lock because the state is now in READY so there
   // should not be any concurrent modifications.
   if (result) {
-    internal::run(data->onReadyCallbacks, data->result.get());
-    internal::run(data->onAnyCallbacks, *this);
+    data->onReadyCallbacks.run(data->result.get());
+    data->onAnyCallbacks.run(*this);
 
     data->clearAllCallbacks();
   }
@@ -1482,8 +1689,8 @@ bool Future<T>::fail(const std::string& _message)
   // don't need a lock because the state is now in FAILED so there
   // should not be any concurrent modifications.
   if (result) {
-    internal::run(data->onFailedCallbacks, data->result.error());
-    internal::run(data->onAnyCallbacks, *this);
+    data->onFailedCallbacks.run(data->result.error());
+    data->onAnyCallbacks.run(*this);
 
     data->clearAllCallbacks();
   }
@@ -387,6 +387,11 @@ public:
     // if the write-end of the pipe was already closed or failed.
     bool fail(const std::string& message);
 
+    // Returns the number of written bytes that the reader has not
+    // yet consumed, which is useful for detecting slow readers and
+    // bounding the memory buffered by the pipe.
+    size_t outstanding() const;
+
     // Returns Nothing when the read-end of the pipe is closed
     // before the write-end is closed, which means the reader
     // was unable to continue reading!
@@ -423,7 +428,8 @@ private:
   {
     Data()
       : readEnd(Reader::OPEN),
-        writeEnd(Writer::OPEN) {}
+        writeEnd(Writer::OPEN),
+        writesSize(0) {}
 
     // Rather than use a process to serialize access to the pipe's
     // internal data we use a 'std::atomic_flag'.
@@ -439,6 +445,9 @@ private:
     // empty strings as they serve as a signal for end-of-file.
     std::queue<std::string> writes;
 
+    // Total size of the unread writes in the pipe.
+    size_t writesSize;
+
     // Signals when the read-end is closed before the write-end.
     Promise<Nothing> readerClosure;
 
@@ -544,6 +553,18 @@ struct Accepted : Response
 };
 
 
+struct NotModified : Response
+{
+  NotModified() : Response(Status::NOT_MODIFIED) {}
+
+  explicit NotModified(const std::string& etag)
+    : Response(Status::NOT_MODIFIED)
+  {
+    headers["ETag"] = etag;
+  }
+};
+
+
 struct TemporaryRedirect : Response
 {
   explicit TemporaryRedirect(const std::string& url)
@@ -832,6 +853,47 @@ private:
 Future<Connection> connect(const URL& url);
 
 
+/**
+ * A pool of keep-alive connections.
+ *
+ * Sending a request borrows an idle pooled connection to the server
+ * (keyed by scheme, host and port) or establishes a new one if none
+ * is idle, and returns the connection to the pool once the response
+ * completes, so bursts of requests to the same server don't pay
+ * connection setup per request. Up to 'capacity' idle connections
+ * are kept per server; connections closed by the server are evicted
+ * from the pool. Requests are sent with 'keepAlive' set regardless
+ * of what the caller specified.
+ */
+class ConnectionPool
+{
+public:
+  explicit ConnectionPool(size_t capacity = 4);
+
+  /**
+   * Sends the request to the server identified by 'request.url'. As
+   * with Connection::send, if 'streamedResponse' is set the response
+   * body will be of type 'PIPE'.
+   */
+  Future<Response> send(const Request& request, bool streamedResponse = false);
+
+  /**
+   * Disconnects all the idle pooled connections. Borrowed
+   * connections are disconnected once their response completes.
+   */
+  Future<Nothing> disconnect();
+
+  bool operator==(const ConnectionPool& p) const { return data == p.data; }
+  bool operator!=(const ConnectionPool& p) const { return !(*this == p); }
+
+private:
+  // Forward declaration.
+  struct Data;
+
+  std::shared_ptr<Data> data;
+};
+
+
 // Create a http Request from the specified parameters.
 Request createRequest(
   const UPID& upid,
@@ -13,8 +13,13 @@
 #ifndef __PROCESS_IO_HPP__
 #define __PROCESS_IO_HPP__
 
+#ifndef __WINDOWS__
+#include <sys/uio.h>
+#endif // __WINDOWS__
+
 #include <cstring> // For size_t.
 #include <string>
+#include <vector>
 
 #include <process/future.hpp>
 
@@ -101,6 +106,22 @@ Future<std::string> read(HANDLE fd);
  */
 Future<size_t> write(int fd, const void* data, size_t size);
 
+#ifndef __WINDOWS__
+/**
+ * Performs a single non-blocking vectored write ('writev' semantics)
+ * by polling on the specified file descriptor until data can be be
+ * written. The buffers are written in order and need not outlive the
+ * call (the iovec array is copied).
+ *
+ * The future will become ready when some data is written (may be less
+ * than the total size of the buffers).
+ *
+ * @return The number of bytes written.
+ *     A failure will be returned if an error is detected.
+ */
+Future<size_t> write(int fd, const struct iovec* iov, int iovcnt);
+#endif // __WINDOWS__
+
 
 /**
  * Performs a series of asynchronous writes, until all of data has been
@@ -113,6 +134,20 @@ Future<size_t> write(int fd, const void* data, size_t size);
  */
 Future<Nothing> write(int fd, const std::string& data);
 
+#ifndef __WINDOWS__
+/**
+ * Performs a series of asynchronous vectored writes, until all of the
+ * buffers have been written. Writing the buffers with 'writev'
+ * avoids concatenating them into a single allocation first.
+ *
+ * @return Nothing or a failure if an error occurred.
+ *     A failure will be returned if the file descriptor is bad, or if the
+ *     file descriptor cannot be duplicated, set to close-on-exec,
+ *     or made non-blocking.
+ */
+Future<Nothing> write(int fd, const std::vector<std::string>& data);
+#endif // __WINDOWS__
+
 /**
  * Redirect output from the 'from' file descriptor to the 'to' file
  * descriptor (or /dev/null if 'to' is None).
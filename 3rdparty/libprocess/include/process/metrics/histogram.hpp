@@ -0,0 +1,287 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_METRICS_HISTOGRAM_HPP__
+#define __PROCESS_METRICS_HISTOGRAM_HPP__
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <process/statistics.hpp>
+
+#include <process/metrics/metric.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+namespace metrics {
+
+// Records a distribution of non-negative values in fixed memory, in
+// the style of an HDR histogram: each power of two range ("octave")
+// of values is linearly subdivided into SUBBUCKETS buckets, so a
+// sample lands in a bucket whose width is a bounded fraction
+// (1 / SUBBUCKETS, i.e., ~1.5%) of its value. Recording a sample is
+// a couple of relaxed atomic additions, with no locking and no
+// allocation (cf. the per sample allocation of TimeSeries), and
+// distributions recorded independently (e.g., per thread or per
+// process instance) can be merged.
+class Distribution
+{
+public:
+  Distribution()
+    : count_(0),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(0.0)
+  {
+    for (size_t i = 0; i < BUCKETS; i++) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Records a sample. Thread safe, lock free and allocation free.
+  // Negative values are clamped to 0.
+  void record(double value)
+  {
+    if (isnan(value)) {
+      return;
+    }
+
+    if (value < 0.0) {
+      value = 0.0;
+    }
+
+    counts[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    // Track the exact minimum and maximum (the buckets only bound
+    // the percentiles).
+    double min = min_.load(std::memory_order_relaxed);
+    while (value < min && !min_.compare_exchange_weak(min, value)) {}
+
+    double max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value)) {}
+  }
+
+  // Merges the samples recorded by 'that' into this distribution.
+  void merge(const Distribution& that)
+  {
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+      uint64_t count = that.counts[i].load(std::memory_order_relaxed);
+      if (count > 0) {
+        counts[i].fetch_add(count, std::memory_order_relaxed);
+        total += count;
+      }
+    }
+
+    count_.fetch_add(total, std::memory_order_relaxed);
+
+    double value = that.min_.load(std::memory_order_relaxed);
+    double min = min_.load(std::memory_order_relaxed);
+    while (value < min && !min_.compare_exchange_weak(min, value)) {}
+
+    value = that.max_.load(std::memory_order_relaxed);
+    double max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value)) {}
+  }
+
+  // The number of recorded samples.
+  uint64_t count() const
+  {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the statistics of the recorded samples, or None if there
+  // are none. The percentiles are computed from the bucket midpoints
+  // and are therefore approximate (see above); the count, minimum
+  // and maximum are exact. Concurrent recording can skew the result
+  // by however many samples arrive during the computation.
+  Option<Statistics<double>> statistics() const
+  {
+    std::vector<uint64_t> snapshot(BUCKETS);
+
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+      snapshot[i] = counts[i].load(std::memory_order_relaxed);
+      total += snapshot[i];
+    }
+
+    if (total == 0) {
+      return None();
+    }
+
+    Statistics<double> statistics;
+
+    statistics.count = total;
+
+    statistics.min = min_.load(std::memory_order_relaxed);
+    statistics.max = max_.load(std::memory_order_relaxed);
+
+    statistics.p50 = percentile(snapshot, total, 0.50, statistics);
+    statistics.p90 = percentile(snapshot, total, 0.90, statistics);
+    statistics.p95 = percentile(snapshot, total, 0.95, statistics);
+    statistics.p99 = percentile(snapshot, total, 0.99, statistics);
+    statistics.p999 = percentile(snapshot, total, 0.999, statistics);
+    statistics.p9999 = percentile(snapshot, total, 0.9999, statistics);
+
+    return statistics;
+  }
+
+private:
+  // Each octave gets 64 subbuckets, i.e., a relative bucket width
+  // (and thus percentile error) of ~1.5%. With the exponent range
+  // below the buckets span ~5e-7 to ~9e12 (values outside the range
+  // land in the first/last bucket) using 64 * 64 buckets of 8 bytes:
+  // 32KB per distribution, independent of the recording rate.
+  static constexpr int SUBBUCKET_BITS = 6;
+  static constexpr size_t SUBBUCKETS = 1 << SUBBUCKET_BITS;
+  static constexpr int MIN_EXPONENT = -21;
+  static constexpr int MAX_EXPONENT = 43;
+  static constexpr size_t BUCKETS =
+    (MAX_EXPONENT - MIN_EXPONENT) * SUBBUCKETS;
+
+  // Returns the bucket the value lands in.
+  static size_t bucket(double value)
+  {
+    int exponent = 0;
+    double fraction = frexp(value, &exponent); // In [0.5, 1.0).
+
+    if (fraction == 0.0 || exponent <= MIN_EXPONENT) {
+      return 0;
+    }
+
+    if (exponent > MAX_EXPONENT) {
+      return BUCKETS - 1;
+    }
+
+    const size_t subbucket = (fraction - 0.5) * 2 * SUBBUCKETS;
+
+    return (exponent - MIN_EXPONENT - 1) * SUBBUCKETS + subbucket;
+  }
+
+  // The value at the middle of the bucket.
+  static double midpoint(size_t index)
+  {
+    const int exponent = MIN_EXPONENT + 1 + index / SUBBUCKETS;
+    const size_t subbucket = index % SUBBUCKETS;
+
+    return ldexp(0.5 + (subbucket + 0.5) / (2.0 * SUBBUCKETS), exponent);
+  }
+
+  // Returns the requested percentile (clamped to the exact minimum
+  // and maximum) by walking the cumulative bucket counts.
+  static double percentile(
+      const std::vector<uint64_t>& counts,
+      uint64_t total,
+      double percentile,
+      const Statistics<double>& statistics)
+  {
+    const uint64_t rank = static_cast<uint64_t>(ceil(percentile * total));
+
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+      cumulative += counts[i];
+      if (cumulative >= rank) {
+        return std::min(std::max(midpoint(i), statistics.min),
+                        statistics.max);
+      }
+    }
+
+    return statistics.max;
+  }
+
+  std::atomic<uint64_t> counts[BUCKETS];
+  std::atomic<uint64_t> count_;
+  std::atomic<double> min_;
+  std::atomic<double> max_;
+};
+
+
+// A Metric that exposes the distribution of recorded samples (e.g.,
+// latencies) with bounded, recording rate independent memory: use it
+// instead of a windowed Timer/TimeSeries wherever samples arrive too
+// fast to keep (see Distribution above for the cost model). The
+// metric's value is the most recently recorded sample (as with
+// Timer); the statistics (min/max/percentiles) get exposed the same
+// way as the time series backed ones.
+class Histogram : public Metric
+{
+public:
+  // 'name' is the unique name of this Histogram, used as the key
+  // prefix in the JSON endpoint.
+  explicit Histogram(const std::string& name)
+    : Metric(name, None()), data(new Data()) {}
+
+  virtual ~Histogram() {}
+
+  virtual Future<double> value() const
+  {
+    if (data->distribution.count() == 0) {
+      return Failure("No samples have been recorded yet");
+    }
+
+    return data->last.load(std::memory_order_relaxed);
+  }
+
+  virtual Option<Statistics<double>> statistics() const
+  {
+    return data->distribution.statistics();
+  }
+
+  // Records a sample. Thread safe, lock free and allocation free.
+  void record(double value)
+  {
+    data->last.store(value, std::memory_order_relaxed);
+    data->distribution.record(value);
+  }
+
+  // Records a duration, in the units the histogram was constructed
+  // for.
+  template <typename T>
+  void record(const Duration& duration)
+  {
+    record(T(duration).value());
+  }
+
+  // Merges the samples recorded by 'that' into this histogram.
+  void merge(const Histogram& that)
+  {
+    data->distribution.merge(that.data->distribution);
+  }
+
+private:
+  struct Data
+  {
+    Data() : last(0.0) {}
+
+    Distribution distribution;
+    std::atomic<double> last;
+  };
+
+  std::shared_ptr<Data> data;
+};
+
+} // namespace metrics {
+} // namespace process {
+
+#endif // __PROCESS_METRICS_HISTOGRAM_HPP__
@@ -41,7 +41,9 @@ public:
     return data->name;
   }
 
-  Option<Statistics<double>> statistics() const
+  // NOTE: virtual so that metrics that keep their own sample
+  // representation (e.g., Histogram) can provide their statistics.
+  virtual Option<Statistics<double>> statistics() const
   {
     Option<Statistics<double>> statistics = None();
 
@@ -13,6 +13,9 @@
 #ifndef __PROCESS_METRICS_METRICS_HPP__
 #define __PROCESS_METRICS_METRICS_HPP__
 
+#include <functional>
+#include <list>
+#include <mutex>
 #include <string>
 
 #include <process/dispatch.hpp>
@@ -26,16 +29,22 @@
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
+#include <stout/synchronized.hpp>
 
 namespace process {
 namespace metrics {
 namespace internal {
 
-class MetricsProcess : public Process<MetricsProcess>
+// A sharded registry of the added metrics. The metrics are spread
+// over several individually locked shards (by a hash of their name)
+// so that concurrent registration and removal neither contend on a
+// single lock nor serialize through an actor's event queue, and a
+// snapshot can collect every metric's value without dispatching:
+// only metrics whose value is provided by a process (e.g., Gauge)
+// are then waited on, and those can be bounded with a timeout.
+class Registry
 {
 public:
-  static MetricsProcess* create(const Option<std::string>& authenticationRealm);
-
   Future<Nothing> add(Owned<Metric> metric);
 
   Future<Nothing> remove(const std::string& name);
@@ -43,6 +52,47 @@ public:
   Future<hashmap<std::string, double>> snapshot(
       const Option<Duration>& timeout);
 
+private:
+  static constexpr size_t SHARDS = 16;
+
+  static std::list<Future<double>> _snapshotTimeout(
+      const std::list<Future<double>>& futures);
+
+  static Future<hashmap<std::string, double>> __snapshot(
+      const Option<Duration>& timeout,
+      const hashmap<std::string, Future<double>>& metrics,
+      const hashmap<std::string, Option<Statistics<double>>>& statistics);
+
+  struct Shard
+  {
+    std::mutex mutex;
+
+    // The Owned<Metric> is an explicit copy of the Metric passed to
+    // 'add'.
+    hashmap<std::string, Owned<Metric>> metrics;
+  };
+
+  Shard& shard(const std::string& name)
+  {
+    return shards[std::hash<std::string>()(name) % SHARDS];
+  }
+
+  Shard shards[SHARDS];
+};
+
+
+// Returns the global metrics registry, constructed on first use.
+// NOTE: unlike the MetricsProcess below the registry does not depend
+// on libprocess being initialized, so metrics can be added and
+// removed at any time.
+Registry* registry();
+
+
+class MetricsProcess : public Process<MetricsProcess>
+{
+public:
+  static MetricsProcess* create(const Option<std::string>& authenticationRealm);
+
 protected:
   virtual void initialize();
 
@@ -65,17 +115,6 @@ private:
       const http::Request& request,
       const Option<std::string>& /* principal */);
 
-  static std::list<Future<double>> _snapshotTimeout(
-      const std::list<Future<double>>& futures);
-
-  static Future<hashmap<std::string, double>> __snapshot(
-      const Option<Duration>& timeout,
-      const hashmap<std::string, Future<double>>& metrics,
-      const hashmap<std::string, Option<Statistics<double>>>& statistics);
-
-  // The Owned<Metric> is an explicit copy of the Metric passed to 'add'.
-  hashmap<std::string, Owned<Metric>> metrics;
-
   // Used to rate limit the snapshot endpoint.
   Option<Owned<RateLimiter>> limiter;
 
@@ -93,40 +132,27 @@ extern PID<MetricsProcess> metrics;
 template <typename T>
 Future<Nothing> add(const T& metric)
 {
-  // The metrics process is instantiated in `process::initialize`.
-  process::initialize();
-
   // There is an explicit copy in this call to ensure we end up owning
   // the last copy of a Metric when we remove it.
-  return dispatch(
-      internal::metrics,
-      &internal::MetricsProcess::add,
-      Owned<Metric>(new T(metric)));
+  return internal::registry()->add(Owned<Metric>(new T(metric)));
 }
 
 
 inline Future<Nothing> remove(const Metric& metric)
 {
-  // The metrics process is instantiated in `process::initialize`.
-  process::initialize();
-
-  return dispatch(
-      internal::metrics,
-      &internal::MetricsProcess::remove,
-      metric.name());
+  return internal::registry()->remove(metric.name());
 }
 
 
 inline Future<hashmap<std::string, double>> snapshot(
     const Option<Duration>& timeout)
 {
-  // The metrics process is instantiated in `process::initialize`.
+  // Collecting a snapshot requires libprocess to be initialized
+  // since awaiting the process provided metrics (e.g., Gauge) spawns
+  // a process.
   process::initialize();
 
-  return dispatch(
-      internal::metrics,
-      &internal::MetricsProcess::snapshot,
-      timeout);
+  return internal::registry()->snapshot(timeout);
 }
 
 }  // namespace metrics {
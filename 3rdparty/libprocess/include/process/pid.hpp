@@ -16,6 +16,7 @@
 #include <stdint.h>
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 
 #include <boost/functional/hash.hpp>
@@ -38,6 +39,95 @@ class ProcessBase;
  */
 struct UPID
 {
+  // A shared, immutable process id. The id gets copied into every
+  // message envelope and compared in the socket and process lookup
+  // maps, so rather than a `std::string` (an allocation per copy)
+  // we share one heap string between all copies of a UPID and
+  // compare descriptor pointers before falling back to comparing
+  // characters. Parsed ids are additionally interned (see pid.cpp)
+  // so messages repeatedly arriving from the same sender, e.g.,
+  // `master@ip`, share a single descriptor.
+  struct ID
+  {
+    ID() = default;
+
+    ID(const char* s)
+      : id(std::make_shared<std::string>(s)) {}
+
+    ID(const std::string& s)
+      : id(std::make_shared<std::string>(s)) {}
+
+    ID(std::string&& s)
+      : id(std::make_shared<std::string>(std::move(s))) {}
+
+    ID& operator=(const char* s)
+    {
+      id = std::make_shared<std::string>(s);
+      return *this;
+    }
+
+    ID& operator=(const std::string& s)
+    {
+      id = std::make_shared<std::string>(s);
+      return *this;
+    }
+
+    ID& operator=(std::string&& s)
+    {
+      id = std::make_shared<std::string>(std::move(s));
+      return *this;
+    }
+
+    operator const std::string&() const
+    {
+      static const std::string empty;
+      return id == nullptr ? empty : *id;
+    }
+
+    bool operator==(const ID& that) const
+    {
+      // Interned or copied ids share their descriptor, so most
+      // comparisons never look at the characters.
+      if (id == that.id) {
+        return true;
+      }
+
+      return static_cast<const std::string&>(*this) ==
+             static_cast<const std::string&>(that);
+    }
+
+    bool operator!=(const ID& that) const { return !(*this == that); }
+
+    bool operator<(const ID& that) const
+    {
+      return static_cast<const std::string&>(*this) <
+             static_cast<const std::string&>(that);
+    }
+
+    bool operator==(const std::string& that) const
+    {
+      return static_cast<const std::string&>(*this) == that;
+    }
+
+    bool operator!=(const std::string& that) const
+    {
+      return !(*this == that);
+    }
+
+    bool operator==(const char* that) const
+    {
+      return static_cast<const std::string&>(*this) == that;
+    }
+
+    bool operator!=(const char* that) const
+    {
+      return !(*this == that);
+    }
+
+  private:
+    std::shared_ptr<const std::string> id;
+  };
+
   UPID() = default;
 
   UPID(const UPID& that)
@@ -91,11 +181,56 @@ struct UPID
   {
     return !(*this == that);
   }
-  std::string id;
+  ID id;
   network::Address address;
 };
 
 
+inline std::ostream& operator<<(std::ostream& stream, const UPID::ID& id)
+{
+  return stream << static_cast<const std::string&>(id);
+}
+
+
+inline bool operator==(const std::string& left, const UPID::ID& right)
+{
+  return right == left;
+}
+
+
+inline bool operator!=(const std::string& left, const UPID::ID& right)
+{
+  return right != left;
+}
+
+
+// String concatenation is done by templates on `std::basic_string`
+// which won't consider the implicit conversion from `UPID::ID`, so
+// provide the concatenations call sites use directly.
+inline std::string operator+(const UPID::ID& id, const std::string& s)
+{
+  return static_cast<const std::string&>(id) + s;
+}
+
+
+inline std::string operator+(const UPID::ID& id, const char* s)
+{
+  return static_cast<const std::string&>(id) + s;
+}
+
+
+inline std::string operator+(const std::string& s, const UPID::ID& id)
+{
+  return s + static_cast<const std::string&>(id);
+}
+
+
+inline std::string operator+(const char* s, const UPID::ID& id)
+{
+  return s + static_cast<const std::string&>(id);
+}
+
+
 /**
  * A "process identifier" used to uniquely identify a process when
  * dispatching messages.
@@ -163,7 +298,8 @@ struct hash<process::UPID>
   result_type operator()(const argument_type& upid) const
   {
     size_t seed = 0;
-    boost::hash_combine(seed, upid.id);
+    boost::hash_combine(
+        seed, static_cast<const std::string&>(upid.id));
     boost::hash_combine(seed, std::hash<net::IP>()(upid.address.ip));
     boost::hash_combine(seed, upid.address.port);
     return seed;
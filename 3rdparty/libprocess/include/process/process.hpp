@@ -15,13 +15,16 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <queue>
 #include <vector>
 
 #include <process/address.hpp>
 #include <process/clock.hpp>
 #include <process/event.hpp>
+#include <process/event_queue.hpp>
 #include <process/filter.hpp>
 #include <process/firewall.hpp>
 #include <process/http.hpp>
@@ -128,6 +131,18 @@ protected:
    */
   virtual void lost(const UPID&) {}
 
+  /**
+   * Sets an advisory limit on the number of pending events in this
+   * process's mailbox (0, the default, means unlimited). The limit
+   * is not enforced on enqueue — events are never dropped — but once
+   * it is reached the process is reported as congested (see
+   * 'congested' and 'drained'), which the socket reading code
+   * translates into TCP-level pushback: it stops reading from
+   * sockets whose receiver is congested instead of buffering events
+   * without bound.
+   */
+  void setMailboxLimit(size_t limit);
+
   /**
    * Puts the message at front of this process's message queue.
    *
@@ -150,6 +165,39 @@ protected:
       const char* data = nullptr,
       size_t length = 0);
 
+  /**
+   * Sends the message to the specified `UPID`, taking ownership of
+   * the message name and body.
+   *
+   * This avoids copying the body, which matters for large messages
+   * and in particular when the recipient runs in the same OS process
+   * (e.g., the master and agents under `mesos-local`, or the master
+   * and its allocator): such messages are enqueued directly with the
+   * recipient without ever touching the socket layer, so the copies
+   * are the dominant cost.
+   *
+   * @see process::Message
+   */
+  void send(
+      const UPID& to,
+      std::string&& name,
+      std::string&& data);
+
+  /**
+   * Sends the message to each of the specified `UPID`s.
+   *
+   * The message body is constructed once and copied per recipient,
+   * which is significantly cheaper than re-encoding the message for
+   * each recipient when fanning out to many of them.
+   *
+   * @see process::Message
+   */
+  void send(
+      const std::vector<UPID>& to,
+      const std::string& name,
+      const char* data = nullptr,
+      size_t length = 0);
+
   /**
    * Describes the behavior of the `link` call when the target `pid`
    * points to a remote process. This enum has no effect if the target
@@ -361,14 +409,24 @@ protected:
   template <typename T>
   size_t eventCount()
   {
-    size_t count = 0U;
+    return events.count<T>();
+  }
 
-    synchronized (mutex) {
-      count = std::count_if(events.begin(), events.end(), isEventType<T>);
-    }
+  /**
+   * Whether this process has a mailbox limit and currently has at
+   * least that many pending events (see setMailboxLimit).
+   */
+  bool congested() const;
 
-    return count;
-  }
+  /**
+   * Returns a future that is satisfied once this process is no
+   * longer congested, i.e., its pending events have drained below
+   * half the mailbox limit. Ready immediately if the process is not
+   * congested. Used to implement backpressure: for example, the
+   * socket reading code stops reading from a socket whose receiver
+   * is congested until this future is satisfied.
+   */
+  Future<Nothing> drained();
 
 private:
   friend class SocketManager;
@@ -376,8 +434,13 @@ private:
   friend class ProcessReference;
   friend void* schedule(void*);
 
-  // Process states.
-  enum
+  // Process states. The state is only ever mutated by the consumer
+  // (i.e., the thread currently running the process) except for the
+  // BLOCKED to READY transition which is performed by whichever
+  // producer enqueues an event on a blocked process (see
+  // ProcessBase::enqueue and ProcessManager::resume for how the
+  // transitions are synchronized without holding a lock).
+  enum State
   {
     BOTTOM,
     READY,
@@ -385,17 +448,9 @@ private:
     BLOCKED,
     TERMINATING,
     TERMINATED
-  } state;
-
-  template <typename T>
-  static bool isEventType(const Event* event)
-  {
-    return event->is<T>();
-  }
+  };
 
-  // Mutex protecting internals.
-  // TODO(benh): Consider replacing with a spinlock, on multi-core systems.
-  std::recursive_mutex mutex;
+  std::atomic<State> state;
 
   // Enqueue the specified message, request, or function call.
   void enqueue(Event* event, bool inject = false);
@@ -425,11 +480,35 @@ private:
     Option<AuthenticatedHttpRequestHandler> authenticatedHandler;
   };
 
+  // A node of the trie over the segments of the installed endpoint
+  // paths, used to find the endpoint handling the longest prefix of
+  // a request path in time linear in the path length rather than
+  // doing a lookup in 'handlers.http' per prefix (see
+  // 'visit(const HttpEvent&)').
+  struct RouteNode
+  {
+    // Inserts the endpoint path (with the leading '/' stripped, as
+    // stored in 'handlers.http') into the trie.
+    void insert(const std::string& name);
+
+    // Returns the name of the endpoint handling the longest prefix
+    // of the path, or None if no endpoint matches.
+    Option<std::string> find(const std::string& path) const;
+
+    // The endpoint path this node terminates, if any.
+    Option<std::string> name;
+
+    std::map<std::string, Owned<RouteNode>> children;
+  };
+
   // Handlers for messages and HTTP requests.
   struct {
     std::map<std::string, MessageHandler> message;
     std::map<std::string, HttpEndpoint> http;
 
+    // Trie over the paths in 'http', updated by 'route'.
+    RouteNode routes;
+
     // Used for delivering HTTP requests in the correct order.
     // Initialized lazily to avoid ProcessBase requiring
     // another Process!
@@ -446,8 +525,66 @@ private:
   // Static assets(s) to provide.
   std::map<std::string, Asset> assets;
 
-  // Queue of received events, requires lock()ed access!
-  std::deque<Event*> events;
+  // Queue of received events. Producers (e.g., I/O threads and other
+  // worker threads) enqueue lock free; only the thread resuming this
+  // process consumes.
+  EventQueue events;
+
+  // Mailbox limit (see setMailboxLimit); 0 means unlimited.
+  std::atomic<size_t> mailbox_limit;
+
+  // Backpressure support: promises registered via 'drained' by
+  // parties waiting for the mailbox to drain. 'waiters' lets the
+  // resuming worker thread skip taking the mutex in the common case
+  // of nobody waiting. Satisfies the waiting promises if the mailbox
+  // has drained below half the limit (or unconditionally if 'force'
+  // is true, used when the process terminates).
+  void relieve(bool force = false);
+
+  std::atomic<bool> waiters;
+  std::mutex congestion_mutex;
+  std::vector<Owned<Promise<Nothing>>> congestion_promises;
+
+  // Scheduling instrumentation for this process, exposed via the
+  // /__processes__ endpoint so a backlogged actor can be spotted in
+  // production without attaching a profiler. The queue high-water
+  // mark is updated by producers; everything else by the worker
+  // thread currently resuming this process. Event ages are counted
+  // in buckets by floor(log2(age in microseconds)): a factor of two
+  // resolution, but constant memory per process and lock free to
+  // update.
+  struct Profile
+  {
+    static constexpr size_t AGE_BUCKETS = 32;
+
+    Profile()
+      : served(0),
+        resumes(0),
+        serve_ns(0),
+        queue_peak(0)
+    {
+      for (size_t i = 0; i < AGE_BUCKETS; i++) {
+        ages[i].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    // Number of events served.
+    std::atomic<uint64_t> served;
+
+    // Number of times the process has been resumed.
+    std::atomic<uint64_t> resumes;
+
+    // Total time spent serving events, in nanoseconds.
+    std::atomic<uint64_t> serve_ns;
+
+    // Largest number of events ever pending in the queue.
+    std::atomic<size_t> queue_peak;
+
+    // Bucket i counts served events whose age (time between enqueue
+    // and serve) was in [2^i, 2^(i+1)) microseconds (bucket 0 also
+    // includes sub-microsecond ages).
+    std::atomic<uint64_t> ages[AGE_BUCKETS];
+  } profile;
 
   // Active references.
   std::atomic_long refs;
@@ -13,6 +13,7 @@
 #ifndef __PROCESS_PROFILER_HPP__
 #define __PROCESS_PROFILER_HPP__
 
+#include <map>
 #include <string>
 
 #include <process/future.hpp>
@@ -27,6 +28,7 @@ public:
   Profiler(const Option<std::string>& _authenticationRealm)
     : ProcessBase("profiler"),
       started(false),
+      heapStarted(false),
       authenticationRealm(_authenticationRealm) {}
 
   virtual ~Profiler() {}
@@ -44,6 +46,26 @@ protected:
             authenticationRealm.get(),
             STOP_HELP(),
             &Profiler::stop);
+
+      route("/heap/start",
+            authenticationRealm.get(),
+            HEAP_START_HELP(),
+            &Profiler::heapStart);
+
+      route("/heap/stop",
+            authenticationRealm.get(),
+            HEAP_STOP_HELP(),
+            &Profiler::heapStop);
+
+      route("/heap/profile",
+            authenticationRealm.get(),
+            HEAP_PROFILE_HELP(),
+            &Profiler::heapProfile);
+
+      route("/heap/growth",
+            authenticationRealm.get(),
+            HEAP_GROWTH_HELP(),
+            &Profiler::heapGrowth);
     } else {
       route("/start",
             START_HELP(),
@@ -56,12 +78,40 @@ protected:
             [this](const http::Request& request) {
               return Profiler::stop(request, None());
             });
+
+      route("/heap/start",
+            HEAP_START_HELP(),
+            [this](const http::Request& request) {
+              return Profiler::heapStart(request, None());
+            });
+
+      route("/heap/stop",
+            HEAP_STOP_HELP(),
+            [this](const http::Request& request) {
+              return Profiler::heapStop(request, None());
+            });
+
+      route("/heap/profile",
+            HEAP_PROFILE_HELP(),
+            [this](const http::Request& request) {
+              return Profiler::heapProfile(request, None());
+            });
+
+      route("/heap/growth",
+            HEAP_GROWTH_HELP(),
+            [this](const http::Request& request) {
+              return Profiler::heapGrowth(request, None());
+            });
     }
   }
 
 private:
   static const std::string START_HELP();
   static const std::string STOP_HELP();
+  static const std::string HEAP_START_HELP();
+  static const std::string HEAP_STOP_HELP();
+  static const std::string HEAP_PROFILE_HELP();
+  static const std::string HEAP_GROWTH_HELP();
 
   // HTTP endpoints.
 
@@ -77,7 +127,36 @@ private:
       const http::Request& request,
       const Option<std::string>& /* principal */);
 
+  // Starts the tcmalloc heap profiler. Requires the process to be
+  // running with tcmalloc as its allocator (e.g., via LD_PRELOAD).
+  Future<http::Response> heapStart(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
+  // Stops the tcmalloc heap profiler and returns the final heap
+  // profile, aggregated by allocation site.
+  Future<http::Response> heapStop(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
+  // Returns the current heap profile while the heap profiler is
+  // running, aggregated by allocation site.
+  Future<http::Response> heapProfile(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
+  // Returns the allocation sites whose cumulative allocated bytes
+  // grew since the previous call to this endpoint, largest first.
+  Future<http::Response> heapGrowth(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
   bool started;
+  bool heapStarted;
+
+  // Cumulative allocated bytes per allocation site at the time of the
+  // last call to the heap growth endpoint.
+  std::map<std::string, long long> allocated;
 
   // The authentication realm that the profiler's HTTP endpoints will be
   // installed into.
@@ -111,6 +111,18 @@ protected:
 
   void send(const process::UPID& to,
             const google::protobuf::Message& message)
+  {
+    std::string data;
+    message.SerializeToString(&data);
+    // Move the serialized bytes into the outgoing message rather
+    // than copying them.
+    process::Process<T>::send(to, message.GetTypeName(), std::move(data));
+  }
+
+  // Sends the message to each of the specified pids, serializing the
+  // message once rather than once per recipient.
+  void send(const std::vector<process::UPID>& to,
+            const google::protobuf::Message& message)
   {
     std::string data;
     message.SerializeToString(&data);
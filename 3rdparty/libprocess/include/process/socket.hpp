@@ -15,6 +15,7 @@
 
 #ifndef __WINDOWS__
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #endif // __WINDOWS__
 
@@ -155,6 +156,24 @@ public:
     virtual Future<size_t> send(const char* data, size_t size) = 0;
     virtual Future<size_t> sendfile(int fd, off_t offset, size_t size) = 0;
 
+#ifndef __WINDOWS__
+    /**
+     * An overload of `send` that sends multiple buffers in one go
+     * ("scatter gather"), e.g., a message header followed by its body
+     * without first copying them into a contiguous buffer.
+     *
+     * The default implementation just sends the first buffer (which
+     * is correct since callers must handle partial sends anyway);
+     * implementations that can send all the buffers in a single
+     * system call override this (see `PollSocketImpl`).
+     */
+    virtual Future<size_t> send(const iovec* iov, int iovcnt)
+    {
+      CHECK(iovcnt > 0);
+      return send(static_cast<const char*>(iov[0].iov_base), iov[0].iov_len);
+    }
+#endif // __WINDOWS__
+
     /**
      * An overload of `recv`, which receives data based on the specified
      * 'size' parameter.
@@ -314,6 +333,13 @@ public:
     return impl->send(data, size);
   }
 
+#ifndef __WINDOWS__
+  Future<size_t> send(const iovec* iov, int iovcnt) const
+  {
+    return impl->send(iov, iovcnt);
+  }
+#endif // __WINDOWS__
+
   Future<size_t> sendfile(int fd, off_t offset, size_t size) const
   {
     return impl->sendfile(fd, offset, size);
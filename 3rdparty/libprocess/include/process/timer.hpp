@@ -59,6 +59,7 @@ public:
 
 private:
   friend class Clock;
+  friend class TimerWheel;
 
   Timer(uint64_t _id,
         const Timeout& _t,
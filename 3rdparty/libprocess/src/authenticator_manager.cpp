@@ -12,26 +12,64 @@
 
 #include "authenticator_manager.hpp"
 
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include <process/authenticator.hpp>
+#include <process/clock.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/http.hpp>
 #include <process/id.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/path.hpp>
+#include <stout/synchronized.hpp>
 
+using std::shared_ptr;
 using std::string;
 
 namespace process {
 namespace http {
 namespace authentication {
 
+// Bounds how long a successful authentication is served from the
+// cache. This also bounds the window during which a request carrying
+// a removed or changed credential is still accepted.
+static const Duration AUTHENTICATION_CACHE_TTL = Seconds(5);
+
+
+// Bound on the number of results cached per realm, to protect
+// against unbounded growth from requests carrying distinct (e.g.,
+// invalid and varying) credentials. Note that only successful
+// authentications are cached, so the bound is effectively the number
+// of valid credentials.
+static const size_t AUTHENTICATION_CACHE_MAX = 10240;
+
+
+// Cache of successful authentication results, keyed by realm and the
+// request's 'Authorization' header. All known authenticators make
+// their decision from that header alone, which is what makes the
+// result reusable across requests. Guarded by its mutex since the
+// cache is read and written from arbitrary threads.
+struct AuthenticationCache
+{
+  struct Entry
+  {
+    AuthenticationResult result;
+    Time expiration;
+  };
+
+  std::mutex mutex;
+  hashmap<string, hashmap<string, Entry>> entries;
+};
+
 
 class AuthenticatorManagerProcess : public Process<AuthenticatorManagerProcess>
 {
@@ -107,7 +145,8 @@ Future<Option<AuthenticationResult>> AuthenticatorManagerProcess::authenticate(
 
 
 AuthenticatorManager::AuthenticatorManager()
-  : process(new AuthenticatorManagerProcess())
+  : cache(new AuthenticationCache()),
+    process(new AuthenticatorManagerProcess())
 {
   spawn(process.get());
 }
@@ -124,6 +163,12 @@ Future<Nothing> AuthenticatorManager::setAuthenticator(
     const string& realm,
     Owned<Authenticator> authenticator)
 {
+  // Invalidate cached results for the realm since the new
+  // authenticator may not accept the same credentials.
+  synchronized (cache->mutex) {
+    cache->entries.erase(realm);
+  }
+
   return dispatch(
       process.get(),
       &AuthenticatorManagerProcess::setAuthenticator,
@@ -135,6 +180,10 @@ Future<Nothing> AuthenticatorManager::setAuthenticator(
 Future<Nothing> AuthenticatorManager::unsetAuthenticator(
     const string& realm)
 {
+  synchronized (cache->mutex) {
+    cache->entries.erase(realm);
+  }
+
   return dispatch(
       process.get(),
       &AuthenticatorManagerProcess::unsetAuthenticator,
@@ -146,11 +195,68 @@ Future<Option<AuthenticationResult>> AuthenticatorManager::authenticate(
     const Request& request,
     const string& realm)
 {
-  return dispatch(
+  Option<string> authorization = request.headers.get("Authorization");
+
+  // Fast path: serve repeat requests carrying a recently verified
+  // credential from the cache, without a dispatch to the manager
+  // actor (or the authenticator's).
+  if (authorization.isSome()) {
+    synchronized (cache->mutex) {
+      if (cache->entries.contains(realm)) {
+        Option<AuthenticationCache::Entry> entry =
+          cache->entries.at(realm).get(authorization.get());
+
+        if (entry.isSome() && Clock::now() < entry->expiration) {
+          return Option<AuthenticationResult>(entry->result);
+        }
+      }
+    }
+  }
+
+  Future<Option<AuthenticationResult>> future = dispatch(
       process.get(),
       &AuthenticatorManagerProcess::authenticate,
       request,
       realm);
+
+  if (authorization.isNone()) {
+    return future;
+  }
+
+  // NOTE: The continuation captures the cache by 'shared_ptr' since
+  // it may run after this manager has been destroyed.
+  shared_ptr<AuthenticationCache> cache_ = cache;
+  const string header = authorization.get();
+  const string realm_ = realm;
+
+  return future
+    .onReady([cache_, realm_, header](
+        const Option<AuthenticationResult>& result) {
+      // Only successful authentications are cached; rejections are
+      // re-verified each time so that an added credential takes
+      // effect immediately.
+      if (result.isNone() || result->principal.isNone()) {
+        return;
+      }
+
+      synchronized (cache_->mutex) {
+        hashmap<string, AuthenticationCache::Entry>& entries =
+          cache_->entries[realm_];
+
+        // Keep the cache bounded; starting over simply costs a
+        // verification per credential.
+        if (entries.size() >= AUTHENTICATION_CACHE_MAX &&
+            !entries.contains(header)) {
+          entries.clear();
+        }
+
+        AuthenticationCache::Entry entry;
+        entry.result = result.get();
+        entry.expiration = Clock::now() + AUTHENTICATION_CACHE_TTL;
+
+        entries[header] = entry;
+      }
+    });
 }
 
 } // namespace authentication {
@@ -13,6 +13,7 @@
 #ifndef __PROCESS_AUTHENTICATION_ROUTER_HPP__
 #define __PROCESS_AUTHENTICATION_ROUTER_HPP__
 
+#include <memory>
 #include <string>
 
 #include <process/authenticator.hpp>
@@ -28,6 +29,7 @@ namespace http {
 namespace authentication {
 
 class AuthenticatorManagerProcess;
+struct AuthenticationCache;
 
 
 // Manages the realm -> Authenticator mapping for HTTP
@@ -58,6 +60,12 @@ public:
       const std::string& realm);
 
 private:
+  // Cache of successful authentication results, checked inline
+  // (i.e., without a dispatch to the manager actor) on the calling
+  // thread. Shared with the cache-filling continuations, which may
+  // outlive this manager.
+  std::shared_ptr<AuthenticationCache> cache;
+
   Owned<AuthenticatorManagerProcess> process;
 };
 
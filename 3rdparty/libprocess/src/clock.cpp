@@ -24,13 +24,13 @@
 #include <process/timeout.hpp>
 
 #include <stout/duration.hpp>
-#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 #include <stout/unreachable.hpp>
 
 #include "event_loop.hpp"
+#include "timer_wheel.hpp"
 
 using std::list;
 using std::map;
@@ -39,10 +39,10 @@ using std::set;
 
 namespace process {
 
-// We store the timers in a map of lists indexed by the timeout of the
-// timer so that we can have two timers that have the same timeout. We
-// exploit that the map is SORTED!
-static map<Time, list<Timer>>* timers = new map<Time, list<Timer>>();
+// We store the timers in a hierarchical timing wheel so that creating
+// and canceling a timer is constant time in the number of pending
+// timers (see timer_wheel.hpp).
+static TimerWheel* timers = new TimerWheel();
 static recursive_mutex* timers_mutex = new recursive_mutex();
 
 
@@ -82,27 +82,22 @@ set<Time>* ticks = new set<Time>();
 // timers are expired. Note that we don't manipulate 'timers' directly
 // so that it's clear from the callsite that the use of 'timers' is
 // within a 'synchronized' block.
-//
-// TODO(benh): Create a generic 'Timers' abstraction which hides this
-// and more away (i.e., all manipulations of 'timers' below).
-Option<Time> next(const map<Time, list<Timer>>& timers)
+Option<Time> next(const TimerWheel& timers)
 {
-  if (!timers.empty()) {
-    Time first = timers.begin()->first;
+  const Option<Time> first = timers.earliest();
 
+  if (first.isSome()) {
     // If the clock is paused and no timers are expired, the
     // timers cannot fire until the clock is advanced, so we
     // return None() here. Note that we pass nullptr to ensure
     // that this looks at the global clock, since this can be
     // called from a Process context through Clock::timer.
-    if (Clock::paused() && first > Clock::now(nullptr)) {
+    if (Clock::paused() && first.get() > Clock::now(nullptr)) {
       return None();
     }
-
-    return first;
   }
 
-  return None();
+  return first;
 }
 
 
@@ -116,7 +111,7 @@ void tick(const Time& time);
 // a 'synchronized' block.
 // TODO(bmahler): Consider taking an optional 'now' to avoid
 // excessive syscalls via Clock::now(nullptr).
-void scheduleTick(const map<Time, list<Timer>>& timers, set<Time>* ticks)
+void scheduleTick(const TimerWheel& timers, set<Time>* ticks)
 {
   // Determine when the next 'tick' should fire.
   const Option<Time> next = clock::next(timers);
@@ -151,28 +146,17 @@ void tick(const Time& time)
 
     VLOG(3) << "Handling timers up to " << now;
 
-    foreachkey (const Time& timeout, *timers) {
-      if (timeout > now) {
-        break;
-      }
-
-      VLOG(3) << "Have timeout(s) at " << timeout;
-
-      // Need to toggle 'settling' so that we don't prematurely say
-      // we're settled until after the timers are executed below,
-      // outside of the critical section.
-      if (clock::paused) {
-        clock::settling = true;
-      }
+    timedout = timers->advance(now);
 
-      timedout.splice(timedout.end(), (*timers)[timeout]);
+    // Need to toggle 'settling' so that we don't prematurely say
+    // we're settled until after the timers are executed below,
+    // outside of the critical section.
+    if (clock::paused && !timedout.empty()) {
+      clock::settling = true;
     }
 
-    // Now erase the range of timers that timed out.
-    timers->erase(timers->begin(), timers->upper_bound(now));
-
     // Okay, so the timeout for the next timer should not have fired.
-    CHECK(timers->empty() || (timers->begin()->first > now));
+    CHECK(timers->empty() || (timers->earliest().get() > now));
 
     // Remove this tick from the scheduled 'ticks', it may have
     // been removed already if the clock was paused / manipulated
@@ -189,9 +173,9 @@ void tick(const Time& time)
   // that will expire before the paused time and we've finished
   // executing expired timers.
   synchronized (timers_mutex) {
+    const Option<Time> earliest = timers->earliest();
     if (clock::paused &&
-        (timers->size() == 0 ||
-         timers->begin()->first > *clock::current)) {
+        (earliest.isNone() || earliest.get() > *clock::current)) {
       VLOG(3) << "Clock has settled";
       clock::settling = false;
     }
@@ -219,7 +203,7 @@ void Clock::finalize()
     // This, along with the `timers_mutex`, is all that is required to clean
     // up any pending timers.  Timers are triggered via "ticks".  However,
     // we do not need to clear `ticks` because a "tick" with an empty `timers`
-    // map will effectively be a no-op.
+    // wheel will effectively be a no-op.
     timers->clear();
   }
 }
@@ -267,54 +251,43 @@ Timer Clock::timer(
   // Start at 1 since Timer() instances use id 0.
   static std::atomic<uint64_t> id(1);
 
+  UPID pid = __process__ != nullptr ? __process__->self() : UPID();
+
+  // Add the timer. Note that the timeout is computed while holding
+  // 'timers_mutex' (it is recursive, so the Clock::now() underneath
+  // Timeout::in is fine) so that a concurrent "tick" cannot advance
+  // the clock past the timeout before the timer is inserted.
   // Assumes Clock::now() does Clock::now(__process__).
-  Timeout timeout = Timeout::in(duration);
+  synchronized (timers_mutex) {
+    Timeout timeout = Timeout::in(duration);
 
-  UPID pid = __process__ != nullptr ? __process__->self() : UPID();
+    Timer timer(id.fetch_add(1), timeout, pid, thunk);
 
-  Timer timer(id.fetch_add(1), timeout, pid, thunk);
+    VLOG(3) << "Created a timer for " << pid << " in " << stringify(duration)
+            << " in the future (" << timeout.time() << ")";
 
-  VLOG(3) << "Created a timer for " << pid << " in " << stringify(duration)
-          << " in the future (" << timeout.time() << ")";
+    timers->insert(timer);
 
-  // Add the timer.
-  synchronized (timers_mutex) {
-    if (timers->size() == 0 ||
-        timer.timeout().time() < timers->begin()->first) {
-      // Need to interrupt the loop to update/set timer repeat.
-      (*timers)[timer.timeout().time()].push_back(timer);
+    // Schedule another "tick" if necessary. Note that 'scheduleTick'
+    // is a no-op unless this timer is earlier than all the currently
+    // scheduled "ticks".
+    clock::scheduleTick(*timers, clock::ticks);
 
-      // Schedule another "tick" if necessary.
-      clock::scheduleTick(*timers, clock::ticks);
-    } else {
-      // Timer repeat is adequate, just add the timeout.
-      CHECK(timers->size() >= 1);
-      (*timers)[timer.timeout().time()].push_back(timer);
-    }
+    return timer;
   }
 
-  return timer;
+  UNREACHABLE();
 }
 
 
 bool Clock::cancel(const Timer& timer)
 {
-  bool canceled = false;
   synchronized (timers_mutex) {
-    // Check if the timeout is still pending, and if so, erase it. In
-    // addition, erase an empty list if we just removed the last
-    // timeout.
-    Time time = timer.timeout().time();
-    if (timers->count(time) > 0) {
-      canceled = true;
-      (*timers)[time].remove(timer);
-      if ((*timers)[time].empty()) {
-        timers->erase(time);
-      }
-    }
+    // Check if the timer is still pending, and if so, erase it.
+    return timers->cancel(timer);
   }
 
-  return canceled;
+  UNREACHABLE();
 }
 
 
@@ -455,11 +428,12 @@ bool Clock::settled()
   synchronized (timers_mutex) {
     CHECK(clock::paused);
 
+    const Option<Time> earliest = timers->earliest();
+
     if (clock::settling) {
       VLOG(3) << "Clock still not settled";
       return false;
-    } else if (timers->size() == 0 ||
-               timers->begin()->first > *clock::current) {
+    } else if (earliest.isNone() || earliest.get() > *clock::current) {
       VLOG(3) << "Clock is settled";
       return true;
     }
@@ -16,8 +16,14 @@
 #include <stdint.h>
 #include <time.h>
 
+#ifndef __WINDOWS__
+#include <sys/uio.h>
+#endif // __WINDOWS__
+
 #include <map>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include <process/http.hpp>
 #include <process/process.hpp>
@@ -69,7 +75,10 @@ class DataEncoder : public Encoder
 {
 public:
   DataEncoder(const network::Socket& s, const std::string& _data)
-    : Encoder(s), data(_data), index(0) {}
+    : Encoder(s), data(_data), size(0), index(0)
+  {
+    append(data.data(), data.size());
+  }
 
   virtual ~DataEncoder() {}
 
@@ -78,14 +87,61 @@ public:
     return Encoder::DATA;
   }
 
+  // Returns a pointer to the next contiguous chunk of data to send
+  // (i.e., the remainder of the current segment), advancing past it.
   virtual const char* next(size_t* length)
   {
-    size_t temp = index;
-    index = data.size();
-    *length = data.size() - temp;
-    return data.data() + temp;
+    size_t offset = index;
+
+    foreach (const Segment& segment, segments) {
+      if (offset < segment.second) {
+        *length = segment.second - offset;
+        index += *length;
+        return segment.first + offset;
+      }
+      offset -= segment.second;
+    }
+
+    *length = 0;
+    return nullptr;
   }
 
+#ifndef __WINDOWS__
+  // Fills at most 'count' iovecs with the remaining segments for a
+  // scatter gather send, advancing past them. Returns the number of
+  // iovecs filled and stores the total number of bytes they span in
+  // 'length'.
+  virtual size_t next(iovec* iov, size_t count, size_t* length)
+  {
+    size_t offset = index;
+    size_t iovcnt = 0;
+
+    *length = 0;
+
+    foreach (const Segment& segment, segments) {
+      if (iovcnt == count) {
+        break;
+      }
+
+      if (offset >= segment.second) {
+        offset -= segment.second;
+        continue;
+      }
+
+      iov[iovcnt].iov_base = const_cast<char*>(segment.first + offset);
+      iov[iovcnt].iov_len = segment.second - offset;
+      *length += iov[iovcnt].iov_len;
+
+      iovcnt++;
+      offset = 0;
+    }
+
+    index += *length;
+
+    return iovcnt;
+  }
+#endif // __WINDOWS__
+
   virtual void backup(size_t length)
   {
     if (index >= length) {
@@ -95,12 +151,34 @@ public:
 
   virtual size_t remaining() const
   {
-    return data.size() - index;
+    return size - index;
+  }
+
+protected:
+  // Constructor for subclasses that provide their own segments via
+  // 'append', some of which may reference storage owned by the
+  // subclass (e.g., a message body) rather than being copied.
+  explicit DataEncoder(const network::Socket& s)
+    : Encoder(s), size(0), index(0) {}
+
+  void append(const char* _data, size_t length)
+  {
+    segments.push_back(Segment(_data, length));
+    size += length;
   }
 
 private:
+  typedef std::pair<const char*, size_t> Segment;
+
+  // (Possibly empty) backing storage for the single buffer case.
   const std::string data;
-  size_t index;
+
+  // The data to send, in order. The pointed to storage must outlive
+  // the encoder: it is either 'data' above or owned by the subclass.
+  std::vector<Segment> segments;
+
+  size_t size;  // Total number of bytes across all segments.
+  size_t index; // Number of bytes already sent.
 };
 
 
@@ -108,7 +186,20 @@ class MessageEncoder : public DataEncoder
 {
 public:
   MessageEncoder(const network::Socket& s, Message* _message)
-    : DataEncoder(s, encode(_message)), message(_message) {}
+    : DataEncoder(s), message(_message), header(encodeHeader(_message))
+  {
+    append(header.data(), header.size());
+
+    if (message != nullptr && message->body.size() > 0) {
+      // Reference the message body in place rather than copying it
+      // into the encoded data: the message is owned by this encoder
+      // so the body outlives the send.
+      static const std::string trailer = "\r\n0\r\n\r\n";
+
+      append(message->body.data(), message->body.size());
+      append(trailer.data(), trailer.size());
+    }
+  }
 
   virtual ~MessageEncoder()
   {
@@ -117,7 +208,31 @@ public:
     }
   }
 
+  // Returns the complete encoding of the message, including the body.
+  // NOTE: the encoder itself does not use this (it references the
+  // body in place, see above); this is kept for callers (and tests)
+  // that want the full wire format as a single buffer.
   static std::string encode(Message* message)
+  {
+    if (message == nullptr) {
+      return "";
+    }
+
+    std::string encoded = encodeHeader(message);
+
+    if (message->body.size() > 0) {
+      encoded.append(message->body);
+      encoded.append("\r\n0\r\n\r\n");
+    }
+
+    return encoded;
+  }
+
+private:
+  // Returns the encoding of everything that precedes the message
+  // body: the request line and headers, and, if there is a body, the
+  // (single) chunk length since we use chunked transfer encoding.
+  static std::string encodeHeader(Message* message)
   {
     std::ostringstream out;
 
@@ -141,10 +256,6 @@ public:
       if (message->body.size() > 0) {
         out << "Transfer-Encoding: chunked\r\n\r\n"
             << std::hex << message->body.size() << "\r\n";
-        out.write(message->body.data(), message->body.size());
-        out << "\r\n"
-            << "0\r\n"
-            << "\r\n";
       } else {
         out << "\r\n";
       }
@@ -153,8 +264,11 @@ public:
     return out.str();
   }
 
-private:
   Message* message;
+
+  // The encoded request line, headers and chunk framing (the body
+  // itself stays in 'message').
+  const std::string header;
 };
 
 
@@ -251,8 +365,14 @@ public:
 class FileEncoder : public Encoder
 {
 public:
-  FileEncoder(const network::Socket& s, int _fd, size_t _size)
-    : Encoder(s), fd(_fd), size(_size), index(0) {}
+  // Encodes the '_size' bytes of the file starting at '_offset'. By
+  // default the whole file (from the beginning) is encoded.
+  FileEncoder(
+      const network::Socket& s,
+      int _fd,
+      size_t _size,
+      off_t _offset = 0)
+    : Encoder(s), fd(_fd), size(_offset + _size), index(_offset) {}
 
   virtual ~FileEncoder()
   {
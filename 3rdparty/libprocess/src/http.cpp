@@ -22,6 +22,7 @@
 #include <cstring>
 #include <deque>
 #include <iomanip>
+#include <list>
 #include <ostream>
 #include <map>
 #include <memory>
@@ -402,6 +403,7 @@ Future<string> Pipe::Reader::read()
       future = Failure("closed");
     } else if (!data->writes.empty()) {
       future = data->writes.front();
+      data->writesSize -= data->writes.front().size();
       data->writes.pop();
     } else if (data->writeEnd == Writer::CLOSED) {
       future = ""; // End-of-file.
@@ -430,6 +432,7 @@ bool Pipe::Reader::close()
       while (!data->writes.empty()) {
         data->writes.pop();
       }
+      data->writesSize = 0;
 
       // Extract the pending reads so we can fail them.
       std::swap(data->reads, reads);
@@ -475,6 +478,7 @@ bool Pipe::Writer::write(string s)
       // Don't bother surfacing empty writes to the readers.
       if (!s.empty()) {
         if (data->reads.empty()) {
+          data->writesSize += s.size();
           data->writes.push(std::move(s));
         } else {
           read = data->reads.front();
@@ -548,6 +552,18 @@ bool Pipe::Writer::fail(const string& message)
 }
 
 
+size_t Pipe::Writer::outstanding() const
+{
+  size_t size = 0;
+
+  synchronized (data->lock) {
+    size = data->writesSize;
+  }
+
+  return size;
+}
+
+
 Future<Nothing> Pipe::Writer::readerClosed() const
 {
   return data->readerClosure.future();
@@ -1284,6 +1300,160 @@ Future<Connection> connect(const URL& url)
 }
 
 
+namespace internal {
+
+class ConnectionPoolProcess : public Process<ConnectionPoolProcess>
+{
+public:
+  explicit ConnectionPoolProcess(size_t _capacity)
+    : ProcessBase(ID::generate("__http_connection_pool__")),
+      capacity(_capacity) {}
+
+  Future<Response> send(Request request, bool streamedResponse)
+  {
+    // The pool only hands out keep-alive connections.
+    request.keepAlive = true;
+
+    const string key = address(request.url);
+
+    if (idle.contains(key) && !idle[key].empty()) {
+      Connection connection = idle[key].front();
+      idle[key].pop_front();
+      return _send(key, connection, request, streamedResponse);
+    }
+
+    return http::connect(request.url)
+      .then(defer(self(), [this, key, request, streamedResponse](
+          Connection connection) {
+        // Evict the connection from the pool when the server (or the
+        // 'Connection: close' handling) closes it.
+        connection.disconnected()
+          .onAny(defer(self(), &Self::evict, key, connection));
+
+        return _send(key, connection, request, streamedResponse);
+      }));
+  }
+
+  Future<Nothing> disconnect()
+  {
+    foreachvalue (std::list<Connection>& connections, idle) {
+      foreach (Connection& connection, connections) {
+        connection.disconnect();
+      }
+    }
+
+    idle.clear();
+
+    return Nothing();
+  }
+
+private:
+  Future<Response> _send(
+      const string& key,
+      Connection connection,
+      const Request& request,
+      bool streamedResponse)
+  {
+    Future<Response> response = connection.send(request, streamedResponse);
+
+    // Return the connection to the pool once the response completes.
+    // NOTE: a failed (or discarded) response means the connection is
+    // broken (or getting disconnected, see Connection::send), so in
+    // that case we simply let the connection go.
+    response
+      .onAny(defer(self(), &Self::returned, key, connection, lambda::_1));
+
+    return response;
+  }
+
+  void returned(
+      const string& key,
+      const Connection& connection,
+      const Future<Response>& response)
+  {
+    if (response.isReady() && idle[key].size() < capacity) {
+      // NOTE: if the response carried 'Connection: close' the
+      // connection is about to die; the disconnection handler
+      // installed in 'send' will evict it.
+      idle[key].push_back(connection);
+    } else {
+      Connection(connection).disconnect();
+    }
+  }
+
+  void evict(const string& key, const Connection& connection)
+  {
+    if (idle.contains(key)) {
+      idle[key].remove(connection);
+    }
+  }
+
+  // The pool is keyed by scheme, host and port.
+  static string address(const URL& url)
+  {
+    string host;
+
+    if (url.ip.isSome()) {
+      host = stringify(url.ip.get());
+    } else if (url.domain.isSome()) {
+      host = url.domain.get();
+    }
+
+    return url.scheme.getOrElse("http") + "://" + host + ":" +
+           (url.port.isSome() ? stringify(url.port.get()) : "");
+  }
+
+  // Maximum number of idle connections kept per server.
+  const size_t capacity;
+
+  hashmap<string, std::list<Connection>> idle;
+};
+
+} // namespace internal {
+
+
+// See the comment in `Connection::Data` for why the process is
+// spawned as a managed process.
+struct ConnectionPool::Data
+{
+  explicit Data(size_t capacity)
+    : process(spawn(new internal::ConnectionPoolProcess(capacity), true)) {}
+
+  ~Data()
+  {
+    // As with `Connection::Data`, don't inject the termination event
+    // so queued sends still get processed.
+    terminate(process, false);
+  }
+
+  PID<internal::ConnectionPoolProcess> process;
+};
+
+
+ConnectionPool::ConnectionPool(size_t capacity)
+  : data(std::make_shared<ConnectionPool::Data>(capacity)) {}
+
+
+Future<Response> ConnectionPool::send(
+    const http::Request& request,
+    bool streamedResponse)
+{
+  return dispatch(
+      data->process,
+      &internal::ConnectionPoolProcess::send,
+      request,
+      streamedResponse);
+}
+
+
+Future<Nothing> ConnectionPool::disconnect()
+{
+  return dispatch(
+      data->process,
+      &internal::ConnectionPoolProcess::disconnect);
+}
+
+
 Request createRequest(
     const URL& url,
     const string& method,
@@ -10,8 +10,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <boost/shared_array.hpp>
 
@@ -25,6 +28,7 @@
 #include <stout/os/read.hpp>
 #include <stout/os/strerror.hpp>
 #include <stout/os/write.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
 using std::string;
@@ -33,6 +37,65 @@ namespace process {
 namespace io {
 namespace internal {
 
+// A pool of fixed size (BUFFERED_READ_SIZE) read chunks. Buffered
+// reads (e.g., the files endpoints and the fetcher moving bulk data
+// through io::read) go through many short lived chunks; recycling
+// them through a small free list avoids an allocation per read. The
+// chunks are reference counted: a chunk goes back on the free list
+// when the last reference to it is dropped, so a chunk can safely be
+// referenced by continuations that outlive the read. The free list
+// is bounded, anything beyond its capacity is simply freed.
+class ChunkPool
+{
+public:
+  std::shared_ptr<char> get()
+  {
+    char* chunk = nullptr;
+
+    synchronized (mutex) {
+      if (!chunks.empty()) {
+        chunk = chunks.back();
+        chunks.pop_back();
+      }
+    }
+
+    if (chunk == nullptr) {
+      chunk = new char[BUFFERED_READ_SIZE];
+    }
+
+    return std::shared_ptr<char>(chunk, [this](char* chunk) { put(chunk); });
+  }
+
+private:
+  void put(char* chunk)
+  {
+    synchronized (mutex) {
+      if (chunks.size() < CAPACITY) {
+        chunks.push_back(chunk);
+        chunk = nullptr;
+      }
+    }
+
+    if (chunk != nullptr) {
+      delete[] chunk;
+    }
+  }
+
+  // Maximum number of idle chunks retained (with 64K chunks this
+  // bounds the free list at 4MB).
+  static const size_t CAPACITY = 64;
+
+  std::mutex mutex;
+  std::vector<char*> chunks;
+};
+
+
+// NOTE: the pool is intentionally leaked: outstanding chunks may be
+// returned from other threads at any time, including during static
+// destruction.
+static ChunkPool* chunk_pool = new ChunkPool();
+
+
 enum ReadFlags
 {
   NONE = 0,
@@ -168,6 +231,58 @@ void write(
   }
 }
 
+
+#ifndef __WINDOWS__
+void writev(
+    int fd,
+    const std::shared_ptr<std::vector<struct iovec>>& iov,
+    const std::shared_ptr<Promise<size_t>>& promise,
+    const Future<short>& future)
+{
+  // Ignore this function if the write operation has been discarded.
+  if (promise->future().hasDiscard()) {
+    promise->discard();
+    return;
+  }
+
+  if (iov->empty()) {
+    promise->set(0);
+    return;
+  }
+
+  if (future.isDiscarded()) {
+    promise->fail("Failed to poll: discarded future");
+  } else if (future.isFailed()) {
+    promise->fail(future.failure());
+  } else {
+    ssize_t length = ::writev(fd, iov->data(), static_cast<int>(iov->size()));
+
+    if (length < 0) {
+      if (net::is_restartable_error(errno) || net::is_retryable_error(errno)) {
+        // Restart the write operation.
+        Future<short> future =
+          io::poll(fd, process::io::WRITE).onAny(
+              lambda::bind(&internal::writev,
+                           fd,
+                           iov,
+                           promise,
+                           lambda::_1));
+
+        // Stop polling if a discard occurs on our future.
+        promise->future().onDiscard(
+            lambda::bind(&process::internal::discard<short>,
+                         WeakFuture<short>(future)));
+      } else {
+        // Error occurred.
+        promise->fail(os::strerror(errno));
+      }
+    } else {
+      promise->set(length);
+    }
+  }
+}
+#endif // __WINDOWS__
+
 } // namespace internal {
 
 
@@ -237,6 +352,40 @@ Future<size_t> write(int fd, const void* data, size_t size)
 }
 
 
+#ifndef __WINDOWS__
+Future<size_t> write(int fd, const struct iovec* iov, int iovcnt)
+{
+  process::initialize();
+
+  std::shared_ptr<Promise<size_t>> promise(new Promise<size_t>());
+
+  // Check the file descriptor.
+  Try<bool> nonblock = os::isNonblock(fd);
+  if (nonblock.isError()) {
+    // The file descriptor is not valid (e.g., has been closed).
+    promise->fail(
+        "Failed to check if file descriptor was non-blocking: " +
+        nonblock.error());
+    return promise->future();
+  } else if (!nonblock.get()) {
+    // The file descriptor is not non-blocking.
+    promise->fail("Expected a non-blocking file descriptor");
+    return promise->future();
+  }
+
+  // Copy the iovec array since the write may complete asynchronously
+  // (the buffers the array points to must still outlive the write).
+  std::shared_ptr<std::vector<struct iovec>> buffers(
+      new std::vector<struct iovec>(iov, iov + iovcnt));
+
+  // As with the non-vectored write, attempt immediately (see above).
+  internal::writev(fd, buffers, promise, io::WRITE);
+
+  return promise->future();
+}
+#endif // __WINDOWS__
+
+
 Future<size_t> peek(int fd, void* data, size_t size, size_t limit)
 {
   process::initialize();
@@ -301,7 +450,7 @@ namespace internal {
 Future<string> _read(
     int fd,
     const std::shared_ptr<string>& buffer,
-    const boost::shared_array<char>& data,
+    const std::shared_ptr<char>& data,
     size_t length)
 {
   return io::read(fd, data.get(), length)
@@ -330,6 +479,66 @@ Future<Nothing> _write(
 }
 
 
+#ifndef __WINDOWS__
+// Continues writing the buffers starting at 'data[index]' (of which
+// 'offset' bytes have already been written).
+Future<Nothing> _writev(
+    int fd,
+    const std::shared_ptr<std::vector<string>>& data,
+    size_t index,
+    size_t offset)
+{
+  // Maximum number of buffers gathered per system call (well below
+  // any IOV_MAX).
+  static const size_t MAX_IOVECS = 64;
+
+  std::vector<struct iovec> iov;
+
+  for (size_t i = index; i < data->size() && iov.size() < MAX_IOVECS; i++) {
+    const string& buffer = (*data)[i];
+    const size_t skip = (i == index) ? offset : 0;
+
+    if (buffer.size() > skip) {
+      struct iovec entry;
+      entry.iov_base = const_cast<char*>(buffer.data() + skip);
+      entry.iov_len = buffer.size() - skip;
+      iov.push_back(entry);
+    }
+  }
+
+  if (iov.empty()) { // Nothing left to write.
+    return Nothing();
+  }
+
+  return io::write(fd, iov.data(), static_cast<int>(iov.size()))
+    .then([=](size_t length) -> Future<Nothing> {
+      // Advance over the written bytes.
+      size_t i = index;
+      size_t o = offset;
+
+      while (length > 0 || (i < data->size() && (*data)[i].size() == o)) {
+        const size_t remaining = (*data)[i].size() - o;
+
+        if (length >= remaining) {
+          length -= remaining;
+          i++;
+          o = 0;
+        } else {
+          o += length;
+          length = 0;
+        }
+      }
+
+      if (i == data->size()) {
+        return Nothing();
+      }
+
+      return _writev(fd, data, i, o);
+    });
+}
+#endif // __WINDOWS__
+
+
 void _splice(
     int from,
     int to,
@@ -436,7 +645,7 @@ Future<string> read(int fd)
   // TODO(benh): Wrap up this data as a struct, use 'Owner'.
   // TODO(bmahler): For efficiency, use a rope for the buffer.
   std::shared_ptr<string> buffer(new string());
-  boost::shared_array<char> data(new char[BUFFERED_READ_SIZE]);
+  std::shared_ptr<char> data = internal::chunk_pool->get();
 
   // NOTE: We wrap `os::close` in a lambda to disambiguate on Windows.
   return internal::_read(fd, buffer, data, BUFFERED_READ_SIZE)
@@ -496,6 +705,48 @@ Future<Nothing> write(int fd, const string& data)
 }
 
 
+#ifndef __WINDOWS__
+Future<Nothing> write(int fd, const std::vector<string>& data)
+{
+  process::initialize();
+
+  // Get our own copy of the file descriptor (see the non-vectored
+  // overload above for the rationale).
+  if (fd < 0) {
+    return Failure(os::strerror(EBADF));
+  }
+
+  fd = dup(fd);
+  if (fd == -1) {
+    return Failure(ErrnoError("Failed to duplicate file descriptor"));
+  }
+
+  // Set the close-on-exec flag.
+  Try<Nothing> cloexec = os::cloexec(fd);
+  if (cloexec.isError()) {
+    os::close(fd);
+    return Failure(
+        "Failed to set close-on-exec on duplicated file descriptor: " +
+        cloexec.error());
+  }
+
+  // Make the file descriptor non-blocking.
+  Try<Nothing> nonblock = os::nonblock(fd);
+  if (nonblock.isError()) {
+    os::close(fd);
+    return Failure(
+        "Failed to make duplicated file descriptor non-blocking: " +
+        nonblock.error());
+  }
+
+  return internal::_writev(
+      fd, std::shared_ptr<std::vector<string>>(
+          new std::vector<string>(data)), 0, 0)
+    .onAny([fd]() { os::close(fd); });
+}
+#endif // __WINDOWS__
+
+
 Future<Nothing> redirect(int from, Option<int> to, size_t chunk)
 {
   // Make sure we've got "valid" file descriptors.
@@ -593,7 +844,7 @@ Future<string> peek(int fd, size_t limit)
   }
 
   // TODO(benh): Wrap up this data as a struct, use 'Owner'.
-  boost::shared_array<char> data(new char[BUFFERED_READ_SIZE]);
+  std::shared_ptr<char> data = internal::chunk_pool->get();
 
   return io::peek(fd, data.get(), BUFFERED_READ_SIZE, limit)
     .then([=](size_t length) -> Future<string> {
@@ -12,12 +12,20 @@
 
 #include <ev.h>
 
+#include <glog/logging.h>
+
+#include <algorithm>
 #include <mutex>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include <stout/duration.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
 #include <stout/thread_local.hpp>
 
 #include "event_loop.hpp"
@@ -25,48 +33,40 @@
 
 namespace process {
 
-ev_async async_watcher;
-// We need an asynchronous watcher to receive the request to shutdown.
-ev_async shutdown_watcher;
-
 // Define the initial values for all of the declarations made in
 // libev.hpp (since these need to live in the static data space).
-struct ev_loop* loop = nullptr;
-
-std::queue<ev_io*>* watchers = new std::queue<ev_io*>();
-
-std::mutex* watchers_mutex = new std::mutex();
+Shard* shards = nullptr;
+size_t num_shards = 1;
 
-std::queue<lambda::function<void()>>* functions =
-  new std::queue<lambda::function<void()>>();
+THREAD_LOCAL Shard* _event_loop_shard_ = nullptr;
 
-THREAD_LOCAL bool* _in_event_loop_ = nullptr;
 
-
-void handle_async(struct ev_loop* loop, ev_async* _, int revents)
+void handle_async(struct ev_loop* loop, ev_async* watcher, int revents)
 {
+  Shard* shard = reinterpret_cast<Shard*>(watcher->data);
+
   std::queue<lambda::function<void()>> run_functions;
-  synchronized (watchers_mutex) {
+  synchronized (shard->mutex) {
     // Start all the new I/O watchers.
-    while (!watchers->empty()) {
-      ev_io* watcher = watchers->front();
-      watchers->pop();
+    while (!shard->watchers.empty()) {
+      ev_io* watcher = shard->watchers.front();
+      shard->watchers.pop();
       ev_io_start(loop, watcher);
     }
 
     // Swap the functions into a temporary queue so that we can invoke
     // them outside of the mutex.
-    std::swap(run_functions, *functions);
+    std::swap(run_functions, shard->functions);
   }
 
   // Running the functions outside of the mutex reduces locking
   // contention as these are arbitrary functions that can take a long
   // time to execute. Doing this also avoids a deadlock scenario where
   // (A) mutexes are acquired before calling `run_in_event_loop`,
-  // followed by locking (B) `watchers_mutex`. If we executed the
+  // followed by locking (B) the shard's mutex. If we executed the
   // functions inside the mutex, then the locking order violation
-  // would be this function acquiring the (B) `watchers_mutex`
-  // followed by the arbitrary function acquiring the (A) mutexes.
+  // would be this function acquiring (B) the shard's mutex followed
+  // by the arbitrary function acquiring the (A) mutexes.
   while (!run_functions.empty()) {
     (run_functions.front())();
     run_functions.pop();
@@ -80,15 +80,63 @@ void handle_shutdown(struct ev_loop* loop, ev_async* _, int revents)
 }
 
 
+// Determines the number of event loops, which defaults to the number
+// of cores (capped, since an event loop thread per core on a large
+// machine is rarely warranted) and can be overridden with the
+// LIBPROCESS_NUM_EVENT_LOOPS environment variable (cf.
+// LIBPROCESS_NUM_WORKER_THREADS in process.cpp).
+static size_t num_event_loops()
+{
+  long num_loops =
+    std::min(8L, os::cpus().isSome() ? os::cpus().get() : 1);
+
+  constexpr char env_var[] = "LIBPROCESS_NUM_EVENT_LOOPS";
+  Option<std::string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    constexpr long maxval = 1024;
+    Try<long> number = numify<long>(value.get().c_str());
+    if (number.isSome() && number.get() > 0L && number.get() <= maxval) {
+      VLOG(1) << "Overriding default number of event loops "
+              << num_loops << ", using the value "
+              << env_var << "=" << number.get() << " instead";
+      num_loops = number.get();
+    } else {
+      LOG(WARNING) << "Ignoring invalid value " << value.get()
+                   << " for " << env_var
+                   << ", using default value " << num_loops
+                   << ". Valid values are integers in the range 1 to "
+                   << maxval;
+    }
+  }
+
+  return num_loops;
+}
+
+
 void EventLoop::initialize()
 {
-  loop = ev_default_loop(EVFLAG_AUTO);
+  num_shards = num_event_loops();
+  shards = new Shard[num_shards];
+
+  for (size_t i = 0; i < num_shards; i++) {
+    Shard* shard = &shards[i];
 
-  ev_async_init(&async_watcher, handle_async);
-  ev_async_init(&shutdown_watcher, handle_shutdown);
+    // NOTE: the default loop is kept as the first shard since it is
+    // the only one that can handle child watchers should we ever use
+    // them.
+    shard->loop =
+      i == 0 ? ev_default_loop(EVFLAG_AUTO) : ev_loop_new(EVFLAG_AUTO);
 
-  ev_async_start(loop, &async_watcher);
-  ev_async_start(loop, &shutdown_watcher);
+    ev_async_init(&shard->async_watcher, handle_async);
+    ev_async_init(&shard->shutdown_watcher, handle_shutdown);
+
+    // Have the watcher data point back to the shard so that
+    // 'handle_async' can find the right queues.
+    shard->async_watcher.data = shard;
+
+    ev_async_start(shard->loop, &shard->async_watcher);
+    ev_async_start(shard->loop, &shard->shutdown_watcher);
+  }
 }
 
 
@@ -125,11 +173,22 @@ Future<Nothing> delay(
   const double repeat = 0.0;
 
   ev_timer_init(timer, handle_delay, after, repeat);
-  ev_timer_start(loop, timer);
+  ev_timer_start(shards[0].loop, timer);
 
   return Nothing();
 }
 
+
+// Runs the event loop of the specified shard.
+static void run(Shard* shard)
+{
+  _event_loop_shard_ = shard;
+
+  ev_loop(shard->loop, 0);
+
+  _event_loop_shard_ = nullptr;
+}
+
 } // namespace internal {
 
 
@@ -137,7 +196,9 @@ void EventLoop::delay(
     const Duration& duration,
     const lambda::function<void()>& function)
 {
+  // Timers all live in the first shard's loop.
   run_in_event_loop<Nothing>(
+      &shards[0],
       lambda::bind(&internal::delay, duration, function));
 }
 
@@ -151,16 +212,27 @@ double EventLoop::time()
 
 void EventLoop::run()
 {
-  __in_event_loop__ = true;
+  // Run any additional event loops on their own threads and the
+  // first one on this thread, joining the others once every loop has
+  // been told to shutdown (see 'stop').
+  std::vector<std::thread> threads;
+
+  for (size_t i = 1; i < num_shards; i++) {
+    threads.emplace_back(&internal::run, &shards[i]);
+  }
 
-  ev_loop(loop, 0);
+  internal::run(&shards[0]);
 
-  __in_event_loop__ = false;
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
 }
 
 void EventLoop::stop()
 {
-  ev_async_send(loop, &shutdown_watcher);
+  for (size_t i = 0; i < num_shards; i++) {
+    ev_async_send(shards[i].loop, &shards[i].shutdown_watcher);
+  }
 }
 
 } // namespace process {
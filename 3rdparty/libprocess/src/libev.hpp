@@ -27,30 +27,54 @@
 
 namespace process {
 
-// Event loop.
-extern struct ev_loop* loop;
+// Everything an event loop needs: the loop itself, the asynchronous
+// watchers for interrupting and shutting down the loop, and the
+// queues of I/O watchers and functions to be started/invoked within
+// the loop.
+struct Shard
+{
+  // Event loop.
+  struct ev_loop* loop = nullptr;
+
+  // Asynchronous watcher for interrupting the loop to specifically
+  // deal with IO watchers and functions (via run_in_event_loop).
+  ev_async async_watcher;
+
+  // We need an asynchronous watcher to receive the request to
+  // shutdown.
+  ev_async shutdown_watcher;
+
+  // Queue of I/O watchers to be asynchronously added to the event
+  // loop (protected by 'mutex' below).
+  // TODO(benh): Replace this queue with functions that we put in
+  // 'functions' below that perform the ev_io_start themselves.
+  std::queue<ev_io*> watchers;
 
-// Asynchronous watcher for interrupting loop to specifically deal
-// with IO watchers and functions (via run_in_event_loop).
-extern ev_async async_watcher;
+  // Queue of functions to be invoked asynchronously within the event
+  // loop (protected by 'mutex' below).
+  std::queue<lambda::function<void()>> functions;
 
-// Queue of I/O watchers to be asynchronously added to the event loop
-// (protected by 'watchers' below).
-// TODO(benh): Replace this queue with functions that we put in
-// 'functions' below that perform the ev_io_start themselves.
-extern std::queue<ev_io*>* watchers;
-extern std::mutex* watchers_mutex;
+  std::mutex mutex;
+};
 
-// Queue of functions to be invoked asynchronously within the vent
-// loop (protected by 'watchers' above).
-extern std::queue<lambda::function<void()>>* functions;
 
-// Per thread bool pointer. We use a pointer to lazily construct the
-// actual bool.
-extern THREAD_LOCAL bool* _in_event_loop_;
+// The event loops. There may be more than one (see
+// LIBPROCESS_NUM_EVENT_LOOPS), with sockets sharded across them by
+// file descriptor (see 'shard' below) so that network I/O is not
+// bottlenecked on a single thread.
+extern Shard* shards;
+extern size_t num_shards;
 
-#define __in_event_loop__ *(_in_event_loop_ == nullptr ?                \
-  _in_event_loop_ = new bool(false) : _in_event_loop_)
+// The shard whose event loop is running on this thread, or nullptr
+// if this thread is not an event loop thread.
+extern THREAD_LOCAL Shard* _event_loop_shard_;
+
+
+// Returns the shard the file descriptor maps onto.
+inline Shard* shard(int fd)
+{
+  return &shards[fd % num_shards];
+}
 
 
 // Wrapper around function we want to run in the event loop.
@@ -68,12 +92,15 @@ void _run_in_event_loop(
 }
 
 
-// Helper for running a function in the event loop.
+// Helper for running a function in the specified shard's event loop.
 template <typename T>
-Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
+Future<T> run_in_event_loop(
+    Shard* shard,
+    const lambda::function<Future<T>()>& f)
 {
-  // If this is already the event loop then just run the function.
-  if (__in_event_loop__) {
+  // If this is already the target event loop then just run the
+  // function.
+  if (_event_loop_shard_ == shard) {
     return f();
   }
 
@@ -82,12 +109,12 @@ Future<T> run_in_event_loop(const lambda::function<Future<T>()>& f)
   Future<T> future = promise->future();
 
   // Enqueue the function.
-  synchronized (watchers_mutex) {
-    functions->push(lambda::bind(&_run_in_event_loop<T>, f, promise));
+  synchronized (shard->mutex) {
+    shard->functions.push(lambda::bind(&_run_in_event_loop<T>, f, promise));
   }
 
   // Interrupt the loop.
-  ev_async_send(loop, &async_watcher);
+  ev_async_send(shard->loop, &shard->async_watcher);
 
   return future;
 }
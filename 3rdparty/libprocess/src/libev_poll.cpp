@@ -90,7 +90,7 @@ namespace io {
 namespace internal {
 
 // Helper/continuation of 'poll' on future discard.
-void _poll(const std::shared_ptr<ev_async>& async)
+void _poll(struct ev_loop* loop, const std::shared_ptr<ev_async>& async)
 {
   ev_async_send(loop, async.get());
 }
@@ -98,6 +98,10 @@ void _poll(const std::shared_ptr<ev_async>& async)
 
 Future<short> poll(int fd, short events)
 {
+  // The loop of the shard the file descriptor maps onto; this
+  // function runs within that loop (see below).
+  struct ev_loop* loop = shard(fd)->loop;
+
   Poll* poll = new Poll();
 
   // Have the watchers data point back to the struct.
@@ -117,7 +121,7 @@ Future<short> poll(int fd, short events)
   // in this case while we will interrupt the event loop since the
   // async watcher has already been stopped we won't cause
   // 'discard_poll' to get invoked.
-  future.onDiscard(lambda::bind(&_poll, poll->watcher.async));
+  future.onDiscard(lambda::bind(&_poll, loop, poll->watcher.async));
 
   // Initialize and start the I/O watcher.
   ev_io_init(poll->watcher.io.get(), polled, fd, events);
@@ -135,7 +139,12 @@ Future<short> poll(int fd, short events)
 
   // TODO(benh): Check if the file descriptor is non-blocking?
 
-  return run_in_event_loop<short>(lambda::bind(&internal::poll, fd, events));
+  // Run in the event loop of the shard the file descriptor maps
+  // onto: a descriptor is always watched by the same loop, sharding
+  // the socket I/O across the event loop threads.
+  return run_in_event_loop<short>(
+      shard(fd),
+      lambda::bind(&internal::poll, fd, events));
 }
 
 } // namespace io {
@@ -26,6 +26,7 @@
 #include <process/ssl/flags.hpp>
 
 #include <stout/net.hpp>
+#include <stout/stringify.hpp>
 #include <stout/synchronized.hpp>
 
 #include "libevent.hpp"
@@ -402,6 +403,13 @@ void LibeventSSLSocketImpl::event_callback(short events)
       return;
     }
 
+    // Cache the session for this peer: if the handshake was resumed
+    // this refreshes the cached session, and if a full handshake was
+    // performed this makes the next connection resumable.
+    if (peer_address.isSome()) {
+      openssl::cache_client_session(ssl, peer_address.get());
+    }
+
     current_connect_request->promise.set(Nothing());
   } else if (events & BEV_EVENT_ERROR) {
     CHECK(EVUTIL_SOCKET_ERROR() != 0);
@@ -475,6 +483,12 @@ Future<Nothing> LibeventSSLSocketImpl::connect(const Address& address)
     return Failure("Failed to connect: SSL_new");
   }
 
+  // Attach a previously negotiated session with this peer, if we
+  // have one cached, so that the handshake can be resumed instead of
+  // performed in full. This must happen before the handshake is
+  // initiated by the bufferevent below.
+  openssl::set_client_session(ssl, stringify(address));
+
   // Construct the bufferevent in the connecting state.
   // We set 'BEV_OPT_DEFER_CALLBACKS' to avoid calling the
   // 'event_callback' before 'bufferevent_socket_connect' returns.
@@ -508,6 +522,11 @@ Future<Nothing> LibeventSSLSocketImpl::connect(const Address& address)
   // order to properly verify the certificate later.
   peer_ip = address.ip;
 
+  // Remember the peer address so that once the connection is
+  // established the negotiated session can be cached under it for
+  // later resumption.
+  peer_address = stringify(address);
+
   // Optimistically construct a 'ConnectRequest' and future.
   Owned<ConnectRequest> request(new ConnectRequest());
   Future<Nothing> future = request->promise.future();
@@ -179,6 +179,11 @@ private:
 
   Option<std::string> peer_hostname;
   Option<net::IP> peer_ip;
+
+  // The stringified address a connecting socket was pointed at; used
+  // as the key under which the negotiated TLS session is cached for
+  // later resumption. Only set for connecting (client) sockets.
+  Option<std::string> peer_address;
 };
 
 } // namespace network {
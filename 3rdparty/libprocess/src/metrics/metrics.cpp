@@ -40,6 +40,129 @@ namespace process {
 namespace metrics {
 namespace internal {
 
+constexpr size_t Registry::SHARDS;
+
+
+Registry* registry()
+{
+  // NOTE: a function local static so that metrics can be added from
+  // static initialization code without running into initialization
+  // order issues.
+  static Registry* instance = new Registry();
+  return instance;
+}
+
+
+Future<Nothing> Registry::add(Owned<Metric> metric)
+{
+  Shard& shard_ = shard(metric->name());
+
+  synchronized (shard_.mutex) {
+    if (shard_.metrics.contains(metric->name())) {
+      return Failure("Metric '" + metric->name() + "' was already added");
+    }
+
+    shard_.metrics[metric->name()] = metric;
+  }
+
+  return Nothing();
+}
+
+
+Future<Nothing> Registry::remove(const string& name)
+{
+  Shard& shard_ = shard(name);
+
+  synchronized (shard_.mutex) {
+    if (!shard_.metrics.contains(name)) {
+      return Failure("Metric '" + name + "' not found");
+    }
+
+    shard_.metrics.erase(name);
+  }
+
+  return Nothing();
+}
+
+
+Future<hashmap<string, double>> Registry::snapshot(
+    const Option<Duration>& timeout)
+{
+  hashmap<string, Future<double>> futures;
+  hashmap<string, Option<Statistics<double>>> statistics;
+
+  for (size_t i = 0; i < SHARDS; i++) {
+    synchronized (shards[i].mutex) {
+      foreachvalue (const Owned<Metric>& metric, shards[i].metrics) {
+        CHECK_NOTNULL(metric.get());
+        futures[metric->name()] = metric->value();
+        // TODO(dhamon): It would be nice to compute these asynchronously.
+        statistics[metric->name()] = metric->statistics();
+      }
+    }
+  }
+
+  // NOTE: only the metrics whose value is provided by a process
+  // (e.g., Gauge) have pending futures here; the push based metrics
+  // (Counter, PushGauge) are ready immediately and can never stall
+  // the snapshot.
+  if (timeout.isSome()) {
+    return await(futures.values())
+      .after(timeout.get(), lambda::bind(_snapshotTimeout, futures.values()))
+      .then(lambda::bind(__snapshot, timeout, futures, statistics));
+  } else {
+    return await(futures.values())
+      .then(lambda::bind(__snapshot, timeout, futures, statistics));
+  }
+}
+
+
+list<Future<double>> Registry::_snapshotTimeout(
+    const list<Future<double>>& futures)
+{
+  // Stop waiting for all futures to transition and return a 'ready'
+  // list to proceed handling the request.
+  return futures;
+}
+
+
+Future<hashmap<string, double>> Registry::__snapshot(
+    const Option<Duration>& timeout,
+    const hashmap<string, Future<double>>& metrics,
+    const hashmap<string, Option<Statistics<double>>>& statistics)
+{
+  hashmap<string, double> snapshot;
+
+  foreachpair (const string& key, const Future<double>& value, metrics) {
+    // TODO(dhamon): Maybe add the failure message for this metric to the
+    // response if value.isFailed().
+    if (value.isPending()) {
+      CHECK_SOME(timeout);
+      VLOG(1) << "Exceeded timeout of " << timeout.get()
+              << " when attempting to get metric '" << key << "'";
+    } else if (value.isReady()) {
+      snapshot[key] = value.get();
+    }
+
+    Option<Statistics<double>> statistics_ = statistics.get(key).get();
+
+    if (statistics_.isSome()) {
+      snapshot[key + "/count"] = static_cast<double>(statistics_.get().count);
+      snapshot[key + "/min"] = statistics_.get().min;
+      snapshot[key + "/max"] = statistics_.get().max;
+      snapshot[key + "/p50"] = statistics_.get().p50;
+      snapshot[key + "/p90"] = statistics_.get().p90;
+      snapshot[key + "/p95"] = statistics_.get().p95;
+      snapshot[key + "/p99"] = statistics_.get().p99;
+      snapshot[key + "/p999"] = statistics_.get().p999;
+      snapshot[key + "/p9999"] = statistics_.get().p9999;
+    }
+  }
+
+  return snapshot;
+}
+
+
 MetricsProcess* MetricsProcess::create(
     const Option<string>& authenticationRealm)
 {
@@ -126,53 +249,6 @@ string MetricsProcess::help()
 }
 
 
-Future<Nothing> MetricsProcess::add(Owned<Metric> metric)
-{
-  if (metrics.contains(metric->name())) {
-    return Failure("Metric '" + metric->name() + "' was already added");
-  }
-
-  metrics[metric->name()] = metric;
-  return Nothing();
-}
-
-
-Future<Nothing> MetricsProcess::remove(const string& name)
-{
-  if (!metrics.contains(name)) {
-    return Failure("Metric '" + name + "' not found");
-  }
-
-  metrics.erase(name);
-
-  return Nothing();
-}
-
-
-Future<hashmap<string, double>> MetricsProcess::snapshot(
-    const Option<Duration>& timeout)
-{
-  hashmap<string, Future<double>> futures;
-  hashmap<string, Option<Statistics<double>>> statistics;
-
-  foreachkey (const string& metric, metrics) {
-    CHECK_NOTNULL(metrics[metric].get());
-    futures[metric] = metrics[metric]->value();
-    // TODO(dhamon): It would be nice to compute these asynchronously.
-    statistics[metric] = metrics[metric]->statistics();
-  }
-
-  if (timeout.isSome()) {
-    return await(futures.values())
-      .after(timeout.get(), lambda::bind(_snapshotTimeout, futures.values()))
-      .then(lambda::bind(__snapshot, timeout, futures, statistics));
-  } else {
-    return await(futures.values())
-      .then(lambda::bind(__snapshot, timeout, futures, statistics));
-  }
-}
-
-
 Future<http::Response> MetricsProcess::_snapshot(
     const http::Request& request,
     const Option<string>& /* principal */)
@@ -199,59 +275,17 @@ Future<http::Response> MetricsProcess::_snapshot(
     acquire = limiter.get()->acquire();
   }
 
-  return acquire.then(defer(self(), &Self::snapshot, timeout))
+  // NOTE: the snapshot is assembled straight from the registry, not
+  // via a dispatch to this process, so a backed up metrics process
+  // cannot stall it either.
+  return acquire
+      .then([timeout]() { return registry()->snapshot(timeout); })
       .then([request](const hashmap<string, double>& metrics)
             -> http::Response {
         return http::OK(jsonify(metrics), request.url.query.get("jsonp"));
       });
 }
 
-
-list<Future<double>> MetricsProcess::_snapshotTimeout(
-    const list<Future<double>>& futures)
-{
-  // Stop waiting for all futures to transition and return a 'ready'
-  // list to proceed handling the request.
-  return futures;
-}
-
-
-Future<hashmap<string, double>> MetricsProcess::__snapshot(
-    const Option<Duration>& timeout,
-    const hashmap<string, Future<double>>& metrics,
-    const hashmap<string, Option<Statistics<double>>>& statistics)
-{
-  hashmap<string, double> snapshot;
-
-  foreachpair (const string& key, const Future<double>& value, metrics) {
-    // TODO(dhamon): Maybe add the failure message for this metric to the
-    // response if value.isFailed().
-    if (value.isPending()) {
-      CHECK_SOME(timeout);
-      VLOG(1) << "Exceeded timeout of " << timeout.get()
-              << " when attempting to get metric '" << key << "'";
-    } else if (value.isReady()) {
-      snapshot[key] = value.get();
-    }
-
-    Option<Statistics<double>> statistics_ = statistics.get(key).get();
-
-    if (statistics_.isSome()) {
-      snapshot[key + "/count"] = static_cast<double>(statistics_.get().count);
-      snapshot[key + "/min"] = statistics_.get().min;
-      snapshot[key + "/max"] = statistics_.get().max;
-      snapshot[key + "/p50"] = statistics_.get().p50;
-      snapshot[key + "/p90"] = statistics_.get().p90;
-      snapshot[key + "/p95"] = statistics_.get().p95;
-      snapshot[key + "/p99"] = statistics_.get().p99;
-      snapshot[key + "/p999"] = statistics_.get().p999;
-      snapshot[key + "/p9999"] = statistics_.get().p9999;
-    }
-  }
-
-  return snapshot;
-}
-
 }  // namespace internal {
 
 }  // namespace metrics {
@@ -28,8 +28,10 @@
 
 #include <process/ssl/flags.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/os.hpp>
 #include <stout/strings.hpp>
+#include <stout/synchronized.hpp>
 
 using std::map;
 using std::ostringstream;
@@ -52,6 +54,23 @@ namespace openssl {
 static SSL_CTX* ctx = nullptr;
 
 
+// Bound on the number of TLS sessions cached for resumption, used
+// for both the server side cache inside OpenSSL and our client side
+// cache below. Sized to comfortably hold a session per peer on large
+// clusters; a session is on the order of a few hundred bytes.
+static const size_t SESSION_CACHE_MAX = 1024 * 64;
+
+
+// Cache of client side TLS sessions, keyed by the stringified peer
+// address. OpenSSL only maintains a session cache for the accepting
+// side; for connecting sockets we remember the most recently
+// negotiated session per peer ourselves and attach it to new
+// connections so that re-connects resume with an abbreviated
+// handshake rather than repeating the full key exchange.
+static std::mutex* sessions_mutex = new std::mutex();
+static map<string, SSL_SESSION*>* sessions = new map<string, SSL_SESSION*>();
+
+
 Flags::Flags()
 {
   add(&Flags::enabled,
@@ -368,6 +387,15 @@ void reinitialize()
   // Clean up if we had a previous SSL context object. We want to
   // re-initialize this to get rid of any non-default settings.
   if (ctx != nullptr) {
+    // Sessions negotiated under the previous context cannot be
+    // resumed under the new one, so drop the client side cache.
+    synchronized (*sessions_mutex) {
+      foreachvalue (SSL_SESSION* session, *sessions) {
+        SSL_SESSION_free(session);
+      }
+      sessions->clear();
+    }
+
     SSL_CTX_free(ctx);
     ctx = nullptr;
   }
@@ -378,12 +406,17 @@ void reinitialize()
   CHECK(ctx) << "Failed to create SSL context: "
              << ERR_error_string(ERR_get_error(), nullptr);
 
-  // Disable SSL session caching.
-  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
-
-  // Set a session id to avoid connection termination upon
-  // re-connect. We can use something more relevant when we care
-  // about session caching.
+  // Enable the internal server side session cache so that peers
+  // re-connecting (e.g., an agent after a socket error) can resume
+  // their session with an abbreviated handshake instead of repeating
+  // the full key exchange. Session tickets are enabled by default as
+  // well, covering clients that prefer stateless resumption.
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(ctx, SESSION_CACHE_MAX);
+
+  // Set a session id context to scope the sessions cached above;
+  // resumption attempts on accepting sockets are rejected without
+  // one. The value just needs to be consistent across our sockets.
   const uint64_t session_ctx = 7;
 
   const unsigned char* session_id =
@@ -619,6 +652,54 @@ SSL_CTX* context()
 }
 
 
+void set_client_session(SSL* ssl, const string& peer)
+{
+  synchronized (*sessions_mutex) {
+    map<string, SSL_SESSION*>::const_iterator iterator =
+      sessions->find(peer);
+
+    if (iterator != sessions->end()) {
+      // NOTE: 'SSL_set_session' takes its own reference on the
+      // session, so the cache retains ownership of its copy.
+      SSL_set_session(ssl, iterator->second);
+    }
+  }
+}
+
+
+void cache_client_session(SSL* ssl, const string& peer)
+{
+  // Returns a reference counted handle on the session, or nullptr if
+  // no session was negotiated (e.g., the cipher suite does not
+  // support resumption).
+  SSL_SESSION* session = SSL_get1_session(ssl);
+
+  if (session == nullptr) {
+    return;
+  }
+
+  synchronized (*sessions_mutex) {
+    // Keep the cache bounded; if it fills up with distinct peers we
+    // simply start over, at the cost of one full handshake per peer.
+    if (sessions->size() >= SESSION_CACHE_MAX &&
+        sessions->count(peer) == 0) {
+      foreachvalue (SSL_SESSION* cached, *sessions) {
+        SSL_SESSION_free(cached);
+      }
+      sessions->clear();
+    }
+
+    SSL_SESSION*& cached = (*sessions)[peer];
+
+    if (cached != nullptr) {
+      SSL_SESSION_free(cached);
+    }
+
+    cached = session;
+  }
+}
+
+
 Try<Nothing> verify(
     const SSL* const ssl,
     const Option<string>& hostname,
@@ -56,6 +56,18 @@ void initialize();
 // Returns the _global_ OpenSSL context.
 SSL_CTX* context();
 
+// Attaches the cached TLS session for the given peer (if any) to
+// 'ssl' so that the handshake can attempt an abbreviated resumption
+// instead of a full key exchange. Must be called before the handshake
+// is initiated; if the peer declines the resumption a full handshake
+// is performed as usual.
+void set_client_session(SSL* ssl, const std::string& peer);
+
+// Caches the session negotiated on 'ssl' under the given peer so
+// that subsequent connections to that peer can attempt resumption.
+// Replaces any previously cached session for the peer.
+void cache_client_session(SSL* ssl, const std::string& peer);
+
 // Verify that the hostname is properly associated with the peer
 // certificate associated with the specified SSL connection.
 Try<Nothing> verify(
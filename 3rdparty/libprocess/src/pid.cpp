@@ -23,14 +23,18 @@
 #include <glog/logging.h>
 
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 
 #include <process/pid.hpp>
 #include <process/process.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/net.hpp>
+#include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/synchronized.hpp>
 
 #include "config.hpp"
 
@@ -43,6 +47,36 @@ using std::string;
 
 namespace process {
 
+// Returns a shared descriptor for a parsed id so that the many
+// messages arriving from (or addressed to) the same actor, e.g.,
+// 'master@ip', share one immutable string which the socket and
+// process lookup maps then compare by pointer. The table is bounded
+// because ephemeral ids (latches, one-off processes) would otherwise
+// accumulate in it indefinitely.
+static UPID::ID intern(const std::string& id)
+{
+  static std::mutex* mutex = new std::mutex();
+  static hashmap<std::string, UPID::ID>* ids =
+    new hashmap<std::string, UPID::ID>();
+
+  synchronized (mutex) {
+    Option<UPID::ID> interned = ids->get(id);
+
+    if (interned.isSome()) {
+      return interned.get();
+    }
+
+    if (ids->size() >= 10000) {
+      ids->clear();
+    }
+
+    UPID::ID result(id);
+    ids->put(id, result);
+    return result;
+  }
+}
+
+
 UPID::UPID(const char* s)
 {
   istringstream in(s);
@@ -141,7 +175,7 @@ istream& operator>>(istream& stream, UPID& pid)
     return stream;
   }
 
-  pid.id = id;
+  pid.id = intern(id);
   pid.address = address;
 
   return stream;
@@ -17,6 +17,11 @@
 #include <netinet/tcp.h>
 #endif // __WINDOWS__
 
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
 #include <process/io.hpp>
 #include <process/network.hpp>
 #include <process/socket.hpp>
@@ -201,6 +206,56 @@ Future<size_t> socket_send_data(Socket socket, const char* data, size_t size)
 }
 
 
+#ifndef __WINDOWS__
+// NOTE: we use sendmsg(2) rather than writev(2) since only the former
+// lets us pass MSG_NOSIGNAL (we handle closed sockets via the return
+// value, not SIGPIPE, see socket_send_data above).
+Future<size_t> socket_send_data_scattered(
+    Socket socket,
+    const std::shared_ptr<std::vector<iovec>>& iov)
+{
+  CHECK(!iov->empty());
+
+  while (true) {
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov->data();
+    message.msg_iovlen = iov->size();
+
+    ssize_t length = ::sendmsg(socket.get(), &message, MSG_NOSIGNAL);
+
+    int error = errno;
+
+    if (length < 0 && net::is_restartable_error(error)) {
+      // Interrupted, try again now.
+      continue;
+    } else if (length < 0 && net::is_retryable_error(error)) {
+      // Might block, try again later.
+      return io::poll(socket.get(), io::WRITE)
+        .then(lambda::bind(
+            &internal::socket_send_data_scattered,
+            socket,
+            iov));
+    } else if (length <= 0) {
+      // Socket error or closed.
+      if (length < 0) {
+        const string error = os::strerror(errno);
+        VLOG(1) << "Socket error while sending: " << error;
+        return Failure(ErrnoError("Socket send failed"));
+      } else {
+        VLOG(1) << "Socket closed while sending";
+        return length;
+      }
+    } else {
+      CHECK(length > 0);
+
+      return length;
+    }
+  }
+}
+#endif // __WINDOWS__
+
+
 Future<size_t> socket_send_file(
     Socket socket,
     int fd,
@@ -256,6 +311,25 @@ Future<size_t> PollSocketImpl::send(const char* data, size_t size)
 }
 
 
+#ifndef __WINDOWS__
+Future<size_t> PollSocketImpl::send(const iovec* iov, int iovcnt)
+{
+  CHECK(iovcnt > 0);
+
+  // NOTE: we copy the iovec array since the caller's array need not
+  // outlive the (asynchronous) send.
+  std::shared_ptr<std::vector<iovec>> iov_(
+      new std::vector<iovec>(iov, iov + iovcnt));
+
+  return io::poll(get(), io::WRITE)
+    .then(lambda::bind(
+        &internal::socket_send_data_scattered,
+        socket(),
+        iov_));
+}
+#endif // __WINDOWS__
+
+
 Future<size_t> PollSocketImpl::sendfile(int fd, off_t offset, size_t size)
 {
   return io::poll(get(), io::WRITE)
@@ -34,6 +34,9 @@ public:
   virtual Future<Nothing> connect(const Address& address);
   virtual Future<size_t> recv(char* data, size_t size);
   virtual Future<size_t> send(const char* data, size_t size);
+#ifndef __WINDOWS__
+  virtual Future<size_t> send(const iovec* iov, int iovcnt);
+#endif // __WINDOWS__
   virtual Future<size_t> sendfile(int fd, off_t offset, size_t size);
 
   virtual Socket::Kind kind() const { return Socket::POLL; }
@@ -15,6 +15,10 @@
 #ifndef __WINDOWS__
 #include <netdb.h>
 #endif // __WINDOWS__
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
 #include <signal.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -43,6 +47,7 @@
 #endif // __WINDOWS__
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <fstream>
 #include <iomanip>
@@ -86,12 +91,14 @@
 #include <process/time.hpp>
 #include <process/timer.hpp>
 
+#include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
 
 #include <process/ssl/flags.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/foreach.hpp>
+#include <stout/gzip.hpp>
 #include <stout/lambda.hpp>
 #include <stout/net.hpp>
 #include <stout/numify.hpp>
@@ -99,6 +106,8 @@
 #include <stout/os.hpp>
 #include <stout/os/strerror.hpp>
 #include <stout/path.hpp>
+#include <stout/result.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 #include <stout/synchronized.hpp>
 #include <stout/thread_local.hpp>
@@ -234,6 +243,10 @@ private:
   queue<Item*> items;
 
   Option<http::Pipe::Reader> pipe; // Current pipe, if streaming.
+
+  // Current streaming compressor, if the client negotiated
+  // "Accept-Encoding: gzip" for a streaming response.
+  Owned<gzip::Compressor> compressor;
 };
 
 
@@ -287,6 +300,292 @@ private:
 };
 
 
+// The trace id of the event currently being served on this worker
+// thread, or 0 if the event being served (if any) is not traced. Used
+// by the Tracer to stitch dispatch chains together (see below).
+static THREAD_LOCAL uint64_t __trace__ = 0;
+
+
+// A sampling tracer for dispatch chains: every Nth dispatch that is
+// not already part of a trace gets tagged with a fresh trace id, and
+// every dispatch made while serving a traced event inherits that
+// event's id, so all the hops caused by a sampled dispatch share one
+// id. Each served hop records its queue and execution time into a
+// fixed size ring buffer which the /__traces__ endpoint renders as
+// JSON, so master latency can be attributed to a specific chain of
+// dispatches. Sampling is off unless the operator sets
+// LIBPROCESS_DISPATCH_TRACE_INTERVAL=N (sample every Nth dispatch);
+// when a dispatch is not sampled the only overhead is one relaxed
+// counter increment.
+class Tracer
+{
+public:
+  Tracer()
+    : interval(0),
+      counter(0),
+      ids(0),
+      index(0),
+      records(CAPACITY)
+  {
+    constexpr char env_var[] = "LIBPROCESS_DISPATCH_TRACE_INTERVAL";
+    Option<string> value = os::getenv(env_var);
+    if (value.isSome()) {
+      Try<size_t> number = numify<size_t>(value.get().c_str());
+      if (number.isSome()) {
+        interval = number.get();
+      } else {
+        LOG(WARNING) << "Ignoring invalid value " << value.get()
+                     << " for " << env_var
+                     << ", dispatch tracing is disabled."
+                     << " Valid values are non-negative integers";
+      }
+    }
+  }
+
+  // Returns the trace id a new dispatch should carry: the id of the
+  // trace currently being served if there is one, a fresh id for
+  // every 'interval'th dispatch otherwise, or 0 (not traced).
+  uint64_t sample()
+  {
+    if (interval == 0) {
+      return 0;
+    }
+
+    if (__trace__ != 0) {
+      return __trace__;
+    }
+
+    if (counter.fetch_add(1, std::memory_order_relaxed) % interval != 0) {
+      return 0;
+    }
+
+    return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  // Records one served hop of the specified trace. Only called for
+  // traced (i.e., rare) events so taking the lock is cheap.
+  void record(
+      uint64_t trace,
+      const UPID& pid,
+      const Duration& queued,
+      const Duration& execution)
+  {
+    synchronized (mutex) {
+      Record& record = records[index++ % CAPACITY];
+      record.trace = trace;
+      record.process = pid.id;
+      record.time = Clock::now();
+      record.queued = queued;
+      record.execution = execution;
+    }
+  }
+
+  // The /__traces__ route: the recorded hops, oldest first.
+  Future<Response> traces(const Request& request)
+  {
+    JSON::Array array;
+
+    synchronized (mutex) {
+      size_t start = index > CAPACITY ? index - CAPACITY : 0;
+
+      for (size_t i = start; i < index; i++) {
+        const Record& record = records[i % CAPACITY];
+
+        JSON::Object object;
+        object.values["trace"] = record.trace;
+        object.values["process"] = record.process;
+        object.values["time_secs"] = record.time.secs();
+        object.values["queued_us"] = record.queued.us();
+        object.values["execution_us"] = record.execution.us();
+
+        array.values.push_back(object);
+      }
+    }
+
+    return OK(array, request.url.query.get("jsonp"));
+  }
+
+private:
+  struct Record
+  {
+    uint64_t trace;
+    std::string process;
+    Time time;
+    Duration queued;
+    Duration execution;
+  };
+
+  static const size_t CAPACITY = 4096;
+
+  // Sample every 'interval'th dispatch; 0 disables tracing.
+  size_t interval;
+
+  // Number of sampling decisions made, for the 1 in 'interval'
+  // sampling.
+  std::atomic<uint64_t> counter;
+
+  // The last trace id handed out.
+  std::atomic<uint64_t> ids;
+
+  // Guards the ring buffer.
+  std::mutex mutex;
+
+  // Total number of records written; 'index % CAPACITY' is the next
+  // slot to (over)write.
+  size_t index;
+
+  std::vector<Record> records;
+};
+
+
+// An always-on watchdog for slow handlers: any event whose handler
+// runs longer than a threshold is recorded (process, a description of
+// the event, execution time and the number of events that were
+// pending when the handler started) into a fixed size ring buffer
+// which the /__slow__ endpoint renders as JSON, so a multi-second
+// handler can be identified after the fact without attaching a
+// profiler. The threshold defaults to 500ms and can be changed with
+// LIBPROCESS_SLOW_DISPATCH_THRESHOLD_MS (0 disables the watchdog);
+// handlers below the threshold only pay for reading the stopwatch
+// that ProcessManager::resume maintains anyway.
+class SlowDispatchWatchdog
+{
+public:
+  SlowDispatchWatchdog()
+    : threshold(Milliseconds(500)),
+      index(0),
+      records(CAPACITY)
+  {
+    constexpr char env_var[] = "LIBPROCESS_SLOW_DISPATCH_THRESHOLD_MS";
+    Option<string> value = os::getenv(env_var);
+    if (value.isSome()) {
+      Try<size_t> number = numify<size_t>(value.get().c_str());
+      if (number.isSome()) {
+        threshold = Milliseconds(number.get());
+      } else {
+        LOG(WARNING) << "Ignoring invalid value " << value.get()
+                     << " for " << env_var
+                     << ", using default value " << threshold
+                     << ". Valid values are non-negative integers";
+      }
+    }
+  }
+
+  // Whether the specified handler execution time should be recorded.
+  bool exceeded(const Duration& execution) const
+  {
+    return threshold > Duration::zero() && execution >= threshold;
+  }
+
+  // Records one slow handler. Only called for handlers that already
+  // ran for at least the threshold, so taking the lock is noise in
+  // comparison.
+  void record(
+      const UPID& pid,
+      const Event& event,
+      const Duration& execution,
+      size_t pending)
+  {
+    synchronized (mutex) {
+      Record& record = records[index++ % CAPACITY];
+      record.process = pid.id;
+      record.event = describe(event);
+      record.time = Clock::now();
+      record.execution = execution;
+      record.pending = pending;
+    }
+  }
+
+  // The /__slow__ route: the recorded slow handlers, oldest first.
+  Future<Response> slow(const Request& request)
+  {
+    JSON::Array array;
+
+    synchronized (mutex) {
+      size_t start = index > CAPACITY ? index - CAPACITY : 0;
+
+      for (size_t i = start; i < index; i++) {
+        const Record& record = records[i % CAPACITY];
+
+        JSON::Object object;
+        object.values["process"] = record.process;
+        object.values["event"] = record.event;
+        object.values["time_secs"] = record.time.secs();
+        object.values["execution_us"] = record.execution.us();
+        object.values["pending"] = record.pending;
+
+        array.values.push_back(object);
+      }
+    }
+
+    return OK(array, request.url.query.get("jsonp"));
+  }
+
+private:
+  // Returns a human readable identification of the event's handler,
+  // e.g., the dispatched method or the message name.
+  static std::string describe(const Event& event)
+  {
+    struct DescribeVisitor : EventVisitor
+    {
+      virtual void visit(const MessageEvent& event)
+      {
+        description = "message '" + event.message->name + "'";
+      }
+
+      virtual void visit(const DispatchEvent& event)
+      {
+        description = event.functionType.isSome()
+          ? "dispatch '" + std::string(event.functionType.get()->name()) + "'"
+          : "dispatch";
+      }
+
+      virtual void visit(const HttpEvent& event)
+      {
+        description =
+          "http '" + event.request->method + " " +
+          event.request->url.path + "'";
+      }
+
+      virtual void visit(const ExitedEvent& event)
+      {
+        description = "exited '" + event.pid.id + "'";
+      }
+
+      std::string description = "event";
+    } visitor;
+
+    event.visit(&visitor);
+
+    return visitor.description;
+  }
+
+  struct Record
+  {
+    std::string process;
+    std::string event;
+    Time time;
+    Duration execution;
+    size_t pending;
+  };
+
+  static const size_t CAPACITY = 1024;
+
+  // Handlers running at least this long are recorded; zero disables
+  // the watchdog.
+  Duration threshold;
+
+  // Guards the ring buffer.
+  std::mutex mutex;
+
+  // Total number of records written; 'index % CAPACITY' is the next
+  // slot to (over)write.
+  size_t index;
+
+  std::vector<Record> records;
+};
+
+
 class SocketManager
 {
 public:
@@ -325,6 +624,19 @@ public:
 
   Encoder* next(int s);
 
+#ifndef __WINDOWS__
+  // Dequeues up to 'limit' additional DATA encoders queued on the
+  // socket so that they can get coalesced into a single scatter
+  // gather send (see internal::sendv).
+  std::deque<Encoder*> gather(int s, size_t limit);
+#endif // __WINDOWS__
+
+  // Metrics on the outgoing queues (see SocketManagerMetrics): the
+  // total number of queued messages and the depth of the deepest
+  // queue, across all sockets.
+  size_t queued();
+  size_t max_queue_depth();
+
   void close(int s);
 
   void exited(const Address& address);
@@ -448,7 +760,7 @@ public:
   string absolutePath(const string& path);
 
   void enqueue(ProcessBase* process);
-  ProcessBase* dequeue();
+  ProcessBase* dequeue(size_t id);
 
   void settle();
 
@@ -466,9 +778,23 @@ private:
   // Gates for waiting threads (protected by processes_mutex).
   map<ProcessBase*, Gate*> gates;
 
-  // Queue of runnable processes (implemented using list).
-  list<ProcessBase*> runq;
-  std::recursive_mutex runq_mutex;
+  // Per worker thread queue of runnable processes. Each queue is
+  // guarded by its own mutex rather than having a single global run
+  // queue and lock that every worker thread contends on for every
+  // enqueue/dequeue: a worker thread enqueues and dequeues on its own
+  // queue in the common case (so the lock is almost always
+  // uncontended) and only touches the other queues when stealing.
+  struct RunQueue
+  {
+    std::deque<ProcessBase*> processes;
+    std::mutex mutex;
+  };
+
+  std::vector<RunQueue*> runqs;
+
+  // Used to pick a run queue (round-robin) for enqueues that don't
+  // originate from a worker thread.
+  std::atomic_size_t next_runq;
 
   // Number of running processes, to support Clock::settle operation.
   std::atomic_long running;
@@ -530,6 +856,14 @@ static AuthorizationCallbacks* authorization_callbacks = nullptr;
 // Global route that returns process information.
 static Route* processes_route = nullptr;
 
+// Global dispatch chain tracer and its route.
+static Tracer* tracer = nullptr;
+static Route* traces_route = nullptr;
+
+// Global slow handler watchdog and its route.
+static SlowDispatchWatchdog* watchdog = nullptr;
+static Route* slow_route = nullptr;
+
 // Filter. Synchronized support for using the filterer needs to be
 // recursive in case a filterer wants to do anything fancy (which is
 // possible and likely given that filters will get used for testing).
@@ -548,6 +882,10 @@ PID<Logging> _logging;
 // Per thread process pointer.
 THREAD_LOCAL ProcessBase* __process__ = nullptr;
 
+// Index of this thread's run queue, or -1 if this thread is not a
+// worker thread (e.g., a thread calling in to libprocess).
+static THREAD_LOCAL long __worker_id__ = -1;
+
 // Per thread executor pointer.
 THREAD_LOCAL Executor* _executor_ = nullptr;
 
@@ -566,6 +904,54 @@ PID<process::internal::ReaperProcess> reaper;
 } // namespace internal {
 
 
+// Exposes metrics about the SocketManager, e.g., the depth of the
+// outgoing message queues. This is started by default during the
+// initialization of libprocess (like the System process for system
+// metrics).
+class SocketManagerMetrics : public Process<SocketManagerMetrics>
+{
+public:
+  SocketManagerMetrics()
+    : ProcessBase("socket_manager"),
+      queued_messages(
+          self().id + "/queued_messages",
+          defer(self(), &SocketManagerMetrics::_queued_messages)),
+      max_queue_depth(
+          self().id + "/max_queue_depth",
+          defer(self(), &SocketManagerMetrics::_max_queue_depth)) {}
+
+  virtual ~SocketManagerMetrics() {}
+
+protected:
+  virtual void initialize()
+  {
+    metrics::add(queued_messages);
+    metrics::add(max_queue_depth);
+  }
+
+  virtual void finalize()
+  {
+    metrics::remove(queued_messages);
+    metrics::remove(max_queue_depth);
+  }
+
+private:
+  // Gauge handlers.
+  Future<double> _queued_messages()
+  {
+    return static_cast<double>(socket_manager->queued());
+  }
+
+  Future<double> _max_queue_depth()
+  {
+    return static_cast<double>(socket_manager->max_queue_depth());
+  }
+
+  metrics::Gauge queued_messages;
+  metrics::Gauge max_queue_depth;
+};
+
+
 namespace http {
 
 namespace authentication {
@@ -724,64 +1110,120 @@ static Message* parse(Request* request)
 
 namespace internal {
 
-void decode_recv(
-    const Future<size_t>& length,
-    char* data,
-    size_t size,
-    Socket socket,
-    DataDecoder* decoder)
+// Reads and decodes the HTTP requests arriving on an accepted socket
+// and hands them to the process manager. Decoding happens within
+// this process, i.e., on the worker threads, so that parsing a large
+// request body (e.g., an operator API call) does not stall the event
+// loop thread, which only performs the raw reads into the buffer.
+class DecoderProcess : public Process<DecoderProcess>
 {
-  if (length.isDiscarded() || length.isFailed()) {
-    if (length.isFailed()) {
-      VLOG(1) << "Decode failure: " << length.failure();
-    }
+public:
+  explicit DecoderProcess(const Socket& _socket)
+    : ProcessBase(ID::generate("__decoder__")),
+      socket(_socket),
+      decoder(_socket),
+      data(new char[SIZE]) {}
 
-    socket_manager->close(socket);
+  virtual ~DecoderProcess()
+  {
     delete[] data;
-    delete decoder;
-    return;
   }
 
-  if (length.get() == 0) {
-    socket_manager->close(socket);
-    delete[] data;
-    delete decoder;
-    return;
+protected:
+  virtual void initialize()
+  {
+    recv();
   }
 
-  // Decode as much of the data as possible into HTTP requests.
-  const deque<Request*> requests = decoder->decode(data, length.get());
+private:
+  static const size_t SIZE = 80 * 1024;
 
-  if (requests.empty() && decoder->failed()) {
-     VLOG(1) << "Decoder error while receiving";
-     socket_manager->close(socket);
-     delete[] data;
-     delete decoder;
-     return;
+  void recv()
+  {
+    socket.recv(data, SIZE)
+      .onAny(defer(self(), &DecoderProcess::_recv, lambda::_1));
   }
 
-  if (!requests.empty()) {
-    // Get the peer address to augment the requests.
-    Try<Address> address = socket.peer();
+  void _recv(const Future<size_t>& length)
+  {
+    if (length.isDiscarded() || length.isFailed()) {
+      if (length.isFailed()) {
+        VLOG(1) << "Decode failure: " << length.failure();
+      }
+
+      socket_manager->close(socket);
+      terminate(self());
+      return;
+    }
 
-    if (address.isError()) {
-      VLOG(1) << "Failed to get peer address while receiving: "
-              << address.error();
+    if (length.get() == 0) {
       socket_manager->close(socket);
-      delete[] data;
-      delete decoder;
+      terminate(self());
       return;
     }
 
-    foreach (Request* request, requests) {
-      request->client = address.get();
-      process_manager->handle(decoder->socket(), request);
+    // Decode as much of the data as possible into HTTP requests.
+    const deque<Request*> requests = decoder.decode(data, length.get());
+
+    if (requests.empty() && decoder.failed()) {
+      VLOG(1) << "Decoder error while receiving";
+      socket_manager->close(socket);
+      terminate(self());
+      return;
+    }
+
+    if (!requests.empty()) {
+      // Get the peer address to augment the requests.
+      Try<Address> address = socket.peer();
+
+      if (address.isError()) {
+        VLOG(1) << "Failed to get peer address while receiving: "
+                << address.error();
+        socket_manager->close(socket);
+        terminate(self());
+        return;
+      }
+
+      // Remember the receiver of the last request so we can apply
+      // backpressure below (the path is "/id/...", see
+      // ProcessManager::handle). NOTE: 'handle' takes ownership of
+      // the requests so we must extract this first.
+      vector<string> tokens =
+        strings::tokenize(requests.back()->url.path, "/");
+
+      Option<string> receiver;
+      if (!tokens.empty()) {
+        receiver = tokens[0];
+      }
+
+      foreach (Request* request, requests) {
+        request->client = address.get();
+        process_manager->handle(socket, request);
+      }
+
+      // Backpressure: if the receiver has a mailbox limit and is over
+      // it, stop reading from this socket until its mailbox drains,
+      // translating the overload into TCP-level pushback on the
+      // sender instead of buffering events without bound.
+      if (receiver.isSome()) {
+        if (ProcessReference reference =
+              process_manager->use(UPID(receiver.get(), __address__))) {
+          if (reference->congested()) {
+            reference->drained()
+              .onAny(defer(self(), &DecoderProcess::recv));
+            return;
+          }
+        }
+      }
     }
+
+    recv();
   }
 
-  socket.recv(data, size)
-    .onAny(lambda::bind(&decode_recv, lambda::_1, data, size, socket, decoder));
-}
+  Socket socket;
+  DataDecoder decoder;
+  char* data;
+};
 
 } // namespace internal {
 
@@ -799,10 +1241,39 @@ void timedout(const list<Timer>& timers)
     }
   }
 
-  // Invoke the timers that timed out (TODO(benh): Do this
-  // asynchronously so that we don't tie up the event thread!).
+  // Group the expired timers by the process that created them so
+  // that when many timers expire in a single tick (e.g., an offer
+  // filter expiry storm) we can deliver them to their process as a
+  // single batched dispatch rather than tying up the event loop
+  // thread constructing and enqueuing one event per timer.
+  hashmap<UPID, vector<Timer>> batches;
+
   foreach (const Timer& timer, timers) {
-    timer();
+    batches[timer.creator()].push_back(timer);
+  }
+
+  foreachpair (const UPID& pid, const vector<Timer>& batch, batches) {
+    // Invoke singleton batches and timers without a (running)
+    // creator inline, as we always have. Note that this means the
+    // thunks of a batch destined for a process that is terminating
+    // may get dropped with the batch, but the messages they would
+    // have dispatched to that process would have been dropped
+    // regardless.
+    if (batch.size() > 1 && pid != UPID() && process_manager->use(pid)) {
+      std::shared_ptr<lambda::function<void(ProcessBase*)>> f(
+          new lambda::function<void(ProcessBase*)>(
+              [batch](ProcessBase*) {
+                foreach (const Timer& timer, batch) {
+                  timer();
+                }
+              }));
+
+      internal::dispatch(pid, f);
+    } else {
+      foreach (const Timer& timer, batch) {
+        timer();
+      }
+    }
   }
 }
 
@@ -832,19 +1303,9 @@ void on_accept(const Future<Socket>& socket)
     // Inform the socket manager for proper bookkeeping.
     socket_manager->accepted(socket.get());
 
-    const size_t size = 80 * 1024;
-    char* data = new char[size];
-
-    DataDecoder* decoder = new DataDecoder(socket.get());
-
-    socket.get().recv(data, size)
-      .onAny(lambda::bind(
-          &internal::decode_recv,
-          lambda::_1,
-          data,
-          size,
-          socket.get(),
-          decoder));
+    // The process reads and decodes the requests arriving on the
+    // socket and cleans itself up once the connection closes.
+    spawn(new DecoderProcess(socket.get()), true);
   }
 
   // NOTE: `__s__` may be cleaned up during `process::finalize`.
@@ -1137,6 +1598,9 @@ bool initialize(
   // Create the global system statistics process.
   spawn(new System(), true);
 
+  // Create the process exposing the socket manager metrics.
+  spawn(new SocketManagerMetrics(), true);
+
   // Create the global HTTP authentication router.
   authenticator_manager = new AuthenticatorManager();
 
@@ -1153,6 +1617,22 @@ bool initialize(
 
   processes_route = new Route("/__processes__", None(), __processes__);
 
+  // Add a route for the sampled dispatch traces.
+  tracer = new Tracer();
+
+  lambda::function<Future<Response>(const Request&)> __traces__ =
+    lambda::bind(&Tracer::traces, tracer, lambda::_1);
+
+  traces_route = new Route("/__traces__", None(), __traces__);
+
+  // Add a route for the recorded slow handlers.
+  watchdog = new SlowDispatchWatchdog();
+
+  lambda::function<Future<Response>(const Request&)> __slow__ =
+    lambda::bind(&SlowDispatchWatchdog::slow, watchdog, lambda::_1);
+
+  slow_route = new Route("/__slow__", None(), __slow__);
+
   VLOG(1) << "libprocess is initialized on " << address() << " with "
           << num_worker_threads << " worker threads";
 
@@ -1170,7 +1650,13 @@ void finalize()
   // waits during clean up, so we make sure the clock is running normally.
   Clock::resume();
 
-  // This will terminate the underlying process for the `Route`.
+  // This will terminate the underlying processes for the `Route`s.
+  delete slow_route;
+  slow_route = nullptr;
+
+  delete traces_route;
+  traces_route = nullptr;
+
   delete processes_route;
   processes_route = nullptr;
 
@@ -1180,6 +1666,15 @@ void finalize()
   // libprocess should be single-threaded.
   process_manager->finalize();
 
+  // NOTE: deleted after the `ProcessManager` since worker threads
+  // serving the last events may still record traced hops and slow
+  // handlers.
+  delete tracer;
+  tracer = nullptr;
+
+  delete watchdog;
+  watchdog = nullptr;
+
   // This clears any remaining timers. Because the event loop has been
   // stopped, no timers will fire.
   Clock::finalize();
@@ -1340,6 +1835,77 @@ void HttpProxy::waited(const Future<Response>& future)
 }
 
 
+// A single byte range of a 'Range' request header, resolved against
+// the size of the requested file.
+struct ByteRange
+{
+  off_t offset;
+  size_t length;
+};
+
+
+// Parses a 'Range' header of the form "bytes=N-M", "bytes=N-" or
+// "bytes=-N" against a file of 'size' bytes. Returns None if the
+// header does not hold a single byte range (in which case the whole
+// file should be sent, as RFC 7233 recommends for ranges that cannot
+// be interpreted), and an Error if the range is syntactically valid
+// but not satisfiable for the given file size.
+static Result<ByteRange> parseRange(const string& value, off_t size)
+{
+  if (!strings::startsWith(value, "bytes=")) {
+    return None();
+  }
+
+  const string spec = strings::trim(value.substr(strlen("bytes=")));
+
+  // Multiple ranges are not supported.
+  if (strings::contains(spec, ",")) {
+    return None();
+  }
+
+  vector<string> tokens = strings::split(spec, "-", 2);
+  if (tokens.size() != 2) {
+    return None();
+  }
+
+  if (tokens[0].empty()) {
+    // A suffix range, i.e., the last N bytes of the file.
+    Try<off_t> suffix = numify<off_t>(tokens[1]);
+    if (suffix.isError() || suffix.get() < 0) {
+      return None();
+    }
+
+    if (suffix.get() == 0) {
+      return Error("Unsatisfiable byte range");
+    }
+
+    off_t length = std::min(suffix.get(), size);
+    return ByteRange{size - length, static_cast<size_t>(length)};
+  }
+
+  Try<off_t> start = numify<off_t>(tokens[0]);
+  if (start.isError() || start.get() < 0) {
+    return None();
+  }
+
+  if (start.get() >= size) {
+    return Error("Unsatisfiable byte range");
+  }
+
+  off_t end = size - 1;
+  if (!tokens[1].empty()) {
+    Try<off_t> last = numify<off_t>(tokens[1]);
+    if (last.isError() || last.get() < start.get()) {
+      return None();
+    }
+
+    end = std::min(last.get(), size - 1);
+  }
+
+  return ByteRange{start.get(), static_cast<size_t>(end - start.get() + 1)};
+}
+
+
 bool HttpProxy::process(const Future<Response>& future, const Request& request)
 {
   if (!future.isReady()) {
@@ -1401,7 +1967,49 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
           return true; // All done, can process next request.
         }
 
-        VLOG(1) << "Sending file at '" << path << "' with length " << s.st_size;
+        // We support single byte ranges so that clients can resume
+        // or parallelize large downloads; the selected range, like
+        // the whole file, is sent straight from the file descriptor
+        // (i.e., via sendfile where supported).
+        response.headers["Accept-Ranges"] = "bytes";
+
+        off_t offset = 0;
+        size_t length = s.st_size;
+
+        Option<string> range = request.headers.get("Range");
+        if (range.isSome()) {
+          Result<ByteRange> parsed = parseRange(range.get(), s.st_size);
+          if (parsed.isError()) {
+            os::close(fd);
+
+            VLOG(1) << "Returning '416 Requested Range Not Satisfiable' for"
+                    << " range '" << range.get() << "' of file at '"
+                    << path << "'";
+
+            Response notSatisfiable = Response(
+                http::Status::REQUESTED_RANGE_NOT_SATISFIABLE);
+
+            notSatisfiable.headers["Content-Range"] =
+              "bytes */" + stringify(s.st_size);
+
+            socket_manager->send(notSatisfiable, request, socket);
+            return true; // All done, can process next request.
+          } else if (parsed.isSome()) {
+            offset = parsed->offset;
+            length = parsed->length;
+
+            response.code = http::Status::PARTIAL_CONTENT;
+            response.status = http::Status::string(response.code);
+
+            response.headers["Content-Range"] =
+              "bytes " + stringify(offset) + "-" +
+              stringify(offset + length - 1) + "/" + stringify(s.st_size);
+
+            response.headers["Content-Length"] = stringify(length);
+          }
+        }
+
+        VLOG(1) << "Sending file at '" << path << "' with length " << length;
 
         // TODO(benh): Consider a way to have the socket manager turn
         // on TCP_CORK for both sends and then turn it off.
@@ -1411,7 +2019,7 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
 
         // Note the file descriptor gets closed by FileEncoder.
         socket_manager->send(
-            new FileEncoder(socket, fd, s.st_size),
+            new FileEncoder(socket, fd, length, offset),
             request.keepAlive);
       }
     }
@@ -1424,6 +2032,15 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
     // header, we fill in (or overwrite) 'Transfer-Encoding' header.
     response.headers["Transfer-Encoding"] = "chunked";
 
+    // Negotiate streaming compression: if the client accepts gzip
+    // and the response is not already encoded, each chunk is
+    // compressed as it is streamed.
+    if (!response.headers.contains("Content-Encoding") &&
+        request.acceptsEncoding("gzip")) {
+      response.headers["Content-Encoding"] = "gzip";
+      compressor = Owned<gzip::Compressor>(new gzip::Compressor());
+    }
+
     VLOG(3) << "Starting \"chunked\" streaming";
 
     socket_manager->send(
@@ -1468,23 +2085,60 @@ void HttpProxy::stream(
     std::ostringstream out;
 
     if (chunk.get().empty()) {
-      // Finished reading.
+      // Finished reading; flush the remaining compressed data (and
+      // the gzip trailer) before terminating the chunked body.
+      if (compressor.get() != nullptr) {
+        Try<string> compressed = compressor->finalize();
+        if (compressed.isError()) {
+          // The response headers have already been sent, so all we
+          // can do is terminate the stream.
+          VLOG(1) << "Failed to finalize gzip stream: " << compressed.error();
+        } else if (!compressed.get().empty()) {
+          out << std::hex << compressed.get().size() << "\r\n";
+          out << compressed.get();
+          out << "\r\n";
+        }
+      }
+
       out << "0\r\n" << "\r\n";
       finished = true;
     } else {
-      out << std::hex << chunk.get().size() << "\r\n";
-      out << chunk.get();
-      out << "\r\n";
+      string data = chunk.get();
+
+      if (compressor.get() != nullptr) {
+        Try<string> compressed = compressor->compress(data);
+        if (compressed.isError()) {
+          // As above, the response headers have already been sent,
+          // so all we can do is terminate the stream.
+          VLOG(1) << "Failed to gzip chunk: " << compressed.error();
+          out << "0\r\n" << "\r\n";
+          finished = true;
+        } else {
+          data = compressed.get();
+        }
+      }
+
+      if (!finished) {
+        // NOTE: The compressor may buffer the input without emitting
+        // any output yet, in which case there is nothing to send.
+        if (!data.empty()) {
+          out << std::hex << data.size() << "\r\n";
+          out << data;
+          out << "\r\n";
+        }
 
-      // Keep reading.
-      reader.read()
-        .onAny(defer(self(), &Self::stream, request, lambda::_1));
+        // Keep reading.
+        reader.read()
+          .onAny(defer(self(), &Self::stream, request, lambda::_1));
+      }
     }
 
     // Always persist the connection when streaming is not finished.
-    socket_manager->send(
-        new DataEncoder(socket, out.str()),
-        finished ? request->keepAlive : true);
+    if (!out.str().empty() || finished) {
+      socket_manager->send(
+          new DataEncoder(socket, out.str()),
+          finished ? request->keepAlive : true);
+    }
   } else if (chunk.isFailed()) {
     VLOG(1) << "Failed to read from stream: " << chunk.failure();
     // TODO(bmahler): Have to close connection if headers were sent!
@@ -1500,6 +2154,7 @@ void HttpProxy::stream(
   if (finished) {
     reader.close();
     pipe = None();
+    compressor.reset();
     next();
   }
 }
@@ -1884,10 +2539,75 @@ void _send(
     size_t size);
 
 
+#ifndef __WINDOWS__
+// The maximum number of encoders that get coalesced into a single
+// scatter gather send, and the maximum number of buffers handed to
+// the kernel in that send (a MessageEncoder has at most 3 segments:
+// the header, the body and the chunk trailer).
+static const size_t MAX_SEND_ENCODERS = 16;
+static const size_t MAX_SEND_IOVECS = 64;
+
+
+void _sendv(
+    const Future<size_t>& result,
+    Socket socket,
+    deque<Encoder*> encoders,
+    deque<size_t> sizes,
+    size_t size);
+
+
+// Sends the remaining data of the specified encoders with a single
+// scatter gather send, coalescing any further DATA encoders queued
+// behind them on the socket. This way a link carrying many small
+// messages (e.g., status updates flowing from an agent to the
+// master) goes out with one system call per batch rather than one
+// per message.
+void sendv(deque<Encoder*>&& encoders, Socket socket)
+{
+  CHECK(!encoders.empty());
+
+  if (encoders.size() < MAX_SEND_ENCODERS) {
+    deque<Encoder*> more =
+      socket_manager->gather(socket, MAX_SEND_ENCODERS - encoders.size());
+
+    encoders.insert(encoders.end(), more.begin(), more.end());
+  }
+
+  iovec iov[MAX_SEND_IOVECS];
+  size_t iovcnt = 0;
+  size_t size = 0;
+
+  // How many bytes of each encoder's data are included in the send,
+  // needed to correctly back the encoders up in case of a partial
+  // send. NOTE: should the buffers run out the leftover encoders
+  // simply contribute nothing and go out with a subsequent send.
+  deque<size_t> sizes;
+
+  foreach (Encoder* encoder, encoders) {
+    size_t length = 0;
+    iovcnt += static_cast<DataEncoder*>(encoder)->next(
+        iov + iovcnt, MAX_SEND_IOVECS - iovcnt, &length);
+    sizes.push_back(length);
+    size += length;
+  }
+
+  socket.send(iov, static_cast<int>(iovcnt))
+    .onAny(lambda::bind(
+        &internal::_sendv,
+        lambda::_1,
+        socket,
+        encoders,
+        sizes,
+        size));
+}
+#endif // __WINDOWS__
+
+
 void send(Encoder* encoder, Socket socket)
 {
   switch (encoder->kind()) {
     case Encoder::DATA: {
+#ifdef __WINDOWS__
       size_t size;
       const char* data = static_cast<DataEncoder*>(encoder)->next(&size);
       socket.send(data, size)
@@ -1897,6 +2617,11 @@ void send(Encoder* encoder, Socket socket)
             socket,
             encoder,
             size));
+#else
+      deque<Encoder*> encoders;
+      encoders.push_back(encoder);
+      sendv(std::move(encoders), socket);
+#endif // __WINDOWS__
       break;
     }
     case Encoder::FILE: {
@@ -1944,6 +2669,54 @@ void _send(
   }
 }
 
+
+#ifndef __WINDOWS__
+void _sendv(
+    const Future<size_t>& length,
+    Socket socket,
+    deque<Encoder*> encoders,
+    deque<size_t> sizes,
+    size_t size)
+{
+  if (length.isDiscarded() || length.isFailed()) {
+    socket_manager->close(socket);
+    foreach (Encoder* encoder, encoders) {
+      delete encoder;
+    }
+    return;
+  }
+
+  // Update the encoders with the amount sent. The data went out in
+  // order, so back up from the last encoder by however much of its
+  // contribution did not make it out.
+  size_t remaining = size - length.get();
+
+  for (size_t i = encoders.size(); i-- > 0 && remaining > 0;) {
+    size_t backup = std::min(remaining, sizes[i]);
+    encoders[i]->backup(backup);
+    remaining -= backup;
+  }
+
+  // Release the encoders that are completely sent.
+  while (!encoders.empty() && encoders.front()->remaining() == 0) {
+    delete encoders.front();
+    encoders.pop_front();
+  }
+
+  // See if there is any more of the messages to send.
+  if (!encoders.empty()) {
+    sendv(std::move(encoders), socket);
+    return;
+  }
+
+  // Check for more stuff to send on socket.
+  Encoder* next = socket_manager->next(socket);
+  if (next != nullptr) {
+    send(next, socket);
+  }
+}
+#endif // __WINDOWS__
+
 } // namespace internal {
 
 
@@ -2247,6 +3020,58 @@ Encoder* SocketManager::next(int s)
 }
 
 
+#ifndef __WINDOWS__
+deque<Encoder*> SocketManager::gather(int s, size_t limit)
+{
+  deque<Encoder*> encoders;
+
+  synchronized (mutex) {
+    if (outgoing.count(s) > 0) {
+      // NOTE: we stop at a FILE encoder since those can not get
+      // scatter gathered; it will get picked up by 'next' once the
+      // coalesced sends in front of it complete.
+      while (encoders.size() < limit &&
+             !outgoing[s].empty() &&
+             outgoing[s].front()->kind() == Encoder::DATA) {
+        encoders.push_back(outgoing[s].front());
+        outgoing[s].pop();
+      }
+    }
+  }
+
+  return encoders;
+}
+#endif // __WINDOWS__
+
+
+size_t SocketManager::queued()
+{
+  size_t count = 0;
+
+  synchronized (mutex) {
+    foreachvalue (const queue<Encoder*>& encoders, outgoing) {
+      count += encoders.size();
+    }
+  }
+
+  return count;
+}
+
+
+size_t SocketManager::max_queue_depth()
+{
+  size_t depth = 0;
+
+  synchronized (mutex) {
+    foreachvalue (const queue<Encoder*>& encoders, outgoing) {
+      depth = std::max(depth, encoders.size());
+    }
+  }
+
+  return depth;
+}
+
+
 void SocketManager::close(int s)
 {
   Option<UPID> proxy; // Some if an `HttpProxy` needs to be terminated.
@@ -2480,27 +3305,190 @@ void SocketManager::swap_implementing_socket(
       // No need to erase as we're changing the value, not the key.
     }
 
-    // Move any encoders queued against this link to the new socket.
-    outgoing[to_fd] = std::move(outgoing[from_fd]);
-    outgoing.erase(from_fd);
+    // Move any encoders queued against this link to the new socket.
+    outgoing[to_fd] = std::move(outgoing[from_fd]);
+    outgoing.erase(from_fd);
+
+    // Update the fd any proxies are associated with.
+    if (proxies.count(from_fd) > 0) {
+      proxies[to_fd] = proxies[from_fd];
+      proxies.erase(from_fd);
+    }
+  }
+}
+
+
+// Returns the number of worker threads (and hence run queues) to
+// use. We create no fewer than 8 threads because some tests require
+// more worker threads than `sysconf(_SC_NPROCESSORS_ONLN)` on
+// computers with fewer cores.
+// e.g. https://issues.apache.org/jira/browse/MESOS-818
+//
+// TODO(xujyan): Use a smarter algorithm to allocate threads.
+// Allocating a static number of threads can cause starvation if
+// there are more waiting Processes than the number of worker
+// threads. On error assumes one core.
+static long num_worker_threads()
+{
+  long num_worker_threads =
+    std::max(8L, os::cpus().isSome() ? os::cpus().get() : 1);
+
+  // We allow the operator to set the number of libprocess worker
+  // threads, using an environment variable. The motivation is that
+  // for machines with a large number of cores, setting the number of
+  // worker threads to sysconf(_SC_NPROCESSORS_ONLN) can be very high
+  // and affect performance negatively. Furthermore, libprocess is
+  // widely used in Mesos and there may be a large number of Mesos
+  // processes (e.g., executors) on the same machine.
+  //
+  // See https://issues.apache.org/jira/browse/MESOS-4353.
+  constexpr char env_var[] = "LIBPROCESS_NUM_WORKER_THREADS";
+  Option<string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    constexpr long maxval = 1024;
+    Try<long> number = numify<long>(value.get().c_str());
+    if (number.isSome() && number.get() > 0L && number.get() <= maxval) {
+      VLOG(1) << "Overriding default number of worker threads "
+              << num_worker_threads << ", using the value "
+              <<  env_var << "=" << number.get() << " instead";
+      num_worker_threads = number.get();
+    } else {
+      LOG(WARNING) << "Ignoring invalid value " << value.get()
+                   << " for " << env_var
+                   << ", using default value " << num_worker_threads
+                   << ". Valid values are integers in the range 1 to "
+                   << maxval;
+    }
+  }
+
+  return num_worker_threads;
+}
+
+
+#ifdef __linux__
+// Parses a CPU list of the form "0,2,4-7" from the given environment
+// variable. Returns None if the variable is not set or the value is
+// invalid (a warning is logged in the latter case).
+static Option<std::vector<unsigned int>> parse_cpu_list(const char* env_var)
+{
+  Option<string> value = os::getenv(env_var);
+  if (value.isNone()) {
+    return None();
+  }
+
+  std::vector<unsigned int> cpus;
+
+  foreach (const string& token, strings::tokenize(value.get(), ",")) {
+    const std::vector<string> range = strings::split(token, "-");
+
+    Try<unsigned int> begin = numify<unsigned int>(range.front());
+    Try<unsigned int> end = numify<unsigned int>(range.back());
+
+    if (range.size() > 2 ||
+        begin.isError() ||
+        end.isError() ||
+        begin.get() > end.get() ||
+        end.get() >= CPU_SETSIZE) {
+      LOG(WARNING) << "Ignoring invalid value '" << value.get() << "' for "
+                   << env_var << ". Expecting a CPU list such as '0,2,4-7'";
+      return None();
+    }
+
+    for (unsigned int cpu = begin.get(); cpu <= end.get(); cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  if (cpus.empty()) {
+    return None();
+  }
+
+  return cpus;
+}
+
+
+// Restricts the given thread to the given set of CPUs. Failures are
+// logged but not fatal: the thread then simply runs unpinned.
+static void pin_thread(
+    std::thread* thread,
+    const std::vector<unsigned int>& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  foreach (unsigned int cpu, cpus) {
+    CPU_SET(cpu, &set);
+  }
+
+  int error =
+    pthread_setaffinity_np(thread->native_handle(), sizeof(set), &set);
+
+  if (error != 0) {
+    LOG(WARNING) << "Failed to set the CPU affinity of a libprocess"
+                 << " thread: " << os::strerror(error);
+  }
+}
+#endif // __linux__
+
+
+// Returns the maximum number of events a process gets to serve per
+// resumption. Serving a batch of events per resumption amortizes the
+// event queue synchronization for busy processes (e.g., the master)
+// while still bounding how long a single process can hog a worker
+// thread before other runnable processes get a turn.
+static size_t max_event_batch_size()
+{
+  size_t batch_size = 64;
 
-    // Update the fd any proxies are associated with.
-    if (proxies.count(from_fd) > 0) {
-      proxies[to_fd] = proxies[from_fd];
-      proxies.erase(from_fd);
+  constexpr char env_var[] = "LIBPROCESS_MAX_EVENT_BATCH_SIZE";
+  Option<string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    constexpr size_t maxval = 65536;
+    Try<size_t> number = numify<size_t>(value.get().c_str());
+    if (number.isSome() && number.get() > 0 && number.get() <= maxval) {
+      VLOG(1) << "Overriding default maximum event batch size "
+              << batch_size << ", using the value "
+              << env_var << "=" << number.get() << " instead";
+      batch_size = number.get();
+    } else {
+      LOG(WARNING) << "Ignoring invalid value " << value.get()
+                   << " for " << env_var
+                   << ", using default value " << batch_size
+                   << ". Valid values are integers in the range 1 to "
+                   << maxval;
     }
   }
+
+  return batch_size;
 }
 
 
 ProcessManager::ProcessManager(const Option<string>& _delegate)
   : delegate(_delegate),
+    next_runq(0),
     running(0),
     joining_threads(false),
-    finalizing(false) {}
+    finalizing(false)
+{
+  // Create the run queues up front (rather than in 'init_threads')
+  // so that processes can be enqueued before the worker threads have
+  // been created.
+  long threads = num_worker_threads();
+
+  runqs.reserve(threads);
+
+  for (long i = 0; i < threads; i++) {
+    runqs.push_back(new RunQueue());
+  }
+}
 
 
-ProcessManager::~ProcessManager() {}
+ProcessManager::~ProcessManager()
+{
+  foreach (RunQueue* runq, runqs) {
+    delete runq;
+  }
+}
 
 
 void ProcessManager::finalize()
@@ -2574,57 +3562,23 @@ void ProcessManager::finalize()
 
 long ProcessManager::init_threads()
 {
-  // We create no fewer than 8 threads because some tests require
-  // more worker threads than `sysconf(_SC_NPROCESSORS_ONLN)` on
-  // computers with fewer cores.
-  // e.g. https://issues.apache.org/jira/browse/MESOS-818
-  //
-  // TODO(xujyan): Use a smarter algorithm to allocate threads.
-  // Allocating a static number of threads can cause starvation if
-  // there are more waiting Processes than the number of worker
-  // threads. On error assumes one core.
-  long num_worker_threads =
-    std::max(8L, os::cpus().isSome() ? os::cpus().get() : 1);
-
-  // We allow the operator to set the number of libprocess worker
-  // threads, using an environment variable. The motivation is that
-  // for machines with a large number of cores, setting the number of
-  // worker threads to sysconf(_SC_NPROCESSORS_ONLN) can be very high
-  // and affect performance negatively. Furthermore, libprocess is
-  // widely used in Mesos and there may be a large number of Mesos
-  // processes (e.g., executors) on the same machine.
-  //
-  // See https://issues.apache.org/jira/browse/MESOS-4353.
-  constexpr char env_var[] = "LIBPROCESS_NUM_WORKER_THREADS";
-  Option<string> value = os::getenv(env_var);
-  if (value.isSome()) {
-    constexpr long maxval = 1024;
-    Try<long> number = numify<long>(value.get().c_str());
-    if (number.isSome() && number.get() > 0L && number.get() <= maxval) {
-      VLOG(1) << "Overriding default number of worker threads "
-              << num_worker_threads << ", using the value "
-              <<  env_var << "=" << number.get() << " instead";
-      num_worker_threads = number.get();
-    } else {
-      LOG(WARNING) << "Ignoring invalid value " << value.get()
-                   << " for " << env_var
-                   << ", using default value " << num_worker_threads
-                   << ". Valid values are integers in the range 1 to "
-                   << maxval;
-    }
-  }
+  // One worker thread per run queue (see the ProcessManager
+  // constructor for how the number of worker threads is determined).
+  long num_worker_threads = static_cast<long>(runqs.size());
 
   threads.reserve(num_worker_threads + 1);
 
-  struct
+  struct Worker
   {
     void operator()() const
     {
+      __worker_id__ = id;
+
       do {
-        ProcessBase* process = process_manager->dequeue();
+        ProcessBase* process = process_manager->dequeue(id);
         if (process == nullptr) {
           Gate::state_t old = gate->approach();
-          process = process_manager->dequeue();
+          process = process_manager->dequeue(id);
           if (process == nullptr) {
             if (joining_threads.load()) {
               break;
@@ -2642,17 +3596,54 @@ long ProcessManager::init_threads()
     // We hold a constant reference to `joining_threads` to make it clear that
     // this value is only being tested (read), and not manipulated.
     const std::atomic_bool& joining_threads;
-  } worker{joining_threads};
+
+    // Index of this worker's run queue.
+    const size_t id;
+  };
 
   // Create processing threads.
   for (long i = 0; i < num_worker_threads; i++) {
     // Retain the thread handles so that we can join when shutting down.
-    threads.emplace_back(new std::thread(worker));
+    threads.emplace_back(
+        new std::thread(Worker{joining_threads, static_cast<size_t>(i)}));
+  }
+
+#ifdef __linux__
+  // Pin the worker threads if requested: each worker is pinned to one
+  // CPU from the list, assigned round-robin in list order. Note that
+  // a worker dequeues from its own run queue first and steals from
+  // its neighbors in index order (see 'dequeue'), so on a multi-socket
+  // machine listing one NUMA node's CPUs before the other keeps both a
+  // worker's run queue and most of its stealing on the local node.
+  Option<std::vector<unsigned int>> worker_cpus =
+    parse_cpu_list("LIBPROCESS_WORKER_CPUS");
+
+  if (worker_cpus.isSome()) {
+    for (long i = 0; i < num_worker_threads; i++) {
+      pin_thread(
+          threads[i],
+          {worker_cpus.get()[i % worker_cpus.get().size()]});
+    }
   }
+#endif // __linux__
 
   // Create a thread for the event loop.
   threads.emplace_back(new std::thread(&EventLoop::run));
 
+#ifdef __linux__
+  // Pin the event loop thread if requested. Unlike the workers the
+  // event loop is given the entire list, since there is only one such
+  // thread; co-locating it with (a subset of) the workers avoids
+  // cross-node cache traffic between the event loop and the workers
+  // it hands sockets and timers to.
+  Option<std::vector<unsigned int>> event_loop_cpus =
+    parse_cpu_list("LIBPROCESS_EVENT_LOOP_CPUS");
+
+  if (event_loop_cpus.isSome()) {
+    pin_thread(threads.back(), event_loop_cpus.get());
+  }
+#endif // __linux__
+
   return num_worker_threads;
 }
 
@@ -2940,97 +3931,204 @@ void ProcessManager::resume(ProcessBase* process)
   bool terminate = false;
   bool blocked = false;
 
-  CHECK(process->state == ProcessBase::BOTTOM ||
-        process->state == ProcessBase::READY);
+  ProcessBase::State state = process->state.load();
 
-  if (process->state == ProcessBase::BOTTOM) {
-    process->state = ProcessBase::RUNNING;
+  CHECK(state == ProcessBase::BOTTOM ||
+        state == ProcessBase::READY);
+
+  process->state.store(ProcessBase::RUNNING);
+
+  process->profile.resumes.fetch_add(1, std::memory_order_relaxed);
+
+  if (state == ProcessBase::BOTTOM) {
     try { process->initialize(); }
     catch (...) { terminate = true; }
   }
 
+  // Maximum number of events this process gets to serve before
+  // yielding the worker thread (see 'max_event_batch_size').
+  static const size_t MAX_EVENT_BATCH_SIZE = max_event_batch_size();
+
+  // Events are dequeued in batches to amortize the event queue
+  // synchronization; events that have been dequeued but not yet
+  // served live here.
+  std::deque<Event*> batch;
+
+  size_t served = 0;
+
   while (!terminate && !blocked) {
-    Event* event = nullptr;
+    // Satisfy any backpressure waiters once the mailbox has drained
+    // sufficiently (see ProcessBase::drained). The common case is a
+    // single relaxed load of 'waiters'.
+    if (process->waiters.load(std::memory_order_relaxed)) {
+      process->relieve();
+    }
 
-    synchronized (process->mutex) {
-      if (process->events.size() > 0) {
-        event = process->events.front();
-        process->events.pop_front();
-        process->state = ProcessBase::RUNNING;
-      } else {
-        process->state = ProcessBase::BLOCKED;
-        blocked = true;
+    if (batch.empty()) {
+      if (served >= MAX_EVENT_BATCH_SIZE && !process->events.empty()) {
+        // The process has used up its quantum but still has pending
+        // events; put it at the back of a run queue so that other
+        // runnable processes get a turn. NOTE: once the process has
+        // been enqueued another worker thread may immediately resume
+        // it so we must not touch the process after this point.
+        process->state.store(ProcessBase::READY);
+        enqueue(process);
+        break;
       }
-    }
 
-    if (!blocked) {
-      CHECK(event != nullptr);
+      if (process->events.dequeue(
+              &batch, MAX_EVENT_BATCH_SIZE - served) == 0) {
+        // Transition to BLOCKED and then check the queue again: a
+        // producer might have enqueued an event right before the
+        // transition, in which case it saw RUNNING and did not make
+        // the process runnable (a producer only does that after
+        // seeing BLOCKED, see ProcessBase::enqueue).
+        process->state.store(ProcessBase::BLOCKED);
+
+        if (process->events.empty()) {
+          blocked = true;
+        } else {
+          // There is an event after all; take ourselves back to
+          // RUNNING, unless a producer already made the process READY
+          // (and hence enqueued it on a run queue), in which case we
+          // must stop resuming here and let that run queue entry
+          // resume the process. Note that an empty dequeue with a
+          // non-empty queue is also possible if a producer is in the
+          // middle of enqueuing, in which case we simply retry.
+          ProcessBase::State expected = ProcessBase::BLOCKED;
+          if (!process->state.compare_exchange_strong(
+                  expected, ProcessBase::RUNNING)) {
+            blocked = true;
+          }
+        }
 
-      // Determine if we should filter this event.
-      synchronized (filterer_mutex) {
-        if (filterer != nullptr) {
-          bool filter = false;
-          struct FilterVisitor : EventVisitor
-          {
-            explicit FilterVisitor(bool* _filter) : filter(_filter) {}
+        continue;
+      }
+    }
 
-            virtual void visit(const MessageEvent& event)
-            {
-              *filter = filterer->filter(event);
-            }
+    Event* event = batch.front();
+    batch.pop_front();
 
-            virtual void visit(const DispatchEvent& event)
-            {
-              *filter = filterer->filter(event);
-            }
+    served++;
 
-            virtual void visit(const HttpEvent& event)
-            {
-              *filter = filterer->filter(event);
-            }
+    // Determine if we should filter this event.
+    synchronized (filterer_mutex) {
+      if (filterer != nullptr) {
+        bool filter = false;
+        struct FilterVisitor : EventVisitor
+        {
+          explicit FilterVisitor(bool* _filter) : filter(_filter) {}
 
-            virtual void visit(const ExitedEvent& event)
-            {
-              *filter = filterer->filter(event);
-            }
+          virtual void visit(const MessageEvent& event)
+          {
+            *filter = filterer->filter(event);
+          }
 
-            bool* filter;
-          } visitor(&filter);
+          virtual void visit(const DispatchEvent& event)
+          {
+            *filter = filterer->filter(event);
+          }
 
-          event->visit(&visitor);
+          virtual void visit(const HttpEvent& event)
+          {
+            *filter = filterer->filter(event);
+          }
 
-          if (filter) {
-            delete event;
-            continue; // Try and execute the next event.
+          virtual void visit(const ExitedEvent& event)
+          {
+            *filter = filterer->filter(event);
           }
+
+          bool* filter;
+        } visitor(&filter);
+
+        event->visit(&visitor);
+
+        if (filter) {
+          delete event;
+          continue; // Try and execute the next event.
         }
       }
+    }
 
-      // Determine if we should terminate.
-      terminate = event->is<TerminateEvent>();
-
-      // Now service the event.
-      try {
-        process->serve(*event);
-      } catch (const std::exception& e) {
-        std::cerr << "libprocess: " << process->pid
-                  << " terminating due to "
-                  << e.what() << std::endl;
-        terminate = true;
-      } catch (...) {
-        std::cerr << "libprocess: " << process->pid
-                  << " terminating due to unknown exception" << std::endl;
-        terminate = true;
-      }
+    // Determine if we should terminate.
+    terminate = event->is<TerminateEvent>();
 
-      delete event;
+    // Record how long this event waited in the queue. The bucket
+    // index is floor(log2(age in microseconds)), see
+    // ProcessBase::Profile.
+    Duration age = Clock::now() - event->enqueued;
 
-      if (terminate) {
-        cleanup(process);
-      }
+    size_t bucket = 0;
+    uint64_t us = age > Duration::zero()
+      ? static_cast<uint64_t>(age.us())
+      : 0;
+    while (us >>= 1) {
+      bucket++;
+    }
+
+    if (bucket >= ProcessBase::Profile::AGE_BUCKETS) {
+      bucket = ProcessBase::Profile::AGE_BUCKETS - 1;
+    }
+
+    process->profile.ages[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // Queue depth when the handler starts, reported by the slow
+    // handler watchdog to tell an isolated slow handler from one
+    // that is starving a backlog.
+    size_t pending = process->events.pending();
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    // Dispatches made while serving a traced event inherit its trace
+    // id (see Tracer::sample).
+    __trace__ = event->trace;
+
+    // Now service the event.
+    try {
+      process->serve(*event);
+    } catch (const std::exception& e) {
+      std::cerr << "libprocess: " << process->pid
+                << " terminating due to "
+                << e.what() << std::endl;
+      terminate = true;
+    } catch (...) {
+      std::cerr << "libprocess: " << process->pid
+                << " terminating due to unknown exception" << std::endl;
+      terminate = true;
+    }
+
+    __trace__ = 0;
+
+    // NOTE: this must happen before 'cleanup' below since another
+    // thread may delete the process once it has been cleaned up.
+    process->profile.served.fetch_add(1, std::memory_order_relaxed);
+    process->profile.serve_ns.fetch_add(
+        stopwatch.elapsed().ns(), std::memory_order_relaxed);
+
+    if (event->trace != 0 && tracer != nullptr) {
+      tracer->record(event->trace, process->pid, age, stopwatch.elapsed());
+    }
+
+    if (watchdog != nullptr && watchdog->exceeded(stopwatch.elapsed())) {
+      watchdog->record(process->pid, *event, stopwatch.elapsed(), pending);
+    }
+
+    delete event;
+
+    if (terminate) {
+      cleanup(process);
     }
   }
 
+  // Delete any events that were dequeued into the batch but not yet
+  // served when the process terminated.
+  while (!batch.empty()) {
+    delete batch.front();
+    batch.pop_front();
+  }
+
   __process__ = nullptr;
 
   CHECK_GE(running.load(), 1);
@@ -3042,30 +4140,25 @@ void ProcessManager::cleanup(ProcessBase* process)
 {
   VLOG(2) << "Cleaning up " << process->pid;
 
-  // First, set the terminating state so no more events will get
-  // enqueued and delete all the pending events. We want to delete the
-  // events before we hold the processes lock because deleting an
-  // event could cause code outside libprocess to get executed which
-  // might cause a deadlock with the processes lock. Likewise,
-  // deleting the events now rather than later has the nice property
-  // of making sure that any events that might have gotten enqueued on
-  // the process we are cleaning up will get dropped (since it's
-  // terminating) and eliminates the potential of enqueueing them on
-  // another process that gets spawned with the same PID.
-  deque<Event*> events;
-
-  synchronized (process->mutex) {
-    process->state = ProcessBase::TERMINATING;
-    events = process->events;
-    process->events.clear();
-  }
-
-  // Delete pending events.
-  while (!events.empty()) {
-    Event* event = events.front();
-    events.pop_front();
-    delete event;
-  }
+  // First, set the terminating state and decomission the event queue
+  // so no more events will get enqueued and all the pending events
+  // get deleted. We want to delete the events before we hold the
+  // processes lock because deleting an event could cause code outside
+  // libprocess to get executed which might cause a deadlock with the
+  // processes lock. Likewise, deleting the events now rather than
+  // later has the nice property of making sure that any events that
+  // might have gotten enqueued on the process we are cleaning up will
+  // get dropped (since it's terminating) and eliminates the potential
+  // of enqueueing them on another process that gets spawned with the
+  // same PID. Note that a producer racing with the decomission might
+  // still get an event into the queue; such events get deleted when
+  // the process (and hence its queue) gets destructed.
+  process->state.store(ProcessBase::TERMINATING);
+  process->events.decomission();
+
+  // Wake up any backpressure waiters: this mailbox will never drain
+  // and subsequent sends to it get dropped anyway.
+  process->relieve(true);
 
   // Remove help strings for all installed routes for this process.
   dispatch(help, &Help::remove, process->pid.id);
@@ -3082,23 +4175,19 @@ void ProcessManager::cleanup(ProcessBase* process)
 #endif
     }
 
-    synchronized (process->mutex) {
-      CHECK(process->events.empty());
-
-      processes.erase(process->pid.id);
-
-      // Lookup gate to wake up waiting threads.
-      map<ProcessBase*, Gate*>::iterator it = gates.find(process);
-      if (it != gates.end()) {
-        gate = it->second;
-        // N.B. The last thread that leaves the gate also free's it.
-        gates.erase(it);
-      }
+    processes.erase(process->pid.id);
 
-      CHECK(process->refs.load() == 0);
-      process->state = ProcessBase::TERMINATED;
+    // Lookup gate to wake up waiting threads.
+    map<ProcessBase*, Gate*>::iterator it = gates.find(process);
+    if (it != gates.end()) {
+      gate = it->second;
+      // N.B. The last thread that leaves the gate also free's it.
+      gates.erase(it);
     }
 
+    CHECK(process->refs.load() == 0);
+    process->state.store(ProcessBase::TERMINATED);
+
     // Note that we don't remove the process from the clock during
     // cleanup, but rather the clock is reset for a process when it is
     // created (see ProcessBase::ProcessBase). We do this so that
@@ -3201,7 +4290,7 @@ bool ProcessManager::wait(const UPID& pid)
   synchronized (processes_mutex) {
     if (processes.count(pid.id) > 0) {
       process = processes[pid.id];
-      CHECK(process->state != ProcessBase::TERMINATED);
+      CHECK(process->state.load() != ProcessBase::TERMINATED);
 
       // Check and see if a gate already exists.
       if (gates.find(process) == gates.end()) {
@@ -3211,27 +4300,42 @@ bool ProcessManager::wait(const UPID& pid)
       gate = gates[process];
       old = gate->approach();
 
-      // Check if it is runnable in order to donate this thread.
-      if (process->state == ProcessBase::BOTTOM ||
-          process->state == ProcessBase::READY) {
-        synchronized (runq_mutex) {
-          list<ProcessBase*>::iterator it =
-            find(runq.begin(), runq.end(), process);
-          if (it != runq.end()) {
-            // Found it! Remove it from the run queue since we'll be
-            // donating our thread and also increment 'running' before
-            // leaving this 'runq' protected critical section so that
-            // everyone that is waiting for the processes to settle
-            // continue to wait (otherwise they could see nothing in
-            // 'runq' and 'running' equal to 0 between when we exit
-            // this critical section and increment 'running').
-            runq.erase(it);
-            running.fetch_add(1);
-          } else {
-            // Another thread has resumed the process ...
-            process = nullptr;
+      // Check if it is runnable in order to donate this thread. We
+      // don't know which run queue the process was enqueued on so we
+      // look at all of them.
+      ProcessBase::State state = process->state.load();
+      if (state == ProcessBase::BOTTOM ||
+          state == ProcessBase::READY) {
+        bool found = false;
+
+        foreach (RunQueue* runq, runqs) {
+          synchronized (runq->mutex) {
+            std::deque<ProcessBase*>::iterator it =
+              find(runq->processes.begin(), runq->processes.end(), process);
+            if (it != runq->processes.end()) {
+              // Found it! Remove it from the run queue since we'll be
+              // donating our thread and also increment 'running'
+              // before leaving this run queue's critical section so
+              // that everyone that is waiting for the processes to
+              // settle continue to wait (otherwise they could see
+              // nothing in the run queues and 'running' equal to 0
+              // between when we exit this critical section and
+              // increment 'running').
+              runq->processes.erase(it);
+              running.fetch_add(1);
+              found = true;
+            }
+          }
+
+          if (found) {
+            break;
           }
         }
+
+        if (!found) {
+          // Another thread has resumed the process ...
+          process = nullptr;
+        }
       } else {
         // Process is not runnable, so no need to donate ...
         process = nullptr;
@@ -3317,14 +4421,19 @@ void ProcessManager::enqueue(ProcessBase* process)
     return;
   }
 
-  // TODO(benh): Check and see if this process has its own thread. If
-  // it does, push it on that threads runq, and wake up that thread if
-  // it's not running. Otherwise, check and see which thread this
-  // process was last running on, and put it on that threads runq.
+  // Push the process on the run queue of the worker thread doing the
+  // enqueuing (e.g., a dispatch from a process running on that
+  // thread) so that in the common case the lock is uncontended,
+  // otherwise pick a run queue round-robin. An idle worker will steal
+  // the process if the chosen worker is busy.
+  size_t id = __worker_id__ >= 0
+    ? static_cast<size_t>(__worker_id__)
+    : next_runq.fetch_add(1) % runqs.size();
+
+  RunQueue* runq = runqs[id];
 
-  synchronized (runq_mutex) {
-    CHECK(find(runq.begin(), runq.end(), process) == runq.end());
-    runq.push_back(process);
+  synchronized (runq->mutex) {
+    runq->processes.push_back(process);
   }
 
   // Wake up the processing thread if necessary.
@@ -3332,26 +4441,29 @@ void ProcessManager::enqueue(ProcessBase* process)
 }
 
 
-ProcessBase* ProcessManager::dequeue()
+ProcessBase* ProcessManager::dequeue(size_t id)
 {
-  // TODO(benh): Remove a process from this thread's runq. If there
-  // are no processes to run, and this is not a dedicated thread, then
-  // steal one from another threads runq.
-
-  ProcessBase* process = nullptr;
-
-  synchronized (runq_mutex) {
-    if (!runq.empty()) {
-      process = runq.front();
-      runq.pop_front();
-      // Increment the running count of processes in order to support
-      // the Clock::settle() operation (this must be done atomically
-      // with removing the process from the runq).
-      running.fetch_add(1);
+  // First look at this worker's own run queue and then attempt to
+  // steal from the other workers' run queues.
+  const size_t count = runqs.size();
+
+  for (size_t i = 0; i < count; i++) {
+    RunQueue* runq = runqs[(id + i) % count];
+
+    synchronized (runq->mutex) {
+      if (!runq->processes.empty()) {
+        ProcessBase* process = runq->processes.front();
+        runq->processes.pop_front();
+        // Increment the running count of processes in order to
+        // support the Clock::settle() operation (this must be done
+        // atomically with removing the process from the run queue).
+        running.fetch_add(1);
+        return process;
+      }
     }
   }
 
-  return process;
+  return nullptr;
 }
 
 
@@ -3361,22 +4473,49 @@ void ProcessManager::settle()
   do {
     done = true; // Assume to start that we are settled.
 
-    synchronized (runq_mutex) {
-      if (!runq.empty()) {
-        done = false;
-        continue;
+    // The emptiness of the run queues and the 'running' count must
+    // be observed atomically: scanning the queues one lock at a time
+    // would let a process dequeued from a not-yet-scanned queue
+    // enqueue work onto an already-scanned queue and then drop
+    // 'running' to zero before we check it, making us settle while
+    // events are still pending. Since every enqueue and dequeue
+    // takes one of the queue locks, holding all of them (in a fixed
+    // order, so this cannot deadlock with the single-lock
+    // acquisitions) freezes the system for a consistent snapshot.
+    // Note that this is only used by Clock::settle, i.e., tests, so
+    // grabbing every lock here is not a performance concern.
+    {
+      std::vector<std::unique_lock<std::mutex>> locks;
+      locks.reserve(runqs.size());
+
+      foreach (RunQueue* runq, runqs) {
+        locks.push_back(std::unique_lock<std::mutex>(runq->mutex));
       }
 
-      if (running.load() > 0) {
-        done = false;
-        continue;
+      foreach (RunQueue* runq, runqs) {
+        if (!runq->processes.empty()) {
+          done = false;
+          break;
+        }
       }
 
-      if (!Clock::settled()) {
+      // Note that any process removed from a run queue has 'running'
+      // incremented before the queue's lock is released (see
+      // dequeue), so with all the locks held an empty scan means any
+      // such process must be visible in 'running' here.
+      if (done && running.load() > 0) {
         done = false;
-        continue;
       }
     }
+
+    if (!done) {
+      continue;
+    }
+
+    if (!Clock::settled()) {
+      done = false;
+      continue;
+    }
   } while (!done);
 }
 
@@ -3388,7 +4527,7 @@ Future<Response> ProcessManager::__processes__(const Request&)
   synchronized (processes_mutex) {
     foreachvalue (ProcessBase* process, process_manager->processes) {
       JSON::Object object;
-      object.values["id"] = process->pid.id;
+      object.values["id"] = string(process->pid.id);
 
       JSON::Array events;
 
@@ -3448,13 +4587,56 @@ Future<Response> ProcessManager::__processes__(const Request&)
         JSON::Array* events;
       } visitor(&events);
 
-      synchronized (process->mutex) {
-        foreach (Event* event, process->events) {
-          event->visit(&visitor);
-        }
-      }
+      process->events.visit(&visitor);
 
       object.values["events"] = events;
+
+      // Scheduling instrumentation (see ProcessBase::Profile).
+      const ProcessBase::Profile& profile = process->profile;
+
+      object.values["events_processed"] =
+        profile.served.load(std::memory_order_relaxed);
+      object.values["resumes"] =
+        profile.resumes.load(std::memory_order_relaxed);
+      object.values["serve_time_secs"] =
+        profile.serve_ns.load(std::memory_order_relaxed) / 1e9;
+      object.values["queue_size"] = process->events.pending();
+      object.values["queue_peak"] =
+        profile.queue_peak.load(std::memory_order_relaxed);
+
+      // Compute event age percentiles from the log2 microsecond
+      // buckets; each percentile reports the upper bound of the
+      // bucket it falls in, in milliseconds.
+      uint64_t ages[ProcessBase::Profile::AGE_BUCKETS];
+      uint64_t total = 0;
+
+      for (size_t i = 0; i < ProcessBase::Profile::AGE_BUCKETS; i++) {
+        ages[i] = profile.ages[i].load(std::memory_order_relaxed);
+        total += ages[i];
+      }
+
+      if (total > 0) {
+        auto percentile = [&ages, total](double p) -> double {
+          const uint64_t rank =
+            static_cast<uint64_t>(std::ceil(p * total));
+
+          uint64_t cumulative = 0;
+
+          for (size_t i = 0; i < ProcessBase::Profile::AGE_BUCKETS; i++) {
+            cumulative += ages[i];
+            if (cumulative >= rank) {
+              return (1ULL << (i + 1)) / 1000.0; // Microseconds to ms.
+            }
+          }
+
+          return (1ULL << ProcessBase::Profile::AGE_BUCKETS) / 1000.0;
+        };
+
+        object.values["event_age_p50_ms"] = percentile(0.50);
+        object.values["event_age_p90_ms"] = percentile(0.90);
+        object.values["event_age_p99_ms"] = percentile(0.99);
+      }
+
       array.values.push_back(object);
     }
   }
@@ -3471,6 +4653,9 @@ ProcessBase::ProcessBase(const string& id)
 
   refs = 0;
 
+  mailbox_limit = 0;
+  waiters = false;
+
   pid.id = id != "" ? id : ID::generate();
   pid.address = __address__;
 
@@ -3486,28 +4671,101 @@ ProcessBase::ProcessBase(const string& id)
 ProcessBase::~ProcessBase() {}
 
 
+void ProcessBase::setMailboxLimit(size_t limit)
+{
+  mailbox_limit.store(limit, std::memory_order_relaxed);
+}
+
+
+bool ProcessBase::congested() const
+{
+  size_t limit = mailbox_limit.load(std::memory_order_relaxed);
+  return limit > 0 && events.pending() >= limit;
+}
+
+
+Future<Nothing> ProcessBase::drained()
+{
+  if (!congested()) {
+    return Nothing();
+  }
+
+  Future<Nothing> future;
+
+  synchronized (congestion_mutex) {
+    congestion_promises.push_back(
+        Owned<Promise<Nothing>>(new Promise<Nothing>()));
+    future = congestion_promises.back()->future();
+    waiters.store(true);
+  }
+
+  // Re-check after registering: the mailbox may have drained (or the
+  // process terminated) in between, in which case the worker thread
+  // serving this process may never notice the waiter.
+  if (!congested()) {
+    relieve(true);
+  }
+
+  return future;
+}
+
+
+void ProcessBase::relieve(bool force)
+{
+  if (!force) {
+    size_t limit = mailbox_limit.load(std::memory_order_relaxed);
+    if (limit > 0 && events.pending() > limit / 2) {
+      return;
+    }
+  }
+
+  std::vector<Owned<Promise<Nothing>>> promises;
+
+  synchronized (congestion_mutex) {
+    promises.swap(congestion_promises);
+    waiters.store(false);
+  }
+
+  foreach (const Owned<Promise<Nothing>>& promise, promises) {
+    promise->set(Nothing());
+  }
+}
+
+
 void ProcessBase::enqueue(Event* event, bool inject)
 {
   CHECK(event != nullptr);
 
-  synchronized (mutex) {
-    if (state != TERMINATING && state != TERMINATED) {
-      if (!inject) {
-        events.push_back(event);
-      } else {
-        events.push_front(event);
-      }
+  event->enqueued = Clock::now();
 
-      if (state == BLOCKED) {
-        state = READY;
-        process_manager->enqueue(this);
-      }
+  // The event queue will refuse the event if it has been decomissioned
+  // (i.e., the process is terminating or terminated), in which case we
+  // still own the event.
+  if (!events.enqueue(event, inject)) {
+    delete event;
+    return;
+  }
 
-      CHECK(state == BOTTOM ||
-            state == READY ||
-            state == RUNNING);
-    } else {
-      delete event;
+  // Maintain the queue length high-water mark. NOTE: racing
+  // producers may observe sizes out of order so the recorded peak is
+  // approximate, which is fine for instrumentation.
+  size_t size = events.pending();
+  size_t peak = profile.queue_peak.load(std::memory_order_relaxed);
+  while (size > peak &&
+         !profile.queue_peak.compare_exchange_weak(peak, size)) {}
+
+  // If the process is blocked then we need to make it runnable. Note
+  // that the event was fully enqueued before loading the state so
+  // that if we see anything but BLOCKED the consumer is guaranteed to
+  // see our event when it checks the queue before actually blocking
+  // (see ProcessManager::resume). The CAS ensures only a single
+  // producer makes the process runnable.
+  State old = state.load();
+
+  while (old == BLOCKED) {
+    if (state.compare_exchange_weak(old, READY)) {
+      process_manager->enqueue(this);
+      break;
     }
   }
 }
@@ -3533,13 +4791,50 @@ void ProcessBase::send(
     const string& name,
     const char* data,
     size_t length)
+{
+  send(to, string(name), string(data, length));
+}
+
+
+void ProcessBase::send(
+    const UPID& to,
+    string&& name,
+    string&& data)
 {
   if (!to) {
     return;
   }
 
-  // Encode and transport outgoing message.
-  transport(encode(pid, to, name, string(data, length)), this);
+  // Encode and transport outgoing message. We move the name and
+  // body into the message rather than copying them; for a local
+  // recipient the message is then enqueued directly so no copies
+  // are made at all.
+  Message* message = new Message();
+  message->from = pid;
+  message->to = to;
+  message->name = std::move(name);
+  message->body = std::move(data);
+
+  transport(message, this);
+}
+
+
+void ProcessBase::send(
+    const std::vector<UPID>& to,
+    const string& name,
+    const char* data,
+    size_t length)
+{
+  const string body(data, length);
+
+  foreach (const UPID& recipient, to) {
+    if (!recipient) {
+      continue;
+    }
+
+    // Encode and transport outgoing message.
+    transport(encode(pid, recipient, name, body), this);
+  }
 }
 
 
@@ -3593,16 +4888,19 @@ void ProcessBase::visit(const HttpEvent& event)
       event.request->url.path, "/" + tokens[0], strings::PREFIX);
   name = strings::trim(name, strings::PREFIX, "/");
 
-  // Look for an endpoint handler for this path. We begin with the full path,
-  // but if no handler is found and the path is nested, we shorten it and look
-  // again. For example: if the request is for '/a/b/c' and no handler is found,
-  // we will then check for '/a/b', and finally for '/a'.
-  while (Path(name).dirname() != name) {
-    if (handlers.http.count(name) == 0) {
-      name = Path(name).dirname();
-      continue;
-    }
+  // Look for the endpoint handler installed for the longest prefix
+  // of this path by walking the route trie, e.g., a request for
+  // '/a/b/c' is handled by the endpoint for '/a/b/c' if one exists,
+  // otherwise by the one for '/a/b', and finally by the one for
+  // '/a'. This takes time linear in the length of the path rather
+  // than a map lookup per prefix, which processes with many
+  // installed routes pay on every request.
+  Option<string> route = handlers.routes.find(name);
+
+  if (route.isSome()) {
+    name = route.get();
 
+    CHECK(handlers.http.count(name) > 0);
     HttpEndpoint endpoint = handlers.http[name];
     Future<Option<AuthenticationResult>> authentication = None();
 
@@ -3783,6 +5081,56 @@ UPID ProcessBase::link(const UPID& to, const RemoteConnection remote)
 }
 
 
+void ProcessBase::RouteNode::insert(const string& name)
+{
+  RouteNode* node = this;
+
+  foreach (const string& segment, strings::tokenize(name, "/")) {
+    Owned<RouteNode>& child = node->children[segment];
+
+    if (child.get() == nullptr) {
+      child.reset(new RouteNode());
+    }
+
+    node = child.get();
+  }
+
+  node->name = name;
+}
+
+
+Option<string> ProcessBase::RouteNode::find(const string& path) const
+{
+  const vector<string> segments = strings::tokenize(path, "/");
+
+  // The root only matches the empty path (an endpoint installed for
+  // "/" does not catch every path below it).
+  if (segments.empty()) {
+    return name;
+  }
+
+  Option<string> found = None();
+
+  const RouteNode* node = this;
+
+  foreach (const string& segment, segments) {
+    auto child = node->children.find(segment);
+
+    if (child == node->children.end()) {
+      break;
+    }
+
+    node = child->second.get();
+
+    if (node->name.isSome()) {
+      found = node->name;
+    }
+  }
+
+  return found;
+}
+
+
 void ProcessBase::route(
     const string& name,
     const Option<string>& help_,
@@ -3795,6 +5143,7 @@ void ProcessBase::route(
   endpoint.handler = handler;
 
   handlers.http[name.substr(1)] = endpoint;
+  handlers.routes.insert(name.substr(1));
 
   dispatch(help, &Help::add, pid.id, name, help_);
 }
@@ -3814,6 +5163,7 @@ void ProcessBase::route(
   endpoint.authenticatedHandler = handler;
 
   handlers.http[name.substr(1)] = endpoint;
+  handlers.routes.insert(name.substr(1));
 
   dispatch(help, &Help::add, pid.id, name, help_);
 }
@@ -3974,6 +5324,13 @@ void dispatch(
   process::initialize();
 
   DispatchEvent* event = new DispatchEvent(pid, f, functionType);
+
+  // Tag the dispatch with a trace id if it got sampled (or belongs
+  // to a trace already being served, see Tracer::sample).
+  if (tracer != nullptr) {
+    event->trace = tracer->sample();
+  }
+
   process_manager->deliver(pid, event, __process__);
 }
 
@@ -10,7 +10,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <stdlib.h>
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -23,9 +32,13 @@
 #include "process/http.hpp"
 #include "process/profiler.hpp"
 
+#include "stout/foreach.hpp"
 #include "stout/format.hpp"
+#include "stout/numify.hpp"
 #include "stout/option.hpp"
 #include "stout/os.hpp"
+#include "stout/strings.hpp"
+#include "stout/try.hpp"
 #include "stout/os/strerror.hpp"
 
 namespace process {
@@ -34,6 +47,67 @@ namespace {
 
 const char PROFILE_FILE[] = "perftools.out";
 
+// Prefix for the dump files the tcmalloc heap profiler writes on its
+// own (e.g., on large heap growth).
+const char HEAP_PROFILE_PREFIX[] = "perftools-heap";
+
+// The tcmalloc heap profiling functions, resolved at runtime so that
+// running the process with tcmalloc as its allocator (e.g., via
+// LD_PRELOAD=libtcmalloc.so) is sufficient; neither a link time
+// dependency nor a rebuild is required.
+typedef void (*HeapProfilerStartFunction)(const char*);
+typedef void (*HeapProfilerStopFunction)();
+typedef char* (*GetHeapProfileFunction)();
+
+template <typename T>
+T resolve(const char* symbol)
+{
+  return reinterpret_cast<T>(dlsym(RTLD_DEFAULT, symbol));
+}
+
+const char TCMALLOC_MISSING[] =
+  "tcmalloc does not appear to be the allocator of this process.\n"
+  "Restart the process with tcmalloc loaded (e.g., via\n"
+  "LD_PRELOAD=libtcmalloc.so) to use the heap profiling endpoints.\n";
+
+
+// Parses the cumulative allocated bytes per allocation site out of a
+// tcmalloc heap profile. Each site is one line of the form:
+//   inuse_objects: inuse_bytes [alloc_objects: alloc_bytes] @ stack
+std::map<std::string, long long> parseAllocated(const std::string& profile)
+{
+  std::map<std::string, long long> result;
+
+  foreach (const std::string& line, strings::split(profile, "\n")) {
+    size_t at = line.find(" @ ");
+    if (at == std::string::npos) {
+      continue;
+    }
+
+    size_t open = line.find('[');
+    size_t close = line.find(']');
+    if (open == std::string::npos || close == std::string::npos ||
+        close < open) {
+      continue;
+    }
+
+    std::vector<std::string> counts =
+      strings::split(line.substr(open + 1, close - open - 1), ":");
+    if (counts.size() != 2) {
+      continue;
+    }
+
+    Try<long long> bytes = numify<long long>(strings::trim(counts[1]));
+    if (bytes.isError()) {
+      continue;
+    }
+
+    result[strings::trim(line.substr(at + 3))] += bytes.get();
+  }
+
+  return result;
+}
+
 }  // namespace {
 
 const std::string Profiler::START_HELP()
@@ -58,6 +132,60 @@ const std::string Profiler::STOP_HELP()
 }
 
 
+const std::string Profiler::HEAP_START_HELP()
+{
+  return HELP(
+    TLDR(
+        "Starts heap profiling."),
+    DESCRIPTION(
+        "Start the tcmalloc heap profiler. The process must be",
+        "running with tcmalloc as its allocator (e.g., via",
+        "LD_PRELOAD=libtcmalloc.so); no special environment",
+        "variables or restart flags are needed beyond that."),
+    AUTHENTICATION(true));
+}
+
+
+const std::string Profiler::HEAP_STOP_HELP()
+{
+  return HELP(
+    TLDR(
+        "Stops heap profiling."),
+    DESCRIPTION(
+        "Stop the tcmalloc heap profiler and return the final heap",
+        "profile, aggregated by allocation site. The stack addresses",
+        "can be symbolized offline with pprof."),
+    AUTHENTICATION(true));
+}
+
+
+const std::string Profiler::HEAP_PROFILE_HELP()
+{
+  return HELP(
+    TLDR(
+        "Returns the current heap profile."),
+    DESCRIPTION(
+        "Return the live heap allocations aggregated by allocation",
+        "site, in pprof format. The heap profiler must be running",
+        "(see /heap/start)."),
+    AUTHENTICATION(true));
+}
+
+
+const std::string Profiler::HEAP_GROWTH_HELP()
+{
+  return HELP(
+    TLDR(
+        "Returns heap growth since the last call."),
+    DESCRIPTION(
+        "Return the allocation sites whose cumulative allocated",
+        "bytes grew since the previous call to this endpoint,",
+        "largest first. The heap profiler must be running",
+        "(see /heap/start)."),
+    AUTHENTICATION(true));
+}
+
+
 Future<http::Response> Profiler::start(
     const http::Request& request,
     const Option<std::string>& /* principal */)
@@ -132,4 +260,140 @@ Future<http::Response> Profiler::stop(
 #endif
 }
 
+
+Future<http::Response> Profiler::heapStart(
+    const http::Request& request,
+    const Option<std::string>& /* principal */)
+{
+  HeapProfilerStartFunction heapProfilerStart =
+    resolve<HeapProfilerStartFunction>("HeapProfilerStart");
+
+  if (heapProfilerStart == nullptr) {
+    return http::BadRequest(TCMALLOC_MISSING);
+  }
+
+  if (heapStarted) {
+    return http::BadRequest("Heap profiler already started.\n");
+  }
+
+  LOG(INFO) << "Starting heap profiler";
+
+  heapProfilerStart(HEAP_PROFILE_PREFIX);
+
+  heapStarted = true;
+  allocated.clear();
+
+  return http::OK("Heap profiler started.\n");
+}
+
+
+Future<http::Response> Profiler::heapStop(
+    const http::Request& request,
+    const Option<std::string>& /* principal */)
+{
+  HeapProfilerStopFunction heapProfilerStop =
+    resolve<HeapProfilerStopFunction>("HeapProfilerStop");
+
+  GetHeapProfileFunction getHeapProfile =
+    resolve<GetHeapProfileFunction>("GetHeapProfile");
+
+  if (heapProfilerStop == nullptr || getHeapProfile == nullptr) {
+    return http::BadRequest(TCMALLOC_MISSING);
+  }
+
+  if (!heapStarted) {
+    return http::BadRequest("Heap profiler not running.\n");
+  }
+
+  LOG(INFO) << "Stopping heap profiler";
+
+  char* profile = getHeapProfile();
+  std::string body(profile);
+  free(profile);
+
+  heapProfilerStop();
+
+  heapStarted = false;
+  allocated.clear();
+
+  return http::OK(body);
+}
+
+
+Future<http::Response> Profiler::heapProfile(
+    const http::Request& request,
+    const Option<std::string>& /* principal */)
+{
+  GetHeapProfileFunction getHeapProfile =
+    resolve<GetHeapProfileFunction>("GetHeapProfile");
+
+  if (getHeapProfile == nullptr) {
+    return http::BadRequest(TCMALLOC_MISSING);
+  }
+
+  if (!heapStarted) {
+    return http::BadRequest("Heap profiler not running.\n");
+  }
+
+  char* profile = getHeapProfile();
+  std::string body(profile);
+  free(profile);
+
+  return http::OK(body);
+}
+
+
+Future<http::Response> Profiler::heapGrowth(
+    const http::Request& request,
+    const Option<std::string>& /* principal */)
+{
+  GetHeapProfileFunction getHeapProfile =
+    resolve<GetHeapProfileFunction>("GetHeapProfile");
+
+  if (getHeapProfile == nullptr) {
+    return http::BadRequest(TCMALLOC_MISSING);
+  }
+
+  if (!heapStarted) {
+    return http::BadRequest("Heap profiler not running.\n");
+  }
+
+  char* profile = getHeapProfile();
+  std::map<std::string, long long> current = parseAllocated(profile);
+  free(profile);
+
+  // Compute per site growth against the snapshot taken on the
+  // previous call. Sites that disappeared are ignored: cumulative
+  // allocation counts never shrink while the profiler runs.
+  std::vector<std::pair<long long, std::string>> growth;
+
+  foreachpair (const std::string& site, long long bytes, current) {
+    long long previous = 0;
+
+    std::map<std::string, long long>::const_iterator it =
+      allocated.find(site);
+    if (it != allocated.end()) {
+      previous = it->second;
+    }
+
+    if (bytes > previous) {
+      growth.push_back(std::make_pair(bytes - previous, site));
+    }
+  }
+
+  allocated = std::move(current);
+
+  std::sort(growth.rbegin(), growth.rend());
+
+  std::ostringstream out;
+  out << "Allocation site growth since last call ("
+      << growth.size() << " sites):\n";
+
+  foreachpair (long long bytes, const std::string& site, growth) {
+    out << bytes << " bytes @ " << site << "\n";
+  }
+
+  return http::OK(out.str());
+}
+
 } // namespace process {
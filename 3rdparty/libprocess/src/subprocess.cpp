@@ -283,16 +283,39 @@ Try<Subprocess> subprocess(
   // it in the non-`__WINDOWS__` branch.
   {
 #ifndef __WINDOWS__
-    Try<pid_t> pid = internal::cloneChild(
-        path,
-        argv,
-        environment,
-        _clone,
-        parent_hooks,
-        child_hooks,
-        stdinfds,
-        stdoutfds,
-        stderrfds);
+    // Use the 'posix_spawn' based fast path when the caller does not
+    // need to run code between 'fork' and 'exec' (no custom clone
+    // function and no hooks). This avoids copying the page tables of
+    // the parent, which is what makes launching short-lived children
+    // expensive from processes with a large resident set. We also
+    // require the prepared stdio descriptors to be outside of the
+    // standard descriptor range; see `internal::spawnChild`.
+    const bool spawnable =
+      _clone.isNone() &&
+      parent_hooks.empty() &&
+      child_hooks.empty() &&
+      stdinfds.read > STDERR_FILENO &&
+      stdoutfds.write > STDERR_FILENO &&
+      stderrfds.write > STDERR_FILENO;
+
+    Try<pid_t> pid = spawnable
+      ? internal::spawnChild(
+            path,
+            argv,
+            environment,
+            stdinfds,
+            stdoutfds,
+            stderrfds)
+      : internal::cloneChild(
+            path,
+            argv,
+            environment,
+            _clone,
+            parent_hooks,
+            child_hooks,
+            stdinfds,
+            stdoutfds,
+            stderrfds);
 
     if (pid.isError()) {
       return Error(pid.error());
@@ -21,27 +21,35 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/gtest.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/timer.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/gtest.hpp>
 #include <stout/hashset.hpp>
+#include <stout/json.hpp>
 #include <stout/stopwatch.hpp>
 
 namespace http = process::http;
 
+using process::Clock;
 using process::Future;
 using process::Owned;
 using process::Process;
 using process::ProcessBase;
 using process::Promise;
+using process::Timer;
 using process::UPID;
 
 using std::cout;
@@ -51,6 +59,28 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+
+// Prints a single machine readable result line for a benchmark
+// measurement so that results can be scraped and compared across
+// runs (and releases), e.g.:
+//
+//   BENCHMARK: {"benchmark":"dispatch_throughput","parameters":
+//     {"processes":4},"unit":"dispatches\/sec","value":1.0e6}
+static void report(
+    const string& benchmark,
+    const JSON::Object& parameters,
+    const string& unit,
+    double value)
+{
+  JSON::Object result;
+  result.values["benchmark"] = benchmark;
+  result.values["parameters"] = parameters;
+  result.values["unit"] = unit;
+  result.values["value"] = value;
+
+  cout << "BENCHMARK: " << result << endl;
+}
+
 int main(int argc, char** argv)
 {
   // Initialize Google Mock/Test.
@@ -374,3 +404,278 @@ TEST(ProcessTest, Process_BENCHMARK_LargeNumberOfLinks)
     delete process;
   }
 }
+
+
+// A process that counts the dispatches it receives and satisfies a
+// promise once a target count has been reached.
+class CounterProcess : public Process<CounterProcess>
+{
+public:
+  explicit CounterProcess(size_t _target)
+    : target(_target), received(0) {}
+
+  Future<Nothing> done() { return promise.future(); }
+
+  void increment()
+  {
+    if (++received == target) {
+      promise.set(Nothing());
+    }
+  }
+
+private:
+  const size_t target;
+  size_t received;
+  Promise<Nothing> promise;
+};
+
+
+// Measures dispatch delivery throughput as the dispatches are spread
+// over an increasing number of target processes, i.e., how well the
+// run queue scales with the available parallelism.
+TEST(ProcessTest, Process_BENCHMARK_DispatchThroughput)
+{
+  const size_t dispatches = 100000;
+
+  foreach (size_t processes, vector<size_t>({1, 2, 4, 8})) {
+    const size_t each = dispatches / processes;
+
+    vector<Owned<CounterProcess>> counters;
+    for (size_t i = 0; i < processes; i++) {
+      counters.push_back(Owned<CounterProcess>(new CounterProcess(each)));
+      spawn(counters.back().get());
+    }
+
+    Stopwatch watch;
+    watch.start();
+
+    for (size_t i = 0; i < each * processes; i++) {
+      dispatch(counters[i % processes]->self(), &CounterProcess::increment);
+    }
+
+    foreach (const Owned<CounterProcess>& counter, counters) {
+      AWAIT_READY(counter->done());
+    }
+
+    const Duration elapsed = watch.elapsed();
+
+    foreach (const Owned<CounterProcess>& counter, counters) {
+      terminate(counter->self());
+      wait(counter->self());
+    }
+
+    JSON::Object parameters;
+    parameters.values["processes"] = processes;
+
+    report(
+        "dispatch_throughput",
+        parameters,
+        "dispatches/sec",
+        (each * processes) / elapsed.secs());
+  }
+}
+
+
+// Measures the cost of concurrent enqueuing by having an increasing
+// number of threads dispatch to a single process, i.e., contention
+// on a single event queue.
+TEST(ProcessTest, Process_BENCHMARK_EnqueueContention)
+{
+  const size_t dispatches = 100000;
+
+  foreach (size_t threads, vector<size_t>({1, 2, 4, 8})) {
+    const size_t each = dispatches / threads;
+
+    CounterProcess counter(each * threads);
+    spawn(&counter);
+
+    Stopwatch watch;
+    watch.start();
+
+    vector<std::thread> producers;
+    for (size_t i = 0; i < threads; i++) {
+      producers.push_back(std::thread([&counter, each]() {
+        for (size_t j = 0; j < each; j++) {
+          dispatch(counter.self(), &CounterProcess::increment);
+        }
+      }));
+    }
+
+    foreach (std::thread& producer, producers) {
+      producer.join();
+    }
+
+    AWAIT_READY(counter.done());
+
+    const Duration elapsed = watch.elapsed();
+
+    terminate(counter);
+    wait(counter);
+
+    JSON::Object parameters;
+    parameters.values["threads"] = threads;
+
+    report(
+        "enqueue_contention",
+        parameters,
+        "dispatches/sec",
+        (each * threads) / elapsed.secs());
+  }
+}
+
+
+// Measures the cost of creating and canceling timers (the common
+// fate of timeouts that don't fire, e.g., offer filters that get
+// revived) as well as the cost of expiring a large number of timers
+// destined for a single process in one tick.
+TEST(ProcessTest, Process_BENCHMARK_TimerChurn)
+{
+  const size_t timers = 100000;
+
+  vector<Timer> pending;
+  pending.reserve(timers);
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < timers; i++) {
+    pending.push_back(Clock::timer(Hours(1), []() {}));
+  }
+
+  foreach (const Timer& timer, pending) {
+    Clock::cancel(timer);
+  }
+
+  JSON::Object parameters;
+  parameters.values["timers"] = timers;
+
+  report(
+      "timer_churn",
+      parameters,
+      "create+cancel/sec",
+      timers / watch.elapsed().secs());
+
+  // Now measure a timer expiry storm: all timers expire in a single
+  // tick and are delivered to the same process.
+  const size_t expirations = 50000;
+
+  CounterProcess counter(expirations);
+  spawn(&counter);
+
+  watch.start();
+
+  for (size_t i = 0; i < expirations; i++) {
+    delay(Duration::zero(), counter.self(), &CounterProcess::increment);
+  }
+
+  AWAIT_READY(counter.done());
+
+  const Duration elapsed = watch.elapsed();
+
+  terminate(counter);
+  wait(counter);
+
+  parameters = JSON::Object();
+  parameters.values["timers"] = expirations;
+
+  report(
+      "timer_expiry",
+      parameters,
+      "expirations/sec",
+      expirations / elapsed.secs());
+}
+
+
+// Measures the per-link overhead of 'Future::then' chains, which the
+// HTTP handling and operator API paths rely on heavily.
+TEST(ProcessTest, Process_BENCHMARK_FutureChain)
+{
+  const size_t links = 100000;
+
+  Promise<size_t> promise;
+  Future<size_t> future = promise.future();
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < links; i++) {
+    future = future.then([](size_t count) { return count + 1; });
+  }
+
+  promise.set(static_cast<size_t>(0));
+
+  AWAIT_READY(future);
+  EXPECT_EQ(links, future.get());
+
+  JSON::Object parameters;
+  parameters.values["links"] = links;
+
+  report(
+      "future_chain",
+      parameters,
+      "links/sec",
+      links / watch.elapsed().secs());
+}
+
+
+// A process serving a trivial HTTP endpoint, used to measure the
+// request handling rate of the HTTP stack without the cost of any
+// application level work.
+class HttpServerProcess : public Process<HttpServerProcess>
+{
+protected:
+  virtual void initialize()
+  {
+    route("/ping", None(), &HttpServerProcess::ping);
+  }
+
+private:
+  Future<http::Response> ping(const http::Request& request)
+  {
+    return http::OK("pong");
+  }
+};
+
+
+// Measures the sustained HTTP request rate against a trivial
+// endpoint with a fixed number of requests in flight.
+TEST(ProcessTest, Process_BENCHMARK_HttpRequestRate)
+{
+  const size_t requests = 5000;
+  const size_t concurrency = 64;
+
+  HttpServerProcess server;
+  spawn(&server);
+
+  Stopwatch watch;
+  watch.start();
+
+  size_t sent = 0;
+  while (sent < requests) {
+    list<Future<http::Response>> futures;
+    for (size_t i = 0; i < concurrency && sent < requests; i++, sent++) {
+      futures.push_back(http::get(server.self(), "ping"));
+    }
+
+    Future<list<http::Response>> responses = collect(futures);
+    AWAIT_READY(responses);
+
+    foreach (const http::Response& response, responses.get()) {
+      ASSERT_EQ(http::Status::OK, response.code);
+    }
+  }
+
+  const Duration elapsed = watch.elapsed();
+
+  terminate(server);
+  wait(server);
+
+  JSON::Object parameters;
+  parameters.values["concurrency"] = concurrency;
+
+  report(
+      "http_request_rate",
+      parameters,
+      "requests/sec",
+      requests / elapsed.secs());
+}
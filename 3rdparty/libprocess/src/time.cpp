@@ -99,13 +99,15 @@ std::ostream& operator<<(std::ostream& out, const RFC3339& formatter)
   // Append the fraction part in nanoseconds.
   int64_t nanoSeconds = (formatter.time.duration() - Seconds(secs)).ns();
   if (nanoSeconds != 0) {
-    char prev = out.fill();
-
-    // 9 digits for nanosecond level precision.
-    out << "." << std::setfill('0') << std::setw(9) << nanoSeconds;
-
-    // Return the stream to original formatting state.
-    out.fill(prev);
+    // 9 digits for nanosecond level precision. Formatted with
+    // snprintf rather than setfill/setw to avoid mutating (and
+    // having to restore) the stream's formatting state.
+    snprintf(
+        buffer,
+        sizeof(buffer),
+        ".%09lld",
+        static_cast<long long int>(nanoSeconds));
+    out << buffer;
   }
 
   out << "+00:00";
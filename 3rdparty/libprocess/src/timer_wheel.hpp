@@ -0,0 +1,316 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __TIMER_WHEEL_HPP__
+#define __TIMER_WHEEL_HPP__
+
+#include <stdint.h>
+
+#include <list>
+#include <utility>
+
+#include <process/time.hpp>
+#include <process/timer.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+
+// A hierarchical timing wheel (see Varghese and Lauck) holding the
+// pending timers. Both 'insert' and 'cancel' are constant time in the
+// number of pending timers (the previous representation, a 'Time'
+// sorted std::map of timer lists, required tree rebalancing on every
+// insert and erase which made timer churn, e.g., the allocator's
+// offer filter timeouts, a hotspot).
+//
+// The wheel has NUM_LEVELS levels of NUM_SLOTS slots each. A slot at
+// level 0 spans one tick (RESOLUTION), a slot at level 1 spans
+// NUM_SLOTS ticks, and so on; a timer gets bucketed by how far its
+// deadline is from the current tick and "cascades" down to a lower
+// level as the wheel turns. Note that the wheel is purely an indexing
+// structure: timers store their exact deadline and only expire once
+// 'advance' gets passed a time at or beyond that deadline, so no
+// precision is lost to the tick granularity.
+//
+// This class is not thread safe; the caller is expected to
+// synchronize (see clock.cpp).
+class TimerWheel
+{
+public:
+  TimerWheel() : current(0), count(0) {}
+
+  void insert(const Timer& timer)
+  {
+    add(timer);
+    count++;
+  }
+
+  // Cancels the timer, returning false if the timer was not pending
+  // (i.e., it already expired or was already canceled).
+  bool cancel(const Timer& timer)
+  {
+    Option<Position> position = positions.get(timer.id);
+
+    if (position.isNone()) {
+      return false;
+    }
+
+    position->first->erase(position->second);
+    positions.erase(timer.id);
+    count--;
+
+    return true;
+  }
+
+  // Turns the wheel up to 'now' and returns the expired timers.
+  std::list<Timer> advance(const Time& now)
+  {
+    const uint64_t target = ticks(now);
+
+    std::list<Timer> expired;
+
+    // The current slot might hold timers whose deadline falls within
+    // the current tick (or timers that were inserted already
+    // expired), so it gets collected even if the wheel doesn't turn.
+    collect(&wheel[0][current & SLOT_MASK], now, &expired);
+
+    while (current < target && count > 0) {
+      if (target - current >= (1ULL << (2 * SLOT_BITS))) {
+        // The jump is so large (e.g., the clock got advanced while
+        // paused, or this is the first turn of the wheel) that
+        // stepping tick by tick would be wasteful; re-bucket all the
+        // pending timers relative to the target instead.
+        rebuild(now, target, &expired);
+        break;
+      }
+
+      current++;
+
+      // Upon entering a new slot span of a higher level that level's
+      // now current slot cascades down.
+      if ((current & SLOT_MASK) == 0) {
+        cascade(1);
+      }
+
+      collect(&wheel[0][current & SLOT_MASK], now, &expired);
+    }
+
+    current = target;
+
+    // Expire in deadline order: the slots are visited roughly in
+    // deadline order but not exactly (e.g., when re-bucketing), and
+    // callers rely on timers firing in the order they would have by
+    // just letting the clock run. Note that the sort is stable so
+    // timers with the same deadline fire in creation order.
+    expired.sort([](const Timer& left, const Timer& right) {
+      return left.timeout().time() < right.timeout().time();
+    });
+
+    return expired;
+  }
+
+  // Returns the exact deadline of the earliest pending timer, or None
+  // if there are no pending timers. Takes time proportional to the
+  // number of slots (i.e., constant in the number of timers).
+  Option<Time> earliest() const
+  {
+    if (count == 0) {
+      return None();
+    }
+
+    // Scanning each level's slots starting from the slot holding the
+    // current tick visits them in deadline order, and all the timers
+    // at a level precede all the timers at higher levels (the cascade
+    // in 'advance' maintains this), so the first non-empty slot found
+    // holds the earliest timer.
+    for (int level = 0; level < NUM_LEVELS; level++) {
+      for (size_t i = 0; i < NUM_SLOTS; i++) {
+        const size_t index =
+          ((current >> (level * SLOT_BITS)) + i) & SLOT_MASK;
+
+        const std::list<Timer>& slot = wheel[level][index];
+
+        if (!slot.empty()) {
+          Option<Time> time = None();
+          foreach (const Timer& timer, slot) {
+            if (time.isNone() || timer.timeout().time() < time.get()) {
+              time = timer.timeout().time();
+            }
+          }
+          return time;
+        }
+      }
+    }
+
+    return None();
+  }
+
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  void clear()
+  {
+    for (int level = 0; level < NUM_LEVELS; level++) {
+      for (size_t index = 0; index < NUM_SLOTS; index++) {
+        wheel[level][index].clear();
+      }
+    }
+
+    positions.clear();
+    count = 0;
+  }
+
+private:
+  static constexpr int NUM_LEVELS = 4;
+  static constexpr int SLOT_BITS = 8;
+  static constexpr size_t NUM_SLOTS = 1 << SLOT_BITS;
+  static constexpr uint64_t SLOT_MASK = NUM_SLOTS - 1;
+
+  // One tick of the wheel, i.e., the span of a level 0 slot.
+  static constexpr int64_t RESOLUTION_NS = 1000000; // 1 millisecond.
+
+  typedef std::pair<std::list<Timer>*, std::list<Timer>::iterator> Position;
+
+  static uint64_t ticks(const Time& time)
+  {
+    return time.duration().ns() / RESOLUTION_NS;
+  }
+
+  // Buckets the timer by how far its deadline is from the current
+  // tick. Note that this does not adjust 'count' so that it can also
+  // be used while cascading and rebuilding.
+  void add(const Timer& timer)
+  {
+    const uint64_t deadline = ticks(timer.timeout().time());
+
+    // A timer whose deadline tick is at or behind the current tick
+    // must land in the *current* slot, the only level 0 slot that
+    // 'advance' is guaranteed to collect; the slot its deadline
+    // indexes is behind the wheel and would not be visited until the
+    // wheel wraps around. Such inserts do occur, e.g., when a "tick"
+    // advances the clock between a timer's timeout being computed
+    // and the timer being inserted.
+    const uint64_t tick = deadline > current ? deadline : current;
+    const uint64_t delta = tick - current;
+
+    std::list<Timer>* slot = nullptr;
+
+    if (delta < (1ULL << SLOT_BITS)) {
+      slot = &wheel[0][tick & SLOT_MASK];
+    } else if (delta < (1ULL << (2 * SLOT_BITS))) {
+      slot = &wheel[1][(tick >> SLOT_BITS) & SLOT_MASK];
+    } else if (delta < (1ULL << (3 * SLOT_BITS))) {
+      slot = &wheel[2][(tick >> (2 * SLOT_BITS)) & SLOT_MASK];
+    } else if (delta < (1ULL << (4 * SLOT_BITS))) {
+      slot = &wheel[3][(tick >> (3 * SLOT_BITS)) & SLOT_MASK];
+    } else {
+      // Beyond the span of the wheel; park the timer in the farthest
+      // top level slot, it will get re-bucketed as the wheel turns.
+      slot = &wheel[NUM_LEVELS - 1]
+                   [((current >> (3 * SLOT_BITS)) + NUM_SLOTS - 1) & SLOT_MASK];
+    }
+
+    slot->push_back(timer);
+    positions[timer.id] = Position(slot, --slot->end());
+  }
+
+  // Re-buckets the timers in the specified level's now current slot
+  // (cascading the next higher level first if this level just entered
+  // a new slot span of that level).
+  void cascade(int level)
+  {
+    if (level >= NUM_LEVELS) {
+      return;
+    }
+
+    const size_t index = (current >> (level * SLOT_BITS)) & SLOT_MASK;
+
+    if (index == 0) {
+      cascade(level + 1);
+    }
+
+    std::list<Timer> timers;
+    timers.swap(wheel[level][index]);
+
+    foreach (const Timer& timer, timers) {
+      positions.erase(timer.id);
+      add(timer);
+    }
+  }
+
+  // Moves the timers in the slot whose deadline has passed into
+  // 'expired'. Timers whose deadline falls within the current tick
+  // but has not yet passed stay put.
+  void collect(std::list<Timer>* slot, const Time& now, std::list<Timer>* expired)
+  {
+    std::list<Timer>::iterator iterator = slot->begin();
+    while (iterator != slot->end()) {
+      if (iterator->timeout().time() <= now) {
+        positions.erase(iterator->id);
+        expired->push_back(*iterator);
+        iterator = slot->erase(iterator);
+        count--;
+      } else {
+        ++iterator;
+      }
+    }
+  }
+
+  // Re-buckets all the pending timers relative to 'target', expiring
+  // those whose deadline has passed. Used when the wheel turns by
+  // more ticks than stepping slot by slot is worth.
+  void rebuild(const Time& now, uint64_t target, std::list<Timer>* expired)
+  {
+    std::list<Timer> pending;
+
+    for (int level = 0; level < NUM_LEVELS; level++) {
+      for (size_t index = 0; index < NUM_SLOTS; index++) {
+        pending.splice(pending.end(), wheel[level][index]);
+      }
+    }
+
+    positions.clear();
+
+    current = target;
+
+    foreach (const Timer& timer, pending) {
+      if (timer.timeout().time() <= now) {
+        expired->push_back(timer);
+        count--;
+      } else {
+        add(timer);
+      }
+    }
+  }
+
+  // The slots hold the pending timers, bucketed by deadline (see
+  // 'add').
+  std::list<Timer> wheel[NUM_LEVELS][NUM_SLOTS];
+
+  // Where each pending timer lives, used for constant time 'cancel'.
+  hashmap<uint64_t, Position> positions;
+
+  // The tick the wheel has been turned up to (see 'advance').
+  uint64_t current;
+
+  // Number of pending timers.
+  size_t count;
+};
+
+} // namespace process {
+
+#endif // __TIMER_WHEEL_HPP__
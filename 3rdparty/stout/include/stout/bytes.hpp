@@ -15,6 +15,7 @@
 
 #include <ctype.h> // For 'isdigit'.
 #include <stdint.h>
+#include <stdio.h>
 
 #include <iomanip>
 #include <iostream>
@@ -159,22 +160,61 @@ public:
 };
 
 
-inline std::ostream& operator<<(std::ostream& stream, const Bytes& bytes)
+namespace internal {
+
+// Formats a byte count into the buffer exactly as `operator<<`
+// renders it and returns the length, so that `stringify(Bytes)`
+// (used on logging and metrics paths) does not have to construct
+// a stringstream.
+inline int format(char* buffer, size_t size, const Bytes& bytes)
 {
+  uint64_t value;
+  const char* units;
+
   // Only raise the unit when there is no loss of information.
-  if (bytes.bytes() == 0) {
-    return stream << bytes.bytes() << "B";
-  } else if (bytes.bytes() % 1024 != 0) {
-    return stream << bytes.bytes() << "B";
+  if (bytes.bytes() == 0 || bytes.bytes() % 1024 != 0) {
+    value = bytes.bytes();
+    units = "B";
   } else if (bytes.kilobytes() % 1024 != 0) {
-    return stream << bytes.kilobytes() << "KB";
+    value = bytes.kilobytes();
+    units = "KB";
   } else if (bytes.megabytes() % 1024 != 0) {
-    return stream << bytes.megabytes() << "MB";
+    value = bytes.megabytes();
+    units = "MB";
   } else if (bytes.gigabytes() % 1024 != 0) {
-    return stream << bytes.gigabytes() << "GB";
+    value = bytes.gigabytes();
+    units = "GB";
   } else {
-    return stream << bytes.terabytes() << "TB";
+    value = bytes.terabytes();
+    units = "TB";
   }
+
+  return snprintf(
+      buffer,
+      size,
+      "%llu%s",
+      static_cast<unsigned long long int>(value),
+      units);
+}
+
+} // namespace internal {
+
+
+inline std::ostream& operator<<(std::ostream& stream, const Bytes& bytes)
+{
+  char buffer[32];
+  internal::format(buffer, sizeof(buffer), bytes);
+  return stream << buffer;
+}
+
+
+// Overrides the generic `stringify` (see stringify.hpp) to avoid
+// constructing a stringstream per formatted byte count.
+inline std::string stringify(const Bytes& bytes)
+{
+  char buffer[32];
+  int size = internal::format(buffer, sizeof(buffer), bytes);
+  return std::string(buffer, size);
 }
 
 
@@ -14,6 +14,7 @@
 #define __STOUT_DURATION_HPP__
 
 #include <ctype.h> // For 'isdigit'.
+#include <stdio.h>
 
 // For 'timeval'.
 #ifndef __WINDOWS__
@@ -29,6 +30,15 @@
 #include "numify.hpp"
 #include "try.hpp"
 
+class Duration;
+
+namespace internal {
+
+// Defined below (needs access to the unit constants).
+int format(char* buffer, size_t size, const Duration& duration);
+
+} // namespace internal {
+
 class Duration
 {
 public:
@@ -192,6 +202,11 @@ private:
   friend std::ostream& operator<<(
     std::ostream& stream,
     const Duration& duration);
+
+  friend int internal::format(
+    char* buffer,
+    size_t size,
+    const Duration& duration);
 };
 
 
@@ -306,16 +321,20 @@ public:
 };
 
 
-inline std::ostream& operator<<(std::ostream& stream, const Duration& duration_)
+namespace internal {
+
+// Formats a duration into the buffer exactly as `operator<<`
+// renders it and returns the length. Kept separate so that
+// `stringify(Duration)` (called for millions of logged durations)
+// bypasses stringstream construction and locale machinery.
+inline int format(char* buffer, size_t size, const Duration& duration_)
 {
-  // Output the duration in full double precision and save the old precision.
-  std::streamsize precision =
-    stream.precision(std::numeric_limits<double>::digits10);
+  int offset = 0;
 
   // Parse the duration as the sign and the absolute value.
   Duration duration = duration_;
   if (duration_ < Duration::zero()) {
-    stream << "-";
+    buffer[offset++] = '-';
 
     // Duration::min() may not be representable as a positive Duration.
     if (duration_ == Duration::min()) {
@@ -332,64 +351,114 @@ inline std::ostream& operator<<(std::ostream& stream, const Duration& duration_)
   // reads better with a smaller unit: '10days'. So we use 'days'
   // instead of 'weeks' to output the duration.
   int64_t nanoseconds = duration.ns();
+
+  double value;
+  const char* units;
+
   if (duration < Microseconds(1)) {
-    stream << duration.ns() << Nanoseconds::units();
+    return offset + snprintf(
+        buffer + offset,
+        size - offset,
+        "%lldns",
+        static_cast<long long int>(duration.ns()));
   } else if (duration < Milliseconds(1)) {
     if (nanoseconds % Duration::MICROSECONDS != 0) {
       // We can't get a whole number using this unit but we can at
       // one level down.
-      stream << duration.ns() << Nanoseconds::units();
+      return offset + snprintf(
+          buffer + offset,
+          size - offset,
+          "%lldns",
+          static_cast<long long int>(duration.ns()));
     } else {
-      stream << duration.us() << Microseconds::units();
+      value = duration.us();
+      units = "us";
     }
   } else if (duration < Seconds(1)) {
     if (nanoseconds % Duration::MILLISECONDS != 0 &&
         nanoseconds % Duration::MICROSECONDS == 0) {
-      stream << duration.us() << Microseconds::units();
+      value = duration.us();
+      units = "us";
     } else {
-      stream << duration.ms() << Milliseconds::units();
+      value = duration.ms();
+      units = "ms";
     }
   } else if (duration < Minutes(1)) {
     if (nanoseconds % Duration::SECONDS != 0 &&
         nanoseconds % Duration::MILLISECONDS == 0) {
-      stream << duration.ms() << Milliseconds::units();
+      value = duration.ms();
+      units = "ms";
     } else {
-      stream << duration.secs() << Seconds::units();
+      value = duration.secs();
+      units = "secs";
     }
   } else if (duration < Hours(1)) {
     if (nanoseconds % Duration::MINUTES != 0 &&
         nanoseconds % Duration::SECONDS == 0) {
-      stream << duration.secs() << Seconds::units();
+      value = duration.secs();
+      units = "secs";
     } else {
-      stream << duration.mins() << Minutes::units();
+      value = duration.mins();
+      units = "mins";
     }
   } else if (duration < Days(1)) {
     if (nanoseconds % Duration::HOURS != 0 &&
         nanoseconds % Duration::MINUTES == 0) {
-      stream << duration.mins() << Minutes::units();
+      value = duration.mins();
+      units = "mins";
     } else {
-      stream << duration.hrs() << Hours::units();
+      value = duration.hrs();
+      units = "hrs";
     }
   } else if (duration < Weeks(1)) {
     if (nanoseconds % Duration::DAYS != 0 &&
         nanoseconds % Duration::HOURS == 0) {
-      stream << duration.hrs() << Hours::units();
+      value = duration.hrs();
+      units = "hrs";
     } else {
-      stream << duration.days() << Days::units();
+      value = duration.days();
+      units = "days";
     }
   } else {
     if (nanoseconds % Duration::WEEKS != 0 &&
         nanoseconds % Duration::DAYS == 0) {
-      stream << duration.days() << Days::units();
+      value = duration.days();
+      units = "days";
     } else {
-      stream << duration.weeks() << Weeks::units();
+      value = duration.weeks();
+      units = "weeks";
     }
   }
 
-  // Return the stream to original formatting state.
-  stream.precision(precision);
+  // "%.*g" with double precision matches what a stream renders
+  // with `precision(std::numeric_limits<double>::digits10)`.
+  return offset + snprintf(
+      buffer + offset,
+      size - offset,
+      "%.*g%s",
+      std::numeric_limits<double>::digits10,
+      value,
+      units);
+}
+
+} // namespace internal {
+
+
+inline std::ostream& operator<<(std::ostream& stream, const Duration& duration)
+{
+  char buffer[64];
+  internal::format(buffer, sizeof(buffer), duration);
+  return stream << buffer;
+}
 
-  return stream;
+
+// Overrides the generic `stringify` (see stringify.hpp) to avoid
+// constructing a stringstream per formatted duration.
+inline std::string stringify(const Duration& duration)
+{
+  char buffer[64];
+  int size = internal::format(buffer, sizeof(buffer), duration);
+  return std::string(buffer, size);
 }
 
 
@@ -87,6 +87,15 @@ struct Flag
 
   std::string help;
   bool boolean;
+
+  // Stringifies this flag's default value for the help text, set
+  // for flags registered with a default. This is deferred rather
+  // than eagerly appended to `help` so that constructing a flags
+  // object doesn't have to stringify every default (durations,
+  // JSON, etc.) just to build help text that is rarely requested
+  // (see `FlagsBase::usage`).
+  Option<lambda::function<std::string()>> defaultString;
+
   lambda::function<Try<Nothing>(FlagsBase*, const std::string&)> load;
   lambda::function<Option<std::string>(const FlagsBase&)> stringify;
   lambda::function<Option<Error>(const FlagsBase&)> validate;
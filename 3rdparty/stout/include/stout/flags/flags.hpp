@@ -17,11 +17,13 @@
 #include <map>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <typeinfo> // For typeid.
 #include <vector>
 
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
+#include <stout/flathashmap.hpp>
 #include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/multimap.hpp>
@@ -61,9 +63,13 @@ public:
   // C++14, but in C++11 only the versions taking lvalue references
   // should be. GCC seems to create all of these even in C++11 mode so
   // we need to explicitly disable them.
-  FlagsBase(const FlagsBase&) = default;
+  //
+  // The copy operations are user provided (rather than defaulted)
+  // because `index_` points into our own `flags_` and has to be
+  // rebuilt rather than copied.
+  FlagsBase(const FlagsBase& that) { *this = that; }
   FlagsBase(FlagsBase&&) = delete;
-  FlagsBase& operator=(const FlagsBase&) = default;
+  FlagsBase& operator=(const FlagsBase& that);
   FlagsBase& operator=(FlagsBase&&) = delete;
 
   // Load any flags from the environment given the variable prefix,
@@ -317,14 +323,50 @@ private:
       bool duplicates = false,
       const Option<std::string>& prefix = None());
 
-  // Maps flag's name to flag.
+  // Maps flag's name to flag. This is kept ordered so that help
+  // and stringification output are sorted by flag name.
   std::map<std::string, Flag> flags_;
 
   // Maps flag's alias to flag's name.
   std::map<std::string, std::string> aliases;
+
+  // Maps every name a flag can be loaded by (its name and its
+  // alias, if any) to the flag, so that loading N values does a
+  // single hash lookup per value rather than walking the ordered
+  // maps above. The pointers reference values in `flags_`, which
+  // is node based and therefore pointer stable; copying a flags
+  // object rebuilds the index (see the copy operations above).
+  flathashmap<std::string, Flag*> index_;
 };
 
 
+inline FlagsBase& FlagsBase::operator=(const FlagsBase& that)
+{
+  help = that.help;
+  programName_ = that.programName_;
+  usageMessage_ = that.usageMessage_;
+  flags_ = that.flags_;
+  aliases = that.aliases;
+
+  // Rebuild the name index over our own `flags_`. Aliases are
+  // inserted last since an alias shadows an equal flag name in
+  // lookups (as it always has, see `load`).
+  index_.clear();
+
+  foreachvalue (Flag& flag, flags_) {
+    index_[flag.name.value] = &flag;
+  }
+
+  foreachvalue (Flag& flag, flags_) {
+    if (flag.alias.isSome()) {
+      index_[flag.alias->value] = &flag;
+    }
+  }
+
+  return *this;
+}
+
+
 template <typename Flags, typename T1, typename T2, typename F>
 void FlagsBase::add(
     T1 Flags::*t1,
@@ -397,14 +439,19 @@ void FlagsBase::add(
     return None();
   };
 
-  // Update the help string to include the default value.
-  flag.help += help.size() > 0 && help.find_last_of("\n\r") != help.size() - 1
-    ? " (default: " // On same line, add space.
-    : "(default: "; // On newline.
+  // Defer stringifying the default value until the help string is
+  // actually rendered (see `usage`): agents and masters register a
+  // hundred plus flags at startup and never ask for help. Note
+  // that `T2` is a character array when a string literal default
+  // is passed (see the comment above the `add` overloads), so we
+  // capture those as `std::string` rather than copying the array.
   if (t2 != nullptr) {
-    flag.help += stringify(*t2);
+    const typename std::conditional<
+        std::is_array<T2>::value, std::string, T2>::type default_ = *t2;
+    flag.defaultString = [default_]() { return stringify(default_); };
+  } else {
+    flag.defaultString = []() { return std::string(); };
   }
-  flag.help += ")";
 
   add(flag);
 }
@@ -504,9 +551,18 @@ inline void FlagsBase::add(const Flag& flag)
     }
   }
 
-  flags_[flag.name.value] = flag;
+  Flag& added = flags_[flag.name.value];
+  added = flag;
+
+  // NOTE: An alias shadows an equal flag name in lookups (as it
+  // always has), so don't overwrite an existing alias entry.
+  if (aliases.count(flag.name.value) == 0) {
+    index_[flag.name.value] = &added;
+  }
+
   if (flag.alias.isSome()) {
     aliases[flag.alias.get().value] = flag.name.value;
+    index_[flag.alias.get().value] = &added;
   }
 }
 
@@ -528,7 +584,7 @@ inline std::map<std::string, Option<std::string>> FlagsBase::extract(
       // TODO(vinod): Reject flags with an unknown name if `unknowns` is false.
       // This will break backwards compatibility however!
       std::string flag_name = strings::remove(name, "no-", strings::PREFIX);
-      if (flags_.count(flag_name) > 0 || aliases.count(flag_name) > 0) {
+      if (index_.contains(flag_name)) {
         values[name] = Some(value);
       }
     }
@@ -723,11 +779,9 @@ inline Try<Warnings> FlagsBase::load(
     bool is_negated = strings::startsWith(name, "no-");
     std::string flag_name = !is_negated ? name : name.substr(3);
 
-    auto iter = aliases.count(flag_name)
-      ? flags_.find(aliases[flag_name])
-      : flags_.find(flag_name);
+    Option<Flag*> lookup = index_.get(flag_name);
 
-    if (iter == flags_.end()) {
+    if (lookup.isNone()) {
       if (!unknowns) {
         return Error("Failed to load unknown flag '" + flag_name + "'" +
                      (!is_negated ? "" : " via '" + name + "'"));
@@ -736,7 +790,7 @@ inline Try<Warnings> FlagsBase::load(
       }
     }
 
-    Flag* flag = &(iter->second);
+    Flag* flag = lookup.get();
 
     if (!duplicates && flag->loaded_name.isSome()) {
       return Error("Flag '" + flag_name + "' is already loaded via name '" +
@@ -777,8 +831,7 @@ inline Try<Warnings> FlagsBase::load(
     // TODO(vinod): Move this logic inside `Flag::load()`.
 
     // Set `loaded_name` to the Name corresponding to `flag_name`.
-    if (aliases.count(flag_name)) {
-      CHECK_SOME(flag->alias);
+    if (flag->alias.isSome() && flag->alias->value == flag_name) {
       flag->loaded_name = flag->alias.get();
     } else {
       flag->loaded_name = flag->name;
@@ -857,9 +910,21 @@ inline std::string FlagsBase::usage( const Option<std::string>& message) const
     std::string pad(PAD + width - line.size(), ' ');
     line += pad;
 
+    // Append the default value, which we defer stringifying until
+    // the help text is actually rendered (see `FlagsBase::add`).
+    std::string help = flag.help;
+    if (flag.defaultString.isSome()) {
+      help +=
+        help.size() > 0 && help.find_last_of("\n\r") != help.size() - 1
+          ? " (default: " // On same line, add space.
+          : "(default: "; // On newline.
+      help += flag.defaultString.get()();
+      help += ")";
+    }
+
     size_t pos1 = 0, pos2 = 0;
-    pos2 = flag.help.find_first_of("\n\r", pos1);
-    line += flag.help.substr(pos1, pos2 - pos1) + "\n";
+    pos2 = help.find_first_of("\n\r", pos1);
+    line += help.substr(pos1, pos2 - pos1) + "\n";
     usage += line;
 
     while (pos2 != std::string::npos) {  // Handle multi-line help strings.
@@ -867,8 +932,8 @@ inline std::string FlagsBase::usage( const Option<std::string>& message) const
       pos1 = pos2 + 1;
       std::string pad2(PAD + width, ' ');
       line += pad2;
-      pos2 = flag.help.find_first_of("\n\r", pos1);
-      line += flag.help.substr(pos1, pos2 - pos1) + "\n";
+      pos2 = help.find_first_of("\n\r", pos1);
+      line += help.substr(pos1, pos2 - pos1) + "\n";
       usage += line;
     }
   }
@@ -17,18 +17,119 @@
 
 #include <string>
 
+#include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 
 // Compression utilities.
-// TODO(bmahler): Provide streaming compression / decompression as well.
+// TODO(bmahler): Provide streaming decompression as well.
 namespace gzip {
 
 // We use a 16KB buffer with zlib compression / decompression.
 #define GZIP_BUFFER_SIZE 16384
 
+// Provides the ability to incrementally compress a stream of
+// uncompressed data as gzip. Each call to `compress` returns the
+// compressed data available so far (synchronously flushed, so that a
+// consumer such as a chunked HTTP response can make progress after
+// every call); `finalize` returns the remaining data along with the
+// gzip trailer.
+class Compressor
+{
+public:
+  // The compression level should be within the range [-1, 9],
+  // see `compress` below.
+  explicit Compressor(int level = Z_DEFAULT_COMPRESSION)
+    : finalized_(false)
+  {
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    int code = deflateInit2(
+        &stream,
+        level,          // Compression level.
+        Z_DEFLATED,     // Compression method.
+        MAX_WBITS + 16, // Zlib magic for gzip compression / decompression.
+        8,              // Default memLevel value.
+        Z_DEFAULT_STRATEGY);
+
+    CHECK_EQ(code, Z_OK) << "Failed to initialize zlib";
+  }
+
+  Compressor(const Compressor&) = delete;
+  Compressor& operator=(const Compressor&) = delete;
+
+  ~Compressor()
+  {
+    deflateEnd(&stream);
+  }
+
+  // Returns the compressed output available after consuming the
+  // provided input. The output is flushed such that the data
+  // compressed so far can be decompressed by the consumer.
+  Try<std::string> compress(const std::string& input)
+  {
+    CHECK(!finalized_) << "Cannot compress after the stream was finalized";
+
+    stream.next_in =
+      const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+
+    return emit(Z_SYNC_FLUSH);
+  }
+
+  // Returns the remaining compressed output and the gzip trailer.
+  // The compressor cannot be used once finalized.
+  Try<std::string> finalize()
+  {
+    CHECK(!finalized_) << "Cannot finalize a finalized stream";
+
+    finalized_ = true;
+
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    return emit(Z_FINISH);
+  }
+
+  bool finalized() const { return finalized_; }
+
+private:
+  // Runs `deflate` with the specified flush mode until all pending
+  // output has been emitted.
+  Try<std::string> emit(int flush)
+  {
+    // Build up the compressed result.
+    Bytef buffer[GZIP_BUFFER_SIZE];
+    std::string result = "";
+    int code = Z_OK;
+    do {
+      stream.next_out = buffer;
+      stream.avail_out = GZIP_BUFFER_SIZE;
+      code = deflate(&stream, flush);
+
+      if (code != Z_OK && code != Z_STREAM_END && code != Z_BUF_ERROR) {
+        return Error(stream.msg != Z_NULL ? std::string(stream.msg)
+                                          : "Failed to deflate");
+      }
+
+      result.append(
+          reinterpret_cast<char*>(buffer),
+          GZIP_BUFFER_SIZE - stream.avail_out);
+    } while (stream.avail_out == 0);
+
+    return result;
+  }
+
+  z_stream_s stream;
+  bool finalized_;
+};
+
 // Returns a gzip compressed version of the provided string.
 // The compression level should be within the range [-1, 9].
 // See zlib.h:
@@ -36,6 +36,7 @@
 
 #include <stout/check.hpp>
 #include <stout/foreach.hpp>
+#include <stout/nothing.hpp>
 #include <stout/numify.hpp>
 #include <stout/result.hpp>
 #include <stout/strings.hpp>
@@ -832,6 +833,171 @@ inline Try<Value> parse(const std::string& s)
   return parse(s);
 }
 
+
+// SAX style parsing: instead of materializing a `JSON::Value` tree
+// (which costs an allocation per node), `sax::parse` invokes the
+// methods of a `sax::Handler` as the input is scanned. This lets
+// callers that map JSON onto an existing representation (e.g.,
+// protobuf messages, see `protobuf::parse` in <stout/protobuf.hpp>)
+// avoid the intermediate DOM entirely.
+namespace sax {
+
+// The event interface. Each method can return an `Error` to abort
+// the parse; the error is surfaced from `sax::parse`. Note that
+// numbers are surfaced as `onInteger` when they are exactly
+// representable as `int64_t` and as `onDouble` otherwise, mirroring
+// the behavior of `JSON::Number`.
+class Handler
+{
+public:
+  virtual ~Handler() {}
+
+  virtual Try<Nothing> onNull() = 0;
+  virtual Try<Nothing> onBoolean(bool value) = 0;
+  virtual Try<Nothing> onInteger(int64_t value) = 0;
+  virtual Try<Nothing> onDouble(double value) = 0;
+  virtual Try<Nothing> onString(std::string&& value) = 0;
+  virtual Try<Nothing> onObjectStart() = 0;
+  virtual Try<Nothing> onKey(std::string&& key) = 0;
+  virtual Try<Nothing> onObjectEnd() = 0;
+  virtual Try<Nothing> onArrayStart() = 0;
+  virtual Try<Nothing> onArrayEnd() = 0;
+};
+
+
+namespace internal {
+
+// Stores the first error returned by the handler (syntax errors are
+// detected by the caller from the parse position instead).
+inline bool handle(const Try<Nothing>& result, Option<Error>* error)
+{
+  if (result.isError()) {
+    if (error->isNone()) {
+      *error = Error(result.error());
+    }
+    return false;
+  }
+  return true;
+}
+
+
+// Recursive descent over a `picojson::input`, mirroring the value
+// dispatch of `picojson::_parse` but emitting handler events rather
+// than building `picojson::value` instances. We reuse PicoJson's
+// string parsing (which handles escapes and UTF-16 surrogate pairs)
+// and number tokenization.
+template <typename Iterator>
+bool parse(
+    Handler* handler,
+    picojson::input<Iterator>& in,
+    Option<Error>* error)
+{
+  in.skip_ws();
+  int ch = in.getc();
+  switch (ch) {
+    case 'n':
+      return in.match("ull") && handle(handler->onNull(), error);
+    case 't':
+      return in.match("rue") && handle(handler->onBoolean(true), error);
+    case 'f':
+      return in.match("alse") && handle(handler->onBoolean(false), error);
+    case '"': {
+      std::string value;
+      return picojson::_parse_string(value, in) &&
+             handle(handler->onString(std::move(value)), error);
+    }
+    case '[': {
+      if (!handle(handler->onArrayStart(), error)) {
+        return false;
+      }
+      if (in.expect(']')) {
+        return handle(handler->onArrayEnd(), error);
+      }
+      do {
+        if (!parse(handler, in, error)) {
+          return false;
+        }
+      } while (in.expect(','));
+      return in.expect(']') && handle(handler->onArrayEnd(), error);
+    }
+    case '{': {
+      if (!handle(handler->onObjectStart(), error)) {
+        return false;
+      }
+      if (in.expect('}')) {
+        return handle(handler->onObjectEnd(), error);
+      }
+      do {
+        std::string key;
+        if (!in.expect('"') ||
+            !picojson::_parse_string(key, in) ||
+            !in.expect(':')) {
+          return false;
+        }
+        if (!handle(handler->onKey(std::move(key)), error) ||
+            !parse(handler, in, error)) {
+          return false;
+        }
+      } while (in.expect(','));
+      return in.expect('}') && handle(handler->onObjectEnd(), error);
+    }
+    default: {
+      if (('0' <= ch && ch <= '9') || ch == '-') {
+        in.ungetc();
+        const std::string number = picojson::_parse_number(in);
+        if (number.empty()) {
+          return false;
+        }
+
+        char* end;
+        errno = 0;
+        const intmax_t integer = strtoimax(number.c_str(), &end, 10);
+        if (errno == 0 &&
+            end == number.c_str() + number.size() &&
+            integer >= std::numeric_limits<int64_t>::min() &&
+            integer <= std::numeric_limits<int64_t>::max()) {
+          return handle(handler->onInteger(integer), error);
+        }
+
+        const double real = strtod(number.c_str(), &end);
+        if (end == number.c_str() + number.size()) {
+          return handle(handler->onDouble(real), error);
+        }
+        return false;
+      }
+      break;
+    }
+  }
+  in.ungetc();
+  return false;
+}
+
+} // namespace internal {
+
+
+inline Try<Nothing> parse(const std::string& s, Handler* handler)
+{
+  const char* begin = s.c_str();
+  picojson::input<const char*> in(begin, begin + s.size());
+
+  Option<Error> error = None();
+  if (!internal::parse(handler, in, &error)) {
+    if (error.isSome()) {
+      return error.get();
+    }
+    return Error("Syntax error at line " + stringify(in.line()));
+  }
+
+  // Like `JSON::parse`, reject trailing non-whitespace characters.
+  in.skip_ws();
+  if (in.getc() != -1) {
+    return Error("Parsed JSON included non-whitespace trailing characters");
+  }
+
+  return Nothing();
+}
+
+} // namespace sax {
 } // namespace JSON {
 
 #endif // __STOUT_JSON__
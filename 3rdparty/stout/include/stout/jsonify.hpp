@@ -13,6 +13,7 @@
 #ifndef __STOUT_JSONIFY__
 #define __STOUT_JSONIFY__
 
+#include <cmath>
 #include <cstddef>
 #include <functional>
 #include <ostream>
@@ -21,6 +22,10 @@
 #include <type_traits>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
 #include <stout/result_of.hpp>
 #include <stout/strings.hpp>
 
@@ -99,6 +104,23 @@ inline std::ostream& operator<<(std::ostream& stream, Proxy&& that)
 }
 
 
+// Wraps a string containing an already-serialized JSON value, so that it can
+// be passed to the writers below (e.g., as an object's field or an array's
+// element) and spliced into the output without being re-escaped. The caller
+// is responsible for ensuring that the wrapped string is valid JSON.
+//
+// NOTE: In order to keep this object light-weight, the string is captured by
+// reference. This gives rise to the same lifetime semantics as `JSON::Proxy`;
+// the wrapped string has to outlive the full expression.
+class RawString
+{
+public:
+  explicit RawString(const std::string& _value) : value(_value) {}
+
+  const std::string& value;
+};
+
+
 // The boolean writer. If `set` is not called at all, `false` is printed.
 // If `set` is called more than once, only the last value is printed out.
 class BooleanWriter
@@ -145,6 +167,21 @@ public:
         break;
       }
       case DOUBLE: {
+        // Fast path for doubles which hold an integral value (e.g.,
+        // byte and task counts in master state), which can be
+        // formatted with the much cheaper integer inserter. The
+        // bound keeps us within the 15 significant digits printed by
+        // the snprintf fallback below so that the output matches,
+        // and negative zero is excluded since it must keep its sign.
+        if (double_ > -1e15 && double_ < 1e15 &&
+            !(double_ == 0.0 && std::signbit(double_))) {
+          const long long int integral = static_cast<long long int>(double_);
+          if (static_cast<double>(integral) == double_) {
+            *stream_ << integral << ".0";
+            break;
+          }
+        }
+
         // Prints a floating point value, with the specified precision, see:
         // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2006/n2005.pdf
         // Additionally ensures that a decimal point is in the output.
@@ -295,11 +332,80 @@ public:
 private:
   void append(const char* value, std::size_t size)
   {
-    for (std::size_t i = 0; i < size; ++i) {
-      append(value[i]);
+    // Most strings contain no characters that require escaping, so
+    // rather than inserting one character at a time we scan for the
+    // next character that requires escaping and bulk-write the clean
+    // run preceding it.
+    std::size_t i = 0;
+    while (i < size) {
+      const std::size_t run = clean(value + i, size - i);
+      if (run > 0) {
+        stream_->write(value + i, run);
+        i += run;
+      }
+
+      if (i < size) {
+        append(value[i]);
+        ++i;
+      }
     }
   }
 
+  // Returns `true` if the given character requires escaping.
+  static bool escaped(char c)
+  {
+    return static_cast<unsigned char>(c) < 0x20 ||
+           c == 0x7f || c == '"' || c == '\\' || c == '/';
+  }
+
+  // Returns the number of leading characters of `data` that do not
+  // require escaping, i.e., the offset of the first character that
+  // does (or `size` if there is none).
+  static std::size_t clean(const char* data, std::size_t size)
+  {
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    // Scan 16 bytes at a time. A character requires escaping if it
+    // is a control character (unsigned < 0x20), DEL (0x7f), or one
+    // of '"', '\\', '/'.
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i control = _mm_set1_epi8(0x1f);
+
+    while (i + 16 <= size) {
+      const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+      __m128i special = _mm_cmpeq_epi8(chunk, quote);
+      special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, backslash));
+      special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, slash));
+      special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, del));
+
+      // Unsigned 'chunk <= 0x1f' comparison: the unsigned minimum of
+      // the chunk and 0x1f equals the chunk only for such bytes.
+      special = _mm_or_si128(
+          special,
+          _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+
+      const int mask = _mm_movemask_epi8(special);
+      if (mask != 0) {
+        return i + __builtin_ctz(mask);
+      }
+
+      i += 16;
+    }
+#endif // __SSE2__
+
+    while (i < size && !escaped(data[i])) {
+      ++i;
+    }
+
+    return i;
+  }
+
   std::ostream* stream_;
 };
 
@@ -675,4 +781,13 @@ JSON::Proxy jsonify(const T& t)
   return JSON::internal::jsonify(t, JSON::internal::Prefer());
 }
 
+
+// `jsonify` specialization for `JSON::RawString`, which splices the
+// pre-serialized value into the output stream without re-escaping.
+template <>
+inline JSON::Proxy jsonify(const JSON::RawString& raw)
+{
+  return JSON::Proxy([&raw](std::ostream* stream) { *stream << raw.value; });
+}
+
 #endif // __STOUT_JSONIFY__
@@ -19,95 +19,212 @@
 #include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 
-// Implementation of a hashmap that maintains the insertion order
-// of the keys. Note that re-insertion of a key (i.e., update)
-// doesn't update its insertion order.
+// Implementation of a hashmap that maintains the insertion order of
+// the keys. Note that re-insertion of a key (i.e., update) doesn't
+// update its insertion order.
+//
+// The insertion order is maintained by a doubly-linked list threaded
+// through the map's own entries rather than by a separate list of key
+// copies, so each entry costs a single allocation and stores its key
+// once. This relies on `hashmap` (i.e., `std::unordered_map`) being
+// node based: pointers to entries remain valid until erasure.
+//
 // TODO(vinod/bmahler): Consider extending from stout::hashmap and/or
 // having a compatible API with stout::hashmap.
 template <typename Key, typename Value>
 class LinkedHashMap
 {
+private:
+  struct Entry
+  {
+    Value value;
+    const Key* key = nullptr; // Points at the key of this map entry.
+    Entry* prev = nullptr;
+    Entry* next = nullptr;
+  };
+
 public:
-  typedef std::list<Key> list;
-  typedef hashmap<Key, std::pair<Value, typename list::iterator>> map;
+  // Iterates over the entries in insertion order, yielding
+  // (key, value) pairs usable with `foreachpair` and friends.
+  // Note that only const iteration is provided.
+  class const_iterator
+  {
+  public:
+    explicit const_iterator(const Entry* _entry) : entry(_entry) {}
+
+    std::pair<const Key&, const Value&> operator*() const
+    {
+      return std::pair<const Key&, const Value&>(*entry->key, entry->value);
+    }
+
+    const_iterator& operator++()
+    {
+      entry = entry->next;
+      return *this;
+    }
+
+    bool operator==(const const_iterator& that) const
+    {
+      return entry == that.entry;
+    }
+
+    bool operator!=(const const_iterator& that) const
+    {
+      return entry != that.entry;
+    }
+
+  private:
+    const Entry* entry;
+  };
+
+  const_iterator begin() const { return const_iterator(head_); }
+  const_iterator end() const { return const_iterator(nullptr); }
+
+  LinkedHashMap() = default;
+
+  // The entry links point into our own `entries_`, so copies
+  // re-insert (in insertion order) rather than copying the links,
+  // and moves transfer the links (entry addresses are stable across
+  // a container move) but must reset them in the source.
+  LinkedHashMap(const LinkedHashMap& that) { *this = that; }
+
+  LinkedHashMap(LinkedHashMap&& that) { *this = std::move(that); }
+
+  LinkedHashMap& operator=(const LinkedHashMap& that)
+  {
+    if (this != &that) {
+      clear();
+      for (const Entry* entry = that.head_;
+           entry != nullptr;
+           entry = entry->next) {
+        (*this)[*entry->key] = entry->value;
+      }
+    }
+    return *this;
+  }
+
+  LinkedHashMap& operator=(LinkedHashMap&& that)
+  {
+    if (this != &that) {
+      entries_ = std::move(that.entries_);
+      head_ = that.head_;
+      tail_ = that.tail_;
+      that.entries_.clear();
+      that.head_ = nullptr;
+      that.tail_ = nullptr;
+    }
+    return *this;
+  }
 
   Value& operator[] (const Key& key)
   {
-    if (!values_.contains(key)) {
-      // Insert into the list and get the "pointer" into the list.
-      typename list::iterator i = keys_.insert(keys_.end(), key);
-      values_[key] = std::make_pair(Value(), i); // Store default value.
+    auto iterator = entries_.find(key);
+    if (iterator == entries_.end()) {
+      // Insert a default value and link the new entry at the tail.
+      iterator = entries_.emplace(key, Entry()).first;
+
+      Entry* entry = &iterator->second;
+      entry->key = &iterator->first;
+      entry->prev = tail_;
+
+      if (tail_ != nullptr) {
+        tail_->next = entry;
+      } else {
+        head_ = entry;
+      }
+      tail_ = entry;
     }
-    return values_[key].first;
+    return iterator->second.value;
   }
 
   Option<Value> get(const Key& key) const
   {
-    if (values_.contains(key)) {
-      return values_.at(key).first;
+    auto iterator = entries_.find(key);
+    if (iterator != entries_.end()) {
+      return iterator->second.value;
     }
     return None();
   }
 
   Value& at(const Key& key)
   {
-    return values_.at(key).first;
+    return entries_.at(key).value;
   }
 
   const Value& at(const Key& key) const
   {
-    return values_.at(key).first;
+    return entries_.at(key).value;
   }
 
   bool contains(const Key& key) const
   {
-    return values_.contains(key);
+    return entries_.contains(key);
   }
 
   size_t erase(const Key& key)
   {
-    if (values_.contains(key)) {
-      // Get the "pointer" into the list.
-      typename list::iterator i = values_[key].second;
-      keys_.erase(i);
-      return values_.erase(key);
+    auto iterator = entries_.find(key);
+    if (iterator != entries_.end()) {
+      // Unlink the entry before erasing it.
+      Entry* entry = &iterator->second;
+
+      if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+      } else {
+        head_ = entry->next;
+      }
+
+      if (entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+      } else {
+        tail_ = entry->prev;
+      }
+
+      entries_.erase(iterator);
+      return 1;
     }
     return 0;
   }
 
   std::list<Key> keys() const
   {
-    return keys_;
+    std::list<Key> result;
+    for (const Entry* entry = head_; entry != nullptr; entry = entry->next) {
+      result.push_back(*entry->key);
+    }
+    return result;
   }
 
   std::list<Value> values() const
   {
     std::list<Value> result;
-    foreach (const Key& key, keys_) {
-      result.push_back(values_.at(key).first);
+    for (const Entry* entry = head_; entry != nullptr; entry = entry->next) {
+      result.push_back(entry->value);
     }
     return result;
   }
 
   size_t size() const
   {
-    return keys_.size();
+    return entries_.size();
   }
 
   bool empty() const
   {
-    return keys_.empty();
+    return entries_.empty();
   }
 
   void clear()
   {
-    values_.clear();
-    keys_.clear();
+    entries_.clear();
+    head_ = nullptr;
+    tail_ = nullptr;
   }
 
 private:
-  list keys_;  // Keys ordered by the insertion order.
-  map values_;  // Map of values and "pointers" to the linked list.
+  hashmap<Key, Entry> entries_; // Map of values and insertion order links.
+  Entry* head_ = nullptr; // Least recently inserted entry.
+  Entry* tail_ = nullptr; // Most recently inserted entry.
 };
 
 
@@ -13,7 +13,6 @@
 #ifndef __STOUT_MULTIHASHMAP_HPP__
 #define __STOUT_MULTIHASHMAP_HPP__
 
-#include <algorithm> // For find.
 #include <list>
 #include <map>
 #include <set>
@@ -152,8 +151,19 @@ bool multihashmap<Key, Value, Hash, Equal>::contains(
     const Key& key,
     const Value& value) const
 {
-  const std::list<Value> values = get(key);
-  return std::find(values.begin(), values.end(), value) != values.end();
+  // NOTE: We deliberately don't use `get(key)` here since that
+  // would copy every value associated with the key just to look
+  // for one of them.
+  auto range =
+    std::unordered_multimap<Key, Value, Hash, Equal>::equal_range(key);
+
+  for (auto i = range.first; i != range.second; ++i) {
+    if (i->second == value) {
+      return true;
+    }
+  }
+
+  return false;
 }
 
 #endif // __STOUT_MULTIHASHMAP_HPP__
@@ -167,6 +167,9 @@ inline Try<std::string> sysname()
 }
 
 
+// NOTE: On Linux `processes` is implemented over a single /proc
+// snapshot in stout/os/linux.hpp.
+#ifndef __linux__
 inline Try<std::list<Process>> processes()
 {
   const Try<std::set<pid_t>> pids = os::pids();
@@ -185,6 +188,7 @@ inline Try<std::list<Process>> processes()
   }
   return result;
 }
+#endif // __linux__
 
 
 inline Option<Process> process(
@@ -104,7 +104,12 @@ inline pid_t clone(
 }
 
 
-inline Result<Process> process(pid_t pid)
+namespace internal {
+
+// Builds a Process from its /proc status and command line.
+inline Try<Process> convert(
+    const proc::ProcessStatus& status,
+    const Result<std::string>& cmdline)
 {
   // Page size, used for memory accounting.
   static const size_t pageSize = os::pagesize();
@@ -115,16 +120,6 @@ inline Result<Process> process(pid_t pid)
     return Error("Failed to get sysconf(_SC_CLK_TCK)");
   }
 
-  const Result<proc::ProcessStatus> status = proc::status(pid);
-
-  if (status.isError()) {
-    return Error(status.error());
-  }
-
-  if (status.isNone()) {
-    return None();
-  }
-
   // There are known bugs with invalid utime / stime values coming
   // from /proc/<pid>/stat on some Linux systems.
   // See the following thread for details:
@@ -134,23 +129,81 @@ inline Result<Process> process(pid_t pid)
   // These are similar reports:
   // http://lkml.indiana.edu/hypermail/linux/kernel/1207.1/01388.html
   // https://bugs.launchpad.net/ubuntu/+source/linux/+bug/1023214
-  Try<Duration> utime = Duration::create(status.get().utime / (double) ticks);
-  Try<Duration> stime = Duration::create(status.get().stime / (double) ticks);
+  Try<Duration> utime = Duration::create(status.utime / (double) ticks);
+  Try<Duration> stime = Duration::create(status.stime / (double) ticks);
+
+  return Process(status.pid,
+                 status.ppid,
+                 status.pgrp,
+                 status.session,
+                 Bytes(status.rss * pageSize),
+                 utime.isSome() ? utime.get() : Option<Duration>::none(),
+                 stime.isSome() ? stime.get() : Option<Duration>::none(),
+                 cmdline.isSome() ? cmdline.get() : status.comm,
+                 status.state == 'Z');
+}
+
+} // namespace internal {
+
+
+inline Result<Process> process(pid_t pid)
+{
+  const Result<proc::ProcessStatus> status = proc::status(pid);
+
+  if (status.isError()) {
+    return Error(status.error());
+  }
+
+  if (status.isNone()) {
+    return None();
+  }
 
   // The command line from 'status.get().comm' is only "arg0" from
   // "argv" (i.e., the canonical executable name). To get the entire
   // command line we grab '/proc/[pid]/cmdline'.
   Result<std::string> cmdline = proc::cmdline(pid);
 
-  return Process(status.get().pid,
-                 status.get().ppid,
-                 status.get().pgrp,
-                 status.get().session,
-                 Bytes(status.get().rss * pageSize),
-                 utime.isSome() ? utime.get() : Option<Duration>::none(),
-                 stime.isSome() ? stime.get() : Option<Duration>::none(),
-                 cmdline.isSome() ? cmdline.get() : status.get().comm,
-                 status.get().state == 'Z');
+  Try<Process> process = internal::convert(status.get(), cmdline);
+  if (process.isError()) {
+    return Error(process.error());
+  }
+
+  return process.get();
+}
+
+
+// Linux implementation of `processes` (the generic one in
+// stout/os.hpp reads /proc/[pid]/stat per pid through separate
+// path resolutions): one proc::Snapshot captures every process in
+// a single /proc pass.
+inline Try<std::list<Process>> processes()
+{
+  Try<proc::Snapshot> snapshot = proc::Snapshot::create();
+  if (snapshot.isError()) {
+    return Error(snapshot.error());
+  }
+
+  std::list<Process> result;
+
+  foreach (pid_t pid, snapshot.get().pids()) {
+    Result<proc::ProcessStatus> status = snapshot.get().status(pid);
+
+    // Ignore processes that disappeared or failed to parse.
+    if (!status.isSome()) {
+      continue;
+    }
+
+    Try<Process> process =
+      internal::convert(status.get(), snapshot.get().cmdline(pid));
+
+    if (process.isError()) {
+      return Error(process.error());
+    }
+
+    result.push_back(process.get());
+  }
+
+  return result;
 }
 
 
@@ -19,10 +19,15 @@
 #endif
 
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
 
+#include <sys/syscall.h>
 #include <sys/types.h> // For pid_t.
 
+#include <algorithm>
 #include <fstream>
 #include <list>
 #include <queue>
@@ -33,6 +38,7 @@
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
@@ -161,23 +167,73 @@ struct ProcessStatus
 };
 
 
-// Returns the process statistics from /proc/[pid]/stat.
-// The return value is None if the process does not exist.
-inline Result<ProcessStatus> status(pid_t pid)
+namespace internal {
+
+// Enumerates the numeric entries of a directory (process or thread
+// ids) by filling a large buffer with raw getdents64(2) calls,
+// avoiding the per-entry overhead and the intermediate string list
+// of going through os::ls. /proc is scanned on every process tree
+// collection, so this is a hot path during agent recovery.
+inline Try<std::set<pid_t>> scan(const std::string& path)
 {
-  std::string path = "/proc/" + stringify(pid) + "/stat";
+  int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd == -1) {
+    return ErrnoError("Failed to open '" + path + "'");
+  }
 
-  Try<std::string> read = os::read(path);
-  if (read.isError()) {
-    // Need to check if file exists AFTER we open it to guarantee
-    // process hasn't terminated.
-    if (!os::exists(path)) {
-      return None();
+  // Layout of the records that getdents64(2) fills in.
+  struct Entry
+  {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+  };
+
+  std::set<pid_t> pids;
+  char buffer[64 * 1024];
+
+  while (true) {
+    ssize_t size = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+    if (size == -1) {
+      Error error = ErrnoError("Failed to read '" + path + "'");
+      ::close(fd);
+      return error;
+    } else if (size == 0) {
+      break;
+    }
+
+    for (ssize_t offset = 0; offset < size; ) {
+      const Entry* entry = reinterpret_cast<const Entry*>(buffer + offset);
+
+      // Process and thread ids never start with anything but a
+      // digit, which conveniently also skips '.' and '..'.
+      if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
+        Try<pid_t> pid = numify<pid_t>(entry->d_name);
+        if (pid.isSome()) {
+          pids.insert(pid.get());
+        }
+      }
+
+      offset += entry->d_reclen;
     }
-    return Error(read.error());
   }
 
-  std::istringstream data(read.get());
+  ::close(fd);
+
+  return pids;
+}
+
+
+// Parses the contents of a /proc/[pid]/stat file; `path` is only
+// used in error messages.
+inline Try<ProcessStatus> parse(
+    pid_t pid,
+    const std::string& contents,
+    const std::string& path)
+{
+  std::istringstream data(contents);
 
   std::string comm;
   char state;
@@ -252,6 +308,33 @@ inline Result<ProcessStatus> status(pid_t pid)
                        signal, blocked, sigcatch, wchan, nswap, cnswap);
 }
 
+} // namespace internal {
+
+
+// Returns the process statistics from /proc/[pid]/stat.
+// The return value is None if the process does not exist.
+inline Result<ProcessStatus> status(pid_t pid)
+{
+  std::string path = "/proc/" + stringify(pid) + "/stat";
+
+  Try<std::string> read = os::read(path);
+  if (read.isError()) {
+    // Need to check if file exists AFTER we open it to guarantee
+    // process hasn't terminated.
+    if (!os::exists(path)) {
+      return None();
+    }
+    return Error(read.error());
+  }
+
+  Try<ProcessStatus> status = internal::parse(pid, read.get(), path);
+  if (status.isError()) {
+    return Error(status.error());
+  }
+
+  return status.get();
+}
+
 
 inline Result<std::string> cmdline(const Option<pid_t>& pid = None())
 {
@@ -293,22 +376,13 @@ inline Result<std::string> cmdline(const Option<pid_t>& pid = None())
 // Reads from /proc and returns a list of all running processes.
 inline Try<std::set<pid_t>> pids()
 {
-  std::set<pid_t> pids;
-
-  Try<std::list<std::string>> entries = os::ls("/proc");
-  if (entries.isError()) {
-    return Error("Failed to list files in /proc: " + entries.error());
-  }
-
-  foreach (const std::string& entry, entries.get()) {
-    Try<pid_t> pid = numify<pid_t>(entry);
-    if (pid.isSome()) {
-      pids.insert(pid.get()); // Ignore entries that can't be numified.
-    }
+  Try<std::set<pid_t>> pids = internal::scan("/proc");
+  if (pids.isError()) {
+    return Error("Failed to list files in /proc: " + pids.error());
   }
 
-  if (!pids.empty()) {
-    return pids;
+  if (!pids.get().empty()) {
+    return pids.get();
   }
 
   return Error("Failed to determine pids from /proc");
@@ -320,26 +394,145 @@ inline Try<std::set<pid_t>> threads(pid_t pid)
 {
   const std::string path = path::join("/proc", stringify(pid), "task");
 
-  std::set<pid_t> threads;
+  Try<std::set<pid_t>> threads = internal::scan(path);
+  if (threads.isError()) {
+    return Error("Failed to list files in " + path + ": " + threads.error());
+  }
 
-  Try<std::list<std::string>> entries = os::ls(path);
-  if (entries.isError()) {
-    return Error("Failed to list files in " + path + ": " + entries.error());
+  if (!threads.get().empty()) {
+    return threads.get();
   }
 
-  foreach (const std::string& entry, entries.get()) {
-    Try<pid_t> thread = numify<pid_t>(entry);
-    if (thread.isSome()) {
-      threads.insert(thread.get());
+  return Error("Failed to determine thread ids from /proc");
+}
+
+
+// A point-in-time snapshot of /proc: every process together with
+// the contents of its stat and cmdline files, captured in one pass
+// with a bounded number of syscalls. The processes are enumerated
+// with a getdents64(2) scan and each file is read through
+// openat(2) relative to a single /proc file descriptor, so no path
+// is resolved per process. Prefer this over calling proc::status
+// per pid when querying many processes at once (e.g., collecting a
+// process tree during agent recovery).
+class Snapshot
+{
+public:
+  static Try<Snapshot> create()
+  {
+    Try<std::set<pid_t>> pids = proc::pids();
+    if (pids.isError()) {
+      return Error(pids.error());
     }
+
+    int dirfd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd == -1) {
+      return ErrnoError("Failed to open '/proc'");
+    }
+
+    Snapshot snapshot;
+
+    foreach (pid_t pid, pids.get()) {
+      const std::string prefix = stringify(pid);
+
+      // Processes that terminate mid-scan are simply skipped, just
+      // as the per-pid readers treat a vanished process as None.
+      Option<std::string> status = read(dirfd, prefix + "/stat");
+      if (status.isNone()) {
+        continue;
+      }
+
+      Option<std::string> cmdline = read(dirfd, prefix + "/cmdline");
+      if (cmdline.isNone()) {
+        continue;
+      }
+
+      snapshot.pids_.insert(pid);
+      snapshot.statuses.put(pid, std::move(status.get()));
+      snapshot.cmdlines.put(pid, std::move(cmdline.get()));
+    }
+
+    ::close(dirfd);
+
+    return snapshot;
   }
 
-  if (!threads.empty()) {
-    return threads;
+  // The processes that were live when the snapshot was taken.
+  const std::set<pid_t>& pids() const { return pids_; }
+
+  // Returns the process statistics captured from
+  // /proc/[pid]/stat, or None if the process had already
+  // terminated when the snapshot was taken.
+  Result<ProcessStatus> status(pid_t pid) const
+  {
+    Option<std::string> contents = statuses.get(pid);
+    if (contents.isNone()) {
+      return None();
+    }
+
+    Try<ProcessStatus> status = internal::parse(
+        pid, contents.get(), "/proc/" + stringify(pid) + "/stat");
+
+    if (status.isError()) {
+      return Error(status.error());
+    }
+
+    return status.get();
   }
 
-  return Error("Failed to determine thread ids from /proc");
-}
+  // Returns the command line captured from /proc/[pid]/cmdline
+  // with the arguments separated by spaces (as proc::cmdline
+  // renders it), or None if the process had already terminated.
+  Result<std::string> cmdline(pid_t pid) const
+  {
+    Option<std::string> contents = cmdlines.get(pid);
+    if (contents.isNone()) {
+      return None();
+    }
+
+    // The raw file separates (and terminates) the arguments with
+    // null bytes.
+    std::string result = contents.get();
+    std::replace(result.begin(), result.end(), '\0', ' ');
+    return result;
+  }
+
+private:
+  Snapshot() = default;
+
+  // Reads a file relative to the /proc file descriptor, returning
+  // None if it cannot be opened or read (i.e., the process exited).
+  static Option<std::string> read(int dirfd, const std::string& path)
+  {
+    int fd = ::openat(dirfd, path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      return None();
+    }
+
+    std::string contents;
+    char buffer[4096];
+
+    while (true) {
+      ssize_t size = ::read(fd, buffer, sizeof(buffer));
+      if (size == -1) {
+        ::close(fd);
+        return None();
+      } else if (size == 0) {
+        break;
+      }
+
+      contents.append(buffer, size);
+    }
+
+    ::close(fd);
+
+    return contents;
+  }
+
+  std::set<pid_t> pids_;
+  hashmap<pid_t, std::string> statuses;
+  hashmap<pid_t, std::string> cmdlines;
+};
 
 
 // Snapshot of a system (modeled after /proc/stat).
@@ -22,6 +22,7 @@
 
 #include <sys/types.h>
 
+#include <atomic>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -679,6 +680,217 @@ struct Parse<google::protobuf::RepeatedPtrField<T>>
   }
 };
 
+
+// Populates a protobuf message hierarchy directly from the SAX
+// events of a JSON parse (see `JSON::sax` in <stout/json.hpp>),
+// without materializing the intermediate `JSON::Value` tree. The
+// semantics mirror those of the DOM based `internal::parse` above:
+// unknown JSON fields are ignored, 'null' leaves fields unset, and
+// scalar values are applied via the same `Parser` visitor (which
+// handles base64 decoding of bytes fields and enum lookup by name).
+class SaxParser : public JSON::sax::Handler
+{
+public:
+  explicit SaxParser(google::protobuf::Message* message)
+    : root(message), skipping(0) {}
+
+  virtual Try<Nothing> onNull()
+  {
+    if (skipping > 0) {
+      return Nothing();
+    }
+
+    if (frames.empty()) {
+      return Error("Expecting a JSON object");
+    }
+
+    // We treat 'null' as an unset field, like the DOM based parser.
+    consumed(&frames.back());
+    return Nothing();
+  }
+
+  virtual Try<Nothing> onBoolean(bool value)
+  {
+    return scalar(JSON::Boolean(value));
+  }
+
+  virtual Try<Nothing> onInteger(int64_t value)
+  {
+    return scalar(JSON::Number(value));
+  }
+
+  virtual Try<Nothing> onDouble(double value)
+  {
+    return scalar(JSON::Number(value));
+  }
+
+  virtual Try<Nothing> onString(std::string&& value)
+  {
+    JSON::String string;
+    string.value = std::move(value);
+    return scalar(string);
+  }
+
+  virtual Try<Nothing> onObjectStart()
+  {
+    if (skipping > 0) {
+      ++skipping;
+      return Nothing();
+    }
+
+    if (frames.empty()) {
+      frames.push_back(Frame{root, nullptr, 0});
+      return Nothing();
+    }
+
+    Frame& frame = frames.back();
+
+    if (frame.field == nullptr) {
+      // An object for an unknown field; ignore the entire subtree.
+      skipping = 1;
+      return Nothing();
+    }
+
+    if (frame.field->type() !=
+        google::protobuf::FieldDescriptor::TYPE_MESSAGE) {
+      return Error("Not expecting a JSON object for field '" +
+                   frame.field->name() + "'");
+    }
+
+    const google::protobuf::Reflection* reflection =
+      frame.message->GetReflection();
+
+    google::protobuf::Message* child = frame.field->is_repeated()
+      ? reflection->AddMessage(frame.message, frame.field)
+      : reflection->MutableMessage(frame.message, frame.field);
+
+    frames.push_back(Frame{child, nullptr, 0});
+    return Nothing();
+  }
+
+  virtual Try<Nothing> onKey(std::string&& key)
+  {
+    if (skipping > 0) {
+      return Nothing();
+    }
+
+    Frame& frame = frames.back();
+
+    // An unknown field results in a `nullptr` here, which causes the
+    // upcoming value (including any nested subtree) to be ignored.
+    frame.field = frame.message->GetDescriptor()->FindFieldByName(key);
+    return Nothing();
+  }
+
+  virtual Try<Nothing> onObjectEnd()
+  {
+    if (skipping > 0) {
+      --skipping;
+      return Nothing();
+    }
+
+    frames.pop_back();
+
+    if (!frames.empty()) {
+      consumed(&frames.back());
+    }
+
+    return Nothing();
+  }
+
+  virtual Try<Nothing> onArrayStart()
+  {
+    if (skipping > 0) {
+      ++skipping;
+      return Nothing();
+    }
+
+    if (frames.empty()) {
+      return Error("Expecting a JSON object");
+    }
+
+    Frame& frame = frames.back();
+
+    if (frame.field == nullptr) {
+      skipping = 1;
+      return Nothing();
+    }
+
+    if (!frame.field->is_repeated()) {
+      return Error("Not expecting a JSON array for field '" +
+                   frame.field->name() + "'");
+    }
+
+    ++frame.arrays;
+    return Nothing();
+  }
+
+  virtual Try<Nothing> onArrayEnd()
+  {
+    if (skipping > 0) {
+      --skipping;
+      return Nothing();
+    }
+
+    Frame& frame = frames.back();
+
+    --frame.arrays;
+    consumed(&frame);
+    return Nothing();
+  }
+
+private:
+  // The current position in the message hierarchy: the innermost
+  // message being populated, the field the next value applies to (or
+  // `nullptr` if there is none, e.g., for unknown fields), and the
+  // nesting depth of JSON arrays for that field.
+  struct Frame
+  {
+    google::protobuf::Message* message;
+    const google::protobuf::FieldDescriptor* field;
+    size_t arrays;
+  };
+
+  // A singular field is complete after a single value; inside an
+  // array the field stays pending for the subsequent elements.
+  static void consumed(Frame* frame)
+  {
+    if (frame->arrays == 0) {
+      frame->field = nullptr;
+    }
+  }
+
+  template <typename T>
+  Try<Nothing> scalar(const T& value)
+  {
+    if (skipping > 0) {
+      return Nothing();
+    }
+
+    if (frames.empty()) {
+      return Error("Expecting a JSON object");
+    }
+
+    Frame& frame = frames.back();
+
+    if (frame.field == nullptr) {
+      return Nothing();
+    }
+
+    Try<Nothing> apply = Parser(frame.message, frame.field)(value);
+    if (apply.isError()) {
+      return Error(apply.error());
+    }
+
+    consumed(&frame);
+    return Nothing();
+  }
+
+  google::protobuf::Message* root;
+  std::vector<Frame> frames;
+  size_t skipping;
+};
+
 } // namespace internal {
 
 // A dispatch wrapper which parses protobuf messages(s) from a given JSON value.
@@ -695,6 +907,44 @@ Try<T> parse(const JSON::Value& value)
   return internal::Parse<T>()(value);
 }
 
+
+// Parses a single protobuf message of type T directly from a JSON
+// string, using SAX style parsing (see `JSON::sax` in
+// <stout/json.hpp>) so that no intermediate `JSON::Value` tree is
+// materialized. The semantics match `parse<T>(const JSON::Value&)`
+// applied to a `JSON::Object`.
+template <typename T>
+Try<T> parse(const std::string& s)
+{
+  static_assert(std::is_convertible<T*, google::protobuf::Message*>::value,
+                "T must be a protobuf message");
+
+  T message;
+
+  internal::SaxParser parser(&message);
+
+  Try<Nothing> parse = JSON::sax::parse(s, &parser);
+  if (parse.isError()) {
+    return Error(parse.error());
+  }
+
+  if (!message.IsInitialized()) {
+    return Error("Missing required fields: " +
+                 message.InitializationErrorString());
+  }
+
+  return message;
+}
+
+
+// NOTE: This overload disambiguates string literals, which are
+// otherwise equally convertible to `std::string` and `JSON::Value`.
+template <typename T>
+Try<T> parse(const char* s)
+{
+  return parse<T>(std::string(s));
+}
+
 } // namespace protobuf {
 
 namespace JSON {
@@ -707,138 +957,392 @@ struct Protobuf : Representation<google::protobuf::Message>
 };
 
 
-// `json` function for protobuf messages. Refer to `jsonify.hpp` for details.
-// TODO(mpark): This currently uses the default value for optional fields with
-// a default that are not set, but we may want to revisit this decision.
-inline void json(ObjectWriter* writer, const Protobuf& protobuf)
+namespace internal {
+
+// A compiled serialization plan for one message type: the per-field
+// dispatch over the field's type, its JSON name and whether it is
+// bytes (base64) or has a default are resolved once, when a
+// descriptor is first serialized, and reused for every subsequent
+// message of that type. This keeps the master's state endpoints,
+// which render tens of thousands of messages of a handful of types,
+// from re-interrogating the descriptor for every field of every
+// message.
+class WritePlan
 {
-  using google::protobuf::FieldDescriptor;
+public:
+  // Returns the plan for the given descriptor, compiling it on
+  // first use. Plans are kept in an append-only immutable list so
+  // lookups are lock-free: readers just load the head and walk.
+  static const WritePlan* get(
+      const google::protobuf::Descriptor* descriptor)
+  {
+    static std::atomic<Entry*>* head = new std::atomic<Entry*>(nullptr);
 
-  const google::protobuf::Message& message = protobuf;
+    Entry* first = head->load(std::memory_order_acquire);
 
-  const google::protobuf::Descriptor* descriptor = message.GetDescriptor();
-  const google::protobuf::Reflection* reflection = message.GetReflection();
+    for (Entry* entry = first; entry != nullptr; entry = entry->next) {
+      if (entry->descriptor == descriptor) {
+        return entry->plan;
+      }
+    }
 
-  // We first look through all the possible fields to determine both the set
-  // fields __and__ the optional fields with a default that are not set.
-  // `Reflection::ListFields()` alone will only include set fields and
-  // is therefore insufficient.
-  int fieldCount = descriptor->field_count();
-  std::vector<const FieldDescriptor*> fields;
-  fields.reserve(fieldCount);
-  for (int i = 0; i < fieldCount; ++i) {
-    const FieldDescriptor* field = descriptor->field(i);
-    if (field->is_repeated()) {
-      if (reflection->FieldSize(message, field) > 0) {
-        // Has repeated field with members, output as JSON.
-        fields.push_back(field);
+    Entry* inserted = new Entry(descriptor, first);
+
+    while (!head->compare_exchange_weak(
+               inserted->next,
+               inserted,
+               std::memory_order_release,
+               std::memory_order_acquire)) {
+      // Lost a race: another thread may have compiled this very
+      // descriptor, in which case we discard our copy.
+      for (Entry* entry = inserted->next;
+           entry != first;
+           entry = entry->next) {
+        if (entry->descriptor == descriptor) {
+          delete inserted;
+          return entry->plan;
+        }
       }
-    } else if (reflection->HasField(message, field) ||
-               field->has_default_value()) {
-      // Field is set or has default, output as JSON.
+    }
+
+    return inserted->plan;
+  }
+
+  void write(
+      ObjectWriter* writer,
+      const google::protobuf::Message& message) const
+  {
+    const google::protobuf::Reflection* reflection =
+      message.GetReflection();
+
+    // Set fields _and_ unset optional fields with a default are
+    // output; `Reflection::ListFields()` alone would only include
+    // the former.
+    foreach (const Field& field, fields) {
+      if (field.repeated) {
+        if (reflection->FieldSize(message, field.descriptor) > 0) {
+          field.write(writer, reflection, message, field.descriptor);
+        }
+      } else if (field.hasDefault ||
+                 reflection->HasField(message, field.descriptor)) {
+        field.write(writer, reflection, message, field.descriptor);
+      }
+    }
+  }
+
+private:
+  typedef void (*Writer)(
+      ObjectWriter* writer,
+      const google::protobuf::Reflection* reflection,
+      const google::protobuf::Message& message,
+      const google::protobuf::FieldDescriptor* field);
+
+  struct Field
+  {
+    const google::protobuf::FieldDescriptor* descriptor;
+    bool repeated;
+    bool hasDefault;
+    Writer write;
+  };
+
+  struct Entry
+  {
+    Entry(const google::protobuf::Descriptor* _descriptor, Entry* _next)
+      : descriptor(_descriptor), plan(new WritePlan(_descriptor)), next(_next)
+    {}
+
+    ~Entry() { delete plan; }
+
+    const google::protobuf::Descriptor* descriptor;
+    const WritePlan* plan;
+    Entry* next;
+  };
+
+  explicit WritePlan(const google::protobuf::Descriptor* descriptor)
+  {
+    fields.reserve(descriptor->field_count());
+
+    for (int i = 0; i < descriptor->field_count(); ++i) {
+      Field field;
+      field.descriptor = descriptor->field(i);
+      field.repeated = field.descriptor->is_repeated();
+      field.hasDefault = field.descriptor->has_default_value();
+      field.write = field.repeated
+        ? repeated(field.descriptor)
+        : singular(field.descriptor);
       fields.push_back(field);
     }
   }
 
-  foreach (const FieldDescriptor* field, fields) {
-    if (field->is_repeated()) {
-      writer->field(
-          field->name(),
-          [&field, &reflection, &message](JSON::ArrayWriter* writer) {
-            int fieldSize = reflection->FieldSize(message, field);
-            for (int i = 0; i < fieldSize; ++i) {
-              switch (field->cpp_type()) {
-                case FieldDescriptor::CPPTYPE_BOOL:
-                  writer->element(
-                      reflection->GetRepeatedBool(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_INT32:
-                  writer->element(
-                      reflection->GetRepeatedInt32(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_INT64:
-                  writer->element(
-                      reflection->GetRepeatedInt64(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_UINT32:
-                  writer->element(
-                      reflection->GetRepeatedUInt32(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_UINT64:
-                  writer->element(
-                      reflection->GetRepeatedUInt64(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_FLOAT:
-                  writer->element(
-                      reflection->GetRepeatedFloat(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_DOUBLE:
-                  writer->element(
-                      reflection->GetRepeatedDouble(message, field, i));
-                  break;
-                case FieldDescriptor::CPPTYPE_MESSAGE:
-                  writer->element(Protobuf(
-                      reflection->GetRepeatedMessage(message, field, i)));
-                  break;
-                case FieldDescriptor::CPPTYPE_ENUM:
-                  writer->element(
-                      reflection->GetRepeatedEnum(message, field, i)->name());
-                  break;
-                case FieldDescriptor::CPPTYPE_STRING:
-                  const std::string& s = reflection->GetRepeatedStringReference(
-                      message, field, i, nullptr);
-                  if (field->type() == FieldDescriptor::TYPE_BYTES) {
-                    writer->element(base64::encode(s));
-                  } else {
-                    writer->element(s);
-                  }
-                  break;
-              }
-            }
-          });
-    } else {
-      switch (field->cpp_type()) {
-        case FieldDescriptor::CPPTYPE_BOOL:
+  // Resolves the writer for a singular field.
+  static Writer singular(const google::protobuf::FieldDescriptor* field)
+  {
+    using google::protobuf::FieldDescriptor;
+    using google::protobuf::Message;
+    using google::protobuf::Reflection;
+
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetBool(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_INT32:
+        };
+      case FieldDescriptor::CPPTYPE_INT32:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetInt32(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_INT64:
+        };
+      case FieldDescriptor::CPPTYPE_INT64:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetInt64(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_UINT32:
+        };
+      case FieldDescriptor::CPPTYPE_UINT32:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetUInt32(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_UINT64:
+        };
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetUInt64(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_FLOAT:
+        };
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetFloat(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_DOUBLE:
+        };
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(field->name(), reflection->GetDouble(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_MESSAGE:
+        };
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(
               field->name(), Protobuf(reflection->GetMessage(message, field)));
-          break;
-        case FieldDescriptor::CPPTYPE_ENUM:
+        };
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
           writer->field(
               field->name(), reflection->GetEnum(message, field)->name());
-          break;
-        case FieldDescriptor::CPPTYPE_STRING:
-          const std::string& s = reflection->GetStringReference(
-              message, field, nullptr);
-          if (field->type() == FieldDescriptor::TYPE_BYTES) {
-            writer->field(field->name(), base64::encode(s));
-          } else {
-            writer->field(field->name(), s);
-          }
-          break;
-      }
+        };
+      case FieldDescriptor::CPPTYPE_STRING:
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          return [](ObjectWriter* writer,
+                    const Reflection* reflection,
+                    const Message& message,
+                    const FieldDescriptor* field) {
+            writer->field(
+                field->name(),
+                base64::encode(
+                    reflection->GetStringReference(message, field, nullptr)));
+          };
+        }
+
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(
+              field->name(),
+              reflection->GetStringReference(message, field, nullptr));
+        };
     }
+
+    ABORT("Unhandled protobuf field type: " + stringify(field->type()));
   }
+
+  // Resolves the writer for a repeated field.
+  static Writer repeated(const google::protobuf::FieldDescriptor* field)
+  {
+    using google::protobuf::FieldDescriptor;
+    using google::protobuf::Message;
+    using google::protobuf::Reflection;
+
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(reflection->GetRepeatedBool(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_INT32:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(reflection->GetRepeatedInt32(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_INT64:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(reflection->GetRepeatedInt64(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_UINT32:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(
+                  reflection->GetRepeatedUInt32(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(
+                  reflection->GetRepeatedUInt64(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(reflection->GetRepeatedFloat(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(
+                  reflection->GetRepeatedDouble(message, field, i));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(Protobuf(
+                  reflection->GetRepeatedMessage(message, field, i)));
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(
+                  reflection->GetRepeatedEnum(message, field, i)->name());
+            }
+          });
+        };
+      case FieldDescriptor::CPPTYPE_STRING:
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          return [](ObjectWriter* writer,
+                    const Reflection* reflection,
+                    const Message& message,
+                    const FieldDescriptor* field) {
+            writer->field(field->name(), [&](ArrayWriter* writer) {
+              int size = reflection->FieldSize(message, field);
+              for (int i = 0; i < size; ++i) {
+                writer->element(base64::encode(
+                    reflection->GetRepeatedStringReference(
+                        message, field, i, nullptr)));
+              }
+            });
+          };
+        }
+
+        return [](ObjectWriter* writer,
+                  const Reflection* reflection,
+                  const Message& message,
+                  const FieldDescriptor* field) {
+          writer->field(field->name(), [&](ArrayWriter* writer) {
+            int size = reflection->FieldSize(message, field);
+            for (int i = 0; i < size; ++i) {
+              writer->element(
+                  reflection->GetRepeatedStringReference(
+                      message, field, i, nullptr));
+            }
+          });
+        };
+    }
+
+    ABORT("Unhandled protobuf field type: " + stringify(field->type()));
+  }
+
+  std::vector<Field> fields;
+};
+
+} // namespace internal {
+
+
+// `json` function for protobuf messages. Refer to `jsonify.hpp` for details.
+// TODO(mpark): This currently uses the default value for optional fields with
+// a default that are not set, but we may want to revisit this decision.
+inline void json(ObjectWriter* writer, const Protobuf& protobuf)
+{
+  const google::protobuf::Message& message = protobuf;
+
+  internal::WritePlan::get(message.GetDescriptor())->write(writer, message);
 }
 
 
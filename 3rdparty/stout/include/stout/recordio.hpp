@@ -14,13 +14,14 @@
 #define __STOUT_RECORDIO_HPP__
 
 #include <stdlib.h>
+#include <string.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <string>
 
 #include <stout/check.hpp>
-#include <stout/foreach.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/stringify.hpp>
@@ -49,6 +50,21 @@
  */
 namespace recordio {
 
+/**
+ * Returns the "Record-IO" length header for a record of the
+ * specified size: the size encoded in base 10, followed by the
+ * newline delimiter. Callers that can write a sequence of buffers
+ * can emit the header and the record separately rather than
+ * copying the record into a contiguous frame.
+ */
+inline std::string header(size_t size)
+{
+  std::string header = stringify(size);
+  header += '\n';
+  return header;
+}
+
+
 /**
  * Given an encoding function for individual records, this
  * provides encoding from typed records into "Record-IO" data.
@@ -65,8 +81,15 @@ public:
    */
   std::string encode(const T& record) const
   {
-    std::string s = serialize(record);
-    return stringify(s.size()) + "\n" + s;
+    const std::string s = serialize(record);
+    const std::string prefix = header(s.size());
+
+    std::string encoded;
+    encoded.reserve(prefix.size() + s.size());
+    encoded += prefix;
+    encoded += s;
+
+    return encoded;
   }
 
 private:
@@ -105,14 +128,22 @@ public:
 
     std::deque<Try<T>> records;
 
-    foreach (char c, data) {
+    size_t offset = 0;
+
+    while (offset < data.size()) {
       if (state == HEADER) {
         // Keep reading until we have the entire header.
-        if (c != '\n') {
-          buffer += c;
-          continue;
+        const char* newline = static_cast<const char*>(
+            memchr(data.data() + offset, '\n', data.size() - offset));
+
+        if (newline == nullptr) {
+          buffer.append(data, offset, std::string::npos);
+          break;
         }
 
+        buffer.append(data, offset, newline - data.data() - offset);
+        offset = newline - data.data() + 1;
+
         Try<size_t> numify = ::numify<size_t>(buffer);
 
         // If we were unable to decode the length header, do not
@@ -132,12 +163,19 @@ public:
         if (numify.get() <= 0) {
           records.push_back(deserialize(buffer));
           state = HEADER;
+        } else {
+          buffer.reserve(length.get());
         }
       } else if (state == RECORD) {
         CHECK_SOME(length);
         CHECK_LT(buffer.size(), length.get());
 
-        buffer += c;
+        // Consume the record in bulk rather than a byte at a time.
+        size_t size =
+          std::min(length.get() - buffer.size(), data.size() - offset);
+
+        buffer.append(data, offset, size);
+        offset += size;
 
         if (buffer.size() == length.get()) {
           records.push_back(deserialize(buffer));
@@ -158,8 +196,9 @@ private:
     FAILED
   } state;
 
-  // TODO(bmahler): Avoid string here as it will not free
-  // its underlying memory allocation when we clear it.
+  // NOTE: `clear` does not free the underlying allocation, so
+  // the buffer's capacity is deliberately reused (and only ever
+  // grown) across records.
   std::string buffer;
   Option<size_t> length;
 
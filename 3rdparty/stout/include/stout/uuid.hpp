@@ -14,11 +14,13 @@
 #define __STOUT_UUID_HPP__
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
+#include <random>
 #include <stdexcept>
 #include <string>
 
-#include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/string_generator.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -43,10 +45,56 @@ struct UUID : boost::uuids::uuid
 public:
   static UUID random()
   {
-    static THREAD_LOCAL boost::uuids::random_generator* generator = nullptr;
+    // A per-thread PRNG-backed generator: drawing from the system
+    // entropy source is expensive, so we only do so to seed (and
+    // periodically reseed) the PRNG and fill the 16 bytes of each
+    // version 4 UUID from the PRNG directly. The master generates
+    // a UUID per offer and per status update, so this needs to be
+    // no more than a few nanoseconds.
+    struct Generator
+    {
+      Generator() { reseed(); }
+
+      boost::uuids::uuid operator()()
+      {
+        if (--remaining == 0) {
+          reseed();
+        }
+
+        boost::uuids::uuid uuid;
+
+        uint64_t random[2] = {prng(), prng()};
+
+        static_assert(
+            sizeof(random) == sizeof(uuid.data),
+            "Expecting a 16 byte UUID");
+
+        memcpy(uuid.data, random, sizeof(random));
+
+        // Set the variant and version bits for a version 4
+        // (randomly generated) UUID, per RFC 4122.
+        uuid.data[8] = (uuid.data[8] & 0x3f) | 0x80;
+        uuid.data[6] = (uuid.data[6] & 0x0f) | 0x40;
+
+        return uuid;
+      }
+
+      void reseed()
+      {
+        std::random_device device;
+        std::seed_seq seed{device(), device(), device(), device()};
+        prng.seed(seed);
+        remaining = 1 << 20;
+      }
+
+      std::mt19937_64 prng;
+      size_t remaining;
+    };
+
+    static THREAD_LOCAL Generator* generator = nullptr;
 
     if (generator == nullptr) {
-      generator = new boost::uuids::random_generator();
+      generator = new Generator();
     }
 
     return UUID((*generator)());
@@ -74,7 +122,7 @@ public:
   {
     try {
       // NOTE: We don't use THREAD_LOCAL for the `string_generator`
-      // (unlike for the `random_generator` above), because it is cheap
+      // (unlike for the generator in `random` above), because it is cheap
       // to construct one each time.
       boost::uuids::string_generator gen;
       boost::uuids::uuid uuid = gen(s);
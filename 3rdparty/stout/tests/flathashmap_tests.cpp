@@ -0,0 +1,187 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <ctype.h>
+
+#include <map>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <stout/flathashmap.hpp>
+#include <stout/gtest.hpp>
+
+using std::string;
+
+
+TEST(FlatHashMapTest, InitializerList)
+{
+  flathashmap<string, int> map{{"hello", 1}};
+  EXPECT_EQ(1, map.size());
+
+  EXPECT_TRUE((flathashmap<int, int>{}.empty()));
+
+  flathashmap<int, int> map2{{1, 2}, {2, 3}, {3, 4}};
+  EXPECT_EQ(3, map2.size());
+  EXPECT_SOME_EQ(2, map2.get(1));
+  EXPECT_SOME_EQ(3, map2.get(2));
+  EXPECT_SOME_EQ(4, map2.get(3));
+  EXPECT_NONE(map2.get(4));
+}
+
+
+TEST(FlatHashMapTest, FromStdMap)
+{
+  std::map<int, int> map1{{1, 2}, {2, 3}};
+
+  flathashmap<int, int> map2(map1);
+
+  EXPECT_EQ(2, map1.size());
+  EXPECT_EQ(2, map2.size());
+
+  EXPECT_EQ(2, map1[1]);
+  EXPECT_SOME_EQ(2, map2.get(1));
+
+  EXPECT_EQ(3, map1[2]);
+  EXPECT_SOME_EQ(3, map2.get(2));
+}
+
+
+TEST(FlatHashMapTest, Insert)
+{
+  flathashmap<string, int> map;
+  map["abc"] = 1;
+  map.put("def", 2);
+
+  ASSERT_SOME_EQ(1, map.get("abc"));
+  ASSERT_SOME_EQ(2, map.get("def"));
+
+  map.put("def", 4);
+  ASSERT_SOME_EQ(4, map.get("def"));
+  ASSERT_EQ(2, map.size());
+}
+
+
+TEST(FlatHashMapTest, Contains)
+{
+  flathashmap<string, int> map;
+  map["abc"] = 1;
+
+  ASSERT_TRUE(map.contains("abc"));
+  ASSERT_TRUE(map.containsValue(1));
+
+  ASSERT_FALSE(map.contains("def"));
+  ASSERT_FALSE(map.containsValue(2));
+}
+
+
+TEST(FlatHashMapTest, Erase)
+{
+  flathashmap<int, string> map;
+  map[1] = "one";
+  map[2] = "two";
+  map[3] = "three";
+
+  EXPECT_EQ(1, map.erase(2));
+  EXPECT_EQ(0, map.erase(2));
+
+  EXPECT_EQ(2, map.size());
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_SOME_EQ("one", map.get(1));
+  EXPECT_SOME_EQ("three", map.get(3));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_NONE(map.get(1));
+}
+
+
+// Churns insertions and erasures across many rehashes to exercise
+// the probing, backward shift deletion and growth logic.
+TEST(FlatHashMapTest, Churn)
+{
+  flathashmap<int, int> map;
+
+  for (int i = 0; i < 10000; ++i) {
+    map[i] = i * 2;
+  }
+
+  ASSERT_EQ(10000, map.size());
+
+  for (int i = 0; i < 10000; i += 2) {
+    ASSERT_EQ(1, map.erase(i));
+  }
+
+  ASSERT_EQ(5000, map.size());
+
+  for (int i = 0; i < 10000; ++i) {
+    if (i % 2 == 0) {
+      ASSERT_FALSE(map.contains(i));
+    } else {
+      ASSERT_SOME_EQ(i * 2, map.get(i));
+    }
+  }
+
+  size_t entries = 0;
+  foreachpair (const int key, const int value, map) {
+    ASSERT_EQ(key * 2, value);
+    ++entries;
+  }
+
+  ASSERT_EQ(map.size(), entries);
+  ASSERT_EQ(5000, map.keys().size());
+  ASSERT_EQ(5000, map.values().size());
+}
+
+
+TEST(FlatHashMapTest, CustomHashAndEqual)
+{
+  struct CaseInsensitiveHash
+  {
+    size_t operator()(const string& key) const
+    {
+      size_t seed = 0;
+      foreach (const char c, key) {
+        boost::hash_combine(seed, ::tolower(c));
+      }
+      return seed;
+    }
+  };
+
+  struct CaseInsensitiveEqual
+  {
+    bool operator()(const string& left, const string& right) const
+    {
+      if (left.size() != right.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < left.size(); ++i) {
+        if (::tolower(left[i]) != ::tolower(right[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  flathashmap<string, int, CaseInsensitiveHash, CaseInsensitiveEqual> map;
+
+  map["abc"] = 1;
+  EXPECT_SOME_EQ(1, map.get("ABC"));
+
+  map.put("ABC", 2);
+  EXPECT_SOME_EQ(2, map.get("abc"));
+  EXPECT_EQ(1, map.size());
+}
@@ -273,6 +273,82 @@ TEST(JsonTest, ParseError)
 }
 
 
+// Tests the SAX style parsing interface by recording the events as
+// a token string.
+TEST(JsonTest, SaxParse)
+{
+  class Recorder : public JSON::sax::Handler
+  {
+  public:
+    virtual Try<Nothing> onNull() { tokens += "null;"; return Nothing(); }
+
+    virtual Try<Nothing> onBoolean(bool value)
+    {
+      tokens += value ? "true;" : "false;";
+      return Nothing();
+    }
+
+    virtual Try<Nothing> onInteger(int64_t value)
+    {
+      tokens += "int:" + stringify(value) + ";";
+      return Nothing();
+    }
+
+    virtual Try<Nothing> onDouble(double value)
+    {
+      tokens += "double;";
+      return Nothing();
+    }
+
+    virtual Try<Nothing> onString(string&& value)
+    {
+      tokens += "string:" + value + ";";
+      return Nothing();
+    }
+
+    virtual Try<Nothing> onObjectStart() { tokens += "{"; return Nothing(); }
+
+    virtual Try<Nothing> onKey(string&& key)
+    {
+      tokens += "key:" + key + ";";
+      return Nothing();
+    }
+
+    virtual Try<Nothing> onObjectEnd() { tokens += "}"; return Nothing(); }
+    virtual Try<Nothing> onArrayStart() { tokens += "["; return Nothing(); }
+    virtual Try<Nothing> onArrayEnd() { tokens += "]"; return Nothing(); }
+
+    string tokens;
+  };
+
+  Recorder recorder;
+
+  EXPECT_SOME(JSON::sax::parse(
+      "{\"a\": 1, \"b\": [true, null, -1.42, \"x\"], \"c\": {}} ",
+      &recorder));
+
+  EXPECT_EQ(
+      "{key:a;int:1;key:b;[true;null;double;string:x;]key:c;{}}",
+      recorder.tokens);
+
+  // Syntax errors and trailing characters are rejected.
+  EXPECT_ERROR(JSON::sax::parse("{\"a\": }", &recorder));
+  EXPECT_ERROR(JSON::sax::parse("{\"a\": 1} x", &recorder));
+
+  // Errors returned by the handler abort the parse.
+  class Failing : public Recorder
+  {
+    virtual Try<Nothing> onInteger(int64_t) { return Error("forbidden"); }
+  };
+
+  Failing failing;
+
+  Try<Nothing> parse = JSON::sax::parse("{\"a\": 1}", &failing);
+  EXPECT_ERROR(parse);
+  EXPECT_EQ("forbidden", parse.error());
+}
+
+
 TEST(JsonTest, Find)
 {
   Try<JSON::Value> value = JSON::parse(
@@ -50,6 +50,10 @@ TEST(JsonifyTest, Number)
 
   // Expect at least 15 digits of precision.
   EXPECT_EQ("1234567890.12345", string(jsonify(1234567890.12345)));
+
+  // Whole numbers outside of the integral fast path.
+  EXPECT_EQ("-0.0", string(jsonify(-0.0)));
+  EXPECT_EQ("1.00000000000000e+16", string(jsonify(1e16)));
 }
 
 
@@ -60,6 +64,16 @@ TEST(JsonifyTest, String)
   EXPECT_EQ(
       "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0000\\u0019 !#[]\\u007f\xFF\"",
       string(jsonify(string("\"\\/\b\f\n\r\t\x00\x19 !#[]\x7F\xFF", 17))));
+
+  // Runs longer than the vectorized scan width, both clean and with
+  // escapes at various offsets within a chunk.
+  const string clean(64, 'a');
+  EXPECT_EQ("\"" + clean + "\"", string(jsonify(clean)));
+
+  const string interleaved = clean + "\"" + clean + "\n" + clean;
+  EXPECT_EQ(
+      "\"" + clean + "\\\"" + clean + "\\n" + clean + "\"",
+      string(jsonify(interleaved)));
 }
 
 
@@ -14,9 +14,11 @@
 
 #include <list>
 #include <string>
+#include <utility>
 
 #include <gtest/gtest.h>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/linkedhashmap.hpp>
 
@@ -104,3 +106,53 @@ TEST(LinkedHashmapTest, Values)
     ASSERT_EQ(val, value);
   }
 }
+
+
+// Copies and moves have to rebuild or transfer the insertion order
+// links rather than leave them referring to the source's entries.
+TEST(LinkedHashmapTest, CopyAndMove)
+{
+  LinkedHashMap<string, int> map;
+
+  map["foo"] = 1;
+  map["bar"] = 2;
+  map["caz"] = 3;
+
+  LinkedHashMap<string, int> copy(map);
+  ASSERT_EQ(map.keys(), copy.keys());
+  ASSERT_EQ(map.values(), copy.values());
+
+  // Mutating the copy must not affect the original.
+  copy["qux"] = 4;
+  ASSERT_EQ(1, copy.erase("bar"));
+  ASSERT_FALSE(map.contains("qux"));
+  ASSERT_EQ(3, map.size());
+  ASSERT_TRUE(map.contains("bar"));
+
+  LinkedHashMap<string, int> moved(std::move(copy));
+  ASSERT_EQ(list<string>({"foo", "caz", "qux"}), moved.keys());
+}
+
+
+TEST(LinkedHashmapTest, Foreach)
+{
+  LinkedHashMap<string, int> map;
+
+  map["foo"] = 1;
+  map["bar"] = 2;
+  map["caz"] = 3;
+
+  map.erase("bar");
+  map["qux"] = 4;
+
+  list<string> keys;
+  list<int> values;
+
+  foreachpair (const string& key, int value, map) {
+    keys.push_back(key);
+    values.push_back(value);
+  }
+
+  EXPECT_EQ(list<string>({"foo", "caz", "qux"}), keys);
+  EXPECT_EQ(list<int>({1, 3, 4}), values);
+}
@@ -77,6 +77,31 @@ TEST(ProcTest, ProcessStatus)
 }
 
 
+TEST(ProcTest, Snapshot)
+{
+  Try<proc::Snapshot> snapshot = proc::Snapshot::create();
+
+  ASSERT_SOME(snapshot);
+  EXPECT_EQ(1u, snapshot.get().pids().count(getpid()));
+
+  // The snapshot must agree with the per-pid readers.
+  Result<ProcessStatus> status = snapshot.get().status(getpid());
+
+  ASSERT_SOME(status);
+  EXPECT_EQ(getpid(), status.get().pid);
+  EXPECT_EQ(getppid(), status.get().ppid);
+
+  Result<string> cmdline = snapshot.get().cmdline(getpid());
+
+  ASSERT_SOME(cmdline);
+  EXPECT_SOME_EQ(cmdline.get(), proc::cmdline(getpid()));
+
+  // A pid that cannot exist was not captured.
+  EXPECT_NONE(snapshot.get().status(-1));
+  EXPECT_NONE(snapshot.get().cmdline(-1));
+}
+
+
 // NOTE: This test assumes there is a single thread running for the test.
 TEST(ProcTest, SingleThread)
 {
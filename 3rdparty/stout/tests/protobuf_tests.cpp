@@ -343,6 +343,53 @@ TEST(ProtobufTest, ParseJSONArray)
 }
 
 
+// Tests the SAX style parsing of a JSON string directly into a
+// protobuf message, which must match parsing via the JSON::Value
+// tree.
+TEST(ProtobufTest, ParseJSONString)
+{
+  tests::Message message;
+  message.set_b(true);
+  message.set_str("string");
+  message.set_bytes("bytes");
+  message.set_int32(-1);
+  message.set_int64(-1);
+  message.set_uint64(1);
+  message.set_f(1.0);
+  message.set_d(1.0);
+  message.set_e(tests::ONE);
+  message.mutable_nested()->set_str("nested");
+  message.add_repeated_bool(true);
+  message.add_repeated_string("repeated_string");
+  message.add_repeated_int32(-2);
+  message.add_repeated_double(1.0);
+  message.add_repeated_double(2.0);
+  message.add_repeated_enum(tests::TWO);
+  message.add_repeated_nested()->set_str("repeated_nested");
+
+  JSON::Object object = JSON::protobuf(message);
+
+  Try<tests::Message> parse =
+    protobuf::parse<tests::Message>(stringify(object));
+  ASSERT_SOME(parse);
+
+  EXPECT_EQ(object, JSON::protobuf(parse.get()));
+
+  // Unknown fields and 'null' values are ignored.
+  Try<tests::Nested> nested = protobuf::parse<tests::Nested>(
+      "{\"str\": \"value\","
+      " \"unknown\": {\"nested\": [1, {\"more\": 2}]},"
+      " \"optional_str\": null}");
+  ASSERT_SOME(nested);
+  EXPECT_EQ("value", nested->str());
+
+  // Errors surface like they do from the DOM based parser.
+  EXPECT_ERROR(protobuf::parse<tests::Nested>("{\"str\": [1]}"));
+  EXPECT_ERROR(protobuf::parse<tests::Nested>("{\"optional_str\": \"x\"}"));
+  EXPECT_ERROR(protobuf::parse<tests::Nested>("{\"str\": \"value\""));
+}
+
+
 TEST(ProtobufTest, ParseJSONNull)
 {
   tests::Nested nested;
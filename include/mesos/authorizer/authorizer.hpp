@@ -17,6 +17,8 @@
 #ifndef __MESOS_AUTHORIZER_AUTHORIZER_HPP__
 #define __MESOS_AUTHORIZER_AUTHORIZER_HPP__
 
+#include <vector>
+
 #include <mesos/mesos.hpp>
 
 // ONLY USEFUL AFTER RUNNING PROTOC.
@@ -144,6 +146,34 @@ public:
   virtual process::Future<bool> authorized(
       const authorization::Request& request) = 0;
 
+  /**
+   * Checks a batch of authorization requests at once. The returned
+   * futures correspond, in order, to the entries of `requests`.
+   *
+   * The default implementation simply issues one `authorized()` call
+   * per request. Back ends for which every call implies a round trip
+   * (e.g. a dispatch to an actor, or a request to an identity
+   * service) should override this to resolve the batch with a single
+   * round trip: the master authorizes the tasks of an ACCEPT call as
+   * one batch, which can span hundreds of tasks.
+   *
+   * @param requests `authorization::Request` instances to verify.
+   *
+   * @return One future per request, as for `authorized()` above.
+   */
+  virtual std::vector<process::Future<bool>> authorized(
+      const std::vector<authorization::Request>& requests)
+  {
+    std::vector<process::Future<bool>> futures;
+    futures.reserve(requests.size());
+
+    for (const authorization::Request& request : requests) {
+      futures.push_back(authorized(request));
+    }
+
+    return futures;
+  }
+
   /**
    * Creates an `ObjectApprover` which can synchronously check authorization on
    * an object.
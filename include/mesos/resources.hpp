@@ -17,10 +17,13 @@
 #ifndef __RESOURCES_HPP__
 #define __RESOURCES_HPP__
 
+#include <stdint.h>
+
 #include <map>
 #include <iosfwd>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <google/protobuf/repeated_field.h>
@@ -76,7 +79,19 @@ private:
   public:
     /*implicit*/ Resource_(const Resource& _resource)
       : resource(_resource),
-        sharedCount(None())
+        sharedCount(None()),
+        fingerprint(computeFingerprint(resource))
+    {
+      // Setting the counter to 1 to denote "one copy" of the shared resource.
+      if (resource.has_shared()) {
+        sharedCount = 1;
+      }
+    }
+
+    /*implicit*/ Resource_(Resource&& _resource)
+      : resource(std::move(_resource)),
+        sharedCount(None()),
+        fingerprint(computeFingerprint(resource))
     {
       // Setting the counter to 1 to denote "one copy" of the shared resource.
       if (resource.has_shared()) {
@@ -124,6 +139,13 @@ private:
         std::ostream& stream, const Resource_& resource_);
 
   private:
+    // Returns a hash of the fields which determine whether two
+    // Resource objects can be combined or compared: name, type, role,
+    // reservation, disk and the revocable and shared markers. The
+    // arithmetic operators never mutate these fields, so the
+    // fingerprint remains valid for the lifetime of the Resource_.
+    static uint64_t computeFingerprint(const Resource& resource);
+
     // The protobuf Resource that is being managed.
     Resource resource;
 
@@ -131,6 +153,13 @@ private:
     // 'resource' is non-shared. This is an int so as to support arithmetic
     // operations involving subtraction.
     Option<int> sharedCount;
+
+    // Fingerprint of the identity fields of 'resource'; see
+    // `computeFingerprint`. Two Resource_ objects with different
+    // fingerprints can never be addable, subtractable or equal, which
+    // lets the arithmetic and comparison paths reject non-matching
+    // pairs with a single integer compare.
+    uint64_t fingerprint;
   };
 
 public:
@@ -507,10 +536,16 @@ public:
   // doing subtraction), the semantics is as though the second operand
   // was actually just an empty resource (as though you didn't do the
   // operation at all).
+  // The rvalue overloads move the protobuf objects out of the right
+  // operand rather than deep-copying them; `Resources` arithmetic is
+  // hot enough in the master for the copies to matter.
   Resources operator+(const Resource& that) const;
   Resources operator+(const Resources& that) const;
+  Resources operator+(Resources&& that) const;
   Resources& operator+=(const Resource& that);
+  Resources& operator+=(Resource&& that);
   Resources& operator+=(const Resources& that);
+  Resources& operator+=(Resources&& that);
 
   Resources operator-(const Resource& that) const;
   Resources operator-(const Resources& that) const;
@@ -541,10 +576,12 @@ private:
   // NOTE: `Resource` objects are implicitly converted to `Resource_`
   // objects, so here the API can also accept a `Resource` object.
   void add(const Resource_& r);
+  void add(Resource_&& r);
   void subtract(const Resource_& r);
 
   Resources operator+(const Resource_& that) const;
   Resources& operator+=(const Resource_& that);
+  Resources& operator+=(Resource_&& that);
 
   Resources operator-(const Resource_& that) const;
   Resources& operator-=(const Resource_& that);
@@ -135,6 +135,26 @@ public:
       SchedulerDriver* driver,
       const TaskStatus& status) = 0;
 
+  // Invoked with all of the task status updates the driver has
+  // received since the last invocation. The driver coalesces updates
+  // that arrive while the scheduler is busy processing an earlier
+  // callback, so schedulers processing a high rate of updates can
+  // override this to handle them in bulk and pay the callback
+  // dispatch cost once per batch. The default implementation simply
+  // invokes Scheduler::statusUpdate for each status, preserving the
+  // behavior for schedulers that don't override this. Note that if
+  // implicit acknowledgements are being used, returning from this
+  // callback acknowledges receipt of _all_ of the included updates
+  // (see Scheduler::statusUpdate).
+  virtual void statusUpdates(
+      SchedulerDriver* driver,
+      const std::vector<TaskStatus>& statuses)
+  {
+    for (const TaskStatus& status : statuses) {
+      statusUpdate(driver, status);
+    }
+  }
+
   // Invoked when an executor sends a message. These messages are best
   // effort; do not expect a framework message to be retransmitted in
   // any reliable fashion.
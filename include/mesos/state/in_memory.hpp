@@ -19,6 +19,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/storage.hpp>
 
@@ -46,6 +47,11 @@ public:
   virtual process::Future<bool> set(
       const internal::state::Entry& entry,
       const UUID& uuid);
+  virtual process::Future<std::vector<Option<internal::state::Entry>>> get(
+      const std::vector<std::string>& names);
+  virtual process::Future<bool> set(
+      const std::vector<internal::state::Entry>& entries,
+      const std::vector<UUID>& uuids);
   virtual process::Future<bool> expunge(const internal::state::Entry& entry);
   virtual process::Future<std::set<std::string>> names();
 
@@ -19,11 +19,13 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/storage.hpp>
 
 #include <process/future.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
 #include <stout/uuid.hpp>
@@ -38,7 +40,15 @@ class LevelDBStorageProcess;
 class LevelDBStorage : public mesos::state::Storage
 {
 public:
-  explicit LevelDBStorage(const std::string& path);
+  // By default the database is opened with a bloom filter (which
+  // avoids disk reads for keys that are not present) and a block
+  // cache (which serves reads of recently used blocks from memory).
+  // Either can be disabled by passing 0.
+  explicit LevelDBStorage(
+      const std::string& path,
+      size_t bloomFilterBitsPerKey = 10,
+      const Bytes& blockCacheSize = Megabytes(64));
+
   virtual ~LevelDBStorage();
 
   // Storage implementation.
@@ -47,6 +57,11 @@ public:
   virtual process::Future<bool> set(
       const internal::state::Entry& entry,
       const UUID& uuid);
+  virtual process::Future<std::vector<Option<internal::state::Entry>>> get(
+      const std::vector<std::string>& names);
+  virtual process::Future<bool> set(
+      const std::vector<internal::state::Entry>& entries,
+      const std::vector<UUID>& uuids);
   virtual process::Future<bool> expunge(const internal::state::Entry& entry);
   virtual process::Future<std::set<std::string>> names();
 
@@ -19,6 +19,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/log/log.hpp>
 
@@ -26,6 +27,7 @@
 
 #include <process/future.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/option.hpp>
 #include <stout/uuid.hpp>
 
@@ -39,7 +41,15 @@ class LogStorageProcess;
 class LogStorage : public mesos::state::Storage
 {
 public:
-  LogStorage(mesos::log::Log* log, size_t diffsBetweenSnapshots = 0);
+  // If 'standbyCatchupInterval' is provided the storage periodically
+  // replays the entries that the local log replica has already
+  // learned into its cache while the writer has not been started
+  // (i.e., while some other storage instance is leading). Once the
+  // writer is started only the tail of the log then needs to be read.
+  LogStorage(
+      mesos::log::Log* log,
+      size_t diffsBetweenSnapshots = 0,
+      const Option<Duration>& standbyCatchupInterval = None());
 
   virtual ~LogStorage();
 
@@ -49,6 +59,11 @@ public:
   virtual process::Future<bool> set(
       const internal::state::Entry& entry,
       const UUID& uuid);
+  virtual process::Future<std::vector<Option<internal::state::Entry>>> get(
+      const std::vector<std::string>& names);
+  virtual process::Future<bool> set(
+      const std::vector<internal::state::Entry>& entries,
+      const std::vector<UUID>& uuids);
   virtual process::Future<bool> expunge(const internal::state::Entry& entry);
   virtual process::Future<std::set<std::string>> names();
 
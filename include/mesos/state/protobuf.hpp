@@ -18,12 +18,15 @@
 #define __MESOS_STATE_PROTOBUF_HPP__
 
 #include <string>
+#include <vector>
 
 #include <mesos/state/state.hpp>
 #include <mesos/state/storage.hpp>
 
 #include <process/future.hpp>
 
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/option.hpp>
 #include <stout/protobuf.hpp>
@@ -78,12 +81,27 @@ public:
   template <typename T>
   process::Future<Variable<T>> fetch(const std::string& name);
 
+  // Returns the variables for the specified names (in the same
+  // order), all fetched in a single storage operation. All the
+  // variables must hold the same message type.
+  template <typename T>
+  process::Future<std::vector<Variable<T>>> fetch(
+      const std::vector<std::string>& names);
+
   // Returns the variable specified if it was successfully stored in
   // the state, otherwise returns none if the version of the variable
   // was no longer valid, or an error if one occurs.
   template <typename T>
   process::Future<Option<Variable<T>>> store(const Variable<T>& variable);
 
+  // Stores all the specified variables in a single atomic storage
+  // operation: either every variable is stored (returning the stored
+  // variables in the same order) or none of them are (returning
+  // none if the version of any variable was no longer valid).
+  template <typename T>
+  process::Future<Option<std::vector<Variable<T>>>> store(
+      const std::vector<Variable<T>>& variables);
+
   // Expunges the variable from the state.
   template <typename T>
   process::Future<bool> expunge(const Variable<T>& variable);
@@ -124,6 +142,30 @@ process::Future<Variable<T>> State::_fetch(
 }
 
 
+template <typename T>
+process::Future<std::vector<Variable<T>>> State::fetch(
+    const std::vector<std::string>& names)
+{
+  return mesos::state::State::fetch(names)
+    .then([](const std::vector<mesos::state::Variable>& variables)
+        -> process::Future<std::vector<Variable<T>>> {
+      std::vector<Variable<T>> results;
+      results.reserve(variables.size());
+
+      foreach (const mesos::state::Variable& variable, variables) {
+        Try<T> t = ::protobuf::deserialize<T>(variable.value());
+        if (t.isError()) {
+          return process::Failure(t.error());
+        }
+
+        results.push_back(Variable<T>(variable, t.get()));
+      }
+
+      return results;
+    });
+}
+
+
 template <typename T>
 process::Future<Option<Variable<T>>> State::store(
     const Variable<T>& variable)
@@ -152,6 +194,45 @@ process::Future<Option<Variable<T>>> State::_store(
 }
 
 
+template <typename T>
+process::Future<Option<std::vector<Variable<T>>>> State::store(
+    const std::vector<Variable<T>>& variables)
+{
+  std::vector<mesos::state::Variable> variables_;
+  variables_.reserve(variables.size());
+
+  foreach (const Variable<T>& variable, variables) {
+    Try<std::string> value = ::protobuf::serialize(variable.t);
+
+    if (value.isError()) {
+      return process::Failure(value.error());
+    }
+
+    variables_.push_back(variable.variable.mutate(value.get()));
+  }
+
+  return mesos::state::State::store(variables_)
+    .then([variables](
+        const Option<std::vector<mesos::state::Variable>>& stored)
+        -> process::Future<Option<std::vector<Variable<T>>>> {
+      if (stored.isNone()) {
+        return None();
+      }
+
+      CHECK_EQ(stored.get().size(), variables.size());
+
+      std::vector<Variable<T>> results;
+      results.reserve(variables.size());
+
+      for (size_t i = 0; i < variables.size(); i++) {
+        results.push_back(Variable<T>(stored.get()[i], variables[i].t));
+      }
+
+      return Some(results);
+    });
+}
+
+
 template <typename T>
 process::Future<bool> State::expunge(const Variable<T>& variable)
 {
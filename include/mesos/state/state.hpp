@@ -19,12 +19,15 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/storage.hpp>
 
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
 #include <process/future.hpp>
 
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
@@ -97,11 +100,25 @@ public:
   // previously did not exist (or an error if one occurs).
   process::Future<Variable> fetch(const std::string& name);
 
+  // Returns the variables for the specified names (in the same
+  // order), creating new ones where they previously did not
+  // exist. All the variables are fetched in a single storage
+  // operation rather than one storage operation per variable.
+  process::Future<std::vector<Variable>> fetch(
+      const std::vector<std::string>& names);
+
   // Returns the variable specified if it was successfully stored in
   // the state, otherwise returns none if the version of the variable
   // was no longer valid, or an error if one occurs.
   process::Future<Option<Variable>> store(const Variable& variable);
 
+  // Stores all the specified variables in a single atomic storage
+  // operation: either every variable is stored (returning the stored
+  // variables in the same order), or, if the version of any variable
+  // is no longer valid, none of them are (returning none).
+  process::Future<Option<std::vector<Variable>>> store(
+      const std::vector<Variable>& variables);
+
   // Returns true if successfully expunged the variable from the state.
   process::Future<bool> expunge(const Variable& variable);
 
@@ -149,6 +166,37 @@ inline process::Future<Variable> State::_fetch(
 }
 
 
+inline process::Future<std::vector<Variable>> State::fetch(
+    const std::vector<std::string>& names)
+{
+  return storage->get(names)
+    .then([names](
+        const std::vector<Option<internal::state::Entry>>& options)
+        -> process::Future<std::vector<Variable>> {
+      CHECK_EQ(names.size(), options.size());
+
+      std::vector<Variable> variables;
+      variables.reserve(names.size());
+
+      for (size_t i = 0; i < names.size(); i++) {
+        if (options[i].isSome()) {
+          variables.push_back(Variable(options[i].get()));
+        } else {
+          // Construct a Variable with a new Entry (with a random
+          // UUID and no value to start).
+          internal::state::Entry entry;
+          entry.set_name(names[i]);
+          entry.set_uuid(UUID::random().toBytes());
+
+          variables.push_back(Variable(entry));
+        }
+      }
+
+      return variables;
+    });
+}
+
+
 inline process::Future<Option<Variable>> State::store(const Variable& variable)
 {
   // Note that we try and swap an entry even if the value didn't change!
@@ -178,6 +226,49 @@ inline process::Future<Option<Variable>> State::_store(
 }
 
 
+inline process::Future<Option<std::vector<Variable>>> State::store(
+    const std::vector<Variable>& variables)
+{
+  // Note that we try and swap the entries even if the values didn't
+  // change!
+  std::vector<internal::state::Entry> entries;
+  std::vector<UUID> uuids;
+
+  entries.reserve(variables.size());
+  uuids.reserve(variables.size());
+
+  foreach (const Variable& variable, variables) {
+    uuids.push_back(UUID::fromBytes(variable.entry.uuid()).get());
+
+    // Create a new entry to replace the existing entry provided the
+    // UUID matches.
+    internal::state::Entry entry;
+    entry.set_name(variable.entry.name());
+    entry.set_uuid(UUID::random().toBytes());
+    entry.set_value(variable.entry.value());
+
+    entries.push_back(entry);
+  }
+
+  return storage->set(entries, uuids)
+    .then([entries](const bool& b)
+        -> process::Future<Option<std::vector<Variable>>> {
+      if (!b) {
+        return None();
+      }
+
+      std::vector<Variable> variables;
+      variables.reserve(entries.size());
+
+      foreach (const internal::state::Entry& entry, entries) {
+        variables.push_back(Variable(entry));
+      }
+
+      return Some(variables);
+    });
+}
+
+
 inline process::Future<bool> State::expunge(const Variable& variable)
 {
   return storage->expunge(variable.entry);
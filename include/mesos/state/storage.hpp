@@ -19,6 +19,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/state.pb.h>
 
@@ -46,6 +47,20 @@ public:
       const internal::state::Entry& entry,
       const UUID& uuid) = 0;
 
+  // Bulk variants of get and set for reading or writing multiple
+  // state entries in a single storage operation (e.g., one leveldb
+  // write batch, one ZooKeeper multi-op, one log append) rather than
+  // one operation per entry. The entries returned by the bulk get
+  // are in the same order as the specified names. Like set, the bulk
+  // set acts like a "test-and-set" of every entry against the
+  // corresponding UUID, and is atomic across the entries: either all
+  // of the entries are set or none of them are.
+  virtual process::Future<std::vector<Option<internal::state::Entry>>> get(
+      const std::vector<std::string>& names) = 0;
+  virtual process::Future<bool> set(
+      const std::vector<internal::state::Entry>& entries,
+      const std::vector<UUID>& uuids) = 0;
+
   // Returns true if successfully expunged the variable from the state.
   virtual process::Future<bool> expunge(
       const internal::state::Entry& entry) = 0;
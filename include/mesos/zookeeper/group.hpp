@@ -230,6 +230,12 @@ private:
   // and Error otherwise.
   Try<bool> cache();
 
+  // Re-caches the memberships after one or more watch events have
+  // been received. Dispatched (rather than invoked directly) from
+  // `updated()` so that a burst of concurrent watch events is
+  // coalesced into a single ZooKeeper read (see `dirty`).
+  void recache();
+
   // Synchronizes pending operations with ZooKeeper and also attempts
   // to cache the current set of memberships if necessary.
   // Returns true if successful, false if the failure is retryable
@@ -331,6 +337,12 @@ private:
   // Indicates there is a pending delayed retry.
   bool retrying;
 
+  // Indicates a watch event has been received and the memberships
+  // need to be re-cached. Set by `updated()` and cleared by
+  // `recache()`; at most one `recache` dispatch is outstanding at a
+  // time so that concurrent watch events are coalesced.
+  bool dirty;
+
   // Expected ZooKeeper sequence numbers (either owned/created by this
   // group instance or not) and the promise we associate with their
   // "cancellation" (i.e., no longer part of the group).
@@ -341,6 +353,12 @@ private:
   // cache and 'Some' represents a valid cache.
   Option<std::set<Group::Membership>> memberships;
 
+  // Cache of membership data, keyed by sequence number. A member's
+  // znode data is written once when it joins and never modified, so
+  // an entry remains valid until the sequence disappears from the
+  // group (see `cache()`) or the session expires.
+  std::map<int32_t, std::string> dataCache;
+
   // A timer that controls when we should give up on waiting for the
   // current connection attempt to succeed and try to reconnect.
   Option<process::Timer> connectTimer;
@@ -108,6 +108,42 @@ public:
 class ZooKeeper
 {
 public:
+  /**
+   * \brief represents a single operation of a multi-operation
+   * transaction (see ZooKeeper::multi).
+   *
+   * Use the factory functions to construct operations, e.g.,
+   * ZooKeeper::Op::set(path, data, version).
+   */
+  struct Op
+  {
+    static Op create(
+        const std::string& path,
+        const std::string& data,
+        const ACL_vector& acl,
+        int flags);
+
+    static Op remove(const std::string& path, int version);
+
+    static Op set(
+        const std::string& path,
+        const std::string& data,
+        int version);
+
+    enum Type
+    {
+      CREATE,
+      REMOVE,
+      SET,
+    } type;
+
+    std::string path;
+    std::string data;      // Only used by CREATE and SET.
+    const ACL_vector* acl; // Only used by CREATE.
+    int flags;             // Only used by CREATE.
+    int version;           // Only used by REMOVE and SET.
+  };
+
   /**
    * \brief instantiate new ZooKeeper client.
    *
@@ -263,6 +299,28 @@ public:
       std::string* result,
       Stat* stat);
 
+  /**
+   * \brief gets the data associated with multiple nodes, issuing all
+   * of the reads before waiting for any of them. The reads are
+   * pipelined over the single ZooKeeper connection, so the total
+   * latency is bounded by the slowest read rather than by one round
+   * trip per node.
+   *
+   * \param paths the names of the nodes.
+   * \param watch if nonzero, a watch will be set at the server to
+   *    notify the client if one of the nodes changes.
+   * \param results the data returned by the server, one per path.
+   * \param stats if not `nullptr`, will hold the values of stat for
+   *    the paths on return, one per path.
+   * \return the return values of the individual reads, one per path
+   *    (see `get` above for the possible codes).
+   */
+  std::vector<int> get(
+      const std::vector<std::string>& paths,
+      bool watch,
+      std::vector<std::string>* results,
+      std::vector<Stat>* stats);
+
   /**
    * \brief lists the children of a node synchronously.
    *
@@ -304,6 +362,22 @@ public:
    */
   int set(const std::string& path, const std::string& data, int version);
 
+  /**
+   * \brief executes multiple operations as a single atomic
+   * transaction.
+   *
+   * Either all of the operations are applied or, if any of them
+   * fails, none of them are.
+   *
+   * \param ops the operations (see Op above) to execute.
+   * \return the return code for the function call: ZOK if all the
+   * operations succeeded, otherwise the code of the operation that
+   * caused the transaction to abort (e.g., ZBADVERSION if an
+   * expected version did not match, ZNODEEXISTS if a node to be
+   * created already exists, etc).
+   */
+  int multi(const std::vector<Op>& ops);
+
   /**
    * \brief return a message describing the return code.
    *
@@ -16,6 +16,7 @@
 
 #include "authorizer/local/authorizer.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,14 +24,19 @@
 
 #include <mesos/authorizer/acls.hpp>
 
+#include <process/clock.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
+#include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/option.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
@@ -40,6 +46,7 @@
 #include "common/parse.hpp"
 #include "common/http.hpp"
 
+using process::Clock;
 using process::dispatch;
 using process::Failure;
 using process::Future;
@@ -58,6 +65,14 @@ struct GenericACL
 };
 
 
+// How long cached object approvers remain valid. Since the ACLs are
+// fixed for the lifetime of the authorizer a cached approver can
+// never be stale; the TTL only bounds the size of the cache when
+// requests arrive under many distinct principals. Should ACL
+// reloading ever be introduced, the cache must be invalidated there.
+constexpr Duration APPROVER_CACHE_TTL = Seconds(60);
+
+
 // TODO(mpark): This class exists to optionally carry `ACL::SetQuota` and
 // `ACL::RemoveQuota` ACLs. This is a hack to support the deprecation cycle for
 // `ACL::SetQuota` and `ACL::RemoveQuota`. This can be removed / replaced with
@@ -188,6 +203,126 @@ static bool allows(const ACL::Entity& request, const ACL::Entity& acl)
 }
 
 
+// A compiled form of an ordered `GenericACL` list, specialized for a
+// fixed subject. The subject side of every ACL is evaluated once at
+// construction time and the object side is folded into hash-indexed
+// verdict tables, so a request is answered with a single hash lookup
+// instead of a linear scan with string comparisons per ACL. Task
+// launch bursts invoke the authorizer once per task, which makes the
+// per-request scan visible in master profiles.
+//
+// The tables cover the entity shapes that the object approvers in
+// this file actually construct: ANY, or SOME with exactly one value.
+// Other shapes (e.g. multi-value SOME) take a fallback scan over the
+// subject-matching ACLs, which preserves the exact first-match
+// semantics of `matches()` / `allows()`.
+class CompiledGenericACLs
+{
+public:
+  CompiledGenericACLs(
+      const vector<GenericACL>& acls,
+      const ACL::Entity& subject,
+      bool _permissive)
+    : permissive(_permissive)
+  {
+    foreach (const GenericACL& acl, acls) {
+      // An ACL whose subject side does not match can never be the
+      // first matching ACL for this subject, so it is dropped here
+      // rather than re-examined on every request.
+      if (!matches(subject, acl.subjects)) {
+        continue;
+      }
+
+      const bool subjectAllows = allows(subject, acl.subjects);
+
+      entries.push_back({acl.objects, subjectAllows});
+
+      switch (acl.objects.type()) {
+        case ACL::Entity::SOME:
+          // A value already present in the table, or any value once
+          // `someDefault` is set, is decided by an earlier ACL:
+          // first match wins.
+          if (someDefault.isNone()) {
+            foreach (const string& value, acl.objects.values()) {
+              if (!verdicts.contains(value)) {
+                verdicts[value] = subjectAllows;
+              }
+            }
+          }
+          break;
+        case ACL::Entity::ANY:
+          // An ANY object matches every subsequent lookup, fixing
+          // the verdict for all values not decided above.
+          if (someDefault.isNone()) {
+            someDefault = subjectAllows;
+          }
+          if (anyVerdict.isNone()) {
+            anyVerdict = subjectAllows;
+          }
+          break;
+        case ACL::Entity::NONE:
+          // A NONE object matches both SOME and ANY requests but
+          // allows neither.
+          if (someDefault.isNone()) {
+            someDefault = false;
+          }
+          if (anyVerdict.isNone()) {
+            anyVerdict = false;
+          }
+          break;
+      }
+    }
+  }
+
+  bool approved(const ACL::Entity& object) const
+  {
+    if (object.type() == ACL::Entity::ANY) {
+      return anyVerdict.getOrElse(permissive);
+    }
+
+    if (object.type() == ACL::Entity::SOME && object.values_size() == 1) {
+      Option<bool> verdict = verdicts.get(object.values(0));
+      if (verdict.isSome()) {
+        return verdict.get();
+      }
+
+      return someDefault.getOrElse(permissive);
+    }
+
+    // Fallback for entity shapes not covered by the verdict tables.
+    foreach (const Entry& entry, entries) {
+      if (matches(object, entry.objects)) {
+        return entry.subjectAllows && allows(object, entry.objects);
+      }
+    }
+
+    return permissive; // None of the ACLs match.
+  }
+
+private:
+  struct Entry
+  {
+    ACL::Entity objects;
+    bool subjectAllows;
+  };
+
+  // First-match verdict per exact object value.
+  hashmap<string, bool> verdicts;
+
+  // Verdict for values absent from `verdicts`, set by the first
+  // ANY or NONE ACL.
+  Option<bool> someDefault;
+
+  // Verdict for an ANY object entity.
+  Option<bool> anyVerdict;
+
+  // Ordered subject-matching ACLs, kept for the fallback scan.
+  vector<Entry> entries;
+
+  const bool permissive;
+};
+
+
 class LocalAuthorizerObjectApprover : public ObjectApprover
 {
 public:
@@ -199,12 +334,11 @@ public:
     : acls_(acls),
       subject_(subject),
       action_(action),
-      permissive_(permissive) {}
-
-  virtual Try<bool> approved(
-      const Option<ObjectApprover::Object>& object) const noexcept override
+      permissive_(permissive)
   {
-    // Construct subject.
+    // Construct subject. The subject is fixed for the lifetime of
+    // the approver, so the subject side of the ACLs is evaluated
+    // here, once, rather than on every `approved()` call.
     ACL::Entity aclSubject;
     if (subject_.isSome()) {
       aclSubject.add_values(subject_->value());
@@ -213,6 +347,23 @@ public:
       aclSubject.set_type(mesos::ACL::Entity::ANY);
     }
 
+    compiled_.reset(
+        new CompiledGenericACLs(acls_.acls, aclSubject, permissive_));
+
+    if (acls_.set_quotas.isSome()) {
+      compiledSetQuotas_.reset(new CompiledGenericACLs(
+          acls_.set_quotas.get(), aclSubject, permissive_));
+    }
+
+    if (acls_.remove_quotas.isSome()) {
+      compiledRemoveQuotas_.reset(new CompiledGenericACLs(
+          acls_.remove_quotas.get(), aclSubject, permissive_));
+    }
+  }
+
+  virtual Try<bool> approved(
+      const Option<ObjectApprover::Object>& object) const noexcept override
+  {
     // Construct object.
     ACL::Entity aclObject;
 
@@ -293,7 +444,7 @@ public:
               aclObject.set_type(mesos::ACL::Entity::SOME);
 
               CHECK_SOME(acls_.set_quotas);
-              return approved(acls_.set_quotas.get(), aclSubject, aclObject);
+              return compiledSetQuotas_->approved(aclObject);
             } else if (*object->value == "RemoveQuota") {
               if (object->quota_info->has_principal()) {
                 aclObject.add_values(object->quota_info->principal());
@@ -303,7 +454,7 @@ public:
               }
 
               CHECK_SOME(acls_.remove_quotas);
-              return approved(acls_.remove_quotas.get(), aclSubject, aclObject);
+              return compiledRemoveQuotas_->approved(aclObject);
             }
           }
 
@@ -374,29 +525,19 @@ public:
       }
     }
 
-    return approved(acls_.acls, aclSubject, aclObject);
+    return compiled_->approved(aclObject);
   }
 
 private:
-  bool approved(
-      const vector<GenericACL>& acls,
-      const ACL::Entity& subject,
-      const ACL::Entity& object) const
-  {
-    // Authorize subject/object.
-    foreach (const GenericACL& acl, acls) {
-      if (matches(subject, acl.subjects) && matches(object, acl.objects)) {
-        return allows(subject, acl.subjects) && allows(object, acl.objects);
-      }
-    }
-
-    return permissive_; // None of the ACLs match.
-  }
-
   const GenericACLs acls_;
   const Option<authorization::Subject> subject_;
   const authorization::Action action_;
   const bool permissive_;
+
+  // ACLs compiled against the (fixed) subject at construction time.
+  Owned<CompiledGenericACLs> compiled_;
+  Owned<CompiledGenericACLs> compiledSetQuotas_;
+  Owned<CompiledGenericACLs> compiledRemoveQuotas_;
 };
 
 
@@ -807,7 +948,8 @@ Option<Error> LocalAuthorizer::validate(const ACLs& acls)
 
 
 LocalAuthorizer::LocalAuthorizer(const ACLs& acls)
-    : process(new LocalAuthorizerProcess(acls))
+    : cache(new Cache()),
+      process(new LocalAuthorizerProcess(acls))
 {
   spawn(process);
 }
@@ -823,10 +965,22 @@ LocalAuthorizer::~LocalAuthorizer()
 }
 
 
-process::Future<bool> LocalAuthorizer::authorized(
-  const authorization::Request& request)
+// Approver cache key. NOTE: The key covers the entire subject so
+// that subjects which ever grow additional fields cannot alias each
+// other.
+static string approverCacheKey(
+    const Option<authorization::Subject>& subject,
+    const authorization::Action& action)
+{
+  return stringify(static_cast<int>(action)) + ":" +
+    (subject.isSome() ? subject->SerializePartialAsString() : "");
+}
+
+
+// Request sanity checks shared by the single and batched
+// `LocalAuthorizer::authorized` overloads.
+static void checkRequest(const authorization::Request& request)
 {
-  // Request sanity checks.
   // A set `subject` should always come with a set `value`.
   CHECK(
     !request.has_subject() ||
@@ -846,14 +1000,83 @@ process::Future<bool> LocalAuthorizer::authorized(
       request.object().has_task_info() ||
       request.object().has_executor_info() ||
       request.object().has_quota_info())));
+}
 
-  typedef Future<bool> (LocalAuthorizerProcess::*F)(
-      const authorization::Request&);
 
-  return dispatch(
-      process,
-      static_cast<F>(&LocalAuthorizerProcess::authorized),
-      request);
+// Applies a resolved approver to the object of `request`.
+static Future<bool> applyApprover(
+    const Owned<ObjectApprover>& approver,
+    const authorization::Request& request)
+{
+  Option<ObjectApprover::Object> object = None();
+  if (request.has_object()) {
+    object = ObjectApprover::Object(request.object());
+  }
+
+  Try<bool> approved = approver->approved(object);
+  if (approved.isError()) {
+    return Failure(approved.error());
+  }
+
+  return approved.get();
+}
+
+
+process::Future<bool> LocalAuthorizer::authorized(
+  const authorization::Request& request)
+{
+  checkRequest(request);
+
+  Option<authorization::Subject> subject = None();
+  if (request.has_subject()) {
+    subject = request.subject();
+  }
+
+  // Route the request through `getObjectApprover` so that repeated
+  // checks for the same subject and action hit the approver cache
+  // instead of dispatching to the authorizer actor.
+  return getObjectApprover(subject, request.action())
+    .then([request](const Owned<ObjectApprover>& approver) {
+      return applyApprover(approver, request);
+    });
+}
+
+
+vector<Future<bool>> LocalAuthorizer::authorized(
+  const vector<authorization::Request>& requests)
+{
+  vector<Future<bool>> futures;
+  futures.reserve(requests.size());
+
+  // The requests of a batch typically share a single subject and
+  // action (e.g. the tasks of one ACCEPT call), so we resolve one
+  // approver per distinct (action, subject) and share it across the
+  // requests it covers. With a cold approver cache the whole batch
+  // then costs a single dispatch into the authorizer actor rather
+  // than one per request.
+  hashmap<string, Future<Owned<ObjectApprover>>> approvers;
+
+  foreach (const authorization::Request& request, requests) {
+    checkRequest(request);
+
+    Option<authorization::Subject> subject = None();
+    if (request.has_subject()) {
+      subject = request.subject();
+    }
+
+    const string key = approverCacheKey(subject, request.action());
+
+    if (!approvers.contains(key)) {
+      approvers.put(key, getObjectApprover(subject, request.action()));
+    }
+
+    futures.push_back(approvers.at(key)
+      .then([request](const Owned<ObjectApprover>& approver) {
+        return applyApprover(approver, request);
+      }));
+  }
+
+  return futures;
 }
 
 
@@ -861,11 +1084,33 @@ Future<Owned<ObjectApprover>> LocalAuthorizer::getObjectApprover(
       const Option<authorization::Subject>& subject,
       const authorization::Action& action)
 {
+  const string key = approverCacheKey(subject, action);
+
+  synchronized (cache->mutex) {
+    Option<Cache::Entry> entry = cache->entries.get(key);
+    if (entry.isSome() && Clock::now() < entry->expiry) {
+      return entry->approver;
+    }
+  }
+
+  // Capture the cache through the shared pointer rather than `this`:
+  // the continuation may run after the authorizer is destroyed.
+  std::shared_ptr<Cache> cache_ = cache;
+
   return dispatch(
       process,
       &LocalAuthorizerProcess::getObjectApprover,
       subject,
-      action);
+      action)
+    .then([cache_, key](const Owned<ObjectApprover>& approver)
+        -> Future<Owned<ObjectApprover>> {
+      synchronized (cache_->mutex) {
+        cache_->entries[key] =
+          Cache::Entry{approver, Clock::now() + APPROVER_CACHE_TTL};
+      }
+
+      return approver;
+    });
 }
 
 } // namespace internal {
@@ -17,12 +17,19 @@
 #ifndef __AUTHORIZER_AUTHORIZER_HPP__
 #define __AUTHORIZER_AUTHORIZER_HPP__
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <mesos/authorizer/authorizer.hpp>
 
 #include <process/future.hpp>
 #include <process/once.hpp>
+#include <process/time.hpp>
 
 #include <stout/error.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
@@ -65,6 +72,9 @@ public:
   virtual process::Future<bool> authorized(
       const authorization::Request& request);
 
+  virtual std::vector<process::Future<bool>> authorized(
+      const std::vector<authorization::Request>& requests);
+
   virtual process::Future<process::Owned<ObjectApprover>> getObjectApprover(
       const Option<authorization::Subject>& subject,
       const authorization::Action& action);
@@ -74,6 +84,28 @@ private:
 
   static Option<Error> validate(const ACLs& acls);
 
+  // A TTL cache of object approvers keyed by (action, subject).
+  // Approvers computed by the authorizer actor only depend on the
+  // ACLs, which are fixed for the lifetime of this authorizer, so
+  // caching them lets repeated authorization checks (e.g., dashboard
+  // endpoint polls) skip the dispatch to the actor entirely. The
+  // cache is internally synchronized since the authorizer may be
+  // called from multiple actors, and is held through a shared pointer
+  // so that in-flight continuations can outlive the authorizer.
+  struct Cache
+  {
+    struct Entry
+    {
+      process::Owned<ObjectApprover> approver;
+      process::Time expiry;
+    };
+
+    std::mutex mutex;
+    hashmap<std::string, Entry> entries;
+  };
+
+  std::shared_ptr<Cache> cache;
+
   LocalAuthorizerProcess* process;
 };
 
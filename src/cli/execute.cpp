@@ -35,6 +35,7 @@
 #include <stout/flags.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
@@ -138,6 +139,19 @@ public:
         "     ]\n"
         "}");
 
+    add(&Flags::task_list,
+        "task_list",
+        "The value could be a JSON-formatted string of `TaskGroupInfo` or a\n"
+        "file path containing the JSON-formatted `TaskGroupInfo`. Path must\n"
+        "be of the form `file:///path/to/file` or `/path/to/file`.\n"
+        "\n"
+        "Unlike `--task_group`, the tasks in the list are launched\n"
+        "independently rather than as a single task group: as many tasks\n"
+        "as fit are packed into each offer over a single framework\n"
+        "subscription, which avoids one full registration per task when\n"
+        "launching a large batch. See `--task_group` for the expected\n"
+        "format; task IDs must be unique.");
+
     add(&Flags::name,
         "name",
         "Name for the command.");
@@ -283,6 +297,7 @@ public:
   Option<string> master;
   Option<string> name;
   Option<TaskGroupInfo> task_group;
+  Option<TaskGroupInfo> task_list;
   bool shell;
   Option<string> command;
   Option<hashmap<string, string>> environment;
@@ -314,7 +329,7 @@ public:
       const string& _master,
       const Option<Duration>& _killAfter,
       const Option<Credential>& _credential,
-      const Option<TaskInfo>& _task,
+      const vector<TaskInfo>& _tasks,
       const Option<TaskGroupInfo>& _taskGroup,
       const Option<string>& _networks)
     : state(DISCONNECTED),
@@ -322,11 +337,19 @@ public:
       master(_master),
       killAfter(_killAfter),
       credential(_credential),
-      task(_task),
+      tasks(_tasks),
       taskGroup(_taskGroup),
       networks(_networks),
       launched(false),
-      terminatedTaskCount(0) {}
+      terminatedTaskCount(0)
+  {
+    CHECK_NE(tasks.empty(), taskGroup.isNone())
+      << "Either tasks or task group should be set but not both";
+
+    foreach (const TaskInfo& task, tasks) {
+      pending.push(task);
+    }
+  }
 
   virtual ~CommandScheduler() {}
 
@@ -400,132 +423,179 @@ protected:
     CHECK_EQ(SUBSCRIBED, state);
 
     foreach (const Offer& offer, offers) {
-      Resources offered = offer.resources();
+      if (taskGroup.isSome()) {
+        launchTaskGroup(offer);
+      } else {
+        launchTasks(offer);
+      }
+    }
+  }
 
-      Resources requiredResources;
+  // Launches as many of the remaining tasks as fit into the offer.
+  // Note that the accepts for subsequent offers are sent without
+  // waiting for any status updates, so a batch of tasks gets spread
+  // over the offers as they arrive rather than one launch per offer
+  // cycle.
+  void launchTasks(const Offer& offer)
+  {
+    Resources offered = offer.resources();
 
-      CHECK_NE(task.isSome(), taskGroup.isSome())
-        << "Either task or task group should be set but not both";
+    vector<TaskInfo> toLaunch;
 
-      if (task.isSome()) {
-        requiredResources = Resources(task.get().resources());
-      } else {
-        foreach (const TaskInfo& _task, taskGroup->tasks()) {
-          requiredResources += Resources(_task.resources());
-        }
+    while (!pending.empty()) {
+      TaskInfo task = pending.front();
+
+      // Takes resources first from the specified role, then from '*'.
+      Try<Resources> flattened =
+        Resources(task.resources()).flatten(frameworkInfo.role());
+
+      // `frameworkInfo.role()` must be valid as it's allowed to register.
+      CHECK_SOME(flattened);
+      Option<Resources> resources = offered.find(flattened.get());
+
+      if (resources.isNone()) {
+        break;
       }
 
-      if (!launched && offered.flatten().contains(requiredResources)) {
-        TaskInfo _task;
-        TaskGroupInfo _taskGroup;
+      task.mutable_agent_id()->MergeFrom(offer.agent_id());
+      task.mutable_resources()->CopyFrom(resources.get());
+
+      offered -= resources.get();
+
+      toLaunch.push_back(task);
+      pending.pop();
+    }
+
+    if (toLaunch.empty()) {
+      Call call;
+      call.set_type(Call::DECLINE);
+
+      CHECK(frameworkInfo.has_id());
+      call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+
+      Call::Decline* decline = call.mutable_decline();
+      decline->add_offer_ids()->CopyFrom(offer.id());
+
+      mesos->send(call);
+      return;
+    }
+
+    Call call;
+    call.set_type(Call::ACCEPT);
+
+    CHECK(frameworkInfo.has_id());
+    call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+
+    Call::Accept* accept = call.mutable_accept();
+    accept->add_offer_ids()->CopyFrom(offer.id());
+
+    Offer::Operation* operation = accept->add_operations();
+    operation->set_type(Offer::Operation::LAUNCH);
+
+    foreach (const TaskInfo& task, toLaunch) {
+      operation->mutable_launch()->add_task_infos()->CopyFrom(task);
+    }
+
+    mesos->send(call);
+
+    foreach (const TaskInfo& task, toLaunch) {
+      cout << "Submitted task '" << task.name() << "' to agent '"
+           << offer.agent_id() << "'" << endl;
+    }
+  }
+
+  void launchTaskGroup(const Offer& offer)
+  {
+    Resources offered = offer.resources();
+
+    Resources requiredResources;
+
+    foreach (const TaskInfo& _task, taskGroup->tasks()) {
+      requiredResources += Resources(_task.resources());
+    }
+
+    if (!launched && offered.flatten().contains(requiredResources)) {
+      TaskGroupInfo _taskGroup;
 
-        if (task.isSome()) {
-          _task = task.get();
+      foreach (TaskInfo _task, taskGroup->tasks()) {
           _task.mutable_agent_id()->MergeFrom(offer.agent_id());
 
           // Takes resources first from the specified role, then from '*'.
           Try<Resources> flattened =
             Resources(_task.resources()).flatten(frameworkInfo.role());
 
-          // `frameworkInfo.role()` must be valid as it's allowed to register.
+          // `frameworkInfo.role()` must be valid as it's allowed to
+          // register.
           CHECK_SOME(flattened);
           Option<Resources> resources = offered.find(flattened.get());
 
           CHECK_SOME(resources);
 
           _task.mutable_resources()->CopyFrom(resources.get());
-        } else {
-          foreach (TaskInfo _task, taskGroup->tasks()) {
-              _task.mutable_agent_id()->MergeFrom(offer.agent_id());
-
-              // Takes resources first from the specified role, then from '*'.
-              Try<Resources> flattened =
-                Resources(_task.resources()).flatten(frameworkInfo.role());
-
-              // `frameworkInfo.role()` must be valid as it's allowed to
-              // register.
-              CHECK_SOME(flattened);
-              Option<Resources> resources = offered.find(flattened.get());
-
-              CHECK_SOME(resources);
-
-              _task.mutable_resources()->CopyFrom(resources.get());
-              _taskGroup.add_tasks()->CopyFrom(_task);
-          }
-       }
-       Call call;
-       call.set_type(Call::ACCEPT);
-
-       CHECK(frameworkInfo.has_id());
-       call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
-
-       Call::Accept* accept = call.mutable_accept();
-       accept->add_offer_ids()->CopyFrom(offer.id());
-
-       Offer::Operation* operation = accept->add_operations();
-
-       if (task.isSome()) {
-         operation->set_type(Offer::Operation::LAUNCH);
-         operation->mutable_launch()->add_task_infos()->CopyFrom(_task);
-       } else {
-         operation->set_type(Offer::Operation::LAUNCH_GROUP);
-
-         ExecutorInfo* executorInfo =
-           operation->mutable_launch_group()->mutable_executor();
-
-         executorInfo->set_type(ExecutorInfo::DEFAULT);
-         executorInfo->mutable_executor_id()->set_value(
-             "default-executor");
-
-         executorInfo->mutable_framework_id()->CopyFrom(frameworkInfo.id());
-         executorInfo->mutable_resources()->CopyFrom(
-             Resources::parse("cpus:0.1;mem:32;disk:32").get());
-
-         // Setup any CNI networks that the `task_group` needs to
-         // join, in case the `--networks` flag was specified.
-         if (networks.isSome() && !networks->empty()) {
-           ContainerInfo* containerInfo = executorInfo->mutable_container();
-           containerInfo->set_type(ContainerInfo::MESOS);
-
-           foreach (const string& network,
-                    strings::tokenize(networks.get(), ",")) {
-             containerInfo->add_network_infos()->set_name(network);
-           }
-         }
-
-         operation->mutable_launch_group()->mutable_task_group()->CopyFrom(
-             _taskGroup);
-       }
-
-       mesos->send(call);
-
-       if (task.isSome()) {
-         cout << "Submitted task '" << task.get().name() << "' to agent '"
-              << offer.agent_id() << "'" << endl;
-       } else {
-         vector<TaskID> taskIds;
-
-         foreach (const TaskInfo& _task, taskGroup->tasks()) {
-           taskIds.push_back(_task.task_id());
-         }
-
-         cout << "Submitted task group with tasks "<< taskIds
-              << " to agent '" << offer.agent_id() << "'" << endl;
-       }
-
-       launched = true;
-      } else {
-        Call call;
-        call.set_type(Call::DECLINE);
+          _taskGroup.add_tasks()->CopyFrom(_task);
+      }
+
+      Call call;
+      call.set_type(Call::ACCEPT);
+
+      CHECK(frameworkInfo.has_id());
+      call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+
+      Call::Accept* accept = call.mutable_accept();
+      accept->add_offer_ids()->CopyFrom(offer.id());
+
+      Offer::Operation* operation = accept->add_operations();
+      operation->set_type(Offer::Operation::LAUNCH_GROUP);
+
+      ExecutorInfo* executorInfo =
+        operation->mutable_launch_group()->mutable_executor();
+
+      executorInfo->set_type(ExecutorInfo::DEFAULT);
+      executorInfo->mutable_executor_id()->set_value(
+          "default-executor");
+
+      executorInfo->mutable_framework_id()->CopyFrom(frameworkInfo.id());
+      executorInfo->mutable_resources()->CopyFrom(
+          Resources::parse("cpus:0.1;mem:32;disk:32").get());
 
-        CHECK(frameworkInfo.has_id());
-        call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+      // Setup any CNI networks that the `task_group` needs to
+      // join, in case the `--networks` flag was specified.
+      if (networks.isSome() && !networks->empty()) {
+        ContainerInfo* containerInfo = executorInfo->mutable_container();
+        containerInfo->set_type(ContainerInfo::MESOS);
 
-        Call::Decline* decline = call.mutable_decline();
-        decline->add_offer_ids()->CopyFrom(offer.id());
+        foreach (const string& network,
+                 strings::tokenize(networks.get(), ",")) {
+          containerInfo->add_network_infos()->set_name(network);
+        }
+      }
 
-        mesos->send(call);
+      operation->mutable_launch_group()->mutable_task_group()->CopyFrom(
+          _taskGroup);
+
+      mesos->send(call);
+
+      vector<TaskID> taskIds;
+
+      foreach (const TaskInfo& _task, taskGroup->tasks()) {
+        taskIds.push_back(_task.task_id());
       }
+
+      cout << "Submitted task group with tasks "<< taskIds
+           << " to agent '" << offer.agent_id() << "'" << endl;
+
+      launched = true;
+    } else {
+      Call call;
+      call.set_type(Call::DECLINE);
+
+      CHECK(frameworkInfo.has_id());
+      call.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+
+      Call::Decline* decline = call.mutable_decline();
+      decline->add_offer_ids()->CopyFrom(offer.id());
+
+      mesos->send(call);
     }
   }
 
@@ -625,17 +695,13 @@ protected:
     }
 
     if (mesos::internal::protobuf::isTerminalState(devolve(status).state())) {
-      CHECK_NE(task.isSome(), taskGroup.isSome())
-        << "Either task or task group should be set but not both";
+      terminatedTaskCount++;
 
-      if (task.isSome()) {
-        terminate(self());
-      } else {
-        terminatedTaskCount++;
+      size_t total =
+        taskGroup.isSome() ? taskGroup->tasks().size() : tasks.size();
 
-        if (terminatedTaskCount == taskGroup->tasks().size()) {
-          terminate(self());
-        }
+      if (terminatedTaskCount == static_cast<int>(total)) {
+        terminate(self());
       }
     }
   }
@@ -652,9 +718,14 @@ private:
   const string master;
   const Option<Duration> killAfter;
   const Option<Credential> credential;
-  const Option<TaskInfo> task;
+  const vector<TaskInfo> tasks;
   const Option<TaskGroupInfo> taskGroup;
   const Option<string> networks;
+
+  // Tasks that have not yet been launched.
+  queue<TaskInfo> pending;
+
+  // Whether the task group has been launched.
   bool launched;
   int terminatedTaskCount;
   Owned<Mesos> mesos;
@@ -819,7 +890,22 @@ int main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  if (flags.task_group.isNone()) {
+  if (flags.task_list.isSome() &&
+      (flags.task_group.isSome() ||
+       flags.name.isSome() ||
+       flags.command.isSome() ||
+       flags.environment.isSome() ||
+       flags.appc_image.isSome() ||
+       flags.docker_image.isSome() ||
+       flags.volumes.isSome())) {
+    cerr << flags.usage(
+              "'--task_list' cannot be used along with '--task_group' or the"
+              " single task flags '--name, --command, --env, --appc_image,"
+              " --docker_image, --volumes'") << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (flags.task_group.isNone() && flags.task_list.isNone()) {
     if (flags.name.isNone()) {
       cerr << flags.usage("Missing required option --name") << endl;
       return EXIT_FAILURE;
@@ -988,9 +1074,27 @@ int main(int argc, char** argv)
     }
   }
 
-  Option<TaskInfo> taskInfo = None();
+  vector<TaskInfo> tasks;
+
+  if (flags.task_list.isSome()) {
+    hashset<string> taskIds;
+
+    foreach (const TaskInfo& task, flags.task_list->tasks()) {
+      if (taskIds.contains(task.task_id().value())) {
+        cerr << "Duplicate task ID '" << task.task_id().value()
+             << "' in '--task_list'" << endl;
+        return EXIT_FAILURE;
+      }
+
+      taskIds.insert(task.task_id().value());
+      tasks.push_back(task);
+    }
 
-  if (flags.task_group.isNone()) {
+    if (tasks.empty()) {
+      cerr << "No tasks specified in '--task_list'" << endl;
+      return EXIT_FAILURE;
+    }
+  } else if (flags.task_group.isNone()) {
     TaskInfo task;
     task.set_name(flags.name.get());
     task.mutable_task_id()->set_value(flags.name.get());
@@ -1050,7 +1154,7 @@ int main(int argc, char** argv)
       task.mutable_container()->CopyFrom(containerInfo.get());
     }
 
-    taskInfo = task;
+    tasks.push_back(task);
   }
 
   Owned<CommandScheduler> scheduler(
@@ -1059,7 +1163,7 @@ int main(int argc, char** argv)
         flags.master.get(),
         flags.kill_after,
         credential,
-        taskInfo,
+        tasks,
         flags.task_group,
         flags.networks));
 
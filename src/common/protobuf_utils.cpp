@@ -22,6 +22,8 @@
 #include <pwd.h>
 #endif // __WINDOWS__
 
+#include <algorithm>
+
 #include <mesos/slave/isolator.hpp>
 
 #include <mesos/type_utils.hpp>
@@ -48,7 +50,9 @@
 
 #include "messages/messages.hpp"
 
+using std::pair;
 using std::string;
+using std::vector;
 
 using google::protobuf::RepeatedPtrField;
 
@@ -271,6 +275,55 @@ Option<ContainerStatus> getTaskContainerStatus(const Task& task)
 }
 
 
+// Feeds `value` into the running 64-bit FNV-1a `hash`, prefixed by
+// its length so that adjacent values cannot be confused for one
+// another.
+static uint64_t extendFingerprint(uint64_t hash, const string& value)
+{
+  size_t size = value.size();
+  for (size_t i = 0; i < sizeof(size); i++) {
+    hash = (hash ^ ((size >> (i * 8)) & 0xff)) * 1099511628211ULL;
+  }
+
+  for (size_t i = 0; i < value.size(); i++) {
+    hash = (hash ^ static_cast<unsigned char>(value[i])) * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+
+uint64_t getStateFingerprint(
+    vector<pair<string, string>> tasks,
+    vector<pair<string, string>> executors)
+{
+  // Sort so that the fingerprint is independent of the order in
+  // which the caller enumerated its state.
+  std::sort(tasks.begin(), tasks.end());
+  std::sort(executors.begin(), executors.end());
+
+  // We spell out 64-bit FNV-1a rather than relying on `std::hash`
+  // because the master and the agent (possibly built against
+  // different standard libraries) must arrive at identical
+  // fingerprints for the same state.
+  uint64_t hash = 14695981039346656037ULL;
+
+  hash = extendFingerprint(hash, "tasks");
+  for (size_t i = 0; i < tasks.size(); i++) {
+    hash = extendFingerprint(hash, tasks[i].first);
+    hash = extendFingerprint(hash, tasks[i].second);
+  }
+
+  hash = extendFingerprint(hash, "executors");
+  for (size_t i = 0; i < executors.size(); i++) {
+    hash = extendFingerprint(hash, executors[i].first);
+    hash = extendFingerprint(hash, executors[i].second);
+  }
+
+  return hash;
+}
+
+
 /**
  * Creates a MasterInfo protobuf from the process's UPID.
  *
@@ -17,8 +17,12 @@
 #ifndef __PROTOBUF_UTILS_HPP__
 #define __PROTOBUF_UTILS_HPP__
 
+#include <stdint.h>
+
 #include <initializer_list>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <sys/stat.h>
 
@@ -102,6 +106,19 @@ Option<bool> getTaskHealth(const Task& task);
 Option<ContainerStatus> getTaskContainerStatus(const Task& task);
 
 
+// Returns a fingerprint of an agent's task and executor state, used
+// by the delta re-registration handshake (see
+// `ReregisterSlaveMessage.state_fingerprint`). Each task and executor
+// is identified by its (framework id, task/executor id) values; the
+// result is independent of the order in which they are supplied. The
+// master and the agent must arrive at identical fingerprints for the
+// same state, so the hash function is fixed rather than platform
+// defined.
+uint64_t getStateFingerprint(
+    std::vector<std::pair<std::string, std::string>> tasks,
+    std::vector<std::pair<std::string, std::string>> executors);
+
+
 // Helper function that creates a MasterInfo from UPID.
 MasterInfo createMasterInfo(const process::UPID& pid);
 
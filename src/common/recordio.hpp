@@ -43,6 +43,30 @@ class ReaderProcess;
 } // namespace internal {
 
 
+/**
+ * Encodes and writes a record to an http::Pipe::Writer. The length
+ * header and the record are written to the pipe as separate chunks
+ * so that the record is moved into the pipe rather than copied into
+ * a contiguous "Record-IO" frame; this matters for event-heavy
+ * streaming endpoints. Decoding is incremental, so a reader that
+ * observes the header before the record is indistinguishable from
+ * one that performed a short read of a contiguous frame.
+ *
+ * Returns false if either end of the pipe was already closed.
+ *
+ * NOTE: Only individual pipe writes are atomic, so a given writer
+ * must not be written to concurrently.
+ */
+inline bool write(process::http::Pipe::Writer writer, std::string&& record)
+{
+  if (!writer.write(::recordio::header(record.size()))) {
+    return false;
+  }
+
+  return writer.write(std::move(record));
+}
+
+
 /**
  * Provides RecordIO decoding on top of an http::Pipe::Reader.
  * The caller is responsible for closing the http::Pipe::Reader
@@ -19,6 +19,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <glog/logging.h>
@@ -833,6 +834,82 @@ bool Resources::isShared(const Resource& resource)
 // Public member functions.
 /////////////////////////////////////////////////
 
+// 64-bit FNV-1a hash folding, used to compute `Resource_` fingerprints.
+static uint64_t hashCombine(uint64_t hash, const string& data)
+{
+  foreach (char c, data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+
+static uint64_t hashCombine(uint64_t hash, uint64_t data)
+{
+  for (size_t i = 0; i < sizeof(data); i++) {
+    hash ^= (data >> (i * 8)) & 0xff;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+
+uint64_t Resources::Resource_::computeFingerprint(const Resource& resource)
+{
+  // NOTE: Only fields which `internal::addable` and
+  // `internal::subtractable` require to be *equal* may be hashed
+  // here; this guarantees that two matchable resources always have
+  // equal fingerprints, making a fingerprint mismatch a sound reason
+  // to skip the deep protobuf comparison. Sub-messages which are
+  // compared by full equality (e.g., `ReservationInfo`,
+  // `DiskInfo`) need not be hashed exhaustively: hashing a subset of
+  // their fields simply means some mismatches fall through to the
+  // deep comparison.
+
+  // 64-bit FNV-1a offset basis.
+  uint64_t fingerprint = 14695981039346656037ULL;
+
+  fingerprint = hashCombine(fingerprint, resource.name());
+  fingerprint =
+    hashCombine(fingerprint, static_cast<uint64_t>(resource.type()));
+  fingerprint = hashCombine(fingerprint, resource.role());
+
+  uint64_t presence =
+    (resource.has_reservation() ? 1 : 0) |
+    (resource.has_disk() ? 2 : 0) |
+    (resource.has_revocable() ? 4 : 0) |
+    (resource.has_shared() ? 8 : 0);
+
+  fingerprint = hashCombine(fingerprint, presence);
+
+  if (resource.has_reservation()) {
+    fingerprint = hashCombine(fingerprint, resource.reservation().principal());
+  }
+
+  if (resource.has_disk()) {
+    const Resource::DiskInfo& disk = resource.disk();
+
+    if (disk.has_persistence()) {
+      fingerprint = hashCombine(fingerprint, disk.persistence().id());
+    }
+
+    // NOTE: `volume` is intentionally not hashed: `DiskInfo` equality
+    // ignores it, so resources differing only in `volume` may still
+    // be combined and must produce equal fingerprints.
+
+    if (disk.has_source()) {
+      fingerprint =
+        hashCombine(fingerprint, static_cast<uint64_t>(disk.source().type()));
+    }
+  }
+
+  return fingerprint;
+}
+
+
 Option<Error> Resources::Resource_::validate() const
 {
   if (isShared() && sharedCount.get() < 0) {
@@ -855,6 +932,12 @@ bool Resources::Resource_::isEmpty() const
 
 bool Resources::Resource_::contains(const Resource_& that) const
 {
+  // Different fingerprints imply that the identity fields differ, in
+  // which case neither resource can contain the other.
+  if (fingerprint != that.fingerprint) {
+    return false;
+  }
+
   // Both Resource_ objects should have the same sharedness.
   if (isShared() != that.isShared()) {
     return false;
@@ -913,6 +996,11 @@ Resources::Resource_& Resources::Resource_::operator-=(const Resource_& that)
 
 bool Resources::Resource_::operator==(const Resource_& that) const
 {
+  // Equal resources always have equal fingerprints.
+  if (fingerprint != that.fingerprint) {
+    return false;
+  }
+
   // Both Resource_ objects should have the same sharedness.
   if (isShared() != that.isShared()) {
     return false;
@@ -1601,6 +1689,15 @@ Resources Resources::operator+(const Resources& that) const
 }
 
 
+Resources Resources::operator+(Resources&& that) const
+{
+  // Add into the right operand to reuse its storage; the merged
+  // result does not depend on the order of the operands.
+  that += *this;
+  return std::move(that);
+}
+
+
 void Resources::add(const Resource_& that)
 {
   if (that.isEmpty()) {
@@ -1609,7 +1706,10 @@ void Resources::add(const Resource_& that)
 
   bool found = false;
   foreach (Resource_& resource_, resources) {
-    if (internal::addable(resource_.resource, that)) {
+    // A fingerprint mismatch means the pair cannot be addable, so we
+    // can skip the field-by-field comparison.
+    if (resource_.fingerprint == that.fingerprint &&
+        internal::addable(resource_.resource, that)) {
       resource_ += that;
       found = true;
       break;
@@ -1623,6 +1723,31 @@ void Resources::add(const Resource_& that)
 }
 
 
+void Resources::add(Resource_&& that)
+{
+  if (that.isEmpty()) {
+    return;
+  }
+
+  bool found = false;
+  foreach (Resource_& resource_, resources) {
+    // A fingerprint mismatch means the pair cannot be addable, so we
+    // can skip the field-by-field comparison.
+    if (resource_.fingerprint == that.fingerprint &&
+        internal::addable(resource_.resource, that)) {
+      resource_ += that;
+      found = true;
+      break;
+    }
+  }
+
+  // Cannot be combined with any existing Resource object.
+  if (!found) {
+    resources.push_back(std::move(that));
+  }
+}
+
+
 Resources& Resources::operator+=(const Resource_& that)
 {
   if (that.validate().isNone()) {
@@ -1633,6 +1758,16 @@ Resources& Resources::operator+=(const Resource_& that)
 }
 
 
+Resources& Resources::operator+=(Resource_&& that)
+{
+  if (that.validate().isNone()) {
+    add(std::move(that));
+  }
+
+  return *this;
+}
+
+
 Resources& Resources::operator+=(const Resource& that)
 {
   *this += Resource_(that);
@@ -1641,6 +1776,14 @@ Resources& Resources::operator+=(const Resource& that)
 }
 
 
+Resources& Resources::operator+=(Resource&& that)
+{
+  *this += Resource_(std::move(that));
+
+  return *this;
+}
+
+
 Resources& Resources::operator+=(const Resources& that)
 {
   foreach (const Resource_& resource_, that) {
@@ -1651,6 +1794,18 @@ Resources& Resources::operator+=(const Resources& that)
 }
 
 
+Resources& Resources::operator+=(Resources&& that)
+{
+  foreach (Resource_& resource_, that.resources) {
+    add(std::move(resource_));
+  }
+
+  that.resources.clear();
+
+  return *this;
+}
+
+
 Resources Resources::operator-(const Resource_& that) const
 {
   Resources result = *this;
@@ -1684,7 +1839,10 @@ void Resources::subtract(const Resource_& that)
   for (size_t i = 0; i < resources.size(); i++) {
     Resource_& resource_ = resources[i];
 
-    if (internal::subtractable(resource_.resource, that)) {
+    // A fingerprint mismatch means the pair cannot be subtractable,
+    // so we can skip the field-by-field comparison.
+    if (resource_.fingerprint == that.fingerprint &&
+        internal::subtractable(resource_.resource, that)) {
       resource_ -= that;
 
       // Remove the resource if it has become negative or empty.
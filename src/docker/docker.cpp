@@ -26,6 +26,7 @@
 #include <stout/result.hpp>
 #include <stout/strings.hpp>
 #include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
 
 #include <stout/os/killtree.hpp>
 #include <stout/os/read.hpp>
@@ -947,6 +948,28 @@ Future<Nothing> Docker::rm(
 }
 
 
+// Relays the result of an inspect to a caller through a separate
+// promise, so that a discard by one of several waiters sharing the
+// inspect cannot propagate to the others.
+static Future<Docker::Container> relayInspect(
+    const Future<Docker::Container>& inspect)
+{
+  Owned<Promise<Docker::Container>> relay(new Promise<Docker::Container>());
+
+  inspect.onAny([relay](const Future<Docker::Container>& inspect) {
+    if (inspect.isReady()) {
+      relay->set(inspect.get());
+    } else if (inspect.isFailed()) {
+      relay->fail(inspect.failure());
+    } else {
+      relay->discard();
+    }
+  });
+
+  return relay->future();
+}
+
+
 Future<Docker::Container> Docker::inspect(
     const string& containerName,
     const Option<Duration>& retryInterval) const
@@ -954,6 +977,43 @@ Future<Docker::Container> Docker::inspect(
   Owned<Promise<Docker::Container>> promise(new Promise<Docker::Container>());
 
   const string cmd =  path + " -H " + socket + " inspect " + containerName;
+
+  // Callers that set 'retryInterval' poll until the container is
+  // running and may discard the future to stop the polling, so each
+  // of them gets its own subprocess chain. One-shot inspects of the
+  // same container, however, are coalesced onto a single in-flight
+  // subprocess: the health checker, the containerizer's 'usage' and
+  // 'update' calls, and the executor frequently inspect the same
+  // container around the same time, and every 'docker inspect'
+  // costs a fork. A coalesced result is at most one subprocess run
+  // staler than a dedicated one.
+  if (retryInterval.isNone()) {
+    synchronized (*inspectMutex) {
+      Option<Future<Container>> inflight = inspecting->get(cmd);
+
+      if (inflight.isSome()) {
+        return relayInspect(inflight.get());
+      }
+
+      inspecting->put(cmd, promise->future());
+    }
+
+    // NOTE: The removal callback captures the shared state rather
+    // than 'this' since continuations may outlive this object.
+    std::shared_ptr<std::mutex> mutex = inspectMutex;
+    std::shared_ptr<hashmap<string, Future<Container>>> table = inspecting;
+
+    promise->future().onAny([mutex, table, cmd]() {
+      synchronized (*mutex) {
+        table->erase(cmd);
+      }
+    });
+
+    _inspect(cmd, promise, retryInterval);
+
+    return relayInspect(promise->future());
+  }
+
   _inspect(cmd, promise, retryInterval);
 
   return promise->future();
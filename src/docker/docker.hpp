@@ -19,6 +19,8 @@
 
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include <process/future.hpp>
@@ -26,6 +28,7 @@
 #include <process/subprocess.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
@@ -213,7 +216,10 @@ protected:
          const Option<JSON::Object>& _config)
        : path(_path),
          socket("unix://" + _socket),
-         config(_config) {}
+         config(_config),
+         inspectMutex(new std::mutex()),
+         inspecting(
+             new hashmap<std::string, process::Future<Container>>()) {}
 
 private:
   static process::Future<Version> _version(
@@ -307,6 +313,14 @@ private:
   const std::string path;
   const std::string socket;
   const Option<JSON::Object> config;
+
+  // In-flight one-shot 'docker inspect' subprocesses, keyed on the
+  // inspect command line, so that concurrent inspects of the same
+  // container share a single fork (see `inspect`). Held through
+  // shared pointers because continuations bind copies of this object.
+  const std::shared_ptr<std::mutex> inspectMutex;
+  const std::shared_ptr<hashmap<std::string, process::Future<Container>>>
+    inspecting;
 };
 
 #endif // __DOCKER_HPP__
@@ -20,6 +20,10 @@
 
 #include <sys/stat.h>
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif // __linux__
+
 #include <algorithm>
 #include <map>
 #include <string>
@@ -27,7 +31,9 @@
 
 #include <boost/shared_array.hpp>
 
+#include <process/clock.hpp>
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
@@ -36,11 +42,14 @@
 #include <process/io.hpp>
 #include <process/mime.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
+#include <stout/linkedhashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
@@ -75,6 +84,7 @@ using mesos::Authorizer;
 using process::AUTHENTICATION;
 using process::AUTHORIZATION;
 using process::defer;
+using process::delay;
 using process::DESCRIPTION;
 using process::Failure;
 using process::Future;
@@ -92,6 +102,25 @@ using std::vector;
 namespace mesos {
 namespace internal {
 
+// Bound on the age of a cached directory listing. A cached listing
+// is re-validated against the directory's modification time, but
+// that does not change when an existing file merely grows (e.g., a
+// log being appended to), so cached file metadata is also bounded
+// by age.
+static const Duration BROWSE_CACHE_STALENESS_BOUND = Seconds(5);
+
+// Maximum number of directory listings kept in the cache.
+static const size_t BROWSE_CACHE_SIZE = 16;
+
+// How often a streaming tail checks the file for appended data when
+// inotify is not available (see `FilesProcess::tail()`).
+static const Duration TAIL_POLL_INTERVAL = Milliseconds(500);
+
+// How often an inotify driven tail wakes up anyway, so that a
+// disconnected client is noticed even if the file never grows.
+static const Duration TAIL_WAKEUP_INTERVAL = Seconds(15);
+
+
 class FilesProcess : public Process<FilesProcess>
 {
 public:
@@ -153,6 +182,19 @@ private:
       const http::Request& request,
       const Option<string>& principal);
 
+  // Starts a streaming tail of the file at the given virtual path:
+  // the returned chunked response is fed data appended to the file
+  // as it is written, starting at 'offset' (or the current end of
+  // the file if the offset is -1). On Linux the file is watched
+  // with inotify; elsewhere it is polled for growth.
+  Future<http::Response> stream(const string& path, off_t offset);
+
+  // Performs one iteration of a streaming tail: writes the data
+  // currently available at 'fd' into 'writer' and then waits for
+  // the file to grow. Stops (closing the descriptors) once the
+  // client disconnects.
+  void tail(int fd, Option<int> inotify, http::Pipe::Writer writer);
+
   // Returns the raw file contents for a given path.
   // Requests have the following parameters:
   //   path: The directory to browse. Required.
@@ -174,6 +216,20 @@ private:
 
   hashmap<string, string> paths;
 
+  // A directory listing along with the information needed to decide
+  // whether it can still be served (see `browse()`).
+  struct CachedListing
+  {
+    list<FileInfo> listing;
+    time_t mtime; // Modification time of the directory when listed.
+    process::Time created; // When the listing was cached.
+  };
+
+  // Cache of directory listings keyed by resolved path, kept in
+  // insertion order so that the oldest entry can be evicted when
+  // the cache is full.
+  LinkedHashMap<string, CachedListing> cache;
+
   // Set of authorization functions. They will be called whenever
   // access to the path used as key is requested, and will pass
   // as parameter the principal returned by the HTTP authenticator.
@@ -322,7 +378,11 @@ const string FilesProcess::BROWSE_HELP = HELP(
         "",
         "Query parameters:",
         "",
-        ">        path=VALUE          The path of directory to browse."),
+        ">        path=VALUE          The path of directory to browse.",
+        ">        offset=VALUE        Index of the first entry to return",
+        "(optional).",
+        ">        length=VALUE        Maximum number of entries to return",
+        "(optional)."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "Browsing files requires that the request principal is",
@@ -374,8 +434,35 @@ Future<http::Response> FilesProcess::_browse(
   string requestedPath = path.get();
   Option<string> jsonp = request.url.query.get("jsonp");
 
+  // Optional pagination of the listing, mirroring the 'read'
+  // endpoint: 'offset' is the index of the first entry to return
+  // and 'length' bounds the number of entries returned.
+  size_t offset = 0;
+
+  if (request.url.query.get("offset").isSome()) {
+    Try<size_t> result = numify<size_t>(request.url.query.get("offset").get());
+
+    if (result.isError()) {
+      return BadRequest("Failed to parse offset: " + result.error() + ".\n");
+    }
+
+    offset = result.get();
+  }
+
+  Option<size_t> length;
+
+  if (request.url.query.get("length").isSome()) {
+    Try<size_t> result = numify<size_t>(request.url.query.get("length").get());
+
+    if (result.isError()) {
+      return BadRequest("Failed to parse length: " + result.error() + ".\n");
+    }
+
+    length = result.get();
+  }
+
   return browse(requestedPath, principal)
-  .then([jsonp](const Try<list<FileInfo>, FilesError>& result)
+  .then([jsonp, offset, length](const Try<list<FileInfo>, FilesError>& result)
     -> Future<http::Response> {
     if (result.isError()) {
       const FilesError& error = result.error();
@@ -398,7 +485,17 @@ Future<http::Response> FilesProcess::_browse(
     }
 
     JSON::Array listing;
+    size_t index = 0;
+
     foreach (const FileInfo& fileInfo, result.get()) {
+      if (index++ < offset) {
+        continue;
+      }
+
+      if (length.isSome() && listing.values.size() >= length.get()) {
+        break;
+      }
+
       listing.values.push_back(model(fileInfo));
     }
 
@@ -429,6 +526,25 @@ Future<Try<list<FileInfo>, FilesError>> FilesProcess::browse(
         return FilesError(FilesError::Type::NOT_FOUND);
       }
 
+      struct stat directory;
+      bool statted = stat(resolvedPath.get().c_str(), &directory) == 0;
+
+      // Serve the listing from the cache if the directory has not
+      // been modified since it was listed and the entry is still
+      // fresh, so that repeated browses of a hot directory don't
+      // stat every file in it again.
+      if (statted && cache.contains(resolvedPath.get())) {
+        const CachedListing& cached = cache[resolvedPath.get()];
+
+        if (cached.mtime == directory.st_mtime &&
+            process::Clock::now() - cached.created <=
+              BROWSE_CACHE_STALENESS_BOUND) {
+          return cached.listing;
+        }
+
+        cache.erase(resolvedPath.get());
+      }
+
       // The result will be a sorted (on path) list of files and dirs.
       map<string, FileInfo> files;
       Try<list<string>> entries = os::ls(resolvedPath.get());
@@ -452,6 +568,20 @@ Future<Try<list<FileInfo>, FilesError>> FilesProcess::browse(
         listing.push_back(fileInfo);
       }
 
+      if (statted) {
+        CachedListing cached;
+        cached.listing = listing;
+        cached.mtime = directory.st_mtime;
+        cached.created = process::Clock::now();
+
+        cache[resolvedPath.get()] = cached;
+
+        // Evict the oldest listing once the cache is full.
+        if (cache.size() > BROWSE_CACHE_SIZE) {
+          cache.erase(cache.keys().front());
+        }
+      }
+
       return listing;
     }));
 }
@@ -469,7 +599,10 @@ const string FilesProcess::READ_HELP = HELP(
         ">        path=VALUE          The path of directory to browse.",
         ">        offset=VALUE        Value added to base address to obtain "
         "a second address",
-        ">        length=VALUE        Length of file to read."),
+        ">        length=VALUE        Length of file to read.",
+        ">        follow=VALUE        If 'true', stream data appended to the "
+        "file as it grows (chunked response), starting at 'offset' (or the "
+        "current end of the file if no offset is given)."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "Reading files requires that the request principal is",
@@ -509,6 +642,24 @@ Future<http::Response> FilesProcess::__read(
     offset = result.get();
   }
 
+  // A streaming tail pushes appended data to the client instead of
+  // requiring it to poll with increasing offsets. The 'length' and
+  // 'jsonp' parameters do not apply: raw data is streamed until the
+  // client disconnects.
+  if (request.url.query.get("follow") == Option<string>("true")) {
+    string path_ = path.get();
+
+    return authorize(path_, principal)
+      .then(defer(self(),
+          [this, path_, offset](bool authorized) -> Future<http::Response> {
+        if (!authorized) {
+          return Forbidden();
+        }
+
+        return stream(path_, offset);
+      }));
+  }
+
   Option<size_t> length;
 
   if (request.url.query.get("length").isSome()) {
@@ -694,6 +845,180 @@ Future<Try<tuple<size_t, string>, FilesError>> FilesProcess::_read(
 }
 
 
+Future<http::Response> FilesProcess::stream(const string& path, off_t offset)
+{
+  Result<string> resolvedPath = resolve(path);
+
+  if (resolvedPath.isError()) {
+    return BadRequest(resolvedPath.error() + ".\n");
+  } else if (!resolvedPath.isSome()) {
+    return NotFound();
+  }
+
+  // Don't read directories.
+  if (os::stat::isdir(resolvedPath.get())) {
+    return BadRequest("Cannot read a directory.\n");
+  }
+
+  Try<int> fd = os::open(resolvedPath.get(), O_RDONLY | O_CLOEXEC);
+
+  if (fd.isError()) {
+    string error = strings::format(
+        "Failed to open file at '%s': %s",
+        resolvedPath.get(),
+        fd.error()).get();
+    LOG(WARNING) << error;
+    return InternalServerError(error + ".\n");
+  }
+
+  const off_t size = lseek(fd.get(), 0, SEEK_END);
+
+  if (size == -1) {
+    string error = strings::format(
+        "Failed to open file at '%s': %s",
+        resolvedPath.get(),
+        os::strerror(errno)).get();
+
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  // Start at the current end of the file unless an offset within
+  // the file was requested.
+  if (offset < 0 || offset > size) {
+    offset = size;
+  }
+
+  if (lseek(fd.get(), offset, SEEK_SET) == -1) {
+    string error = strings::format(
+        "Failed to seek file at '%s': %s",
+        resolvedPath.get(),
+        os::strerror(errno)).get();
+
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  Try<Nothing> nonblock = os::nonblock(fd.get());
+  if (nonblock.isError()) {
+    string error =
+        "Failed to set file descriptor nonblocking: " + nonblock.error();
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  // Watch the file with inotify where available so that appended
+  // data is pushed to the client as soon as it is written, instead
+  // of being noticed on the next poll.
+  Option<int> inotify = None();
+
+#ifdef __linux__
+  int ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+  if (ifd != -1) {
+    if (inotify_add_watch(ifd, resolvedPath.get().c_str(), IN_MODIFY) != -1) {
+      inotify = ifd;
+    } else {
+      // Fall back to polling the file for growth, e.g., when the
+      // inotify watch limit has been reached.
+      LOG(WARNING) << "Failed to watch file at '" << resolvedPath.get()
+                   << "': " << os::strerror(errno);
+      os::close(ifd);
+    }
+  } else {
+    LOG(WARNING) << "Failed to initialize inotify: " << os::strerror(errno);
+  }
+#endif // __linux__
+
+  http::Pipe pipe;
+
+  tail(fd.get(), inotify, pipe.writer());
+
+  OK ok;
+  ok.headers["Content-Type"] = "text/plain; charset=utf-8";
+  ok.type = http::Response::PIPE;
+  ok.reader = pipe.reader();
+  return ok;
+}
+
+
+void FilesProcess::tail(int fd, Option<int> inotify, http::Pipe::Writer writer)
+{
+  // An empty write has no effect but still reports whether the
+  // client is connected; stop (and release the descriptors) once it
+  // has gone away.
+  if (!writer.write("")) {
+    os::close(fd);
+    if (inotify.isSome()) {
+      os::close(inotify.get());
+    }
+    return;
+  }
+
+  // Read at most 16 pages worth of data at a time.
+  const size_t limit = os::pagesize() * 16;
+
+  boost::shared_array<char> data(new char[limit]);
+
+  io::read(fd, data.get(), limit)
+    .onAny(defer(self(),
+        [this, fd, inotify, writer, data](const Future<size_t>& read) mutable {
+      if (!read.isReady()) {
+        writer.fail(read.isFailed() ? read.failure() : "Read discarded");
+        os::close(fd);
+        if (inotify.isSome()) {
+          os::close(inotify.get());
+        }
+        return;
+      }
+
+      if (read.get() > 0) {
+        if (!writer.write(string(data.get(), read.get()))) {
+          os::close(fd);
+          if (inotify.isSome()) {
+            os::close(inotify.get());
+          }
+          return;
+        }
+
+        // There may be more data already available.
+        tail(fd, inotify, writer);
+        return;
+      }
+
+      // At the end of the file: wait for it to grow. With inotify we
+      // wake up as soon as the file is modified, but also periodically
+      // to notice a disconnected client; without it we poll.
+      if (inotify.isSome()) {
+        io::poll(inotify.get(), io::READ)
+          .after(TAIL_WAKEUP_INTERVAL, [](Future<short> future) -> short {
+            future.discard();
+            return 0;
+          })
+          .onAny(defer(self(),
+              [this, fd, inotify, writer](const Future<short>&) {
+            // Drain the queued events; any event simply means the
+            // file may have grown.
+            char buffer[4096];
+            while (::read(inotify.get(), buffer, sizeof(buffer)) > 0) {}
+
+            tail(fd, inotify, writer);
+          }));
+      } else {
+        delay(TAIL_POLL_INTERVAL,
+              self(),
+              &FilesProcess::tail,
+              fd,
+              inotify,
+              writer);
+      }
+    }));
+}
+
+
 const string FilesProcess::DOWNLOAD_HELP = HELP(
     TLDR(
         "Returns the raw file contents for a given path."),
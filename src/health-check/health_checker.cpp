@@ -32,7 +32,9 @@
 #include <process/collect.hpp>
 #include <process/delay.hpp>
 #include <process/http.hpp>
+#include <process/address.hpp>
 #include <process/io.hpp>
+#include <process/socket.hpp>
 #include <process/subprocess.hpp>
 
 #include <stout/duration.hpp>
@@ -61,6 +63,9 @@ using process::Subprocess;
 using process::Time;
 using process::UPID;
 
+using process::network::Address;
+using process::network::Socket;
+
 using std::map;
 using std::string;
 using std::tuple;
@@ -385,6 +390,57 @@ Future<Nothing> HealthCheckerProcess::_httpHealthCheck()
 
   const string scheme = http.has_scheme() ? http.scheme() : DEFAULT_HTTP_SCHEME;
   const string path = http.has_path() ? http.path() : "";
+
+  // If the check does not have to enter the task's namespaces and
+  // uses plain HTTP, perform it in-process over a persistent
+  // connection from the pool instead of forking a curl subprocess
+  // for every probe.
+  // NOTE: Unlike curl (which is passed '-L'), this path does not
+  // follow redirects; as with curl, a response code in [200, 400) is
+  // considered healthy.
+  if (clone.isNone() && scheme == DEFAULT_HTTP_SCHEME) {
+    const process::http::URL url(
+        scheme,
+        DEFAULT_DOMAIN,
+        http.port(),
+        path.empty() ? "/" : path);
+
+    VLOG(1) << "Performing HTTP health check '" << url << "'";
+
+    Duration timeout = Seconds(static_cast<int64_t>(check.timeout_seconds()));
+
+    return pool.send(process::http::createRequest(url, "GET"))
+      .after(timeout, [timeout](Future<process::http::Response> future) {
+        future.discard();
+
+        return Failure(
+            "HTTP health check request has not returned after " +
+            stringify(timeout) + "; aborting");
+      })
+      .then([](const process::http::Response& response) -> Future<Nothing> {
+        // The status line looks like "200 OK"; parse out the code.
+        const vector<string> tokens = strings::tokenize(response.status, " ");
+
+        Try<int> code = tokens.empty()
+          ? Try<int>(Error("Empty status line"))
+          : numify<int>(tokens.front());
+
+        if (code.isError()) {
+          return Failure(
+              "Unexpected HTTP status line '" + response.status + "'");
+        }
+
+        if (code.get() < process::http::Status::OK ||
+            code.get() >= process::http::Status::BAD_REQUEST) {
+          return Failure(
+              "Unexpected HTTP response code: " +
+              process::http::Status::string(code.get()));
+        }
+
+        return Nothing();
+      });
+  }
+
   const string url = scheme + "://" + DEFAULT_DOMAIN + ":" +
                      stringify(http.port()) + path;
 
@@ -502,6 +558,40 @@ Future<Nothing> HealthCheckerProcess::_tcpHealthCheck()
 
   const HealthCheck::TCPCheckInfo& tcp = check.tcp();
 
+  // If the check does not have to enter the task's namespaces, probe
+  // the port with an in-process connect instead of forking a
+  // subprocess. A fresh connection is established per probe by
+  // design: accepting a new connection is precisely what the check
+  // verifies.
+  if (clone.isNone()) {
+    VLOG(1) << "Performing TCP health check at port '" << tcp.port() << "'";
+
+    Try<net::IP> ip = net::IP::parse(DEFAULT_DOMAIN, AF_INET);
+    CHECK_SOME(ip);
+
+    Try<Socket> create = Socket::create();
+    if (create.isError()) {
+      return Failure("Failed to create socket: " + create.error());
+    }
+
+    Socket socket = create.get();
+    Duration timeout = Seconds(static_cast<int64_t>(check.timeout_seconds()));
+
+    return socket.connect(Address(ip.get(), tcp.port()))
+      .after(timeout, [timeout](Future<Nothing> future) {
+        future.discard();
+
+        return Failure(
+            "TCP connection has not been established after " +
+            stringify(timeout) + "; aborting");
+      })
+      .then([socket]() -> Future<Nothing> {
+        // Holding on to the socket keeps it open until the probe has
+        // completed; it is closed when the last copy goes away.
+        return Nothing();
+      });
+  }
+
   VLOG(1) << "Launching TCP health check at port '" << tcp.port() << "'";
 
   // TODO(haosdent): Replace `bash` with a tiny binary to support
@@ -24,6 +24,7 @@
 #include <mesos/mesos.hpp>
 
 #include <process/future.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/pid.hpp>
 #include <process/process.hpp>
@@ -125,6 +126,13 @@ private:
   Option<pid_t> taskPid;
   std::vector<std::string> namespaces;
   Option<lambda::function<pid_t(const lambda::function<int()>&)>> clone;
+
+  // Pool of persistent connections used for in-process HTTP checks,
+  // so that consecutive probes of the same endpoint reuse one
+  // connection instead of paying connection setup (or a curl fork)
+  // per probe.
+  process::http::ConnectionPool pool;
+
   uint32_t consecutiveFailures;
   process::Time startTime;
 };
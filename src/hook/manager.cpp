@@ -17,6 +17,7 @@
 #include <list>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/hook.hpp>
@@ -38,6 +39,7 @@
 
 using std::list;
 using std::map;
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -52,6 +54,28 @@ namespace internal {
 static std::mutex mutex;
 static LinkedHashMap<string, Hook*> availableHooks;
 
+// The installed hooks "compiled" into a flat call chain when modules
+// are (un)loaded, so that hook invocations iterate a vector instead
+// of taking the lock and performing a map lookup per hook. Modules
+// are loaded during initialization and unloaded only by tests,
+// before and between hook invocations, so reads of the chain never
+// race with a rebuild.
+static vector<pair<string, Hook*>> hookChain;
+
+
+// Rebuilds the call chain from 'availableHooks'. Must be called with
+// the lock held.
+static void compileHookChain()
+{
+  vector<pair<string, Hook*>> chain;
+
+  foreach (const string& name, availableHooks.keys()) {
+    chain.push_back({name, availableHooks[name]});
+  }
+
+  hookChain = std::move(chain);
+}
+
 
 Try<Nothing> HookManager::initialize(const string& hookList)
 {
@@ -77,6 +101,8 @@ Try<Nothing> HookManager::initialize(const string& hookList)
       // Add the hook module to the list of available hooks.
       availableHooks[hook] = module.get();
     }
+
+    compileHookChain();
   }
 
   return Nothing();
@@ -93,6 +119,8 @@ Try<Nothing> HookManager::unload(const string& hookName)
 
     // Now remove the hook from the list of available hooks.
     availableHooks.erase(hookName);
+
+    compileHookChain();
   }
 
   return Nothing();
@@ -101,9 +129,7 @@ Try<Nothing> HookManager::unload(const string& hookName)
 
 bool HookManager::hooksAvailable()
 {
-  synchronized (mutex) {
-    return !availableHooks.empty();
-  }
+  return !hookChain.empty();
 }
 
 
@@ -112,39 +138,45 @@ Labels HookManager::masterLaunchTaskLabelDecorator(
     const FrameworkInfo& frameworkInfo,
     const SlaveInfo& slaveInfo)
 {
-  synchronized (mutex) {
-    // We need a mutable copy of the task info and set the new
-    // labels after each hook invocation. Otherwise, the last hook
-    // will be the only effective hook setting the labels.
-    TaskInfo taskInfo_ = taskInfo;
-
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<Labels> result =
-        hook->masterLaunchTaskLabelDecorator(
-            taskInfo_,
-            frameworkInfo,
-            slaveInfo);
-
-      // NOTE: If the hook returns None(), the task labels won't be
-      // changed.
-      if (result.isSome()) {
-        taskInfo_.mutable_labels()->CopyFrom(result.get());
-      } else if (result.isError()) {
-        LOG(WARNING) << "Master label decorator hook failed for module '"
-                    << name << "': " << result.error();
-      }
-    }
+  // Fast path: with no hooks installed the labels pass through
+  // unmodified, without copying the task info.
+  if (hookChain.empty()) {
+    return taskInfo.labels();
+  }
 
-    return taskInfo_.labels();
+  // We need a mutable copy of the task info and set the new
+  // labels after each hook invocation. Otherwise, the last hook
+  // will be the only effective hook setting the labels.
+  TaskInfo taskInfo_ = taskInfo;
+
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    Result<Labels> result =
+      hook->masterLaunchTaskLabelDecorator(
+          taskInfo_,
+          frameworkInfo,
+          slaveInfo);
+
+    // NOTE: If the hook returns None(), the task labels won't be
+    // changed. The hook's result is dead after this, so swap it in
+    // rather than copying it.
+    if (result.isSome()) {
+      taskInfo_.mutable_labels()->Swap(&result.get());
+    } else if (result.isError()) {
+      LOG(WARNING) << "Master label decorator hook failed for module '"
+                  << name << "': " << result.error();
+    }
   }
+
+  Labels labels;
+  labels.Swap(taskInfo_.mutable_labels());
+
+  return labels;
 }
 
 
 void HookManager::masterSlaveLostHook(const SlaveInfo& slaveInfo)
 {
-  foreach (const string& name, availableHooks.keys()) {
-    Hook* hook = availableHooks[name];
+  foreachpair (const string& name, Hook* hook, hookChain) {
     Try<Nothing> result = hook->masterSlaveLostHook(slaveInfo);
     if (result.isError()) {
       LOG(WARNING) << "Master agent-lost hook failed for module '"
@@ -160,51 +192,57 @@ Labels HookManager::slaveRunTaskLabelDecorator(
     const FrameworkInfo& frameworkInfo,
     const SlaveInfo& slaveInfo)
 {
-  synchronized (mutex) {
-    TaskInfo taskInfo_ = taskInfo;
-
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<Labels> result = hook->slaveRunTaskLabelDecorator(
-          taskInfo_, executorInfo, frameworkInfo, slaveInfo);
-
-      // NOTE: If the hook returns None(), the task labels won't be
-      // changed.
-      if (result.isSome()) {
-        taskInfo_.mutable_labels()->CopyFrom(result.get());
-      } else if (result.isError()) {
-        LOG(WARNING) << "Agent label decorator hook failed for module '"
-                    << name << "': " << result.error();
-      }
-    }
+  // Fast path: with no hooks installed the labels pass through
+  // unmodified, without copying the task info.
+  if (hookChain.empty()) {
+    return taskInfo.labels();
+  }
+
+  TaskInfo taskInfo_ = taskInfo;
 
-    return taskInfo_.labels();
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    Result<Labels> result = hook->slaveRunTaskLabelDecorator(
+        taskInfo_, executorInfo, frameworkInfo, slaveInfo);
+
+    // NOTE: If the hook returns None(), the task labels won't be
+    // changed.
+    if (result.isSome()) {
+      taskInfo_.mutable_labels()->Swap(&result.get());
+    } else if (result.isError()) {
+      LOG(WARNING) << "Agent label decorator hook failed for module '"
+                  << name << "': " << result.error();
+    }
   }
+
+  Labels labels;
+  labels.Swap(taskInfo_.mutable_labels());
+
+  return labels;
 }
 
 
 Environment HookManager::slaveExecutorEnvironmentDecorator(
     ExecutorInfo executorInfo)
 {
-  synchronized (mutex) {
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<Environment> result =
-        hook->slaveExecutorEnvironmentDecorator(executorInfo);
-
-      // NOTE: If the hook returns None(), the environment won't be
-      // changed.
-      if (result.isSome()) {
-        executorInfo.mutable_command()->mutable_environment()->CopyFrom(
-            result.get());
-      } else if (result.isError()) {
-        LOG(WARNING) << "Agent environment decorator hook failed for module '"
-                    << name << "': " << result.error();
-      }
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    Result<Environment> result =
+      hook->slaveExecutorEnvironmentDecorator(executorInfo);
+
+    // NOTE: If the hook returns None(), the environment won't be
+    // changed.
+    if (result.isSome()) {
+      executorInfo.mutable_command()->mutable_environment()->Swap(
+          &result.get());
+    } else if (result.isError()) {
+      LOG(WARNING) << "Agent environment decorator hook failed for module '"
+                  << name << "': " << result.error();
     }
-
-    return executorInfo.command().environment();
   }
+
+  Environment environment;
+  environment.Swap(executorInfo.mutable_command()->mutable_environment());
+
+  return environment;
 }
 
 
@@ -217,14 +255,16 @@ Future<map<string, string>>
       const string& mappedDirectory,
       const Option<map<string, string>>& env)
 {
+  if (hookChain.empty()) {
+    return map<string, string>();
+  }
+
   // We execute these hooks according to their ordering so any conflicting
   // environment variables can be deterministically resolved
   // (the last hook takes priority).
   list<Future<Option<Environment>>> futures;
 
-  foreach (const string& name, availableHooks.keys()) {
-    Hook* hook = availableHooks[name];
-
+  foreachvalue (Hook* hook, hookChain) {
     // Chain together each hook.
     futures.push_back(
         hook->slavePreLaunchDockerEnvironmentDecorator(
@@ -268,8 +308,7 @@ void HookManager::slavePreLaunchDockerHook(
     const Option<Resources>& resources,
     const Option<map<string, string>>& env)
 {
-  foreach (const string& name, availableHooks.keys()) {
-    Hook* hook = availableHooks[name];
+  foreachpair (const string& name, Hook* hook, hookChain) {
     Try<Nothing> result =
       hook->slavePreLaunchDockerHook(
           containerInfo,
@@ -293,8 +332,7 @@ void HookManager::slavePostFetchHook(
     const ContainerID& containerId,
     const string& directory)
 {
-  foreach (const string& name, availableHooks.keys()) {
-    Hook* hook = availableHooks[name];
+  foreachpair (const string& name, Hook* hook, hookChain) {
     Try<Nothing> result = hook->slavePostFetchHook(containerId, directory);
     if (result.isError()) {
       LOG(WARNING) << "Agent post fetch hook failed for module "
@@ -308,8 +346,7 @@ void HookManager::slaveRemoveExecutorHook(
     const FrameworkInfo& frameworkInfo,
     const ExecutorInfo& executorInfo)
 {
-  foreach (const string& name, availableHooks.keys()) {
-    Hook* hook = availableHooks[name];
+  foreachpair (const string& name, Hook* hook, hookChain) {
     const Try<Nothing> result =
       hook->slaveRemoveExecutorHook(frameworkInfo, executorInfo);
     if (result.isError()) {
@@ -324,87 +361,86 @@ TaskStatus HookManager::slaveTaskStatusDecorator(
     const FrameworkID& frameworkId,
     TaskStatus status)
 {
-  synchronized (mutex) {
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<TaskStatus> result =
-        hook->slaveTaskStatusDecorator(frameworkId, status);
-
-      // NOTE: Labels/ContainerStatus remain unchanged if the hook returns
-      // None().
-      if (result.isSome()) {
-        if (result.get().has_labels()) {
-          status.mutable_labels()->CopyFrom(result.get().labels());
-        }
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    Result<TaskStatus> result =
+      hook->slaveTaskStatusDecorator(frameworkId, status);
+
+    // NOTE: Labels/ContainerStatus remain unchanged if the hook returns
+    // None().
+    if (result.isSome()) {
+      if (result.get().has_labels()) {
+        status.mutable_labels()->Swap(result.get().mutable_labels());
+      }
 
-        if (result.get().has_container_status()) {
-          status.mutable_container_status()->CopyFrom(
-              result.get().container_status());
-        }
-      } else if (result.isError()) {
-        LOG(WARNING) << "Agent TaskStatus decorator hook failed for "
-                     << "module '" << name << "': " << result.error();
+      if (result.get().has_container_status()) {
+        status.mutable_container_status()->Swap(
+            result.get().mutable_container_status());
       }
+    } else if (result.isError()) {
+      LOG(WARNING) << "Agent TaskStatus decorator hook failed for "
+                   << "module '" << name << "': " << result.error();
     }
-
-    return status;
   }
+
+  return status;
 }
 
 Resources HookManager::slaveResourcesDecorator(
     const SlaveInfo& slaveInfo)
 {
+  // Fast path: with no hooks installed the resources pass through
+  // unmodified, without copying the agent info.
+  if (hookChain.empty()) {
+    return slaveInfo.resources();
+  }
+
   // We need a mutable copy of the Resources object. Each hook will see the
-  // changes made by previous hooks, so the order of execution matters. The
-  // execution order is currently unspecified since availableHooks uses a
-  // hashmap.
+  // changes made by previous hooks, so the order of execution matters.
   SlaveInfo slaveInfo_ = slaveInfo;
 
-  synchronized (mutex) {
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<Resources> result =
-        hook->slaveResourcesDecorator(slaveInfo_);
-
-      // NOTE: Resources remain unchanged if the hook returns None().
-      if (result.isSome()) {
-        slaveInfo_.mutable_resources()->CopyFrom(result.get());
-      } else if (result.isError()) {
-        LOG(WARNING) << "Agent Resources decorator hook failed for "
-                     << "module '" << name << "': " << result.error();
-      }
-    }
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    const Result<Resources> result =
+      hook->slaveResourcesDecorator(slaveInfo_);
 
-    return slaveInfo_.resources();
+    // NOTE: Resources remain unchanged if the hook returns None().
+    if (result.isSome()) {
+      slaveInfo_.mutable_resources()->CopyFrom(result.get());
+    } else if (result.isError()) {
+      LOG(WARNING) << "Agent Resources decorator hook failed for "
+                   << "module '" << name << "': " << result.error();
+    }
   }
+
+  return slaveInfo_.resources();
 }
 
 Attributes HookManager::slaveAttributesDecorator(
     const SlaveInfo& slaveInfo)
 {
+  // Fast path: with no hooks installed the attributes pass through
+  // unmodified, without copying the agent info.
+  if (hookChain.empty()) {
+    return slaveInfo.attributes();
+  }
+
   // We need a mutable copy of the Attributes object. Each hook will see the
-  // changes made by previous hooks, so the order of execution matters. The
-  // execution order is currently unspecified since availableHooks uses a
-  // hashmap.
+  // changes made by previous hooks, so the order of execution matters.
   SlaveInfo slaveInfo_ = slaveInfo;
 
-  synchronized (mutex) {
-    foreach (const string& name, availableHooks.keys()) {
-      Hook* hook = availableHooks[name];
-      const Result<Attributes> result =
-        hook->slaveAttributesDecorator(slaveInfo_);
-
-      // NOTE: Attributes remain unchanged if the hook returns None().
-      if (result.isSome()) {
-        slaveInfo_.mutable_attributes()->CopyFrom(result.get());
-      } else if (result.isError()) {
-        LOG(WARNING) << "Agent Attributes decorator hook failed for "
-                     << "module '" << name << "': " << result.error();
-      }
-    }
+  foreachpair (const string& name, Hook* hook, hookChain) {
+    const Result<Attributes> result =
+      hook->slaveAttributesDecorator(slaveInfo_);
 
-    return slaveInfo_.attributes();
+    // NOTE: Attributes remain unchanged if the hook returns None().
+    if (result.isSome()) {
+      slaveInfo_.mutable_attributes()->CopyFrom(result.get());
+    } else if (result.isError()) {
+      LOG(WARNING) << "Agent Attributes decorator hook failed for "
+                   << "module '" << name << "': " << result.error();
+    }
   }
+
+  return slaveInfo_.attributes();
 }
 
 } // namespace internal {
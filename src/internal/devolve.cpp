@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <stout/check.hpp>
+#include <stout/thread_local.hpp>
 
 #include "internal/devolve.hpp"
 
@@ -28,19 +29,26 @@ static T devolve(const google::protobuf::Message& message)
 {
   T t;
 
-  string data;
+  // Since this round trip is on the API hot path, we serialize into
+  // a thread local buffer that is reused (and only ever grown)
+  // across calls rather than heap allocating a string per call.
+  static THREAD_LOCAL string* data = nullptr;
+
+  if (data == nullptr) {
+    data = new string();
+  }
 
   // NOTE: We need to use 'SerializePartialToString' instead of
   // 'SerializeToString' because some required fields might not be set
   // and we don't want an exception to get thrown.
-  CHECK(message.SerializePartialToString(&data))
+  CHECK(message.SerializePartialToString(data))
     << "Failed to serialize " << message.GetTypeName()
     << " while devolving to " << t.GetTypeName();
 
   // NOTE: We need to use 'ParsePartialFromString' instead of
   // 'ParseFromString' because some required fields might not
   // be set and we don't want an exception to get thrown.
-  CHECK(t.ParsePartialFromString(data))
+  CHECK(t.ParsePartialFromString(*data))
     << "Failed to parse " << t.GetTypeName()
     << " while devolving from " << message.GetTypeName();
 
@@ -62,13 +70,21 @@ Credential devolve(const v1::Credential& credential)
 
 ExecutorID devolve(const v1::ExecutorID& executorId)
 {
-  return devolve<ExecutorID>(executorId);
+  // Converted directly for speed, see the note in
+  // `devolve(const v1::AgentID&)` below.
+  ExecutorID id;
+  id.set_value(executorId.value());
+  return id;
 }
 
 
 FrameworkID devolve(const v1::FrameworkID& frameworkId)
 {
-  return devolve<FrameworkID>(frameworkId);
+  // Converted directly for speed, see the note in
+  // `devolve(const v1::AgentID&)` below.
+  FrameworkID id;
+  id.set_value(frameworkId.value());
+  return id;
 }
 
 
@@ -123,7 +139,11 @@ SlaveInfo devolve(const v1::AgentInfo& agentInfo)
 
 TaskID devolve(const v1::TaskID& taskId)
 {
-  return devolve<TaskID>(taskId);
+  // Converted directly for speed, see the note in
+  // `devolve(const v1::AgentID&)` below.
+  TaskID id;
+  id.set_value(taskId.value());
+  return id;
 }
 
 
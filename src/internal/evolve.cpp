@@ -27,6 +27,7 @@
 #include <stout/check.hpp>
 #include <stout/json.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/thread_local.hpp>
 
 #include "internal/evolve.hpp"
 
@@ -48,19 +49,26 @@ static T evolve(const google::protobuf::Message& message)
 {
   T t;
 
-  string data;
+  // Since this round trip is on the API hot path, we serialize into
+  // a thread local buffer that is reused (and only ever grown)
+  // across calls rather than heap allocating a string per call.
+  static THREAD_LOCAL string* data = nullptr;
+
+  if (data == nullptr) {
+    data = new string();
+  }
 
   // NOTE: We need to use 'SerializePartialToString' instead of
   // 'SerializeToString' because some required fields might not be set
   // and we don't want an exception to get thrown.
-  CHECK(message.SerializePartialToString(&data))
+  CHECK(message.SerializePartialToString(data))
     << "Failed to serialize " << message.GetTypeName()
     << " while evolving to " << t.GetTypeName();
 
   // NOTE: We need to use 'ParsePartialFromString' instead of
   // 'ParseFromString' because some required fields might not
   // be set and we don't want an exception to get thrown.
-  CHECK(t.ParsePartialFromString(data))
+  CHECK(t.ParsePartialFromString(*data))
     << "Failed to parse " << t.GetTypeName()
     << " while evolving from " << message.GetTypeName();
 
@@ -88,7 +96,11 @@ v1::AgentInfo evolve(const SlaveInfo& slaveInfo)
 
 v1::ExecutorID evolve(const ExecutorID& executorId)
 {
-  return evolve<v1::ExecutorID>(executorId);
+  // Converted directly for speed, see the note in
+  // `evolve(const SlaveID&)` above.
+  v1::ExecutorID id;
+  id.set_value(executorId.value());
+  return id;
 }
 
 
@@ -106,7 +118,11 @@ v1::FileInfo evolve(const FileInfo& fileInfo)
 
 v1::FrameworkID evolve(const FrameworkID& frameworkId)
 {
-  return evolve<v1::FrameworkID>(frameworkId);
+  // Converted directly for speed, see the note in
+  // `evolve(const SlaveID&)` above.
+  v1::FrameworkID id;
+  id.set_value(frameworkId.value());
+  return id;
 }
 
 
@@ -148,7 +164,11 @@ v1::Offer evolve(const Offer& offer)
 
 v1::OfferID evolve(const OfferID& offerId)
 {
-  return evolve<v1::OfferID>(offerId);
+  // Converted directly for speed, see the note in
+  // `evolve(const SlaveID&)` above.
+  v1::OfferID id;
+  id.set_value(offerId.value());
+  return id;
 }
 
 
@@ -160,8 +180,18 @@ v1::Resource evolve(const Resource& resource)
 
 v1::Resources evolve(const Resources& resources)
 {
-  return evolve<v1::Resource>(
-      static_cast<const RepeatedPtrField<Resource>&>(resources));
+  // NOTE: We convert each Resource directly instead of going through
+  // the conversion operator to `RepeatedPtrField<Resource>`, which
+  // deep-copies the entire resource vector before evolving it.
+  RepeatedPtrField<v1::Resource> evolved;
+  evolved.Reserve(resources.size());
+
+  foreach (const Resource& resource, resources) {
+    v1::Resource r = evolve(resource);
+    r.Swap(evolved.Add());
+  }
+
+  return evolved;
 }
 
 
@@ -173,7 +203,11 @@ v1::Task evolve(const Task& task)
 
 v1::TaskID evolve(const TaskID& taskId)
 {
-  return evolve<v1::TaskID>(taskId);
+  // Converted directly for speed, see the note in
+  // `evolve(const SlaveID&)` above.
+  v1::TaskID id;
+  id.set_value(taskId.value());
+  return id;
 }
 
 
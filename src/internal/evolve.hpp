@@ -90,12 +90,15 @@ v1::scheduler::Call evolve(const scheduler::Call& call);
 // Helper for repeated field evolving to 'T1' from 'T2'.
 template <typename T1, typename T2>
 google::protobuf::RepeatedPtrField<T1> evolve(
-    google::protobuf::RepeatedPtrField<T2> t2s)
+    const google::protobuf::RepeatedPtrField<T2>& t2s)
 {
   google::protobuf::RepeatedPtrField<T1> t1s;
+  t1s.Reserve(t2s.size());
 
   foreach (const T2& t2, t2s) {
-    t1s.Add()->CopyFrom(evolve(t2));
+    // Swap the evolved message into place rather than deep-copying it.
+    T1 t1 = evolve(t2);
+    t1.Swap(t1s.Add());
   }
 
   return t1s;
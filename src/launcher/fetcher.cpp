@@ -15,7 +15,10 @@
 // limitations under the License.
 
 #include <string>
+#include <vector>
 
+#include <process/async.hpp>
+#include <process/collect.hpp>
 #include <process/owned.hpp>
 
 #include <stout/json.hpp>
@@ -45,6 +48,7 @@ using namespace mesos;
 using namespace mesos::internal;
 
 using std::string;
+using std::vector;
 
 using mesos::fetcher::FetcherInfo;
 
@@ -536,16 +540,34 @@ int main(int argc, char* argv[])
       Option<string>::some(fetcherInfo.get().frameworks_home()) :
         Option<string>::none();
 
-  // Fetch each URI to a local file and chmod if necessary.
+  // Fetch the URIs in parallel, each to its own local file, and
+  // chmod if necessary. The items are independent of each other:
+  // every one downloads to a distinct file in the sandbox (or in the
+  // cache), so they can safely proceed concurrently. The parallelism
+  // is naturally bounded by the size of the libprocess worker pool.
+  vector<Future<Try<string>>> fetches;
+  fetches.reserve(fetcherInfo.get().items_size());
+
   foreach (const FetcherInfo::Item& item, fetcherInfo.get().items()) {
-    Try<string> fetched =
-      fetch(item, cacheDirectory, sandboxDirectory, frameworksHome);
-    if (fetched.isError()) {
+    fetches.push_back(async(
+        &fetch, item, cacheDirectory, sandboxDirectory, frameworksHome));
+  }
+
+  Future<vector<Try<string>>> fetched = collect(fetches);
+  fetched.await();
+
+  CHECK_READY(fetched);
+
+  for (int i = 0; i < fetcherInfo.get().items_size(); i++) {
+    const FetcherInfo::Item& item = fetcherInfo.get().items(i);
+    const Try<string>& result = fetched->at(i);
+
+    if (result.isError()) {
       EXIT(EXIT_FAILURE)
-        << "Failed to fetch '" << item.uri().value() << "': " + fetched.error();
+        << "Failed to fetch '" << item.uri().value() << "': " + result.error();
     } else {
       LOG(INFO) << "Fetched '" << item.uri().value()
-                << "' to '" << fetched.get() << "'";
+                << "' to '" << result.get() << "'";
     }
   }
 
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
@@ -54,6 +55,7 @@
 #include <stout/proc.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/unreachable.hpp>
 
 #include "linux/cgroups.hpp"
@@ -517,18 +519,39 @@ Try<string> prepare(
 
 // Returns some error string if either (a) hierarchy is not mounted,
 // (b) cgroup does not exist, or (c) control file does not exist.
+// Hierarchies that have already been verified to be mounted, so that
+// we don't have to walk /proc/mounts again for every operation on
+// them (the isolators issue dozens of operations per container
+// event). `unmount` removes the hierarchy from this set. Guarded by
+// `verifiedHierarchiesMutex` since cgroups helpers may be called
+// concurrently from worker threads.
+static std::mutex* verifiedHierarchiesMutex = new std::mutex();
+static hashset<string>* verifiedHierarchies = new hashset<string>();
+
+
 static Option<Error> verify(
     const string& hierarchy,
     const string& cgroup = "",
     const string& control = "")
 {
-  Try<bool> mounted = cgroups::mounted(hierarchy);
-  if (mounted.isError()) {
-    return Error(
-        "Failed to determine if the hierarchy at '" + hierarchy +
-        "' is mounted: " + mounted.error());
-  } else if (!mounted.get()) {
-    return Error("'" + hierarchy + "' is not a valid hierarchy");
+  bool verified;
+  synchronized (*verifiedHierarchiesMutex) {
+    verified = verifiedHierarchies->contains(hierarchy);
+  }
+
+  if (!verified) {
+    Try<bool> mounted = cgroups::mounted(hierarchy);
+    if (mounted.isError()) {
+      return Error(
+          "Failed to determine if the hierarchy at '" + hierarchy +
+          "' is mounted: " + mounted.error());
+    } else if (!mounted.get()) {
+      return Error("'" + hierarchy + "' is not a valid hierarchy");
+    }
+
+    synchronized (*verifiedHierarchiesMutex) {
+      verifiedHierarchies->insert(hierarchy);
+    }
   }
 
   if (cgroup != "") {
@@ -773,6 +796,11 @@ Try<Nothing> unmount(const string& hierarchy)
     return unmount;
   }
 
+  // The hierarchy is gone, so stop vouching for it in `verify`.
+  synchronized (*verifiedHierarchiesMutex) {
+    verifiedHierarchies->erase(hierarchy);
+  }
+
   Try<Nothing> rmdir = os::rmdir(hierarchy);
   if (rmdir.isError()) {
     return Error(
@@ -981,6 +1009,37 @@ Try<string> read(
 }
 
 
+Try<hashmap<string, string>> read(
+    const string& hierarchy,
+    const string& cgroup,
+    const vector<string>& controls)
+{
+  Option<Error> error = verify(hierarchy, cgroup);
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  hashmap<string, string> values;
+
+  foreach (const string& control, controls) {
+    if (!os::exists(path::join(hierarchy, cgroup, control))) {
+      return Error(
+          "'" + control + "' is not a valid control (is subsystem attached?)");
+    }
+
+    Try<string> value = internal::read(hierarchy, cgroup, control);
+    if (value.isError()) {
+      return Error(
+          "Failed to read '" + control + "': " + value.error());
+    }
+
+    values[control] = value.get();
+  }
+
+  return values;
+}
+
+
 Try<Nothing> write(
     const string& hierarchy,
     const string& cgroup,
@@ -2360,22 +2419,25 @@ ostream& operator<<(ostream& stream, Level level)
 }
 
 
-// The process drives the event::Listener to keep listening on cgroups
-// memory pressure counters.
+// The process keeps listening on the pressure level eventfd of the
+// cgroup and accumulates the event count. The eventfd is read by
+// this process directly (rather than through a dedicated
+// `event::Listener`) so that each counter costs a single process and
+// no cross-process dispatch per event; polling of the eventfds of
+// all the containers is multiplexed by the libprocess event loop.
 class CounterProcess : public Process<CounterProcess>
 {
 public:
-  CounterProcess(const string& hierarchy,
-                 const string& cgroup,
-                 Level level)
+  CounterProcess(const string& _hierarchy,
+                 const string& _cgroup,
+                 Level _level)
     : ProcessBase(ID::generate("cgroups-counter")),
+      hierarchy(_hierarchy),
+      cgroup(_cgroup),
+      level(_level),
       value_(0),
-      error(None()),
-      process(new event::Listener(
-          hierarchy,
-          cgroup,
-          "memory.pressure_level",
-          stringify(level))) {}
+      data(0),
+      error(None()) {}
 
   virtual ~CounterProcess() {}
 
@@ -2391,40 +2453,77 @@ public:
 protected:
   virtual void initialize()
   {
-    spawn(CHECK_NOTNULL(process.get()));
-    listen();
+    // Register an eventfd "notifier" for the pressure level.
+    Try<int> fd = event::registerNotifier(
+        hierarchy,
+        cgroup,
+        "memory.pressure_level",
+        stringify(level));
+
+    if (fd.isError()) {
+      error = Error("Failed to register notification eventfd: " + fd.error());
+    } else {
+      eventfd = fd.get();
+      listen();
+    }
   }
 
   virtual void finalize()
   {
-    terminate(process.get());
-    wait(process.get());
+    // Discard the nonblocking read.
+    reading.discard();
+
+    // Unregister the eventfd if needed.
+    if (eventfd.isSome()) {
+      Try<Nothing> unregister = event::unregisterNotifier(eventfd.get());
+      if (unregister.isError()) {
+        LOG(ERROR) << "Failed to unregister eventfd: " << unregister.error();
+      }
+    }
   }
 
 private:
   void listen()
   {
-    dispatch(process.get(), &event::Listener::listen)
-      .onAny(defer(self(), &CounterProcess::_listen, lambda::_1));
+    // Perform nonblocking read on the event file. The nonblocking
+    // read will start polling on the event file until it becomes
+    // readable. If we can successfully read 8 bytes (sizeof
+    // uint64_t) from the event file, it indicates that an event has
+    // occurred.
+    reading = io::read(eventfd.get(), &data, sizeof(data));
+    reading.onAny(defer(self(), &CounterProcess::_listen));
   }
 
-  void _listen(const process::Future<uint64_t>& future)
+  void _listen()
   {
     CHECK_NONE(error);
 
-    if (future.isReady()) {
-      value_ += future.get();
+    if (reading.isReady() && reading.get() == sizeof(data)) {
+      value_ += data;
       listen();
-    } else if (future.isFailed()) {
-      error = Error(future.failure());
-    } else if (future.isDiscarded()) {
-      error = Error("Listening stopped unexpectedly");
+      return;
+    }
+
+    if (reading.isDiscarded()) {
+      error = Error("Reading eventfd stopped unexpectedly");
+    } else if (reading.isFailed()) {
+      error = Error("Failed to read eventfd: " + reading.failure());
+    } else {
+      error = Error("Read less than expected. Expect " +
+                    stringify(sizeof(data)) + " bytes; actual " +
+                    stringify(reading.get()) + " bytes");
     }
   }
 
+  const string hierarchy;
+  const string cgroup;
+  const Level level;
+
   uint64_t value_;
+  uint64_t data;                // The data read from the eventfd last time.
+  Future<size_t> reading;
   Option<Error> error;
-  process::Owned<event::Listener> process;
+  Option<int> eventfd;
 };
 
 
@@ -249,6 +249,21 @@ Try<std::string> read(
     const std::string& control);
 
 
+// Read a batch of control files of the same cgroup. The hierarchy
+// and the cgroup are verified once for the whole batch rather than
+// once per control file, so prefer this overload when several
+// controls need to be sampled together (e.g., when gathering
+// resource statistics).
+// @param   hierarchy   Path to the hierarchy root.
+// @param   cgroup      Path to the cgroup relative to the hierarchy root.
+// @param   controls    Names of the control files.
+// @return  The values read, keyed by control file name.
+Try<hashmap<std::string, std::string>> read(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::vector<std::string>& controls);
+
+
 // Write a control file. Parameter checking is similar to read.
 // @param   hierarchy   Path to the hierarchy root.
 // @param   cgroup      Path to the cgroup relative to the hierarchy root.
@@ -15,6 +15,8 @@
 // limitations under the License.
 
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -22,6 +24,7 @@
 #include <linux/unistd.h>
 
 #include <list>
+#include <mutex>
 #include <set>
 #include <utility>
 
@@ -34,6 +37,7 @@
 #include <stout/path.hpp>
 #include <stout/strings.hpp>
 #include <stout/synchronized.hpp>
+#include <stout/unreachable.hpp>
 
 #include <stout/fs.hpp>
 #include <stout/os.hpp>
@@ -178,6 +182,71 @@ Try<MountInfoTable> MountInfoTable::read(
 }
 
 
+Try<MountInfoTable> MountInfoTable::cachedRead(bool hierarchicalSort)
+{
+  // The kernel reports POLLPRI (or POLLERR, depending on the kernel
+  // version) on a polled /proc/self/mountinfo descriptor if a mount
+  // or unmount has happened in the mount namespace since the
+  // descriptor was last polled. We keep one such descriptor open for
+  // the lifetime of the process and only re-read and re-parse the
+  // table when a poll with a zero timeout reports a change.
+  //
+  // NOTE: The kernel flags the event as part of the mount syscall
+  // itself, so a mount performed by this process is guaranteed to be
+  // visible to a subsequent `cachedRead`.
+  static std::mutex* mutex = new std::mutex();
+  static int fd = -1;
+  static Option<MountInfoTable> sorted = None();
+  static Option<MountInfoTable> unsorted = None();
+
+  synchronized (*mutex) {
+    if (fd == -1) {
+      Try<int> open = os::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+      if (open.isError()) {
+        return Error(
+            "Failed to open /proc/self/mountinfo: " + open.error());
+      }
+
+      fd = open.get();
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLPRI;
+    pfd.revents = 0;
+
+    if (::poll(&pfd, 1, 0) == -1) {
+      return ErrnoError("Failed to poll /proc/self/mountinfo");
+    }
+
+    // NOTE: Polling the descriptor acknowledges the event, i.e., the
+    // next poll will not report a change until another mount or
+    // unmount happens.
+    if ((pfd.revents & (POLLPRI | POLLERR)) != 0) {
+      sorted = None();
+      unsorted = None();
+    }
+
+    Option<MountInfoTable>& cache = hierarchicalSort ? sorted : unsorted;
+
+    if (cache.isNone()) {
+      Try<MountInfoTable> table =
+        MountInfoTable::read(None(), hierarchicalSort);
+
+      if (table.isError()) {
+        return Error(table.error());
+      }
+
+      cache = table.get();
+    }
+
+    return cache.get();
+  }
+
+  UNREACHABLE();
+}
+
+
 Try<MountInfoTable::Entry> MountInfoTable::Entry::parse(const string& s)
 {
   MountInfoTable::Entry entry;
@@ -239,6 +239,19 @@ struct MountInfoTable {
       const std::string& lines,
       bool hierarchicalSort = true);
 
+  // Read the mountinfo table for the calling process, returning a
+  // cached copy if the mount namespace has not changed since the
+  // table was last parsed. The kernel reports an exceptional
+  // condition on a polled /proc/self/mountinfo descriptor whenever a
+  // mount or unmount happens in the mount namespace, which is what we
+  // use for invalidation. Use this in preference to `read` on hot
+  // paths (e.g., per container launch or destroy): parsing the table
+  // takes milliseconds on hosts with thousands of mounts.
+  // @param   hierarchicalSort
+  //                  See `read` above.
+  // @return  An instance of MountInfoTable if success.
+  static Try<MountInfoTable> cachedRead(bool hierarchicalSort = true);
+
   // TODO(jieyu): Introduce 'find' methods to find entries that match
   // the given conditions (e.g., target, root, devno, etc.).
 
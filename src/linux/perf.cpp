@@ -14,11 +14,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <linux/perf_event.h>
+
+#include <sys/ioctl.h>
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
@@ -30,18 +37,21 @@
 #include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/id.hpp>
 #include <process/io.hpp>
 #include <process/process.hpp>
 #include <process/subprocess.hpp>
 
 #include <stout/os.hpp>
+#include <stout/path.hpp>
 #include <stout/strings.hpp>
 
 #include <stout/os/signals.hpp>
 
 #include "common/status_utils.hpp"
 
+#include "linux/cgroups.hpp"
 #include "linux/perf.hpp"
 
 using namespace process;
@@ -71,6 +81,509 @@ inline string normalize(const string& s)
 }
 
 
+// The perf_event_attr type and config for a counter.
+struct EventConfig
+{
+  uint32_t type;
+  uint64_t config;
+};
+
+
+// Shorthand for building a hardware cache event config,
+// see perf_event_open(2).
+static constexpr uint64_t cacheConfig(
+    uint64_t cache,
+    uint64_t operation,
+    uint64_t result)
+{
+  return cache | (operation << 8) | (result << 16);
+}
+
+
+// Returns the perf_event_attr type and config for a normalized event
+// name, or None for events we do not know how to program directly
+// (e.g., raw or PMU-specific events), in which case sampling falls
+// back to forking `perf stat`. The names mirror the event fields of
+// the PerfStatistics protobuf.
+static Option<EventConfig> attribute(const string& event)
+{
+  static const hashmap<string, EventConfig> attributes = {
+    // Hardware events.
+    {"cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}},
+    {"stalled_cycles_frontend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND}},
+    {"stalled_cycles_backend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND}},
+    {"instructions", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}},
+    {"cache_references",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES}},
+    {"cache_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}},
+    {"branches", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS}},
+    {"branch_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}},
+    {"bus_cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES}},
+    {"ref_cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES}},
+
+    // Software events.
+    {"cpu_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK}},
+    {"task_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}},
+    {"page_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}},
+    {"minor_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN}},
+    {"major_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ}},
+    {"context_switches",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}},
+    {"cpu_migrations", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS}},
+    {"alignment_faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_ALIGNMENT_FAULTS}},
+    {"emulation_faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_EMULATION_FAULTS}},
+
+    // Hardware cache events.
+    {"l1_dcache_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"l1_dcache_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"l1_dcache_stores",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"l1_dcache_store_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"l1_dcache_prefetches",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"l1_dcache_prefetch_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1D,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"l1_icache_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1I,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"l1_icache_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1I,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"l1_icache_prefetches",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1I,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"l1_icache_prefetch_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_L1I,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"llc_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"llc_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"llc_stores",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"llc_store_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"llc_prefetches",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"llc_prefetch_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_LL,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"dtlb_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"dtlb_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"dtlb_stores",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"dtlb_store_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"dtlb_prefetches",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"dtlb_prefetch_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"itlb_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_ITLB,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"itlb_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_ITLB,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"branch_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_BPU,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"branch_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_BPU,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"node_loads",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"node_load_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"node_stores",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"node_store_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_WRITE,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+    {"node_prefetches",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+    {"node_prefetch_misses",
+     {PERF_TYPE_HW_CACHE,
+      cacheConfig(PERF_COUNT_HW_CACHE_NODE,
+                  PERF_COUNT_HW_CACHE_OP_PREFETCH,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+  };
+
+  if (attributes.contains(event)) {
+    return attributes.at(event);
+  }
+
+  return None();
+}
+
+
+// A single per-CPU counter programmed via perf_event_open(2).
+struct Counter
+{
+  string cgroup;
+  string event; // Normalized event name.
+  int fd;
+};
+
+
+// Closes the file descriptors of the specified counters.
+static void close(const vector<Counter>& counters)
+{
+  foreach (const Counter& counter, counters) {
+    ::close(counter.fd);
+  }
+}
+
+
+// Opens one counting counter per (cgroup, event, logical CPU) via
+// perf_event_open(2); cgroup mode counters are per-CPU so the counts
+// are summed across CPUs when the sample window closes. Counters are
+// created disabled so that the sampler can enable them together,
+// giving all counters the same window. Events that the hardware does
+// not support are skipped, mirroring the '<not supported>' rows of
+// `perf stat` output. Returns an error if any other counter cannot
+// be opened (e.g., insufficient privileges or a kernel without
+// cgroup perf support).
+static Try<vector<Counter>> open(
+    const set<string>& events,
+    const set<string>& cgroups,
+    const string& hierarchy)
+{
+  Try<long> cpus = os::cpus();
+  if (cpus.isError()) {
+    return Error("Failed to determine the number of CPUs: " + cpus.error());
+  }
+
+  vector<Counter> counters;
+
+  foreach (const string& cgroup, cgroups) {
+    Try<int> cgroupFd = os::open(path::join(hierarchy, cgroup), O_RDONLY);
+    if (cgroupFd.isError()) {
+      close(counters);
+      return Error(
+          "Failed to open cgroup '" + cgroup + "': " + cgroupFd.error());
+    }
+
+    foreach (const string& event, events) {
+      const string normalized = normalize(event);
+
+      Option<EventConfig> config = attribute(normalized);
+
+      // The caller only samples directly when all events are known.
+      CHECK_SOME(config);
+
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+
+      attr.size = sizeof(attr);
+      attr.type = config->type;
+      attr.config = config->config;
+
+      // Create the counter disabled, and include the enabled and
+      // running times in reads so that counts can be scaled if the
+      // kernel had to multiplex counters onto the PMU.
+      attr.disabled = 1;
+      attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      bool supported = true;
+
+      for (long cpu = 0; cpu < cpus.get(); cpu++) {
+        int fd = ::syscall(
+            __NR_perf_event_open,
+            &attr,
+            cgroupFd.get(),
+            static_cast<int>(cpu),
+            -1,
+            static_cast<unsigned long>(PERF_FLAG_PID_CGROUP));
+
+        if (fd == -1) {
+          // Skip events that the hardware (or kernel) does not
+          // support, like `perf stat` reporting '<not supported>'.
+          if (errno == ENOENT || errno == ENODEV || errno == EOPNOTSUPP) {
+            VLOG(1) << "Perf event '" << event << "' is not supported";
+            supported = false;
+            break;
+          }
+
+          ErrnoError error(
+              "Failed to open perf event '" + event + "'"
+              " for cgroup '" + cgroup + "'");
+
+          os::close(cgroupFd.get());
+          close(counters);
+          return error;
+        }
+
+        os::cloexec(fd);
+
+        counters.push_back(Counter{cgroup, normalized, fd});
+      }
+
+      if (!supported) {
+        // Drop any per-CPU counters already opened for this event.
+        while (!counters.empty() &&
+               counters.back().cgroup == cgroup &&
+               counters.back().event == normalized) {
+          ::close(counters.back().fd);
+          counters.pop_back();
+        }
+      }
+    }
+
+    // The counters hold their own reference to the cgroup.
+    os::close(cgroupFd.get());
+  }
+
+  return counters;
+}
+
+
+// Sets the field of the statistics matching the normalized event
+// name. NOTE: the kernel counts the clock events in nanoseconds but
+// `perf stat` (and therefore PerfStatistics) reports them in
+// milliseconds, so the double (clock) fields are converted.
+static Try<Nothing> set(
+    mesos::PerfStatistics* statistics,
+    const string& event,
+    double value)
+{
+  const google::protobuf::FieldDescriptor* field =
+    statistics->GetDescriptor()->FindFieldByName(event);
+
+  if (field == nullptr) {
+    return Error("Unexpected event '" + event + "'");
+  }
+
+  switch (field->type()) {
+    case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+      statistics->GetReflection()->SetDouble(
+          statistics, field, value / 1000000.0);
+      break;
+    case google::protobuf::FieldDescriptor::TYPE_UINT64:
+      statistics->GetReflection()->SetUInt64(
+          statistics, field, static_cast<uint64_t>(value));
+      break;
+    default:
+      return Error("Unsupported field type for event '" + event + "'");
+  }
+
+  return Nothing();
+}
+
+
+// Samples the perf counters for the given cgroups by programming
+// counters directly via perf_event_open(2), rather than forking
+// `perf stat` per sampling window. This keeps the sampling cost
+// independent of the window size, allowing much shorter windows.
+class Sampler : public Process<Sampler>
+{
+public:
+  Sampler(
+      const vector<Counter>& _counters,
+      const set<string>& _cgroups,
+      const Duration& _duration)
+    : ProcessBase(process::ID::generate("perf-event-sampler")),
+      counters(_counters),
+      cgroups(_cgroups),
+      duration(_duration) {}
+
+  virtual ~Sampler() {}
+
+  Future<hashmap<string, mesos::PerfStatistics>> output()
+  {
+    return promise.future();
+  }
+
+protected:
+  virtual void initialize()
+  {
+    // Stop when no one cares.
+    promise.future().onDiscard(lambda::bind(
+        static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
+
+    start = Clock::now();
+
+    // Enable all counters together so that they cover the same
+    // window.
+    foreach (const Counter& counter, counters) {
+      ::ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    delay(duration, self(), &Self::finish);
+  }
+
+  virtual void finalize()
+  {
+    close(counters);
+    promise.discard();
+  }
+
+private:
+  void finish()
+  {
+    // Disable all counters together so that they cover the same
+    // window.
+    foreach (const Counter& counter, counters) {
+      ::ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    hashmap<string, mesos::PerfStatistics> statistics;
+
+    foreach (const string& cgroup, cgroups) {
+      statistics.put(cgroup, mesos::PerfStatistics());
+      statistics[cgroup].set_timestamp(start.secs());
+      statistics[cgroup].set_duration(duration.secs());
+    }
+
+    // Sum the per-CPU counts for each (cgroup, event), scaling each
+    // count by the time the counter was actually on the PMU in case
+    // the kernel had to multiplex counters (as `perf stat` does).
+    hashmap<string, hashmap<string, double>> totals;
+
+    foreach (const Counter& counter, counters) {
+      struct
+      {
+        uint64_t value;
+        uint64_t enabled;
+        uint64_t running;
+      } count = {0, 0, 0};
+
+      if (::read(counter.fd, &count, sizeof(count)) !=
+          static_cast<ssize_t>(sizeof(count))) {
+        promise.fail(ErrnoError(
+            "Failed to read perf event '" + counter.event + "'").message);
+        terminate(self());
+        return;
+      }
+
+      double value = static_cast<double>(count.value);
+      if (count.running > 0 && count.running < count.enabled) {
+        value *= static_cast<double>(count.enabled) / count.running;
+      }
+
+      totals[counter.cgroup][counter.event] += value;
+    }
+
+    foreachpair (
+        const string& cgroup,
+        const hashmap<string, double>& events,
+        totals) {
+      foreachpair (const string& event, double value, events) {
+        Try<Nothing> status = set(&statistics[cgroup], event, value);
+        if (status.isError()) {
+          promise.fail(status.error());
+          terminate(self());
+          return;
+        }
+      }
+    }
+
+    promise.set(statistics);
+    terminate(self());
+  }
+
+  const vector<Counter> counters;
+  const set<string> cgroups;
+  const Duration duration;
+
+  Time start;
+  Promise<hashmap<string, mesos::PerfStatistics>> promise;
+};
+
+
 // Executes the 'perf' command using the supplied arguments, and
 // returns stdout as the value of the future or a failure if calling
 // the command fails or the command returns a non-zero exit code.
@@ -247,6 +760,46 @@ Future<hashmap<string, mesos::PerfStatistics>> sample(
     return hashmap<string, mesos::PerfStatistics>();
   }
 
+  // Prefer programming counters directly via perf_event_open(2) over
+  // forking `perf stat`: a fork/exec (and a `sleep` child) per cgroup
+  // sampling window is prohibitively expensive for short windows.
+  // This requires all events to be expressible as perf_event_attr
+  // configs; for raw or PMU-specific events, or if counters cannot be
+  // opened (e.g., restrictive perf_event_paranoid), fall back to
+  // `perf stat`.
+  bool direct = true;
+
+  foreach (const string& event, events) {
+    if (internal::attribute(internal::normalize(event)).isNone()) {
+      direct = false;
+      break;
+    }
+  }
+
+  if (direct) {
+    Result<string> hierarchy = cgroups::hierarchy("perf_event");
+
+    if (hierarchy.isSome()) {
+      Try<vector<internal::Counter>> counters =
+        internal::open(events, cgroups, hierarchy.get());
+
+      if (counters.isError()) {
+        LOG(WARNING) << "Failed to open perf event counters, falling back"
+                     << " to sampling with 'perf stat': " << counters.error();
+      } else {
+        internal::Sampler* sampler =
+          new internal::Sampler(counters.get(), cgroups, duration);
+
+        Future<hashmap<string, mesos::PerfStatistics>> output =
+          sampler->output();
+
+        spawn(sampler, true);
+
+        return output;
+      }
+    }
+  }
+
   vector<string> argv = {
     "stat",
 
@@ -16,13 +16,17 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <list>
+#include <set>
 
 #include <process/collect.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
+#include <process/protobuf.hpp>
 #include <process/timer.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/stringify.hpp>
 
@@ -34,11 +38,17 @@
 using namespace process;
 
 using std::list;
+using std::set;
 
 namespace mesos {
 namespace internal {
 namespace log {
 
+// Number of positions requested per bulk read during catch-up. This
+// bounds the size of each response so that a large range is streamed
+// from the replicas in batches.
+static const uint64_t BULK_READ_CHUNK = 10240;
+
 class CatchUpProcess : public Process<CatchUpProcess>
 {
 public:
@@ -165,10 +175,13 @@ static Future<uint64_t> catchup(
 }
 
 
-// TODO(jieyu): Our current implementation catches-up each position in
-// the set sequentially. In the future, we may want to parallelize it
-// to improve the performance. Also, we may want to implement rate
-// control here so that we don't saturate the network or disk.
+// Catches-up an interval of positions by first copying the learned
+// actions that the other replicas can offer in bulk (streamed in
+// batches of `BULK_READ_CHUNK` positions), and then catching-up
+// whatever positions remain (e.g., unlearned positions) one at a
+// time through the regular consensus protocol.
+// TODO(jieyu): We may want to implement rate control here so that we
+// don't saturate the network or disk.
 class BulkCatchUpProcess : public Process<BulkCatchUpProcess>
 {
 public:
@@ -198,14 +211,19 @@ protected:
     promise.future().onDiscard(lambda::bind(
         static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
 
-    // Catch-up sequentially.
     current = positions.lower();
+    next = positions.lower();
 
-    catchup();
+    // First copy whatever learned actions the other replicas can
+    // offer for this interval in bulk, then catch-up the remaining
+    // positions one at a time.
+    bulkread();
   }
 
   virtual void finalize()
   {
+    reading.discard();
+    process::discard(responses);
     catching.discard();
 
     // TODO(benh): Discard our promise only after 'catching' has
@@ -219,6 +237,100 @@ private:
     catching.discard();
   }
 
+  static Future<Nothing> expired(Future<Nothing> reading)
+  {
+    reading.discard();
+    return Nothing();
+  }
+
+  void bulkread()
+  {
+    if (next >= positions.upper()) {
+      // All the learned actions that the other replicas could offer
+      // have been copied; catch-up the remaining positions one at a
+      // time.
+      catchup();
+      return;
+    }
+
+    BulkReadRequest request;
+    request.set_from(next);
+    request.set_to(std::min(positions.upper(), next + BULK_READ_CHUNK) - 1);
+
+    next = request.to() + 1;
+
+    // We bound each batch with the catch-up timeout. Positions that
+    // could not be read in bulk (e.g., no replica responded in time)
+    // will simply be caught-up one at a time afterwards.
+    reading = network->broadcast(protocol::bulkread, request)
+      .then(defer(self(), &Self::receive, lambda::_1))
+      .after(timeout, lambda::bind(&Self::expired, lambda::_1))
+      .onAny(defer(self(), &Self::bulkreadFinished));
+  }
+
+  Future<Nothing> receive(const set<Future<BulkReadResponse>>& _responses)
+  {
+    responses = _responses;
+    return _receive();
+  }
+
+  Future<Nothing> _receive()
+  {
+    if (responses.empty()) {
+      // No replica was able to serve this batch. The positions will
+      // be caught-up one at a time instead.
+      return Nothing();
+    }
+
+    // Process responses one after another so that we can stop at the
+    // first replica that serves the batch.
+    return select(responses)
+      .then(defer(self(), &Self::received, lambda::_1));
+  }
+
+  Future<Nothing> received(const Future<BulkReadResponse>& future)
+  {
+    // Enforced by the select semantics.
+    CHECK_READY(future);
+
+    // Remove this future from 'responses' so that we do not listen on
+    // it the next time we invoke select.
+    responses.erase(future);
+
+    const BulkReadResponse& response = future.get();
+
+    if (response.actions_size() == 0) {
+      // This replica had nothing learned in the requested range, but
+      // some other replica might.
+      return _receive();
+    }
+
+    process::discard(responses);
+    responses.clear();
+
+    VLOG(1) << "Copying " << response.actions_size()
+            << " learned actions in bulk";
+
+    // Forward the learned actions to the local replica. Learned
+    // actions have already reached consensus, so they can be adopted
+    // directly without running a consensus round per position.
+    foreach (const Action& action, response.actions()) {
+      CHECK(action.has_learned() && action.learned());
+
+      LearnedMessage message;
+      message.mutable_action()->CopyFrom(action);
+
+      post(replica->pid(), message);
+    }
+
+    return Nothing();
+  }
+
+  void bulkreadFinished()
+  {
+    bulkread();
+  }
+
   void catchup()
   {
     if (current >= positions.upper()) {
@@ -280,7 +392,12 @@ private:
   uint64_t proposal;
   uint64_t current;
 
+  // The next position to bulk read.
+  uint64_t next;
+
   process::Promise<Nothing> promise;
+  Future<Nothing> reading;
+  set<Future<BulkReadResponse>> responses;
   Future<uint64_t> catching;
 };
 
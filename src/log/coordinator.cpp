@@ -17,6 +17,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <list>
 
 #include <mesos/type_utils.hpp>
 
@@ -25,6 +26,7 @@
 #include <process/id.hpp>
 #include <process/process.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
 
 #include "log/catchup.hpp"
@@ -68,7 +70,10 @@ protected:
   virtual void finalize()
   {
     electing.discard();
-    writing.discard();
+
+    foreach (Future<Option<uint64_t>>& writing, writings) {
+      writing.discard();
+    }
   }
 
 private:
@@ -93,13 +98,17 @@ private:
   /////////////////////////////////
 
   Future<Option<uint64_t>> write(const Action& action);
+  Future<Option<uint64_t>> _write(
+      const Action& action,
+      const Future<WriteResponse>& response,
+      const Option<uint64_t>& previous);
   Future<WriteResponse> runWritePhase(const Action& action);
   Future<Option<uint64_t>> checkWritePhase(
       const Action& action,
       const WriteResponse& response);
   Future<Nothing> runLearnPhase(const Action& action);
   Future<bool> checkLearnPhase(const Action& action);
-  Future<Option<uint64_t>> updateIndexAfterWritten(bool missing);
+  Future<Option<uint64_t>> completeWrite(const Action& action, bool missing);
   void writingFinished();
   void writingFailed();
   void writingAborted();
@@ -115,7 +124,9 @@ private:
   // coordinator does not declare itself as elected until it wins the
   // election and has filled all existing positions. A coordinator is
   // put in electing state after it decides to go for an election and
-  // before it is elected.
+  // before it is elected. A coordinator is in writing state while at
+  // least one write is outstanding; appends and truncates are still
+  // accepted in that state (i.e., writes are pipelined).
   enum
   {
     INITIAL,
@@ -131,7 +142,11 @@ private:
   uint64_t index;
 
   Future<Option<uint64_t>> electing;
-  Future<Option<uint64_t>> writing;
+
+  // The outstanding writes, in position order. The front is the
+  // oldest outstanding write and the back is the tail of the pipeline
+  // that a new write chains its commitment on.
+  std::list<Future<Option<uint64_t>>> writings;
 };
 
 
@@ -307,8 +322,6 @@ Future<Option<uint64_t>> CoordinatorProcess::append(const string& bytes)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
   Action action;
@@ -327,8 +340,6 @@ Future<Option<uint64_t>> CoordinatorProcess::truncate(uint64_t to)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
   Action action;
@@ -348,21 +359,64 @@ Future<Option<uint64_t>> CoordinatorProcess::write(const Action& action)
   LOG(INFO) << "Coordinator attempting to write " << action.type()
             << " action at position " << action.position();
 
-  CHECK_EQ(state, ELECTED);
+  CHECK(state == ELECTED || state == WRITING);
   CHECK(action.has_performed() && action.has_type());
+  CHECK_EQ(action.position(), index);
 
   state = WRITING;
 
-  writing = runWritePhase(action)
-    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1))
+  // The next write (if any) will use the subsequent position. If this
+  // write does not commit, 'checkWritePhase' rewinds the index so
+  // that the position gets retried.
+  index++;
+
+  // Run the write phase (i.e., the paxos accept round) right away so
+  // that the rounds of consecutive writes overlap on the network
+  // (i.e., the writes are pipelined), but chain the commitment of
+  // this write on the previous outstanding write (if any) so that
+  // positions are committed and results are returned in order.
+  Future<WriteResponse> response = runWritePhase(action);
+
+  Future<Option<uint64_t>> writing;
+
+  if (writings.empty()) {
+    writing = response
+      .then(defer(self(), &Self::checkWritePhase, action, lambda::_1));
+  } else {
+    writing = writings.back()
+      .then(defer(self(), &Self::_write, action, response, lambda::_1));
+  }
+
+  writing
     .onReady(defer(self(), &Self::writingFinished))
     .onFailed(defer(self(), &Self::writingFailed))
     .onDiscarded(defer(self(), &Self::writingAborted));
 
+  writings.push_back(writing);
+
   return writing;
 }
 
 
+Future<Option<uint64_t>> CoordinatorProcess::_write(
+    const Action& action,
+    const Future<WriteResponse>& response,
+    const Option<uint64_t>& previous)
+{
+  // If the previous write did not commit (e.g., it was rejected by a
+  // replica that promised a competing coordinator), resolve this
+  // write to none as well without committing it so that positions
+  // are committed in order (the write phase for this position may
+  // well have succeeded, in which case a retry will commit it).
+  if (previous.isNone()) {
+    return None();
+  }
+
+  return response
+    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1));
+}
+
+
 Future<WriteResponse> CoordinatorProcess::runWritePhase(const Action& action)
 {
   return log::write(quorum, network, proposal, action);
@@ -378,12 +432,18 @@ Future<Option<uint64_t>> CoordinatorProcess::checkWritePhase(
     CHECK_LE(proposal, response.proposal());
     proposal = response.proposal();
 
+    // This write did not commit, so rewind the next position to
+    // write. Writes further down the pipeline will resolve to none
+    // without committing (see '_write'), so a subsequent write will
+    // retry this position.
+    index = std::min(index, action.position());
+
     return None();
   }
 
   return runLearnPhase(action)
     .then(defer(self(), &Self::checkLearnPhase, action))
-    .then(defer(self(), &Self::updateIndexAfterWritten, lambda::_1));
+    .then(defer(self(), &Self::completeWrite, action, lambda::_1));
 }
 
 
@@ -402,33 +462,53 @@ Future<bool> CoordinatorProcess::checkLearnPhase(const Action& action)
 }
 
 
-Future<Option<uint64_t>> CoordinatorProcess::updateIndexAfterWritten(
+Future<Option<uint64_t>> CoordinatorProcess::completeWrite(
+    const Action& action,
     bool missing)
 {
   CHECK(!missing) << "Not expecting local replica to be missing position "
-                  << index << " after the writing is done";
+                  << action.position() << " after the writing is done";
 
-  return index++;
+  return Option<uint64_t>(action.position());
 }
 
 
 void CoordinatorProcess::writingFinished()
 {
-  CHECK_EQ(state, WRITING);
-  state = ELECTED;
+  // An earlier write in the pipeline may have failed (or been
+  // discarded) and demoted the coordinator already.
+  CHECK(state == WRITING || state == INITIAL);
+
+  CHECK(!writings.empty());
+  writings.pop_front();
+
+  if (writings.empty() && state == WRITING) {
+    state = ELECTED;
+  }
 }
 
 
 void CoordinatorProcess::writingFailed()
 {
-  CHECK_EQ(state, WRITING);
+  // An earlier write in the pipeline may have failed (or been
+  // discarded) and demoted the coordinator already.
+  CHECK(state == WRITING || state == INITIAL);
+
+  CHECK(!writings.empty());
+  writings.pop_front();
+
   state = INITIAL;
 }
 
 
 void CoordinatorProcess::writingAborted()
 {
-  CHECK_EQ(state, WRITING);
+  // An earlier write in the pipeline may have failed (or been
+  // discarded) and demoted the coordinator already.
+  CHECK(state == WRITING || state == INITIAL);
+
+  CHECK(!writings.empty());
+  writings.pop_front();
 
   // Demote the coordinator if a write operation is discarded since we
   // don't actually know the write was successful or not and we really
@@ -60,7 +60,9 @@ public:
 
   // Appends the specified bytes to the end of the log. Returns the
   // position of the appended entry if the operation succeeds or none
-  // if the coordinator was demoted.
+  // if the coordinator was demoted. Multiple writes may be
+  // outstanding at any time (i.e., the write rounds are pipelined);
+  // positions are committed and results are returned in order.
   process::Future<Option<uint64_t>> append(const std::string& bytes);
 
   // Removes all log entries preceding the log entry at the given
@@ -18,13 +18,20 @@
 
 #include <glog/logging.h>
 
+#include <leveldb/cache.h>
 #include <leveldb/comparator.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 
 #include <stdint.h>
 
+#include <list>
+
+#include <process/async.hpp>
+
 #include <stout/check.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
 #include <stout/numify.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
@@ -126,16 +133,107 @@ static string encode(uint64_t position, bool adjust = true)
 // }
 
 
-LevelDBStorage::LevelDBStorage()
-  : db(nullptr), first(None())
+// Key under which a snapshot of the state is stored. Chosen so that
+// it sorts before all the keys produced by 'encode' in the byte-wise
+// ordering ('!' < '0') and therefore does not interfere with the
+// position keys.
+static const char SNAPSHOT_KEY[] = "!snapshot";
+
+
+// Encodes a snapshot of the specified state as a record and adds it
+// to the batch, so that it gets persisted atomically with the rest
+// of the batch.
+static Try<Nothing> snapshot(
+    leveldb::WriteBatch* batch,
+    const Storage::State& state,
+    const Option<uint64_t>& first)
 {
-  // Nothing to see here.
+  Record record;
+  record.set_type(Record::SNAPSHOT);
+
+  Snapshot* snapshot = record.mutable_snapshot();
+  snapshot->set_begin(state.begin);
+  snapshot->set_end(state.end);
+
+  if (first.isSome()) {
+    snapshot->set_first(first.get());
+  }
+
+  foreach (const Interval<uint64_t>& interval, state.learned) {
+    Snapshot::Range* range = snapshot->add_learned();
+    range->set_begin(interval.lower());
+    range->set_end(interval.upper());
+  }
+
+  foreach (const Interval<uint64_t>& interval, state.unlearned) {
+    Snapshot::Range* range = snapshot->add_unlearned();
+    range->set_begin(interval.lower());
+    range->set_end(interval.upper());
+  }
+
+  string value;
+
+  if (!record.SerializeToString(&value)) {
+    return Error("Failed to serialize record");
+  }
+
+  batch->Put(SNAPSHOT_KEY, value);
+
+  return Nothing();
+}
+
+
+// Compacts the specified range of keys in leveldb. Used to reclaim
+// the space occupied by truncated positions: deleting a range of
+// keys leaves tombstones behind which progressively slow down
+// iteration until the range gets compacted. Note that compacting is
+// thread safe and thus can be (and is) performed concurrently with
+// reads and writes to the database.
+static Nothing compact(leveldb::DB* db, const string& begin, const string& end)
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  leveldb::Slice from = begin;
+  leveldb::Slice to = end;
+
+  db->CompactRange(&from, &to);
+
+  VLOG(1) << "Compacting [" << begin << ", " << end << "] "
+          << "in leveldb took " << stopwatch.elapsed();
+
+  return Nothing();
+}
+
+
+LevelDBStorage::LevelDBStorage(
+    size_t _bloomFilterBitsPerKey,
+    const Bytes& _blockCacheSize)
+  : bloomFilterBitsPerKey(_bloomFilterBitsPerKey),
+    blockCacheSize(_blockCacheSize),
+    db(nullptr),
+    filterPolicy(nullptr),
+    blockCache(nullptr),
+    first(None()),
+    compacted(0),
+    compacting(Nothing())
+{
+  state.begin = 0;
+  state.end = 0;
 }
 
 
 LevelDBStorage::~LevelDBStorage()
 {
+  // Wait for any in-progress background compaction since it uses
+  // 'db'.
+  compacting.await();
+
   delete db; // Might be null if open failed in LevelDBStorage::restore.
+
+  // NOTE: Deleted after 'db' since the database references them.
+  delete filterPolicy;
+  delete blockCache;
 }
 
 
@@ -144,6 +242,20 @@ Try<Storage::State> LevelDBStorage::restore(const string& path)
   leveldb::Options options;
   options.create_if_missing = true;
 
+  // Use a bloom filter to avoid the disk reads otherwise needed to
+  // determine that a position is not present.
+  if (bloomFilterBitsPerKey > 0) {
+    filterPolicy = leveldb::NewBloomFilterPolicy(bloomFilterBitsPerKey);
+    options.filter_policy = filterPolicy;
+  }
+
+  // Use a larger than default (8 MB) block cache so that reads of
+  // recently used blocks are served from memory.
+  if (blockCacheSize.bytes() > 0) {
+    blockCache = leveldb::NewLRUCache(blockCacheSize.bytes());
+    options.block_cache = blockCache;
+  }
+
   // TODO(benh): Can't use varint comparator until bug discussed at
   // groups.google.com/group/leveldb/browse_thread/thread/17eac39168909ba7
   // gets fixed. For now, we are using the default byte-wise
@@ -175,15 +287,93 @@ Try<Storage::State> LevelDBStorage::restore(const string& path)
 
   stopwatch.start(); // Restart the stopwatch.
 
+  // First try to restore the state from a snapshot record so that we
+  // don't have to compact and iterate over the entire database,
+  // which dominates the recovery time for large logs.
+  string value;
+
+  status = db->Get(leveldb::ReadOptions(), SNAPSHOT_KEY, &value);
+
+  if (status.ok()) {
+    google::protobuf::io::ArrayInputStream stream(value.data(), value.size());
+
+    Record record;
+
+    if (!record.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize record");
+    }
+
+    if (record.type() != Record::SNAPSHOT) {
+      return Error("Bad record");
+    }
+
+    const Snapshot& snapshot = record.snapshot();
+
+    state.begin = snapshot.begin();
+    state.end = snapshot.end();
+
+    foreach (const Snapshot::Range& range, snapshot.learned()) {
+      state.learned +=
+        (Bound<uint64_t>::closed(range.begin()),
+         Bound<uint64_t>::open(range.end()));
+    }
+
+    foreach (const Snapshot::Range& range, snapshot.unlearned()) {
+      state.unlearned +=
+        (Bound<uint64_t>::closed(range.begin()),
+         Bound<uint64_t>::open(range.end()));
+    }
+
+    if (snapshot.has_first()) {
+      first = snapshot.first();
+    }
+
+    // The metadata is stored under its own key (see 'persist') so
+    // that it is not overwritten by the snapshot.
+    status = db->Get(leveldb::ReadOptions(), encode(0, false), &value);
+
+    if (status.ok()) {
+      google::protobuf::io::ArrayInputStream stream(
+          value.data(), value.size());
+
+      Record record;
+
+      if (!record.ParseFromZeroCopyStream(&stream)) {
+        return Error("Failed to deserialize record");
+      }
+
+      if (record.type() != Record::METADATA) {
+        return Error("Bad record");
+      }
+
+      state.metadata.CopyFrom(record.metadata());
+    } else if (!status.IsNotFound()) {
+      return Error(status.ToString());
+    }
+
+    VLOG(1) << "Restored db state from snapshot in " << stopwatch.elapsed();
+
+    // Note that we deliberately skip the full compaction here: any
+    // tombstones left behind by truncations are compacted in the
+    // background as part of the truncations themselves (see
+    // 'truncate').
+    return state;
+  } else if (!status.IsNotFound()) {
+    return Error(status.ToString());
+  }
+
+  // No snapshot record: either this is a new database or it was
+  // created by a version that did not write snapshots. Fall back to
+  // iterating over all the records; a snapshot will be included with
+  // the next persisted action.
+
+  stopwatch.start(); // Restart the stopwatch.
+
   // TODO(benh): Conditionally compact to avoid long recovery times?
   db->CompactRange(nullptr, nullptr);
 
   VLOG(1) << "Compacted db in " << stopwatch.elapsed();
 
-  State state;
-  state.begin = 0;
-  state.end = 0;
-
   // TODO(benh): Consider just reading the "promise" record (e.g.,
   // 'encode(0, false)') and then iterating over the rest of the
   // records and confirming that they are all indeed of type
@@ -304,101 +494,113 @@ Try<Nothing> LevelDBStorage::persist(const Metadata& metadata)
   VLOG(1) << "Persisting metadata (" << value.size()
           << " bytes) to leveldb took " << stopwatch.elapsed();
 
+  state.metadata.CopyFrom(metadata);
+
   return Nothing();
 }
 
 
 Try<Nothing> LevelDBStorage::persist(const Action& action)
 {
+  return persist(std::list<Action>{action});
+}
+
+
+Try<Nothing> LevelDBStorage::persist(const std::list<Action>& actions)
+{
+  CHECK(!actions.empty());
+
   Stopwatch stopwatch;
   stopwatch.start();
 
-  Record record;
-  record.set_type(Record::ACTION);
-  record.mutable_action()->MergeFrom(action);
+  // Write all the actions in a single batch so that they share the
+  // cost of one synchronous write (i.e., group commit). Note that the
+  // entries of a WriteBatch are applied in order, so if the batch
+  // contains multiple actions for the same position the last one
+  // wins, just as if they had been written individually.
+  leveldb::WriteBatch batch;
 
-  string value;
+  size_t bytes = 0;
 
-  if (!record.SerializeToString(&value)) {
-    return Error("Failed to serialize record");
+  // Compute the state after this batch of actions has been applied
+  // (mirroring the bookkeeping in 'restore') so that an up-to-date
+  // snapshot can be included in the batch itself. The new state is
+  // only committed to 'this->state' once the write has succeeded.
+  State updated = state;
+  Option<uint64_t> first_ = first;
+
+  foreach (const Action& action, actions) {
+    Record record;
+    record.set_type(Record::ACTION);
+    record.mutable_action()->MergeFrom(action);
+
+    string value;
+
+    if (!record.SerializeToString(&value)) {
+      return Error("Failed to serialize record");
+    }
+
+    bytes += value.size();
+
+    batch.Put(encode(action.position()), value);
+
+    if (action.has_learned() && action.learned()) {
+      updated.learned.insert(action.position());
+      updated.unlearned.erase(action.position());
+      if (action.has_type() && action.type() == Action::TRUNCATE) {
+        updated.begin = std::max(updated.begin, action.truncate().to());
+
+        // Truncated positions get deleted from leveldb (see
+        // 'truncate'), so drop them from the snapshot as well to
+        // match what a scan of the records would recover.
+        updated.learned -=
+          (Bound<uint64_t>::closed(0),
+           Bound<uint64_t>::open(action.truncate().to()));
+        updated.unlearned -=
+          (Bound<uint64_t>::closed(0),
+           Bound<uint64_t>::open(action.truncate().to()));
+      }
+    } else {
+      updated.learned.erase(action.position());
+      updated.unlearned.insert(action.position());
+    }
+    updated.end = std::max(updated.end, action.position());
+
+    // Update the first position. Notice that we use 'min' here
+    // instead of checking 'isNone()' because it's likely that log
+    // entries are written out of order during catch-up (e.g. if a
+    // random bulk catch-up policy is used).
+    first_ = min(first_, action.position());
+  }
+
+  Try<Nothing> snapshotted = snapshot(&batch, updated, first_);
+
+  if (snapshotted.isError()) {
+    return Error(snapshotted.error());
   }
 
   leveldb::WriteOptions options;
   options.sync = true;
 
-  leveldb::Status status = db->Put(options, encode(action.position()), value);
+  leveldb::Status status = db->Write(options, &batch);
 
   if (!status.ok()) {
     return Error(status.ToString());
   }
 
-  // Updated the first position. Notice that we use 'min' here instead
-  // of checking 'isNone()' because it's likely that log entries are
-  // written out of order during catch-up (e.g. if a random bulk
-  // catch-up policy is used).
-  first = min(first, action.position());
-
-  VLOG(1) << "Persisting action (" << value.size()
+  VLOG(1) << "Persisting " << actions.size() << " actions (" << bytes
           << " bytes) to leveldb took " << stopwatch.elapsed();
 
-  // Delete positions if a truncate action has been *learned*. Note
-  // that we do this in a best-effort fashion (i.e., we ignore any
-  // failures to the database since we can always try again).
-  if (action.has_type() && action.type() == Action::TRUNCATE &&
-      action.has_learned() && action.learned()) {
-    CHECK(action.has_truncate());
-
-    stopwatch.start(); // Restart the stopwatch.
-
-    // To actually perform the truncation in leveldb we need to remove
-    // all the keys that represent positions no longer in the log. We
-    // do this by attempting to delete all keys that represent the
-    // first position we know is still in leveldb up to (but
-    // excluding) the truncate position. Note that this works because
-    // the semantics of WriteBatch are such that even if the position
-    // doesn't exist (which is possible because this replica has some
-    // holes), we can attempt to delete the key that represents it and
-    // it will just ignore that key. This is *much* cheaper than
-    // actually iterating through the entire database instead (which
-    // was, for posterity, the original implementation). In addition,
-    // caching the "first" position we know is in the database is
-    // cheaper than using an iterator to determine the first position
-    // (which was, for posterity, the second implementation).
-
-    leveldb::WriteBatch batch;
-
-    CHECK_SOME(first);
-
-    // Add positions up to (but excluding) the truncate position to
-    // the batch starting at the first position still in leveldb. It's
-    // likely that the first position is greater than the truncate
-    // position (e.g., during catch-up). In that case, we do nothing
-    // because there is nothing we can truncate.
-    // TODO(jieyu): We might miss a truncation if we do random (i.e.,
-    // out of order) bulk catch-up and the truncate operation is
-    // caught up first.
-    uint64_t index = 0;
-    while ((first.get() + index) < action.truncate().to()) {
-      batch.Delete(encode(first.get() + index));
-      index++;
-    }
+  state = updated;
+  first = first_;
 
-    // If we added any positions, attempt to delete them!
-    if (index > 0) {
-      // We do this write asynchronously (e.g., using default options).
-      leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
-
-      if (!status.ok()) {
-        LOG(WARNING) << "Ignoring leveldb batch delete failure: "
-                     << status.ToString();
-      } else {
-        // Save the new first position!
-        CHECK_LT(first.get(), action.truncate().to());
-        first = action.truncate().to();
-
-        VLOG(1) << "Deleting ~" << index
-                << " keys from leveldb took " << stopwatch.elapsed();
-      }
+  foreach (const Action& action, actions) {
+    // Delete positions if a truncate action has been *learned*. Note
+    // that we do this in a best-effort fashion (i.e., we ignore any
+    // failures to the database since we can always try again).
+    if (action.has_type() && action.type() == Action::TRUNCATE &&
+        action.has_learned() && action.learned()) {
+      truncate(action);
     }
   }
 
@@ -406,6 +608,81 @@ Try<Nothing> LevelDBStorage::persist(const Action& action)
 }
 
 
+void LevelDBStorage::truncate(const Action& action)
+{
+  CHECK(action.has_truncate());
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // To actually perform the truncation in leveldb we need to remove
+  // all the keys that represent positions no longer in the log. We
+  // do this by attempting to delete all keys that represent the
+  // first position we know is still in leveldb up to (but
+  // excluding) the truncate position. Note that this works because
+  // the semantics of WriteBatch are such that even if the position
+  // doesn't exist (which is possible because this replica has some
+  // holes), we can attempt to delete the key that represents it and
+  // it will just ignore that key. This is *much* cheaper than
+  // actually iterating through the entire database instead (which
+  // was, for posterity, the original implementation). In addition,
+  // caching the "first" position we know is in the database is
+  // cheaper than using an iterator to determine the first position
+  // (which was, for posterity, the second implementation).
+
+  leveldb::WriteBatch batch;
+
+  CHECK_SOME(first);
+
+  // Add positions up to (but excluding) the truncate position to
+  // the batch starting at the first position still in leveldb. It's
+  // likely that the first position is greater than the truncate
+  // position (e.g., during catch-up). In that case, we do nothing
+  // because there is nothing we can truncate.
+  // TODO(jieyu): We might miss a truncation if we do random (i.e.,
+  // out of order) bulk catch-up and the truncate operation is
+  // caught up first.
+  uint64_t index = 0;
+  while ((first.get() + index) < action.truncate().to()) {
+    batch.Delete(encode(first.get() + index));
+    index++;
+  }
+
+  // If we added any positions, attempt to delete them!
+  if (index > 0) {
+    // We do this write asynchronously (e.g., using default options).
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+
+    if (!status.ok()) {
+      LOG(WARNING) << "Ignoring leveldb batch delete failure: "
+                   << status.ToString();
+    } else {
+      // Save the new first position!
+      CHECK_LT(first.get(), action.truncate().to());
+      first = action.truncate().to();
+
+      VLOG(1) << "Deleting ~" << index
+              << " keys from leveldb took " << stopwatch.elapsed();
+
+      // Compact the range we just deleted in the background so that
+      // the tombstones do not accumulate (accumulated tombstones
+      // progressively slow down iteration and eventually force a
+      // full compaction that can stall the replica). If a compaction
+      // is still running we simply defer: the skipped range will be
+      // covered by the compaction scheduled at a later truncation
+      // since we keep track of where the last one ended.
+      if (!compacting.isPending()) {
+        uint64_t from = compacted;
+        compacted = action.truncate().to();
+
+        compacting = process::async(
+            &compact, db, encode(from), encode(compacted));
+      }
+    }
+  }
+}
+
+
 Try<Action> LevelDBStorage::read(uint64_t position)
 {
   Stopwatch stopwatch;
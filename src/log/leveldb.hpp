@@ -21,6 +21,11 @@
 
 #include <stdint.h>
 
+#include <list>
+
+#include <process/future.hpp>
+
+#include <stout/bytes.hpp>
 #include <stout/option.hpp>
 
 #include "log/storage.hpp"
@@ -33,19 +38,51 @@ namespace log {
 class LevelDBStorage : public Storage
 {
 public:
-  LevelDBStorage();
+  // By default the database is opened with a bloom filter (which
+  // avoids disk reads for positions that are not present) and a
+  // block cache (which serves reads of recently used blocks from
+  // memory). Either can be disabled by passing 0.
+  explicit LevelDBStorage(
+      size_t bloomFilterBitsPerKey = 10,
+      const Bytes& blockCacheSize = Megabytes(64));
+
   virtual ~LevelDBStorage();
 
   virtual Try<State> restore(const std::string& path);
   virtual Try<Nothing> persist(const Metadata& metadata);
   virtual Try<Nothing> persist(const Action& action);
+  virtual Try<Nothing> persist(const std::list<Action>& actions);
   virtual Try<Action> read(uint64_t position);
 
 private:
+  // Deletes positions that are no longer in the log due to the
+  // specified *learned* truncate action.
+  void truncate(const Action& action);
+
+  const size_t bloomFilterBitsPerKey;
+  const Bytes blockCacheSize;
+
   leveldb::DB* db;
 
+  // Referenced by 'db' and hence must outlive it.
+  const leveldb::FilterPolicy* filterPolicy;
+  leveldb::Cache* blockCache;
+
   // First position still in leveldb, used during truncation.
   Option<uint64_t> first;
+
+  // In-memory copy of the state stored in leveldb. Kept up to date
+  // so that an up-to-date snapshot record can be included in every
+  // write batch, which allows 'restore' to avoid iterating over all
+  // the records in the database.
+  State state;
+
+  // Upper bound (exclusive) of the positions that have already been
+  // handed to a background compaction (see 'truncate').
+  uint64_t compacted;
+
+  // The currently running background compaction, if any.
+  process::Future<Nothing> compacting;
 };
 
 } // namespace log {
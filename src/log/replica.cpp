@@ -17,6 +17,8 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <list>
+#include <utility>
 
 #include <mesos/type_utils.hpp>
 
@@ -27,6 +29,7 @@
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/result.hpp>
@@ -52,6 +55,7 @@ namespace protocol {
 Protocol<PromiseRequest, PromiseResponse> promise;
 Protocol<WriteRequest, WriteResponse> write;
 Protocol<RecoverRequest, RecoverResponse> recover;
+Protocol<BulkReadRequest, BulkReadResponse> bulkread;
 
 } // namespace protocol {
 
@@ -112,12 +116,50 @@ private:
   // Handles a request from a recover process.
   void recover(const UPID& from, const RecoverRequest& request);
 
+  // Handles a request to read the learned actions in a range in
+  // bulk (e.g., from a catching-up replica).
+  void bulkread(const UPID& from, const BulkReadRequest& request);
+
   // Handles a message notifying of a learned action.
   void learned(const UPID& from, const Action& action);
 
-  // Persists the specified action to storage. Returns true on success
-  // and false otherwise.
-  bool persist(const Action& action);
+  // An action buffered for the next storage flush, along with the
+  // response (if any) to send back once the action has been synced
+  // to disk.
+  struct Pending
+  {
+    Action action;
+    Option<UPID> from;
+    Option<PromiseResponse> promiseResponse;
+    Option<WriteResponse> writeResponse;
+  };
+
+  // Buffers the specified action to be persisted to storage. The
+  // overloads taking a response will send it to 'from' once the
+  // action has been synced to disk. Actions buffered while a flush
+  // is pending are persisted in a single synchronous write (i.e.,
+  // group commit) and acknowledged together, so concurrent requests
+  // share the cost of one disk sync.
+  void persist(const Action& action);
+
+  void persist(
+      const Action& action,
+      const UPID& from,
+      const PromiseResponse& response);
+
+  void persist(
+      const Action& action,
+      const UPID& from,
+      const WriteResponse& response);
+
+  // Buffers the pending action, applies the in-memory bookkeeping
+  // (so that requests handled before the flush observe the action)
+  // and schedules a flush if one is not already on its way.
+  void _persist(Pending&& pending_);
+
+  // Writes all the buffered actions to storage in a single batch and
+  // sends the buffered responses.
+  void flush();
 
   // Updates the highest promise this replica has given. The update
   // will be persisted to storage. Returns true on success and false
@@ -145,13 +187,28 @@ private:
 
   // Unlearned positions in the log.
   IntervalSet<uint64_t> unlearned;
+
+  // Actions buffered for the next storage flush, along with the
+  // responses to send once they have been synced to disk.
+  std::list<Pending> pending;
+
+  // The buffered actions by position, consulted by 'read' so that
+  // requests handled before the flush observe the actions already
+  // accepted (but not yet synced) in this window. If multiple
+  // actions are buffered for the same position the last one is kept,
+  // matching the order in which they will be applied by storage.
+  hashmap<uint64_t, Action> buffered;
+
+  // Whether a flush has been dispatched but has not yet run.
+  bool flushing;
 };
 
 
 ReplicaProcess::ReplicaProcess(const string& path)
   : ProcessBase(ID::generate("log-replica")),
     begin(0),
-    end(0)
+    end(0),
+    flushing(false)
 {
   // TODO(benh): Factor out and expose storage.
   storage = new LevelDBStorage();
@@ -168,6 +225,9 @@ ReplicaProcess::ReplicaProcess(const string& path)
   install<RecoverRequest>(
       &ReplicaProcess::recover);
 
+  install<BulkReadRequest>(
+      &ReplicaProcess::bulkread);
+
   install<LearnedMessage>(
       &ReplicaProcess::learned,
       &LearnedMessage::action);
@@ -190,6 +250,13 @@ Result<Action> ReplicaProcess::read(uint64_t position)
     return None();
   }
 
+  // The action may still be buffered (i.e., accepted but not yet
+  // synced to disk).
+  Option<Action> buffered_ = buffered.get(position);
+  if (buffered_.isSome()) {
+    return buffered_.get();
+  }
+
   // Must exist in storage ...
   Try<Action> action = storage->read(position);
 
@@ -455,14 +522,13 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
         action.set_position(request.position());
         action.set_promised(request.proposal());
 
-        if (persist(action)) {
-          PromiseResponse response;
-          response.set_type(PromiseResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.set_position(request.position());
-          reply(response);
-        }
+        PromiseResponse response;
+        response.set_type(PromiseResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.set_position(request.position());
+
+        persist(action, from, response);
       }
     } else {
       CHECK_SOME(result);
@@ -479,14 +545,13 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
         Action original = action;
         action.set_promised(request.proposal());
 
-        if (persist(action)) {
-          PromiseResponse response;
-          response.set_type(PromiseResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.mutable_action()->MergeFrom(original);
-          reply(response);
-        }
+        PromiseResponse response;
+        response.set_type(PromiseResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.mutable_action()->MergeFrom(original);
+
+        persist(action, from, response);
       }
     }
   } else {
@@ -575,14 +640,13 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
           LOG(FATAL) << "Unknown Action::Type!";
       }
 
-      if (persist(action)) {
-        WriteResponse response;
-        response.set_type(WriteResponse::ACCEPT);
-        response.set_okay(true);
-        response.set_proposal(request.proposal());
-        response.set_position(request.position());
-        reply(response);
-      }
+      WriteResponse response;
+      response.set_type(WriteResponse::ACCEPT);
+      response.set_okay(true);
+      response.set_proposal(request.proposal());
+      response.set_position(request.position());
+
+      persist(action, from, response);
     }
   } else if (result.isSome()) {
     Action action = result.get();
@@ -654,14 +718,13 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
             LOG(FATAL) << "Unknown Action::Type!";
         }
 
-        if (persist(action)) {
-          WriteResponse response;
-          response.set_type(WriteResponse::ACCEPT);
-          response.set_okay(true);
-          response.set_proposal(request.proposal());
-          response.set_position(request.position());
-          reply(response);
-        }
+        WriteResponse response;
+        response.set_type(WriteResponse::ACCEPT);
+        response.set_okay(true);
+        response.set_proposal(request.proposal());
+        response.set_position(request.position());
+
+        persist(action, from, response);
       }
     }
   }
@@ -686,6 +749,33 @@ void ReplicaProcess::recover(const UPID& from, const RecoverRequest& request)
 }
 
 
+void ReplicaProcess::bulkread(const UPID& from, const BulkReadRequest& request)
+{
+  VLOG(1) << "Replica received bulk read request for positions "
+          << request.from() << " -> " << request.to() << " from " << from;
+
+  BulkReadResponse response;
+
+  for (uint64_t position = request.from();
+       position <= request.to();
+       position++) {
+    Result<Action> result = read(position);
+
+    // Only learned actions can be copied directly by the requester
+    // since they have already reached consensus. Truncated or
+    // unlearned positions (and read errors) are simply omitted; the
+    // requester will catch them up through the regular protocol.
+    if (result.isSome() &&
+        result->has_learned() &&
+        result->learned()) {
+      response.add_actions()->CopyFrom(result.get());
+    }
+  }
+
+  reply(response);
+}
+
+
 void ReplicaProcess::learned(const UPID& from, const Action& action)
 {
   LOG(INFO) << "Replica received learned notice for position "
@@ -696,18 +786,52 @@ void ReplicaProcess::learned(const UPID& from, const Action& action)
 }
 
 
-bool ReplicaProcess::persist(const Action& action)
+void ReplicaProcess::persist(const Action& action)
 {
-  Try<Nothing> persisted = storage->persist(action);
+  Pending pending_;
+  pending_.action = action;
 
-  if (persisted.isError()) {
-    LOG(ERROR) << "Error writing to log: " << persisted.error();
-    return false;
-  }
+  _persist(std::move(pending_));
+}
+
+
+void ReplicaProcess::persist(
+    const Action& action,
+    const UPID& from,
+    const PromiseResponse& response)
+{
+  Pending pending_;
+  pending_.action = action;
+  pending_.from = from;
+  pending_.promiseResponse = response;
+
+  _persist(std::move(pending_));
+}
+
+
+void ReplicaProcess::persist(
+    const Action& action,
+    const UPID& from,
+    const WriteResponse& response)
+{
+  Pending pending_;
+  pending_.action = action;
+  pending_.from = from;
+  pending_.writeResponse = response;
+
+  _persist(std::move(pending_));
+}
+
+
+void ReplicaProcess::_persist(Pending&& pending_)
+{
+  const Action& action = pending_.action;
 
-  VLOG(1) << "Persisted action " << action.type()
+  VLOG(1) << "Buffered action " << action.type()
           << " at position " << action.position();
 
+  buffered[action.position()] = action;
+
   // No longer a hole here (if there even was one).
   holes -= action.position();
 
@@ -743,7 +867,55 @@ bool ReplicaProcess::persist(const Action& action)
   // And update the end position.
   end = std::max(end, action.position());
 
-  return true;
+  pending.push_back(std::move(pending_));
+
+  // Schedule a flush if one is not already on its way. Any requests
+  // that are already enqueued behind the current one will be handled
+  // (and their actions buffered) before the flush runs, so concurrent
+  // requests within this window share a single synchronous write.
+  if (!flushing) {
+    flushing = true;
+    dispatch(self(), &ReplicaProcess::flush);
+  }
+}
+
+
+void ReplicaProcess::flush()
+{
+  flushing = false;
+
+  CHECK(!pending.empty());
+
+  std::list<Action> actions;
+  foreach (const Pending& pending_, pending) {
+    actions.push_back(pending_.action);
+  }
+
+  Try<Nothing> persisted = storage->persist(actions);
+
+  if (persisted.isError()) {
+    // Keep the actions (and their responses) buffered so that they
+    // are written as part of the next flush. Not sending the
+    // responses means the requests are effectively ignored; the
+    // proposers will time out and retry.
+    LOG(ERROR) << "Error writing to log: " << persisted.error();
+    return;
+  }
+
+  VLOG(1) << "Persisted " << actions.size() << " actions";
+
+  // Now that the actions have been synced to disk, send the
+  // responses.
+  foreach (const Pending& pending_, pending) {
+    if (pending_.promiseResponse.isSome()) {
+      send(pending_.from.get(), pending_.promiseResponse.get());
+    } else if (pending_.writeResponse.isSome()) {
+      send(pending_.from.get(), pending_.writeResponse.get());
+    }
+  }
+
+  pending.clear();
+  buffered.clear();
 }
 
 
@@ -40,6 +40,7 @@ namespace protocol {
 extern Protocol<PromiseRequest, PromiseResponse> promise;
 extern Protocol<WriteRequest, WriteResponse> write;
 extern Protocol<RecoverRequest, RecoverResponse> recover;
+extern Protocol<BulkReadRequest, BulkReadResponse> bulkread;
 
 } // namespace protocol {
 
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 
+#include <list>
 #include <string>
 
 #include <stout/interval.hpp>
@@ -53,6 +54,12 @@ public:
   virtual Try<State> restore(const std::string& path) = 0;
   virtual Try<Nothing> persist(const Metadata& metadata) = 0;
   virtual Try<Nothing> persist(const Action& action) = 0;
+
+  // Persists all the specified actions in a single synchronous write
+  // (i.e., group commit) so that concurrent actions share the cost of
+  // one disk sync instead of paying for a sync each.
+  virtual Try<Nothing> persist(const std::list<Action>& actions) = 0;
+
   virtual Try<Action> read(uint64_t position) = 0;
 };
 
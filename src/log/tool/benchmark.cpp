@@ -17,8 +17,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <list>
 #include <sstream>
 
 #include <mesos/log/log.hpp>
@@ -78,11 +80,35 @@ Benchmark::Flags::Flags()
   add(&Flags::input,
       "input",
       "Path to the input trace file. Each line in the trace file\n"
-      "specifies the size of the append (e.g. 100B, 2MB, etc.)");
+      "specifies the size of the append (e.g. 100B, 2MB, etc.)\n"
+      "Cannot be used together with --appends");
 
   add(&Flags::output,
       "output",
-      "Path to the output file");
+      "Path to the output file for per-append latencies. If not\n"
+      "specified, only the summary statistics are reported");
+
+  add(&Flags::appends,
+      "appends",
+      "Number of appends to perform using a synthetic workload of\n"
+      "--size sized entries. Cannot be used together with --input");
+
+  add(&Flags::size,
+      "size",
+      "Size of each append in the synthetic workload (e.g. 100B, 2MB)",
+      Kilobytes(1));
+
+  add(&Flags::truncate_interval,
+      "truncate_interval",
+      "If specified, truncate the log every given number of appends,\n"
+      "keeping a window of that many entries (this is the write\n"
+      "pattern of the registrar)");
+
+  add(&Flags::catchup,
+      "catchup",
+      "Whether to read the log back through a reader after the write\n"
+      "workload, as the registrar does on recovery",
+      false);
 
   add(&Flags::type,
       "type",
@@ -105,10 +131,14 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
       "Usage: " + name() + " [options]\n"
       "\n"
       "This command is used to do performance test on the\n"
-      "replicated log. It takes a trace file of write sizes\n"
-      "and replay that trace to measure the latency of each\n"
-      "write. The data to be written for each write can be\n"
-      "specified using the --type flag.\n"
+      "replicated log. It replays a write workload, either a\n"
+      "trace file of write sizes (--input) or a synthetic\n"
+      "workload (--appends and --size), and reports the append\n"
+      "throughput and latency percentiles. The log can be\n"
+      "truncated periodically during the workload\n"
+      "(--truncate_interval) and read back afterwards\n"
+      "(--catchup). The data to be written for each write can\n"
+      "be specified using the --type flag.\n"
       "\n");
 
   // Configure the tool by parsing command line arguments.
@@ -147,12 +177,12 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
     return Error(flags.usage("Missing required option --znode"));
   }
 
-  if (flags.input.isNone()) {
-    return Error(flags.usage("Missing required option --input"));
+  if (flags.input.isNone() && flags.appends.isNone()) {
+    return Error(flags.usage("Expecting either --input or --appends"));
   }
 
-  if (flags.output.isNone()) {
-    return Error(flags.usage("Missing required option --output"));
+  if (flags.input.isSome() && flags.appends.isSome()) {
+    return Error(flags.usage("Only one of --input and --appends can be used"));
   }
 
   // Initialize the log.
@@ -191,25 +221,35 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
   // Statistics to output.
   vector<Bytes> sizes;
   vector<Duration> durations;
+  vector<Duration> truncations;
   vector<Time> timestamps;
 
-  // Read sizes from the input trace file.
-  ifstream input(flags.input.get().c_str());
-  if (!input.is_open()) {
-    return Error("Failed to open the trace file " + flags.input.get());
-  }
+  if (flags.input.isSome()) {
+    // Read sizes from the input trace file.
+    ifstream input(flags.input.get().c_str());
+    if (!input.is_open()) {
+      return Error("Failed to open the trace file " + flags.input.get());
+    }
 
-  string line;
-  while (getline(input, line)) {
-    Try<Bytes> size = Bytes::parse(strings::trim(line));
-    if (size.isError()) {
-      return Error("Failed to parse the trace file: " + size.error());
+    string line;
+    while (getline(input, line)) {
+      Try<Bytes> size = Bytes::parse(strings::trim(line));
+      if (size.isError()) {
+        return Error("Failed to parse the trace file: " + size.error());
+      }
+
+      sizes.push_back(size.get());
     }
 
-    sizes.push_back(size.get());
+    input.close();
+  } else {
+    // Generate a synthetic workload of fixed size appends.
+    sizes = vector<Bytes>(flags.appends.get(), flags.size);
   }
 
-  input.close();
+  if (sizes.empty()) {
+    return Error("No appends to perform");
+  }
 
   // Generate the data to be written.
   vector<string> data;
@@ -223,8 +263,13 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
     }
   }
 
-  Stopwatch stopwatch;
-  stopwatch.start();
+  // Positions of all the appends performed so far, used to pick the
+  // position to truncate to.
+  vector<Log::Position> positions;
+  positions.reserve(sizes.size());
+
+  Stopwatch total;
+  total.start();
 
   for (size_t i = 0; i < sizes.size(); i++) {
     Stopwatch stopwatch;
@@ -245,21 +290,119 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
 
     durations.push_back(stopwatch.elapsed());
     timestamps.push_back(Clock::now());
+
+    positions.push_back(position.get().get());
+
+    // Periodically truncate the log, keeping a window of the last
+    // `truncate_interval` entries.
+    if (flags.truncate_interval.isSome() &&
+        positions.size() % flags.truncate_interval.get() == 0 &&
+        positions.size() > flags.truncate_interval.get()) {
+      const Log::Position& to =
+        positions[positions.size() - flags.truncate_interval.get()];
+
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      position = writer.truncate(to);
+
+      if (!position.await(Seconds(10))) {
+        return Error("Failed to truncate: timed out");
+      } else if (!position.isReady()) {
+        return Error("Failed to truncate: " +
+                     (position.isFailed()
+                      ? position.failure()
+                      : "Discarded future"));
+      } else if (position.get().isNone()) {
+        return Error("Failed to truncate: exclusive write promise lost");
+      }
+
+      truncations.push_back(stopwatch.elapsed());
+    }
   }
 
+  total.stop();
+
+  // Report throughput and latency percentiles.
+  vector<Duration> sorted = durations;
+  std::sort(sorted.begin(), sorted.end());
+
+  auto percentile = [&sorted](double p) {
+    return sorted[std::min(
+        sorted.size() - 1,
+        static_cast<size_t>(p * sorted.size()))];
+  };
+
   cout << "Total number of appends: " << sizes.size() << endl;
-  cout << "Total time used: " << stopwatch.elapsed() << endl;
+  cout << "Total time used: " << total.elapsed() << endl;
+  cout << "Appends per second: "
+       << sizes.size() / total.elapsed().secs() << endl;
+  cout << "Append latency:"
+       << " min " << sorted.front()
+       << " / p50 " << percentile(0.50)
+       << " / p90 " << percentile(0.90)
+       << " / p99 " << percentile(0.99)
+       << " / max " << sorted.back() << endl;
+
+  if (!truncations.empty()) {
+    sorted = truncations;
+    std::sort(sorted.begin(), sorted.end());
+
+    cout << "Total number of truncates: " << truncations.size() << endl;
+    cout << "Truncate latency:"
+         << " min " << sorted.front()
+         << " / p50 " << percentile(0.50)
+         << " / p99 " << percentile(0.99)
+         << " / max " << sorted.back() << endl;
+  }
 
-  // Ouput statistics.
-  ofstream output(flags.output.get().c_str());
-  if (!output.is_open()) {
-    return Error("Failed to open the output file " + flags.output.get());
+  // Read the log back, as the registrar does when it recovers.
+  if (flags.catchup) {
+    Log::Reader reader(&log);
+
+    Future<Log::Position> beginning = reader.beginning();
+    Future<Log::Position> ending = reader.ending();
+
+    if (!beginning.await(Seconds(15)) || !beginning.isReady() ||
+        !ending.await(Seconds(15)) || !ending.isReady()) {
+      return Error("Failed to determine the beginning or ending of the log");
+    }
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    Future<std::list<Log::Entry>> entries =
+      reader.read(beginning.get(), ending.get());
+
+    if (!entries.await(Minutes(5))) {
+      return Error("Failed to read the log: timed out");
+    } else if (!entries.isReady()) {
+      return Error("Failed to read the log: " +
+                   (entries.isFailed()
+                    ? entries.failure()
+                    : "Discarded future"));
+    }
+
+    stopwatch.stop();
+
+    cout << "Caught up " << entries.get().size() << " entries in "
+         << stopwatch.elapsed() << " ("
+         << entries.get().size() / stopwatch.elapsed().secs()
+         << " entries/sec)" << endl;
   }
 
-  for (size_t i = 0; i < sizes.size(); i++) {
-    output << timestamps[i]
-           << " Appended " << sizes[i].bytes() << " bytes"
-           << " in " << durations[i].ms() << " ms" << endl;
+  // Output per append statistics.
+  if (flags.output.isSome()) {
+    ofstream output(flags.output.get().c_str());
+    if (!output.is_open()) {
+      return Error("Failed to open the output file " + flags.output.get());
+    }
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+      output << timestamps[i]
+             << " Appended " << sizes[i].bytes() << " bytes"
+             << " in " << durations[i].ms() << " ms" << endl;
+    }
   }
 
   return Nothing();
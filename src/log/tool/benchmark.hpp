@@ -17,6 +17,7 @@
 #ifndef __LOG_TOOL_BENCHMARK_HPP__
 #define __LOG_TOOL_BENCHMARK_HPP__
 
+#include <stout/bytes.hpp>
 #include <stout/flags.hpp>
 #include <stout/option.hpp>
 
@@ -43,6 +44,10 @@ public:
     Option<std::string> znode;
     Option<std::string> input;
     Option<std::string> output;
+    Option<size_t> appends;
+    Bytes size;
+    Option<size_t> truncate_interval;
+    bool catchup;
     std::string type;
     bool initialize;
     bool help;
@@ -46,6 +46,19 @@ mesos::internal::logging::Flags::Flags()
       "By default, logs are flushed immediately.",
       0);
 
+  add(&Flags::async_logging,
+      "async_logging",
+      "Whether to write log messages to `--log_dir` from a dedicated\n"
+      "background thread instead of synchronously from the thread that\n"
+      "logs. This keeps slow disks from stalling the processing threads,\n"
+      "at the cost of losing the most recently buffered messages (other\n"
+      "than the `FATAL` one, which is always written synchronously) if\n"
+      "the process dies abruptly. If the buffer fills up, messages are\n"
+      "dropped and the number of dropped messages is logged.\n"
+      "Has no effect unless `--log_dir` is specified.\n"
+      "By default, this option is false.",
+      false);
+
   add(&Flags::initialize_driver_logging,
       "initialize_driver_logging",
       "Whether the master/agent should initialize Google logging for the\n"
@@ -20,10 +20,14 @@
 #include <glog/logging.h>
 #include <glog/raw_logging.h>
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <process/once.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
 #include <stout/os.hpp>
@@ -76,6 +80,148 @@ namespace logging {
 string argv0;
 
 
+// Number of log messages that may be buffered by an `AsyncLogger`
+// before messages get dropped.
+static const size_t ASYNC_LOG_CAPACITY = 8192;
+
+
+// A glog `Logger` that buffers messages in a fixed size ring buffer
+// drained by a dedicated writer thread, so that the threads doing the
+// logging never block on disk I/O. Enqueueing is lock free; when the
+// buffer is full messages are dropped and the drop count is written
+// to the log once the writer thread catches up.
+//
+// NOTE: Messages buffered here are lost if the process dies abruptly.
+// The `FATAL` severity is therefore never wrapped (see `initialize()`
+// below) so that the message causing an abort always hits its own log
+// file, but the copies glog writes to the lower severity files may be
+// lost.
+class AsyncLogger : public google::base::Logger
+{
+public:
+  explicit AsyncLogger(google::base::Logger* _wrapped)
+    : wrapped(_wrapped),
+      entries(ASYNC_LOG_CAPACITY),
+      head(0),
+      tail(0),
+      dropped(0),
+      terminating(false),
+      thread(&AsyncLogger::run, this) {}
+
+  // NOTE: Never runs in practice since the logger is installed for
+  // the lifetime of the process.
+  virtual ~AsyncLogger()
+  {
+    terminating.store(true, std::memory_order_release);
+    thread.join();
+  }
+
+  virtual void Write(
+      bool force_flush,
+      time_t timestamp,
+      const char* message,
+      int length)
+  {
+    // NOTE: glog serializes calls to `Write()` through its own mutex,
+    // so there is a single producer and the unsynchronized write to
+    // the entry below is safe: the slot is not visible to the writer
+    // thread until `head` is advanced.
+    size_t next = head.load(std::memory_order_relaxed);
+
+    if (next - tail.load(std::memory_order_acquire) >= entries.size()) {
+      // The buffer is full: drop the message rather than block.
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    Entry& entry = entries[next % entries.size()];
+    entry.flush = force_flush;
+    entry.timestamp = timestamp;
+    entry.message.assign(message, length);
+
+    head.store(next + 1, std::memory_order_release);
+  }
+
+  // Blocks until the messages enqueued so far have been written, then
+  // flushes the underlying logger. This is only called from glog's
+  // periodic flushing and from explicit `FlushLogFiles()` calls, so
+  // blocking here does not stall the threads doing the logging.
+  virtual void Flush()
+  {
+    const size_t mark = head.load(std::memory_order_acquire);
+
+    while (tail.load(std::memory_order_acquire) < mark) {
+      os::sleep(Milliseconds(1));
+    }
+
+    wrapped->Flush();
+  }
+
+  virtual google::uint32 LogSize()
+  {
+    return wrapped->LogSize();
+  }
+
+private:
+  struct Entry
+  {
+    bool flush;
+    time_t timestamp;
+    std::string message;
+  };
+
+  void run()
+  {
+    while (true) {
+      size_t next = tail.load(std::memory_order_relaxed);
+
+      if (next == head.load(std::memory_order_acquire)) {
+        // Report messages dropped while the buffer was full now that
+        // the buffer is empty, i.e., once the report cannot displace
+        // a queued message.
+        size_t count = dropped.exchange(0, std::memory_order_relaxed);
+
+        if (count > 0) {
+          const string message =
+            "Dropped " + stringify(count) + " log messages because the"
+            " asynchronous logging buffer was full\n";
+
+          wrapped->Write(true, ::time(nullptr), message.data(), message.size());
+        }
+
+        if (terminating.load(std::memory_order_acquire)) {
+          return;
+        }
+
+        os::sleep(Milliseconds(10));
+        continue;
+      }
+
+      Entry& entry = entries[next % entries.size()];
+
+      wrapped->Write(
+          entry.flush,
+          entry.timestamp,
+          entry.message.data(),
+          entry.message.size());
+
+      tail.store(next + 1, std::memory_order_release);
+    }
+  }
+
+  // The wrapped logger is glog's own file logger, which glog
+  // continues to own; we must not delete it.
+  google::base::Logger* wrapped;
+
+  std::vector<Entry> entries;
+  std::atomic<size_t> head; // Next slot to fill; advanced by producers.
+  std::atomic<size_t> tail; // Next slot to drain; advanced by `run()`.
+  std::atomic<size_t> dropped;
+  std::atomic<bool> terminating;
+  std::thread thread;
+};
+
+
 // NOTE: We use RAW_LOG instead of LOG because RAW_LOG doesn't
 // allocate any memory or grab locks. And according to
 // https://code.google.com/p/google-glog/issues/detail?id=161
@@ -194,6 +340,21 @@ void initialize(
     LOG_AT_LEVEL(FLAGS_minloglevel)
       << google::GetLogSeverityName(FLAGS_minloglevel)
       << " level logging started!";
+
+    if (flags.async_logging) {
+      // Wrap the file loggers for INFO, WARNING and ERROR so that
+      // writes to `--log_dir` happen from a dedicated thread. FATAL
+      // is deliberately left synchronous since glog aborts right
+      // after writing it. Note that writing to stderr does not go
+      // through the loggers and is unaffected.
+      //
+      // NOTE: The `AsyncLogger`s are deliberately leaked; they (and
+      // their writer threads) live for the remainder of the process.
+      for (int severity = google::INFO; severity < google::FATAL; severity++) {
+        google::base::SetLogger(
+            severity, new AsyncLogger(google::base::GetLogger(severity)));
+      }
+    }
   }
 
   VLOG(1) << "Logging to " <<
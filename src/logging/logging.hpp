@@ -17,10 +17,16 @@
 #ifndef __LOGGING_LOGGING_HPP__
 #define __LOGGING_LOGGING_HPP__
 
+#include <atomic>
 #include <string>
 
 #include <glog/logging.h> // Includes LOG(*), PLOG(*), CHECK, etc.
 
+#include <process/clock.hpp>
+#include <process/time.hpp>
+
+#include <stout/duration.hpp>
+
 #include "logging/flags.hpp"
 
 namespace mesos {
@@ -41,6 +47,58 @@ Try<std::string> getLogFile(google::LogSeverity severity);
 // Returns the provided logging level as a LogSeverity type.
 google::LogSeverity getLogSeverity(const std::string& logging_level);
 
+
+// A time based throttle for logging on hot paths: permits at most one
+// log line per interval per instance and counts how many were
+// suppressed in between. Typical usage, with one function local
+// static instance per logging statement:
+//
+//   static logging::Throttle throttle(Seconds(1));
+//
+//   if (throttle.permit()) {
+//     LOG(INFO) << "..." << " (" << throttle.suppressed()
+//               << " similar messages suppressed)";
+//   } else {
+//     VLOG(1) << "...";
+//   }
+class Throttle
+{
+public:
+  explicit Throttle(const Duration& _interval)
+    : interval(_interval.ns()), last(0), count(0), suppressed_(0) {}
+
+  // Returns whether a log line is permitted, i.e., at least the
+  // interval has passed since the last permitted one. Thread safe:
+  // when multiple threads race, exactly one of them is permitted.
+  bool permit()
+  {
+    const int64_t now = process::Clock::now().duration().ns();
+
+    int64_t then = last.load(std::memory_order_relaxed);
+
+    if (now - then >= interval && last.compare_exchange_strong(then, now)) {
+      suppressed_ = count.exchange(0, std::memory_order_relaxed);
+      return true;
+    }
+
+    count.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Number of calls to `permit()` suppressed before the last
+  // permitted one. Only meaningful on the thread to which that
+  // `permit()` call returned true, i.e., within the permitted log
+  // statement.
+  size_t suppressed() const { return suppressed_; }
+
+private:
+  const int64_t interval; // In nanoseconds.
+
+  std::atomic<int64_t> last; // Time of the last permitted line.
+  std::atomic<size_t> count; // Suppressed since the last permitted line.
+  size_t suppressed_;
+};
+
 } // namespace logging {
 } // namespace internal {
 } // namespace mesos {
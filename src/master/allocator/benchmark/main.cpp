@@ -0,0 +1,376 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <mesos/allocator/allocator.hpp>
+
+#include <process/clock.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/flags.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/none.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/try.hpp>
+
+#include "master/constants.hpp"
+
+#include "master/allocator/mesos/hierarchical.hpp"
+
+using namespace mesos;
+
+using mesos::allocator::Allocator;
+
+using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+
+using process::Clock;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+
+// This is a standalone driver for the hierarchical allocator. It
+// constructs a synthetic cluster (agent count, resource shapes,
+// framework mix and filter churn are configurable), drives a number
+// of allocation cycles against it, and reports per-cycle latency
+// percentiles along with the overall allocation rate. Unlike the
+// BENCHMARK tests in src/tests, this runs against the allocator
+// directly without any gtest/gmock overhead, which makes the numbers
+// comparable across runs and suitable for regression tracking.
+class Flags : public virtual flags::FlagsBase
+{
+public:
+  Flags()
+  {
+    add(&Flags::agents,
+        "agents",
+        "Number of agents in the synthetic cluster",
+        1000u);
+
+    add(&Flags::frameworks,
+        "frameworks",
+        "Number of frameworks in the synthetic cluster",
+        200u);
+
+    add(&Flags::roles,
+        "roles",
+        "Number of roles the frameworks are spread over.\n"
+        "With a single role all frameworks use the default role '*'",
+        1u);
+
+    add(&Flags::agent_resources,
+        "agent_resources",
+        "Resources on each agent",
+        "cpus:24;mem:4096;disk:4096;ports:[31000-32000]");
+
+    add(&Flags::used_resources,
+        "used_resources",
+        "Resources on each agent that are already allocated when the\n"
+        "agent is added, assigned to the frameworks in a round-robin\n"
+        "fashion. If unset, agents are added with no used resources");
+
+    add(&Flags::decline_fraction,
+        "decline_fraction",
+        "Fraction of the offers made in each cycle that are declined\n"
+        "with a filter; the remainder stays allocated. Declining\n"
+        "everything keeps the cluster in a steady state of filter\n"
+        "churn",
+        1.0);
+
+    add(&Flags::refuse_seconds,
+        "refuse_seconds",
+        "Filter timeout, in seconds, used when declining offers",
+        5.0);
+
+    add(&Flags::rounds,
+        "rounds",
+        "Number of allocation cycles to drive",
+        100u);
+
+    add(&Flags::allocation_interval,
+        "allocation_interval",
+        "Allocation interval configured in the allocator",
+        mesos::internal::master::DEFAULT_ALLOCATION_INTERVAL);
+  }
+
+  size_t agents;
+  size_t frameworks;
+  size_t roles;
+  string agent_resources;
+  Option<string> used_resources;
+  double decline_fraction;
+  double refuse_seconds;
+  size_t rounds;
+  Duration allocation_interval;
+};
+
+
+static SlaveInfo createSlaveInfo(size_t index, const Resources& resources)
+{
+  SlaveID slaveId;
+  slaveId.set_value("agent" + stringify(index));
+
+  SlaveInfo slave;
+  *(slave.mutable_resources()) = resources;
+  *(slave.mutable_id()) = slaveId;
+  slave.set_hostname(slaveId.value());
+
+  return slave;
+}
+
+
+static FrameworkInfo createFrameworkInfo(size_t index, const string& role)
+{
+  FrameworkInfo framework;
+  framework.set_user("user");
+  framework.set_name("framework" + stringify(index));
+  framework.mutable_id()->set_value(framework.name());
+  framework.set_role(role);
+
+  return framework;
+}
+
+
+int main(int argc, char** argv)
+{
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  Flags flags;
+
+  Try<flags::Warnings> load = flags.load(None(), argc, argv);
+
+  if (load.isError()) {
+    cerr << flags.usage(load.error()) << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (flags.help) {
+    cout << flags.usage() << endl;
+    return EXIT_SUCCESS;
+  }
+
+  // Log any flag warnings.
+  foreach (const flags::Warning& warning, load->warnings) {
+    LOG(WARNING) << warning.message;
+  }
+
+  if (flags.decline_fraction < 0.0 || flags.decline_fraction > 1.0) {
+    cerr << flags.usage("--decline_fraction must be between 0 and 1") << endl;
+    return EXIT_FAILURE;
+  }
+
+  Try<Resources> agentResources = Resources::parse(flags.agent_resources);
+
+  if (agentResources.isError()) {
+    cerr << "Failed to parse --agent_resources: "
+         << agentResources.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  Option<Resources> usedResources = None();
+
+  if (flags.used_resources.isSome()) {
+    Try<Resources> parse = Resources::parse(flags.used_resources.get());
+
+    if (parse.isError()) {
+      cerr << "Failed to parse --used_resources: " << parse.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    usedResources = parse.get();
+  }
+
+  Try<Allocator*> create = HierarchicalDRFAllocator::create();
+
+  if (create.isError()) {
+    cerr << "Failed to create the allocator: " << create.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  Allocator* allocator = create.get();
+
+  // We manually drive the allocation cycles below.
+  Clock::pause();
+
+  struct OfferedResources
+  {
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    Resources resources;
+  };
+
+  // NOTE: The offer callback runs on the allocator actor; `offers`
+  // is only read and mutated by the main thread while the clock is
+  // settled, i.e. while the allocator is idle.
+  vector<OfferedResources> offers;
+
+  auto offerCallback = [&offers](
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources_)
+  {
+    foreachpair (const SlaveID& slaveId,
+                 const Resources& resources,
+                 resources_) {
+      offers.push_back(OfferedResources{frameworkId, slaveId, resources});
+    }
+  };
+
+  auto inverseOfferCallback = [](
+      const FrameworkID&,
+      const hashmap<SlaveID, UnavailableResources>&) {};
+
+  allocator->initialize(
+      flags.allocation_interval,
+      offerCallback,
+      inverseOfferCallback,
+      {});
+
+  cout << "Using " << flags.agents << " agents, "
+       << flags.frameworks << " frameworks and "
+       << flags.roles << " roles" << endl;
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<FrameworkInfo> frameworks;
+  frameworks.reserve(flags.frameworks);
+
+  for (size_t i = 0; i < flags.frameworks; i++) {
+    const string role = flags.roles <= 1
+      ? "*"
+      : "role" + stringify(i % flags.roles);
+
+    frameworks.push_back(createFrameworkInfo(i, role));
+    allocator->addFramework(frameworks[i].id(), frameworks[i], {});
+  }
+
+  Clock::settle();
+  watch.stop();
+
+  cout << "Added " << flags.frameworks << " frameworks in "
+       << watch.elapsed() << endl;
+
+  watch.start();
+
+  for (size_t i = 0; i < flags.agents; i++) {
+    SlaveInfo slave = createSlaveInfo(i, agentResources.get());
+
+    // Assign any used resources to the frameworks round-robin.
+    hashmap<FrameworkID, Resources> used;
+
+    if (usedResources.isSome()) {
+      used[frameworks[i % flags.frameworks].id()] = usedResources.get();
+    }
+
+    allocator->addSlave(
+        slave.id(), slave, None(), slave.resources(), used);
+  }
+
+  Clock::settle();
+  watch.stop();
+
+  cout << "Added " << flags.agents << " agents in "
+       << watch.elapsed() << endl;
+
+  // Discard the offers triggered by adding the agents so that every
+  // measured round starts from the same state.
+  Clock::settle();
+  offers.clear();
+
+  vector<Duration> latencies;
+  latencies.reserve(flags.rounds);
+
+  Duration totalLatency;
+  size_t totalAllocations = 0;
+  size_t declined = 0;
+  size_t offered = 0;
+
+  for (size_t round = 0; round < flags.rounds; round++) {
+    // Decline the configured fraction of the previous round's offers
+    // with a filter; the rest stays allocated.
+    foreach (const OfferedResources& offer, offers) {
+      if (flags.decline_fraction > 0.0 &&
+          static_cast<double>(declined) <=
+            flags.decline_fraction * static_cast<double>(offered)) {
+        Filters filters;
+        filters.set_refuse_seconds(flags.refuse_seconds);
+
+        allocator->recoverResources(
+            offer.frameworkId, offer.slaveId, offer.resources, filters);
+
+        declined++;
+      }
+
+      offered++;
+    }
+
+    // Wait for the declines to be processed.
+    Clock::settle();
+    offers.clear();
+
+    watch.start();
+
+    // Trigger a batch allocation cycle.
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+
+    watch.stop();
+
+    latencies.push_back(watch.elapsed());
+    totalLatency += watch.elapsed();
+    totalAllocations += offers.size();
+  }
+
+  Clock::resume();
+
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile = [&latencies](double percent) {
+    size_t index = static_cast<size_t>(percent * latencies.size());
+    return latencies[std::min(index, latencies.size() - 1)];
+  };
+
+  cout << "Ran " << flags.rounds << " allocation cycles in "
+       << totalLatency << endl;
+
+  cout << "Made " << totalAllocations << " allocations ("
+       << static_cast<double>(totalAllocations) / totalLatency.secs()
+       << " allocations/sec), declined " << declined << " offers" << endl;
+
+  cout << "Cycle latencies:"
+       << " min " << latencies.front()
+       << ", p50 " << percentile(0.50)
+       << ", p90 " << percentile(0.90)
+       << ", p95 " << percentile(0.95)
+       << ", p99 " << percentile(0.99)
+       << ", max " << latencies.back() << endl;
+
+  delete allocator;
+
+  return EXIT_SUCCESS;
+}
@@ -17,13 +17,20 @@
 #include "master/allocator/mesos/hierarchical.hpp"
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <process/async.hpp>
+#include <process/check.hpp>
+#include <process/clock.hpp>
+#include <process/collect.hpp>
+#include <process/dispatch.hpp>
 #include <process/event.hpp>
 #include <process/delay.hpp>
 #include <process/id.hpp>
@@ -31,6 +38,7 @@
 
 #include <stout/check.hpp>
 #include <stout/hashset.hpp>
+#include <stout/os.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 
@@ -42,6 +50,8 @@ using std::vector;
 
 using mesos::allocator::InverseOfferStatus;
 
+using process::Clock;
+using process::dispatch;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -452,7 +462,7 @@ void HierarchicalAllocatorProcess::addSlave(
   }
 
   slaves[slaveId] = Slave();
-  slaves[slaveId].total = total;
+  slaves[slaveId].total = internTotal(total);
   slaves[slaveId].allocated = Resources::sum(used);
   slaves[slaveId].activated = true;
   slaves[slaveId].hostname = slaveInfo.hostname();
@@ -462,6 +472,7 @@ void HierarchicalAllocatorProcess::addSlave(
   if (unavailability.isSome()) {
     slaves[slaveId].maintenance =
       typename Slave::Maintenance(unavailability.get());
+    maintenanceSlaves.insert(slaveId);
   }
 
   // If we have just a number of recovered agents, we cannot distinguish
@@ -483,9 +494,14 @@ void HierarchicalAllocatorProcess::addSlave(
   }
 
   LOG(INFO) << "Added agent " << slaveId << " (" << slaves[slaveId].hostname
-            << ") with " << slaves[slaveId].total
+            << ") with " << slaves[slaveId].total->resources
             << " (allocated: " << slaves[slaveId].allocated << ")";
 
+  // Also mark the agent as an allocation candidate in case the
+  // allocator is paused (e.g., while recovering from a failover), so
+  // that it is evaluated by the first batch allocation after resuming.
+  allocationCandidates.insert(slaveId);
+
   allocate(slaveId);
 }
 
@@ -502,12 +518,17 @@ void HierarchicalAllocatorProcess::removeSlave(
   // all the resources. Fixing this would require more information
   // than what we currently track in the allocator.
 
-  roleSorter->remove(slaveId, slaves[slaveId].total);
+  roleSorter->remove(slaveId, slaves[slaveId].total->resources);
 
   // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-  quotaRoleSorter->remove(slaveId, slaves[slaveId].total.nonRevocable());
+  quotaRoleSorter->remove(
+      slaveId, slaves[slaveId].total->resources.nonRevocable());
+
+  releaseTotal(slaves[slaveId].total);
 
   slaves.erase(slaveId);
+  maintenanceSlaves.erase(slaveId);
+  allocationCandidates.erase(slaveId);
 
   // Note that we DO NOT actually delete any filters associated with
   // this slave, that will occur when the delayed
@@ -528,7 +549,16 @@ void HierarchicalAllocatorProcess::updateSlave(
   // Check that all the oversubscribed resources are revocable.
   CHECK_EQ(oversubscribed, oversubscribed.revocable());
 
-  const Resources oldRevocable = slaves[slaveId].total.revocable();
+  const Resources oldRevocable = slaves[slaveId].total->resources.revocable();
+
+  // An unchanged estimate is a no-op; returning early avoids
+  // churning the sorters (and the metrics derived from them).
+  if (oldRevocable == oversubscribed) {
+    VLOG(1) << "Agent " << slaveId << " (" << slaves[slaveId].hostname << ")"
+            << " updated with unchanged oversubscribed resources "
+            << oversubscribed;
+    return;
+  }
 
   // Update the total resources.
   //
@@ -540,7 +570,15 @@ void HierarchicalAllocatorProcess::updateSlave(
   //
   // TODO(alexr): Update this math once the source of revocable resources
   // is extended beyond oversubscription.
-  slaves[slaveId].total = slaves[slaveId].total.nonRevocable() + oversubscribed;
+  const std::shared_ptr<const TotalResources> updated = internTotal(
+      slaves[slaveId].total->resources.nonRevocable() + oversubscribed);
+
+  // NOTE: Pointer equality implies shape equality for interned
+  // descriptors, making this comparison O(1).
+  if (updated != slaves[slaveId].total) {
+    releaseTotal(slaves[slaveId].total);
+    slaves[slaveId].total = updated;
+  }
 
   // Update the total resources in the `roleSorter` by removing the
   // previous oversubscribed resources and adding the new
@@ -554,9 +592,11 @@ void HierarchicalAllocatorProcess::updateSlave(
 
   LOG(INFO) << "Agent " << slaveId << " (" << slaves[slaveId].hostname << ")"
             << " updated with oversubscribed resources " << oversubscribed
-            << " (total: " << slaves[slaveId].total
+            << " (total: " << slaves[slaveId].total->resources
             << ", allocated: " << slaves[slaveId].allocated << ")";
 
+  allocationCandidates.insert(slaveId);
+
   allocate(slaveId);
 }
 
@@ -720,10 +760,13 @@ void HierarchicalAllocatorProcess::updateAllocation(
     slaves[slaveId].allocated = updatedSlaveAllocation.get();
 
     // Update the total resources.
-    Try<Resources> updatedTotal = slaves[slaveId].total.apply(operation);
+    Try<Resources> updatedTotal =
+      slaves[slaveId].total->resources.apply(operation);
+
     CHECK_SOME(updatedTotal);
 
-    slaves[slaveId].total = updatedTotal.get();
+    releaseTotal(slaves[slaveId].total);
+    slaves[slaveId].total = internTotal(updatedTotal.get());
 
     // Update the total and allocated resources in each sorter.
     Resources frameworkAllocation =
@@ -788,7 +831,8 @@ Future<Nothing> HierarchicalAllocatorProcess::updateAvailable(
   CHECK(initialized);
   CHECK(slaves.contains(slaveId));
 
-  Resources available = slaves[slaveId].total - slaves[slaveId].allocated;
+  Resources available =
+    slaves[slaveId].total->resources - slaves[slaveId].allocated;
 
   // It's possible for this 'apply' to fail here because a call to
   // 'allocate' could have been enqueued by the allocator itself
@@ -808,11 +852,15 @@ Future<Nothing> HierarchicalAllocatorProcess::updateAvailable(
   }
 
   // Update the total resources.
-  Try<Resources> updatedTotal = slaves[slaveId].total.apply(operations);
+  Try<Resources> updatedTotal =
+    slaves[slaveId].total->resources.apply(operations);
+
   CHECK_SOME(updatedTotal);
 
-  const Resources oldTotal = slaves[slaveId].total;
-  slaves[slaveId].total = updatedTotal.get();
+  const Resources oldTotal = slaves[slaveId].total->resources;
+
+  releaseTotal(slaves[slaveId].total);
+  slaves[slaveId].total = internTotal(updatedTotal.get());
 
   // Now, update the total resources in the role sorters by removing
   // the previous resources at this slave and adding the new resources.
@@ -848,11 +896,13 @@ void HierarchicalAllocatorProcess::updateUnavailability(
 
   // Remove any old unavailability.
   slaves[slaveId].maintenance = None();
+  maintenanceSlaves.erase(slaveId);
 
   // If we have a new unavailability.
   if (unavailability.isSome()) {
     slaves[slaveId].maintenance =
       typename Slave::Maintenance(unavailability.get());
+    maintenanceSlaves.insert(slaveId);
   }
 
   allocate(slaveId);
@@ -1015,8 +1065,12 @@ void HierarchicalAllocatorProcess::recoverResources(
 
     slaves[slaveId].allocated -= resources;
 
+    // The agent's available resources changed, so evaluate it in
+    // the next batch allocation.
+    allocationCandidates.insert(slaveId);
+
     VLOG(1) << "Recovered " << resources
-            << " (total: " << slaves[slaveId].total
+            << " (total: " << slaves[slaveId].total->resources
             << ", allocated: " << slaves[slaveId].allocated
             << ") on agent " << slaveId
             << " from framework " << frameworkId;
@@ -1060,13 +1114,6 @@ void HierarchicalAllocatorProcess::recoverResources(
     OfferFilter* offerFilter = new RefusedOfferFilter(resources);
     frameworks[frameworkId].offerFilters[slaveId].insert(offerFilter);
 
-    // We need to disambiguate the function call to pick the correct
-    // expire() overload.
-    void (Self::*expireOffer)(
-              const FrameworkID&,
-              const SlaveID&,
-              OfferFilter*) = &Self::expire;
-
     // Expire the filter after both an `allocationInterval` and the
     // `timeout` have elapsed. This ensures that the filter does not
     // expire before we perform the next allocation for this agent,
@@ -1076,12 +1123,28 @@ void HierarchicalAllocatorProcess::recoverResources(
     // (MESOS-3078), we would not need to increase the timeout here.
     timeout = std::max(allocationInterval, timeout.get());
 
-    delay(timeout.get(),
-          self(),
-          expireOffer,
-          frameworkId,
-          slaveId,
-          offerFilter);
+    // Place the filter in the timing wheel: all filters expiring in
+    // the same `OFFER_FILTER_TIMEOUT_GRANULARITY` interval share a
+    // single timer and are expired in one batch. The expiry time is
+    // rounded up to the bucket boundary, so the filter can expire up
+    // to one interval late but never early.
+    const Duration expiry = Clock::now().duration() + timeout.get();
+
+    int64_t bucket = expiry.ns() / OFFER_FILTER_TIMEOUT_GRANULARITY.ns();
+    if (expiry.ns() % OFFER_FILTER_TIMEOUT_GRANULARITY.ns() != 0) {
+      bucket++;
+    }
+
+    if (!offerFilterWheel.contains(bucket)) {
+      delay(Nanoseconds(bucket * OFFER_FILTER_TIMEOUT_GRANULARITY.ns()) -
+              Clock::now().duration(),
+            self(),
+            &Self::expireOfferFilters,
+            bucket);
+    }
+
+    offerFilterWheel[bucket].push_back(
+        OfferFilterExpiry(frameworkId, slaveId, offerFilter));
   }
 }
 
@@ -1110,10 +1173,26 @@ void HierarchicalAllocatorProcess::reviveOffers(
 {
   CHECK(initialized);
 
+  // The agents the framework had filtered are the ones on which its
+  // standing changes by reviving; collect them before the filters
+  // are dropped so that they can be promptly re-evaluated below.
+  hashset<SlaveID> revivedSlaveIds;
+
+  foreachkey (const SlaveID& slaveId, frameworks[frameworkId].offerFilters) {
+    revivedSlaveIds.insert(slaveId);
+  }
+
+  foreachkey (const SlaveID& slaveId,
+              frameworks[frameworkId].inverseOfferFilters) {
+    revivedSlaveIds.insert(slaveId);
+  }
+
   frameworks[frameworkId].offerFilters.clear();
   frameworks[frameworkId].inverseOfferFilters.clear();
 
-  if (frameworks[frameworkId].suppressed) {
+  const bool suppressed = frameworks[frameworkId].suppressed;
+
+  if (suppressed) {
     frameworks[frameworkId].suppressed = false;
 
     const string& role = frameworks[frameworkId].role;
@@ -1135,7 +1214,19 @@ void HierarchicalAllocatorProcess::reviveOffers(
 
   LOG(INFO) << "Removed offer filters for framework " << frameworkId;
 
-  allocate();
+  // Reactivating a suppressed framework changes its standing on
+  // every agent, so that (rare) case still performs a full pass.
+  // Otherwise promptly evaluate only the agents the framework had
+  // filtered: agents it has simply not been offered yet are covered
+  // by the regular batch allocations, including the periodic full
+  // pass, like for any other active framework. This way revive
+  // storms from declining frameworks no longer trigger back-to-back
+  // full-cluster cycles.
+  if (suppressed) {
+    allocate();
+  } else if (!revivedSlaveIds.empty()) {
+    allocate(revivedSlaveIds);
+  }
 }
 
 
@@ -1261,7 +1352,35 @@ void HierarchicalAllocatorProcess::resume()
 
 void HierarchicalAllocatorProcess::batch()
 {
-  allocate();
+  // Batch allocations only evaluate the agents whose available
+  // resources changed since the last batch, which keeps the cost of
+  // a batch proportional to the amount of change rather than to the
+  // cluster size. Periodically we still perform a full pass over all
+  // agents as a safety net for events that do not mark allocation
+  // candidates (e.g., fair shares changing as the allocations of
+  // other frameworks change).
+  if (++batchesSinceFullAllocation >= BATCHES_PER_FULL_ALLOCATION) {
+    if (!paused) {
+      batchesSinceFullAllocation = 0;
+      allocationCandidates.clear();
+    }
+
+    allocate();
+  } else if (!paused && !allocationCandidates.empty()) {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    hashset<SlaveID> candidates;
+    std::swap(candidates, allocationCandidates);
+
+    allocate(candidates);
+
+    metrics.allocation_run.record(stopwatch.elapsed().ms());
+
+    VLOG(1) << "Performed allocation for " << candidates.size() << " of "
+            << slaves.size() << " agents in " << stopwatch.elapsed();
+  }
+
   delay(allocationInterval, self(), &Self::batch);
 }
 
@@ -1277,11 +1396,9 @@ void HierarchicalAllocatorProcess::allocate()
   Stopwatch stopwatch;
   stopwatch.start();
 
-  metrics.allocation_run.start();
-
   allocate(slaves.keys());
 
-  metrics.allocation_run.stop();
+  metrics.allocation_run.record(stopwatch.elapsed().ms());
 
   VLOG(1) << "Performed allocation for " << slaves.size() << " agents in "
             << stopwatch.elapsed();
@@ -1299,18 +1416,54 @@ void HierarchicalAllocatorProcess::allocate(
 
   Stopwatch stopwatch;
   stopwatch.start();
-  metrics.allocation_run.start();
 
   hashset<SlaveID> slaves({slaveId});
   allocate(slaves);
 
-  metrics.allocation_run.stop();
+  metrics.allocation_run.record(stopwatch.elapsed().ms());
 
   VLOG(1) << "Performed allocation for agent " << slaveId << " in "
           << stopwatch.elapsed();
 }
 
 
+void HierarchicalAllocatorProcess::resumeAllocation(
+    const hashset<SlaveID>& slaveIds)
+{
+  // An agent may have been removed since the cycle yielded.
+  hashset<SlaveID> remaining;
+  foreach (const SlaveID& slaveId, slaveIds) {
+    if (slaves.contains(slaveId)) {
+      remaining.insert(slaveId);
+    }
+  }
+
+  if (remaining.empty()) {
+    return;
+  }
+
+  if (paused) {
+    // Do not lose the agents: they will be picked up by the next
+    // batch allocation after the allocator is resumed.
+    foreach (const SlaveID& slaveId, remaining) {
+      allocationCandidates.insert(slaveId);
+    }
+
+    return;
+  }
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  allocate(remaining);
+
+  metrics.allocation_run.record(stopwatch.elapsed().ms());
+
+  VLOG(1) << "Resumed allocation for " << remaining.size() << " agents in "
+          << stopwatch.elapsed();
+}
+
+
 // TODO(alexr): Consider factoring out the quota allocation logic.
 void HierarchicalAllocatorProcess::allocate(
     const hashset<SlaveID>& slaveIds_)
@@ -1344,6 +1497,70 @@ void HierarchicalAllocatorProcess::allocate(
   // TODO(vinod): Implement a smarter sorting algorithm.
   std::random_shuffle(slaveIds.begin(), slaveIds.end());
 
+  // Precompute the available non-shared resources of the
+  // participating agents. This is pure CPU-bound `Resources`
+  // arithmetic against agent state that is immutable for the duration
+  // of the computation, so for large allocation cycles we partition
+  // the agents across worker threads and compute the snapshot
+  // concurrently. The matching below consults (and incrementally
+  // updates) the snapshot instead of recomputing the difference for
+  // every (agent, role, framework) combination, and the resulting
+  // allocations are applied serially on the allocator actor as
+  // before.
+  hashmap<SlaveID, Resources> availableResources;
+
+  auto computeAvailable = [this](const vector<SlaveID>& slaveIds) {
+    hashmap<SlaveID, Resources> available;
+
+    foreach (const SlaveID& slaveId, slaveIds) {
+      available[slaveId] =
+        (slaves[slaveId].total->resources -
+           slaves[slaveId].allocated).nonShared();
+    }
+
+    return available;
+  };
+
+  if (slaveIds.size() < MIN_AGENTS_FOR_PARALLEL_ALLOCATION) {
+    availableResources = computeAvailable(slaveIds);
+  } else {
+    Try<long> cpus = os::cpus();
+
+    const size_t workers = std::min(
+        slaveIds.size(),
+        static_cast<size_t>(std::max(cpus.isSome() ? cpus.get() : 1L, 1L)));
+
+    const size_t chunk = (slaveIds.size() + workers - 1) / workers;
+
+    std::vector<process::Future<hashmap<SlaveID, Resources>>> pieces;
+    pieces.reserve(workers);
+
+    for (size_t start = 0; start < slaveIds.size(); start += chunk) {
+      pieces.push_back(process::async(
+          computeAvailable,
+          vector<SlaveID>(
+              slaveIds.begin() + start,
+              slaveIds.begin() +
+                std::min(start + chunk, slaveIds.size()))));
+    }
+
+    // Note that waiting on the allocator actor is safe here: the
+    // workers only read agent state and nothing else mutates it
+    // until they are done.
+    process::collect(pieces).await();
+
+    foreach (const process::Future<hashmap<SlaveID, Resources>>& piece,
+             pieces) {
+      CHECK_READY(piece);
+
+      foreachpair (const SlaveID& slaveId,
+                   const Resources& resources,
+                   piece.get()) {
+        availableResources[slaveId] = resources;
+      }
+    }
+  }
+
   // Returns the __quantity__ of resources allocated to a quota role. Since we
   // account for reservations and persistent volumes toward quota, we strip
   // reservation and persistent volume related information for comparability.
@@ -1382,10 +1599,40 @@ void HierarchicalAllocatorProcess::allocate(
   // allocated in the current cycle.
   hashmap<SlaveID, Resources> offeredSharedResources;
 
+  // Agents that could not be evaluated within the allocation cycle
+  // time budget. They are resumed in a separate dispatch (see below),
+  // so that dispatches queued behind a long cycle (e.g., framework
+  // messages) are not blocked until the whole cluster is evaluated.
+  hashset<SlaveID> deferredSlaveIds;
+
+  // The quantity of resources allocated to each quota'ed role. This
+  // is computed once per cycle (O(roles-with-quota) lookups into the
+  // incrementally maintained sorter quantities) and updated as this
+  // cycle allocates, so the quota check in the loop below is a
+  // hashmap lookup rather than a per-agent recomputation.
+  hashmap<string, Resources> quotaRoleConsumed;
+  foreachkey (const string& role, quotas) {
+    quotaRoleConsumed[role] = getQuotaRoleAllocatedResources(role);
+  }
+
+  Stopwatch cycle;
+  cycle.start();
+
   // Quota comes first and fair share second. Here we process only those
   // roles, for which quota is set (quota'ed roles). Such roles form a
   // special allocation group with a dedicated sorter.
-  foreach (const SlaveID& slaveId, slaveIds) {
+  for (size_t i = 0; i < slaveIds.size(); i++) {
+    // Yield if the cycle has exhausted its time budget. The remaining
+    // agents are excluded from the second stage as well and resumed
+    // as a whole.
+    if (cycle.elapsed() > allocationCycleBudget) {
+      deferredSlaveIds.insert(slaveIds.begin() + i, slaveIds.end());
+      slaveIds.resize(i);
+      break;
+    }
+
+    const SlaveID& slaveId = slaveIds[i];
+
     foreach (const string& role, quotaRoleSorter->sort()) {
       CHECK(quotas.contains(role));
 
@@ -1395,9 +1642,9 @@ void HierarchicalAllocatorProcess::allocate(
         continue;
       }
 
-      // Get the total quantity of resources allocated to a quota role. The
-      // value omits role, reservation, and persistence info.
-      Resources roleConsumedResources = getQuotaRoleAllocatedResources(role);
+      // The total quantity of resources allocated to the quota role.
+      // The value omits role, reservation, and persistence info.
+      const Resources& roleConsumedResources = quotaRoleConsumed[role];
 
       // If quota for the role is satisfied, we do not need to do any further
       // allocations for this role, at least at this stage.
@@ -1420,23 +1667,23 @@ void HierarchicalAllocatorProcess::allocate(
         // frameworks that are capable of receiving GPUs.
         // See MESOS-5634.
         if (!frameworks[frameworkId].gpuAware &&
-            slaves[slaveId].total.gpus().getOrElse(0) > 0) {
+            slaves[slaveId].total->hasGpus) {
           continue;
         }
 
-        // Calculate the currently available resources on the slave, which
-        // is the difference in non-shared resources between total and
-        // allocated, plus all shared resources on the agent (if applicable).
-        // Since shared resources are offerable even when they are in use, we
-        // make one copy of the shared resources available regardless of the
+        // The currently available resources on the slave are the
+        // difference in non-shared resources between total and
+        // allocated (precomputed in `availableResources`), plus all
+        // shared resources on the agent (if applicable). Since shared
+        // resources are offerable even when they are in use, we make
+        // one copy of the shared resources available regardless of the
         // past allocations.
-        Resources available =
-          (slaves[slaveId].total - slaves[slaveId].allocated).nonShared();
+        Resources available = availableResources[slaveId];
 
         // Offer a shared resource only if it has not been offered in
         // this offer cycle to a framework.
         if (frameworks[frameworkId].shared) {
-          available += slaves[slaveId].total.shared();
+          available += slaves[slaveId].total->sharedResources;
           if (offeredSharedResources.contains(slaveId)) {
             available -= offeredSharedResources[slaveId];
           }
@@ -1488,6 +1735,7 @@ void HierarchicalAllocatorProcess::allocate(
         offeredSharedResources[slaveId] += resources.shared();
 
         slaves[slaveId].allocated += resources;
+        availableResources[slaveId] -= resources.nonShared();
 
         // Resources allocated as part of the quota count towards the
         // role's and the framework's fair share.
@@ -1497,6 +1745,14 @@ void HierarchicalAllocatorProcess::allocate(
         frameworkSorters[role]->allocated(frameworkId_, slaveId, resources);
         roleSorter->allocated(role, slaveId, resources);
         quotaRoleSorter->allocated(role, slaveId, resources);
+
+        // Track the role's quota consumption within this cycle. The
+        // role is stripped to match `getQuotaRoleAllocatedResources`.
+        foreach (Resource resource,
+                 resources.createStrippedScalarQuantity()) {
+          resource.set_role("*");
+          quotaRoleConsumed[role] += resource;
+        }
       }
     }
   }
@@ -1513,10 +1769,12 @@ void HierarchicalAllocatorProcess::allocate(
   // agents participating in the current allocation (i.e. provided as an
   // argument to the `allocate()` call) so that frameworks in roles without
   // quota are not unnecessarily deprived of resources.
-  Resources remainingClusterResources = roleSorter->totalScalarQuantities();
-  foreachkey (const string& role, activeRoles) {
-    remainingClusterResources -= roleSorter->allocationScalarQuantities(role);
-  }
+  //
+  // Both quantities are maintained incrementally by the sorter, so
+  // this does not require summing over roles or agents.
+  Resources remainingClusterResources =
+    roleSorter->totalScalarQuantities() -
+    roleSorter->totalAllocationScalarQuantities();
 
   // Frameworks in a quota'ed role may temporarily reject resources by
   // filtering or suppressing offers. Hence quotas may not be fully allocated.
@@ -1526,7 +1784,7 @@ void HierarchicalAllocatorProcess::allocate(
     //
     // NOTE: Revocable resources are excluded in `quotaRoleSorter`.
     // NOTE: Only scalars are considered for quota.
-    Resources allocated = getQuotaRoleAllocatedResources(name);
+    const Resources& allocated = quotaRoleConsumed[name];
     const Resources required = quota.info.guarantee();
     unallocatedQuotaResources += (required - allocated);
   }
@@ -1559,7 +1817,18 @@ void HierarchicalAllocatorProcess::allocate(
 
   // At this point resources for quotas are allocated or accounted for.
   // Proceed with allocating the remaining free pool.
-  foreach (const SlaveID& slaveId, slaveIds) {
+  for (size_t i = 0; i < slaveIds.size(); i++) {
+    // Yield if the cycle has exhausted its time budget. Note that the
+    // resumed cycle runs the first allocation stage for these agents
+    // again, which is fine: any quota that is still unsatisfied may
+    // be allocated from them.
+    if (cycle.elapsed() > allocationCycleBudget) {
+      deferredSlaveIds.insert(slaveIds.begin() + i, slaveIds.end());
+      break;
+    }
+
+    const SlaveID& slaveId = slaveIds[i];
+
     // If there are no resources available for the second stage, stop.
     if (!allocatable(remainingClusterResources - allocatedStage2)) {
       break;
@@ -1576,23 +1845,23 @@ void HierarchicalAllocatorProcess::allocate(
         // frameworks that are capable of receiving GPUs.
         // See MESOS-5634.
         if (!frameworks[frameworkId].gpuAware &&
-            slaves[slaveId].total.gpus().getOrElse(0) > 0) {
+            slaves[slaveId].total->hasGpus) {
           continue;
         }
 
-        // Calculate the currently available resources on the slave, which
-        // is the difference in non-shared resources between total and
-        // allocated, plus all shared resources on the agent (if applicable).
-        // Since shared resources are offerable even when they are in use, we
-        // make one copy of the shared resources available regardless of the
+        // The currently available resources on the slave are the
+        // difference in non-shared resources between total and
+        // allocated (precomputed in `availableResources`), plus all
+        // shared resources on the agent (if applicable). Since shared
+        // resources are offerable even when they are in use, we make
+        // one copy of the shared resources available regardless of the
         // past allocations.
-        Resources available =
-          (slaves[slaveId].total - slaves[slaveId].allocated).nonShared();
+        Resources available = availableResources[slaveId];
 
         // Offer a shared resource only if it has not been offered in
         // this offer cycle to a framework.
         if (frameworks[frameworkId].shared) {
-          available += slaves[slaveId].total.shared();
+          available += slaves[slaveId].total->sharedResources;
           if (offeredSharedResources.contains(slaveId)) {
             available -= offeredSharedResources[slaveId];
           }
@@ -1676,6 +1945,7 @@ void HierarchicalAllocatorProcess::allocate(
         allocatedStage2 += scalarQuantity;
 
         slaves[slaveId].allocated += resources;
+        availableResources[slaveId] -= resources.nonShared();
 
         frameworkSorters[role]->add(slaveId, resources);
         frameworkSorters[role]->allocated(frameworkId_, slaveId, resources);
@@ -1693,9 +1963,23 @@ void HierarchicalAllocatorProcess::allocate(
   if (offerable.empty()) {
     VLOG(1) << "No allocations performed";
   } else {
-    // Now offer the resources to each framework.
+    // Stage the allocations rather than invoking the offer callback
+    // directly: offers produced by back-to-back allocation cycles in
+    // the same event batch (e.g., during rolling agent restarts)
+    // coalesce into a single callback per framework, which the master
+    // turns into one ResourceOffersMessage.
+    const bool flushScheduled = !pendingOffers.empty();
+
     foreachkey (const FrameworkID& frameworkId, offerable) {
-      offerCallback(frameworkId, offerable[frameworkId]);
+      foreachpair (const SlaveID& slaveId,
+                   const Resources& resources,
+                   offerable[frameworkId]) {
+        pendingOffers[frameworkId][slaveId] += resources;
+      }
+    }
+
+    if (!flushScheduled) {
+      dispatch(self(), &Self::flushOffers);
     }
   }
 
@@ -1703,12 +1987,45 @@ void HierarchicalAllocatorProcess::allocate(
   // allocator. We leverage the existing timer/cycle of offers to also do any
   // "deallocation" (inverse offers) necessary to satisfy maintenance needs.
   deallocate(slaveIds_);
+
+  // Resume the cycle for the agents that did not fit into the time
+  // budget. Dispatching (rather than continuing inline) lets any
+  // queued dispatches run first.
+  if (!deferredSlaveIds.empty()) {
+    VLOG(1) << "Deferred allocation for " << deferredSlaveIds.size()
+            << " agents because the allocation cycle budget "
+            << allocationCycleBudget << " was exceeded";
+
+    dispatch(self(), &Self::resumeAllocation, deferredSlaveIds);
+  }
+}
+
+
+void HierarchicalAllocatorProcess::flushOffers()
+{
+  if (pendingOffers.empty()) {
+    return;
+  }
+
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> offers;
+  offers.swap(pendingOffers);
+
+  foreachpair (const FrameworkID& frameworkId,
+               const hashmap<SlaveID, Resources>& resources,
+               offers) {
+    offerCallback(frameworkId, resources);
+  }
 }
 
 
 void HierarchicalAllocatorProcess::deallocate(
     const hashset<SlaveID>& slaveIds_)
 {
+  // If no agents are under maintenance, no work to do.
+  if (maintenanceSlaves.empty()) {
+    return;
+  }
+
   // If no frameworks are currently registered, no work to do.
   if (activeRoles.empty()) {
     return;
@@ -1730,55 +2047,62 @@ void HierarchicalAllocatorProcess::deallocate(
   // keep generating new inverse offers even though the framework had not
   // responded yet.
 
-  foreachvalue (const Owned<Sorter>& frameworkSorter, frameworkSorters) {
-    foreach (const SlaveID& slaveId, slaveIds_) {
-      CHECK(slaves.contains(slaveId));
-
-      if (slaves[slaveId].maintenance.isSome()) {
-        // We use a reference by alias because we intend to modify the
-        // `maintenance` and to improve readability.
-        typename Slave::Maintenance& maintenance =
-          slaves[slaveId].maintenance.get();
-
-        hashmap<string, Resources> allocation =
-          frameworkSorter->allocation(slaveId);
-
-        foreachkey (const string& frameworkId_, allocation) {
-          FrameworkID frameworkId;
-          frameworkId.set_value(frameworkId_);
-
-          // If this framework doesn't already have inverse offers for the
-          // specified slave.
-          if (!offerable[frameworkId].contains(slaveId)) {
-            // If there isn't already an outstanding inverse offer to this
-            // framework for the specified slave.
-            if (!maintenance.offersOutstanding.contains(frameworkId)) {
-              // Ignore in case the framework filters inverse offers for this
-              // slave.
-              //
-              // NOTE: Since this specific allocator implementation only sends
-              // inverse offers for maintenance primitives, and those are at the
-              // whole slave level, we only need to filter based on the
-              // time-out.
-              if (isFiltered(frameworkId, slaveId)) {
-                continue;
-              }
-
-              const UnavailableResources unavailableResources =
-                UnavailableResources{
-                    Resources(),
-                    maintenance.unavailability};
-
-              // For now we send inverse offers with empty resources when the
-              // inverse offer represents maintenance on the machine. In the
-              // future we could be more specific about the resources on the
-              // host, as we have the information available.
-              offerable[frameworkId][slaveId] = unavailableResources;
-
-              // Mark this framework as having an offer outstanding for the
-              // specified slave.
-              maintenance.offersOutstanding.insert(frameworkId);
+  // NOTE: We iterate over the (usually much smaller) set of agents
+  // under maintenance rather than over all allocation candidates;
+  // agents without a scheduled unavailability cannot produce inverse
+  // offers.
+  foreach (const SlaveID& slaveId, maintenanceSlaves) {
+    if (!slaveIds_.contains(slaveId)) {
+      continue;
+    }
+
+    CHECK(slaves.contains(slaveId));
+    CHECK(slaves[slaveId].maintenance.isSome());
+
+    // We use a reference by alias because we intend to modify the
+    // `maintenance` and to improve readability.
+    typename Slave::Maintenance& maintenance =
+      slaves[slaveId].maintenance.get();
+
+    foreachvalue (const Owned<Sorter>& frameworkSorter, frameworkSorters) {
+      hashmap<string, Resources> allocation =
+        frameworkSorter->allocation(slaveId);
+
+      foreachkey (const string& frameworkId_, allocation) {
+        FrameworkID frameworkId;
+        frameworkId.set_value(frameworkId_);
+
+        // If this framework doesn't already have inverse offers for the
+        // specified slave.
+        if (!offerable[frameworkId].contains(slaveId)) {
+          // If there isn't already an outstanding inverse offer to this
+          // framework for the specified slave.
+          if (!maintenance.offersOutstanding.contains(frameworkId)) {
+            // Ignore in case the framework filters inverse offers for this
+            // slave.
+            //
+            // NOTE: Since this specific allocator implementation only sends
+            // inverse offers for maintenance primitives, and those are at the
+            // whole slave level, we only need to filter based on the
+            // time-out.
+            if (isFiltered(frameworkId, slaveId)) {
+              continue;
             }
+
+            const UnavailableResources unavailableResources =
+              UnavailableResources{
+                  Resources(),
+                  maintenance.unavailability};
+
+            // For now we send inverse offers with empty resources when the
+            // inverse offer represents maintenance on the machine. In the
+            // future we could be more specific about the resources on the
+            // host, as we have the information available.
+            offerable[frameworkId][slaveId] = unavailableResources;
+
+            // Mark this framework as having an offer outstanding for the
+            // specified slave.
+            maintenance.offersOutstanding.insert(frameworkId);
           }
         }
       }
@@ -1796,6 +2120,16 @@ void HierarchicalAllocatorProcess::deallocate(
 }
 
 
+void HierarchicalAllocatorProcess::expireOfferFilters(int64_t bucket)
+{
+  foreach (const OfferFilterExpiry& entry, offerFilterWheel[bucket]) {
+    expire(entry.frameworkId, entry.slaveId, entry.filter);
+  }
+
+  offerFilterWheel.erase(bucket);
+}
+
+
 void HierarchicalAllocatorProcess::expire(
     const FrameworkID& frameworkId,
     const SlaveID& slaveId,
@@ -1813,6 +2147,10 @@ void HierarchicalAllocatorProcess::expire(
     if (frameworks[frameworkId].offerFilters[slaveId].empty()) {
       frameworks[frameworkId].offerFilters.erase(slaveId);
     }
+
+    // The framework may now be offered the previously refused
+    // resources, so evaluate the agent in the next batch allocation.
+    allocationCandidates.insert(slaveId);
   }
 
   delete offerFilter;
@@ -1925,6 +2263,39 @@ bool HierarchicalAllocatorProcess::allocatable(
 }
 
 
+std::shared_ptr<const HierarchicalAllocatorProcess::TotalResources>
+HierarchicalAllocatorProcess::internTotal(const Resources& total)
+{
+  // NOTE: `Resources` is not hashable, so the descriptors are keyed
+  // by their stringification.
+  const string key = stringify(total);
+
+  Option<std::shared_ptr<const TotalResources>> shape = totalShapes.get(key);
+
+  if (shape.isSome()) {
+    return shape.get();
+  }
+
+  std::shared_ptr<const TotalResources> created =
+    std::make_shared<const TotalResources>(total);
+
+  totalShapes.put(key, created);
+
+  return created;
+}
+
+
+void HierarchicalAllocatorProcess::releaseTotal(
+    const std::shared_ptr<const TotalResources>& total)
+{
+  // If `totalShapes` and the caller hold the only references, no
+  // agent uses this shape anymore and the descriptor is dropped.
+  if (total.use_count() == 2) {
+    totalShapes.erase(stringify(total->resources));
+  }
+}
+
+
 double HierarchicalAllocatorProcess::_resources_offered_or_allocated(
     const string& resource)
 {
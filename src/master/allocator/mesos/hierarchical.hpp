@@ -17,8 +17,10 @@
 #ifndef __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 #define __MASTER_ALLOCATOR_MESOS_HIERARCHICAL_HPP__
 
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
@@ -66,6 +68,36 @@ class OfferFilter;
 class InverseOfferFilter;
 
 
+// Number of batch allocations between two full allocation passes
+// over all agents. In between, batch allocations only evaluate the
+// agents whose available resources changed since the last batch
+// (see `HierarchicalAllocatorProcess::allocationCandidates`).
+constexpr size_t BATCHES_PER_FULL_ALLOCATION = 10;
+
+
+// Minimum number of agents participating in an allocation cycle for
+// the available resources snapshot to be computed concurrently on
+// worker threads rather than on the allocator actor. Below this the
+// cost of dispatching the work outweighs the parallelism.
+constexpr size_t MIN_AGENTS_FOR_PARALLEL_ALLOCATION = 1000;
+
+
+// Default time budget for a single allocation cycle. When the budget
+// is exceeded the cycle yields, and the agents that have not been
+// evaluated yet are resumed in a separate dispatch, so that queued
+// dispatches (e.g., framework messages) are not blocked behind a
+// long cycle.
+constexpr Duration DEFAULT_ALLOCATION_CYCLE_BUDGET = Milliseconds(100);
+
+
+// Granularity of the offer filter timing wheel. Filters expiring
+// within the same interval share a single timer and are expired in
+// one batch, rather than scheduling one libprocess timer per
+// declined offer. Expiries are rounded up to the bucket boundary,
+// so a filter can expire up to one interval late but never early.
+constexpr Duration OFFER_FILTER_TIMEOUT_GRANULARITY = Seconds(1);
+
+
 // Implements the basic allocator algorithm - first pick a role by
 // some criteria, then pick one of their frameworks to allocate to.
 class HierarchicalAllocatorProcess : public MesosAllocatorProcess
@@ -77,6 +109,8 @@ public:
       const std::function<Sorter*()>& quotaRoleSorterFactory)
     : initialized(false),
       paused(true),
+      allocationCycleBudget(DEFAULT_ALLOCATION_CYCLE_BUDGET),
+      batchesSinceFullAllocation(0),
       metrics(*this),
       roleSorter(roleSorterFactory()),
       quotaRoleSorter(quotaRoleSorterFactory()),
@@ -220,6 +254,14 @@ protected:
   // Allocate resources from the specified slaves.
   void allocate(const hashset<SlaveID>& slaveIds);
 
+  // Continues an allocation cycle that yielded after exceeding the
+  // allocation cycle time budget.
+  void resumeAllocation(const hashset<SlaveID>& slaveIds);
+
+  // Delivers all staged offers to the master, one coalesced callback
+  // per framework.
+  void flushOffers();
+
   // Send inverse offers from the specified slaves.
   void deallocate(const hashset<SlaveID>& slaveIds);
 
@@ -235,6 +277,10 @@ protected:
       const SlaveID& slaveId,
       InverseOfferFilter* inverseOfferFilter);
 
+  // Expires all offer filters in the specified timing wheel bucket
+  // (see `offerFilterWheel`).
+  void expireOfferFilters(int64_t bucket);
+
   // Returns the weight of the specified role name.
   double roleWeight(const std::string& name);
 
@@ -256,6 +302,37 @@ protected:
 
   bool allocatable(const Resources& resources);
 
+  // An immutable, interned description of an agent's total
+  // resources. Most agents in a cluster have one of a handful of
+  // identical resource shapes, so agents with the same shape share a
+  // single descriptor (see `totalShapes`), and pointer equality
+  // between descriptors implies shape equality. Values derived from
+  // the total that the allocation loops consult per framework are
+  // cached here.
+  struct TotalResources
+  {
+    explicit TotalResources(const Resources& _resources)
+      : resources(_resources),
+        sharedResources(_resources.shared()),
+        hasGpus(_resources.gpus().getOrElse(0) > 0) {}
+
+    const Resources resources;
+
+    // Cached `resources.shared()`.
+    const Resources sharedResources;
+
+    // Cached `resources.gpus().getOrElse(0) > 0`.
+    const bool hasGpus;
+  };
+
+  // Returns the shared descriptor for the given total resources,
+  // creating and interning it if no agent has this shape yet.
+  std::shared_ptr<const TotalResources> internTotal(const Resources& total);
+
+  // Drops the interned descriptor if the given reference belongs to
+  // the last agent using its shape.
+  void releaseTotal(const std::shared_ptr<const TotalResources>& total);
+
   bool initialized;
   bool paused;
 
@@ -264,6 +341,29 @@ protected:
 
   Duration allocationInterval;
 
+  // Time budget for a single allocation cycle; the cycle yields and
+  // resumes in a separate dispatch when the budget is exceeded.
+  Duration allocationCycleBudget;
+
+  // Agents whose available resources changed since the last batch
+  // allocation, e.g., because resources were recovered from an offer
+  // or an offer filter expired. Batch allocations only evaluate these
+  // agents; every `BATCHES_PER_FULL_ALLOCATION`-th batch performs a
+  // full pass over all agents as a safety net for events that are not
+  // tracked here (e.g., fair shares changing as the allocations of
+  // other frameworks change).
+  hashset<SlaveID> allocationCandidates;
+
+  // Number of batch allocations performed since the last full
+  // allocation pass.
+  size_t batchesSinceFullAllocation;
+
+  // Offers produced by allocation cycles but not yet delivered to the
+  // master. Offers from back-to-back cycles in the same event batch
+  // (e.g., during rolling agent restarts) are merged per framework
+  // and flushed in a single callback each (see `flushOffers`).
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> pendingOffers;
+
   lambda::function<
       void(const FrameworkID&,
            const hashmap<SlaveID, Resources>&)> offerCallback;
@@ -317,10 +417,36 @@ protected:
 
   hashmap<FrameworkID, Framework> frameworks;
 
+  // A pending offer filter expiration in the timing wheel.
+  struct OfferFilterExpiry
+  {
+    OfferFilterExpiry(
+        const FrameworkID& _frameworkId,
+        const SlaveID& _slaveId,
+        OfferFilter* _filter)
+      : frameworkId(_frameworkId), slaveId(_slaveId), filter(_filter) {}
+
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    OfferFilter* filter;
+  };
+
+  // Timing wheel for offer filter expiration, bucketed by expiry
+  // time in `OFFER_FILTER_TIMEOUT_GRANULARITY` intervals. A single
+  // timer per bucket, scheduled when the bucket is created, expires
+  // all of its filters at once. The per-framework `offerFilters`
+  // hashmaps remain the authoritative index consulted during
+  // allocation; entries here may refer to filters that have already
+  // been removed from that index (e.g., by `reviveOffers`), in which
+  // case expiration merely deletes them.
+  hashmap<int64_t, std::vector<OfferFilterExpiry>> offerFilterWheel;
+
   struct Slave
   {
-    // Total amount of regular *and* oversubscribed resources.
-    Resources total;
+    // Total amount of regular *and* oversubscribed resources. This
+    // points at an interned, immutable descriptor that is shared by
+    // all agents with an identical resource shape.
+    std::shared_ptr<const TotalResources> total;
 
     // Regular *and* oversubscribed resources that are allocated.
     //
@@ -386,6 +512,16 @@ protected:
 
   hashmap<SlaveID, Slave> slaves;
 
+  // Agents with `maintenance` currently set, kept in lockstep with
+  // the `slaves` map. This lets the inverse offer pass of each
+  // allocation cycle visit only the agents under maintenance instead
+  // of scanning the whole cluster.
+  hashset<SlaveID> maintenanceSlaves;
+
+  // Interned agent resource shapes, keyed by their stringification
+  // (`Resources` is not hashable). See `TotalResources`.
+  hashmap<std::string, std::shared_ptr<const TotalResources>> totalShapes;
+
   // Number of registered frameworks for each role. When a role's active
   // count drops to zero, it is removed from this map; the role is also
   // removed from `roleSorter` and its `frameworkSorter` is deleted.
@@ -45,7 +45,9 @@ Metrics::Metrics(const HierarchicalAllocatorProcess& _allocator)
         process::defer(
             allocator, &HierarchicalAllocatorProcess::_event_queue_dispatches)),
     allocation_runs("allocator/mesos/allocation_runs"),
-    allocation_run("allocator/mesos/allocation_run", Hours(1))
+    // NOTE: the "_ms" suffix preserves the name this metric was
+    // exported under when it was a Timer<Milliseconds>.
+    allocation_run("allocator/mesos/allocation_run_ms")
 {
   process::metrics::add(event_queue_dispatches);
   process::metrics::add(event_queue_dispatches_);
@@ -22,7 +22,7 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
-#include <process/metrics/timer.hpp>
+#include <process/metrics/histogram.hpp>
 
 #include <process/pid.hpp>
 
@@ -64,8 +64,10 @@ struct Metrics
   // Number of times the allocation algorithm has run.
   process::metrics::Counter allocation_runs;
 
-  // Latency of the allocation algorithm.
-  process::metrics::Timer<Milliseconds> allocation_run;
+  // Latency of the allocation algorithm, in milliseconds. A
+  // histogram rather than a windowed Timer so that recording a run
+  // stays allocation free regardless of the allocation rate.
+  process::metrics::Histogram allocation_run;
 
   // Gauges for the total amount of each resource in the cluster.
   std::vector<process::metrics::Gauge> resources_total;
@@ -74,7 +74,7 @@ void DRFSorter::add(const string& name, double weight)
   CHECK(!contains(name));
 
   Client client(name, 0, 0);
-  clients.insert(client);
+  clientIterators[name] = clients.insert(client).first;
 
   allocations[name] = Allocation();
   weights[name] = weight;
@@ -105,6 +105,14 @@ void DRFSorter::remove(const string& name)
 
   if (it != clients.end()) {
     clients.erase(it);
+    clientIterators.erase(name);
+  }
+
+  if (allocations.contains(name)) {
+    CHECK(totalAllocationScalarQuantities_.contains(
+        allocations[name].scalarQuantities));
+
+    totalAllocationScalarQuantities_ -= allocations[name].scalarQuantities;
   }
 
   allocations.erase(name);
@@ -123,7 +131,7 @@ void DRFSorter::activate(const string& name)
   set<Client, DRFComparator>::iterator it = find(name);
   if (it == clients.end()) {
     Client client(name, calculateShare(name), 0);
-    clients.insert(client);
+    clientIterators[name] = clients.insert(client).first;
   }
 }
 
@@ -138,6 +146,7 @@ void DRFSorter::deactivate(const string& name)
     // for this client which means the fairness can be gamed by a
     // framework disconnecting and reconnecting.
     clients.erase(it);
+    clientIterators.erase(name);
   }
 }
 
@@ -158,7 +167,7 @@ void DRFSorter::allocated(
 
     // Remove and reinsert it to update the ordering appropriately.
     clients.erase(it);
-    clients.insert(client);
+    clientIterators[name] = clients.insert(client).first;
   }
 
   // Add shared resources to the allocated quantities when the same
@@ -173,9 +182,10 @@ void DRFSorter::allocated(
 
   allocations[name].resources[slaveId] += resources;
   allocations[name].scalarQuantities += scalarQuantities;
+  totalAllocationScalarQuantities_ += scalarQuantities;
 
   foreach (const Resource& resource, scalarQuantities) {
-    allocations[name].totals[resource.name()] += resource.scalar();
+    allocations[name].totals[resource.name()] += resource.scalar().value();
   }
 
   // If the total resources have changed, we're going to
@@ -214,12 +224,15 @@ void DRFSorter::update(
   allocations[name].scalarQuantities -= oldAllocationQuantity;
   allocations[name].scalarQuantities += newAllocationQuantity;
 
+  totalAllocationScalarQuantities_ -= oldAllocationQuantity;
+  totalAllocationScalarQuantities_ += newAllocationQuantity;
+
   foreach (const Resource& resource, oldAllocationQuantity) {
-    allocations[name].totals[resource.name()] -= resource.scalar();
+    allocations[name].totals[resource.name()] -= resource.scalar().value();
   }
 
   foreach (const Resource& resource, newAllocationQuantity) {
-    allocations[name].totals[resource.name()] += resource.scalar();
+    allocations[name].totals[resource.name()] += resource.scalar().value();
   }
 
   // Just assume the total has changed, per the TODO above.
@@ -243,6 +256,12 @@ const Resources& DRFSorter::allocationScalarQuantities(const string& name)
 }
 
 
+const Resources& DRFSorter::totalAllocationScalarQuantities() const
+{
+  return totalAllocationScalarQuantities_;
+}
+
+
 hashmap<string, Resources> DRFSorter::allocation(const SlaveID& slaveId)
 {
   // TODO(jmlvanre): We can index the allocation by slaveId to make this faster.
@@ -302,11 +321,12 @@ void DRFSorter::unallocated(
     (resources.nonShared() + absentShared).createStrippedScalarQuantity();
 
   foreach (const Resource& resource, scalarQuantities) {
-    allocations[name].totals[resource.name()] -= resource.scalar();
+    allocations[name].totals[resource.name()] -= resource.scalar().value();
   }
 
   CHECK(allocations[name].scalarQuantities.contains(scalarQuantities));
   allocations[name].scalarQuantities -= scalarQuantities;
+  totalAllocationScalarQuantities_ -= scalarQuantities;
 
   if (allocations[name].resources[slaveId].empty()) {
     allocations[name].resources.erase(slaveId);
@@ -336,7 +356,7 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
     total_.scalarQuantities += scalarQuantities;
 
     foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] += resource.scalar();
+      total_.totals[resource.name()] += resource.scalar().value();
     }
 
     // We have to recalculate all shares when the total resources
@@ -367,7 +387,7 @@ void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
       (resources.nonShared() + absentShared).createStrippedScalarQuantity();
 
     foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] -= resource.scalar();
+      total_.totals[resource.name()] -= resource.scalar().value();
     }
 
     CHECK(total_.scalarQuantities.contains(scalarQuantities));
@@ -399,6 +419,12 @@ vector<string> DRFSorter::sort()
 
     clients = temp;
 
+    // Rebuild the name index since all clients were reinserted.
+    clientIterators.clear();
+    for (it = clients.begin(); it != clients.end(); it++) {
+      clientIterators[(*it).name] = it;
+    }
+
     // Reset dirty to false so as not to re-calculate *all*
     // shares unless another dirtying operation occurs.
     dirty = false;
@@ -440,7 +466,7 @@ void DRFSorter::update(const string& name)
 
     // Remove and reinsert it to update the ordering appropriately.
     clients.erase(it);
-    clients.insert(client);
+    clientIterators[name] = clients.insert(client).first;
   }
 }
 
@@ -456,7 +482,7 @@ double DRFSorter::calculateShare(const string& name) const
   // scalars.
 
   foreachpair (const string& resourceName,
-               const Value::Scalar& scalar,
+               double total,
                total_.totals) {
     // Filter out the resources excluded from fair sharing.
     if (fairnessExcludeResourceNames.isSome() &&
@@ -464,12 +490,12 @@ double DRFSorter::calculateShare(const string& name) const
       continue;
     }
 
-    if (scalar.value() > 0.0 &&
+    if (total > 0.0 &&
         allocations.at(name).totals.contains(resourceName)) {
       const double allocation =
-        allocations.at(name).totals.at(resourceName).value();
+        allocations.at(name).totals.at(resourceName);
 
-      share = std::max(share, allocation / scalar.value());
+      share = std::max(share, allocation / total);
     }
   }
 
@@ -479,14 +505,9 @@ double DRFSorter::calculateShare(const string& name) const
 
 set<Client, DRFComparator>::iterator DRFSorter::find(const string& name)
 {
-  set<Client, DRFComparator>::iterator it;
-  for (it = clients.begin(); it != clients.end(); it++) {
-    if (name == (*it).name) {
-      break;
-    }
-  }
+  Option<set<Client, DRFComparator>::iterator> it = clientIterators.get(name);
 
-  return it;
+  return it.isSome() ? it.get() : clients.end();
 }
 
 } // namespace allocator {
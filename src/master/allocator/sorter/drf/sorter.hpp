@@ -109,6 +109,8 @@ public:
 
   virtual const Resources& allocationScalarQuantities(const std::string& name);
 
+  virtual const Resources& totalAllocationScalarQuantities() const;
+
   virtual hashmap<std::string, Resources> allocation(const SlaveID& slaveId);
 
   virtual Resources allocation(const std::string& name, const SlaveID& slaveId);
@@ -146,6 +148,14 @@ private:
   // A set of Clients (names and shares) sorted by share.
   std::set<Client, DRFComparator> clients;
 
+  // Index from client name to its position in `clients`. This makes
+  // looking up a client O(1) and moving it after a share change
+  // O(log n) (erase and reinsert by iterator), rather than a linear
+  // scan over all clients. Note that `std::set` iterators remain
+  // valid as other clients are inserted and erased.
+  hashmap<std::string, std::set<Client, DRFComparator>::iterator>
+    clientIterators;
+
   // Maps client names to the weights that should be applied to their shares.
   hashmap<std::string, double> weights;
 
@@ -171,13 +181,15 @@ private:
     Resources scalarQuantities;
 
     // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
+    // the `Resource::name` to the aggregated scalar value as a plain
+    // double. This improves the performance of calculating shares,
+    // which then only performs hashmap lookups and double divisions.
+    // See MESOS-4694.
     //
     // TODO(bmahler): Ideally we do not store `scalarQuantities`
     // redundantly here, investigate performance improvements to
     // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    hashmap<std::string, double> totals;
   } total_;
 
   // Allocation for a client.
@@ -194,18 +206,24 @@ private:
     Resources scalarQuantities;
 
     // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
+    // the `Resource::name` to the aggregated scalar value as a
+    // plain double. This improves the performance of calculating
+    // shares. See MESOS-4694.
     //
     // TODO(bmahler): Ideally we do not store `scalarQuantities`
     // redundantly here, investigate performance improvements to
     // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    hashmap<std::string, double> totals;
   };
 
   // Maps client names to the resources they have been allocated.
   hashmap<std::string, Allocation> allocations;
 
+  // The sum of `Allocation::scalarQuantities` over all clients,
+  // maintained incrementally so that cluster-wide headroom checks
+  // do not need to sum over the clients.
+  Resources totalAllocationScalarQuantities_;
+
   // Metrics are optionally exposed by the sorter.
   friend Metrics;
   Option<Metrics> metrics;
@@ -106,6 +106,13 @@ public:
   virtual const Resources& allocationScalarQuantities(
       const std::string& client) = 0;
 
+  // Returns the total scalar resource quantities that are allocated
+  // across all of this sorter's clients, aggregated in the same way
+  // as `allocationScalarQuantities`. Implementations maintain this
+  // incrementally, so calling it does not require summing over the
+  // clients.
+  virtual const Resources& totalAllocationScalarQuantities() const = 0;
+
   // Returns the clients that have allocations on this slave.
   virtual hashmap<std::string, Resources> allocation(
       const SlaveID& slaveId) = 0;
@@ -0,0 +1,195 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <leveldb/db.h>
+
+#include <string>
+#include <vector>
+
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+#include <stout/some.hpp>
+
+#include "logging/logging.hpp"
+
+#include "master/archive.hpp"
+
+using namespace process;
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// All the leveldb interaction is isolated in this process so that
+// disk latency never blocks the master actor (see
+// `state::LevelDBStorageProcess` for the same structure).
+class ArchivistProcess : public Process<ArchivistProcess>
+{
+public:
+  explicit ArchivistProcess(const string& _path)
+    : ProcessBase(process::ID::generate("archivist")),
+      path(_path),
+      db(nullptr) {}
+
+  virtual ~ArchivistProcess()
+  {
+    delete db; // nullptr if open failed in initialize.
+  }
+
+  virtual void initialize()
+  {
+    leveldb::Options options;
+    options.create_if_missing = true;
+
+    leveldb::Status status = leveldb::DB::Open(options, path, &db);
+
+    if (!status.ok()) {
+      error = status.ToString();
+      LOG(ERROR) << "Failed to open framework archive at '" << path
+                 << "': " << error.get();
+    }
+  }
+
+  Future<Nothing> put(const Archive::Framework& framework)
+  {
+    if (error.isSome()) {
+      return Failure(error.get());
+    }
+
+    string value;
+    if (!framework.SerializeToString(&value)) {
+      return Failure("Failed to serialize framework");
+    }
+
+    // Archived history is not critical state (losing it on a crash
+    // only loses history), so we don't pay for a synchronous write
+    // like the registry does.
+    leveldb::WriteOptions options;
+    options.sync = false;
+
+    leveldb::Status status = db->Put(
+        options, framework.framework_info().id().value(), value);
+
+    if (!status.ok()) {
+      return Failure(status.ToString());
+    }
+
+    return Nothing();
+  }
+
+  Future<Option<Archive::Framework>> get(const FrameworkID& frameworkId)
+  {
+    if (error.isSome()) {
+      return Failure(error.get());
+    }
+
+    string value;
+
+    leveldb::Status status =
+      db->Get(leveldb::ReadOptions(), frameworkId.value(), &value);
+
+    if (status.IsNotFound()) {
+      return None();
+    } else if (!status.ok()) {
+      return Failure(status.ToString());
+    }
+
+    Archive::Framework framework;
+    if (!framework.ParseFromString(value)) {
+      return Failure("Failed to deserialize framework");
+    }
+
+    return Some(framework);
+  }
+
+  Future<vector<FrameworkID>> frameworkIds()
+  {
+    if (error.isSome()) {
+      return Failure(error.get());
+    }
+
+    vector<FrameworkID> results;
+
+    leveldb::Iterator* iterator = db->NewIterator(leveldb::ReadOptions());
+
+    iterator->SeekToFirst();
+
+    while (iterator->Valid()) {
+      FrameworkID frameworkId;
+      frameworkId.set_value(iterator->key().ToString());
+
+      results.push_back(frameworkId);
+
+      iterator->Next();
+    }
+
+    delete iterator;
+
+    return results;
+  }
+
+private:
+  const string path;
+  leveldb::DB* db;
+
+  Option<string> error;
+};
+
+
+Archivist::Archivist(const string& path)
+{
+  process = new ArchivistProcess(path);
+  spawn(process);
+}
+
+
+Archivist::~Archivist()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+Future<Nothing> Archivist::put(const Archive::Framework& framework)
+{
+  return dispatch(process, &ArchivistProcess::put, framework);
+}
+
+
+Future<Option<Archive::Framework>> Archivist::get(
+    const FrameworkID& frameworkId)
+{
+  return dispatch(process, &ArchivistProcess::get, frameworkId);
+}
+
+
+Future<vector<FrameworkID>> Archivist::frameworkIds()
+{
+  return dispatch(process, &ArchivistProcess::frameworkIds);
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
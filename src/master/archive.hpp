@@ -0,0 +1,72 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ARCHIVE_HPP__
+#define __MASTER_ARCHIVE_HPP__
+
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Forward declaration.
+class ArchivistProcess;
+
+
+// An archive tier for the master's completed framework history:
+// completed frameworks and their tasks are serialized into a local
+// leveldb so that the bounded in-memory history buffers can stay
+// small while older history remains available. Archived history is
+// only read on demand (see the master's '/archive' endpoint), so it
+// costs disk rather than RSS. The archive is local to one master and
+// is not part of the registry; losing it only loses history.
+class Archivist
+{
+public:
+  explicit Archivist(const std::string& path);
+  ~Archivist();
+
+  // Stores the completed framework, replacing any previously
+  // archived framework with the same id.
+  process::Future<Nothing> put(const Archive::Framework& framework);
+
+  // Returns the archived framework with the given id, if any.
+  process::Future<Option<Archive::Framework>> get(
+      const FrameworkID& frameworkId);
+
+  // Returns the ids of all archived frameworks.
+  process::Future<std::vector<FrameworkID>> frameworkIds();
+
+private:
+  ArchivistProcess* process;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ARCHIVE_HPP__
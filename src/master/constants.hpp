@@ -48,6 +48,11 @@ constexpr Bytes MIN_MEM = Megabytes(32);
 // scheduler.
 constexpr Duration DEFAULT_HEARTBEAT_INTERVAL = Seconds(15);
 
+// Window within which status update acknowledgements destined for
+// the same agent are coalesced into a single batched message.
+constexpr Duration STATUS_UPDATE_ACKNOWLEDGEMENT_BATCH_WINDOW =
+  Milliseconds(10);
+
 // Amount of time within which a slave PING should be received.
 // NOTE: The slave uses these PING constants to determine when
 // the master has stopped sending pings. If these are made
@@ -59,6 +64,24 @@ constexpr Duration DEFAULT_AGENT_PING_TIMEOUT = Seconds(15);
 // Maximum number of ping timeouts until slave is considered failed.
 constexpr size_t DEFAULT_MAX_AGENT_PING_TIMEOUTS = 5;
 
+// Number of slots in the timing wheel the agent observer uses to
+// spread liveness pings over the ping interval, so that each tick
+// pings a batch of agents rather than scheduling a timer per agent.
+constexpr size_t AGENT_PING_WHEEL_SLOTS = 16;
+
+// Maximum number of operator read requests (/state, /tasks and the
+// other dashboard endpoints) served concurrently. Requests beyond
+// the budget are shed with "503 Service Unavailable" so that a
+// monitoring burst costs a constant-time rejection instead of
+// crowding scheduler calls out of the master actor.
+constexpr size_t MAX_OUTSTANDING_OPERATOR_READS = 32;
+
+// Maximum number of tasks removed per dispatch while tearing down a
+// framework. Framework removal yields the master actor between
+// chunks so that removing a framework with many tasks does not stall
+// other processing.
+constexpr size_t REMOVE_FRAMEWORK_TASKS_PER_DISPATCH = 1000;
+
 // The minimum timeout that can be used by a newly elected leader to
 // allow re-registration of slaves. Any slaves that do not re-register
 // within this timeout will be shutdown.
@@ -85,12 +108,34 @@ constexpr size_t DEFAULT_MAX_COMPLETED_FRAMEWORKS = 50;
 // to store in the cache.
 constexpr size_t DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK = 1000;
 
+// Maximum number of Offer objects kept for reuse after their offer
+// is removed. Recycling offers retains the memory allocated for
+// their sub-messages across offer cycles; see `Master::removeOffer`.
+constexpr size_t MAX_OFFER_POOL_SIZE = 10000;
+
+// Maximum number of entries in the cache that memoizes the outcome
+// of executor-only validation checks, keyed by framework id and
+// serialized `ExecutorInfo`. Repeat launches with an identical
+// executor info skip re-running these checks.
+constexpr size_t EXECUTOR_VALIDATION_CACHE_SIZE = 1000;
+
+// Upper bound on the staleness of the memoized scalar sums behind
+// the master's per-resource metrics gauges.
+constexpr Duration METRICS_RESOURCES_STALENESS_BOUND = Seconds(1);
+
 // Time interval to check for updated watchers list.
 constexpr Duration WHITELIST_WATCH_INTERVAL = Seconds(5);
 
 // Default number of tasks (limit) for /master/tasks endpoint.
 constexpr size_t TASK_LIMIT = 100;
 
+// Maximum amount of encoded event data that may be queued on the
+// streaming connection of a subscriber to the 'api/vX' endpoint
+// before the master disconnects it. Without this bound a subscriber
+// that consumes events slower than the master produces them would
+// buffer an unbounded amount of memory in the master.
+constexpr Bytes MAX_SUBSCRIBER_EVENT_BACKLOG = Megabytes(64);
+
 constexpr Duration DEFAULT_REGISTRY_GC_INTERVAL = Minutes(15);
 
 constexpr Duration DEFAULT_REGISTRY_MAX_AGENT_AGE = Weeks(2);
@@ -118,6 +163,12 @@ constexpr Duration ZOOKEEPER_SESSION_TIMEOUT = Seconds(10);
 // Name of the default, CRAM-MD5 authenticator.
 constexpr char DEFAULT_AUTHENTICATOR[] = "crammd5";
 
+// Validity period of the tokens handed out on successful
+// authentication. A client presenting an unexpired token when
+// re-authenticating (e.g., after a ZooKeeper session expiration)
+// skips the SASL exchange.
+constexpr Duration AUTHENTICATION_TOKEN_TTL = Minutes(15);
+
 // Name of the default, HierarchicalDRF authenticator.
 constexpr char DEFAULT_ALLOCATOR[] = "HierarchicalDRF";
 
@@ -81,6 +81,17 @@ private:
   Option<MasterInfo> leader;
   set<Promise<Option<MasterInfo>>*> promises;
 
+  // Cache of the most recently fetched leader, keyed by the group
+  // membership id its data was parsed from, along with a generation
+  // number that is bumped on every detection event. A membership's
+  // znode data is immutable, so when the same membership is detected
+  // as leading again (e.g., re-detected after a ZooKeeper
+  // reconnection) the cached `MasterInfo` is served from memory
+  // instead of re-fetching and re-parsing the znode.
+  Option<int32_t> cachedMembership;
+  Option<MasterInfo> cachedLeader;
+  uint64_t generation;
+
   // Potential non-retryable error.
   Option<Error> error;
 };
@@ -101,7 +112,8 @@ ZooKeeperMasterDetectorProcess::ZooKeeperMasterDetectorProcess(
   : ProcessBase(ID::generate("zookeeper-master-detector")),
     group(_group),
     detector(group.get()),
-    leader(None()) {}
+    leader(None()),
+    generation(0) {}
 
 
 ZooKeeperMasterDetectorProcess::~ZooKeeperMasterDetectorProcess()
@@ -169,6 +181,19 @@ void ZooKeeperMasterDetectorProcess::detected(
 
   if (_leader.get().isNone()) {
     leader = None();
+    generation++;
+
+    setPromises(&promises, leader);
+  } else if (cachedMembership.isSome() &&
+             cachedMembership.get() == _leader.get().get().id()) {
+    // The same membership is leading again, so serve the result from
+    // the cache rather than re-fetching and re-parsing the znode.
+    leader = cachedLeader;
+    generation++;
+
+    LOG(INFO) << "The leading master (UPID="
+              << UPID(leader.get().pid()) << ") is detected again"
+              << " (generation " << generation << ")";
 
     setPromises(&promises, leader);
   } else {
@@ -196,6 +221,7 @@ void ZooKeeperMasterDetectorProcess::fetched(
   } else if (data.get().isNone()) {
     // Membership is gone before we can read its data.
     leader = None();
+    generation++;
     setPromises(&promises, leader);
     return;
   }
@@ -256,8 +282,13 @@ void ZooKeeperMasterDetectorProcess::fetched(
     return;
   }
 
+  cachedMembership = membership.id();
+  cachedLeader = leader;
+  generation++;
+
   LOG(INFO) << "A new leading master (UPID="
-            << UPID(leader.get().pid()) << ") is detected";
+            << UPID(leader.get().pid()) << ") is detected"
+            << " (generation " << generation << ")";
 
   setPromises(&promises, leader);
 }
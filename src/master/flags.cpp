@@ -114,6 +114,27 @@ mesos::internal::master::Flags::Flags()
       "after which the operation is considered a failure.",
       Seconds(20));
 
+  add(&Flags::registry_diffs_between_snapshots,
+      "registry_diffs_between_snapshots",
+      "Number of diff-encoded registry updates to write to the\n"
+      "replicated log between full registry snapshots. Diffs keep\n"
+      "steady-state registry writes proportional to the size of the\n"
+      "change rather than the size of the registry; recovery replays\n"
+      "the latest snapshot plus the diffs that follow it. A value of\n"
+      "`0` (the default) writes a full snapshot on every update.\n"
+      "Only used when `--registry=replicated_log`.",
+      static_cast<size_t>(0));
+
+  add(&Flags::registry_standby_catchup_interval,
+      "registry_standby_catchup_interval",
+      "If set, a master that is not currently leading periodically\n"
+      "replays the registry updates that its local replicated log\n"
+      "replica has learned, at this interval, so that upon election\n"
+      "it starts with a warm registry and only needs to read the\n"
+      "tail of the log. If unset (the default), the registry is read\n"
+      "in full after election. Only used when\n"
+      "`--registry=replicated_log`.");
+
   add(&Flags::log_auto_initialize,
       "log_auto_initialize",
       "Whether to automatically initialize the replicated log used for the\n"
@@ -541,6 +562,17 @@ mesos::internal::master::Flags::Flags()
       "Maximum number of completed tasks per framework to store in memory.",
       DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK);
 
+  add(&Flags::archive_dir,
+      "archive_dir",
+      "Directory into which completed frameworks and their tasks are\n"
+      "archived (in a local leveldb) when they fall out of the in-memory\n"
+      "history. Archived history is served on demand via the '/archive'\n"
+      "endpoint, which lets `--max_completed_frameworks` and\n"
+      "`--max_completed_tasks_per_framework` stay small without losing\n"
+      "history. The archive is local to this master and is not part of\n"
+      "the registry. If unset, completed frameworks are simply dropped\n"
+      "once they fall out of the in-memory history.");
+
   add(&Flags::master_contender,
       "master_contender",
       "The symbol name of the master contender to use.\n"
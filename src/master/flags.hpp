@@ -52,6 +52,8 @@ public:
   bool registry_strict;
   Duration registry_fetch_timeout;
   Duration registry_store_timeout;
+  size_t registry_diffs_between_snapshots;
+  Option<Duration> registry_standby_catchup_interval;
   bool log_auto_initialize;
   Duration agent_reregister_timeout;
   std::string recovery_agent_removal_limit;
@@ -87,6 +89,7 @@ public:
   Option<std::string> http_framework_authenticators;
   size_t max_completed_frameworks;
   size_t max_completed_tasks_per_framework;
+  Option<std::string> archive_dir;
   Option<std::string> master_contender;
   Option<std::string> master_detector;
   Duration registry_gc_interval;
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <functional>
 #include <iomanip>
 #include <map>
 #include <memory>
@@ -38,8 +39,10 @@
 
 #include <mesos/v1/master/master.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
+#include <process/dispatch.hpp>
 #include <process/help.hpp>
 #include <process/logging.hpp>
 
@@ -76,6 +79,7 @@
 
 #include "logging/logging.hpp"
 
+#include "master/archive.hpp"
 #include "master/machine.hpp"
 #include "master/maintenance.hpp"
 #include "master/master.hpp"
@@ -105,6 +109,7 @@ using process::http::Forbidden;
 using process::http::InternalServerError;
 using process::http::MethodNotAllowed;
 using process::http::NotFound;
+using process::http::NotModified;
 using process::http::NotImplemented;
 using process::http::NotAcceptable;
 using process::http::OK;
@@ -390,6 +395,36 @@ void Master::Http::log(const Request& request)
 }
 
 
+Future<Response> Master::Http::admit(
+    RequestClass requestClass,
+    const lambda::function<Future<Response>()>& f) const
+{
+  // Only operator reads are subject to a budget: shedding a
+  // scheduler call or internal traffic would trade scheduling
+  // correctness for latency.
+  if (requestClass != OPERATOR_READ) {
+    return f();
+  }
+
+  if (outstandingOperatorReads >= MAX_OUTSTANDING_OPERATOR_READS) {
+    // Rejecting here costs constant time, whereas serving the
+    // request would occupy the master actor for a full state
+    // serialization; monitoring clients are expected to back off
+    // and retry.
+    return ServiceUnavailable("Too many outstanding read requests");
+  }
+
+  ++outstandingOperatorReads;
+
+  return f()
+    .onAny(process::defer(master->self(), [this](
+        const Future<Response>&) {
+      CHECK_GT(outstandingOperatorReads, 0u);
+      --outstandingOperatorReads;
+    }));
+}
+
+
 string Master::Http::API_HELP()
 {
   return HELP(
@@ -649,14 +684,49 @@ Future<Response> Master::Http::subscribe(
       HttpConnection http {pipe.writer(), contentType, UUID::random()};
       master->subscribe(http);
 
-      mesos::master::Event event;
-      event.set_type(mesos::master::Event::SUBSCRIBED);
-      event.mutable_subscribed()->mutable_get_state()->CopyFrom(
-        _getState(frameworksApprover,
-                  tasksApprover,
-                  executorsApprover));
+      // The `SUBSCRIBED` event embeds a full state snapshot. Without
+      // an authorizer the snapshot is identical for all subscribers,
+      // so the encoded event is shared across subscribers connecting
+      // at the same state generation instead of being re-captured and
+      // re-encoded for each of them.
+      if (master->authorizer.isNone()) {
+        if (cachedSubscribedEvent.isNone() ||
+            cachedSubscribedEvent->generation != stateGeneration) {
+          cachedSubscribedEvent = CachedV1State{stateGeneration, {}};
+        }
+
+        if (cachedSubscribedEvent->bodies.count(contentType) == 0) {
+          mesos::master::Event event;
+          event.set_type(mesos::master::Event::SUBSCRIBED);
+
+          mesos::master::Response::GetState getState =
+            _getState(frameworksApprover,
+                      tasksApprover,
+                      executorsApprover);
+
+          event.mutable_subscribed()->mutable_get_state()->Swap(&getState);
 
-      http.send<mesos::master::Event, v1::master::Event>(event);
+          ::recordio::Encoder<v1::master::Event> encoder(lambda::bind(
+              serialize, contentType, lambda::_1));
+
+          cachedSubscribedEvent->bodies[contentType] =
+            encoder.encode(evolve(event));
+        }
+
+        http.writer.write(cachedSubscribedEvent->bodies[contentType]);
+      } else {
+        mesos::master::Event event;
+        event.set_type(mesos::master::Event::SUBSCRIBED);
+
+        mesos::master::Response::GetState getState =
+          _getState(frameworksApprover,
+                    tasksApprover,
+                    executorsApprover);
+
+        event.mutable_subscribed()->mutable_get_state()->Swap(&getState);
+
+        http.send<mesos::master::Event, v1::master::Event>(event);
+      }
 
       return ok;
     }));
@@ -1221,6 +1291,143 @@ Future<Response> Master::Http::destroyVolumes(
 }
 
 
+string Master::Http::ARCHIVE_HELP()
+{
+  return HELP(
+    TLDR("Archived completed framework history."),
+    DESCRIPTION(
+        "Returns the archived history of completed frameworks. Without",
+        "a query parameter, returns the ids of all archived frameworks.",
+        "With a `framework_id` query parameter, returns the archived",
+        "framework and its completed tasks.",
+        "",
+        "Archived history is only read on demand: unlike '/state', this",
+        "endpoint does not grow with the age of the cluster unless it",
+        "is asked to.",
+        "",
+        "Returns 400 BAD REQUEST if archiving is not enabled (see the",
+        "`--archive_dir` master flag).",
+        "Returns 404 NOT FOUND if the requested framework id is not",
+        "archived.",
+        "Returns 307 TEMPORARY_REDIRECT redirect to the leading master",
+        "when current master is not the leader."),
+    AUTHENTICATION(true),
+    AUTHORIZATION(
+        "This endpoint might be filtered based on the user accessing it.",
+        "See the authorization documentation for details."));
+}
+
+
+Future<Response> Master::Http::archive(
+    const Request& request,
+    const Option<string>& principal) const
+{
+  // When current master is not the leader, redirect to the leading master.
+  if (!master->elected()) {
+    return redirect(request);
+  }
+
+  if (master->archivist.get() == nullptr) {
+    return BadRequest(
+        "Archiving is not enabled. To enable archiving, the master "
+        "must be started with `--archive_dir`.\n");
+  }
+
+  Option<string> frameworkId = request.url.query.get("framework_id");
+
+  if (frameworkId.isNone()) {
+    // Without a framework id we only list what is archived; the
+    // ids themselves are not subject to authorization filtering.
+    return master->archivist->frameworkIds()
+      .then([request](const vector<FrameworkID>& frameworkIds) -> Response {
+        JSON::Object object;
+
+        {
+          JSON::Array array;
+          array.values.reserve(frameworkIds.size());
+
+          foreach (const FrameworkID& frameworkId, frameworkIds) {
+            array.values.push_back(frameworkId.value());
+          }
+
+          object.values["frameworks"] = std::move(array);
+        }
+
+        return OK(object, request.url.query.get("jsonp"));
+      });
+  }
+
+  FrameworkID id;
+  id.set_value(frameworkId.get());
+
+  // Retrieve `ObjectApprover`s for authorizing the framework and its tasks.
+  Future<Owned<ObjectApprover>> frameworksApprover;
+  Future<Owned<ObjectApprover>> tasksApprover;
+
+  if (master->authorizer.isSome()) {
+    authorization::Subject subject;
+    if (principal.isSome()) {
+      subject.set_value(principal.get());
+    }
+
+    frameworksApprover = master->authorizer.get()->getObjectApprover(
+        subject, authorization::VIEW_FRAMEWORK);
+
+    tasksApprover = master->authorizer.get()->getObjectApprover(
+        subject, authorization::VIEW_TASK);
+  } else {
+    frameworksApprover = Owned<ObjectApprover>(new AcceptingObjectApprover());
+    tasksApprover = Owned<ObjectApprover>(new AcceptingObjectApprover());
+  }
+
+  return collect(frameworksApprover, tasksApprover, master->archivist->get(id))
+    .then(defer(master->self(),
+        [request](const tuple<Owned<ObjectApprover>,
+                              Owned<ObjectApprover>,
+                              Option<Archive::Framework>>& result)
+          -> Response {
+      // Get approvers and the archived framework from tuple.
+      Owned<ObjectApprover> frameworksApprover;
+      Owned<ObjectApprover> tasksApprover;
+      Option<Archive::Framework> archived;
+      tie(frameworksApprover, tasksApprover, archived) = result;
+
+      if (archived.isNone()) {
+        return NotFound(
+            "Framework '" + request.url.query.get("framework_id").get() +
+            "' is not archived");
+      }
+
+      if (!approveViewFrameworkInfo(
+              frameworksApprover, archived->framework_info())) {
+        return Forbidden();
+      }
+
+      JSON::Object object;
+      object.values["framework_info"] =
+        JSON::protobuf(archived->framework_info());
+
+      {
+        JSON::Array array;
+        array.values.reserve(archived->tasks().size());
+
+        foreach (const Task& task, archived->tasks()) {
+          if (!approveViewTask(
+                  tasksApprover, task, archived->framework_info())) {
+            continue;
+          }
+
+          array.values.push_back(model(task));
+        }
+
+        object.values["completed_tasks"] = std::move(array);
+      }
+
+      return OK(object, request.url.query.get("jsonp"));
+    }));
+}
+
+
 string Master::Http::FRAMEWORKS_HELP()
 {
   return HELP(
@@ -1279,6 +1486,31 @@ Future<Response> Master::Http::frameworks(
                                     Owned<ObjectApprover>,
                                     Owned<ObjectApprover>>& approvers)
           -> Response {
+      // Support conditional requests, as in `state()`.
+      const string etag = stateETag();
+
+      if (request.headers.get("If-None-Match") == Option<string>(etag)) {
+        return NotModified(etag);
+      }
+
+      // Answer from the cached response body when nothing has changed
+      // since it was serialized; see
+      // `Master::Http::invalidateStateCache`. As with the fragment
+      // caches, this only applies when no authorizer filters the
+      // output per principal.
+      const bool cacheable =
+        master->authorizer.isNone() &&
+        request.url.query.get("jsonp").isNone();
+
+      if (cacheable &&
+          cachedFrameworksResponse.isSome() &&
+          cachedFrameworksResponse->generation == stateGeneration) {
+        OK ok(cachedFrameworksResponse->body);
+        ok.headers["Content-Type"] = "application/json";
+        ok.headers["ETag"] = etag;
+        return ok;
+      }
+
       // This lambda is consumed before the outer lambda
       // returns, hence capture by reference is fine here.
       auto frameworks = [this, &approvers](JSON::ObjectWriter* writer) {
@@ -1347,7 +1579,19 @@ Future<Response> Master::Http::frameworks(
         });
       };
 
-      return OK(jsonify(frameworks), request.url.query.get("jsonp"));
+      if (cacheable) {
+        cachedFrameworksResponse =
+          CachedResponse{stateGeneration, jsonify(frameworks)};
+
+        OK ok(cachedFrameworksResponse->body);
+        ok.headers["Content-Type"] = "application/json";
+        ok.headers["ETag"] = etag;
+        return ok;
+      }
+
+      OK ok(jsonify(frameworks), request.url.query.get("jsonp"));
+      ok.headers["ETag"] = etag;
+      return ok;
   }));
 }
 
@@ -1670,15 +1914,50 @@ Future<Response> Master::Http::getState(
       Owned<ObjectApprover> executorsApprover;
       tie(frameworksApprover, tasksApprover, executorsApprover) = approvers;
 
+      // Without an authorizer the response is identical for all
+      // principals, so the serialized body is shared across concurrent
+      // requests at the same state generation instead of re-capturing
+      // the snapshot per request.
+      const bool cacheable = master->authorizer.isNone();
+
+      if (cacheable &&
+          cachedGetStateResponse.isSome() &&
+          cachedGetStateResponse->generation == stateGeneration &&
+          cachedGetStateResponse->bodies.count(contentType) > 0) {
+        return OK(cachedGetStateResponse->bodies[contentType],
+                  stringify(contentType));
+      }
+
       mesos::master::Response response;
       response.set_type(mesos::master::Response::GET_STATE);
-      response.mutable_get_state()->CopyFrom(
-          _getState(frameworksApprover,
-                    tasksApprover,
-                    executorsApprover));
 
-      return OK(serialize(contentType, evolve(response)),
-                stringify(contentType));
+      mesos::master::Response::GetState getState =
+        _getState(frameworksApprover,
+                  tasksApprover,
+                  executorsApprover);
+
+      response.mutable_get_state()->Swap(&getState);
+
+      // The v0 and v1 operator API messages are wire-compatible (the
+      // `evolve` helper itself relies on this and round-trips through
+      // the wire format), so protobuf responses can be serialized
+      // directly from the unversioned message. This avoids the
+      // serialize/parse/re-serialize detour through `evolve` for what
+      // is by far the largest operator API response.
+      string body = contentType == ContentType::PROTOBUF
+        ? response.SerializeAsString()
+        : serialize(contentType, evolve(response));
+
+      if (cacheable) {
+        if (cachedGetStateResponse.isNone() ||
+            cachedGetStateResponse->generation != stateGeneration) {
+          cachedGetStateResponse = CachedV1State{stateGeneration, {}};
+        }
+
+        cachedGetStateResponse->bodies[contentType] = body;
+      }
+
+      return OK(body, stringify(contentType));
     }));
 }
 
@@ -1695,16 +1974,23 @@ mesos::master::Response::GetState Master::Http::_getState(
 
   mesos::master::Response::GetState getState;
 
-  getState.mutable_get_tasks()->CopyFrom(
-    _getTasks(frameworksApprover, tasksApprover));
+  // NOTE: We `Swap` the subresponses into place rather than copying
+  // them, since for a large cluster each of these holds a significant
+  // amount of task and agent state.
+  mesos::master::Response::GetTasks getTasks =
+    _getTasks(frameworksApprover, tasksApprover);
+  getState.mutable_get_tasks()->Swap(&getTasks);
 
-  getState.mutable_get_executors()->CopyFrom(
-    _getExecutors(frameworksApprover, executorsApprover));
+  mesos::master::Response::GetExecutors getExecutors =
+    _getExecutors(frameworksApprover, executorsApprover);
+  getState.mutable_get_executors()->Swap(&getExecutors);
 
-  getState.mutable_get_frameworks()->CopyFrom(
-    _getFrameworks(frameworksApprover));
+  mesos::master::Response::GetFrameworks getFrameworks =
+    _getFrameworks(frameworksApprover);
+  getState.mutable_get_frameworks()->Swap(&getFrameworks);
 
-  getState.mutable_get_agents()->CopyFrom(_getAgents());
+  mesos::master::Response::GetAgents getAgents = _getAgents();
+  getState.mutable_get_agents()->Swap(&getAgents);
 
   return getState;
 }
@@ -2435,6 +2721,14 @@ string Master::Http::STATE_HELP()
         "The information shown might be filtered based on the user",
         "accessing the endpoint.",
         "",
+        "When the query parameter `streaming=true` is specified (and",
+        "`jsonp` is not), the response is delivered as a chunked stream",
+        "that emits the JSON incrementally.",
+        "",
+        "The query parameter `framework_id=VALUE` restricts the",
+        "`frameworks` and `completed_frameworks` sections to the",
+        "framework with the given ID.",
+        "",
         "Example (**Note**: this is not exhaustive):",
         "",
         "```",
@@ -2513,6 +2807,81 @@ string Master::Http::STATE_HELP()
 }
 
 
+// The number of agents, frameworks or tasks serialized per dispatch
+// when streaming a response; see `Master::Http::streamState` and
+// `Master::Http::streamTasks`.
+static constexpr size_t STREAM_BATCH_SIZE = 64;
+
+
+// The state a streamed "/state" response carries between the
+// dispatches that emit its chunks. The ids are re-resolved per batch,
+// so only the approvers and the (bounded) tail writers pin memory for
+// the lifetime of the stream.
+struct Master::Http::StateStreamContext
+{
+  explicit StateStreamContext(const Pipe::Writer& _writer)
+    : writer(_writer) {}
+
+  Pipe::Writer writer;
+
+  std::vector<SlaveID> slaveIds;
+  std::vector<FrameworkID> frameworkIds;
+
+  Owned<ObjectApprover> frameworksApprover;
+  Owned<ObjectApprover> tasksApprover;
+  Owned<ObjectApprover> executorsApprover;
+
+  Option<string> frameworkIdFilter;
+
+  std::function<void(JSON::ArrayWriter*)> completedFrameworksWriter;
+  std::function<void(JSON::ArrayWriter*)> orphanTasksWriter;
+  std::function<void(JSON::ArrayWriter*)> unregisteredFrameworksWriter;
+
+  size_t slaveIndex = 0;
+  size_t frameworkIndex = 0;
+
+  // Elements actually written (as opposed to visited), for comma
+  // placement; skipped ids do not advance these.
+  size_t slavesEmitted = 0;
+  size_t frameworksEmitted = 0;
+
+  bool frameworksStarted = false;
+};
+
+
+// Ditto for a streamed "/tasks" response. Completed tasks are kept
+// alive by their shared ownership; live tasks are re-resolved per
+// batch instead, since they may be removed (or complete) in between.
+struct Master::Http::TasksStreamContext
+{
+  explicit TasksStreamContext(const Pipe::Writer& _writer)
+    : writer(_writer) {}
+
+  struct Entry
+  {
+    FrameworkID frameworkId;
+    TaskID taskId;
+
+    // Set (and owning) for a task that was completed when the stream
+    // started; unset for a task that was live, which is then looked
+    // up via the ids above.
+    std::shared_ptr<const Task> completed;
+  };
+
+  Pipe::Writer writer;
+
+  std::vector<Entry> entries;
+
+  std::function<void(JSON::ObjectWriter*, const Task&)> taskWriter;
+
+  size_t index = 0;
+
+  // Elements actually written, for comma placement; entries whose
+  // task is gone do not advance this.
+  size_t emitted = 0;
+};
+
+
 Future<Response> Master::Http::state(
     const Request& request,
     const Option<string>& principal) const
@@ -2563,20 +2932,38 @@ Future<Response> Master::Http::state(
                                     Owned<ObjectApprover>,
                                     Owned<ObjectApprover>,
                                     Owned<ObjectApprover>>& approvers)
-          -> Response {
+          -> Future<Response> {
+      // Support conditional requests: the entity tag embeds the
+      // cluster state generation, so an unchanged tag implies an
+      // unchanged (per-principal) response.
+      const string etag = stateETag();
+
+      if (request.headers.get("If-None-Match") == Option<string>(etag)) {
+        return NotModified(etag);
+      }
+
+      // Optional server-side filtering of the (completed) frameworks
+      // by ID, e.g., "?framework_id=...".
+      const Option<string> frameworkIdFilter =
+        request.url.query.get("framework_id");
+
+      // Get approver from tuple.
+      Owned<ObjectApprover> frameworksApprover;
+      Owned<ObjectApprover> tasksApprover;
+      Owned<ObjectApprover> executorsApprover;
+      Owned<ObjectApprover> flagsApprover;
+      tie(frameworksApprover,
+          tasksApprover,
+          executorsApprover,
+          flagsApprover) = approvers;
+
+      // The scalar fields common to the buffered and the streamed
+      // response; the latter splices the per-agent and per-framework
+      // fragments in behind these.
+      //
       // This lambda is consumed before the outer lambda
       // returns, hence capture by reference is fine here.
-      auto state = [this, &approvers](JSON::ObjectWriter* writer) {
-        // Get approver from tuple.
-        Owned<ObjectApprover> frameworksApprover;
-        Owned<ObjectApprover> tasksApprover;
-        Owned<ObjectApprover> executorsApprover;
-        Owned<ObjectApprover> flagsApprover;
-        tie(frameworksApprover,
-            tasksApprover,
-            executorsApprover,
-            flagsApprover) = approvers;
-
+      auto commonFields = [this, &flagsApprover](JSON::ObjectWriter* writer) {
         writer->field("version", MESOS_VERSION);
 
         if (build::GIT_SHA.isSome()) {
@@ -2633,113 +3020,442 @@ Future<Response> Master::Http::state(
               }
             });
         }
+      };
 
-        // Model all of the slaves.
-        writer->field("slaves", [this](JSON::ArrayWriter* writer) {
-          foreachvalue (Slave* slave, master->slaves.registered) {
-            writer->element(Full<Slave>(*slave));
+      // Serializes one agent; splices in a pre-serialized fragment
+      // when no authorizer filters the output, since then the output
+      // is identical for all principals; see
+      // `Master::Http::invalidateStateCache`.
+      auto slaveWriter = [this](JSON::ArrayWriter* writer, Slave* slave) {
+        if (master->authorizer.isNone()) {
+          if (!cachedSlaveJson.contains(slave->id)) {
+            cachedSlaveJson[slave->id] = jsonify(Full<Slave>(*slave));
           }
-        });
 
-        // Model all of the frameworks.
-        writer->field(
-            "frameworks",
-            [this, &frameworksApprover, &executorsApprover, &tasksApprover](
-                JSON::ArrayWriter* writer) {
-              foreachvalue (
-                  Framework* framework,
-                  master->frameworks.registered) {
-                // Skip unauthorized frameworks.
-                if (!approveViewFrameworkInfo(
-                        frameworksApprover, framework->info)) {
-                  continue;
-                }
+          writer->element(JSON::RawString(cachedSlaveJson.at(slave->id)));
+        } else {
+          writer->element(Full<Slave>(*slave));
+        }
+      };
 
-                auto frameworkWriter = FullFrameworkWriter(
-                    tasksApprover, executorsApprover, framework);
+      auto slavesWriter = [this, &slaveWriter](JSON::ArrayWriter* writer) {
+        foreachvalue (Slave* slave, master->slaves.registered) {
+          slaveWriter(writer, slave);
+        }
+      };
 
-                writer->element(frameworkWriter);
-              }
-            });
+      // As for the agents above, serializes one registered framework,
+      // consulting the fragment cache when no authorizer is configured.
+      auto frameworkWriter = [this, &executorsApprover, &tasksApprover](
+          JSON::ArrayWriter* writer, Framework* framework) {
+        auto fullFrameworkWriter = FullFrameworkWriter(
+            tasksApprover, executorsApprover, framework);
+
+        if (master->authorizer.isNone()) {
+          if (!cachedFrameworkJson.contains(framework->id())) {
+            cachedFrameworkJson[framework->id()] =
+              jsonify(fullFrameworkWriter);
+          }
 
-        // Model all of the completed frameworks.
-        writer->field(
-            "completed_frameworks",
-            [this, &frameworksApprover, &executorsApprover, &tasksApprover](
-                JSON::ArrayWriter* writer) {
-              foreach (
-                  const std::shared_ptr<Framework>& framework,
-                  master->frameworks.completed) {
-                // Skip unauthorized frameworks.
-                if (!approveViewFrameworkInfo(
+          writer->element(
+              JSON::RawString(cachedFrameworkJson.at(framework->id())));
+        } else {
+          writer->element(fullFrameworkWriter);
+        }
+      };
+
+      auto frameworksWriter =
+        [this, &frameworksApprover, &frameworkIdFilter, &frameworkWriter](
+            JSON::ArrayWriter* writer) {
+          foreachvalue (
+              Framework* framework,
+              master->frameworks.registered) {
+            // Skip filtered out frameworks.
+            if (frameworkIdFilter.isSome() &&
+                frameworkIdFilter.get() != framework->id().value()) {
+              continue;
+            }
+
+            // Skip unauthorized frameworks.
+            if (!approveViewFrameworkInfo(
                     frameworksApprover, framework->info)) {
-                  continue;
-                }
+              continue;
+            }
 
-                auto frameworkWriter = FullFrameworkWriter(
-                    tasksApprover, executorsApprover, framework.get());
+            frameworkWriter(writer, framework);
+          }
+        };
+
+      // NOTE: The three "tail" writers below (completed frameworks,
+      // orphan tasks and unregistered frameworks) capture by value:
+      // the streamed path stows them away in its context and invokes
+      // them from a later dispatch, after this lambda has returned.
+      auto completedFrameworksWriter =
+        [this,
+         frameworksApprover,
+         frameworkIdFilter,
+         executorsApprover,
+         tasksApprover](JSON::ArrayWriter* writer) {
+          foreach (
+              const std::shared_ptr<Framework>& framework,
+              master->frameworks.completed) {
+            // Skip filtered out frameworks.
+            if (frameworkIdFilter.isSome() &&
+                frameworkIdFilter.get() != framework->id().value()) {
+              continue;
+            }
 
-                writer->element(frameworkWriter);
-              }
-            });
+            // Skip unauthorized frameworks.
+            if (!approveViewFrameworkInfo(
+                frameworksApprover, framework->info)) {
+              continue;
+            }
 
-        // Model all of the orphan tasks.
-        writer->field("orphan_tasks", [this, &tasksApprover](
-            JSON::ArrayWriter* writer) {
-          // Find those orphan tasks.
-          foreachvalue (const Slave* slave, master->slaves.registered) {
-            typedef hashmap<TaskID, Task*> TaskMap;
-            foreachvalue (const TaskMap& tasks, slave->tasks) {
-              foreachvalue (const Task* task, tasks) {
-                CHECK_NOTNULL(task);
-                const FrameworkID& frameworkId = task->framework_id();
-                if (!master->frameworks.registered.contains(frameworkId)) {
-                  // TODO(joerg84): This logic should be simplified after
-                  // a deprecation cycle starting with 1.0 as after that
-                  // we can rely on 'master->frameworks.recovered' containing
-                  // all FrameworkInfos.
-                  // Until then there are 3 cases:
-                  // - No authorization enabled: show all orphaned tasks.
-                  // - Authorization enabled, but no FrameworkInfo present:
-                  //   do not show orphaned tasks.
-                  // - Authorization enabled, FrameworkInfo present: filter
-                  //   based on 'approveViewTask'.
-                  if (master->authorizer.isSome() &&
-                     (!master->frameworks.recovered.contains(frameworkId) ||
-                      !approveViewTask(
-                          tasksApprover,
-                          *task,
-                          master->frameworks.recovered[frameworkId]))) {
-                    continue;
-                  }
-
-                  writer->element(*task);
+            auto frameworkWriter = FullFrameworkWriter(
+                tasksApprover, executorsApprover, framework.get());
+
+            writer->element(frameworkWriter);
+          }
+        };
+
+      // Models all of the orphan tasks.
+      auto orphanTasksWriter = [this, tasksApprover](
+          JSON::ArrayWriter* writer) {
+        // Find those orphan tasks.
+        foreachvalue (const Slave* slave, master->slaves.registered) {
+          typedef hashmap<TaskID, Task*> TaskMap;
+          foreachvalue (const TaskMap& tasks, slave->tasks) {
+            foreachvalue (const Task* task, tasks) {
+              CHECK_NOTNULL(task);
+              const FrameworkID& frameworkId = task->framework_id();
+              if (!master->frameworks.registered.contains(frameworkId)) {
+                // TODO(joerg84): This logic should be simplified after
+                // a deprecation cycle starting with 1.0 as after that
+                // we can rely on 'master->frameworks.recovered' containing
+                // all FrameworkInfos.
+                // Until then there are 3 cases:
+                // - No authorization enabled: show all orphaned tasks.
+                // - Authorization enabled, but no FrameworkInfo present:
+                //   do not show orphaned tasks.
+                // - Authorization enabled, FrameworkInfo present: filter
+                //   based on 'approveViewTask'.
+                if (master->authorizer.isSome() &&
+                   (!master->frameworks.recovered.contains(frameworkId) ||
+                    !approveViewTask(
+                        tasksApprover,
+                        *task,
+                        master->frameworks.recovered[frameworkId]))) {
+                  continue;
                 }
+
+                writer->element(*task);
               }
             }
           }
-        });
+        }
+      };
 
-        // Model all currently unregistered frameworks. This can happen
-        // when a framework has yet to re-register after master failover.
-        // TODO(vinod): Need to filter these frameworks based on authorization!
-        // See the TODO above for "orphan_tasks" for further details.
-        writer->field("unregistered_frameworks", [this](
-            JSON::ArrayWriter* writer) {
-          // Find unregistered frameworks.
-          foreachvalue (const Slave* slave, master->slaves.registered) {
-            foreachkey (const FrameworkID& frameworkId, slave->tasks) {
-              if (!master->frameworks.registered.contains(frameworkId)) {
-                writer->element(frameworkId.value());
-              }
+      // Models all currently unregistered frameworks. This can happen
+      // when a framework has yet to re-register after master failover.
+      // TODO(vinod): Need to filter these frameworks based on authorization!
+      // See the TODO above for "orphan_tasks" for further details.
+      auto unregisteredFrameworksWriter = [this](
+          JSON::ArrayWriter* writer) {
+        // Find unregistered frameworks.
+        foreachvalue (const Slave* slave, master->slaves.registered) {
+          foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+            if (!master->frameworks.registered.contains(frameworkId)) {
+              writer->element(frameworkId.value());
             }
           }
-        });
+        }
       };
 
-      return OK(jsonify(state), request.url.query.get("jsonp"));
-    }));
-}
+      // When "?streaming=true" is specified (and "jsonp" is not), the
+      // response is a chunked stream: it is returned (holding the pipe
+      // reader) once the common fields have been written, and the
+      // per-agent and per-framework chunks are then emitted in batches
+      // of `STREAM_BATCH_SIZE` via separate dispatches onto the master
+      // actor (see `streamState`). This bounds both the peak memory of
+      // the response and the time the actor is blocked by any single
+      // dispatch, and gets the first bytes onto the wire before the
+      // cluster has been fully serialized.
+      if (request.url.query.get("streaming") == Option<string>("true") &&
+          request.url.query.get("jsonp").isNone()) {
+        Pipe pipe;
+        OK ok;
+
+        ok.headers["Content-Type"] = "application/json";
+        ok.headers["ETag"] = etag;
+        ok.type = Response::PIPE;
+        ok.reader = pipe.reader();
+
+        auto context = std::make_shared<StateStreamContext>(pipe.writer());
+
+        // Snapshot the ids rather than the objects: agents and
+        // frameworks can be removed between the batches, so each
+        // batch looks its ids up again and skips the ones that are
+        // gone (mirroring what a client polling the buffered endpoint
+        // across the removal would observe).
+        foreachvalue (Slave* slave, master->slaves.registered) {
+          context->slaveIds.push_back(slave->id);
+        }
+
+        foreachvalue (Framework* framework, master->frameworks.registered) {
+          context->frameworkIds.push_back(framework->id());
+        }
+
+        context->frameworksApprover = frameworksApprover;
+        context->tasksApprover = tasksApprover;
+        context->executorsApprover = executorsApprover;
+        context->frameworkIdFilter = frameworkIdFilter;
+
+        // The tail sections are backed by bounded buffers, so they
+        // are emitted as single chunks once the last framework batch
+        // is out.
+        context->completedFrameworksWriter = completedFrameworksWriter;
+        context->orphanTasksWriter = orphanTasksWriter;
+        context->unregisteredFrameworksWriter = unregisteredFrameworksWriter;
+
+        // Emit the common fields, re-opening the object so that the
+        // per-agent and per-framework chunks can be appended behind.
+        string head = jsonify(commonFields);
+        CHECK_EQ('}', head.back());
+        head.pop_back();
+        context->writer.write(std::move(head));
+        context->writer.write(",\"slaves\":[");
+
+        dispatch(master->self(), [this, context]() {
+          streamState(context);
+        });
+
+        return ok;
+      }
+
+      // Without an authorizer (and without "jsonp"), gather the
+      // pre-serialized fragments on the master actor and assemble the
+      // response body on the async worker pool, so that the actor is
+      // only blocked for the snapshot (fragment refresh) cost rather
+      // than for the full response concatenation.
+      if (master->authorizer.isNone() &&
+          request.url.query.get("jsonp").isNone()) {
+        auto pieces = std::make_shared<vector<string>>();
+
+        string head = jsonify(commonFields);
+        CHECK_EQ('}', head.back());
+        head.pop_back();
+        pieces->push_back(std::move(head));
+
+        pieces->push_back(",\"slaves\":[");
+
+        size_t count = 0;
+        foreachvalue (Slave* slave, master->slaves.registered) {
+          if (!cachedSlaveJson.contains(slave->id)) {
+            cachedSlaveJson[slave->id] = jsonify(Full<Slave>(*slave));
+          }
+
+          pieces->push_back(
+              (count++ > 0 ? "," : "") + cachedSlaveJson.at(slave->id));
+        }
+
+        pieces->push_back("],\"frameworks\":[");
+
+        count = 0;
+        foreachvalue (Framework* framework, master->frameworks.registered) {
+          // Skip filtered out frameworks.
+          if (frameworkIdFilter.isSome() &&
+              frameworkIdFilter.get() != framework->id().value()) {
+            continue;
+          }
+
+          if (!cachedFrameworkJson.contains(framework->id())) {
+            cachedFrameworkJson[framework->id()] = jsonify(
+                FullFrameworkWriter(
+                    tasksApprover, executorsApprover, framework));
+          }
+
+          pieces->push_back(
+              (count++ > 0 ? "," : "") +
+              cachedFrameworkJson.at(framework->id()));
+        }
+
+        pieces->push_back("],\"completed_frameworks\":");
+        pieces->push_back(jsonify(completedFrameworksWriter));
+        pieces->push_back(",\"orphan_tasks\":");
+        pieces->push_back(jsonify(orphanTasksWriter));
+        pieces->push_back(",\"unregistered_frameworks\":");
+        pieces->push_back(jsonify(unregisteredFrameworksWriter));
+        pieces->push_back("}");
+
+        return process::async([pieces, etag]() -> Response {
+          size_t size = 0;
+          foreach (const string& piece, *pieces) {
+            size += piece.size();
+          }
+
+          string body;
+          body.reserve(size);
+
+          foreach (const string& piece, *pieces) {
+            body += piece;
+          }
+
+          OK ok(body);
+          ok.headers["Content-Type"] = "application/json";
+          ok.headers["ETag"] = etag;
+          return ok;
+        });
+      }
+
+      auto state = [&commonFields,
+                    &slavesWriter,
+                    &frameworksWriter,
+                    &completedFrameworksWriter,
+                    &orphanTasksWriter,
+                    &unregisteredFrameworksWriter](JSON::ObjectWriter* writer) {
+        commonFields(writer);
+
+        writer->field("slaves", slavesWriter);
+        writer->field("frameworks", frameworksWriter);
+        writer->field("completed_frameworks", completedFrameworksWriter);
+        writer->field("orphan_tasks", orphanTasksWriter);
+        writer->field("unregistered_frameworks", unregisteredFrameworksWriter);
+      };
+
+      OK ok(jsonify(state), request.url.query.get("jsonp"));
+      ok.headers["ETag"] = etag;
+      return ok;
+    }));
+}
+
+
+void Master::Http::streamState(
+    const std::shared_ptr<StateStreamContext>& context) const
+{
+  size_t batched = 0;
+
+  while (context->slaveIndex < context->slaveIds.size() &&
+         batched < STREAM_BATCH_SIZE) {
+    const SlaveID& slaveId = context->slaveIds[context->slaveIndex++];
+
+    // The agent may have been removed since the ids were snapshot.
+    Slave* slave = master->slaves.registered.get(slaveId);
+    if (slave == nullptr) {
+      continue;
+    }
+
+    // As in the buffered paths, consult the fragment cache when no
+    // authorizer filters the output; see
+    // `Master::Http::invalidateStateCache`.
+    string chunk;
+    if (master->authorizer.isNone()) {
+      if (!cachedSlaveJson.contains(slave->id)) {
+        cachedSlaveJson[slave->id] = jsonify(Full<Slave>(*slave));
+      }
+
+      chunk = cachedSlaveJson.at(slave->id);
+    } else {
+      chunk = jsonify(Full<Slave>(*slave));
+    }
+
+    // A failed write means the read end of the pipe was closed: the
+    // client is gone, so stop serializing.
+    if (!context->writer.write(
+            (context->slavesEmitted++ > 0 ? "," : "") + chunk)) {
+      return;
+    }
+
+    batched++;
+  }
+
+  if (context->slaveIndex < context->slaveIds.size()) {
+    // More agents remain; yield the actor and continue in a separate
+    // dispatch so that other master work can interleave.
+    dispatch(master->self(), [this, context]() {
+      streamState(context);
+    });
+
+    return;
+  }
+
+  if (!context->frameworksStarted) {
+    if (!context->writer.write("],\"frameworks\":[")) {
+      return;
+    }
+
+    context->frameworksStarted = true;
+  }
+
+  while (context->frameworkIndex < context->frameworkIds.size() &&
+         batched < STREAM_BATCH_SIZE) {
+    const FrameworkID& frameworkId =
+      context->frameworkIds[context->frameworkIndex++];
+
+    // The framework may have been removed since the ids were snapshot.
+    Framework* framework =
+      master->frameworks.registered.get(frameworkId).getOrElse(nullptr);
+
+    if (framework == nullptr) {
+      continue;
+    }
+
+    // Skip filtered out frameworks.
+    if (context->frameworkIdFilter.isSome() &&
+        context->frameworkIdFilter.get() != framework->id().value()) {
+      continue;
+    }
+
+    // Skip unauthorized frameworks.
+    if (!approveViewFrameworkInfo(
+            context->frameworksApprover, framework->info)) {
+      continue;
+    }
+
+    string chunk;
+    if (master->authorizer.isNone()) {
+      if (!cachedFrameworkJson.contains(framework->id())) {
+        cachedFrameworkJson[framework->id()] = jsonify(
+            FullFrameworkWriter(
+                context->tasksApprover,
+                context->executorsApprover,
+                framework));
+      }
+
+      chunk = cachedFrameworkJson.at(framework->id());
+    } else {
+      chunk = jsonify(FullFrameworkWriter(
+          context->tasksApprover, context->executorsApprover, framework));
+    }
+
+    if (!context->writer.write(
+            (context->frameworksEmitted++ > 0 ? "," : "") + chunk)) {
+      return;
+    }
+
+    batched++;
+  }
+
+  if (context->frameworkIndex < context->frameworkIds.size()) {
+    dispatch(master->self(), [this, context]() {
+      streamState(context);
+    });
+
+    return;
+  }
+
+  // The tail sections are bounded, so they go out in one final batch.
+  // Failed writes can be ignored here: the response is complete and
+  // the writer is closed either way.
+  context->writer.write("],\"completed_frameworks\":");
+  context->writer.write(jsonify(context->completedFrameworksWriter));
+  context->writer.write(",\"orphan_tasks\":");
+  context->writer.write(jsonify(context->orphanTasksWriter));
+  context->writer.write(",\"unregistered_frameworks\":");
+  context->writer.write(jsonify(context->unregisteredFrameworksWriter));
+  context->writer.write("}");
+
+  context->writer.close();
+}
 
 
 Future<Response> Master::Http::readFile(
@@ -2780,182 +3496,21 @@ Future<Response> Master::Http::readFile(
         UNREACHABLE();
       }
 
-      mesos::master::Response response;
-      response.set_type(mesos::master::Response::READ_FILE);
+      // Constructing the versioned response directly (rather than
+      // evolving an unversioned one) avoids serializing and
+      // re-parsing the file data.
+      v1::master::Response response;
+      response.set_type(v1::master::Response::READ_FILE);
 
       response.mutable_read_file()->set_size(std::get<0>(result.get()));
       response.mutable_read_file()->set_data(std::get<1>(result.get()));
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serialize(contentType, response),
                 stringify(contentType));
     });
 }
 
 
-// This abstraction has no side-effects. It factors out computing the
-// mapping from 'slaves' to 'frameworks' to answer the questions 'what
-// frameworks are running on a given slave?' and 'what slaves are
-// running the given framework?'.
-class SlaveFrameworkMapping
-{
-public:
-  SlaveFrameworkMapping(const hashmap<FrameworkID, Framework*>& frameworks)
-  {
-    foreachpair (const FrameworkID& frameworkId,
-                 const Framework* framework,
-                 frameworks) {
-      foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
-        frameworksToSlaves[frameworkId].insert(taskInfo.slave_id());
-        slavesToFrameworks[taskInfo.slave_id()].insert(frameworkId);
-      }
-
-      foreachvalue (const Task* task, framework->tasks) {
-        frameworksToSlaves[frameworkId].insert(task->slave_id());
-        slavesToFrameworks[task->slave_id()].insert(frameworkId);
-      }
-
-      foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-        frameworksToSlaves[frameworkId].insert(task->slave_id());
-        slavesToFrameworks[task->slave_id()].insert(frameworkId);
-      }
-    }
-  }
-
-  const hashset<FrameworkID>& frameworks(const SlaveID& slaveId) const
-  {
-    const auto iterator = slavesToFrameworks.find(slaveId);
-    return iterator != slavesToFrameworks.end() ?
-      iterator->second : hashset<FrameworkID>::EMPTY;
-  }
-
-  const hashset<SlaveID>& slaves(const FrameworkID& frameworkId) const
-  {
-    const auto iterator = frameworksToSlaves.find(frameworkId);
-    return iterator != frameworksToSlaves.end() ?
-      iterator->second : hashset<SlaveID>::EMPTY;
-  }
-
-private:
-  hashmap<SlaveID, hashset<FrameworkID>> slavesToFrameworks;
-  hashmap<FrameworkID, hashset<SlaveID>> frameworksToSlaves;
-};
-
-
-// This abstraction has no side-effects. It factors out the accounting
-// for a 'TaskState' summary. We use this to summarize 'TaskState's
-// for both frameworks as well as slaves.
-struct TaskStateSummary
-{
-  // TODO(jmlvanre): Possibly clean this up as per MESOS-2694.
-  const static TaskStateSummary EMPTY;
-
-  TaskStateSummary()
-    : staging(0),
-      starting(0),
-      running(0),
-      killing(0),
-      finished(0),
-      killed(0),
-      failed(0),
-      lost(0),
-      error(0),
-      dropped(0),
-      unreachable(0),
-      gone(0),
-      gone_by_operator(0),
-      unknown(0) {}
-
-  // Account for the state of the given task.
-  void count(const Task& task)
-  {
-    switch (task.state()) {
-      case TASK_STAGING: { ++staging; break; }
-      case TASK_STARTING: { ++starting; break; }
-      case TASK_RUNNING: { ++running; break; }
-      case TASK_KILLING: { ++killing; break; }
-      case TASK_FINISHED: { ++finished; break; }
-      case TASK_KILLED: { ++killed; break; }
-      case TASK_FAILED: { ++failed; break; }
-      case TASK_LOST: { ++lost; break; }
-      case TASK_ERROR: { ++error; break; }
-      case TASK_DROPPED: { ++dropped; break; }
-      case TASK_UNREACHABLE: { ++unreachable; break; }
-      case TASK_GONE: { ++gone; break; }
-      case TASK_GONE_BY_OPERATOR: { ++gone_by_operator; break; }
-      case TASK_UNKNOWN: { ++unknown; break; }
-      // No default case allows for a helpful compiler error if we
-      // introduce a new state.
-    }
-  }
-
-  size_t staging;
-  size_t starting;
-  size_t running;
-  size_t killing;
-  size_t finished;
-  size_t killed;
-  size_t failed;
-  size_t lost;
-  size_t error;
-  size_t dropped;
-  size_t unreachable;
-  size_t gone;
-  size_t gone_by_operator;
-  size_t unknown;
-};
-
-
-const TaskStateSummary TaskStateSummary::EMPTY;
-
-
-// This abstraction has no side-effects. It factors out computing the
-// 'TaskState' summaries for frameworks and slaves. This answers the
-// questions 'How many tasks are in each state for a given framework?'
-// and 'How many tasks are in each state for a given slave?'.
-class TaskStateSummaries
-{
-public:
-  TaskStateSummaries(const hashmap<FrameworkID, Framework*>& frameworks)
-  {
-    foreachpair (const FrameworkID& frameworkId,
-                 const Framework* framework,
-                 frameworks) {
-      foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
-        frameworkTaskSummaries[frameworkId].staging++;
-        slaveTaskSummaries[taskInfo.slave_id()].staging++;
-      }
-
-      foreachvalue (const Task* task, framework->tasks) {
-        frameworkTaskSummaries[frameworkId].count(*task);
-        slaveTaskSummaries[task->slave_id()].count(*task);
-      }
-
-      foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-        frameworkTaskSummaries[frameworkId].count(*task);
-        slaveTaskSummaries[task->slave_id()].count(*task);
-      }
-    }
-  }
-
-  const TaskStateSummary& framework(const FrameworkID& frameworkId) const
-  {
-    const auto iterator = frameworkTaskSummaries.find(frameworkId);
-    return iterator != frameworkTaskSummaries.end() ?
-      iterator->second : TaskStateSummary::EMPTY;
-  }
-
-  const TaskStateSummary& slave(const SlaveID& slaveId) const
-  {
-    const auto iterator = slaveTaskSummaries.find(slaveId);
-    return iterator != slaveTaskSummaries.end() ?
-      iterator->second : TaskStateSummary::EMPTY;
-  }
-private:
-  hashmap<FrameworkID, TaskStateSummary> frameworkTaskSummaries;
-  hashmap<SlaveID, TaskStateSummary> slaveTaskSummaries;
-};
-
-
 string Master::Http::STATESUMMARY_HELP()
 {
   return HELP(
@@ -3009,6 +3564,28 @@ Future<Response> Master::Http::stateSummary(
         master->self(),
         [this, request](const Owned<ObjectApprover>& frameworksApprover)
           -> Response {
+      // Support conditional requests, as in `state()`.
+      const string etag = stateETag();
+
+      if (request.headers.get("If-None-Match") == Option<string>(etag)) {
+        return NotModified(etag);
+      }
+
+      // As in `frameworks()` above, answer from the cached response
+      // body when nothing has changed since it was serialized.
+      const bool cacheable =
+        master->authorizer.isNone() &&
+        request.url.query.get("jsonp").isNone();
+
+      if (cacheable &&
+          cachedStateSummaryResponse.isSome() &&
+          cachedStateSummaryResponse->generation == stateGeneration) {
+        OK ok(cachedStateSummaryResponse->body);
+        ok.headers["Content-Type"] = "application/json";
+        ok.headers["ETag"] = etag;
+        return ok;
+      }
+
       auto stateSummary =
           [this, &frameworksApprover](JSON::ObjectWriter* writer) {
         writer->field("hostname", master->info().hostname());
@@ -3017,35 +3594,28 @@ Future<Response> Master::Http::stateSummary(
           writer->field("cluster", master->flags.cluster.get());
         }
 
-        // We use the tasks in the 'Frameworks' struct to compute summaries
-        // for this endpoint. This is done 1) for consistency between the
-        // 'slaves' and 'frameworks' subsections below 2) because we want to
-        // provide summary information for frameworks that are currently
-        // registered 3) the frameworks keep a circular buffer of completed
-        // tasks that we can use to keep a limited view on the history of
-        // recent completed / failed tasks.
-
-        // Generate mappings from 'slave' to 'framework' and reverse.
-        SlaveFrameworkMapping slaveFrameworkMapping(
-            master->frameworks.registered);
-
-        // Generate 'TaskState' summaries for all framework and slave ids.
-        TaskStateSummaries taskStateSummaries(master->frameworks.registered);
+        // The 'TaskState' summaries and the mapping between frameworks
+        // and agents are maintained incrementally by the master as
+        // tasks are added, updated and removed (see
+        // Master::TaskStateSummaries), so this endpoint does not have
+        // to iterate the tasks. Like the summaries that were
+        // previously computed here from the 'Frameworks' struct, they
+        // cover the pending, active and (recent) completed tasks of
+        // the registered frameworks.
+        const Master::TaskStateSummaries& summaries =
+          master->taskStateSummaries;
 
         // Model all of the slaves.
         writer->field(
             "slaves",
-            [this, &slaveFrameworkMapping, &taskStateSummaries](
-                JSON::ArrayWriter* writer) {
+            [this, &summaries](JSON::ArrayWriter* writer) {
           foreachvalue (Slave* slave, master->slaves.registered) {
             writer->element(
-                [&slave, &slaveFrameworkMapping, &taskStateSummaries](
-                    JSON::ObjectWriter* writer) {
+                [&slave, &summaries](JSON::ObjectWriter* writer) {
               json(writer, Summary<Slave>(*slave));
 
               // Add the 'TaskState' summary for this slave.
-              const TaskStateSummary& summary =
-                taskStateSummaries.slave(slave->id);
+              const TaskStateSummary& summary = summaries.slave(slave->id);
 
               // TODO(neilc): Update for new PARTITION_AWARE task statuses.
               writer->field("TASK_STAGING", summary.staging);
@@ -3059,13 +3629,13 @@ Future<Response> Master::Http::stateSummary(
               writer->field("TASK_ERROR", summary.error);
 
               // Add the ids of all the frameworks running on this slave.
-              const hashset<FrameworkID>& frameworks =
-                slaveFrameworkMapping.frameworks(slave->id);
+              const hashmap<FrameworkID, size_t>& frameworks =
+                summaries.frameworks(slave->id);
 
               writer->field(
                   "framework_ids",
                   [&frameworks](JSON::ArrayWriter* writer) {
-                foreach (const FrameworkID& frameworkId, frameworks) {
+                foreachkey (const FrameworkID& frameworkId, frameworks) {
                   writer->element(frameworkId.value());
                 }
               });
@@ -3076,10 +3646,7 @@ Future<Response> Master::Http::stateSummary(
         // Model all of the frameworks.
         writer->field(
             "frameworks",
-            [this,
-             &slaveFrameworkMapping,
-             &taskStateSummaries,
-             &frameworksApprover](JSON::ArrayWriter* writer) {
+            [this, &summaries, &frameworksApprover](JSON::ArrayWriter* writer) {
           foreachpair (const FrameworkID& frameworkId,
                        Framework* framework,
                        master->frameworks.registered) {
@@ -3093,13 +3660,12 @@ Future<Response> Master::Http::stateSummary(
             writer->element(
                 [&frameworkId,
                  &framework,
-                 &slaveFrameworkMapping,
-                 &taskStateSummaries](JSON::ObjectWriter* writer) {
+                 &summaries](JSON::ObjectWriter* writer) {
               json(writer, Summary<Framework>(*framework));
 
               // Add the 'TaskState' summary for this framework.
               const TaskStateSummary& summary =
-                taskStateSummaries.framework(frameworkId);
+                summaries.framework(frameworkId);
 
               // TODO(neilc): Update for new PARTITION_AWARE task statuses.
               writer->field("TASK_STAGING", summary.staging);
@@ -3113,11 +3679,11 @@ Future<Response> Master::Http::stateSummary(
               writer->field("TASK_ERROR", summary.error);
 
               // Add the ids of all the slaves running this framework.
-              const hashset<SlaveID>& slaves =
-                slaveFrameworkMapping.slaves(frameworkId);
+              const hashmap<SlaveID, size_t>& slaves =
+                summaries.slaves(frameworkId);
 
               writer->field("slave_ids", [&slaves](JSON::ArrayWriter* writer) {
-                foreach (const SlaveID& slaveId, slaves) {
+                foreachkey (const SlaveID& slaveId, slaves) {
                   writer->element(slaveId.value());
                 }
               });
@@ -3126,7 +3692,19 @@ Future<Response> Master::Http::stateSummary(
         });
       };
 
-      return OK(jsonify(stateSummary), request.url.query.get("jsonp"));
+      if (cacheable) {
+        cachedStateSummaryResponse =
+          CachedResponse{stateGeneration, jsonify(stateSummary)};
+
+        OK ok(cachedStateSummaryResponse->body);
+        ok.headers["Content-Type"] = "application/json";
+        ok.headers["ETag"] = etag;
+        return ok;
+      }
+
+      OK ok(jsonify(stateSummary), request.url.query.get("jsonp"));
+      ok.headers["ETag"] = etag;
+      return ok;
     }));
 }
 
@@ -3135,6 +3713,7 @@ Future<Response> Master::Http::stateSummary(
 JSON::Object model(
     const string& name,
     Option<double> weight,
+    const Resources& allocated,
     Option<Role*> _role)
 {
   JSON::Object object;
@@ -3146,14 +3725,13 @@ JSON::Object model(
     object.values["weight"] = 1.0; // Default weight.
   }
 
+  object.values["resources"] = model(allocated);
+
   if (_role.isNone()) {
-    object.values["resources"] = model(Resources());
     object.values["frameworks"] = JSON::Array();
   } else {
     Role* role = _role.get();
 
-    object.values["resources"] = model(role->resources());
-
     {
       JSON::Array array;
 
@@ -3284,7 +3862,12 @@ Future<Response> Master::Http::roles(
             role = master->activeRoles[name];
           }
 
-          array.values.push_back(model(name, weight, role));
+          // The allocation total is maintained incrementally rather
+          // than summed over the role's frameworks per request.
+          const Resources allocated =
+            master->roleResources.get(name).getOrElse(Resources());
+
+          array.values.push_back(model(name, weight, allocated, role));
         }
 
         object.values["roles"] = std::move(array);
@@ -3376,7 +3959,10 @@ Future<Response> Master::Http::getRoles(
         if (master->activeRoles.contains(name)) {
           Role* role_ = master->activeRoles[name];
 
-          role.mutable_resources()->CopyFrom(role_->resources());
+          // The allocation total is maintained incrementally rather
+          // than summed over the role's frameworks per request.
+          role.mutable_resources()->CopyFrom(
+              master->roleResources.get(name).getOrElse(Resources()));
 
           foreachkey (const FrameworkID& frameworkId, role_->frameworks) {
             role.add_frameworks()->CopyFrom(frameworkId);
@@ -3561,7 +4147,17 @@ string Master::Http::TASKS_HELP()
         "(default is " + stringify(TASK_LIMIT) + ").",
         ">        offset=VALUE         Starts task list at offset.",
         ">        order=(asc|desc)     Ascending or descending sort order "
-        "(default is descending)."
+        "(default is descending).",
+        ">        framework_id=VALUE   Only return tasks belonging to the "
+        "framework with this ID.",
+        ">        slave_id=VALUE       Only return tasks running on the "
+        "agent with this ID.",
+        ">        state=VALUE          Only return tasks in this state "
+        "(e.g. `TASK_RUNNING`).",
+        ">        fields=F1,F2,...     Only emit the named task fields "
+        "(e.g. `id,state`).",
+        ">        streaming=true       Deliver the response as a chunked "
+        "stream (one chunk per task); ignored if `jsonp` is specified."
         ""),
     AUTHENTICATION(true),
     AUTHORIZATION(
@@ -3591,6 +4187,24 @@ Future<Response> Master::Http::tasks(
   Option<string> order = request.url.query.get("order");
   string _order = order.isSome() && (order.get() == "asc") ? "asc" : "des";
 
+  // Server-side filtering: restrict the result to tasks of a given
+  // framework, running on a given agent, or in a given state.
+  Option<string> frameworkIdFilter = request.url.query.get("framework_id");
+  Option<string> slaveIdFilter = request.url.query.get("slave_id");
+  Option<string> stateFilter = request.url.query.get("state");
+
+  // Field projection: emit only the named task fields (e.g.,
+  // "?fields=id,state" when reconciling), so that clients do not have
+  // to transfer fields they discard.
+  Option<hashset<string>> fields;
+  if (request.url.query.get("fields").isSome()) {
+    fields = hashset<string>();
+    foreach (const string& field,
+             strings::tokenize(request.url.query.get("fields").get(), ",")) {
+      fields->insert(field);
+    }
+  }
+
   // Retrieve Approvers for authorizing frameworks and tasks.
   Future<Owned<ObjectApprover>> frameworksApprover;
   Future<Owned<ObjectApprover>> tasksApprover;
@@ -3623,6 +4237,12 @@ Future<Response> Master::Http::tasks(
       // Construct framework list with both active and completed frameworks.
       vector<const Framework*> frameworks;
       foreachvalue (Framework* framework, master->frameworks.registered) {
+        // Skip filtered out frameworks.
+        if (frameworkIdFilter.isSome() &&
+            frameworkIdFilter.get() != framework->id().value()) {
+          continue;
+        }
+
         // Skip unauthorized frameworks.
         if (!approveViewFrameworkInfo(frameworksApprover, framework->info)) {
           continue;
@@ -3633,6 +4253,12 @@ Future<Response> Master::Http::tasks(
 
       foreach (const std::shared_ptr<Framework>& framework,
                master->frameworks.completed) {
+        // Skip filtered out frameworks.
+        if (frameworkIdFilter.isSome() &&
+            frameworkIdFilter.get() != framework->id().value()) {
+          continue;
+        }
+
         // Skip unauthorized frameworks.
         if (!approveViewFrameworkInfo(frameworksApprover, framework->info)) {
           continue;
@@ -3641,25 +4267,143 @@ Future<Response> Master::Http::tasks(
         frameworks.push_back(framework.get());
       }
 
+      // Returns whether the task passes the query filters.
+      auto filtered = [&slaveIdFilter, &stateFilter](const Task& task) {
+        if (slaveIdFilter.isSome() &&
+            slaveIdFilter.get() != task.slave_id().value()) {
+          return true;
+        }
+
+        if (stateFilter.isSome() &&
+            stateFilter.get() != TaskState_Name(task.state())) {
+          return true;
+        }
+
+        return false;
+      };
+
       // Construct task list with both running and finished tasks.
       vector<const Task*> tasks;
-      foreach (const Framework* framework, frameworks) {
-        foreachvalue (Task* task, framework->tasks) {
+
+      // When filtering by state or by agent, serve the live tasks
+      // from the master's secondary indexes (`Master::tasksByState`
+      // and the per-agent task map) instead of walking every task of
+      // every framework. The indexes only cover live tasks; completed
+      // tasks are scanned below either way, but those buffers are
+      // bounded.
+      Option<TaskState> taskState = None();
+      if (stateFilter.isSome()) {
+        TaskState parsed;
+        if (TaskState_Parse(stateFilter.get(), &parsed)) {
+          taskState = parsed;
+        }
+      }
+
+      if (taskState.isSome() || slaveIdFilter.isSome()) {
+        // Index the (filtered and authorized) frameworks by id. If a
+        // framework appears both as registered and as completed, keep
+        // the registered entry, which comes first.
+        hashmap<FrameworkID, const Framework*> frameworkIds;
+        foreach (const Framework* framework, frameworks) {
+          if (!frameworkIds.contains(framework->id())) {
+            frameworkIds[framework->id()] = framework;
+          }
+        }
+
+        // Appends a live task if it passes the framework, query
+        // filter and authorization checks. Orphan tasks, whose
+        // framework has not re-registered, are not exposed by this
+        // endpoint.
+        auto append = [&](Task* task) {
           CHECK_NOTNULL(task);
+
+          Option<const Framework*> framework =
+            frameworkIds.get(task->framework_id());
+
+          if (framework.isNone() ||
+              !framework.get()->tasks.contains(task->task_id())) {
+            return;
+          }
+
+          // Skip filtered out tasks.
+          if (filtered(*task)) {
+            return;
+          }
+
           // Skip unauthorized tasks.
-          if (!approveViewTask(tasksApprover, *task, framework->info)) {
-            continue;
+          if (!approveViewTask(tasksApprover, *task, framework.get()->info)) {
+            return;
           }
 
           tasks.push_back(task);
+        };
+
+        if (taskState.isSome()) {
+          if (master->tasksByState.contains(taskState.get())) {
+            foreach (Task* task, master->tasksByState.at(taskState.get())) {
+              append(task);
+            }
+          }
+        } else {
+          SlaveID slaveId;
+          slaveId.set_value(slaveIdFilter.get());
+
+          Slave* slave = master->slaves.registered.get(slaveId);
+          if (slave != nullptr) {
+            foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+              foreachvalue (Task* task, slave->tasks.at(frameworkId)) {
+                append(task);
+              }
+            }
+          }
         }
-        foreach (const std::shared_ptr<Task>& task, framework->completedTasks) {
-          // Skip unauthorized tasks.
-          if (!approveViewTask(tasksApprover, *task.get(), framework->info)) {
-            continue;
+
+        foreach (const Framework* framework, frameworks) {
+          foreach (const std::shared_ptr<Task>& task,
+                   framework->completedTasks) {
+            // Skip filtered out tasks.
+            if (filtered(*task)) {
+              continue;
+            }
+
+            // Skip unauthorized tasks.
+            if (!approveViewTask(tasksApprover, *task.get(), framework->info)) {
+              continue;
+            }
+
+            tasks.push_back(task.get());
           }
+        }
+      } else {
+        foreach (const Framework* framework, frameworks) {
+          foreachvalue (Task* task, framework->tasks) {
+            CHECK_NOTNULL(task);
+            // Skip filtered out tasks.
+            if (filtered(*task)) {
+              continue;
+            }
+
+            // Skip unauthorized tasks.
+            if (!approveViewTask(tasksApprover, *task, framework->info)) {
+              continue;
+            }
+
+            tasks.push_back(task);
+          }
+          foreach (const std::shared_ptr<Task>& task,
+                   framework->completedTasks) {
+            // Skip filtered out tasks.
+            if (filtered(*task)) {
+              continue;
+            }
+
+            // Skip unauthorized tasks.
+            if (!approveViewTask(tasksApprover, *task.get(), framework->info)) {
+              continue;
+            }
 
-          tasks.push_back(task.get());
+            tasks.push_back(task.get());
+          }
         }
       }
 
@@ -3672,22 +4416,207 @@ Future<Response> Master::Http::tasks(
         sort(tasks.begin(), tasks.end(), TaskComparator::descending);
       }
 
-      auto tasksWriter = [&tasks, limit, offset](JSON::ObjectWriter* writer) {
-        writer->field("tasks",
-                      [&tasks, limit, offset](JSON::ArrayWriter* writer) {
-          // Collect 'limit' number of tasks starting from 'offset'.
-          size_t end = std::min(offset + limit, tasks.size());
-          for (size_t i = offset; i < end; i++) {
-            writer->element(*tasks[i]);
+      // Writes one task, restricted to the requested fields if a
+      // projection was specified. This mirrors the full task model in
+      // "src/common/http.cpp".
+      //
+      // NOTE: Captures by value: the streamed path stows this writer
+      // away in its context and invokes it from a later dispatch,
+      // after the enclosing lambda has returned.
+      auto taskWriter = [fields](JSON::ObjectWriter* writer,
+                                 const Task& task) {
+        if (fields.isNone()) {
+          json(writer, task);
+          return;
+        }
+
+        if (fields->contains("id")) {
+          writer->field("id", task.task_id().value());
+        }
+
+        if (fields->contains("name")) {
+          writer->field("name", task.name());
+        }
+
+        if (fields->contains("framework_id")) {
+          writer->field("framework_id", task.framework_id().value());
+        }
+
+        if (fields->contains("executor_id")) {
+          writer->field("executor_id", task.executor_id().value());
+        }
+
+        if (fields->contains("slave_id")) {
+          writer->field("slave_id", task.slave_id().value());
+        }
+
+        if (fields->contains("state")) {
+          writer->field("state", TaskState_Name(task.state()));
+        }
+
+        if (fields->contains("resources")) {
+          writer->field("resources", Resources(task.resources()));
+        }
+
+        if (fields->contains("statuses")) {
+          writer->field("statuses", task.statuses());
+        }
+
+        if (fields->contains("user") && task.has_user()) {
+          writer->field("user", task.user());
+        }
+
+        if (fields->contains("labels") && task.has_labels()) {
+          writer->field("labels", task.labels());
+        }
+
+        if (fields->contains("discovery") && task.has_discovery()) {
+          writer->field("discovery", JSON::Protobuf(task.discovery()));
+        }
+
+        if (fields->contains("container") && task.has_container()) {
+          writer->field("container", JSON::Protobuf(task.container()));
+        }
+      };
+
+      // As for "/state", "?streaming=true" (without "jsonp") yields a
+      // chunked response: it is returned right away and the selected
+      // window of tasks is then serialized in batches of
+      // `STREAM_BATCH_SIZE` via separate dispatches onto the master
+      // actor (see `streamTasks`), so neither is the entire response
+      // string built up in memory, nor is the actor blocked for the
+      // whole serialization.
+      if (request.url.query.get("streaming") == Option<string>("true") &&
+          request.url.query.get("jsonp").isNone()) {
+        Pipe pipe;
+        OK ok;
+
+        ok.headers["Content-Type"] = "application/json";
+        ok.type = Response::PIPE;
+        ok.reader = pipe.reader();
+
+        auto context = std::make_shared<TasksStreamContext>(pipe.writer());
+        context->taskWriter = taskWriter;
+
+        // Index the completed tasks, which are only kept alive by
+        // their frameworks' bounded buffers: the stream takes shared
+        // ownership of the ones in its window so that eviction between
+        // batches cannot leave it with dangling pointers. Live tasks
+        // are instead looked up again per batch and skipped if gone.
+        hashmap<const Task*, std::shared_ptr<Task>> completed;
+        foreach (const Framework* framework, frameworks) {
+          foreach (const std::shared_ptr<Task>& task,
+                   framework->completedTasks) {
+            completed.put(task.get(), task);
+          }
+        }
+
+        // Stream 'limit' number of tasks starting from 'offset'.
+        size_t end = std::min(offset + limit, tasks.size());
+        for (size_t i = offset; i < end; i++) {
+          TasksStreamContext::Entry entry;
+          entry.frameworkId = tasks[i]->framework_id();
+          entry.taskId = tasks[i]->task_id();
+
+          Option<std::shared_ptr<Task>> task = completed.get(tasks[i]);
+          if (task.isSome()) {
+            entry.completed = task.get();
           }
+
+          context->entries.push_back(std::move(entry));
+        }
+
+        context->writer.write("{\"tasks\":[");
+
+        dispatch(master->self(), [this, context]() {
+          streamTasks(context);
         });
-      };
+
+        return ok;
+      }
+
+      auto tasksWriter =
+        [&tasks, &taskWriter, limit, offset](JSON::ObjectWriter* writer) {
+          writer->field(
+              "tasks",
+              [&tasks, &taskWriter, limit, offset](JSON::ArrayWriter* writer) {
+            // Collect 'limit' number of tasks starting from 'offset'.
+            size_t end = std::min(offset + limit, tasks.size());
+            for (size_t i = offset; i < end; i++) {
+              writer->element(
+                  [&taskWriter, &tasks, i](JSON::ObjectWriter* writer) {
+                    taskWriter(writer, *tasks[i]);
+                  });
+            }
+          });
+        };
 
       return OK(jsonify(tasksWriter), request.url.query.get("jsonp"));
   }));
 }
 
 
+void Master::Http::streamTasks(
+    const std::shared_ptr<TasksStreamContext>& context) const
+{
+  size_t batched = 0;
+
+  while (context->index < context->entries.size() &&
+         batched < STREAM_BATCH_SIZE) {
+    const TasksStreamContext::Entry& entry =
+      context->entries[context->index++];
+
+    const Task* task = entry.completed.get();
+
+    if (task == nullptr) {
+      // The task was live when the stream started; it may have been
+      // removed (or moved into the completed buffer) since, in which
+      // case it is skipped rather than held onto across dispatches.
+      Framework* framework =
+        master->frameworks.registered.get(entry.frameworkId)
+          .getOrElse(nullptr);
+
+      if (framework == nullptr) {
+        continue;
+      }
+
+      Option<Task*> lookup = framework->tasks.get(entry.taskId);
+      if (lookup.isNone()) {
+        continue;
+      }
+
+      task = lookup.get();
+    }
+
+    auto element = [context, task](JSON::ObjectWriter* writer) {
+      context->taskWriter(writer, *task);
+    };
+
+    // A failed write means the read end of the pipe was closed: the
+    // client is gone, so stop serializing.
+    if (!context->writer.write(
+            (context->emitted++ > 0 ? "," : "") + string(jsonify(element)))) {
+      return;
+    }
+
+    batched++;
+  }
+
+  if (context->index < context->entries.size()) {
+    // More tasks remain; yield the actor and continue in a separate
+    // dispatch so that other master work can interleave.
+    dispatch(master->self(), [this, context]() {
+      streamTasks(context);
+    });
+
+    return;
+  }
+
+  context->writer.write("]}");
+  context->writer.close();
+}
+
+
 Future<Response> Master::Http::getTasks(
     const mesos::master::Call& call,
     const Option<string>& principal,
@@ -428,7 +428,10 @@ int main(int argc, char** argv)
           flags.log_auto_initialize,
           "registrar/");
     }
-    storage = new LogStorage(log);
+    storage = new LogStorage(
+        log,
+        flags.registry_diffs_between_snapshots,
+        flags.registry_standby_catchup_interval);
   } else {
     EXIT(EXIT_FAILURE)
       << "'" << flags.registry << "' is not a supported"
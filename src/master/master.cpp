@@ -21,9 +21,12 @@
 #include <fstream>
 #include <iomanip>
 #include <list>
+#include <map>
 #include <memory>
+#include <queue>
 #include <set>
 #include <sstream>
+#include <utility>
 
 #include <mesos/module.hpp>
 #include <mesos/roles.hpp>
@@ -40,6 +43,7 @@
 
 #include <mesos/scheduler/scheduler.hpp>
 
+#include <process/async.hpp>
 #include <process/check.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
@@ -51,8 +55,13 @@
 #include <process/run.hpp>
 #include <process/shared.hpp>
 
+#ifdef USE_SSL_SOCKET
+#include <process/ssl/flags.hpp>
+#endif
+
 #include <process/metrics/metrics.hpp>
 
+#include <stout/base64.hpp>
 #include <stout/check.hpp>
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
@@ -70,6 +79,10 @@
 #include <stout/utils.hpp>
 #include <stout/uuid.hpp>
 
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/read.hpp>
+
 #include "authentication/cram_md5/authenticator.hpp"
 
 #include "common/build.hpp"
@@ -83,6 +96,7 @@
 #include "logging/flags.hpp"
 #include "logging/logging.hpp"
 
+#include "master/archive.hpp"
 #include "master/flags.hpp"
 #include "master/master.hpp"
 #include "master/weights.hpp"
@@ -99,6 +113,7 @@ using std::shared_ptr;
 using std::string;
 using std::vector;
 
+using process::async;
 using process::await;
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Clock;
@@ -132,87 +147,136 @@ using mesos::master::detector::MasterDetector;
 
 static bool isValidFailoverTimeout(const FrameworkInfo& frameworkinfo);
 
+// Observes the liveness of all registered agents: each agent is
+// pinged periodically and the master is asked to mark an agent
+// unreachable once it misses too many pings in a row. A single
+// process observes every agent; the agents are spread over the slots
+// of a timing wheel that completes one revolution per ping interval,
+// so each tick sends a batch of pings rather than scheduling a timer
+// (and a dispatch) per agent. This keeps both the master actor and
+// the clock out of the per-agent ping path.
 class SlaveObserver : public ProtobufProcess<SlaveObserver>
 {
 public:
-  SlaveObserver(const UPID& _slave,
-                const SlaveInfo& _slaveInfo,
-                const SlaveID& _slaveId,
-                const PID<Master>& _master,
+  SlaveObserver(const PID<Master>& _master,
                 const Option<shared_ptr<RateLimiter>>& _limiter,
                 const shared_ptr<Metrics> _metrics,
                 const Duration& _slavePingTimeout,
                 const size_t _maxSlavePingTimeouts)
     : ProcessBase(process::ID::generate("slave-observer")),
-      slave(_slave),
-      slaveInfo(_slaveInfo),
-      slaveId(_slaveId),
       master(_master),
       limiter(_limiter),
       metrics(_metrics),
       slavePingTimeout(_slavePingTimeout),
       maxSlavePingTimeouts(_maxSlavePingTimeouts),
-      timeouts(0),
-      pinged(false),
-      connected(true)
+      wheel(AGENT_PING_WHEEL_SLOTS),
+      current(0)
   {
     install<PongSlaveMessage>(&SlaveObserver::pong);
   }
 
-  void reconnect()
+  void observe(const UPID& pid, const SlaveID& slaveId)
   {
-    connected = true;
+    // Observing an agent anew (e.g., it was removed and registered
+    // again at the same address) resets its liveness state.
+    forget(pid);
+
+    Observed observed;
+    observed.slaveId = slaveId;
+    observed.slot = current;
+
+    slaves[pid] = observed;
+
+    // The first ping goes out on the next tick; subsequent pings
+    // follow once per wheel revolution, i.e., every ping interval.
+    wheel[current].insert(pid);
   }
 
-  void disconnect()
+  void forget(const UPID& pid)
   {
-    connected = false;
+    if (!slaves.contains(pid)) {
+      return;
+    }
+
+    Observed& observed = slaves.at(pid);
+
+    // Cancel any pending unreachable transition.
+    if (observed.markingUnreachable.isSome()) {
+      // Need a copy for non-const access.
+      Future<Nothing> future = observed.markingUnreachable.get();
+      future.discard();
+    }
+
+    wheel[observed.slot].erase(pid);
+    slaves.erase(pid);
   }
 
-protected:
-  virtual void initialize()
+  void reconnect(const UPID& pid)
   {
-    ping();
+    if (slaves.contains(pid)) {
+      slaves.at(pid).connected = true;
+    }
   }
 
-  void ping()
+  void disconnect(const UPID& pid)
   {
-    PingSlaveMessage message;
-    message.set_connected(connected);
-    send(slave, message);
+    if (slaves.contains(pid)) {
+      slaves.at(pid).connected = false;
+    }
+  }
 
-    pinged = true;
-    delay(slavePingTimeout, self(), &SlaveObserver::timeout);
+protected:
+  virtual void initialize()
+  {
+    tick();
   }
 
-  void pong()
+  void tick()
   {
-    timeouts = 0;
-    pinged = false;
+    foreach (const UPID& pid, wheel[current]) {
+      Observed& observed = slaves.at(pid);
+
+      if (observed.pinged) {
+        observed.timeouts++; // No pong has been received before the timeout.
+        if (observed.timeouts >= maxSlavePingTimeouts) {
+          // No pong has been received for the last
+          // 'maxSlavePingTimeouts' pings.
+          markUnreachable(pid);
+        }
+      }
 
-    // Cancel any pending unreachable transitions.
-    if (markingUnreachable.isSome()) {
-      // Need a copy for non-const access.
-      Future<Nothing> future = markingUnreachable.get();
-      future.discard();
+      // NOTE: We keep pinging even if we schedule a transition to
+      // UNREACHABLE. This is because if the slave eventually responds
+      // to a ping, we can cancel the UNREACHABLE transition.
+      PingSlaveMessage message;
+      message.set_connected(observed.connected);
+      send(pid, message);
+
+      observed.pinged = true;
     }
+
+    current = (current + 1) % wheel.size();
+
+    delay(slavePingTimeout / wheel.size(), self(), &SlaveObserver::tick);
   }
 
-  void timeout()
+  void pong(const UPID& from)
   {
-    if (pinged) {
-      timeouts++; // No pong has been received before the timeout.
-      if (timeouts >= maxSlavePingTimeouts) {
-        // No pong has been received for the last
-        // 'maxSlavePingTimeouts' pings.
-        markUnreachable();
-      }
+    if (!slaves.contains(from)) {
+      return;
     }
 
-    // NOTE: We keep pinging even if we schedule a transition to
-    // UNREACHABLE. This is because if the slave eventually responds
-    // to a ping, we can cancel the UNREACHABLE transition.
-    ping();
+    Observed& observed = slaves.at(from);
+
+    observed.timeouts = 0;
+    observed.pinged = false;
+
+    // Cancel any pending unreachable transitions.
+    if (observed.markingUnreachable.isSome()) {
+      // Need a copy for non-const access.
+      Future<Nothing> future = observed.markingUnreachable.get();
+      future.discard();
+    }
   }
 
   // Marking slaves unreachable is rate-limited and can be canceled if
@@ -224,60 +288,81 @@ protected:
   // agent reregisters, so a rate-limit is a useful safety
   // precaution. Once all frameworks are PARTITION_AWARE, we can
   // likely remove the rate-limit (MESOS-5948).
-  void markUnreachable()
+  void markUnreachable(const UPID& pid)
   {
-    if (markingUnreachable.isSome()) {
+    Observed& observed = slaves.at(pid);
+
+    if (observed.markingUnreachable.isSome()) {
       return; // Unreachable transition is already in progress.
     }
 
     Future<Nothing> acquire = Nothing();
 
     if (limiter.isSome()) {
-      LOG(INFO) << "Scheduling transition of agent " << slaveId
+      LOG(INFO) << "Scheduling transition of agent " << observed.slaveId
                 << " to UNREACHABLE because of health check timeout";
 
       acquire = limiter.get()->acquire();
     }
 
-    markingUnreachable = acquire.onAny(defer(self(), &Self::_markUnreachable));
+    observed.markingUnreachable =
+      acquire.onAny(defer(self(), &Self::_markUnreachable, pid, lambda::_1));
     ++metrics->slave_unreachable_scheduled;
   }
 
-  void _markUnreachable()
+  void _markUnreachable(const UPID& pid, const Future<Nothing>& future)
   {
-    CHECK_SOME(markingUnreachable);
+    if (!slaves.contains(pid)) {
+      return; // The agent was forgotten in the interim.
+    }
+
+    Observed& observed = slaves.at(pid);
 
-    const Future<Nothing>& future = markingUnreachable.get();
+    // Ignore stale callbacks that are not for the currently pending
+    // transition (e.g., the agent was forgotten and observed again
+    // at the same address in the interim).
+    if (observed.markingUnreachable.isNone() ||
+        observed.markingUnreachable.get() != future) {
+      return;
+    }
 
     CHECK(!future.isFailed());
 
     if (future.isReady()) {
       ++metrics->slave_unreachable_completed;
 
-      dispatch(master, &Master::markUnreachable, slaveId);
+      dispatch(master, &Master::markUnreachable, observed.slaveId);
     } else if (future.isDiscarded()) {
-      LOG(INFO) << "Canceling transition of agent " << slaveId
+      LOG(INFO) << "Canceling transition of agent " << observed.slaveId
                 << " to UNREACHABLE because a pong was received!";
 
       ++metrics->slave_unreachable_canceled;
     }
 
-    markingUnreachable = None();
+    observed.markingUnreachable = None();
   }
 
 private:
-  const UPID slave;
-  const SlaveInfo slaveInfo;
-  const SlaveID slaveId;
+  // Per-agent liveness state.
+  struct Observed
+  {
+    SlaveID slaveId;
+    size_t slot = 0; // The timing wheel slot the agent lives in.
+    uint32_t timeouts = 0;
+    bool pinged = false;
+    bool connected = true;
+    Option<Future<Nothing>> markingUnreachable;
+  };
+
   const PID<Master> master;
   const Option<shared_ptr<RateLimiter>> limiter;
   shared_ptr<Metrics> metrics;
-  Option<Future<Nothing>> markingUnreachable;
   const Duration slavePingTimeout;
   const size_t maxSlavePingTimeouts;
-  uint32_t timeouts;
-  bool pinged;
-  bool connected;
+
+  hashmap<UPID, Observed> slaves;
+  std::vector<hashset<UPID>> wheel; // Agents to visit at each tick.
+  size_t current; // The slot to visit at the next tick.
 };
 
 
@@ -300,6 +385,7 @@ Master::Master(
     detector(_detector),
     authorizer(_authorizer),
     frameworks(flags),
+    reconciler(new Reconciler(self())),
     authenticator(None()),
     metrics(new Metrics(*this)),
     electedTime(None())
@@ -356,22 +442,69 @@ Master::Master(
 Master::~Master() {}
 
 
-// TODO(vinod): Update this interface to return failed futures when
+// Throttles events from frameworks of a principal with a token
+// bucket: an event is admitted immediately while tokens remain and
+// is otherwise queued until the bucket, which refills at `qps` up to
+// `burst` tokens, allows it. Queued events are drained by a single
+// timer per limiter rather than one deferred future per message, so
+// admission is O(1) and a backlog costs only its queue entries.
+//
+// TODO(vinod): Update this interface to reject messages when
 // capacity is reached.
 struct BoundedRateLimiter
 {
-  BoundedRateLimiter(double qps, Option<uint64_t> _capacity)
-    : limiter(new process::RateLimiter(qps)),
+  // An event waiting for a token, in arrival order. Exactly one of
+  // `message` and `exited` is set; the two event types share the
+  // queue so that their relative order per framework is maintained.
+  struct Pending
+  {
+    Option<process::MessageEvent> message;
+    Option<process::ExitedEvent> exited;
+    Option<std::string> principal;
+  };
+
+  BoundedRateLimiter(double _qps, uint64_t _burst, Option<uint64_t> _capacity)
+    : qps(_qps),
+      burst(_burst),
       capacity(_capacity),
-      messages(0) {}
+      messages(0),
+      tokens(1.0),
+      refilled(process::Clock::now()),
+      timerActive(false) {}
+
+  // Adds the tokens accrued since the last refill, up to `burst`.
+  void refill()
+  {
+    const process::Time now = process::Clock::now();
 
-  process::Owned<process::RateLimiter> limiter;
+    tokens = std::min(
+        static_cast<double>(burst),
+        tokens + (now - refilled).secs() * qps);
+
+    refilled = now;
+  }
+
+  const double qps;
+  const uint64_t burst;
   const Option<uint64_t> capacity;
 
-  // Number of outstanding messages for this RateLimiter.
+  // Number of outstanding messages for this limiter, used to enforce
+  // the capacity.
   // NOTE: ExitedEvents are throttled but not counted towards
   // the capacity here.
   uint64_t messages;
+
+  // Fractional tokens currently available for immediate admission.
+  double tokens;
+
+  // Time of the last token refill.
+  process::Time refilled;
+
+  // Events waiting for tokens.
+  std::queue<Pending> pending;
+
+  // Whether a drain timer is currently scheduled.
+  bool timerActive;
 };
 
 
@@ -599,6 +732,12 @@ void Master::initialize()
           << ". It must be a positive number";
       }
 
+      if (limit_.has_burst() && limit_.burst() < 1) {
+        EXIT(EXIT_FAILURE)
+          << "Invalid burst: " << limit_.burst()
+          << ". It must be at least 1";
+      }
+
       if (limit_.has_qps()) {
         Option<uint64_t> capacity;
         if (limit_.has_capacity()) {
@@ -607,7 +746,10 @@ void Master::initialize()
         frameworks.limiters.put(
             limit_.principal(),
             Owned<BoundedRateLimiter>(
-                new BoundedRateLimiter(limit_.qps(), capacity)));
+                new BoundedRateLimiter(
+                    limit_.qps(),
+                    limit_.has_burst() ? limit_.burst() : 1,
+                    capacity)));
       } else {
         frameworks.limiters.put(limit_.principal(), None());
       }
@@ -621,6 +763,14 @@ void Master::initialize()
         << ". It must be a positive number";
     }
 
+    if (flags.rate_limits.get().has_aggregate_default_burst() &&
+        flags.rate_limits.get().aggregate_default_burst() < 1) {
+      EXIT(EXIT_FAILURE)
+        << "Invalid aggregate_default_burst: "
+        << flags.rate_limits.get().aggregate_default_burst()
+        << ". It must be at least 1";
+    }
+
     if (flags.rate_limits.get().has_aggregate_default_qps()) {
       Option<uint64_t> capacity;
       if (flags.rate_limits.get().has_aggregate_default_capacity()) {
@@ -628,7 +778,10 @@ void Master::initialize()
       }
       frameworks.defaultLimiter = Owned<BoundedRateLimiter>(
           new BoundedRateLimiter(
-              flags.rate_limits.get().aggregate_default_qps(), capacity));
+              flags.rate_limits.get().aggregate_default_qps(),
+              flags.rate_limits.get().has_aggregate_default_burst()
+                ? flags.rate_limits.get().aggregate_default_burst() : 1,
+              capacity));
     }
 
     LOG(INFO) << "Framework rate limiting enabled";
@@ -641,6 +794,17 @@ void Master::initialize()
               << flags.agent_removal_rate_limit.get();
   }
 
+  // Set up the observer that monitors the liveness of all
+  // registered agents.
+  slaves.observer = new SlaveObserver(
+      self(),
+      slaves.limiter,
+      metrics,
+      flags.agent_ping_timeout,
+      flags.max_agent_ping_timeouts);
+
+  spawn(slaves.observer);
+
   // If "--roles" is set, configure the role whitelist.
   // TODO(neilc): Remove support for explicit roles in ~Mesos 0.32.
   if (flags.roles.isSome()) {
@@ -721,6 +885,10 @@ void Master::initialize()
       });
   spawn(whitelistWatcher);
 
+  if (flags.archive_dir.isSome()) {
+    archivist.reset(new Archivist(flags.archive_dir.get()));
+  }
+
   nextFrameworkId = 0;
   nextSlaveId = 0;
   nextOfferId = 0;
@@ -790,17 +958,13 @@ void Master::initialize()
       &Master::registerSlave,
       &RegisterSlaveMessage::slave,
       &RegisterSlaveMessage::checkpointed_resources,
-      &RegisterSlaveMessage::version);
-
-  install<ReregisterSlaveMessage>(
-      &Master::reregisterSlave,
-      &ReregisterSlaveMessage::slave,
-      &ReregisterSlaveMessage::checkpointed_resources,
-      &ReregisterSlaveMessage::executor_infos,
-      &ReregisterSlaveMessage::tasks,
-      &ReregisterSlaveMessage::frameworks,
-      &ReregisterSlaveMessage::completed_frameworks,
-      &ReregisterSlaveMessage::version);
+      &RegisterSlaveMessage::version,
+      &RegisterSlaveMessage::batched_acknowledgements);
+
+  // NOTE: No handler is installed for `ReregisterSlaveMessage`; it
+  // is intercepted in `_visit` and parsed on a worker thread before
+  // being handed to `reregisterSlave` (see the intake pipeline
+  // there).
 
   install<UnregisterSlaveMessage>(
       &Master::unregisterSlave,
@@ -840,7 +1004,8 @@ void Master::initialize()
 
   install<AuthenticateMessage>(
       &Master::authenticate,
-      &AuthenticateMessage::pid);
+      &AuthenticateMessage::pid,
+      &AuthenticateMessage::token);
 
   // Setup HTTP routes.
   route("/api/v1",
@@ -860,7 +1025,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.scheduler(request, principal);
+          return http.admit(Http::SCHEDULER_CALL, [this, request, principal]() {
+            return http.scheduler(request, principal);
+          });
         });
   route("/create-volumes",
         READWRITE_HTTP_AUTHENTICATION_REALM,
@@ -878,13 +1045,25 @@ void Master::initialize()
           Http::log(request);
           return http.destroyVolumes(request, principal);
         });
+  route("/archive",
+        READONLY_HTTP_AUTHENTICATION_REALM,
+        Http::ARCHIVE_HELP(),
+        [this](const process::http::Request& request,
+               const Option<string>& principal) {
+          Http::log(request);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.archive(request, principal);
+          });
+        });
   route("/frameworks",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::FRAMEWORKS_HELP(),
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.frameworks(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.frameworks(request, principal);
+          });
         });
   route("/flags",
         READONLY_HTTP_AUTHENTICATION_REALM,
@@ -920,7 +1099,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.roles(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.roles(request, principal);
+          });
         });
   route("/roles",
         READONLY_HTTP_AUTHENTICATION_REALM,
@@ -928,7 +1109,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.roles(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.roles(request, principal);
+          });
         });
   route("/teardown",
         READWRITE_HTTP_AUTHENTICATION_REALM,
@@ -944,7 +1127,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.slaves(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.slaves(request, principal);
+          });
         });
   // TODO(ijimenez): Remove this endpoint at the end of the
   // deprecation cycle on 0.26.
@@ -954,7 +1139,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.state(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.state(request, principal);
+          });
         });
   route("/state",
         READONLY_HTTP_AUTHENTICATION_REALM,
@@ -962,7 +1149,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.state(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.state(request, principal);
+          });
         });
   route("/state-summary",
         READONLY_HTTP_AUTHENTICATION_REALM,
@@ -970,7 +1159,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.stateSummary(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.stateSummary(request, principal);
+          });
         });
   // TODO(ijimenez): Remove this endpoint at the end of the
   // deprecation cycle.
@@ -980,7 +1171,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.tasks(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.tasks(request, principal);
+          });
         });
   route("/tasks",
         READONLY_HTTP_AUTHENTICATION_REALM,
@@ -988,7 +1181,9 @@ void Master::initialize()
         [this](const process::http::Request& request,
                const Option<string>& principal) {
           Http::log(request);
-          return http.tasks(request, principal);
+          return http.admit(Http::OPERATOR_READ, [this, request, principal]() {
+            return http.tasks(request, principal);
+          });
         });
   route("/maintenance/schedule",
         READWRITE_HTTP_AUTHENTICATION_REALM,
@@ -1140,15 +1335,18 @@ void Master::finalize()
     // recovering the resources in the allocator.
     slave->pendingTasks.clear();
 
-    // Terminate the slave observer.
-    terminate(slave->observer);
-    wait(slave->observer);
-
-    delete slave->observer;
     delete slave;
   }
   slaves.registered.clear();
 
+  // Terminate the slave observer.
+  if (slaves.observer != nullptr) {
+    terminate(slaves.observer);
+    wait(slaves.observer);
+
+    delete slaves.observer;
+  }
+
   // Remove the frameworks.
   // Note we are not deleting the pointers to the frameworks from the
   // roles because it is unnecessary bookkeeping at this point since
@@ -1174,6 +1372,12 @@ void Master::finalize()
   CHECK(offers.empty());
   CHECK(inverseOffers.empty());
 
+  // Free any recycled offers; see `removeOffer()`.
+  foreach (Offer* offer, offerPool) {
+    delete offer;
+  }
+  offerPool.clear();
+
   foreachvalue (Future<Option<string>> future, authenticating) {
     // NOTE: This is necessary during tests because a copy of
     // this future is used to setup authentication timeout. If a
@@ -1409,8 +1613,7 @@ void Master::visit(const MessageEvent& event)
     if (limiter->capacity.isNone() ||
         limiter->messages < limiter->capacity.get()) {
       limiter->messages++;
-      limiter->limiter->acquire()
-        .onReady(defer(self(), &Self::throttled, event, principal));
+      throttle(limiter.get(), principal, event);
     } else {
       exceededCapacity(
           event,
@@ -1425,8 +1628,7 @@ void Master::visit(const MessageEvent& event)
         frameworks.defaultLimiter.get()->messages <
           frameworks.defaultLimiter.get()->capacity.get()) {
       frameworks.defaultLimiter.get()->messages++;
-      frameworks.defaultLimiter.get()->limiter->acquire()
-        .onReady(defer(self(), &Self::throttled, event, None()));
+      throttle(frameworks.defaultLimiter.get().get(), None(), event);
     } else {
       exceededCapacity(
           event,
@@ -1452,26 +1654,132 @@ void Master::visit(const ExitedEvent& event)
     ? frameworks.principals[event.pid]
     : Option<string>::none();
 
-  // Necessary to disambiguate below.
-  typedef void(Self::*F)(const ExitedEvent&);
-
   if (principal.isSome() &&
       frameworks.limiters.contains(principal.get()) &&
       frameworks.limiters[principal.get()].isSome()) {
-    frameworks.limiters[principal.get()].get()->limiter->acquire()
-      .onReady(defer(self(), static_cast<F>(&Self::_visit), event));
+    throttle(
+        frameworks.limiters[principal.get()].get().get(), principal, event);
   } else if ((principal.isNone() ||
               !frameworks.limiters.contains(principal.get())) &&
              isRegisteredFramework &&
              frameworks.defaultLimiter.isSome()) {
-    frameworks.defaultLimiter.get()->limiter->acquire()
-      .onReady(defer(self(), static_cast<F>(&Self::_visit), event));
+    throttle(frameworks.defaultLimiter.get().get(), None(), event);
   } else {
     _visit(event);
   }
 }
 
 
+void Master::throttle(
+    BoundedRateLimiter* limiter,
+    const Option<string>& principal,
+    const MessageEvent& event)
+{
+  limiter->refill();
+
+  // Admit the event immediately if a token is available and nothing
+  // is already waiting (which would otherwise be reordered).
+  if (limiter->pending.empty() && limiter->tokens >= 1.0) {
+    limiter->tokens -= 1.0;
+    throttled(event, principal);
+    return;
+  }
+
+  BoundedRateLimiter::Pending pending;
+  pending.message = event;
+  pending.principal = principal;
+
+  limiter->pending.push(pending);
+
+  scheduleDrain(limiter, principal);
+}
+
+
+void Master::throttle(
+    BoundedRateLimiter* limiter,
+    const Option<string>& principal,
+    const ExitedEvent& event)
+{
+  limiter->refill();
+
+  if (limiter->pending.empty() && limiter->tokens >= 1.0) {
+    limiter->tokens -= 1.0;
+    _visit(event);
+    return;
+  }
+
+  BoundedRateLimiter::Pending pending;
+  pending.exited = event;
+  pending.principal = principal;
+
+  limiter->pending.push(pending);
+
+  scheduleDrain(limiter, principal);
+}
+
+
+void Master::scheduleDrain(
+    BoundedRateLimiter* limiter,
+    const Option<string>& principal)
+{
+  if (limiter->timerActive) {
+    return;
+  }
+
+  limiter->timerActive = true;
+
+  // Wait until the next full token accrues.
+  Try<Duration> wait =
+    Duration::create((1.0 - limiter->tokens) / limiter->qps);
+
+  CHECK_SOME(wait);
+
+  delay(wait.get(), self(), &Self::drainThrottledEvents, principal);
+}
+
+
+void Master::drainThrottledEvents(const Option<string>& principal)
+{
+  BoundedRateLimiter* limiter = nullptr;
+
+  if (principal.isSome()) {
+    if (frameworks.limiters.contains(principal.get()) &&
+        frameworks.limiters[principal.get()].isSome()) {
+      limiter = frameworks.limiters[principal.get()].get().get();
+    }
+  } else if (frameworks.defaultLimiter.isSome()) {
+    limiter = frameworks.defaultLimiter.get().get();
+  }
+
+  // The limiter has been removed; its queued events are dropped just
+  // as the deferred futures of the old implementation were.
+  if (limiter == nullptr) {
+    return;
+  }
+
+  limiter->timerActive = false;
+  limiter->refill();
+
+  while (!limiter->pending.empty() && limiter->tokens >= 1.0) {
+    limiter->tokens -= 1.0;
+
+    BoundedRateLimiter::Pending pending = limiter->pending.front();
+    limiter->pending.pop();
+
+    if (pending.message.isSome()) {
+      throttled(pending.message.get(), pending.principal);
+    } else {
+      CHECK_SOME(pending.exited);
+      _visit(pending.exited.get());
+    }
+  }
+
+  if (!limiter->pending.empty()) {
+    scheduleDrain(limiter, principal);
+  }
+}
+
+
 void Master::throttled(
     const MessageEvent& event,
     const Option<string>& principal)
@@ -1490,6 +1798,22 @@ void Master::throttled(
 }
 
 
+// Parses a serialized `ReregisterSlaveMessage`, returning a null
+// `Owned` if the payload is malformed. Runs on a worker thread (see
+// the intake pipeline in `Master::_visit`).
+static Owned<ReregisterSlaveMessage> parseReregisterSlaveMessage(
+    const string& body)
+{
+  Owned<ReregisterSlaveMessage> message(new ReregisterSlaveMessage());
+
+  if (!message->ParseFromString(body)) {
+    return Owned<ReregisterSlaveMessage>();
+  }
+
+  return message;
+}
+
+
 void Master::_visit(const MessageEvent& event)
 {
   // Obtain the principal before processing the Message because the
@@ -1500,6 +1824,24 @@ void Master::_visit(const MessageEvent& event)
       ? frameworks.principals[event.message->from]
       : Option<string>::none();
 
+  // Agent re-registrations are parsed off the master actor: a
+  // `ReregisterSlaveMessage` carries the agent's full task and
+  // executor lists, and deserializing these serially here is the
+  // dominant cost of processing a failover storm. The payload is
+  // parsed (in parallel across payloads) on worker threads and the
+  // result applied back on the master.
+  static const string reregisterSlaveMessageName =
+    ReregisterSlaveMessage().GetTypeName();
+
+  if (event.message->name == reregisterSlaveMessageName) {
+    async(&parseReregisterSlaveMessage, event.message->body)
+      .onReady(defer(self(),
+                     &Self::reregisterSlave,
+                     event.message->from,
+                     lambda::_1));
+    return;
+  }
+
   ProtobufProcess<Master>::visit(event);
 
   // Increment 'messages_processed' counter if it still exists.
@@ -1571,11 +1913,13 @@ Future<Nothing> Master::_recover(const Registry& registry)
 {
   foreach (const Registry::Slave& slave, registry.slaves().slaves()) {
     slaves.recovered.insert(slave.info().id());
+    reconciler->addRecoveredSlave(slave.info().id());
   }
 
   foreach (const Registry::UnreachableSlave& unreachable,
            registry.unreachable().slaves()) {
     slaves.unreachable[unreachable.id()] = unreachable.timestamp();
+    reconciler->addUnreachableSlave(unreachable.id(), unreachable.timestamp());
   }
 
   // Set up a timer for age-based registry GC.
@@ -1784,6 +2128,7 @@ void Master::_doRegistryGc(
     }
 
     slaves.unreachable.erase(slave);
+    reconciler->removeUnreachableSlave(slave);
     numRemoved++;
   }
 
@@ -1917,6 +2262,7 @@ void Master::_markUnreachableAfterFailover(
 
   CHECK(slaves.recovered.contains(slaveInfo.id()));
   slaves.recovered.erase(slaveInfo.id());
+  reconciler->removeRecoveredSlave(slaveInfo.id());
 
   if (registrarResult.isFailed()) {
     LOG(FATAL) << "Failed to mark agent " << slaveInfo.id()
@@ -1939,6 +2285,7 @@ void Master::_markUnreachableAfterFailover(
   ++metrics->recovery_slave_removals;
 
   slaves.unreachable[slaveInfo.id()] = unreachableTime;
+  reconciler->addUnreachableSlave(slaveInfo.id(), unreachableTime);
 
   sendSlaveLost(slaveInfo);
 }
@@ -2358,6 +2705,17 @@ void Master::subscribe(
     }
   }
 
+  if (validationError.isNone() && frameworkInfo.has_id()) {
+    Framework* framework = getFramework(frameworkInfo.id());
+
+    // The framework remains registered while its tasks are being
+    // removed in chunks; refuse re-subscription until the removal
+    // has completed.
+    if (framework != nullptr && framework->removing) {
+      validationError = Error("Framework is being removed");
+    }
+  }
+
   if (validationError.isNone() && !isValidFailoverTimeout(frameworkInfo)) {
     validationError = Error("The framework failover_timeout (" +
                             stringify(frameworkInfo.failover_timeout()) +
@@ -2463,6 +2821,7 @@ void Master::_subscribe(
     LOG(INFO) << "Updating info for framework " << framework->id();
 
     framework->updateFrameworkInfo(frameworkInfo);
+    reconciler->updateFramework(framework->info, framework->pid);
     allocator->updateFramework(framework->id(), framework->info);
 
     framework->reregisteredTime = Clock::now();
@@ -2507,17 +2866,24 @@ void Master::_subscribe(
 
   // Broadcast the new framework pid to all the slaves. We have to
   // broadcast because an executor might be running on a slave but
-  // it currently isn't running any tasks.
-  foreachvalue (Slave* slave, slaves.registered) {
-    UpdateFrameworkMessage message;
-    message.mutable_framework_id()->MergeFrom(frameworkInfo.id());
+  // it currently isn't running any tasks. The message is serialized
+  // once for all the slaves.
+  UpdateFrameworkMessage message;
+  message.mutable_framework_id()->MergeFrom(frameworkInfo.id());
 
-    // TODO(anand): We set 'pid' to UPID() for http frameworks
-    // as 'pid' was made optional in 0.24.0. In 0.25.0, we
-    // no longer have to set pid here for http frameworks.
-    message.set_pid(UPID());
-    send(slave->pid, message);
+  // TODO(anand): We set 'pid' to UPID() for http frameworks
+  // as 'pid' was made optional in 0.24.0. In 0.25.0, we
+  // no longer have to set pid here for http frameworks.
+  message.set_pid(UPID());
+
+  vector<UPID> pids;
+  pids.reserve(slaves.registered.size());
+
+  foreachvalue (Slave* slave, slaves.registered) {
+    pids.push_back(slave->pid);
   }
+
+  send(pids, message);
 }
 
 
@@ -2582,6 +2948,17 @@ void Master::subscribe(
     }
   }
 
+  if (validationError.isNone() && frameworkInfo.has_id()) {
+    Framework* framework = getFramework(frameworkInfo.id());
+
+    // The framework remains registered while its tasks are being
+    // removed in chunks; refuse re-subscription until the removal
+    // has completed.
+    if (framework != nullptr && framework->removing) {
+      validationError = Error("Framework is being removed");
+    }
+  }
+
   if (validationError.isNone() && !isValidFailoverTimeout(frameworkInfo)) {
     validationError = Error("The framework failover_timeout (" +
                             stringify(frameworkInfo.failover_timeout()) +
@@ -2747,6 +3124,7 @@ void Master::_subscribe(
     LOG(INFO) << "Updating info for framework " << framework->id();
 
     framework->updateFrameworkInfo(frameworkInfo);
+    reconciler->updateFramework(framework->info, framework->pid);
     allocator->updateFramework(framework->id(), framework->info);
 
     framework->reregisteredTime = Clock::now();
@@ -2793,6 +3171,8 @@ void Master::_subscribe(
       // TODO(bmahler): Shouldn't this re-link with the scheduler?
       framework->connected = true;
 
+      http.invalidateStateCache(framework->id());
+
       // Reactivate the framework.
       // NOTE: We do this after recovering resources (above) so that
       // the allocator has the correct view of the framework's share.
@@ -2846,13 +3226,20 @@ void Master::_subscribe(
 
   // Broadcast the new framework pid to all the slaves. We have to
   // broadcast because an executor might be running on a slave but
-  // it currently isn't running any tasks.
+  // it currently isn't running any tasks. The message is serialized
+  // once for all the slaves.
+  UpdateFrameworkMessage message;
+  message.mutable_framework_id()->MergeFrom(frameworkInfo.id());
+  message.set_pid(from);
+
+  vector<UPID> pids;
+  pids.reserve(slaves.registered.size());
+
   foreachvalue (Slave* slave, slaves.registered) {
-    UpdateFrameworkMessage message;
-    message.mutable_framework_id()->MergeFrom(frameworkInfo.id());
-    message.set_pid(from);
-    send(slave->pid, message);
+    pids.push_back(slave->pid);
   }
+
+  send(pids, message);
 }
 
 
@@ -2931,6 +3318,8 @@ void Master::deactivate(Framework* framework)
 
   LOG(INFO) << "Deactivating framework " << *framework;
 
+  http.invalidateStateCache(framework->id());
+
   // Stop sending offers here for now.
   framework->active = false;
 
@@ -2969,7 +3358,7 @@ void Master::disconnect(Slave* slave)
   slave->connected = false;
 
   // Inform the slave observer.
-  dispatch(slave->observer, &SlaveObserver::disconnect);
+  dispatch(slaves.observer, &SlaveObserver::disconnect, slave->pid);
 
   // Remove the slave from authenticated. This is safe because
   // a slave will always reauthenticate before (re-)registering.
@@ -2985,6 +3374,8 @@ void Master::deactivate(Slave* slave)
 
   LOG(INFO) << "Deactivating agent " << *slave;
 
+  http.invalidateStateCache(slave->id);
+
   slave->active = false;
 
   allocator->deactivateSlave(slave->id);
@@ -3138,34 +3529,45 @@ void Master::launchTasks(
 }
 
 
-Future<bool> Master::authorizeTask(
-    const TaskInfo& task,
+vector<Future<bool>> Master::authorizeTasks(
+    const RepeatedPtrField<TaskInfo>& tasks,
     Framework* framework)
 {
   if (authorizer.isNone()) {
-    return true; // Authorization is disabled.
+    // Authorization is disabled.
+    return vector<Future<bool>>(tasks.size(), true);
   }
 
-  // Authorize the task.
-  authorization::Request request;
+  // Authorize the tasks as one batch: a single round trip into the
+  // authorizer covers the entire launch group.
+  vector<authorization::Request> requests;
+  requests.reserve(tasks.size());
 
-  if (framework->info.has_principal()) {
-    request.mutable_subject()->set_value(framework->info.principal());
-  }
+  foreach (const TaskInfo& task, tasks) {
+    authorization::Request request;
 
-  request.set_action(authorization::RUN_TASK);
+    if (framework->info.has_principal()) {
+      request.mutable_subject()->set_value(framework->info.principal());
+    }
 
-  authorization::Object* object = request.mutable_object();
+    request.set_action(authorization::RUN_TASK);
 
-  object->mutable_task_info()->CopyFrom(task);
-  object->mutable_framework_info()->CopyFrom(framework->info);
+    authorization::Object* object = request.mutable_object();
 
-  LOG(INFO)
-    << "Authorizing framework principal '"
-    << (framework->info.has_principal() ? framework->info.principal() : "ANY")
-    << "' to launch task " << task.task_id();
+    object->mutable_task_info()->CopyFrom(task);
+    object->mutable_framework_info()->CopyFrom(framework->info);
 
-  return authorizer.get()->authorized(request);
+    LOG(INFO)
+      << "Authorizing framework principal '"
+      << (framework->info.has_principal()
+            ? framework->info.principal() : "ANY")
+      << "' to launch task " << task.task_id();
+
+    requests.push_back(authorization::Request());
+    requests.back().Swap(&request);
+  }
+
+  return authorizer.get()->authorized(requests);
 }
 
 
@@ -3585,11 +3987,16 @@ void Master::accept(
           UNREACHABLE();
         }();
 
-        // Authorize the tasks. A task is in 'framework->pendingTasks'
-        // and 'slave->pendingTasks' before it is authorized.
-        foreach (const TaskInfo& task, tasks) {
-          futures.push_back(authorizeTask(task, framework));
+        // Authorize the tasks as a single batch so that the whole
+        // launch group costs one round trip into the authorizer. A
+        // task is in 'framework->pendingTasks' and
+        // 'slave->pendingTasks' before it is authorized.
+        foreach (const Future<bool>& authorization,
+                 authorizeTasks(tasks, framework)) {
+          futures.push_back(authorization);
+        }
 
+        foreach (const TaskInfo& task, tasks) {
           // Add to the framework's list of pending tasks.
           //
           // NOTE: If two tasks have the same ID, the second one will
@@ -3601,6 +4008,12 @@ void Master::accept(
           // a TASK_ERROR after a TASK_KILLED (see _accept())!
           if (!framework->pendingTasks.contains(task.task_id())) {
             framework->pendingTasks[task.task_id()] = task;
+
+            taskStateSummaries.add(
+                framework->id(), task.slave_id(), TASK_STAGING);
+
+            reconciler->addPendingTask(
+                framework->id(), task.task_id(), task.slave_id());
           }
 
           // Add to the slave's list of pending tasks.
@@ -3742,7 +4155,12 @@ void Master::_accept(
 
       foreach (const TaskInfo& task, tasks) {
         // Remove the task from being pending.
+        if (framework->pendingTasks.contains(task.task_id())) {
+          taskStateSummaries.subtract(
+              framework->id(), task.slave_id(), TASK_STAGING);
+        }
         framework->pendingTasks.erase(task.task_id());
+        reconciler->removePendingTask(framework->id(), task.task_id());
         if (slave != nullptr) {
           slave->pendingTasks[framework->id()].erase(task.task_id());
           if (slave->pendingTasks[framework->id()].empty()) {
@@ -4093,11 +4511,17 @@ void Master::_accept(
 
           bool pending = framework->pendingTasks.contains(task.task_id());
           framework->pendingTasks.erase(task.task_id());
+          reconciler->removePendingTask(framework->id(), task.task_id());
           slave->pendingTasks[framework->id()].erase(task.task_id());
           if (slave->pendingTasks[framework->id()].empty()) {
             slave->pendingTasks.erase(framework->id());
           }
 
+          if (pending) {
+            taskStateSummaries.subtract(
+                framework->id(), task.slave_id(), TASK_STAGING);
+          }
+
           CHECK(!authorization.isDiscarded());
 
           if (authorization.isFailed() || !authorization.get()) {
@@ -4264,12 +4688,16 @@ void Master::_accept(
         foreach (const TaskInfo& task, taskGroup.tasks()) {
           bool pending = framework->pendingTasks.contains(task.task_id());
           framework->pendingTasks.erase(task.task_id());
+          reconciler->removePendingTask(framework->id(), task.task_id());
           slave->pendingTasks[framework->id()].erase(task.task_id());
           if (slave->pendingTasks[framework->id()].empty()) {
             slave->pendingTasks.erase(framework->id());
           }
 
-          if (!pending) {
+          if (pending) {
+            taskStateSummaries.subtract(
+                framework->id(), task.slave_id(), TASK_STAGING);
+          } else {
             killed.insert(task.task_id());
           }
         }
@@ -4679,8 +5107,14 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
     kill.has_slave_id() ? Option<SlaveID>(kill.slave_id()) : None();
 
   if (framework->pendingTasks.contains(taskId)) {
+    taskStateSummaries.subtract(
+        framework->id(),
+        framework->pendingTasks[taskId].slave_id(),
+        TASK_STAGING);
+
     // Remove from pending tasks.
     framework->pendingTasks.erase(taskId);
+    reconciler->removePendingTask(framework->id(), taskId);
 
     if (slaveId.isSome()) {
       Slave* slave = slaves.registered.get(slaveId.get());
@@ -4895,12 +5329,76 @@ void Master::acknowledge(
   message.mutable_task_id()->CopyFrom(taskId);
   message.set_uuid(uuid.toBytes());
 
-  send(slave->pid, message);
+  // Rather than sending the acknowledgement right away, coalesce
+  // acknowledgements headed to the same agent for a small window;
+  // at high status update rates this substantially reduces the
+  // master <-> agent message count.
+  vector<StatusUpdateAcknowledgementMessage>& pending =
+    pendingAcknowledgements[slaveId];
+
+  pending.push_back(message);
+
+  if (pending.size() == 1) {
+    delay(STATUS_UPDATE_ACKNOWLEDGEMENT_BATCH_WINDOW,
+          self(),
+          &Self::flushAcknowledgements,
+          slaveId);
+  }
 
   metrics->valid_status_update_acknowledgements++;
 }
 
 
+void Master::flushAcknowledgements(const SlaveID& slaveId)
+{
+  if (!pendingAcknowledgements.contains(slaveId)) {
+    return;
+  }
+
+  vector<StatusUpdateAcknowledgementMessage> acknowledgements =
+    std::move(pendingAcknowledgements.at(slaveId));
+
+  pendingAcknowledgements.erase(slaveId);
+
+  Slave* slave = slaves.registered.get(slaveId);
+
+  // The agent may have been removed or disconnected while the
+  // acknowledgements were pending. Dropping them is safe: the agent
+  // will retry the affected status updates when it re-registers.
+  if (slave == nullptr || !slave->connected) {
+    LOG(WARNING) << "Dropping " << acknowledgements.size()
+                 << " status update acknowledgements for agent " << slaveId
+                 << " because the agent is "
+                 << (slave == nullptr ? "not registered" : "disconnected");
+    return;
+  }
+
+  // Send a single acknowledgement in its original form so that the
+  // common low-rate case does not change on the wire. The same form
+  // is used for agents that did not advertise support for the
+  // batched message when (re-)registering: old agents silently drop
+  // unknown message types, and during a rolling upgrade (masters are
+  // upgraded first) dropped acknowledgements would make the agent
+  // retry the affected updates forever.
+  if (acknowledgements.size() == 1 || !slave->batchedAcknowledgements) {
+    foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+             acknowledgements) {
+      send(slave->pid, acknowledgement);
+    }
+    return;
+  }
+
+  StatusUpdateAcknowledgementsMessage message;
+
+  foreach (StatusUpdateAcknowledgementMessage& acknowledgement,
+           acknowledgements) {
+    acknowledgement.Swap(message.add_acknowledgements());
+  }
+
+  send(slave->pid, message);
+}
+
+
 void Master::schedulerMessage(
     const UPID& from,
     const SlaveID& slaveId,
@@ -5041,7 +5539,8 @@ void Master::registerSlave(
     const UPID& from,
     const SlaveInfo& slaveInfo,
     const vector<Resource>& checkpointedResources,
-    const string& version)
+    const string& version,
+    bool batchedAcknowledgements)
 {
   ++metrics->messages_register_slave;
 
@@ -5055,7 +5554,8 @@ void Master::registerSlave(
                      from,
                      slaveInfo,
                      checkpointedResources,
-                     version));
+                     version,
+                     batchedAcknowledgements));
     return;
   }
 
@@ -5115,6 +5615,7 @@ void Master::registerSlave(
         flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
       MasterSlaveConnection connection;
       connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+      connection.set_delta_reregistration(true);
 
       SlaveRegisteredMessage message;
       message.mutable_slave_id()->CopyFrom(slave->id);
@@ -5148,6 +5649,7 @@ void Master::registerSlave(
                  from,
                  checkpointedResources,
                  version,
+                 batchedAcknowledgements,
                  lambda::_1));
 }
 
@@ -5157,6 +5659,7 @@ void Master::_registerSlave(
     const UPID& pid,
     const vector<Resource>& checkpointedResources,
     const string& version,
+    bool batchedAcknowledgements,
     const Future<bool>& admit)
 {
   CHECK(slaves.registering.contains(pid));
@@ -5195,6 +5698,8 @@ void Master::_registerSlave(
       Clock::now(),
       checkpointedResources);
 
+  slave->batchedAcknowledgements = batchedAcknowledgements;
+
   ++metrics->slave_registrations;
 
   addSlave(slave);
@@ -5203,6 +5708,7 @@ void Master::_registerSlave(
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_delta_reregistration(true);
 
   SlaveRegisteredMessage message;
   message.mutable_slave_id()->CopyFrom(slave->id);
@@ -5214,33 +5720,54 @@ void Master::_registerSlave(
 }
 
 
+// Computes the master's fingerprint of an agent's task and executor
+// state for the delta re-registration handshake. This must match the
+// fingerprint the agent computes over the state it would include in a
+// full `ReregisterSlaveMessage`, see `Slave::doReliableRegistration`.
+static uint64_t getStateFingerprint(Slave* slave)
+{
+  std::vector<std::pair<std::string, std::string>> taskIds;
+  std::vector<std::pair<std::string, std::string>> executorIds;
+
+  foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+    foreachkey (const TaskID& taskId, slave->tasks[frameworkId]) {
+      taskIds.push_back(
+          std::make_pair(frameworkId.value(), taskId.value()));
+    }
+  }
+
+  foreachkey (const FrameworkID& frameworkId, slave->executors) {
+    foreachkey (const ExecutorID& executorId, slave->executors[frameworkId]) {
+      executorIds.push_back(
+          std::make_pair(frameworkId.value(), executorId.value()));
+    }
+  }
+
+  return protobuf::getStateFingerprint(
+      std::move(taskIds), std::move(executorIds));
+}
+
+
 void Master::reregisterSlave(
     const UPID& from,
-    const SlaveInfo& slaveInfo,
-    const vector<Resource>& checkpointedResources,
-    const vector<ExecutorInfo>& executorInfos,
-    const vector<Task>& tasks,
-    const vector<FrameworkInfo>& frameworks,
-    const vector<Archive::Framework>& completedFrameworks,
-    const string& version)
+    const Owned<ReregisterSlaveMessage>& message)
 {
+  if (message.get() == nullptr) {
+    LOG(WARNING) << "Dropping re-registration message from agent at " << from
+                 << " because the payload failed to parse";
+    return;
+  }
+
   ++metrics->messages_reregister_slave;
 
+  const SlaveInfo& slaveInfo = message->slave();
+
   if (authenticating.contains(from)) {
     LOG(INFO) << "Queuing up re-registration request from " << from
               << " because authentication is still in progress";
 
     authenticating[from]
-      .onReady(defer(self(),
-                     &Self::reregisterSlave,
-                     from,
-                     slaveInfo,
-                     checkpointedResources,
-                     executorInfos,
-                     tasks,
-                     frameworks,
-                     completedFrameworks,
-                     version));
+      .onReady(defer(self(), &Self::reregisterSlave, from, message));
     return;
   }
 
@@ -5250,9 +5777,9 @@ void Master::reregisterSlave(
     // re-register without authentication.
     LOG(WARNING) << "Refusing re-registration of agent at " << from
                  << " because it is not authenticated";
-    ShutdownMessage message;
-    message.set_message("Agent is not authenticated");
-    send(from, message);
+    ShutdownMessage shutdown;
+    shutdown.set_message("Agent is not authenticated");
+    send(from, shutdown);
     return;
   }
 
@@ -5268,9 +5795,9 @@ void Master::reregisterSlave(
                  << " because the machine '" << machineId << "' that it is "
                  << "running on is `DOWN`";
 
-    ShutdownMessage message;
-    message.set_message("Machine is `DOWN`");
-    send(from, message);
+    ShutdownMessage shutdown;
+    shutdown.set_message("Machine is `DOWN`");
+    send(from, shutdown);
     return;
   }
 
@@ -5302,11 +5829,11 @@ void Master::reregisterSlave(
                    << slave->pid.address.ip << " (" << slave->info.hostname()
                    << ") shutting it down";
 
-      ShutdownMessage message;
-      message.set_message(
+      ShutdownMessage shutdown;
+      shutdown.set_message(
           "Agent attempted to re-register with different IP / hostname");
 
-      send(from, message);
+      send(from, shutdown);
       return;
     }
 
@@ -5320,11 +5847,71 @@ void Master::reregisterSlave(
     link(slave->pid);
 
     // Update slave's version after re-registering successfully.
-    slave->version = version;
+    slave->version = message->version();
+    slave->batchedAcknowledgements = message->batched_acknowledgements();
+
+    // If the agent attempted a delta re-registration (i.e., it only
+    // sent a fingerprint of its task and executor state), check the
+    // fingerprint against our view of the agent. On a mismatch we
+    // ask the agent to re-register with its full state; on a match
+    // the task and executor reconciliation below would be a no-op,
+    // so we skip it. Note that a framework that completed while the
+    // agent was disconnected still has tasks on the agent, which
+    // guarantees a mismatch, so the completed framework shutdown in
+    // `reconcileKnownSlave` is covered as well.
+    bool delta = message->has_state_fingerprint();
+
+    if (delta && message->state_fingerprint() != getStateFingerprint(slave)) {
+      LOG(INFO) << "Asking agent " << *slave << " to re-register with its"
+                << " full state because its state fingerprint does not"
+                << " match the master's view of the agent";
+
+      ReregisterSlaveFullStateMessage request;
+      send(slave->pid, request);
+      return;
+    }
 
-    // Reconcile tasks between master and slave, and send the
-    // `SlaveReregisteredMessage`.
-    reconcileKnownSlave(slave, executorInfos, tasks);
+    if (delta) {
+      LOG(INFO) << "Re-registered agent " << *slave << " via a delta"
+                << " re-registration; skipping task reconciliation";
+
+      Duration pingTimeout =
+        flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
+      MasterSlaveConnection connection;
+      connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+      connection.set_delta_reregistration(true);
+
+      SlaveReregisteredMessage reregistered;
+      reregistered.mutable_slave_id()->CopyFrom(slave->id);
+      reregistered.mutable_connection()->CopyFrom(connection);
+      send(slave->pid, reregistered);
+
+      // Kill messages that raced with the disconnection may have
+      // been dropped, so re-send them. This mirrors the handling in
+      // `reconcileKnownSlave()`, except that we consult our own view
+      // of the task state since the agent did not send its tasks
+      // (the agent ignores kills for unknown or completed tasks).
+      foreachpair (const FrameworkID& frameworkId,
+                   const TaskID& taskId,
+                   slave->killedTasks) {
+        Task* task = slave->getTask(frameworkId, taskId);
+
+        if (task != nullptr && !protobuf::isTerminalState(task->state())) {
+          LOG(WARNING) << "Agent " << *slave
+                       << " has non-terminal task " << taskId
+                       << " that is supposed to be killed. Killing it now!";
+
+          KillTaskMessage kill;
+          kill.mutable_framework_id()->MergeFrom(frameworkId);
+          kill.mutable_task_id()->MergeFrom(taskId);
+          send(slave->pid, kill);
+        }
+      }
+    } else {
+      // Reconcile tasks between master and slave, and send the
+      // `SlaveReregisteredMessage`.
+      reconcileKnownSlave(slave, message->executor_infos(), message->tasks());
+    }
 
     // If this is a disconnected slave, add it back to the allocator.
     // This is done after reconciliation to ensure the allocator's
@@ -5332,21 +5919,65 @@ void Master::reregisterSlave(
     // slave.
     if (!slave->connected) {
       slave->connected = true;
-      dispatch(slave->observer, &SlaveObserver::reconnect);
+      dispatch(slaves.observer, &SlaveObserver::reconnect, slave->pid);
       slave->active = true;
       allocator->activateSlave(slave->id);
+
+      http.invalidateStateCache(slave->id);
     }
 
     CHECK(slave->active)
       << "Unexpected connected but deactivated agent " << *slave;
 
+    if (delta) {
+      // The agent did not send its tasks and frameworks, so derive
+      // the framework pid updates from our own view of the agent.
+      hashset<FrameworkID> ids;
+
+      foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+        ids.insert(frameworkId);
+      }
+
+      foreachkey (const FrameworkID& frameworkId, slave->executors) {
+        ids.insert(frameworkId);
+      }
+
+      foreach (const FrameworkID& frameworkId, ids) {
+        Framework* framework = getFramework(frameworkId);
+
+        if (framework != nullptr) {
+          UpdateFrameworkMessage update;
+          update.mutable_framework_id()->MergeFrom(framework->id());
+          update.set_pid(framework->pid.getOrElse(UPID()));
+          send(slave->pid, update);
+        }
+      }
+    }
+
     // Inform the agent of the master's version of its checkpointed
-    // resources and the new framework pids for its tasks.
-    __reregisterSlave(slave, tasks, frameworks);
+    // resources and the new framework pids for its tasks. On the
+    // delta fast path the message carries no tasks or frameworks,
+    // so this only sends the checkpointed resources.
+    __reregisterSlave(slave, message->tasks(), message->frameworks());
 
     return;
   }
 
+  // The agent attempted a delta re-registration (i.e., it did not
+  // send its task and executor state) but this master holds no state
+  // for it, e.g., because the master failed over or already removed
+  // the agent. Ask the agent to re-register with its full state
+  // rather than readmitting it with no tasks.
+  if (message->has_state_fingerprint()) {
+    LOG(INFO) << "Asking agent " << slaveInfo.id() << " at " << from
+              << " (" << slaveInfo.hostname() << ") to re-register with"
+              << " its full state because it is not currently registered";
+
+    ReregisterSlaveFullStateMessage request;
+    send(from, request);
+    return;
+  }
+
   // If we're already re-registering this slave, then no need to ask
   // the registrar again.
   if (slaves.reregistering.contains(slaveInfo.id())) {
@@ -5371,29 +6002,19 @@ void Master::reregisterSlave(
   registrar->apply(Owned<Operation>(new MarkSlaveReachable(slaveInfo)))
     .onAny(defer(self(),
                  &Self::_reregisterSlave,
-                 slaveInfo,
                  from,
-                 checkpointedResources,
-                 executorInfos,
-                 tasks,
-                 frameworks,
-                 completedFrameworks,
-                 version,
+                 message,
                  lambda::_1));
 }
 
 
 void Master::_reregisterSlave(
-    const SlaveInfo& slaveInfo,
     const UPID& pid,
-    const vector<Resource>& checkpointedResources,
-    const vector<ExecutorInfo>& executorInfos,
-    const vector<Task>& tasks,
-    const vector<FrameworkInfo>& frameworks,
-    const vector<Archive::Framework>& completedFrameworks,
-    const string& version,
+    const Owned<ReregisterSlaveMessage>& message,
     const Future<bool>& readmit)
 {
+  const SlaveInfo& slaveInfo = message->slave();
+
   CHECK(slaves.reregistering.contains(slaveInfo.id()));
   slaves.reregistering.erase(slaveInfo.id());
 
@@ -5412,6 +6033,7 @@ void Master::_reregisterSlave(
   // Ensure we don't remove the slave for not re-registering after
   // we've recovered it from the registry.
   slaves.recovered.erase(slaveInfo.id());
+  reconciler->removeRecoveredSlave(slaveInfo.id());
 
   MachineID machineId;
   machineId.set_hostname(slaveInfo.hostname());
@@ -5422,12 +6044,13 @@ void Master::_reregisterSlave(
       slaveInfo,
       pid,
       machineId,
-      version,
+      message->version(),
       Clock::now(),
-      checkpointedResources,
-      executorInfos,
-      tasks);
+      message->checkpointed_resources(),
+      message->executor_infos(),
+      message->tasks());
 
+  slave->batchedAcknowledgements = message->batched_acknowledgements();
   slave->reregisteredTime = Clock::now();
 
   ++metrics->slave_reregistrations;
@@ -5440,18 +6063,20 @@ void Master::_reregisterSlave(
 
   slaves.removed.erase(slave->id);
   slaves.unreachable.erase(slave->id);
+  reconciler->removeUnreachableSlave(slave->id);
 
-  addSlave(slave, completedFrameworks);
+  addSlave(slave, message->completed_frameworks());
 
   Duration pingTimeout =
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_delta_reregistration(true);
 
-  SlaveReregisteredMessage message;
-  message.mutable_slave_id()->CopyFrom(slave->id);
-  message.mutable_connection()->CopyFrom(connection);
-  send(slave->pid, message);
+  SlaveReregisteredMessage reregistered;
+  reregistered.mutable_slave_id()->CopyFrom(slave->id);
+  reregistered.mutable_connection()->CopyFrom(connection);
+  send(slave->pid, reregistered);
 
   LOG(INFO) << "Re-registered agent " << *slave
             << " with " << slave->info.resources();
@@ -5464,16 +6089,16 @@ void Master::_reregisterSlave(
   // unreachable slave reregisters, its tasks are only shutdown if the
   // master has not failed over.
   if (slaveWasRemoved) {
-    foreach (const FrameworkInfo& framework, frameworks) {
+    foreach (const FrameworkInfo& framework, message->frameworks()) {
       if (!protobuf::frameworkHasCapability(
               framework, FrameworkInfo::Capability::PARTITION_AWARE)) {
         LOG(INFO) << "Shutting down framework " << framework.id()
                   << " at reregistered agent " << *slave
                   << " because the framework is not partition-aware";
 
-        ShutdownFrameworkMessage message;
-        message.mutable_framework_id()->MergeFrom(framework.id());
-        send(slave->pid, message);
+        ShutdownFrameworkMessage shutdownMessage;
+        shutdownMessage.mutable_framework_id()->MergeFrom(framework.id());
+        send(slave->pid, shutdownMessage);
 
         // Remove the framework's tasks from the master's in-memory state.
         foreachvalue (Task* task, utils::copy(slave->tasks[framework.id()])) {
@@ -5483,14 +6108,14 @@ void Master::_reregisterSlave(
     }
   }
 
-  __reregisterSlave(slave, tasks, frameworks);
+  __reregisterSlave(slave, message->tasks(), message->frameworks());
 }
 
 
 void Master::__reregisterSlave(
     Slave* slave,
-    const vector<Task>& tasks,
-    const vector<FrameworkInfo>& frameworks)
+    const RepeatedPtrField<Task>& tasks,
+    const RepeatedPtrField<FrameworkInfo>& frameworks)
 {
   CHECK_NOTNULL(slave);
 
@@ -5608,6 +6233,18 @@ void Master::updateSlave(
 
   Slave* slave = CHECK_NOTNULL(slaves.registered.get(slaveId));
 
+  // The agent only forwards a new estimate when it changes, but it
+  // also (re-)sends the current estimate whenever it (re-)registers,
+  // so we may receive an estimate matching what we already know.
+  // Skip the allocator update and the offer rescission in that case.
+  if (slave->totalResources.revocable() ==
+      oversubscribedResources.revocable()) {
+    LOG(INFO) << "Ignoring update of agent " << *slave << " with total"
+              << " oversubscribed resources " << oversubscribedResources
+              << " because the estimate is unchanged";
+    return;
+  }
+
   LOG(INFO) << "Received update of agent " << *slave << " with total"
             << " oversubscribed resources " <<  oversubscribedResources;
 
@@ -5620,6 +6257,8 @@ void Master::updateSlave(
   slave->totalResources =
     slave->totalResources.nonRevocable() + oversubscribedResources.revocable();
 
+  http.invalidateStateCache(slave->id);
+
   // First update the agent's resources in the allocator.
   allocator->updateSlave(slaveId, oversubscribedResources);
 
@@ -5744,7 +6383,19 @@ void Master::statusUpdate(StatusUpdate update, const UPID& pid)
     return;
   }
 
-  LOG(INFO) << "Status update " << update << " from agent " << *slave;
+  // Logging every status update gets expensive at high update rates
+  // and the log writes show up in the update handling latency, so we
+  // periodically log one along with the number of updates elided and
+  // keep the per-update line at a higher verbosity level.
+  static logging::Throttle statusUpdateThrottle(Seconds(1));
+
+  if (statusUpdateThrottle.permit()) {
+    LOG(INFO) << "Status update " << update << " from agent " << *slave
+              << " (" << statusUpdateThrottle.suppressed()
+              << " updates since last logged)";
+  } else {
+    VLOG(1) << "Status update " << update << " from agent " << *slave;
+  }
 
   // We ensure that the uuid of task status matches the update's uuid, in case
   // the task status uuid is not set by the slave.
@@ -5818,6 +6469,9 @@ void Master::forward(
     if (update.has_uuid()) {
       task->set_status_update_state(update.status().state());
       task->set_status_update_uuid(update.status().uuid());
+
+      reconciler->updateTask(
+          framework->id(), task->task_id(), ReconcilerTask(*task));
     }
   }
 
@@ -6102,8 +6756,13 @@ void Master::_markUnreachable(
 
   // Mark the slave as being unreachable.
   slaves.registered.remove(slave);
+  reconciler->removeSlave(slave->id);
+
+  http.invalidateStateCache(slave->id);
+
   slaves.removed.put(slave->id, Nothing());
   slaves.unreachable[slave->id] = unreachableTime;
+  reconciler->addUnreachableSlave(slave->id, unreachableTime);
   authenticated.erase(slave->pid);
 
   // Remove the slave from the `machines` mapping.
@@ -6111,10 +6770,8 @@ void Master::_markUnreachable(
   CHECK(machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.erase(slave->id);
 
-  // Kill the slave observer.
-  terminate(slave->observer);
-  wait(slave->observer);
-  delete slave->observer;
+  // Stop observing the slave.
+  dispatch(slaves.observer, &SlaveObserver::forget, slave->pid);
 
   // TODO(benh): unlink(slave->pid);
 
@@ -6182,210 +6839,44 @@ void Master::_reconcileTasks(
     // Implicit reconciliation.
     LOG(INFO) << "Performing implicit task state reconciliation"
                  " for framework " << *framework;
+  } else {
+    // Explicit reconciliation.
+    LOG(INFO) << "Performing explicit task state reconciliation for "
+              << statuses.size() << " tasks of framework " << *framework;
+  }
+
+  // The request is answered from the reconciler's snapshot so that
+  // frameworks reconciling a large number of tasks do not occupy the
+  // master actor beyond the cost of forwarding the request; see
+  // `Reconciler` for the case analysis and the consistency argument.
+  // Updates for an HTTP framework are handed back to the master
+  // since its connection lives here.
+  reconciler->reconcile(
+      framework->id(),
+      statuses,
+      defer(self(),
+            &Self::sendReconciliationUpdates,
+            framework->id(),
+            lambda::_1));
+}
 
-    foreachvalue (const TaskInfo& task, framework->pendingTasks) {
-      const StatusUpdate& update = protobuf::createStatusUpdate(
-          framework->id(),
-          task.slave_id(),
-          task.task_id(),
-          TASK_STAGING,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Latest task state",
-          TaskStatus::REASON_RECONCILIATION);
-
-      VLOG(1) << "Sending implicit reconciliation state "
-              << update.status().state()
-              << " for task " << update.status().task_id()
-              << " of framework " << *framework;
-
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update);
-      framework->send(message);
-    }
-
-    foreachvalue (Task* task, framework->tasks) {
-      const TaskState& state = task->has_status_update_state()
-          ? task->status_update_state()
-          : task->state();
-
-      const Option<ExecutorID>& executorId = task->has_executor_id()
-          ? Option<ExecutorID>(task->executor_id())
-          : None();
-
-      const StatusUpdate& update = protobuf::createStatusUpdate(
-          framework->id(),
-          task->slave_id(),
-          task->task_id(),
-          state,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Latest task state",
-          TaskStatus::REASON_RECONCILIATION,
-          executorId,
-          protobuf::getTaskHealth(*task),
-          None(),
-          protobuf::getTaskContainerStatus(*task));
-
-      VLOG(1) << "Sending implicit reconciliation state "
-              << update.status().state()
-              << " for task " << update.status().task_id()
-              << " of framework " << *framework;
 
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update);
-      framework->send(message);
-    }
+void Master::sendReconciliationUpdates(
+    const FrameworkID& frameworkId,
+    const vector<StatusUpdate>& updates)
+{
+  Framework* framework = getFramework(frameworkId);
 
+  // The framework might have been removed while the reconciler was
+  // answering the request.
+  if (framework == nullptr) {
     return;
   }
 
-  // Explicit reconciliation.
-  LOG(INFO) << "Performing explicit task state reconciliation for "
-            << statuses.size() << " tasks of framework " << *framework;
-
-  // Explicit reconciliation occurs for the following cases:
-  //   (1) Task is known, but pending: TASK_STAGING.
-  //   (2) Task is known: send the latest state.
-  //   (3) Task is unknown, slave is registered: TASK_UNKNOWN.
-  //   (4) Task is unknown, slave is transitioning: no-op.
-  //   (5) Task is unknown, slave is unreachable: TASK_UNREACHABLE.
-  //   (6) Task is unknown, slave is unknown: TASK_UNKNOWN.
-  //
-  // For cases (3), (5), and (6), TASK_LOST is sent instead if the
-  // framework has not opted-in to the PARTITION_AWARE capability.
-  foreach (const TaskStatus& status, statuses) {
-    Option<SlaveID> slaveId = None();
-    if (status.has_slave_id()) {
-      slaveId = status.slave_id();
-    }
-
-    Option<StatusUpdate> update = None();
-    Task* task = framework->getTask(status.task_id());
-
-    if (framework->pendingTasks.contains(status.task_id())) {
-      // (1) Task is known, but pending: TASK_STAGING.
-      const TaskInfo& task_ = framework->pendingTasks[status.task_id()];
-      update = protobuf::createStatusUpdate(
-          framework->id(),
-          task_.slave_id(),
-          task_.task_id(),
-          TASK_STAGING,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Latest task state",
-          TaskStatus::REASON_RECONCILIATION);
-    } else if (task != nullptr) {
-      // (2) Task is known: send the latest status update state.
-      const TaskState& state = task->has_status_update_state()
-          ? task->status_update_state()
-          : task->state();
-
-      const Option<ExecutorID> executorId = task->has_executor_id()
-          ? Option<ExecutorID>(task->executor_id())
-          : None();
-
-      update = protobuf::createStatusUpdate(
-          framework->id(),
-          task->slave_id(),
-          task->task_id(),
-          state,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Latest task state",
-          TaskStatus::REASON_RECONCILIATION,
-          executorId,
-          protobuf::getTaskHealth(*task),
-          None(),
-          protobuf::getTaskContainerStatus(*task));
-    } else if (slaveId.isSome() && slaves.registered.contains(slaveId.get())) {
-      // (3) Task is unknown, slave is registered: TASK_UNKNOWN. If
-      // the framework does not have the PARTITION_AWARE capability,
-      // send TASK_LOST for backward compatibility.
-      TaskState taskState = TASK_UNKNOWN;
-      if (!protobuf::frameworkHasCapability(
-              framework->info, FrameworkInfo::Capability::PARTITION_AWARE)) {
-        taskState = TASK_LOST;
-      }
-
-      update = protobuf::createStatusUpdate(
-          framework->id(),
-          slaveId.get(),
-          status.task_id(),
-          taskState,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Task is unknown to the agent",
-          TaskStatus::REASON_RECONCILIATION);
-    } else if (slaves.transitioning(slaveId)) {
-      // (4) Task is unknown, slave is transitionary: no-op.
-      LOG(INFO) << "Dropping reconciliation of task " << status.task_id()
-                << " for framework " << *framework
-                << " because there are transitional agents";
-    } else if (slaveId.isSome() && slaves.unreachable.contains(slaveId.get())) {
-      // (5) Slave is unreachable: TASK_UNREACHABLE. If the framework
-      // does not have the PARTITION_AWARE capability, send TASK_LOST
-      // for backward compatibility. In either case, the status update
-      // also includes the time when the slave was marked unreachable.
-      const TimeInfo& unreachableTime = slaves.unreachable[slaveId.get()];
-
-      TaskState taskState = TASK_UNREACHABLE;
-      if (!protobuf::frameworkHasCapability(
-              framework->info, FrameworkInfo::Capability::PARTITION_AWARE)) {
-        taskState = TASK_LOST;
-      }
-
-      update = protobuf::createStatusUpdate(
-          framework->id(),
-          slaveId.get(),
-          status.task_id(),
-          taskState,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Task is unreachable",
-          TaskStatus::REASON_RECONCILIATION,
-          None(),
-          None(),
-          None(),
-          None(),
-          unreachableTime);
-    } else {
-      // (6) Task is unknown, slave is unknown: TASK_UNKNOWN. If the
-      // framework does not have the PARTITION_AWARE capability, send
-      // TASK_LOST for backward compatibility.
-      TaskState taskState = TASK_UNKNOWN;
-      if (!protobuf::frameworkHasCapability(
-              framework->info, FrameworkInfo::Capability::PARTITION_AWARE)) {
-        taskState = TASK_LOST;
-      }
-
-      update = protobuf::createStatusUpdate(
-          framework->id(),
-          slaveId,
-          status.task_id(),
-          taskState,
-          TaskStatus::SOURCE_MASTER,
-          None(),
-          "Reconciliation: Task is unknown",
-          TaskStatus::REASON_RECONCILIATION);
-    }
-
-    if (update.isSome()) {
-      VLOG(1) << "Sending explicit reconciliation state "
-              << update.get().status().state()
-              << " for task " << update.get().status().task_id()
-              << " of framework " << *framework;
-
-      // TODO(bmahler): Consider using forward(); might lead to too
-      // much logging.
-      StatusUpdateMessage message;
-      message.mutable_update()->CopyFrom(update.get());
-      framework->send(message);
-    }
+  foreach (const StatusUpdate& update, updates) {
+    StatusUpdateMessage message;
+    message.mutable_update()->CopyFrom(update);
+    framework->send(message);
   }
 }
 
@@ -6478,22 +6969,21 @@ void Master::offer(const FrameworkID& frameworkId,
     // separate offers, so that rescinding offers with revocable
     // resources does not affect offers with regular resources.
 
-    // TODO(bmahler): Set "https" if only "https" is supported.
-    mesos::URL url;
-    url.set_scheme("http");
-    url.mutable_address()->set_hostname(slave->info.hostname());
-    url.mutable_address()->set_ip(stringify(slave->pid.address.ip));
-    url.mutable_address()->set_port(slave->pid.address.port);
-    url.set_path("/" + slave->pid.id);
+    // Reuse a recycled Offer if one is available (see `removeOffer()`),
+    // and copy the per-slave parts of the offer from the template that
+    // was pre-built when the slave registered.
+    Offer* offer;
+    if (!offerPool.empty()) {
+      offer = offerPool.back();
+      offerPool.pop_back();
+    } else {
+      offer = new Offer();
+    }
 
-    Offer* offer = new Offer();
+    offer->CopyFrom(slave->offerTemplate);
     offer->mutable_id()->MergeFrom(newOfferId());
     offer->mutable_framework_id()->MergeFrom(framework->id());
-    offer->mutable_slave_id()->MergeFrom(slave->id);
-    offer->set_hostname(slave->info.hostname());
-    offer->mutable_url()->MergeFrom(url);
     offer->mutable_resources()->MergeFrom(offered);
-    offer->mutable_attributes()->MergeFrom(slave->info.attributes());
 
     // Add all framework's executors running on this slave.
     if (slave->executors.contains(framework->id())) {
@@ -6517,6 +7007,9 @@ void Master::offer(const FrameworkID& frameworkId,
     framework->addOffer(offer);
     slave->addOffer(offer);
 
+    http.invalidateStateCache(framework->id());
+    http.invalidateStateCache(slave->id);
+
     if (flags.offer_timeout.isSome()) {
       // Rescind the offer after the timeout elapses.
       offerTimers[offer->id()] =
@@ -6526,20 +7019,23 @@ void Master::offer(const FrameworkID& frameworkId,
               offer->id());
     }
 
+    // Add the offer *AND* the corresponding slave's PID. Note that
+    // the offer is copied into the message in place, rather than via
+    // an intermediate `Offer`, to avoid an extra copy per offer.
+    Offer* offer_ = message.add_offers();
+    offer_->CopyFrom(*offer);
+
     // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
     // offers so that frameworks do not see this resource. This is a
     // short term workaround. Revisit this once we resolve MESOS-1654.
-    Offer offer_ = *offer;
-    offer_.clear_resources();
+    offer_->clear_resources();
 
     foreach (const Resource& resource, offered) {
       if (resource.name() != "ephemeral_ports") {
-        offer_.add_resources()->CopyFrom(resource);
+        offer_->add_resources()->CopyFrom(resource);
       }
     }
 
-    // Add the offer *AND* the corresponding slave's PID.
-    message.add_offers()->MergeFrom(offer_);
     message.add_pids(slave->pid);
   }
 
@@ -6644,6 +7140,49 @@ void Master::inverseOffer(
 }
 
 
+// Whether the master hands out (and honors) re-authentication
+// tokens. The tokens are bearer credentials: presenting one is
+// sufficient to authenticate, so they must never cross the wire in
+// cleartext. The fast path is therefore only offered when all
+// libprocess traffic is encrypted; with downgrade support enabled
+// peers may still connect in cleartext.
+static bool authenticationTokensEnabled()
+{
+#ifdef USE_SSL_SOCKET
+  return process::network::openssl::flags().enabled &&
+         !process::network::openssl::flags().support_downgrade;
+#else
+  return false;
+#endif
+}
+
+
+// Mints an unguessable re-authentication token. Note that
+// UUID::random() is deliberately not used here: it is drawn from a
+// non-cryptographic generator whose state can be reconstructed by
+// anybody observing other ids the master mints from it (offer ids,
+// framework ids).
+static Try<string> generateAuthenticationToken()
+{
+  Try<int> fd = os::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  if (fd.isError()) {
+    return Error("Failed to open '/dev/urandom': " + fd.error());
+  }
+
+  Result<string> bytes = os::read(fd.get(), 16);
+
+  os::close(fd.get());
+
+  if (!bytes.isSome() || bytes->size() != 16u) {
+    return Error(
+        "Failed to read from '/dev/urandom': " +
+        (bytes.isError() ? bytes.error() : "short read"));
+  }
+
+  return base64::encode(bytes.get());
+}
+
+
 // TODO(vinod): If due to network partition there are two instances
 // of the framework that think they are leaders and try to
 // authenticate with master they would be stepping on each other's
@@ -6651,7 +7190,10 @@ void Master::inverseOffer(
 // 'authenticate' message doesn't contain the 'FrameworkID'.
 // 'from' is the authenticatee process with which to communicate.
 // 'pid' is the framework/slave process being authenticated.
-void Master::authenticate(const UPID& from, const UPID& pid)
+void Master::authenticate(
+    const UPID& from,
+    const UPID& pid,
+    const string& token)
 {
   ++metrics->messages_authenticate;
 
@@ -6713,7 +7255,47 @@ void Master::authenticate(const UPID& from, const UPID& pid)
 
     // Retry after the current authenticator session finishes.
     authenticating[pid]
-      .onAny(defer(self(), &Self::authenticate, from, pid));
+      .onAny(defer(self(), &Self::authenticate, from, pid, token));
+
+    return;
+  }
+
+  // Fast path: a client that authenticated recently may present the
+  // token it was handed in order to skip the SASL exchange.
+  if (!token.empty()) {
+    Option<AuthenticationToken> entry = authenticationTokens.get(token);
+
+    // Note that the token must have been issued to this same pid: a
+    // token that leaks to (or is guessed by) another client must not
+    // be replayable from elsewhere.
+    if (authenticationTokensEnabled() &&
+        entry.isSome() &&
+        entry->pid == pid &&
+        Clock::now() < entry->expiration) {
+      LOG(INFO) << "Successfully authenticated principal '"
+                << entry->principal << "' at " << pid
+                << " using an authentication token";
+
+      authenticated.put(pid, entry->principal);
+
+      AuthenticationCompletedMessage message;
+      send(from, message);
+
+      return;
+    }
+
+    if (entry.isSome()) {
+      authenticationTokens.erase(token);
+    }
+
+    LOG(INFO) << "Rejecting unknown or expired authentication token"
+              << " from " << pid;
+
+    // The client falls back to the full SASL exchange; we do not
+    // start an authenticator session here because the sender of a
+    // token is not an authenticatee.
+    AuthenticationFailedMessage message;
+    send(from, message);
 
     return;
   }
@@ -6752,6 +7334,42 @@ void Master::_authenticate(
               << "' at " << pid;
 
     authenticated.put(pid, future.get().get());
+
+    if (authenticationTokensEnabled()) {
+      // Periodically sweep out expired tokens.
+      if (Clock::now() >= authenticationTokenSweep) {
+        foreachpair (const string& token,
+                     const AuthenticationToken& entry,
+                     utils::copy(authenticationTokens)) {
+          if (Clock::now() >= entry.expiration) {
+            authenticationTokens.erase(token);
+          }
+        }
+
+        authenticationTokenSweep = Clock::now() + AUTHENTICATION_TOKEN_TTL;
+      }
+
+      // Hand the client a token it can present to skip the SASL
+      // exchange the next time it needs to re-authenticate (e.g.,
+      // after a ZooKeeper session expiration or a socket error).
+      Try<string> token = generateAuthenticationToken();
+
+      if (token.isError()) {
+        LOG(WARNING) << "Not handing out an authentication token: "
+                     << token.error();
+      } else {
+        AuthenticationToken entry;
+        entry.principal = future.get().get();
+        entry.pid = pid;
+        entry.expiration = Clock::now() + AUTHENTICATION_TOKEN_TTL;
+
+        authenticationTokens[token.get()] = entry;
+
+        AuthenticationTokenMessage message;
+        message.set_token(token.get());
+        send(pid, message);
+      }
+    }
   }
 
   CHECK(authenticating.contains(pid));
@@ -6772,8 +7390,8 @@ void Master::authenticationTimeout(Future<Option<string>> future)
 
 void Master::reconcileKnownSlave(
     Slave* slave,
-    const vector<ExecutorInfo>& executors,
-    const vector<Task>& tasks)
+    const RepeatedPtrField<ExecutorInfo>& executors,
+    const RepeatedPtrField<Task>& tasks)
 {
   CHECK_NOTNULL(slave);
 
@@ -6801,6 +7419,7 @@ void Master::reconcileKnownSlave(
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_delta_reregistration(true);
 
   SlaveReregisteredMessage reregistered;
   reregistered.mutable_slave_id()->CopyFrom(slave->id);
@@ -6944,6 +7563,13 @@ void Master::addFramework(Framework* framework)
 
   frameworks.registered[framework->id()] = framework;
 
+  // Note that any tasks of the framework reported by re-registering
+  // agents were already mirrored when they were added above; this
+  // completes the framework's snapshot entry.
+  reconciler->updateFramework(framework->info, framework->pid);
+
+  http.invalidateStateCache(framework->id());
+
   // Remove from 'frameworks.recovered' if necessary.
   frameworks.recovered.erase(framework->id());
 
@@ -7031,6 +7657,7 @@ void Master::failoverFramework(Framework* framework, const HttpConnection& http)
   }
 
   framework->updateConnection(http);
+  reconciler->updateFramework(framework->info, framework->pid);
 
   http.closed()
     .onAny(defer(self(), &Self::exited, framework->id(), http));
@@ -7065,6 +7692,7 @@ void Master::failoverFramework(Framework* framework, const UPID& newPid)
   }
 
   framework->updateConnection(newPid);
+  reconciler->updateFramework(framework->info, framework->pid);
   link(newPid);
 
   _failoverFramework(framework);
@@ -7110,6 +7738,8 @@ void Master::_failoverFramework(Framework* framework)
   // Reconnect and reactivate the framework.
   framework->connected = true;
 
+  http.invalidateStateCache(framework->id());
+
   // Reactivate the framework.
   // NOTE: We do this after recovering resources (above) so that
   // the allocator has the correct view of the framework's share.
@@ -7143,8 +7773,18 @@ void Master::removeFramework(Framework* framework)
 {
   CHECK_NOTNULL(framework);
 
+  if (framework->removing) {
+    // The framework's tasks are already being removed in chunks;
+    // the removal will complete once they have drained.
+    return;
+  }
+
+  framework->removing = true;
+
   LOG(INFO) << "Removing framework " << *framework;
 
+  http.invalidateStateCache(framework->id());
+
   if (framework->active) {
     // Tell the allocator to stop allocating resources to this framework.
     // TODO(vinod): Consider setting  framework->active to false here
@@ -7152,21 +7792,87 @@ void Master::removeFramework(Framework* framework)
     allocator->deactivateFramework(framework->id());
   }
 
+  // Tell slaves to shutdown the framework. The message is serialized
+  // once for all the slaves.
+  ShutdownFrameworkMessage message;
+  message.mutable_framework_id()->MergeFrom(framework->id());
+
+  vector<UPID> pids;
+  pids.reserve(slaves.registered.size());
+
   foreachvalue (Slave* slave, slaves.registered) {
     // Remove the pending tasks from the slave.
     slave->pendingTasks.erase(framework->id());
 
-    // Tell slaves to shutdown the framework.
-    ShutdownFrameworkMessage message;
-    message.mutable_framework_id()->MergeFrom(framework->id());
-    send(slave->pid, message);
+    pids.push_back(slave->pid);
   }
 
+  send(pids, message);
+
   // Remove the pending tasks from the framework.
+  foreachvalue (const TaskInfo& task, framework->pendingTasks) {
+    taskStateSummaries.subtract(
+        framework->id(), task.slave_id(), TASK_STAGING);
+  }
+
   framework->pendingTasks.clear();
 
-  // Remove pointers to the framework's tasks in slaves.
-  foreachvalue (Task* task, utils::copy(framework->tasks)) {
+  // Remove the framework's offers (if they weren't removed before).
+  foreach (Offer* offer, utils::copy(framework->offers)) {
+    allocator->recoverResources(
+        offer->framework_id(),
+        offer->slave_id(),
+        offer->resources(),
+        None());
+
+    removeOffer(offer);
+  }
+
+  // Also remove the inverse offers.
+  foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
+    allocator->updateInverseOffer(
+        inverseOffer->slave_id(),
+        inverseOffer->framework_id(),
+        UnavailableResources{
+            inverseOffer->resources(),
+            inverseOffer->unavailability()},
+        None());
+
+    removeInverseOffer(inverseOffer);
+  }
+
+  // TODO(benh): Similar code between removeFramework and
+  // failoverFramework needs to be shared!
+
+  // TODO(benh): unlink(framework->pid);
+
+  // For http frameworks, close the connection.
+  if (framework->http.isSome()) {
+    framework->http->close();
+  }
+
+  framework->unregisteredTime = Clock::now();
+
+  // Remove the framework's tasks in bounded chunks, yielding the
+  // master actor in between. The framework stays registered (but
+  // deactivated, with its offers rescinded and re-subscription
+  // refused) until the last chunk completes.
+  _removeFramework(framework->id());
+}
+
+
+void Master::_removeFramework(const FrameworkID& frameworkId)
+{
+  Framework* framework = getFramework(frameworkId);
+
+  CHECK_NOTNULL(framework);
+  CHECK(framework->removing);
+
+  size_t removed = 0;
+  while (!framework->tasks.empty() &&
+         removed < REMOVE_FRAMEWORK_TASKS_PER_DISPATCH) {
+    Task* task = framework->tasks.begin()->second;
+
     Slave* slave = slaves.registered.get(task->slave_id());
 
     // Since we only find out about tasks when the slave re-registers,
@@ -7199,32 +7905,34 @@ void Master::removeFramework(Framework* framework)
 
     updateTask(task, update);
     removeTask(task);
-  }
 
-  // Remove the framework's offers (if they weren't removed before).
-  foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
-        offer->framework_id(),
-        offer->slave_id(),
-        offer->resources(),
-        None());
+    ++removed;
+  }
 
-    removeOffer(offer);
+  if (!framework->tasks.empty()) {
+    dispatch(self(), &Master::_removeFramework, frameworkId);
+    return;
   }
 
-  // Also remove the inverse offers.
-  foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
-    allocator->updateInverseOffer(
-        inverseOffer->slave_id(),
-        inverseOffer->framework_id(),
-        UnavailableResources{
-            inverseOffer->resources(),
-            inverseOffer->unavailability()},
-        None());
+  __removeFramework(framework);
+}
 
-    removeInverseOffer(inverseOffer);
+
+void Master::__removeFramework(Framework* framework)
+{
+  CHECK_NOTNULL(framework);
+  CHECK(framework->tasks.empty());
+
+  // Remove any tasks that went pending while the framework's tasks
+  // were being removed, e.g., from an ACCEPT call that was in flight
+  // when the removal started.
+  foreachvalue (const TaskInfo& task, framework->pendingTasks) {
+    taskStateSummaries.subtract(
+        framework->id(), task.slave_id(), TASK_STAGING);
   }
 
+  framework->pendingTasks.clear();
+
   // Remove the framework's executors for correct resource accounting.
   foreachkey (const SlaveID& slaveId, utils::copy(framework->executors)) {
     Slave* slave = slaves.registered.get(slaveId);
@@ -7237,18 +7945,6 @@ void Master::removeFramework(Framework* framework)
     }
   }
 
-  // TODO(benh): Similar code between removeFramework and
-  // failoverFramework needs to be shared!
-
-  // TODO(benh): unlink(framework->pid);
-
-  // For http frameworks, close the connection.
-  if (framework->http.isSome()) {
-    framework->http->close();
-  }
-
-  framework->unregisteredTime = Clock::now();
-
   const string& role = framework->info.role();
   CHECK(activeRoles.contains(role))
     << "Unknown role " << role
@@ -7279,8 +7975,38 @@ void Master::removeFramework(Framework* framework)
     }
   }
 
+  // The framework is no longer registered, so its completed tasks no
+  // longer contribute to the task state summaries.
+  foreach (const shared_ptr<Task>& task, framework->completedTasks) {
+    taskStateSummaries.subtract(
+        framework->id(), task->slave_id(), task->state());
+  }
+
+  // Archive the completed framework and its tasks so that history
+  // beyond the in-memory buffers remains available via '/archive'.
+  // The write is asynchronous and best effort: losing it only loses
+  // history.
+  if (archivist.get() != nullptr) {
+    Archive::Framework archive;
+    archive.mutable_framework_info()->CopyFrom(framework->info);
+
+    if (framework->pid.isSome()) {
+      archive.set_pid(string(framework->pid.get()));
+    }
+
+    foreach (const shared_ptr<Task>& task, framework->completedTasks) {
+      archive.add_tasks()->CopyFrom(*task);
+    }
+
+    archivist->put(archive)
+      .onFailed([](const string& failure) {
+        LOG(WARNING) << "Failed to archive completed framework: " << failure;
+      });
+  }
+
   // Remove the framework.
   frameworks.registered.erase(framework->id());
+  reconciler->removeFramework(framework->id());
   allocator->removeFramework(framework->id());
 
   // Remove from 'frameworks.recovered' if necessary.
@@ -7299,6 +8025,9 @@ void Master::removeFramework(Slave* slave, Framework* framework)
   LOG(INFO) << "Removing framework " << *framework
             << " from agent " << *slave;
 
+  http.invalidateStateCache(framework->id());
+  http.invalidateStateCache(slave->id);
+
   // Remove pointers to framework's tasks in slaves, and send status
   // updates.
   // NOTE: A copy is needed because removeTask modifies slave->tasks.
@@ -7339,7 +8068,7 @@ void Master::removeFramework(Slave* slave, Framework* framework)
 
 void Master::addSlave(
     Slave* slave,
-    const vector<Archive::Framework>& completedFrameworks)
+    const RepeatedPtrField<Archive::Framework>& completedFrameworks)
 {
   CHECK_NOTNULL(slave);
   CHECK(!slaves.registered.contains(slave->id));
@@ -7347,6 +8076,9 @@ void Master::addSlave(
   CHECK(slaves.removed.get(slave->id).isNone());
 
   slaves.registered.put(slave);
+  reconciler->addSlave(slave->id);
+
+  http.invalidateStateCache(slave->id);
 
   link(slave->pid);
 
@@ -7354,18 +8086,8 @@ void Master::addSlave(
   CHECK(!machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.insert(slave->id);
 
-  // Set up an observer for the slave.
-  slave->observer = new SlaveObserver(
-      slave->pid,
-      slave->info,
-      slave->id,
-      self(),
-      slaves.limiter,
-      metrics,
-      flags.agent_ping_timeout,
-      flags.max_agent_ping_timeouts);
-
-  spawn(slave->observer);
+  // Begin observing the liveness of the slave.
+  dispatch(slaves.observer, &SlaveObserver::observe, slave->pid, slave->id);
 
   // Add the slave's executors to the frameworks.
   foreachkey (const FrameworkID& frameworkId, slave->executors) {
@@ -7591,6 +8313,10 @@ void Master::_removeSlave(
 
   // Mark the slave as being removed.
   slaves.registered.remove(slave);
+  reconciler->removeSlave(slave->id);
+
+  http.invalidateStateCache(slave->id);
+
   slaves.removed.put(slave->id, Nothing());
   authenticated.erase(slave->pid);
 
@@ -7599,10 +8325,8 @@ void Master::_removeSlave(
   CHECK(machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.erase(slave->id);
 
-  // Kill the slave observer.
-  terminate(slave->observer);
-  wait(slave->observer);
-  delete slave->observer;
+  // Stop observing the slave.
+  dispatch(slaves.observer, &SlaveObserver::forget, slave->pid);
 
   // TODO(benh): unlink(slave->pid);
 
@@ -7620,6 +8344,11 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 {
   CHECK_NOTNULL(task);
 
+  http.invalidateStateCache(task->framework_id());
+  http.invalidateStateCache(task->slave_id());
+
+  const TaskState previousState = task->state();
+
   // Get the unacknowledged status.
   const TaskStatus& status = update.status();
 
@@ -7668,6 +8397,24 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
     }
   }
 
+  // Account for the state transition in the task state summaries.
+  // Note that only tasks of registered frameworks are summarized,
+  // so orphaned tasks are not accounted for.
+  if (task->state() != previousState) {
+    // Keep the by-state task index in sync with the transition.
+    tasksByState[previousState].erase(task);
+    tasksByState[task->state()].insert(task);
+
+    Framework* framework = getFramework(task->framework_id());
+    if (framework != nullptr && framework->tasks.contains(task->task_id())) {
+      taskStateSummaries.transition(
+          task->framework_id(),
+          task->slave_id(),
+          previousState,
+          task->state());
+    }
+  }
+
   // TODO(brenden): Consider wiping the `message` field?
   if (task->statuses_size() > 0 &&
       task->statuses(task->statuses_size() - 1).state() == status.state()) {
@@ -7683,6 +8430,14 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
   // MESOS-1746.
   task->mutable_statuses(task->statuses_size() - 1)->clear_data();
 
+  // Mirror the new task state onto the reconciler's snapshot. Tasks
+  // of unregistered frameworks are not mirrored; they are added when
+  // the framework (re-)registers (see `Framework::addTask`).
+  if (frameworks.registered.contains(task->framework_id())) {
+    reconciler->updateTask(
+        task->framework_id(), task->task_id(), ReconcilerTask(*task));
+  }
+
   if (sendSubscribersUpdate && !subscribers.subscribed.empty()) {
     subscribers.send(protobuf::master::event::createTaskUpdated(
         *task, task->state(), status));
@@ -7769,6 +8524,9 @@ void Master::removeTask(Task* task)
   Slave* slave = slaves.registered.get(task->slave_id());
   CHECK_NOTNULL(slave);
 
+  http.invalidateStateCache(task->framework_id());
+  http.invalidateStateCache(slave->id);
+
   if (!protobuf::isTerminalState(task->state())) {
     LOG(WARNING) << "Removing task " << task->task_id()
                  << " with resources " << task->resources()
@@ -7820,6 +8578,9 @@ void Master::removeExecutor(
   allocator->recoverResources(
       frameworkId, slave->id, executor.resources(), None());
 
+  http.invalidateStateCache(frameworkId);
+  http.invalidateStateCache(slave->id);
+
   Framework* framework = getFramework(frameworkId);
   if (framework != nullptr) { // The framework might not be re-registered yet.
     framework->removeExecutor(slave->id, executorId);
@@ -7886,6 +8647,9 @@ void Master::removeOffer(Offer* offer, bool rescind)
 
   slave->removeOffer(offer);
 
+  http.invalidateStateCache(framework->id());
+  http.invalidateStateCache(slave->id);
+
   if (rescind) {
     RescindResourceOfferMessage message;
     message.mutable_offer_id()->MergeFrom(offer->id());
@@ -7899,9 +8663,17 @@ void Master::removeOffer(Offer* offer, bool rescind)
     offerTimers.erase(offer->id());
   }
 
-  // Delete it.
+  // Recycle the offer, if there is room in the pool, so that the
+  // next offer cycle can reuse it. `Clear()` retains the memory
+  // already allocated for the offer's sub-messages.
   offers.erase(offer->id());
-  delete offer;
+
+  if (offerPool.size() < MAX_OFFER_POOL_SIZE) {
+    offer->Clear();
+    offerPool.push_back(offer);
+  } else {
+    delete offer;
+  }
 }
 
 
@@ -8113,6 +8885,10 @@ double Master::_frameworks_inactive()
 }
 
 
+// NOTE: The task state gauges below read the `tasksByState` index
+// instead of scanning every task on every registered agent, so a
+// metrics scrape does not grow with the number of tasks.
+
 double Master::_tasks_staging()
 {
   double count = 0.0;
@@ -8122,15 +8898,8 @@ double Master::_tasks_staging()
     count += framework->pendingTasks.size();
   }
 
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_STAGING) {
-          count++;
-        }
-      }
-    }
+  if (tasksByState.contains(TASK_STAGING)) {
+    count += tasksByState.at(TASK_STAGING).size();
   }
 
   return count;
@@ -8139,92 +8908,93 @@ double Master::_tasks_staging()
 
 double Master::_tasks_starting()
 {
-  double count = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_STARTING) {
-          count++;
-        }
-      }
-    }
+  if (tasksByState.contains(TASK_STARTING)) {
+    return static_cast<double>(tasksByState.at(TASK_STARTING).size());
   }
 
-  return count;
+  return 0.0;
 }
 
 
 double Master::_tasks_running()
 {
-  double count = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_RUNNING) {
-          count++;
-        }
-      }
-    }
+  if (tasksByState.contains(TASK_RUNNING)) {
+    return static_cast<double>(tasksByState.at(TASK_RUNNING).size());
   }
 
-  return count;
+  return 0.0;
 }
 
 
 double Master::_tasks_killing()
 {
-  double count = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_KILLING) {
-          count++;
-        }
-      }
-    }
+  if (tasksByState.contains(TASK_KILLING)) {
+    return static_cast<double>(tasksByState.at(TASK_KILLING).size());
   }
 
-  return count;
+  return 0.0;
 }
 
 
-double Master::_resources_total(const string& name)
+void Master::refreshResourceMetrics()
 {
-  double total = 0.0;
+  if (resourceMetrics.isSome() &&
+      Clock::now() - resourceMetrics->updated <
+        METRICS_RESOURCES_STALENESS_BOUND) {
+    return;
+  }
+
+  ResourceMetrics metrics;
+  metrics.updated = Clock::now();
 
+  // A single pass over the registered agents computes the sums
+  // behind all of the per-resource gauges.
   foreachvalue (Slave* slave, slaves.registered) {
     foreach (const Resource& resource, slave->info.resources()) {
-      if (resource.name() == name && resource.type() == Value::SCALAR) {
-        total += resource.scalar().value();
+      if (resource.type() == Value::SCALAR) {
+        metrics.totals[resource.name()] += resource.scalar().value();
       }
     }
-  }
 
-  return total;
-}
-
-
-double Master::_resources_used(const string& name)
-{
-  double used = 0.0;
+    foreach (const Resource& resource, slave->totalResources.revocable()) {
+      if (resource.type() == Value::SCALAR) {
+        metrics.revocableTotals[resource.name()] += resource.scalar().value();
+      }
+    }
 
-  foreachvalue (Slave* slave, slaves.registered) {
     foreachvalue (const Resources& resources, slave->usedResources) {
-      foreach (const Resource& resource, resources.nonRevocable()) {
-        if (resource.name() == name && resource.type() == Value::SCALAR) {
-          used += resource.scalar().value();
+      foreach (const Resource& resource, resources) {
+        if (resource.type() != Value::SCALAR) {
+          continue;
+        }
+
+        if (Resources::isRevocable(resource)) {
+          metrics.revocableUsed[resource.name()] += resource.scalar().value();
+        } else {
+          metrics.nonRevocableUsed[resource.name()] +=
+            resource.scalar().value();
         }
       }
     }
   }
 
-  return used;
+  resourceMetrics = std::move(metrics);
+}
+
+
+double Master::_resources_total(const string& name)
+{
+  refreshResourceMetrics();
+
+  return resourceMetrics->totals.get(name).getOrElse(0.0);
+}
+
+
+double Master::_resources_used(const string& name)
+{
+  refreshResourceMetrics();
+
+  return resourceMetrics->nonRevocableUsed.get(name).getOrElse(0.0);
 }
 
 
@@ -8242,35 +9012,17 @@ double Master::_resources_percent(const string& name)
 
 double Master::_resources_revocable_total(const string& name)
 {
-  double total = 0.0;
+  refreshResourceMetrics();
 
-  foreachvalue (Slave* slave, slaves.registered) {
-    foreach (const Resource& resource, slave->totalResources.revocable()) {
-      if (resource.name() == name && resource.type() == Value::SCALAR) {
-        total += resource.scalar().value();
-      }
-    }
-  }
-
-  return total;
+  return resourceMetrics->revocableTotals.get(name).getOrElse(0.0);
 }
 
 
 double Master::_resources_revocable_used(const string& name)
 {
-  double used = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    foreachvalue (const Resources& resources, slave->usedResources) {
-      foreach (const Resource& resource, resources.revocable()) {
-        if (resource.name() == name && resource.type() == Value::SCALAR) {
-          used += resource.scalar().value();
-        }
-      }
-    }
-  }
+  refreshResourceMetrics();
 
-  return used;
+  return resourceMetrics->revocableUsed.get(name).getOrElse(0.0);
 }
 
 
@@ -8302,6 +9054,11 @@ void Slave::addTask(Task* task)
 
   tasks[frameworkId][taskId] = task;
 
+  master->tasksByState[task->state()].insert(task);
+
+  master->http.invalidateStateCache(frameworkId);
+  master->http.invalidateStateCache(id);
+
   if (!protobuf::isTerminalState(task->state())) {
     usedResources[frameworkId] += task->resources();
   }
@@ -8316,13 +9073,173 @@ void Slave::addTask(Task* task)
 }
 
 
+void Slave::removeTask(Task* task)
+{
+  const TaskID& taskId = task->task_id();
+  const FrameworkID& frameworkId = task->framework_id();
+
+  CHECK(tasks[frameworkId].contains(taskId))
+    << "Unknown task " << taskId << " of framework " << frameworkId;
+
+  if (!protobuf::isTerminalState(task->state())) {
+    usedResources[frameworkId] -= task->resources();
+    if (!tasks.contains(frameworkId) && !executors.contains(frameworkId)) {
+      usedResources.erase(frameworkId);
+    }
+  }
+
+  tasks[frameworkId].erase(taskId);
+  if (tasks[frameworkId].empty()) {
+    tasks.erase(frameworkId);
+  }
+
+  master->tasksByState[task->state()].erase(task);
+
+  killedTasks.remove(frameworkId, taskId);
+}
+
+
+const TaskStateSummary TaskStateSummary::EMPTY;
+
+
+void Master::TaskStateSummaries::add(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const TaskState& state)
+{
+  frameworkSummaries[frameworkId].add(state);
+  slaveSummaries[slaveId].add(state);
+
+  ++slaveFrameworks[slaveId][frameworkId];
+  ++frameworkSlaves[frameworkId][slaveId];
+}
+
+
+void Master::TaskStateSummaries::subtract(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const TaskState& state)
+{
+  frameworkSummaries[frameworkId].subtract(state);
+  if (frameworkSummaries[frameworkId].empty()) {
+    frameworkSummaries.erase(frameworkId);
+  }
+
+  slaveSummaries[slaveId].subtract(state);
+  if (slaveSummaries[slaveId].empty()) {
+    slaveSummaries.erase(slaveId);
+  }
+
+  if (--slaveFrameworks[slaveId][frameworkId] == 0) {
+    slaveFrameworks[slaveId].erase(frameworkId);
+    if (slaveFrameworks[slaveId].empty()) {
+      slaveFrameworks.erase(slaveId);
+    }
+  }
+
+  if (--frameworkSlaves[frameworkId][slaveId] == 0) {
+    frameworkSlaves[frameworkId].erase(slaveId);
+    if (frameworkSlaves[frameworkId].empty()) {
+      frameworkSlaves.erase(frameworkId);
+    }
+  }
+}
+
+
+void Master::TaskStateSummaries::transition(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const TaskState& previous,
+    const TaskState& current)
+{
+  frameworkSummaries[frameworkId].subtract(previous);
+  frameworkSummaries[frameworkId].add(current);
+
+  slaveSummaries[slaveId].subtract(previous);
+  slaveSummaries[slaveId].add(current);
+}
+
+
+const TaskStateSummary& Master::TaskStateSummaries::framework(
+    const FrameworkID& frameworkId) const
+{
+  const auto iterator = frameworkSummaries.find(frameworkId);
+  return iterator != frameworkSummaries.end() ?
+    iterator->second : TaskStateSummary::EMPTY;
+}
+
+
+const TaskStateSummary& Master::TaskStateSummaries::slave(
+    const SlaveID& slaveId) const
+{
+  const auto iterator = slaveSummaries.find(slaveId);
+  return iterator != slaveSummaries.end() ?
+    iterator->second : TaskStateSummary::EMPTY;
+}
+
+
+const hashmap<FrameworkID, size_t>& Master::TaskStateSummaries::frameworks(
+    const SlaveID& slaveId) const
+{
+  static const hashmap<FrameworkID, size_t> empty;
+
+  const auto iterator = slaveFrameworks.find(slaveId);
+  return iterator != slaveFrameworks.end() ? iterator->second : empty;
+}
+
+
+const hashmap<SlaveID, size_t>& Master::TaskStateSummaries::slaves(
+    const FrameworkID& frameworkId) const
+{
+  static const hashmap<SlaveID, size_t> empty;
+
+  const auto iterator = frameworkSlaves.find(frameworkId);
+  return iterator != frameworkSlaves.end() ? iterator->second : empty;
+}
+
+
 void Master::Subscribers::send(const mesos::master::Event& event)
 {
   VLOG(1) << "Notifying all active subscribers about " << event.type() << " "
           << "event";
 
+  // Evolve and recordio-encode the event once per content type and
+  // share the encoded frame across all subscribers, rather than
+  // serializing the event again for every connection.
+  const v1::master::Event v1Event = evolve(event);
+
+  std::map<ContentType, std::string> frames;
+
+  vector<UUID> slow;
+
   foreachvalue (const Owned<Subscriber>& subscriber, subscribed) {
-    subscriber->http.send<mesos::master::Event, v1::master::Event>(event);
+    const ContentType contentType = subscriber->http.contentType;
+
+    if (frames.count(contentType) == 0) {
+      ::recordio::Encoder<v1::master::Event> encoder(
+          lambda::bind(serialize, contentType, lambda::_1));
+
+      frames[contentType] = encoder.encode(v1Event);
+    }
+
+    // Disconnect subscribers that are not consuming the event stream
+    // fast enough, so that their pipes do not accumulate an unbounded
+    // backlog of encoded events.
+    if (subscriber->http.writer.outstanding() >
+        MAX_SUBSCRIBER_EVENT_BACKLOG.bytes()) {
+      slow.push_back(subscriber->http.streamId);
+      continue;
+    }
+
+    subscriber->http.writer.write(frames[contentType]);
+  }
+
+  foreach (const UUID& id, slow) {
+    LOG(WARNING) << "Removing subscriber " << id << " from the list of "
+                 << "active subscribers: the event stream backlog exceeded "
+                 << MAX_SUBSCRIBER_EVENT_BACKLOG;
+
+    subscribed.erase(id);
   }
 }
 
@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -60,10 +61,12 @@
 #include <stout/multihashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/recordio.hpp>
+#include <stout/stringify.hpp>
 #include <stout/uuid.hpp>
 
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
+#include "common/recordio.hpp"
 #include "common/resources_utils.hpp"
 
 #include "files/files.hpp"
@@ -75,6 +78,7 @@
 #include "master/flags.hpp"
 #include "master/machine.hpp"
 #include "master/metrics.hpp"
+#include "master/reconciler.hpp"
 #include "master/registrar.hpp"
 #include "master/validation.hpp"
 
@@ -100,6 +104,7 @@ class WhitelistWatcher;
 
 namespace master {
 
+class Archivist;
 class Master;
 class SlaveObserver;
 
@@ -117,10 +122,10 @@ struct Slave
         const std::string& _version,
         const process::Time& _registeredTime,
         const Resources& _checkpointedResources,
-        const std::vector<ExecutorInfo> executorInfos =
-          std::vector<ExecutorInfo>(),
-        const std::vector<Task> tasks =
-          std::vector<Task>())
+        const google::protobuf::RepeatedPtrField<ExecutorInfo>& executorInfos =
+          google::protobuf::RepeatedPtrField<ExecutorInfo>(),
+        const google::protobuf::RepeatedPtrField<Task>& tasks =
+          google::protobuf::RepeatedPtrField<Task>())
     : master(_master),
       id(_info.id()),
       info(_info),
@@ -130,8 +135,8 @@ struct Slave
       registeredTime(_registeredTime),
       connected(true),
       active(true),
-      checkpointedResources(_checkpointedResources),
-      observer(nullptr)
+      batchedAcknowledgements(false),
+      checkpointedResources(_checkpointedResources)
   {
     CHECK(_info.has_id());
 
@@ -143,6 +148,24 @@ struct Slave
     CHECK_SOME(resources);
     totalResources = resources.get();
 
+    // Pre-build the parts of an offer that are fixed for the lifetime
+    // of this slave (the slave's id, hostname, URL and attributes), so
+    // that `Master::offer()` can copy them instead of reconstructing
+    // these sub-messages for every offer. NOTE: A `Slave` is recreated
+    // when the slave re-registers, so changes to the slave's info are
+    // reflected in the template.
+    offerTemplate.mutable_slave_id()->CopyFrom(id);
+    offerTemplate.set_hostname(info.hostname());
+    offerTemplate.mutable_attributes()->CopyFrom(info.attributes());
+
+    // TODO(bmahler): Set "https" if only "https" is supported.
+    mesos::URL* url = offerTemplate.mutable_url();
+    url->set_scheme("http");
+    url->mutable_address()->set_hostname(info.hostname());
+    url->mutable_address()->set_ip(stringify(pid.address.ip));
+    url->mutable_address()->set_port(pid.address.port);
+    url->set_path("/" + pid.id);
+
     foreach (const ExecutorInfo& executorInfo, executorInfos) {
       CHECK(executorInfo.has_framework_id());
       addExecutor(executorInfo.framework_id(), executorInfo);
@@ -184,28 +207,7 @@ struct Slave
     }
   }
 
-  void removeTask(Task* task)
-  {
-    const TaskID& taskId = task->task_id();
-    const FrameworkID& frameworkId = task->framework_id();
-
-    CHECK(tasks[frameworkId].contains(taskId))
-      << "Unknown task " << taskId << " of framework " << frameworkId;
-
-    if (!protobuf::isTerminalState(task->state())) {
-      usedResources[frameworkId] -= task->resources();
-      if (!tasks.contains(frameworkId) && !executors.contains(frameworkId)) {
-        usedResources.erase(frameworkId);
-      }
-    }
-
-    tasks[frameworkId].erase(taskId);
-    if (tasks[frameworkId].empty()) {
-      tasks.erase(frameworkId);
-    }
-
-    killedTasks.remove(frameworkId, taskId);
-  }
+  void removeTask(Task* task);
 
   void addOffer(Offer* offer)
   {
@@ -303,6 +305,13 @@ struct Slave
   // No offers will be made for a deactivated slave.
   bool active;
 
+  // Whether the agent advertised support for
+  // `StatusUpdateAcknowledgementsMessage` when it (re-)registered.
+  // Older agents silently drop unknown message types, so the master
+  // only sends the batched form to agents that set this (see
+  // `Master::flushAcknowledgements`).
+  bool batchedAcknowledgements;
+
   // Executors running on this slave.
   hashmap<FrameworkID, hashmap<ExecutorID, ExecutorInfo>> executors;
 
@@ -347,7 +356,9 @@ struct Slave
   // includes revocable resources as well.
   Resources totalResources;
 
-  SlaveObserver* observer;
+  // The per-slave parts of an offer that do not change between
+  // offers (see the constructor).
+  Offer offerTemplate;
 
 private:
   Slave(const Slave&);              // No copying.
@@ -378,10 +389,12 @@ struct HttpConnection
   template <typename Message, typename Event = v1::scheduler::Event>
   bool send(const Message& message)
   {
-    ::recordio::Encoder<Event> encoder (lambda::bind(
-        serialize, contentType, lambda::_1));
+    const Event event = evolve(message);
 
-    return writer.write(encoder.encode(evolve(message)));
+    // Write the length header and the serialized event to the pipe
+    // as separate chunks so that the payload is moved rather than
+    // copied into a contiguous "Record-IO" frame.
+    return recordio::write(writer, serialize(contentType, event));
   }
 
   bool close()
@@ -400,6 +413,95 @@ struct HttpConnection
 };
 
 
+// Summarizes the number of tasks in each 'TaskState'. The master
+// maintains these summaries incrementally for frameworks and agents
+// (see Master::TaskStateSummaries) so that summary endpoints do not
+// have to iterate the tasks.
+struct TaskStateSummary
+{
+  // TODO(jmlvanre): Possibly clean this up as per MESOS-2694.
+  const static TaskStateSummary EMPTY;
+
+  TaskStateSummary()
+    : staging(0),
+      starting(0),
+      running(0),
+      killing(0),
+      finished(0),
+      killed(0),
+      failed(0),
+      lost(0),
+      error(0),
+      dropped(0),
+      unreachable(0),
+      gone(0),
+      gone_by_operator(0),
+      unknown(0) {}
+
+  // Account for a task in the given state.
+  void add(const TaskState& state) { apply(state, 1); }
+
+  // Stop accounting for a task in the given state.
+  void subtract(const TaskState& state) { apply(state, -1); }
+
+  bool empty() const
+  {
+    return staging == 0 &&
+           starting == 0 &&
+           running == 0 &&
+           killing == 0 &&
+           finished == 0 &&
+           killed == 0 &&
+           failed == 0 &&
+           lost == 0 &&
+           error == 0 &&
+           dropped == 0 &&
+           unreachable == 0 &&
+           gone == 0 &&
+           gone_by_operator == 0 &&
+           unknown == 0;
+  }
+
+  size_t staging;
+  size_t starting;
+  size_t running;
+  size_t killing;
+  size_t finished;
+  size_t killed;
+  size_t failed;
+  size_t lost;
+  size_t error;
+  size_t dropped;
+  size_t unreachable;
+  size_t gone;
+  size_t gone_by_operator;
+  size_t unknown;
+
+private:
+  void apply(const TaskState& state, int64_t delta)
+  {
+    switch (state) {
+      case TASK_STAGING: { staging += delta; break; }
+      case TASK_STARTING: { starting += delta; break; }
+      case TASK_RUNNING: { running += delta; break; }
+      case TASK_KILLING: { killing += delta; break; }
+      case TASK_FINISHED: { finished += delta; break; }
+      case TASK_KILLED: { killed += delta; break; }
+      case TASK_FAILED: { failed += delta; break; }
+      case TASK_LOST: { lost += delta; break; }
+      case TASK_ERROR: { error += delta; break; }
+      case TASK_DROPPED: { dropped += delta; break; }
+      case TASK_UNREACHABLE: { unreachable += delta; break; }
+      case TASK_GONE: { gone += delta; break; }
+      case TASK_GONE_BY_OPERATOR: { gone_by_operator += delta; break; }
+      case TASK_UNKNOWN: { unknown += delta; break; }
+      // No default case allows for a helpful compiler error if we
+      // introduce a new state.
+    }
+  }
+};
+
+
 class Master : public ProtobufProcess<Master>
 {
 public:
@@ -483,17 +585,17 @@ public:
       const process::UPID& from,
       const SlaveInfo& slaveInfo,
       const std::vector<Resource>& checkpointedResources,
-      const std::string& version);
+      const std::string& version,
+      bool batchedAcknowledgements);
 
+  // Handles an agent re-registration. The message is parsed off the
+  // master actor by the intake pipeline in `_visit` and its
+  // ownership is shared down the (asynchronous) re-admission chain,
+  // so that the task and executor payloads are not copied at each
+  // hop. A null message indicates a payload that failed to parse.
   void reregisterSlave(
       const process::UPID& from,
-      const SlaveInfo& slaveInfo,
-      const std::vector<Resource>& checkpointedResources,
-      const std::vector<ExecutorInfo>& executorInfos,
-      const std::vector<Task>& tasks,
-      const std::vector<FrameworkInfo>& frameworks,
-      const std::vector<Archive::Framework>& completedFrameworks,
-      const std::string& version);
+      const process::Owned<ReregisterSlaveMessage>& message);
 
   void unregisterSlave(
       const process::UPID& from,
@@ -527,7 +629,8 @@ public:
 
   void authenticate(
       const process::UPID& from,
-      const process::UPID& pid);
+      const process::UPID& pid,
+      const std::string& token);
 
   // TODO(bmahler): It would be preferred to use a unique libprocess
   // Process identifier (PID is not sufficient) for identifying the
@@ -556,6 +659,13 @@ public:
   // Made public for testing purposes.
   process::Future<Nothing> _recover(const Registry& registry);
 
+  // Continuation of removeFramework(): removes up to
+  // `REMOVE_FRAMEWORK_TASKS_PER_DISPATCH` of the framework's tasks
+  // and either re-dispatches itself or finishes the removal once no
+  // tasks remain.
+  // Made public for testing purposes.
+  void _removeFramework(const FrameworkID& frameworkId);
+
   MasterInfo info() const
   {
     return info_;
@@ -583,6 +693,31 @@ protected:
       const process::MessageEvent& event,
       const Option<std::string>& principal);
 
+  // Admits an event through `limiter`: it is either processed
+  // immediately if a token is available or queued until the token
+  // bucket refills. 'principal' being None refers to
+  // 'defaultLimiter'.
+  void throttle(
+      BoundedRateLimiter* limiter,
+      const Option<std::string>& principal,
+      const process::MessageEvent& event);
+
+  void throttle(
+      BoundedRateLimiter* limiter,
+      const Option<std::string>& principal,
+      const process::ExitedEvent& event);
+
+  // Schedules `drainThrottledEvents` for when the next token of the
+  // limiter accrues, unless a drain is already scheduled.
+  void scheduleDrain(
+      BoundedRateLimiter* limiter,
+      const Option<std::string>& principal);
+
+  // Processes events queued by the limiter for 'principal' as its
+  // token bucket refills. 'principal' being None refers to
+  // 'defaultLimiter'.
+  void drainThrottledEvents(const Option<std::string>& principal);
+
   // Continuations of visit().
   void _visit(const process::MessageEvent& event);
   void _visit(const process::ExitedEvent& event);
@@ -603,23 +738,18 @@ protected:
       const process::UPID& pid,
       const std::vector<Resource>& checkpointedResources,
       const std::string& version,
+      bool batchedAcknowledgements,
       const process::Future<bool>& admit);
 
   void _reregisterSlave(
-      const SlaveInfo& slaveInfo,
       const process::UPID& pid,
-      const std::vector<Resource>& checkpointedResources,
-      const std::vector<ExecutorInfo>& executorInfos,
-      const std::vector<Task>& tasks,
-      const std::vector<FrameworkInfo>& frameworks,
-      const std::vector<Archive::Framework>& completedFrameworks,
-      const std::string& version,
+      const process::Owned<ReregisterSlaveMessage>& message,
       const process::Future<bool>& readmit);
 
   void __reregisterSlave(
       Slave* slave,
-      const std::vector<Task>& tasks,
-      const std::vector<FrameworkInfo>& frameworks);
+      const google::protobuf::RepeatedPtrField<Task>& tasks,
+      const google::protobuf::RepeatedPtrField<FrameworkInfo>& frameworks);
 
   // 'authenticate' is the future returned by the authenticator.
   void _authenticate(
@@ -635,18 +765,27 @@ protected:
   void contended(const process::Future<process::Future<Nothing>>& candidacy);
 
   // Task reconciliation, split from the message handler
-  // to allow re-use.
+  // to allow re-use. The request is answered by the reconciler from
+  // its snapshot of the task and agent state (see `Reconciler`).
   void _reconcileTasks(
       Framework* framework,
       const std::vector<TaskStatus>& statuses);
 
+  // Delivers reconciliation status updates produced by the
+  // reconciler for an HTTP framework, whose connection lives on the
+  // master (PID-based frameworks are sent their updates directly
+  // from the reconciler).
+  void sendReconciliationUpdates(
+      const FrameworkID& frameworkId,
+      const std::vector<StatusUpdate>& updates);
+
   // When a slave that is known to the master re-registers, we need to
   // reconcile the master's view of the slave's tasks and executors.
   // This function also sends the `ReregisterSlaveMessage`.
   void reconcileKnownSlave(
       Slave* slave,
-      const std::vector<ExecutorInfo>& executors,
-      const std::vector<Task>& tasks);
+      const google::protobuf::RepeatedPtrField<ExecutorInfo>& executors,
+      const google::protobuf::RepeatedPtrField<Task>& tasks);
 
   // Add a framework.
   void addFramework(Framework* framework);
@@ -662,9 +801,18 @@ protected:
   void _failoverFramework(Framework* framework);
 
   // Kill all of a framework's tasks, delete the framework object, and
-  // reschedule offers that were assigned to this framework.
+  // reschedule offers that were assigned to this framework. The
+  // framework is deactivated and its offers are rescinded
+  // immediately, but its tasks are removed incrementally in bounded
+  // chunks (yielding the master actor in between) so that removing a
+  // framework with many tasks does not stall other processing.
   void removeFramework(Framework* framework);
 
+  // Completes a framework removal once all of its tasks have been
+  // removed: cleans up executors, roles, principals and unregisters
+  // the framework from the allocator.
+  void __removeFramework(Framework* framework);
+
   // Remove a framework from the slave, i.e., remove its tasks and
   // executors and recover the resources.
   void removeFramework(Slave* slave, Framework* framework);
@@ -678,8 +826,9 @@ protected:
   // Add a slave.
   void addSlave(
       Slave* slave,
-      const std::vector<Archive::Framework>& completedFrameworks =
-        std::vector<Archive::Framework>());
+      const google::protobuf::RepeatedPtrField<Archive::Framework>&
+        completedFrameworks =
+          google::protobuf::RepeatedPtrField<Archive::Framework>());
 
   void _markUnreachable(
       Slave* slave,
@@ -721,10 +870,12 @@ protected:
   process::Future<bool> authorizeFramework(
       const FrameworkInfo& frameworkInfo);
 
-  // Returns whether the task is authorized.
-  // Returns failure for transient authorization failures.
-  process::Future<bool> authorizeTask(
-      const TaskInfo& task,
+  // Returns whether each of the tasks is authorized, in order.
+  // Returns failures for transient authorization failures. The tasks
+  // are authorized as a single batch so that one round trip into the
+  // authorizer covers an entire launch group.
+  std::vector<process::Future<bool>> authorizeTasks(
+      const google::protobuf::RepeatedPtrField<TaskInfo>& tasks,
       Framework* framework);
 
   /**
@@ -948,6 +1099,11 @@ private:
       Framework* framework,
       const scheduler::Call::Acknowledge& acknowledge);
 
+  // Sends all pending status update acknowledgements queued for the
+  // given agent, batching them into a single message when there is
+  // more than one.
+  void flushAcknowledgements(const SlaveID& slaveId);
+
   void reconcile(
       Framework* framework,
       const scheduler::Call::Reconcile& reconcile);
@@ -1073,9 +1229,9 @@ private:
     // (including rescinding) is moved to allocator.
     void rescindOffers(const mesos::quota::QuotaInfo& request) const;
 
-    process::Future<bool> authorizeGetQuota(
+    std::vector<process::Future<bool>> authorizeGetQuotas(
         const Option<std::string>& principal,
-        const std::string& role) const;
+        const std::vector<std::string>& roles) const;
 
     // TODO(mpark): The following functions `authorizeSetQuota` and
     // `authorizeRemoveQuota` should be replaced with `authorizeUpdateQuota` at
@@ -1147,9 +1303,9 @@ private:
         ContentType contentType) const;
 
   private:
-    process::Future<bool> authorizeGetWeight(
+    std::vector<process::Future<bool>> authorizeGetWeights(
         const Option<std::string>& principal,
-        const std::string& role) const;
+        const std::vector<std::string>& roles) const;
 
     process::Future<bool> authorizeUpdateWeights(
         const Option<std::string>& principal,
@@ -1183,6 +1339,8 @@ private:
   {
   public:
     explicit Http(Master* _master) : master(_master),
+                                     stateGeneration(0),
+                                     outstandingOperatorReads(0),
                                      quotaHandler(_master),
                                      weightsHandler(_master) {}
 
@@ -1190,6 +1348,51 @@ private:
     // desired request handler to get consistent request logging.
     static void log(const process::http::Request& request);
 
+    // Classes of requests used for admission control. Operator reads
+    // are admitted up to `MAX_OUTSTANDING_OPERATOR_READS` and shed
+    // with "503 Service Unavailable" beyond that; scheduler calls
+    // and internal traffic are never shed.
+    enum RequestClass
+    {
+      OPERATOR_READ,
+      SCHEDULER_CALL,
+      INTERNAL
+    };
+
+    // Runs `f` if the given request class is within its concurrency
+    // budget and returns a "503 Service Unavailable" response
+    // otherwise. The budget is released once the returned response
+    // future completes.
+    process::Future<process::http::Response> admit(
+        RequestClass requestClass,
+        const lambda::function<
+            process::Future<process::http::Response>()>& f) const;
+
+    // Invalidates the cached "/state" JSON fragment, if any, for the
+    // given agent or framework. Invoked by the master on agent, task
+    // and framework state transitions.
+    // Entity tag describing the master's current state, derived from
+    // the master ID and the state generation. Clients can poll the
+    // read-only endpoints cheaply by passing a previous tag back via
+    // the "If-None-Match" request header.
+    std::string stateETag() const
+    {
+      return "\"" + master->info().id() + "-" +
+             stringify(stateGeneration) + "\"";
+    }
+
+    void invalidateStateCache(const SlaveID& slaveId)
+    {
+      ++stateGeneration;
+      cachedSlaveJson.erase(slaveId);
+    }
+
+    void invalidateStateCache(const FrameworkID& frameworkId)
+    {
+      ++stateGeneration;
+      cachedFrameworkJson.erase(frameworkId);
+    }
+
     // /api/v1
     process::Future<process::http::Response> api(
         const process::http::Request& request,
@@ -1210,6 +1413,11 @@ private:
         const process::http::Request& request,
         const Option<std::string>& principal) const;
 
+    // /master/archive
+    process::Future<process::http::Response> archive(
+        const process::http::Request& request,
+        const Option<std::string>& principal) const;
+
     // /master/flags
     process::Future<process::http::Response> flags(
         const process::http::Request& request,
@@ -1300,6 +1508,7 @@ private:
 
     static std::string API_HELP();
     static std::string SCHEDULER_HELP();
+    static std::string ARCHIVE_HELP();
     static std::string FLAGS_HELP();
     static std::string FRAMEWORKS_HELP();
     static std::string HEALTH_HELP();
@@ -1335,6 +1544,20 @@ private:
         const std::string& order,
         const Option<std::string>& principal) const;
 
+    // State carried by a streamed ("?streaming=true") "/state" or
+    // "/tasks" response between the dispatches that emit its chunks.
+    struct StateStreamContext;
+    struct TasksStreamContext;
+
+    // Emit the next batch of chunks of a streamed response onto its
+    // pipe and re-dispatch onto the master actor until the response
+    // is complete; see the "streaming" paths in `state` and `tasks`.
+    void streamState(
+        const std::shared_ptr<StateStreamContext>& context) const;
+
+    void streamTasks(
+        const std::shared_ptr<TasksStreamContext>& context) const;
+
     process::Future<process::http::Response> _teardown(
         const FrameworkID& id) const;
 
@@ -1546,6 +1769,54 @@ private:
 
     Master* master;
 
+    // Pre-serialized JSON fragments for registered agents and
+    // frameworks, keyed by ID, used to satisfy "/state" requests
+    // without re-serializing objects that have not changed. Entries
+    // are erased on state transitions (via `invalidateStateCache`)
+    // and lazily re-populated by the next "/state" request.
+    //
+    // NOTE: The cache is only consulted when no authorizer is
+    // configured, since authorization filters the output of "/state"
+    // per principal.
+    mutable hashmap<SlaveID, std::string> cachedSlaveJson;
+    mutable hashmap<FrameworkID, std::string> cachedFrameworkJson;
+
+    // Generation of the master's externally visible state, bumped by
+    // `invalidateStateCache` on every transition. Used to tell whether
+    // a fully assembled response body is still current.
+    mutable uint64_t stateGeneration;
+
+    // Fully assembled response bodies for read-only endpoints, tagged
+    // with the generation at which they were serialized. As above,
+    // these are only used when no authorizer is configured.
+    struct CachedResponse
+    {
+      uint64_t generation;
+      std::string body;
+    };
+
+    mutable Option<CachedResponse> cachedStateSummaryResponse;
+    mutable Option<CachedResponse> cachedFrameworksResponse;
+
+    // Serialized v1 `GET_STATE` response bodies and encoded
+    // `SUBSCRIBED` events (which embed a full state snapshot), shared
+    // across concurrent requests at the same state generation so that
+    // a subscriber connect storm (e.g., after a failover) costs one
+    // snapshot instead of one full copy per subscriber. As above,
+    // these are only used when no authorizer is configured.
+    struct CachedV1State
+    {
+      uint64_t generation;
+      std::map<ContentType, std::string> bodies;
+    };
+
+    mutable Option<CachedV1State> cachedGetStateResponse;
+    mutable Option<CachedV1State> cachedSubscribedEvent;
+
+    // Number of operator read requests currently being served (see
+    // `admit`).
+    mutable size_t outstandingOperatorReads;
+
     // NOTE: The quota specific pieces of the Operator API are factored
     // out into this separate class.
     QuotaHandler quotaHandler;
@@ -1584,6 +1855,10 @@ private:
   Registrar* registrar;
   Files* files;
 
+  // Archive of completed framework history, backed by a local
+  // leveldb. Only set if `--archive_dir` is specified.
+  process::Owned<Archivist> archivist;
+
   mesos::master::contender::MasterContender* contender;
   mesos::master::detector::MasterDetector* detector;
 
@@ -1612,7 +1887,11 @@ private:
 
   struct Slaves
   {
-    Slaves() : removed(MAX_REMOVED_SLAVES) {}
+    Slaves() : observer(nullptr), removed(MAX_REMOVED_SLAVES) {}
+
+    // Observes the liveness of all registered slaves by pinging them
+    // periodically; created in `Master::initialize()`.
+    SlaveObserver* observer;
 
     // Imposes a time limit for slaves that we recover from the
     // registry to re-register with the master.
@@ -1736,6 +2015,14 @@ private:
     }
   } slaves;
 
+  // Status update acknowledgements that have been processed but not
+  // yet sent to their agent. Acknowledgements destined for the same
+  // agent are coalesced for a small window (see
+  // `STATUS_UPDATE_ACKNOWLEDGEMENT_BATCH_WINDOW`) and then flushed as
+  // a single batched message.
+  hashmap<SlaveID, std::vector<StatusUpdateAcknowledgementMessage>>
+    pendingAcknowledgements;
+
   struct Frameworks
   {
     Frameworks(const Flags& masterFlags)
@@ -1805,15 +2092,91 @@ private:
     hashmap<UUID, process::Owned<Subscriber>> subscribed;
   } subscribers;
 
+  // 'TaskState' summaries and the mapping between frameworks and
+  // agents, maintained incrementally as tasks are added, transition
+  // between states and are removed (only tasks of registered
+  // frameworks are accounted for, as in '/state-summary'). This
+  // allows the summary endpoints to answer without iterating the
+  // tasks.
+  struct TaskStateSummaries
+  {
+    // Account for a (pending, active or completed) task of the given
+    // framework on the given agent.
+    void add(
+        const FrameworkID& frameworkId,
+        const SlaveID& slaveId,
+        const TaskState& state);
+
+    // Stop accounting for a task, e.g., when it is removed or when
+    // its framework is removed.
+    void subtract(
+        const FrameworkID& frameworkId,
+        const SlaveID& slaveId,
+        const TaskState& state);
+
+    // Account for a task state transition.
+    void transition(
+        const FrameworkID& frameworkId,
+        const SlaveID& slaveId,
+        const TaskState& previous,
+        const TaskState& current);
+
+    const TaskStateSummary& framework(const FrameworkID& frameworkId) const;
+    const TaskStateSummary& slave(const SlaveID& slaveId) const;
+
+    // Returns the number of tasks of each framework on the given
+    // agent, and vice versa. This answers 'what frameworks have
+    // tasks on a given agent?' without iterating the tasks.
+    const hashmap<FrameworkID, size_t>& frameworks(
+        const SlaveID& slaveId) const;
+    const hashmap<SlaveID, size_t>& slaves(
+        const FrameworkID& frameworkId) const;
+
+    hashmap<FrameworkID, TaskStateSummary> frameworkSummaries;
+    hashmap<SlaveID, TaskStateSummary> slaveSummaries;
+
+    hashmap<SlaveID, hashmap<FrameworkID, size_t>> slaveFrameworks;
+    hashmap<FrameworkID, hashmap<SlaveID, size_t>> frameworkSlaves;
+  } taskStateSummaries;
+
+  // Secondary index of the live tasks known to the master, keyed by
+  // task state. Maintained on task addition, state transition and
+  // removal (see `Slave::addTask`, `Slave::removeTask` and
+  // `updateTask`); used to serve state-filtered task queries without
+  // walking every task in the cluster. Completed tasks are not
+  // indexed; their buffers are bounded and scanned directly.
+  hashmap<TaskState, hashset<Task*>> tasksByState;
+
+  // Serves task state reconciliation requests on a separate actor,
+  // from a snapshot mirrored incrementally as the master's task and
+  // agent state mutates (see `Reconciler` for the consistency
+  // argument). Must be kept in lockstep with `Framework::tasks`,
+  // `Framework::pendingTasks` and the `Slaves` sets.
+  process::Owned<Reconciler> reconciler;
+
   hashmap<OfferID, Offer*> offers;
   hashmap<OfferID, process::Timer> offerTimers;
 
+  // Offer objects kept for reuse after their offer was removed, so
+  // that the next offer cycle does not have to re-allocate their
+  // sub-messages. Bounded by `MAX_OFFER_POOL_SIZE`; see `offer()`
+  // and `removeOffer()`.
+  std::vector<Offer*> offerPool;
+
   hashmap<OfferID, InverseOffer*> inverseOffers;
   hashmap<OfferID, process::Timer> inverseOfferTimers;
 
   // Roles with > 0 frameworks currently registered.
   hashmap<std::string, Role*> activeRoles;
 
+  // Allocation total (used plus offered resources of the role's
+  // frameworks) per role, maintained incrementally as the
+  // frameworks' resource accounting changes (see
+  // `Framework::trackAllocated`). This lets the role endpoints
+  // answer without summing over every framework of each role.
+  // Entries are erased once they become empty.
+  hashmap<std::string, Resources> roleResources;
+
   // Configured role whitelist if using the (deprecated) "explicit
   // roles" feature. If this is `None`, any role is allowed.
   Option<hashset<std::string>> roleWhitelist;
@@ -1840,6 +2203,26 @@ private:
   // Principals of authenticated frameworks/slaves keyed by PID.
   hashmap<process::UPID, std::string> authenticated;
 
+  // Short-lived tokens handed out on successful authentication,
+  // bound to the pid they were issued to and the time at which they
+  // expire. A client presenting a valid token when re-authenticating
+  // skips the SASL exchange entirely. The tokens are bearer
+  // credentials, so they are only handed out (and honored) when all
+  // libprocess traffic is over TLS; see 'Master::authenticate'.
+  struct AuthenticationToken
+  {
+    std::string principal;
+    process::UPID pid;
+    process::Time expiration;
+  };
+
+  hashmap<std::string, AuthenticationToken> authenticationTokens;
+
+  // The next time at which expired entries are swept out of
+  // 'authenticationTokens'. Expired tokens are otherwise only
+  // removed when they are presented.
+  process::Time authenticationTokenSweep;
+
   int64_t nextFrameworkId; // Used to give each framework a unique ID.
   int64_t nextOfferId;     // Used to give each slot offer a unique ID.
   int64_t nextSlaveId;     // Used to give each slave a unique ID.
@@ -1904,6 +2287,28 @@ private:
   double _resources_revocable_used(const std::string& name);
   double _resources_revocable_percent(const std::string& name);
 
+  // Memoized scalar sums behind the per-resource metrics gauges
+  // above. A /metrics/snapshot scrape evaluates a dozen of these
+  // gauges and each evaluation scanned every registered agent; one
+  // pass now computes all the sums and the result is reused until it
+  // is older than `METRICS_RESOURCES_STALENESS_BOUND`, so a scrape
+  // burst costs a single scan.
+  struct ResourceMetrics
+  {
+    process::Time updated;
+
+    // Scalar sums keyed by resource name.
+    hashmap<std::string, double> totals;
+    hashmap<std::string, double> revocableTotals;
+    hashmap<std::string, double> nonRevocableUsed;
+    hashmap<std::string, double> revocableUsed;
+  };
+
+  Option<ResourceMetrics> resourceMetrics;
+
+  // Recomputes `resourceMetrics` if it is absent or stale.
+  void refreshResourceMetrics();
+
   process::Time startTime; // Start time used to calculate uptime.
 
   Option<process::Time> electedTime; // Time when this master is elected.
@@ -2190,6 +2595,7 @@ struct Framework
       pid(_pid),
       connected(true),
       active(true),
+      removing(false),
       registeredTime(time),
       reregisteredTime(time),
       completedTasks(masterFlags.max_completed_tasks_per_framework) {}
@@ -2204,6 +2610,7 @@ struct Framework
       http(_http),
       connected(true),
       active(true),
+      removing(false),
       registeredTime(time),
       reregisteredTime(time),
       completedTasks(masterFlags.max_completed_tasks_per_framework) {}
@@ -2232,9 +2639,30 @@ struct Framework
 
     tasks[task->task_id()] = task;
 
+    master->taskStateSummaries.add(id(), task->slave_id(), task->state());
+
+    master->reconciler->updateTask(
+        id(), task->task_id(), ReconcilerTask(*task));
+
     if (!protobuf::isTerminalState(task->state())) {
       totalUsedResources += task->resources();
       usedResources[task->slave_id()] += task->resources();
+      trackAllocated(task->resources());
+    }
+  }
+
+  // Mirrors a change of this framework's used or offered resources
+  // into the master's per-role allocation totals.
+  void trackAllocated(const Resources& resources)
+  {
+    master->roleResources[info.role()] += resources;
+  }
+
+  void untrackAllocated(const Resources& resources)
+  {
+    master->roleResources[info.role()] -= resources;
+    if (master->roleResources[info.role()].empty()) {
+      master->roleResources.erase(info.role());
     }
   }
 
@@ -2254,6 +2682,7 @@ struct Framework
     if (usedResources[task->slave_id()].empty()) {
       usedResources.erase(task->slave_id());
     }
+    untrackAllocated(task->resources());
   }
 
   // Sends a message to the connected framework.
@@ -2279,6 +2708,17 @@ struct Framework
   void addCompletedTask(const Task& task)
   {
     // TODO(adam-mesos): Check if completed task already exists.
+
+    // Stop accounting for the completed task that is about to be
+    // evicted from the circular buffer.
+    if (completedTasks.full()) {
+      const Task& evicted = *completedTasks.front();
+      master->taskStateSummaries.subtract(
+          evicted.framework_id(), evicted.slave_id(), evicted.state());
+    }
+
+    master->taskStateSummaries.add(id(), task.slave_id(), task.state());
+
     completedTasks.push_back(std::shared_ptr<Task>(new Task(task)));
   }
 
@@ -2288,12 +2728,17 @@ struct Framework
       << "Unknown task " << task->task_id()
       << " of framework " << task->framework_id();
 
+    master->taskStateSummaries.subtract(id(), task->slave_id(), task->state());
+
+    master->reconciler->removeTask(id(), task->task_id());
+
     if (!protobuf::isTerminalState(task->state())) {
       totalUsedResources -= task->resources();
       usedResources[task->slave_id()] -= task->resources();
       if (usedResources[task->slave_id()].empty()) {
         usedResources.erase(task->slave_id());
       }
+      untrackAllocated(task->resources());
     }
 
     addCompletedTask(*task);
@@ -2307,6 +2752,7 @@ struct Framework
     offers.insert(offer);
     totalOfferedResources += offer->resources();
     offeredResources[offer->slave_id()] += offer->resources();
+    trackAllocated(offer->resources());
   }
 
   void removeOffer(Offer* offer)
@@ -2319,6 +2765,7 @@ struct Framework
     if (offeredResources[offer->slave_id()].empty()) {
       offeredResources.erase(offer->slave_id());
     }
+    untrackAllocated(offer->resources());
 
     offers.erase(offer);
   }
@@ -2355,6 +2802,7 @@ struct Framework
     executors[slaveId][executorInfo.executor_id()] = executorInfo;
     totalUsedResources += executorInfo.resources();
     usedResources[slaveId] += executorInfo.resources();
+    trackAllocated(executorInfo.resources());
   }
 
   void removeExecutor(const SlaveID& slaveId,
@@ -2370,6 +2818,7 @@ struct Framework
     if (usedResources[slaveId].empty()) {
       usedResources.erase(slaveId);
     }
+    untrackAllocated(executors[slaveId][executorId].resources());
 
     executors[slaveId].erase(executorId);
     if (executors[slaveId].empty()) {
@@ -2531,6 +2980,12 @@ struct Framework
   // No offers will be made to a deactivated framework.
   bool active;
 
+  // True while the framework is being removed: it has been
+  // deactivated and its tasks are being removed in chunks (see
+  // `Master::removeFramework`). Re-subscription is refused until
+  // the removal completes.
+  bool removing;
+
   process::Time registeredTime;
   process::Time reregisteredTime;
   process::Time unregisteredTime;
@@ -2623,16 +3078,11 @@ struct Role
     frameworks.erase(framework->id());
   }
 
-  Resources resources() const
-  {
-    Resources resources;
-    foreachvalue (Framework* framework, frameworks) {
-      resources += framework->totalUsedResources;
-      resources += framework->totalOfferedResources;
-    }
-
-    return resources;
-  }
+  // NOTE: The allocation total of the role is not stored here but
+  // maintained incrementally in `Master::roleResources`, since the
+  // frameworks' resource accounting can change before the role
+  // becomes active (e.g., while tasks of a re-registering agent are
+  // recovered ahead of their framework).
 
   // NOTE: The dynamic role/quota relation is stored in and administrated
   // by the master. There is no direct representation of quota information
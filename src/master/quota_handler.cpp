@@ -252,14 +252,22 @@ Future<QuotaStatus> Master::QuotaHandler::_status(
     quotaInfos.push_back(quota.info);
   }
 
-  // Create a list of authorization actions for each role we may return.
+  // Authorize all roles we may return as one batch: at most a single
+  // round trip into the authorizer instead of one per role.
   //
   // TODO(alexr): Use an authorization filter here once they are available.
-  list<Future<bool>> authorizedRoles;
+  vector<string> roles;
+  roles.reserve(quotaInfos.size());
+
   foreach (const QuotaInfo& info, quotaInfos) {
-    authorizedRoles.push_back(authorizeGetQuota(principal, info.role()));
+    roles.push_back(info.role());
   }
 
+  vector<Future<bool>> authorizations = authorizeGetQuotas(principal, roles);
+
+  list<Future<bool>> authorizedRoles(
+      authorizations.begin(), authorizations.end());
+
   return process::collect(authorizedRoles)
     .then(defer(
         master->self(),
@@ -524,17 +532,17 @@ Future<http::Response> Master::QuotaHandler::__remove(const string& role) const
 }
 
 
-Future<bool> Master::QuotaHandler::authorizeGetQuota(
+vector<Future<bool>> Master::QuotaHandler::authorizeGetQuotas(
     const Option<string>& principal,
-    const string& role) const
+    const vector<string>& roles) const
 {
   if (master->authorizer.isNone()) {
-    return true;
+    return vector<Future<bool>>(roles.size(), true);
   }
 
   LOG(INFO) << "Authorizing principal '"
             << (principal.isSome() ? principal.get() : "ANY")
-            << "' to get quota for role '" << role << "'";
+            << "' to get quota for roles " << stringify(roles);
 
   authorization::Request request;
   request.set_action(authorization::GET_QUOTA_WITH_ROLE);
@@ -543,9 +551,14 @@ Future<bool> Master::QuotaHandler::authorizeGetQuota(
     request.mutable_subject()->set_value(principal.get());
   }
 
-  request.mutable_object()->set_value(role);
+  // Authorize all roles as one batch: at most a single round trip
+  // into the authorizer instead of one per role.
+  vector<authorization::Request> requests(roles.size(), request);
+  for (size_t i = 0; i < roles.size(); i++) {
+    requests[i].mutable_object()->set_value(roles[i]);
+  }
 
-  return master->authorizer.get()->authorized(request);
+  return master->authorizer.get()->authorized(requests);
 }
 
 
@@ -0,0 +1,547 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+#include <process/protobuf.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "master/reconciler.hpp"
+
+#include "messages/messages.hpp"
+
+using process::dispatch;
+using process::post;
+using process::spawn;
+using process::terminate;
+using process::wait; // Necessary on some OS's to disambiguate.
+
+using process::Process;
+using process::ProcessBase;
+using process::UPID;
+
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+ReconcilerTask::ReconcilerTask(const Task& task)
+  : slaveId(task.slave_id()),
+    state(task.has_status_update_state()
+        ? task.status_update_state()
+        : task.state()),
+    executorId(task.has_executor_id()
+        ? Option<ExecutorID>(task.executor_id())
+        : None()),
+    healthy(protobuf::getTaskHealth(task)),
+    containerStatus(protobuf::getTaskContainerStatus(task)) {}
+
+
+class ReconcilerProcess : public Process<ReconcilerProcess>
+{
+public:
+  explicit ReconcilerProcess(const UPID& _master)
+    : ProcessBase(process::ID::generate("master-reconciler")),
+      master(_master) {}
+
+  void updateFramework(
+      const FrameworkInfo& frameworkInfo,
+      const Option<UPID>& pid)
+  {
+    Framework& framework = frameworks[frameworkInfo.id()];
+
+    framework.partitionAware = protobuf::frameworkHasCapability(
+        frameworkInfo, FrameworkInfo::Capability::PARTITION_AWARE);
+
+    framework.pid = pid;
+  }
+
+  void removeFramework(const FrameworkID& frameworkId)
+  {
+    frameworks.erase(frameworkId);
+  }
+
+  void addPendingTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const SlaveID& slaveId)
+  {
+    frameworks[frameworkId].pendingTasks[taskId] = slaveId;
+  }
+
+  void removePendingTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId)
+  {
+    if (frameworks.contains(frameworkId)) {
+      frameworks[frameworkId].pendingTasks.erase(taskId);
+    }
+  }
+
+  void updateTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const ReconcilerTask& task)
+  {
+    // NOTE: `ReconcilerTask` has no default constructor, so we
+    // cannot use `operator[]` here.
+    Framework& framework = frameworks[frameworkId];
+    framework.tasks.erase(taskId);
+    framework.tasks.emplace(taskId, task);
+  }
+
+  void removeTask(const FrameworkID& frameworkId, const TaskID& taskId)
+  {
+    if (frameworks.contains(frameworkId)) {
+      frameworks[frameworkId].tasks.erase(taskId);
+    }
+  }
+
+  void addSlave(const SlaveID& slaveId)
+  {
+    registered.insert(slaveId);
+  }
+
+  void removeSlave(const SlaveID& slaveId)
+  {
+    registered.erase(slaveId);
+  }
+
+  void addRecoveredSlave(const SlaveID& slaveId)
+  {
+    recovered.insert(slaveId);
+  }
+
+  void removeRecoveredSlave(const SlaveID& slaveId)
+  {
+    recovered.erase(slaveId);
+  }
+
+  void addUnreachableSlave(const SlaveID& slaveId, const TimeInfo& time)
+  {
+    unreachable[slaveId] = time;
+  }
+
+  void removeUnreachableSlave(const SlaveID& slaveId)
+  {
+    unreachable.erase(slaveId);
+  }
+
+  void reconcile(
+      const FrameworkID& frameworkId,
+      const vector<TaskStatus>& statuses,
+      const lambda::function<void(const vector<StatusUpdate>&)>& forward)
+  {
+    if (!frameworks.contains(frameworkId)) {
+      // The framework was removed after the master forwarded the
+      // request; nothing is sent, as if the request had arrived at
+      // the master after the removal.
+      LOG(WARNING) << "Dropping reconciliation request for unknown"
+                   << " framework " << frameworkId;
+      return;
+    }
+
+    const Framework& framework = frameworks.at(frameworkId);
+
+    // Status updates for an HTTP framework, collected here and handed
+    // back to 'forward' since its connection lives on the master.
+    vector<StatusUpdate> updates;
+
+    if (statuses.empty()) {
+      // Implicit reconciliation: send the latest state of all tasks.
+      foreachpair (
+          const TaskID& taskId, const SlaveID& slaveId,
+          framework.pendingTasks) {
+        StatusUpdate update = protobuf::createStatusUpdate(
+            frameworkId,
+            slaveId,
+            taskId,
+            TASK_STAGING,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Latest task state",
+            TaskStatus::REASON_RECONCILIATION);
+
+        send(framework, &update, &updates);
+      }
+
+      foreachpair (
+          const TaskID& taskId, const ReconcilerTask& task,
+          framework.tasks) {
+        StatusUpdate update = protobuf::createStatusUpdate(
+            frameworkId,
+            task.slaveId,
+            taskId,
+            task.state,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Latest task state",
+            TaskStatus::REASON_RECONCILIATION,
+            task.executorId,
+            task.healthy,
+            None(),
+            task.containerStatus);
+
+        send(framework, &update, &updates);
+      }
+
+      if (framework.pid.isNone() && !updates.empty()) {
+        forward(updates);
+      }
+
+      return;
+    }
+
+    // Explicit reconciliation occurs for the following cases:
+    //   (1) Task is known, but pending: TASK_STAGING.
+    //   (2) Task is known: send the latest state.
+    //   (3) Task is unknown, slave is registered: TASK_UNKNOWN.
+    //   (4) Task is unknown, slave is transitioning: no-op.
+    //   (5) Task is unknown, slave is unreachable: TASK_UNREACHABLE.
+    //   (6) Task is unknown, slave is unknown: TASK_UNKNOWN.
+    //
+    // For cases (3), (5), and (6), TASK_LOST is sent instead if the
+    // framework has not opted-in to the PARTITION_AWARE capability.
+    foreach (const TaskStatus& status, statuses) {
+      Option<SlaveID> slaveId = None();
+      if (status.has_slave_id()) {
+        slaveId = status.slave_id();
+      }
+
+      Option<StatusUpdate> update = None();
+
+      if (framework.pendingTasks.contains(status.task_id())) {
+        // (1) Task is known, but pending: TASK_STAGING.
+        update = protobuf::createStatusUpdate(
+            frameworkId,
+            framework.pendingTasks.at(status.task_id()),
+            status.task_id(),
+            TASK_STAGING,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Latest task state",
+            TaskStatus::REASON_RECONCILIATION);
+      } else if (framework.tasks.contains(status.task_id())) {
+        // (2) Task is known: send the latest status update state.
+        const ReconcilerTask& task = framework.tasks.at(status.task_id());
+
+        update = protobuf::createStatusUpdate(
+            frameworkId,
+            task.slaveId,
+            status.task_id(),
+            task.state,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Latest task state",
+            TaskStatus::REASON_RECONCILIATION,
+            task.executorId,
+            task.healthy,
+            None(),
+            task.containerStatus);
+      } else if (slaveId.isSome() && registered.contains(slaveId.get())) {
+        // (3) Task is unknown, slave is registered: TASK_UNKNOWN. If
+        // the framework does not have the PARTITION_AWARE capability,
+        // send TASK_LOST for backward compatibility.
+        TaskState taskState = TASK_UNKNOWN;
+        if (!framework.partitionAware) {
+          taskState = TASK_LOST;
+        }
+
+        update = protobuf::createStatusUpdate(
+            frameworkId,
+            slaveId.get(),
+            status.task_id(),
+            taskState,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Task is unknown to the agent",
+            TaskStatus::REASON_RECONCILIATION);
+      } else if (transitioning(slaveId)) {
+        // (4) Task is unknown, slave is transitionary: no-op.
+        LOG(INFO) << "Dropping reconciliation of task " << status.task_id()
+                  << " for framework " << frameworkId
+                  << " because there are transitional agents";
+      } else if (slaveId.isSome() && unreachable.contains(slaveId.get())) {
+        // (5) Slave is unreachable: TASK_UNREACHABLE. If the framework
+        // does not have the PARTITION_AWARE capability, send TASK_LOST
+        // for backward compatibility. In either case, the status update
+        // also includes the time when the slave was marked unreachable.
+        const TimeInfo& unreachableTime = unreachable.at(slaveId.get());
+
+        TaskState taskState = TASK_UNREACHABLE;
+        if (!framework.partitionAware) {
+          taskState = TASK_LOST;
+        }
+
+        update = protobuf::createStatusUpdate(
+            frameworkId,
+            slaveId.get(),
+            status.task_id(),
+            taskState,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Task is unreachable",
+            TaskStatus::REASON_RECONCILIATION,
+            None(),
+            None(),
+            None(),
+            None(),
+            unreachableTime);
+      } else {
+        // (6) Task is unknown, slave is unknown: TASK_UNKNOWN. If the
+        // framework does not have the PARTITION_AWARE capability, send
+        // TASK_LOST for backward compatibility.
+        TaskState taskState = TASK_UNKNOWN;
+        if (!framework.partitionAware) {
+          taskState = TASK_LOST;
+        }
+
+        update = protobuf::createStatusUpdate(
+            frameworkId,
+            slaveId,
+            status.task_id(),
+            taskState,
+            TaskStatus::SOURCE_MASTER,
+            None(),
+            "Reconciliation: Task is unknown",
+            TaskStatus::REASON_RECONCILIATION);
+      }
+
+      if (update.isSome()) {
+        send(framework, &update.get(), &updates);
+      }
+    }
+
+    if (framework.pid.isNone() && !updates.empty()) {
+      forward(updates);
+    }
+  }
+
+private:
+  // Snapshot of the per-framework task state. Tasks of a framework
+  // that has not (re-)registered yet are mirrored here as soon as
+  // the master creates its `Framework` object; the connection and
+  // capability information follows with `updateFramework` when the
+  // registration completes.
+  struct Framework
+  {
+    Framework() : partitionAware(false) {}
+
+    bool partitionAware;
+    Option<UPID> pid;
+
+    // Pending tasks, keyed by task id, with the agent they were
+    // launched on.
+    hashmap<TaskID, SlaveID> pendingTasks;
+
+    hashmap<TaskID, ReconcilerTask> tasks;
+  };
+
+  // Mirrors `Master::Slaves::transitioning`.
+  bool transitioning(const Option<SlaveID>& slaveId)
+  {
+    if (slaveId.isSome()) {
+      return recovered.contains(slaveId.get());
+    } else {
+      return !recovered.empty();
+    }
+  }
+
+  // Sends the update to a PID-based framework directly, with the
+  // master as the sender so that the scheduler accepts it; updates
+  // for an HTTP framework are collected in 'updates'. Note that the
+  // update is consumed.
+  void send(
+      const Framework& framework,
+      StatusUpdate* update,
+      vector<StatusUpdate>* updates)
+  {
+    VLOG(1) << "Sending reconciliation state " << update->status().state()
+            << " for task " << update->status().task_id()
+            << " of framework " << update->framework_id();
+
+    if (framework.pid.isSome()) {
+      StatusUpdateMessage message;
+      message.mutable_update()->Swap(update);
+      post(master, framework.pid.get(), message);
+    } else {
+      updates->push_back(StatusUpdate());
+      updates->back().Swap(update);
+    }
+  }
+
+  const UPID master;
+
+  hashmap<FrameworkID, Framework> frameworks;
+
+  hashset<SlaveID> registered;
+  hashset<SlaveID> recovered;
+  hashmap<SlaveID, TimeInfo> unreachable;
+};
+
+
+Reconciler::Reconciler(const UPID& master)
+  : process(new ReconcilerProcess(master))
+{
+  spawn(process.get());
+}
+
+
+Reconciler::~Reconciler()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+void Reconciler::updateFramework(
+    const FrameworkInfo& frameworkInfo,
+    const Option<UPID>& pid)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::updateFramework,
+      frameworkInfo,
+      pid);
+}
+
+
+void Reconciler::removeFramework(const FrameworkID& frameworkId)
+{
+  dispatch(process.get(), &ReconcilerProcess::removeFramework, frameworkId);
+}
+
+
+void Reconciler::addPendingTask(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId,
+    const SlaveID& slaveId)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::addPendingTask,
+      frameworkId,
+      taskId,
+      slaveId);
+}
+
+
+void Reconciler::removePendingTask(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::removePendingTask,
+      frameworkId,
+      taskId);
+}
+
+
+void Reconciler::updateTask(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId,
+    const ReconcilerTask& task)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::updateTask,
+      frameworkId,
+      taskId,
+      task);
+}
+
+
+void Reconciler::removeTask(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId)
+{
+  dispatch(process.get(), &ReconcilerProcess::removeTask, frameworkId, taskId);
+}
+
+
+void Reconciler::addSlave(const SlaveID& slaveId)
+{
+  dispatch(process.get(), &ReconcilerProcess::addSlave, slaveId);
+}
+
+
+void Reconciler::removeSlave(const SlaveID& slaveId)
+{
+  dispatch(process.get(), &ReconcilerProcess::removeSlave, slaveId);
+}
+
+
+void Reconciler::addRecoveredSlave(const SlaveID& slaveId)
+{
+  dispatch(process.get(), &ReconcilerProcess::addRecoveredSlave, slaveId);
+}
+
+
+void Reconciler::removeRecoveredSlave(const SlaveID& slaveId)
+{
+  dispatch(process.get(), &ReconcilerProcess::removeRecoveredSlave, slaveId);
+}
+
+
+void Reconciler::addUnreachableSlave(
+    const SlaveID& slaveId,
+    const TimeInfo& time)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::addUnreachableSlave,
+      slaveId,
+      time);
+}
+
+
+void Reconciler::removeUnreachableSlave(const SlaveID& slaveId)
+{
+  dispatch(process.get(), &ReconcilerProcess::removeUnreachableSlave, slaveId);
+}
+
+
+void Reconciler::reconcile(
+    const FrameworkID& frameworkId,
+    const vector<TaskStatus>& statuses,
+    const lambda::function<void(const vector<StatusUpdate>&)>& forward)
+{
+  dispatch(
+      process.get(),
+      &ReconcilerProcess::reconcile,
+      frameworkId,
+      statuses,
+      forward);
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
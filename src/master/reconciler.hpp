@@ -0,0 +1,152 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_RECONCILER_HPP__
+#define __MASTER_RECONCILER_HPP__
+
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
+#include <process/owned.hpp>
+#include <process/pid.hpp>
+
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Forward declaration.
+class ReconcilerProcess;
+
+
+// Compact, self-contained copy of the fields of a task that are
+// needed to answer a reconciliation request. Constructed from the
+// master's `Task` at the point of mutation so that the (potentially
+// large) status history is not copied onto the reconciler.
+struct ReconcilerTask
+{
+  explicit ReconcilerTask(const Task& task);
+
+  SlaveID slaveId;
+
+  // The effective state, i.e., the acknowledged status update state
+  // if one is set and the latest state otherwise.
+  TaskState state;
+
+  Option<ExecutorID> executorId;
+  Option<bool> healthy;
+  Option<ContainerStatus> containerStatus;
+};
+
+
+// Answers task state reconciliation requests from a read-only
+// snapshot of the master's task and agent state, maintained on a
+// separate actor. A framework reconciling a large number of tasks
+// (e.g., after a failover) therefore does not occupy the master
+// actor beyond the cost of forwarding the request.
+//
+// The snapshot is refreshed incrementally: the master (and its
+// `Framework` helpers) mirror every mutation of the covered state
+// through the methods below, in the order the mutations are applied.
+// Because the mirrored updates and the reconciliation requests
+// travel through the same dispatch queue, a request observes exactly
+// the state the master had when it forwarded the request.
+class Reconciler
+{
+public:
+  // The 'master' pid is used as the sender of the resulting status
+  // update messages, since schedulers drop messages that do not
+  // originate from the leading master.
+  explicit Reconciler(const process::UPID& master);
+
+  // Note that the Reconciler process is terminated when the
+  // Reconciler is destructed.
+  ~Reconciler();
+
+  // Not copyable, not assignable.
+  Reconciler(const Reconciler&) = delete;
+  Reconciler& operator=(const Reconciler&) = delete;
+
+  // Adds the framework to the snapshot, or updates its connection
+  // and capability information. An HTTP framework has no pid; its
+  // status updates are handed back to the master for delivery (see
+  // `reconcile`).
+  void updateFramework(
+      const FrameworkInfo& frameworkInfo,
+      const Option<process::UPID>& pid);
+
+  void removeFramework(const FrameworkID& frameworkId);
+
+  // Tasks that are pending authorization, reported as TASK_STAGING.
+  void addPendingTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const SlaveID& slaveId);
+
+  void removePendingTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId);
+
+  // Adds the task to the snapshot, or updates it after a state
+  // transition or status update.
+  void updateTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const ReconcilerTask& task);
+
+  void removeTask(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId);
+
+  // Agent sets mirroring `Master::Slaves`: the registered agents,
+  // the agents recovered from the registry that have not yet
+  // re-registered after a master failover, and the agents that have
+  // been marked unreachable.
+  void addSlave(const SlaveID& slaveId);
+  void removeSlave(const SlaveID& slaveId);
+
+  void addRecoveredSlave(const SlaveID& slaveId);
+  void removeRecoveredSlave(const SlaveID& slaveId);
+
+  void addUnreachableSlave(const SlaveID& slaveId, const TimeInfo& time);
+  void removeUnreachableSlave(const SlaveID& slaveId);
+
+  // Serves explicit (non-empty 'statuses') or implicit (empty
+  // 'statuses') reconciliation for a framework that was registered
+  // when the master forwarded the request. Status updates for a
+  // PID-based framework are sent directly from the reconciler; for
+  // an HTTP framework, whose connection lives on the master, the
+  // updates are passed to 'forward' instead (typically a deferral
+  // onto the master).
+  void reconcile(
+      const FrameworkID& frameworkId,
+      const std::vector<TaskStatus>& statuses,
+      const lambda::function<void(const std::vector<StatusUpdate>&)>& forward);
+
+private:
+  process::Owned<ReconcilerProcess> process;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_RECONCILER_HPP__
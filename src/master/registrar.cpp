@@ -34,6 +34,8 @@
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/timer.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
@@ -78,6 +80,105 @@ namespace master {
 using process::http::Response;
 using process::http::Request;
 
+
+// Replaces each admitted slave's resource and attribute blocks with
+// an index into the registry's shape tables, so that identical
+// blocks (the common case in homogeneous fleets) are stored only
+// once. Performed right before the registry is stored; 'expandShapes'
+// below restores the blocks after a fetch.
+static void internShapes(Registry* registry)
+{
+  // Maps the serialized form of a shape to its index in the table.
+  // NOTE: Serializing the same contents is deterministic within a
+  // single protobuf version, which suffices here since the keys are
+  // never stored.
+  hashmap<string, uint32_t> resourceShapes;
+  hashmap<string, uint32_t> attributeShapes;
+
+  registry->clear_resource_shapes();
+  registry->clear_attribute_shapes();
+
+  for (int i = 0; i < registry->mutable_slaves()->slaves_size(); i++) {
+    Registry::Slave* slave = registry->mutable_slaves()->mutable_slaves(i);
+    SlaveInfo* info = slave->mutable_info();
+
+    {
+      Registry::ResourceShape shape;
+      shape.mutable_resources()->CopyFrom(info->resources());
+
+      const string key = shape.SerializeAsString();
+
+      Option<uint32_t> index = resourceShapes.get(key);
+
+      if (index.isNone()) {
+        index = static_cast<uint32_t>(registry->resource_shapes_size());
+        resourceShapes.put(key, index.get());
+        registry->add_resource_shapes()->Swap(&shape);
+      }
+
+      slave->set_resources_index(index.get());
+      info->clear_resources();
+    }
+
+    {
+      Registry::AttributeShape shape;
+      shape.mutable_attributes()->CopyFrom(info->attributes());
+
+      const string key = shape.SerializeAsString();
+
+      Option<uint32_t> index = attributeShapes.get(key);
+
+      if (index.isNone()) {
+        index = static_cast<uint32_t>(registry->attribute_shapes_size());
+        attributeShapes.put(key, index.get());
+        registry->add_attribute_shapes()->Swap(&shape);
+      }
+
+      slave->set_attributes_index(index.get());
+      info->clear_attributes();
+    }
+  }
+}
+
+
+// Restores the resource and attribute blocks of the admitted slaves
+// from the registry's shape tables (see 'internShapes' above). This
+// is a no-op for registries stored before the tables existed.
+static void expandShapes(Registry* registry)
+{
+  for (int i = 0; i < registry->mutable_slaves()->slaves_size(); i++) {
+    Registry::Slave* slave = registry->mutable_slaves()->mutable_slaves(i);
+
+    if (slave->has_resources_index()) {
+      CHECK_LT(
+          static_cast<int>(slave->resources_index()),
+          registry->resource_shapes_size())
+        << "Corrupt registry: resource shape index out of range";
+
+      slave->mutable_info()->mutable_resources()->CopyFrom(
+          registry->resource_shapes(slave->resources_index()).resources());
+
+      slave->clear_resources_index();
+    }
+
+    if (slave->has_attributes_index()) {
+      CHECK_LT(
+          static_cast<int>(slave->attributes_index()),
+          registry->attribute_shapes_size())
+        << "Corrupt registry: attribute shape index out of range";
+
+      slave->mutable_info()->mutable_attributes()->CopyFrom(
+          registry->attribute_shapes(slave->attributes_index()).attributes());
+
+      slave->clear_attributes_index();
+    }
+  }
+
+  registry->clear_resource_shapes();
+  registry->clear_attribute_shapes();
+}
+
+
 class RegistrarProcess : public Process<RegistrarProcess>
 {
 public:
@@ -261,7 +362,11 @@ Future<Response> RegistrarProcess::registry(
   JSON::Object result;
 
   if (variable.isSome()) {
-    result = JSON::protobuf(variable.get().get());
+    // Serve the expanded form: the interned shape tables are an
+    // artifact of the stored encoding, not part of the API.
+    Registry registry = variable.get().get();
+    expandShapes(&registry);
+    result = JSON::protobuf(registry);
   }
 
   return OK(result, request.url.query.get("jsonp"));
@@ -395,7 +500,13 @@ void RegistrarProcess::__recover(const Future<bool>& recover)
     // the Registry with the latest MasterInfo.
     // Set the promise and un-gate any pending operations.
     CHECK_SOME(variable);
-    recovered.get()->set(variable.get().get());
+
+    // The stored form has the slaves' resource/attribute blocks
+    // interned; recovering consumers expect fully populated
+    // SlaveInfos.
+    Registry registry = variable.get().get();
+    expandShapes(&registry);
+    recovered.get()->set(registry);
   }
 }
 
@@ -421,9 +532,17 @@ Future<bool> RegistrarProcess::_apply(Owned<Operation> operation)
 
   operations.push_back(operation);
   Future<bool> future = operation->future();
-  if (!updating) {
-    update();
+
+  // Rather than starting the storage write immediately, defer it to
+  // the end of the current event batch: operations that are already
+  // sitting in the mailbox (e.g., during an agent (re)registration
+  // storm after a failover) then coalesce into the same registry
+  // mutation and a single `Storage::set`, instead of the first
+  // operation going through the replicated log alone.
+  if (!updating && operations.size() == 1) {
+    dispatch(self(), &Self::update);
   }
+
   return future;
 }
 
@@ -444,8 +563,11 @@ void RegistrarProcess::update()
 
   updating = true;
 
-  // Create a snapshot of the current registry.
+  // Create a snapshot of the current registry. Note that the stored
+  // form has the slaves' resource/attribute blocks interned, so we
+  // expand them before applying any operations.
   Registry registry = variable.get().get();
+  expandShapes(&registry);
 
   // Create the 'slaveIDs' accumulator.
   hashset<SlaveID> slaveIDs;
@@ -461,6 +583,10 @@ void RegistrarProcess::update()
   LOG(INFO) << "Applied " << operations.size() << " operations in "
             << stopwatch.elapsed() << "; attempting to update the registry";
 
+  // Intern the slaves' resource/attribute blocks so that identical
+  // blocks are stored (and replicated) only once.
+  internShapes(&registry);
+
   // Perform the store, and time the operation.
   metrics.state_store.start();
   state->store(variable.get().mutate(registry))
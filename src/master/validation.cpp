@@ -22,6 +22,7 @@
 
 #include <mesos/type_utils.hpp>
 
+#include <stout/cache.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -662,6 +663,21 @@ Option<Error> validateResources(const ExecutorInfo& executor)
 }
 
 
+// Memoizes the outcome of the executor-only validation checks, keyed
+// by framework id and serialized `ExecutorInfo`. These checks depend
+// only on the executor info (and the framework id, which is part of
+// the key), so a framework repeatedly launching tasks with an
+// identical executor — the common case for long-running frameworks —
+// skips re-running them. `validateCompatibleExecutorInfo` depends on
+// the executors currently registered on the agent and is deliberately
+// not memoized.
+//
+// NOTE: The cache requires no synchronization since validation only
+// runs in the master actor.
+static Cache<string, Option<Error>> validationCache(
+    EXECUTOR_VALIDATION_CACHE_SIZE);
+
+
 Option<Error> validate(
     const ExecutorInfo& executor,
     Framework* framework,
@@ -670,23 +686,40 @@ Option<Error> validate(
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
 
-  vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(internal::validateType, executor),
-    lambda::bind(internal::validateFrameworkID, executor, framework),
-    lambda::bind(internal::validateShutdownGracePeriod, executor),
-    lambda::bind(internal::validateResources, executor),
-    lambda::bind(
-        internal::validateCompatibleExecutorInfo, executor, framework, slave)
-  };
+  const string key =
+    framework->id().value() + ":" + executor.SerializePartialAsString();
 
-  foreach (const lambda::function<Option<Error>()>& validator, validators) {
-    Option<Error> error = validator();
-    if (error.isSome()) {
-      return error;
+  Option<Error> error;
+
+  Option<Option<Error>> memoized = validationCache.get(key);
+  if (memoized.isSome()) {
+    error = memoized.get();
+  } else {
+    vector<lambda::function<Option<Error>()>> validators = {
+      lambda::bind(internal::validateType, executor),
+      lambda::bind(internal::validateFrameworkID, executor, framework),
+      lambda::bind(internal::validateShutdownGracePeriod, executor),
+      lambda::bind(internal::validateResources, executor)
+    };
+
+    foreach (const lambda::function<Option<Error>()>& validator, validators) {
+      error = validator();
+      if (error.isSome()) {
+        break;
+      }
     }
+
+    validationCache.put(key, error);
   }
 
-  return None();
+  if (error.isSome()) {
+    return error;
+  }
+
+  // NOTE: This check was the last entry of the validator chain above
+  // before memoization was introduced, so running it after the
+  // memoized checks preserves the original validation order.
+  return internal::validateCompatibleExecutorInfo(executor, framework, slave);
 }
 
 } // namespace internal {
@@ -114,13 +114,20 @@ Future<vector<WeightInfo>> Master::WeightsHandler::_getWeights(
     weightInfos.push_back(weightInfo);
   }
 
-  // Create a list of authorization actions for each role we may return.
-  // TODO(alexr): Batch these actions once we have BatchRequest in authorizer.
-  list<Future<bool>> roleAuthorizations;
+  // Authorize all roles we may return as one batch: at most a single
+  // round trip into the authorizer instead of one per role.
+  vector<string> roles;
+  roles.reserve(weightInfos.size());
+
   foreach (const WeightInfo& info, weightInfos) {
-    roleAuthorizations.push_back(authorizeGetWeight(principal, info.role()));
+    roles.push_back(info.role());
   }
 
+  vector<Future<bool>> authorizations = authorizeGetWeights(principal, roles);
+
+  list<Future<bool>> roleAuthorizations(
+      authorizations.begin(), authorizations.end());
+
   return process::collect(roleAuthorizations)
     .then(defer(
         master->self(),
@@ -331,16 +338,22 @@ Future<bool> Master::WeightsHandler::authorizeUpdateWeights(
     request.mutable_subject()->set_value(principal.get());
   }
 
-  list<Future<bool>> authorizations;
-  foreach (const string& role, roles) {
-    request.mutable_object()->set_value(role);
-    authorizations.push_back(master->authorizer.get()->authorized(request));
+  if (roles.empty()) {
+    return master->authorizer.get()->authorized(request);
   }
 
-  if (authorizations.empty()) {
-    return master->authorizer.get()->authorized(request);
+  // Authorize all roles as one batch: at most a single round trip
+  // into the authorizer instead of one per role.
+  vector<authorization::Request> requests(roles.size(), request);
+  for (size_t i = 0; i < roles.size(); i++) {
+    requests[i].mutable_object()->set_value(roles[i]);
   }
 
+  vector<Future<bool>> batched =
+    master->authorizer.get()->authorized(requests);
+
+  list<Future<bool>> authorizations(batched.begin(), batched.end());
+
   return await(authorizations)
       .then([](const std::list<Future<bool>>& authorizations)
             -> Future<bool> {
@@ -355,17 +368,17 @@ Future<bool> Master::WeightsHandler::authorizeUpdateWeights(
 }
 
 
-Future<bool> Master::WeightsHandler::authorizeGetWeight(
+vector<Future<bool>> Master::WeightsHandler::authorizeGetWeights(
     const Option<string>& principal,
-    const string& role) const
+    const vector<string>& roles) const
 {
   if (master->authorizer.isNone()) {
-    return true;
+    return vector<Future<bool>>(roles.size(), true);
   }
 
   LOG(INFO) << "Authorizing principal '"
             << (principal.isSome() ? principal.get() : "ANY")
-            << "' to get weight for role '" << role << "'";
+            << "' to get weights for roles " << stringify(roles);
 
   authorization::Request request;
   request.set_action(authorization::VIEW_ROLE);
@@ -374,9 +387,14 @@ Future<bool> Master::WeightsHandler::authorizeGetWeight(
     request.mutable_subject()->set_value(principal.get());
   }
 
-  request.mutable_object()->set_value(role);
+  // Authorize all roles as one batch: at most a single round trip
+  // into the authorizer instead of one per role.
+  vector<authorization::Request> requests(roles.size(), request);
+  for (size_t i = 0; i < roles.size(); i++) {
+    requests[i].mutable_object()->set_value(roles[i]);
+  }
 
-  return master->authorizer.get()->authorized(request);
+  return master->authorizer.get()->authorized(requests);
 }
 
 } // namespace master {
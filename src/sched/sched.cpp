@@ -1015,49 +1015,98 @@ protected:
       status.set_uuid(update.uuid());
     }
 
+    // Queue the update rather than invoking the scheduler callback
+    // directly. The drain dispatch below sits in the process's event
+    // queue behind any update messages that have already arrived, so
+    // updates accumulating while the scheduler is busy in a callback
+    // get delivered in a single 'Scheduler::statusUpdates' invocation
+    // rather than paying the callback dispatch cost per update.
+    pendingUpdates.push_back(status);
+
+    // See above for when we don't need to acknowledge.
+    if (implicitAcknowledgements &&
+        ((update.has_uuid() && update.uuid() != "") ||
+         (from != UPID() && pid != UPID()))) {
+      pendingAcknowledgements.push_back(update);
+    }
+
+    // There is a drain dispatch in flight iff 'pendingUpdates' is
+    // non-empty, so only schedule one for the first queued update.
+    if (pendingUpdates.size() == 1) {
+      dispatch(self(), &SchedulerProcess::deliverStatusUpdates);
+    }
+  }
+
+  void deliverStatusUpdates()
+  {
+    // Note that we need to look at the atomic 'running' here so that
+    // we don't deliver (or acknowledge) updates if the driver was
+    // aborted or stopped after the updates were queued.
+    if (!running.load()) {
+      VLOG(1) << "Ignoring queued status updates because "
+              << "the driver is not running!";
+      pendingUpdates.clear();
+      pendingAcknowledgements.clear();
+      return;
+    }
+
+    CHECK(!pendingUpdates.empty());
+
+    VLOG(2) << "Delivering " << pendingUpdates.size() << " status updates";
+
+    // Move the queues into locals so that any updates generated
+    // while the scheduler is in the callback start a new batch.
+    vector<TaskStatus> statuses;
+    statuses.swap(pendingUpdates);
+
+    vector<StatusUpdate> acknowledgements;
+    acknowledgements.swap(pendingAcknowledgements);
+
     Stopwatch stopwatch;
     if (FLAGS_v >= 1) {
       stopwatch.start();
     }
 
-    scheduler->statusUpdate(driver, status);
+    scheduler->statusUpdates(driver, statuses);
 
-    VLOG(1) << "Scheduler::statusUpdate took " << stopwatch.elapsed();
+    VLOG(1) << "Scheduler::statusUpdates of " << statuses.size()
+            << " updates took " << stopwatch.elapsed();
 
-    if (implicitAcknowledgements) {
-      // Note that we need to look at the atomic 'running' here
-      // so that we don't acknowledge the update if the driver was
-      // aborted during the processing of the update.
-      if (!running.load()) {
-        VLOG(1) << "Not sending status update acknowledgment message because "
-                << "the driver is not running!";
-        return;
-      }
+    // Note that we need to look at the atomic 'running' here
+    // so that we don't acknowledge the updates if the driver was
+    // aborted during the processing of the updates.
+    if (!running.load()) {
+      VLOG(1) << "Not sending status update acknowledgment messages because "
+              << "the driver is not running!";
+      return;
+    }
+
+    // We drop acknowledgements while we're disconnected; the master
+    // will resend the unacknowledged updates once we re-register.
+    if (!connected) {
+      VLOG(1) << "Not sending status update acknowledgment messages because "
+              << "the driver is disconnected!";
+      return;
+    }
 
-      // See above for when we don't need to acknowledge.
-      if ((update.has_uuid() && update.uuid() != "") ||
-          (from != UPID() && pid != UPID())) {
-        // We drop updates while we're disconnected.
-        CHECK(connected);
-        CHECK_SOME(master);
+    CHECK_SOME(master);
 
-        VLOG(2) << "Sending ACK for status update " << update
-                << " to " << master.get().pid();
+    foreach (const StatusUpdate& update, acknowledgements) {
+      VLOG(2) << "Sending ACK for status update " << update
+              << " to " << master.get().pid();
 
-        Call call;
+      Call call;
 
-        CHECK(framework.has_id());
-        call.mutable_framework_id()->CopyFrom(framework.id());
-        call.set_type(Call::ACKNOWLEDGE);
+      CHECK(framework.has_id());
+      call.mutable_framework_id()->CopyFrom(framework.id());
+      call.set_type(Call::ACKNOWLEDGE);
 
-        Call::Acknowledge* acknowledge = call.mutable_acknowledge();
-        acknowledge->mutable_slave_id()->CopyFrom(update.slave_id());
-        acknowledge->mutable_task_id()->CopyFrom(update.status().task_id());
-        acknowledge->set_uuid(update.uuid());
+      Call::Acknowledge* acknowledge = call.mutable_acknowledge();
+      acknowledge->mutable_slave_id()->CopyFrom(update.slave_id());
+      acknowledge->mutable_task_id()->CopyFrom(update.status().task_id());
+      acknowledge->set_uuid(update.uuid());
 
-        CHECK_SOME(master);
-        send(master.get().pid(), call);
-      }
+      send(master.get().pid(), call);
     }
   }
 
@@ -1659,6 +1708,13 @@ private:
   // is set).
   bool implicitAcknowledgements;
 
+  // Status updates received but not yet delivered to the scheduler,
+  // along with the subset requiring implicit acknowledgement once
+  // delivered. Updates are queued in 'statusUpdate' and delivered
+  // in batches by 'deliverStatusUpdates'.
+  std::vector<TaskStatus> pendingUpdates;
+  std::vector<StatusUpdate> pendingAcknowledgements;
+
   const Option<Credential> credential;
 
   Authenticatee* authenticatee;
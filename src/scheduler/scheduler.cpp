@@ -28,7 +28,6 @@
 #include <queue>
 #include <string>
 #include <sstream>
-#include <tuple>
 
 #include <mesos/v1/mesos.hpp>
 #include <mesos/v1/scheduler.hpp>
@@ -36,7 +35,6 @@
 #include <mesos/master/detector.hpp>
 
 #include <process/async.hpp>
-#include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
@@ -87,23 +85,21 @@ using namespace mesos::internal::master;
 
 using namespace process;
 
-using std::get;
 using std::ostream;
 using std::queue;
 using std::shared_ptr;
 using std::string;
-using std::tuple;
 using std::vector;
 
 using mesos::internal::recordio::Reader;
 
 using mesos::master::detector::MasterDetector;
 
-using process::collect;
 using process::Owned;
 using process::wait; // Necessary on some OS's to disambiguate.
 
 using process::http::Connection;
+using process::http::ConnectionPool;
 using process::http::Pipe;
 using process::http::post;
 using process::http::Request;
@@ -124,7 +120,7 @@ struct Connections
   }
 
   Connection subscribe; // Used for subscribe call/response.
-  Connection nonSubscribe; // Used for all other calls/responses.
+  ConnectionPool nonSubscribe; // Pool used for all other calls/responses.
 };
 
 
@@ -318,19 +314,16 @@ protected:
 
     state = CONNECTING;
 
-    auto connector = [this]() -> Future<Connection> {
-      return process::http::connect(master.get());
-    };
-
-    // We create two persistent connections here, one for subscribe
-    // call/streaming response and another for non-subscribe calls/responses.
-    collect(connector(), connector())
+    // We create a persistent connection for the subscribe
+    // call/streaming response here; non-subscribe calls/responses go
+    // through a pool of keep-alive connections established on demand.
+    process::http::connect(master.get())
       .onAny(defer(self(), &Self::connected, connectionId.get(), lambda::_1));
   }
 
   void connected(
       const UUID& _connectionId,
-      const Future<tuple<Connection, Connection>>& _connections)
+      const Future<Connection>& _connection)
   {
     // It is possible that a new master was detected while we had an ongoing
     // (re-)connection attempt with the old master.
@@ -342,10 +335,10 @@ protected:
     CHECK_EQ(CONNECTING, state);
     CHECK_SOME(connectionId);
 
-    if (!_connections.isReady()) {
+    if (!_connection.isReady()) {
       disconnected(connectionId.get(),
-                   _connections.isFailed()
-                     ? _connections.failure()
+                   _connection.isFailed()
+                     ? _connection.failure()
                      : "Connection future discarded");
       return;
     }
@@ -354,21 +347,20 @@ protected:
 
     state = CONNECTED;
 
-    connections =
-      Connections {get<0>(_connections.get()), get<1>(_connections.get())};
+    connections = Connections {_connection.get(), ConnectionPool()};
 
+    // NOTE: we only monitor the subscribe connection for
+    // disconnection; pooled non-subscribe connections come and go
+    // (e.g., when the master closes an idle one) and a failed
+    // non-subscribe call already surfaces through `_send`. A master
+    // failover closes the subscribe connection as well, so
+    // re-detection is still triggered.
     connections->subscribe.disconnected()
       .onAny(defer(self(),
                    &Self::disconnected,
                    connectionId.get(),
                    "Subscribe connection interrupted"));
 
-    connections->nonSubscribe.disconnected()
-      .onAny(defer(self(),
-                   &Self::disconnected,
-                   connectionId.get(),
-                   "Non-subscribe connection interrupted"));
-
     // Invoke the connected callback once we have established both subscribe
     // and non-subscribe connections with the master.
     mutex.lock()
@@ -41,6 +41,11 @@ constexpr Duration RECOVERY_TIMEOUT = Minutes(15);
 constexpr Duration STATUS_UPDATE_RETRY_INTERVAL_MIN = Seconds(10);
 constexpr Duration STATUS_UPDATE_RETRY_INTERVAL_MAX = Minutes(10);
 
+// Size that a task's status update stream file may grow to before it
+// is compacted, provided every received update has been acknowledged.
+// See `StatusUpdateStream::compact()`.
+constexpr Bytes STATUS_UPDATE_STREAM_COMPACTION_THRESHOLD = Megabytes(1);
+
 // Default backoff interval used by the slave to wait before registration.
 constexpr Duration DEFAULT_REGISTRATION_BACKOFF_FACTOR = Seconds(1);
 
@@ -61,6 +66,10 @@ constexpr Duration DEFAULT_AUTHENTICATION_BACKOFF_FACTOR = Seconds(1);
 constexpr Duration GC_DELAY = Weeks(1);
 constexpr Duration DISK_WATCH_INTERVAL = Minutes(1);
 
+// Maximum age of the resource usage sample served from the
+// monitoring endpoints. See `--resource_monitoring_interval`.
+constexpr Duration RESOURCE_MONITORING_INTERVAL = Seconds(1);
+
 // Minimum free disk capacity enforced by the garbage collector.
 constexpr double GC_DISK_HEADROOM = 0.1;
 
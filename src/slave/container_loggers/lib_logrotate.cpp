@@ -40,7 +40,6 @@
 
 #include <stout/os/environment.hpp>
 #include <stout/os/fcntl.hpp>
-#include <stout/os/killtree.hpp>
 
 #ifdef __linux__
 #include "linux/systemd.hpp"
@@ -68,9 +67,10 @@ class LogrotateContainerLoggerProcess :
 public:
   LogrotateContainerLoggerProcess(const Flags& _flags) : flags(_flags) {}
 
-  // Spawns two subprocesses that read from their stdin and write to
-  // "stdout" and "stderr" files in the sandbox.  The subprocesses will rotate
-  // the files according to the configured maximum size and number of files.
+  // Spawns a subprocess that reads the container's stdout and stderr
+  // streams and writes them to the "stdout" and "stderr" files in the
+  // sandbox.  The subprocess will rotate the files according to the
+  // configured maximum size and number of files.
   Future<SubprocessInfo> prepare(
       const ExecutorInfo& executorInfo,
       const std::string& sandboxDirectory)
@@ -148,8 +148,7 @@ public:
     outfds.write = pipefd[1];
 
     // NOTE: We need to `cloexec` this FD so that it will be closed when
-    // the child subprocess is spawned and so that the FD will not be
-    // inherited by the second child for stderr.
+    // the child subprocess is spawned.
     Try<Nothing> cloexec = os::cloexec(outfds.write.get());
     if (cloexec.isError()) {
       os::close(outfds.read);
@@ -157,45 +156,11 @@ public:
       return Failure("Failed to cloexec: " + cloexec.error());
     }
 
-    // Spawn a process to handle stdout.
-    mesos::internal::logger::rotate::Flags outFlags;
-    outFlags.max_size = overridenFlags.max_stdout_size;
-    outFlags.logrotate_options = overridenFlags.logrotate_stdout_options;
-    outFlags.log_filename = path::join(sandboxDirectory, "stdout");
-    outFlags.logrotate_path = flags.logrotate_path;
-
-    // If we are on systemd, then extend the life of the process as we
-    // do with the executor. Any grandchildren's lives will also be
-    // extended.
-    std::vector<Subprocess::ParentHook> parentHooks;
-#ifdef __linux__
-    if (systemd::enabled()) {
-      parentHooks.emplace_back(Subprocess::ParentHook(
-          &systemd::mesos::extendLifetime));
-    }
-#endif // __linux__
-
-    Try<Subprocess> outProcess = subprocess(
-        path::join(flags.launcher_dir, mesos::internal::logger::rotate::NAME),
-        {mesos::internal::logger::rotate::NAME},
-        Subprocess::FD(outfds.read, Subprocess::IO::OWNED),
-        Subprocess::PATH("/dev/null"),
-        Subprocess::FD(STDERR_FILENO),
-        &outFlags,
-        environment,
-        None(),
-        parentHooks);
-
-    if (outProcess.isError()) {
-      os::close(outfds.write.get());
-      return Failure("Failed to create logger process: " + outProcess.error());
-    }
-
     // NOTE: We manually construct a pipe here to properly express
     // ownership of the FDs.  See the NOTE above.
     if (::pipe(pipefd) == -1) {
+      os::close(outfds.read);
       os::close(outfds.write.get());
-      os::killtree(outProcess.get().pid(), SIGKILL);
       return Failure(ErrnoError("Failed to create pipe").message);
     }
 
@@ -207,36 +172,53 @@ public:
     // the child subprocess is spawned.
     cloexec = os::cloexec(errfds.write.get());
     if (cloexec.isError()) {
+      os::close(outfds.read);
       os::close(outfds.write.get());
       os::close(errfds.read);
       os::close(errfds.write.get());
-      os::killtree(outProcess.get().pid(), SIGKILL);
       return Failure("Failed to cloexec: " + cloexec.error());
     }
 
-    // Spawn a process to handle stderr.
-    mesos::internal::logger::rotate::Flags errFlags;
-    errFlags.max_size = overridenFlags.max_stderr_size;
-    errFlags.logrotate_options = overridenFlags.logrotate_stderr_options;
-    errFlags.log_filename = path::join(sandboxDirectory, "stderr");
-    errFlags.logrotate_path = flags.logrotate_path;
+    // Spawn a single process to handle both streams: the stdout
+    // stream is read from the subprocess's STDIN and the stderr
+    // stream from its STDOUT file descriptor (see `rotate::Flags`).
+    mesos::internal::logger::rotate::Flags rotateFlags;
+    rotateFlags.max_size = overridenFlags.max_stdout_size;
+    rotateFlags.logrotate_options = overridenFlags.logrotate_stdout_options;
+    rotateFlags.log_filename = path::join(sandboxDirectory, "stdout");
+    rotateFlags.logrotate_path = flags.logrotate_path;
+    rotateFlags.stderr_log_filename = path::join(sandboxDirectory, "stderr");
+    rotateFlags.stderr_max_size = overridenFlags.max_stderr_size;
+    rotateFlags.stderr_logrotate_options =
+      overridenFlags.logrotate_stderr_options;
 
-    Try<Subprocess> errProcess = subprocess(
+    // If we are on systemd, then extend the life of the process as we
+    // do with the executor. Any grandchildren's lives will also be
+    // extended.
+    std::vector<Subprocess::ParentHook> parentHooks;
+#ifdef __linux__
+    if (systemd::enabled()) {
+      parentHooks.emplace_back(Subprocess::ParentHook(
+          &systemd::mesos::extendLifetime));
+    }
+#endif // __linux__
+
+    Try<Subprocess> loggerProcess = subprocess(
         path::join(flags.launcher_dir, mesos::internal::logger::rotate::NAME),
         {mesos::internal::logger::rotate::NAME},
+        Subprocess::FD(outfds.read, Subprocess::IO::OWNED),
         Subprocess::FD(errfds.read, Subprocess::IO::OWNED),
-        Subprocess::PATH("/dev/null"),
         Subprocess::FD(STDERR_FILENO),
-        &errFlags,
+        &rotateFlags,
         environment,
         None(),
         parentHooks);
 
-    if (errProcess.isError()) {
+    if (loggerProcess.isError()) {
       os::close(outfds.write.get());
       os::close(errfds.write.get());
-      os::killtree(outProcess.get().pid(), SIGKILL);
-      return Failure("Failed to create logger process: " + errProcess.error());
+      return Failure(
+          "Failed to create logger process: " + loggerProcess.error());
     }
 
     // NOTE: The ownership of these FDs is given to the caller of this function.
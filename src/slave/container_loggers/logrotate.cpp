@@ -14,6 +14,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifdef __linux__
+// Needed for the declaration of `splice`.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <fcntl.h>
+#endif // __linux__
+
 #include <unistd.h>
 
 #include <new>
@@ -46,18 +54,35 @@ using namespace process;
 using namespace mesos::internal::logger::rotate;
 
 
+// Handles a single stream: reads from the given incoming pipe and
+// writes to (and rotates) the given leading log file. One process is
+// instantiated per stream so that a single OS process can handle both
+// the stdout and stderr streams of a container.
 class LogrotateLoggerProcess : public Process<LogrotateLoggerProcess>
 {
 public:
-  LogrotateLoggerProcess(const Flags& _flags)
+  LogrotateLoggerProcess(
+      int _fd,
+      const std::string& _filename,
+      const Bytes& _maxSize,
+      const Option<std::string>& _rotateOptions,
+      const std::string& _logrotatePath)
     : ProcessBase(process::ID::generate("logrotate-logger")),
-      flags(_flags),
+      fd(_fd),
+      filename(_filename),
+      maxSize(_maxSize),
+      rotateOptions(_rotateOptions),
+      logrotatePath(_logrotatePath),
       leading(None()),
       bytesWritten(0)
   {
     // Prepare a buffer for reading from the `incoming` pipe.
     length = os::pagesize();
     buffer = new char[length];
+
+#ifdef __linux__
+    splicing = true;
+#endif
   }
 
   virtual ~LogrotateLoggerProcess()
@@ -72,8 +97,8 @@ public:
     }
   }
 
-  // Prepares and starts the loop which reads from stdin, writes to the
-  // leading log file, and manages total log size.
+  // Prepares and starts the loop which reads from the incoming pipe,
+  // writes to the leading log file, and manages total log size.
   Future<Nothing> run()
   {
     // Populate the `logrotate` configuration file.
@@ -83,20 +108,20 @@ public:
     // has slightly different size semantics.  `logrotate` will rotate when the
     // max size is *exceeded*.  We rotate to keep files *under* the max size.
     const std::string config =
-      "\"" + flags.log_filename.get() + "\" {\n" +
-      flags.logrotate_options.getOrElse("") + "\n" +
-      "size " + stringify(flags.max_size.bytes() - length) + "\n" +
+      "\"" + filename + "\" {\n" +
+      rotateOptions.getOrElse("") + "\n" +
+      "size " + stringify(maxSize.bytes() - length) + "\n" +
       "}";
 
-    Try<Nothing> result = os::write(
-        flags.log_filename.get() + CONF_SUFFIX, config);
+    Try<Nothing> result = os::write(filename + CONF_SUFFIX, config);
 
     if (result.isError()) {
       return Failure("Failed to write configuration file: " + result.error());
     }
 
-    // NOTE: This is a prerequisuite for `io::read`.
-    Try<Nothing> nonblock = os::nonblock(STDIN_FILENO);
+    // NOTE: This is a prerequisuite for `io::read` and for splicing
+    // with `SPLICE_F_NONBLOCK`.
+    Try<Nothing> nonblock = os::nonblock(fd);
     if (nonblock.isError()) {
       return Failure("Failed to set nonblocking pipe: " + nonblock.error());
     }
@@ -107,10 +132,30 @@ public:
     return promise.future();
   }
 
-  // Reads from stdin and writes to the leading log file.
+  // Reads from the incoming pipe and writes to the leading log file.
   void loop()
   {
-    io::read(STDIN_FILENO, buffer, length)
+#ifdef __linux__
+    // Move the data with `splice` where possible, which avoids
+    // copying each chunk through a user-space buffer.
+    if (splicing) {
+      io::poll(fd, io::READ)
+        .onAny(defer(self(), [this](const Future<short>& future) {
+          if (!future.isReady()) {
+            promise.fail(
+                "Failed to poll the incoming pipe: " +
+                (future.isFailed() ? future.failure() : "discarded"));
+            return;
+          }
+
+          splice();
+        }));
+
+      return;
+    }
+#endif
+
+    io::read(fd, buffer, length)
       .then(defer(self(), [&](size_t readSize) -> Future<Nothing> {
         // Check if EOF has been reached on the input stream.
         // This indicates that the container (whose logs are being
@@ -135,14 +180,78 @@ public:
       }));
   }
 
-  // Writes the buffer from stdin to the leading log file.
+#ifdef __linux__
+  // Splices a chunk from the incoming pipe directly into the leading
+  // log file, rotating the file beforehand if it is full.
+  void splice()
+  {
+    // Rotate the log file if it has reached the `--max_size`.
+    if (bytesWritten >= maxSize.bytes()) {
+      rotate();
+    }
+
+    // If the leading log file is not open, open it.
+    // NOTE: We open the file in append-mode as `logrotate` may sometimes fail.
+    if (leading.isNone()) {
+      Try<int> open = os::open(
+          filename,
+          O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+      if (open.isError()) {
+        promise.fail(
+            "Failed to open '" + filename + "': " + open.error());
+        return;
+      }
+
+      leading = open.get();
+    }
+
+    // Cap the chunk so that the leading log file stays under the
+    // `--max_size`. `splice` only moves the bytes currently sitting
+    // in the pipe, so asking for the full remainder does not block.
+    ssize_t size = ::splice(
+        fd,
+        nullptr,
+        leading.get(),
+        nullptr,
+        maxSize.bytes() - bytesWritten,
+        SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+    if (size == 0) {
+      // EOF has been reached on the input stream. This indicates
+      // that the container (whose logs are being piped to this
+      // process) has exited.
+      promise.set(Nothing());
+      return;
+    }
+
+    if (size == -1) {
+      if (errno != EAGAIN) {
+        // EINVAL means the descriptors do not support splicing, e.g.,
+        // the input is not a pipe. Fall back to the read/write loop
+        // for this and any other error: that loop keeps draining the
+        // incoming pipe (which would otherwise potentially block the
+        // container on write) even if writing to the log file fails.
+        splicing = false;
+      }
+    } else {
+      bytesWritten += size;
+    }
+
+    // Use `dispatch` to limit the size of the call stack.
+    dispatch(self(), &LogrotateLoggerProcess::loop);
+  }
+#endif
+
+  // Writes the buffer from the incoming pipe to the leading log file.
   // When the number of written bytes exceeds `--max_size`, the leading
   // log file is rotated.  When the number of log files exceed `--max_files`,
   // the oldest log file is deleted.
   Try<Nothing> write(size_t readSize)
   {
     // Rotate the log file if it will grow beyond the `--max_size`.
-    if (bytesWritten + readSize > flags.max_size.bytes()) {
+    if (bytesWritten + readSize > maxSize.bytes()) {
       rotate();
     }
 
@@ -150,14 +259,13 @@ public:
     // NOTE: We open the file in append-mode as `logrotate` may sometimes fail.
     if (leading.isNone()) {
       Try<int> open = os::open(
-          flags.log_filename.get(),
+          filename,
           O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
           S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
       if (open.isError()) {
         return Error(
-            "Failed to open '" + flags.log_filename.get() +
-            "': " + open.error());
+            "Failed to open '" + filename + "': " + open.error());
       }
 
       leading = open.get();
@@ -193,21 +301,33 @@ public:
     // is not renamed, we will continue appending to the existing
     // leading log file.
     os::shell(
-        flags.logrotate_path +
-        " --state \"" + flags.log_filename.get() + STATE_SUFFIX + "\" \"" +
-        flags.log_filename.get() + CONF_SUFFIX + "\"");
+        logrotatePath +
+        " --state \"" + filename + STATE_SUFFIX + "\" \"" +
+        filename + CONF_SUFFIX + "\"");
 
     // Reset the number of bytes written.
     bytesWritten = 0;
   }
 
 private:
-  Flags flags;
-
-  // For reading from stdin.
+  // The incoming pipe and the stream's rotation settings.
+  const int fd;
+  const std::string filename;
+  const Bytes maxSize;
+  const Option<std::string> rotateOptions;
+  const std::string logrotatePath;
+
+  // For reading from the incoming pipe.
   char* buffer;
   size_t length;
 
+#ifdef __linux__
+  // Whether data is moved with `splice`. Cleared if the file
+  // descriptors turn out not to support splicing, in which case we
+  // fall back to reading and writing through `buffer`.
+  bool splicing;
+#endif
+
   // For writing and rotating the leading log file.
   Option<int> leading;
   size_t bytesWritten;
@@ -243,15 +363,50 @@ int main(int argc, char** argv)
   }
 
   // Asynchronously control the flow and size of logs.
-  LogrotateLoggerProcess process(flags);
+  LogrotateLoggerProcess process(
+      STDIN_FILENO,
+      flags.log_filename.get(),
+      flags.max_size,
+      flags.logrotate_options,
+      flags.logrotate_path);
+
   spawn(&process);
 
-  // Wait for the logging process to finish.
   Future<Nothing> status = dispatch(process, &LogrotateLoggerProcess::run);
+
+  // If requested, also handle a second stream (the container's
+  // stderr), which the parent wires up to this command's STDOUT file
+  // descriptor. This way a single logger process handles both
+  // streams of a container.
+  LogrotateLoggerProcess* stderrProcess = nullptr;
+  Future<Nothing> stderrStatus = Nothing();
+
+  if (flags.stderr_log_filename.isSome()) {
+    stderrProcess = new LogrotateLoggerProcess(
+        STDOUT_FILENO,
+        flags.stderr_log_filename.get(),
+        flags.stderr_max_size.getOrElse(flags.max_size),
+        flags.stderr_logrotate_options,
+        flags.logrotate_path);
+
+    spawn(stderrProcess);
+
+    stderrStatus = dispatch(stderrProcess, &LogrotateLoggerProcess::run);
+  }
+
+  // Wait for the logging process(es) to finish.
   status.await();
+  stderrStatus.await();
 
   terminate(process);
   wait(process);
 
-  return status.isReady() ? EXIT_SUCCESS : EXIT_FAILURE;
+  if (stderrProcess != nullptr) {
+    terminate(stderrProcess);
+    wait(stderrProcess);
+    delete stderrProcess;
+  }
+
+  return status.isReady() && stderrStatus.isReady()
+    ? EXIT_SUCCESS : EXIT_FAILURE;
 }
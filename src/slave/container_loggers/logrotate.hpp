@@ -112,12 +112,49 @@ struct Flags : public virtual flags::FlagsBase
 
           return None();
         });
+
+    add(&Flags::stderr_log_filename,
+        "stderr_log_filename",
+        "Absolute path to the leading log file of a second stream,\n"
+        "which is read from this command's STDOUT file descriptor.\n"
+        "This lets a single logger process handle both the stdout\n"
+        "and stderr streams of a container.",
+        [](const Option<std::string>& value) -> Option<Error> {
+          if (value.isSome() && !path::absolute(value.get())) {
+            return Error(
+                "Expected --stderr_log_filename to be an absolute path");
+          }
+
+          return None();
+        });
+
+    add(&Flags::stderr_max_size,
+        "stderr_max_size",
+        "Maximum size, in bytes, of a single log file of the second\n"
+        "stream.  Defaults to '--max_size'.",
+        [](const Option<Bytes>& value) -> Option<Error> {
+          if (value.isSome() && value->bytes() < os::pagesize()) {
+            return Error(
+                "Expected --stderr_max_size of at least " +
+                stringify(os::pagesize()) + " bytes");
+          }
+
+          return None();
+        });
+
+    add(&Flags::stderr_logrotate_options,
+        "stderr_logrotate_options",
+        "Additional config options to pass into 'logrotate' for the\n"
+        "second stream.  See '--logrotate_options'.");
   }
 
   Bytes max_size;
   Option<std::string> logrotate_options;
   Option<std::string> log_filename;
   std::string logrotate_path;
+  Option<std::string> stderr_log_filename;
+  Option<Bytes> stderr_max_size;
+  Option<std::string> stderr_logrotate_options;
 };
 
 } // namespace rotate {
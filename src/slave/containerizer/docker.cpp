@@ -610,7 +610,7 @@ Try<Nothing> DockerContainerizerProcess::unmountPersistentVolumes(
   // We assume volumes are only supported on Linux, and also
   // the target path contains the containerId.
 #ifdef __linux__
-  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::cachedRead();
   if (table.isError()) {
     return Error("Failed to get mount table: " + table.error());
   }
@@ -669,7 +669,15 @@ Try<Nothing> DockerContainerizerProcess::checkpoint(
 
     LOG(INFO) << "Checkpointing pid " << pid << " to '" << path <<  "'";
 
-    return slave::state::checkpoint(path, stringify(pid));
+    return slave::state::checkpoint(
+        path,
+        stringify(pid),
+        slave::paths::getExecutorRunPath(
+            slave::paths::getMetaRootDir(flags.work_dir),
+            container->slaveId,
+            container->executor.framework_id(),
+            container->executor.executor_id(),
+            containerId));
   }
 
   return Nothing();
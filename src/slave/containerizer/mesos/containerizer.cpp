@@ -248,9 +248,12 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   //
   // Currently, the order of the entries in the --isolation flag
   // specifies the ordering of the isolators. Specifically, the
-  // `create` and `prepare` calls for each isolator are run serially
-  // in the order in which they appear in the --isolation flag, while
-  // the `cleanup` call is serialized in reverse order.
+  // `create` calls for each isolator are run serially in the order
+  // in which they appear in the --isolation flag, while the
+  // `cleanup` call is serialized in reverse order. The `prepare`
+  // calls of the filesystem isolators are run serially ahead of all
+  // others; the remaining isolators are prepared concurrently (see
+  // `MesosContainerizerProcess::prepare`).
   //
   // It is the responsibility of each isolator to check its
   // dependency requirements (if any) during its `create`
@@ -344,6 +347,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
 
   vector<Owned<Isolator>> isolators;
 
+  size_t numFilesystemIsolators = 0;
+
   // Note: For cgroups, we only create `CgroupsIsolatorProcess` once.
   // We use this flag to identify whether `CgroupsIsolatorProcess` has
   // been created or not.
@@ -378,6 +383,7 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     // prepared filesystem (e.g., any volume mounts are performed).
     if (strings::contains(isolation, "filesystem/")) {
       isolators.insert(isolators.begin(), Owned<Isolator>(isolator.get()));
+      numFilesystemIsolators++;
     } else {
       isolators.push_back(Owned<Isolator>(isolator.get()));
     }
@@ -390,7 +396,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
       Owned<ContainerLogger>(logger.get()),
       Owned<Launcher>(launcher.get()),
       provisioner,
-      isolators);
+      isolators,
+      numFilesystemIsolators);
 }
 
 
@@ -401,7 +408,8 @@ MesosContainerizer::MesosContainerizer(
     const Owned<ContainerLogger>& logger,
     const Owned<Launcher>& launcher,
     const Shared<Provisioner>& provisioner,
-    const vector<Owned<Isolator>>& isolators)
+    const vector<Owned<Isolator>>& isolators,
+    const Option<size_t>& numFilesystemIsolators)
   : process(new MesosContainerizerProcess(
       flags,
       local,
@@ -409,7 +417,8 @@ MesosContainerizer::MesosContainerizer(
       logger,
       launcher,
       provisioner,
-      isolators))
+      isolators,
+      numFilesystemIsolators))
 {
   spawn(process.get());
 }
@@ -1103,19 +1112,36 @@ Future<Nothing> MesosContainerizerProcess::prepare(
   // Captured for lambdas below.
   ContainerConfig containerConfig = container->config;
 
-  // We prepare the isolators sequentially according to their ordering
-  // to permit basic dependency specification, e.g., preparing a
-  // filesystem isolator before other isolators.
+  // We prepare the filesystem isolators (which `create` places at
+  // the front of `isolators`) sequentially and before all others so
+  // that the remaining isolators see a consistent view of the
+  // prepared filesystem (e.g., any volume mounts are performed). The
+  // remaining isolators have no ordering requirements between each
+  // other and are prepared concurrently. If the number of filesystem
+  // isolators is unknown (the containerizer was constructed directly,
+  // e.g., in tests) we fall back to preparing all of them
+  // sequentially in order.
+  size_t numSerialized = numFilesystemIsolators.getOrElse(isolators.size());
+
   Future<list<Option<ContainerLaunchInfo>>> f =
     list<Option<ContainerLaunchInfo>>();
 
-  foreach (const Owned<Isolator>& isolator, isolators) {
+  vector<Owned<Isolator>> remaining;
+
+  for (size_t i = 0; i < isolators.size(); i++) {
+    const Owned<Isolator>& isolator = isolators[i];
+
     // If this is a nested container, we need to skip isolators that
     // do not support nesting.
     if (containerId.has_parent() && !isolator->supportsNesting()) {
       continue;
     }
 
+    if (i >= numSerialized) {
+      remaining.push_back(isolator);
+      continue;
+    }
+
     // Chain together preparing each isolator.
     f = f.then([=](list<Option<ContainerLaunchInfo>> launchInfos) {
       return isolator->prepare(containerId, containerConfig)
@@ -1126,6 +1152,29 @@ Future<Nothing> MesosContainerizerProcess::prepare(
       });
   }
 
+  if (!remaining.empty()) {
+    f = f.then([=](list<Option<ContainerLaunchInfo>> launchInfos) {
+      vector<Future<Option<ContainerLaunchInfo>>> futures;
+      futures.reserve(remaining.size());
+
+      foreach (const Owned<Isolator>& isolator, remaining) {
+        futures.push_back(isolator->prepare(containerId, containerConfig));
+      }
+
+      // NOTE: `collect` preserves the ordering of its results, so
+      // the launch infos (and hence, e.g., the pre-exec commands)
+      // are still accumulated in isolator order.
+      return collect(futures)
+        .then([=](const vector<Option<ContainerLaunchInfo>>& infos) mutable {
+          foreach (const Option<ContainerLaunchInfo>& launchInfo, infos) {
+            launchInfos.push_back(launchInfo);
+          }
+
+          return launchInfos;
+        });
+    });
+  }
+
   container->launchInfos = f;
 
   return f.then([]() { return Nothing(); });
@@ -1474,7 +1523,10 @@ Future<bool> MesosContainerizerProcess::_launch(
     argv[0] = MESOS_CONTAINERIZER;
     argv[1] = MesosContainerizerLaunch::NAME;
 
-    Try<pid_t> forked = launcher->fork(
+    // NOTE: The launcher may fork asynchronously (and concurrently
+    // with the forks of other launches), so everything that depends
+    // on the child's pid happens in the continuation below.
+    return launcher->fork(
         containerId,
         path::join(flags.launcher_dir, MESOS_CONTAINERIZER),
         argv,
@@ -1485,13 +1537,17 @@ Future<bool> MesosContainerizerProcess::_launch(
                : Subprocess::IO(subprocessInfo.err)),
         &launchFlags,
         None(),
-        namespaces); // 'namespaces' will be ignored by PosixLauncher.
-
-    if (forked.isError()) {
-      return Failure("Failed to fork: " + forked.error());
+        namespaces) // 'namespaces' will be ignored by PosixLauncher.
+      .repair([](const Future<pid_t>& forked) -> Future<pid_t> {
+        return Failure("Failed to fork: " + forked.failure());
+      })
+      .then(defer(self(), [=](pid_t pid) -> Future<bool> {
+    if (!containers_.contains(containerId)) {
+      return Failure("Container destroyed during forking");
     }
 
-    pid_t pid = forked.get();
+    const Owned<Container>& container = containers_.at(containerId);
+
     container->pid = pid;
 
     // Checkpoint the forked pid if requested by the agent.
@@ -1507,7 +1563,15 @@ Future<bool> MesosContainerizerProcess::_launch(
                 << " to '" << path <<  "'";
 
       Try<Nothing> checkpointed =
-        slave::state::checkpoint(path, stringify(pid));
+        slave::state::checkpoint(
+            path,
+            stringify(pid),
+            slave::paths::getExecutorRunPath(
+                slave::paths::getMetaRootDir(flags.work_dir),
+                slaveId,
+                container->config.executor_info().framework_id(),
+                container->config.executor_info().executor_id(),
+                containerId));
 
       if (checkpointed.isError()) {
         LOG(ERROR) << "Failed to checkpoint container's forked pid to '"
@@ -1555,6 +1619,7 @@ Future<bool> MesosContainerizerProcess::_launch(
       .onAny([pipes]() { os::close(pipes[0]); })
       .onAny([pipes]() { os::close(pipes[1]); });
   }));
+  }));
 }
 
 
@@ -28,6 +28,8 @@
 
 #include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
 
 #include <mesos/slave/container_logger.hpp>
 #include <mesos/slave/isolator.hpp>
@@ -66,7 +68,8 @@ public:
       const process::Owned<mesos::slave::ContainerLogger>& logger,
       const process::Owned<Launcher>& launcher,
       const process::Shared<Provisioner>& provisioner,
-      const std::vector<process::Owned<mesos::slave::Isolator>>& isolators);
+      const std::vector<process::Owned<mesos::slave::Isolator>>& isolators,
+      const Option<size_t>& numFilesystemIsolators = None());
 
   // Used for testing.
   MesosContainerizer(const process::Owned<MesosContainerizerProcess>& _process);
@@ -127,7 +130,8 @@ public:
       const process::Owned<mesos::slave::ContainerLogger>& _logger,
       const process::Owned<Launcher>& _launcher,
       const process::Shared<Provisioner>& _provisioner,
-      const std::vector<process::Owned<mesos::slave::Isolator>>& _isolators)
+      const std::vector<process::Owned<mesos::slave::Isolator>>& _isolators,
+      const Option<size_t>& _numFilesystemIsolators = None())
     : ProcessBase(process::ID::generate("mesos-containerizer")),
       flags(_flags),
       local(_local),
@@ -135,7 +139,8 @@ public:
       logger(_logger),
       launcher(_launcher),
       provisioner(_provisioner),
-      isolators(_isolators) {}
+      isolators(_isolators),
+      numFilesystemIsolators(_numFilesystemIsolators) {}
 
   virtual ~MesosContainerizerProcess() {}
 
@@ -292,6 +297,13 @@ private:
   const process::Shared<Provisioner> provisioner;
   const std::vector<process::Owned<mesos::slave::Isolator>> isolators;
 
+  // The number of filesystem isolators at the front of `isolators`.
+  // These are prepared serially and ahead of the other isolators;
+  // the rest are prepared concurrently (see `prepare`). When this is
+  // none (e.g., the containerizer was constructed directly rather
+  // than through `create`) all isolators are prepared serially.
+  const Option<size_t> numFilesystemIsolators;
+
   struct Container
   {
     Container() : sequence("mesos-container-status-updates") {}
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <process/async.hpp>
 #include <process/id.hpp>
 
 #include <stout/error.hpp>
@@ -23,6 +24,7 @@
 
 #include "slave/containerizer/mesos/isolators/cgroups/subsystems/cpu.hpp"
 
+using process::async;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -128,43 +130,66 @@ Future<Nothing> CpuSubsystem::update(
 }
 
 
-Future<ResourceStatistics> CpuSubsystem::usage(
-    const ContainerID& containerId,
-    const std::string& cgroup)
+// Reads 'cpu.stat'. Runs on a worker thread (see
+// `CpuSubsystem::usage`), so it is a function of the paths alone.
+static Try<ResourceStatistics> collect(
+    const string& hierarchy,
+    const string& cgroup)
 {
   ResourceStatistics result;
 
-  // Add the cpu.stat information only if CFS is enabled.
-  if (flags.cgroups_enable_cfs) {
-    Try<hashmap<string, uint64_t>> stat = cgroups::stat(
-        hierarchy,
-        cgroup,
-        "cpu.stat");
+  Try<hashmap<string, uint64_t>> stat = cgroups::stat(
+      hierarchy,
+      cgroup,
+      "cpu.stat");
 
-    if (stat.isError()) {
-      return Failure("Failed to read 'cpu.stat': " + stat.error());
-    }
+  if (stat.isError()) {
+    return Error("Failed to read 'cpu.stat': " + stat.error());
+  }
 
-    Option<uint64_t> nr_periods = stat.get().get("nr_periods");
-    if (nr_periods.isSome()) {
-      result.set_cpus_nr_periods(nr_periods.get());
-    }
+  Option<uint64_t> nr_periods = stat.get().get("nr_periods");
+  if (nr_periods.isSome()) {
+    result.set_cpus_nr_periods(nr_periods.get());
+  }
 
-    Option<uint64_t> nr_throttled = stat.get().get("nr_throttled");
-    if (nr_throttled.isSome()) {
-      result.set_cpus_nr_throttled(nr_throttled.get());
-    }
+  Option<uint64_t> nr_throttled = stat.get().get("nr_throttled");
+  if (nr_throttled.isSome()) {
+    result.set_cpus_nr_throttled(nr_throttled.get());
+  }
 
-    Option<uint64_t> throttled_time = stat.get().get("throttled_time");
-    if (throttled_time.isSome()) {
-      result.set_cpus_throttled_time_secs(
-          Nanoseconds(throttled_time.get()).secs());
-    }
+  Option<uint64_t> throttled_time = stat.get().get("throttled_time");
+  if (throttled_time.isSome()) {
+    result.set_cpus_throttled_time_secs(
+        Nanoseconds(throttled_time.get()).secs());
   }
 
   return result;
 }
 
+
+Future<ResourceStatistics> CpuSubsystem::usage(
+    const ContainerID& containerId,
+    const std::string& cgroup)
+{
+  // There is only cpu.stat information to add, and only if CFS is
+  // enabled.
+  if (!flags.cgroups_enable_cfs) {
+    return ResourceStatistics();
+  }
+
+  // Read the statistics on a worker thread, so that the samples for
+  // all containers can be taken concurrently.
+  return async(&collect, hierarchy, cgroup)
+    .then([](const Try<ResourceStatistics>& statistics)
+        -> Future<ResourceStatistics> {
+      if (statistics.isError()) {
+        return Failure(statistics.error());
+      }
+
+      return statistics.get();
+    });
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
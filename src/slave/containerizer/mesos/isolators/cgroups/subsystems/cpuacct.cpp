@@ -14,12 +14,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <process/async.hpp>
 #include <process/id.hpp>
 
 #include "linux/cgroups.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/subsystems/cpuacct.hpp"
 
+using process::async;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -46,8 +48,12 @@ CpuacctSubsystem::CpuacctSubsystem(
     Subsystem(_flags, _hierarchy) {}
 
 
-Future<ResourceStatistics> CpuacctSubsystem::usage(
-    const ContainerID& containerId,
+// Reads the cpuacct statistics. This runs on a worker thread (see
+// `CpuacctSubsystem::usage`) so it must not touch any subsystem
+// state.
+static Try<ResourceStatistics> collect(
+    bool pidsAndTidsCount,
+    const string& hierarchy,
     const string& cgroup)
 {
   ResourceStatistics result;
@@ -64,11 +70,11 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
   // parse the cgroup files to get the size. If this proves to be a
   // performance bottleneck, some kind of rate limiting mechanism
   // needs to be employed.
-  if (flags.cgroups_cpu_enable_pids_and_tids_count) {
+  if (pidsAndTidsCount) {
     Try<set<pid_t>> pids = cgroups::processes(hierarchy, cgroup);
 
     if (pids.isError()) {
-      return Failure("Failed to get number of processes: " + pids.error());
+      return Error("Failed to get number of processes: " + pids.error());
     }
 
     result.set_processes(pids.get().size());
@@ -76,7 +82,7 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
     Try<set<pid_t>> tids = cgroups::threads(hierarchy, cgroup);
 
     if (tids.isError()) {
-      return Failure("Failed to get number of threads: " + tids.error());
+      return Error("Failed to get number of threads: " + tids.error());
     }
 
     result.set_threads(tids.get().size());
@@ -94,7 +100,7 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
       "cpuacct.stat");
 
   if (stat.isError()) {
-    return Failure("Failed to read 'cpuacct.stat': " + stat.error());
+    return Error("Failed to read 'cpuacct.stat': " + stat.error());
   }
 
   // TODO(bmahler): Add namespacing to cgroups to enforce the expected
@@ -110,6 +116,30 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
   return result;
 }
 
+
+Future<ResourceStatistics> CpuacctSubsystem::usage(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  // Collect the statistics on a worker thread: the control files of
+  // different containers are independent, so this lets the samples
+  // for all containers be taken concurrently rather than one after
+  // another on this process.
+  return async(
+      &collect,
+      flags.cgroups_cpu_enable_pids_and_tids_count,
+      hierarchy,
+      cgroup)
+    .then([](const Try<ResourceStatistics>& statistics)
+        -> Future<ResourceStatistics> {
+      if (statistics.isError()) {
+        return Failure(statistics.error());
+      }
+
+      return statistics.get();
+    });
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
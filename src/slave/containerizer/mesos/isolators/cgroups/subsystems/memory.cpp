@@ -19,15 +19,18 @@
 #include <climits>
 #include <sstream>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/id.hpp>
 
 #include <stout/bytes.hpp>
 #include <stout/error.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/result.hpp>
+#include <stout/strings.hpp>
 
 #include "common/protobuf_utils.hpp"
 
@@ -38,6 +41,7 @@ using cgroups::memory::pressure::Level;
 
 using mesos::slave::ContainerLimitation;
 
+using process::async;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -272,36 +276,49 @@ Future<Nothing> MemorySubsystem::update(
 }
 
 
-Future<ResourceStatistics> MemorySubsystem::usage(
-    const ContainerID& containerId,
+// Reads the memory control files of the cgroup. Runs on a worker
+// thread (see `MemorySubsystem::usage`), so it is a function of the
+// paths alone and must not touch any subsystem state.
+static Try<ResourceStatistics> collect(
+    bool limitSwap,
+    const string& hierarchy,
     const string& cgroup)
 {
-  if (!infos.contains(containerId)) {
-    return Failure(
-        "Failed to get usage for subsystem '" + name() + "'"
-        ": Unknown container");
+  ResourceStatistics result;
+
+  // Read the byte counters as a single batch so the cgroup is only
+  // verified once for all of them.
+  vector<string> controls = {"memory.usage_in_bytes"};
+
+  if (limitSwap) {
+    controls.push_back("memory.memsw.usage_in_bytes");
   }
 
-  const Owned<Info>& info = infos[containerId];
+  Try<hashmap<string, string>> values =
+    cgroups::read(hierarchy, cgroup, controls);
 
-  ResourceStatistics result;
+  if (values.isError()) {
+    return Error("Failed to read memory controls: " + values.error());
+  }
 
   // The rss from memory.stat is wrong in two dimensions:
   //   1. It does not include child cgroups.
   //   2. It does not include any file backed pages.
-  Try<Bytes> usage = cgroups::memory::usage_in_bytes(hierarchy, cgroup);
+  Try<Bytes> usage = Bytes::parse(
+      strings::trim(values->at("memory.usage_in_bytes")) + "B");
 
   if (usage.isError()) {
-    return Failure("Failed to parse 'memory.usage_in_bytes': " + usage.error());
+    return Error("Failed to parse 'memory.usage_in_bytes': " + usage.error());
   }
 
   result.set_mem_total_bytes(usage.get().bytes());
 
-  if (flags.cgroups_limit_swap) {
-    Try<Bytes> usage = cgroups::memory::memsw_usage_in_bytes(hierarchy, cgroup);
+  if (limitSwap) {
+    Try<Bytes> usage = Bytes::parse(
+        strings::trim(values->at("memory.memsw.usage_in_bytes")) + "B");
 
     if (usage.isError()) {
-      return Failure(
+      return Error(
         "Failed to parse 'memory.memsw.usage_in_bytes': " + usage.error());
     }
 
@@ -316,7 +333,7 @@ Future<ResourceStatistics> MemorySubsystem::usage(
       "memory.stat");
 
   if (stat.isError()) {
-    return Failure("Failed to read 'memory.stat': " + stat.error());
+    return Error("Failed to read 'memory.stat': " + stat.error());
   }
 
   Option<uint64_t> total_cache = stat.get().get("total_cache");
@@ -350,6 +367,47 @@ Future<ResourceStatistics> MemorySubsystem::usage(
     result.set_mem_unevictable_bytes(total_unevictable.get());
   }
 
+  return result;
+}
+
+
+Future<ResourceStatistics> MemorySubsystem::usage(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  if (!infos.contains(containerId)) {
+    return Failure(
+        "Failed to get usage for subsystem '" + name() + "'"
+        ": Unknown container");
+  }
+
+  // Read the control files on a worker thread, so that the samples
+  // for all containers can be taken concurrently. The pressure
+  // counters are picked up afterwards, back on this process.
+  return async(&collect, flags.cgroups_limit_swap, hierarchy, cgroup)
+    .then(defer(PID<MemorySubsystem>(this),
+                &MemorySubsystem::_usage,
+                containerId,
+                lambda::_1));
+}
+
+
+Future<ResourceStatistics> MemorySubsystem::_usage(
+    const ContainerID& containerId,
+    const Try<ResourceStatistics>& statistics)
+{
+  if (statistics.isError()) {
+    return Failure(statistics.error());
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure(
+        "Failed to get usage for subsystem '" + name() + "'"
+        ": Unknown container");
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
   // Get pressure counter readings.
   list<Level> levels;
   list<Future<uint64_t>> values;
@@ -362,15 +420,15 @@ Future<ResourceStatistics> MemorySubsystem::usage(
 
   return await(values)
     .then(defer(PID<MemorySubsystem>(this),
-                &MemorySubsystem::_usage,
+                &MemorySubsystem::__usage,
                 containerId,
-                result,
+                statistics.get(),
                 levels,
                 lambda::_1));
 }
 
 
-Future<ResourceStatistics> MemorySubsystem::_usage(
+Future<ResourceStatistics> MemorySubsystem::__usage(
     const ContainerID& containerId,
     ResourceStatistics result,
     const list<Level>& levels,
@@ -96,6 +96,10 @@ private:
   MemorySubsystem(const Flags& flags, const std::string& hierarchy);
 
   process::Future<ResourceStatistics> _usage(
+      const ContainerID& containerId,
+      const Try<ResourceStatistics>& statistics);
+
+  process::Future<ResourceStatistics> __usage(
       const ContainerID& containerId,
       ResourceStatistics result,
       const std::list<cgroups::memory::pressure::Level>& levels,
@@ -795,7 +795,11 @@ Future<Nothing> LinuxFilesystemIsolatorProcess::cleanup(
   // Cleanup the mounts for this container in the host mount
   // namespace, including container's work directory and all the
   // persistent volume mounts.
-  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  //
+  // NOTE: We use the cached table here because this runs on every
+  // container destroy and parsing the table is expensive on hosts
+  // with many mounts.
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::cachedRead();
   if (table.isError()) {
     return Failure("Failed to get mount table: " + table.error());
   }
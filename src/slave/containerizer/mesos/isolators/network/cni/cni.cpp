@@ -1064,24 +1064,15 @@ Future<Nothing> NetworkCniIsolatorProcess::attach(
   // Inject Mesos metadata to the network configuration JSON that will
   // be passed to the plugin. Currently, we only pass in NetworkInfo
   // for the given network.
-  const NetworkConfigInfo& networkConfig =
+  NetworkConfigInfo& networkConfig =
     networkConfigs[containerNetwork.networkName];
 
-  Try<string> read = os::read(networkConfig.path);
-  if (read.isError()) {
-    return Failure(
-        "Failed to read CNI network configuration file: '" +
-        networkConfig.path + "': " + read.error());
+  Try<JSON::Object> json = getNetworkConfigJSON(networkConfig);
+  if (json.isError()) {
+    return Failure(json.error());
   }
 
-  Try<JSON::Object> parse = JSON::parse<JSON::Object>(read.get());
-  if (parse.isError()) {
-    return Failure(
-        "Failed to parse CNI network configuration file: '" +
-        networkConfig.path + "': " + parse.error());
-  }
-
-  JSON::Object networkConfigJson = parse.get();
+  JSON::Object networkConfigJson = json.get();
 
   // Note that 'args' might or might not be specified in the network
   // configuration file. We need to deal with both cases.
@@ -1571,6 +1562,51 @@ Future<Nothing> NetworkCniIsolatorProcess::_detach(
 }
 
 
+Try<JSON::Object> NetworkCniIsolatorProcess::getNetworkConfigJSON(
+    NetworkConfigInfo& networkConfig)
+{
+  // A container typically attaches to several networks back to back,
+  // so we cache the parsed configuration JSON and only re-read the
+  // file when its modification time changes.
+  //
+  // NOTE: 'mtime' has second granularity, so an edit made within the
+  // same second as the previous read might not be picked up until the
+  // file is touched again. Since the configuration of a network
+  // rarely changes after agent startup, we don't bother with anything
+  // more precise (e.g., inotify).
+  Try<long> mtime = os::stat::mtime(networkConfig.path);
+  if (mtime.isError()) {
+    return Error(
+        "Failed to stat CNI network configuration file: '" +
+        networkConfig.path + "': " + mtime.error());
+  }
+
+  if (networkConfig.json.isSome() &&
+      networkConfig.mtime == Option<long>(mtime.get())) {
+    return networkConfig.json.get();
+  }
+
+  Try<string> read = os::read(networkConfig.path);
+  if (read.isError()) {
+    return Error(
+        "Failed to read CNI network configuration file: '" +
+        networkConfig.path + "': " + read.error());
+  }
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(read.get());
+  if (parse.isError()) {
+    return Error(
+        "Failed to parse CNI network configuration file: '" +
+        networkConfig.path + "': " + parse.error());
+  }
+
+  networkConfig.json = parse.get();
+  networkConfig.mtime = mtime.get();
+
+  return parse.get();
+}
+
+
 // Implementation of subcommand to setup relevant network files and
 // hostname in the container UTS and mount namespace.
 const char* NetworkCniIsolatorSetup::NAME = "network-cni-setup";
@@ -20,6 +20,7 @@
 #include <process/id.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/json.hpp>
 #include <stout/subcommand.hpp>
 
 #include "slave/flags.hpp"
@@ -79,6 +80,14 @@ private:
 
     // Protobuf of CNI network configuration.
     cni::spec::NetworkConfig config;
+
+    // Cached JSON of the network configuration file, along with the
+    // file's modification time when it was last read. Invalidated
+    // when the modification time changes so that operators can still
+    // edit the configuration of a known network without restarting
+    // the agent (see `getNetworkConfigJSON`).
+    Option<JSON::Object> json;
+    Option<long> mtime;
   };
 
   struct ContainerNetwork
@@ -171,6 +180,8 @@ private:
       const ContainerID& containerId,
       const std::list<process::Future<Nothing>>& detaches);
 
+  Try<JSON::Object> getNetworkConfigJSON(NetworkConfigInfo& networkConfig);
+
   const Flags flags;
 
   // CNI network configurations keyed by network name.
@@ -25,6 +25,7 @@
 
 #include <mesos/mesos.hpp>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/io.hpp>
@@ -662,9 +663,10 @@ PortMappingStatistics::Flags::Flags()
       "eth0_name",
       "The name of the public network interface (e.g., eth0)");
 
-  add(&Flags::pid,
-      "pid",
-      "The pid of the process whose namespaces we will enter");
+  add(&Flags::pids,
+      "pids",
+      "A comma separated list of the pids of the processes whose network\n"
+      "namespaces we will enter, one per container");
 
   add(&Flags::enable_socket_statistics_summary,
       "enable_socket_statistics_summary",
@@ -978,33 +980,14 @@ static void addUDPStatistics(
 }
 
 
-int PortMappingStatistics::execute()
+// Collects the statistics for the container whose network namespace
+// we have already entered. Failures are returned as errors so that
+// one container failing collection does not discard the statistics
+// of the other containers in the batch.
+static Try<ResourceStatistics> collect(
+    const PortMappingStatistics::Flags& flags,
+    pid_t pid)
 {
-  if (flags.help) {
-    cerr << "Usage: " << name() << " [OPTIONS]" << endl << endl
-         << "Supported options:" << endl
-         << flags.usage();
-    return 0;
-  }
-
-  if (flags.pid.isNone()) {
-    cerr << "The pid is not specified" << endl;
-    return 1;
-  }
-
-  if (flags.eth0_name.isNone()) {
-    cerr << "The public interface name (e.g., eth0) is not specified" << endl;
-    return 1;
-  }
-
-  // Enter the network namespace.
-  Try<Nothing> setns = ns::setns(flags.pid.get(), "net");
-  if (setns.isError()) {
-    // This could happen if the executor exits before this function is
-    // invoked. We do not log here to avoid spurious logging.
-    return 1;
-  }
-
   ResourceStatistics result;
 
   // NOTE: We use a dummy value here since this field will be cleared
@@ -1030,8 +1013,7 @@ int PortMappingStatistics::execute()
 
     Try<string> value = os::read("/proc/net/sockstat");
     if (value.isError()) {
-      cerr << "Failed to read /proc/net/sockstat: " << value.error() << endl;
-      return 1;
+      return Error("Failed to read /proc/net/sockstat: " + value.error());
     }
 
     foreach (const string& line, strings::tokenize(value.get(), "\n")) {
@@ -1089,8 +1071,7 @@ int PortMappingStatistics::execute()
       diagnosis::socket::infos(AF_INET, diagnosis::socket::state::ALL);
 
     if (infos.isError()) {
-      cerr << "Failed to retrieve the socket information" << endl;
-      return 1;
+      return Error("Failed to retrieve the socket information");
     }
 
     vector<uint32_t> RTTs;
@@ -1131,8 +1112,7 @@ int PortMappingStatistics::execute()
   if (flags.enable_snmp_statistics) {
     Try<string> value = os::read("/proc/net/snmp");
     if (value.isError()) {
-      cerr << "Failed to read /proc/net/snmp: " << value.error() << endl;
-      return 1;
+      return Error("Failed to read /proc/net/snmp: " + value.error());
     }
 
     hashmap<string, hashmap<string, int64_t>> SNMPStats;
@@ -1141,9 +1121,8 @@ int PortMappingStatistics::execute()
     foreach (const string& line, strings::tokenize(value.get(), "\n")) {
       vector<string> fields = strings::tokenize(line, ":");
       if (fields.size() != 2) {
-        cerr << "Failed to tokenize line '" << line << "' "
-             << " in /proc/net/snmp" << endl;
-        return 1;
+        return Error(
+            "Failed to tokenize line '" + line + "' in /proc/net/snmp");
       }
       vector<string> tokens = strings::tokenize(fields[1], " ");
       if (isKeyLine) {
@@ -1156,9 +1135,9 @@ int PortMappingStatistics::execute()
           Try<int64_t> val = numify<int64_t>(tokens[i]);
 
           if (val.isError()) {
-            cerr << "Failed to parse the statistics in " <<  fields[0]
-                 << val.error() << endl;
-            return 1;
+            return Error(
+                "Failed to parse the statistics in " + fields[0] +
+                ": " + val.error());
           }
           stats[keys[i]] = val.get();
         }
@@ -1199,7 +1178,7 @@ int PortMappingStatistics::execute()
     // statistics as an error.
   } else if (statistics.isError()) {
     cerr << "Failed to get htb qdisc statistics on " << eth0
-         << " in namespace " << flags.pid.get() << endl;
+         << " in namespace " << pid << endl;
   }
 
   // Drops due to the bandwidth limit should be reported at the leaf.
@@ -1213,10 +1192,66 @@ int PortMappingStatistics::execute()
     // See discussion on network isolator statistics above.
   } else if (statistics.isError()) {
     cerr << "Failed to get fq_codel qdisc statistics on " << eth0
-         << " in namespace " << flags.pid.get() << endl;
+         << " in namespace " << pid << endl;
+  }
+
+  return result;
+}
+
+
+int PortMappingStatistics::execute()
+{
+  if (flags.help) {
+    cerr << "Usage: " << name() << " [OPTIONS]" << endl << endl
+         << "Supported options:" << endl
+         << flags.usage();
+    return 0;
+  }
+
+  if (flags.pids.isNone()) {
+    cerr << "The pids are not specified" << endl;
+    return 1;
+  }
+
+  if (flags.eth0_name.isNone()) {
+    cerr << "The public interface name (e.g., eth0) is not specified" << endl;
+    return 1;
+  }
+
+  // Collect the statistics for all the containers in one invocation
+  // so that the isolator only has to fork this subcommand once per
+  // sampling interval, instead of once per container.
+  JSON::Object result;
+
+  foreach (const string& token, strings::tokenize(flags.pids.get(), ",")) {
+    Try<pid_t> pid = numify<pid_t>(token);
+    if (pid.isError()) {
+      cerr << "Failed to parse the pid '" << token << "': "
+           << pid.error() << endl;
+      return 1;
+    }
+
+    // Enter the network namespace. NOTE: We only switch the network
+    // namespace, so /proc remains that of the host and we can keep
+    // entering the namespaces of the remaining containers.
+    Try<Nothing> setns = ns::setns(pid.get(), "net");
+    if (setns.isError()) {
+      // This could happen if the executor exits before this function
+      // is invoked. We do not log here to avoid spurious logging.
+      continue;
+    }
+
+    Try<ResourceStatistics> statistics = collect(flags, pid.get());
+    if (statistics.isError()) {
+      cerr << "Failed to collect statistics for pid " << pid.get() << ": "
+           << statistics.error() << endl;
+      continue;
+    }
+
+    result.values[token] = JSON::protobuf(statistics.get());
   }
 
-  cout << stringify(JSON::protobuf(result));
+  cout << stringify(result);
   return 0;
 }
 
@@ -3185,8 +3220,55 @@ Future<ResourceStatistics> PortMappingIsolatorProcess::usage(
   }
 
   // Retrieve the socket information from inside the container.
+  return collectStatistics()
+    .then(defer(
+        PID<PortMappingIsolatorProcess>(this),
+        &PortMappingIsolatorProcess::_usage,
+        result,
+        info->pid.get(),
+        lambda::_1));
+}
+
+
+Future<ResourceStatistics> PortMappingIsolatorProcess::_usage(
+    ResourceStatistics result,
+    pid_t pid,
+    const hashmap<pid_t, ResourceStatistics>& statistics)
+{
+  // The container may have exited between the start of the batch
+  // collection and now, in which case we simply report the link
+  // statistics collected above.
+  if (statistics.contains(pid)) {
+    result.MergeFrom(statistics.at(pid));
+  }
+
+  return result;
+}
+
+
+Future<hashmap<pid_t, ResourceStatistics>>
+PortMappingIsolatorProcess::collectStatistics()
+{
+  // The containerizer queries the containers back to back, so one
+  // batch collection per resource monitoring interval can serve the
+  // 'usage()' calls for all containers. This means we fork the
+  // statistics subcommand once per interval, rather than once per
+  // container per interval.
+  if (statisticsBatch.isSome() &&
+      Clock::now() - statisticsBatchStart.get() <
+        RESOURCE_MONITORING_INTERVAL) {
+    return statisticsBatch.get();
+  }
+
+  vector<string> pids;
+  foreachvalue (Info* info, infos) {
+    if (info->pid.isSome()) {
+      pids.push_back(stringify(info->pid.get()));
+    }
+  }
+
   PortMappingStatistics statistics;
-  statistics.flags.pid = info->pid.get();
+  statistics.flags.pids = strings::join(",", pids);
   statistics.flags.eth0_name = eth0;
   statistics.flags.enable_socket_statistics_summary =
     flags.network_enable_socket_statistics_summary;
@@ -3213,50 +3295,54 @@ Future<ResourceStatistics> PortMappingIsolatorProcess::usage(
     return Failure("Failed to launch the statistics subcommand: " + s.error());
   }
 
-  // TODO(chzhcn): it is possible for the subprocess to block on
-  // writing to its end of the pipe and never exit because the pipe
-  // has limited buffer size, but we have been careful to send very
-  // few bytes so this shouldn't be a problem.
-  return s.get().status()
+  // NOTE: Since the output now covers all containers it could exceed
+  // the pipe buffer size, so we read the output concurrently with
+  // waiting for the subprocess to exit, lest the subprocess block on
+  // writing its end of the pipe and never exit.
+  statisticsBatch = await(s.get().status(), io::read(s.get().out().get()))
     .then(defer(
         PID<PortMappingIsolatorProcess>(this),
-        &PortMappingIsolatorProcess::_usage,
-        result,
-        s.get()));
+        &PortMappingIsolatorProcess::_collectStatistics,
+        lambda::_1));
+
+  statisticsBatchStart = Clock::now();
+
+  return statisticsBatch.get();
 }
 
 
-Future<ResourceStatistics> PortMappingIsolatorProcess::_usage(
-    const ResourceStatistics& result,
-    const Subprocess& s)
+Future<hashmap<pid_t, ResourceStatistics>>
+PortMappingIsolatorProcess::_collectStatistics(
+    const std::tuple<Future<Option<int>>, Future<string>>& t)
 {
-  CHECK_READY(s.status());
+  const Future<Option<int>>& status = std::get<0>(t);
 
-  Option<int> status = s.status().get();
+  if (!status.isReady()) {
+    return Failure(
+        "Failed to get the exit status of the process for getting network "
+        "statistics: " +
+        (status.isFailed() ? status.failure() : "discarded"));
+  }
 
-  if (status.isNone()) {
+  if (status.get().isNone()) {
     return Failure(
         "The process for getting network statistics is unexpectedly reaped");
-  } else if (status.get() != 0) {
+  } else if (status.get().get() != 0) {
     return Failure(
         "The process for getting network statistics has non-zero exit code: " +
-        WSTRINGIFY(status.get()));
+        WSTRINGIFY(status.get().get()));
   }
 
-  return io::read(s.out().get())
-    .then(defer(
-        PID<PortMappingIsolatorProcess>(this),
-        &PortMappingIsolatorProcess::__usage,
-        result,
-        lambda::_1));
-}
+  const Future<string>& out = std::get<1>(t);
 
+  if (!out.isReady()) {
+    return Failure(
+        "Failed to read the output of the process for getting network "
+        "statistics: " +
+        (out.isFailed() ? out.failure() : "discarded"));
+  }
 
-Future<ResourceStatistics> PortMappingIsolatorProcess::__usage(
-    ResourceStatistics result,
-    const Future<string>& out)
-{
-  CHECK_READY(out);
+  hashmap<pid_t, ResourceStatistics> result;
 
   // NOTE: It's possible the subprocess has no output.
   if (out.get().empty()) {
@@ -3270,20 +3356,38 @@ Future<ResourceStatistics> PortMappingIsolatorProcess::__usage(
         "network statistics: " + object.error());
   }
 
-  Result<ResourceStatistics> _result =
-      protobuf::parse<ResourceStatistics>(object.get());
+  foreachpair (
+      const string& key,
+      const JSON::Value& value,
+      object.get().values) {
+    Try<pid_t> pid = numify<pid_t>(key);
+    if (pid.isError()) {
+      return Failure(
+          "Failed to parse the pid '" + key + "' in the output from the "
+          "process that gets the network statistics: " + pid.error());
+    }
 
-  if (_result.isError()) {
-    return Failure(
-        "Failed to parse the output from the process that gets the "
-        "network statistics: " + object.error());
-  }
+    if (!value.is<JSON::Object>()) {
+      return Failure(
+          "Expecting the network statistics for pid '" + key + "' to be "
+          "a JSON object");
+    }
 
-  result.MergeFrom(_result.get());
+    Result<ResourceStatistics> statistics =
+        protobuf::parse<ResourceStatistics>(value.as<JSON::Object>());
 
-  // NOTE: We unset the 'timestamp' field here because otherwise it
-  // will overwrite the timestamp set in the containerizer.
-  result.clear_timestamp();
+    if (statistics.isError()) {
+      return Failure(
+          "Failed to parse the output from the process that gets the "
+          "network statistics: " + statistics.error());
+    }
+
+    result[pid.get()] = statistics.get();
+
+    // NOTE: We unset the 'timestamp' field here because otherwise it
+    // will overwrite the timestamp set in the containerizer.
+    result[pid.get()].clear_timestamp();
+  }
 
   return result;
 }
@@ -3971,71 +4075,78 @@ string PortMappingIsolatorProcess::scripts(Info* info)
     script << "fi\n";
   }
 
-  // Set up filters on lo and eth0.
-  script << "tc qdisc add dev " << lo << " ingress\n";
-  script << "tc qdisc add dev " << eth0 << " ingress\n";
+  // Set up the qdiscs and filters on lo and eth0. All the tc commands
+  // below are collected and applied through a single 'tc -batch'
+  // invocation because forking one 'tc' per filter dominates the time
+  // spent in this script when a container has many (non-contiguous)
+  // port ranges. Batch mode stops at the first failing command, so
+  // together with 'set -e' above a failure still aborts the launch.
+  ostringstream tc;
+
+  tc << "qdisc add dev " << lo << " ingress\n";
+  tc << "qdisc add dev " << eth0 << " ingress\n";
 
   // Allow talking between containers and from container to host.
   // TODO(chzhcn): Consider merging the following two filters.
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip dst " << hostIPNetwork.address()
-         << " action mirred egress redirect dev " << eth0 << "\n";
-
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip dst "
-         << net::IPNetwork::LOOPBACK_V4().address()
-         << " action mirred egress redirect dev " << eth0 << "\n";
+  tc << "filter add dev " << lo << " parent " << ingress::HANDLE
+     << " protocol ip"
+     << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
+     << " flowid ffff:0"
+     << " match ip dst " << hostIPNetwork.address()
+     << " action mirred egress redirect dev " << eth0 << "\n";
+
+  tc << "filter add dev " << lo << " parent " << ingress::HANDLE
+     << " protocol ip"
+     << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
+     << " flowid ffff:0"
+     << " match ip dst "
+     << net::IPNetwork::LOOPBACK_V4().address()
+     << " action mirred egress redirect dev " << eth0 << "\n";
 
   foreach (const PortRange& range,
            getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts)) {
     // Local traffic inside a container will not be redirected to eth0.
-    script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-           << " protocol ip"
-           << " prio " << Priority(IP_FILTER_PRIORITY, HIGH).get() << " u32"
-           << " flowid ffff:0"
-           << " match ip dport " << range.begin() << " "
-           << hex << range.mask() << dec << "\n";
+    tc << "filter add dev " << lo << " parent " << ingress::HANDLE
+       << " protocol ip"
+       << " prio " << Priority(IP_FILTER_PRIORITY, HIGH).get() << " u32"
+       << " flowid ffff:0"
+       << " match ip dport " << range.begin() << " "
+       << hex << range.mask() << dec << "\n";
 
     // Traffic going to host loopback IP and ports assigned to this
     // container will be redirected to lo.
-    script << "tc filter add dev " << eth0 << " parent " << ingress::HANDLE
-           << " protocol ip"
-           << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
-           << " flowid ffff:0"
-           << " match ip dst "
-           << net::IPNetwork::LOOPBACK_V4().address()
-           << " match ip dport " << range.begin() << " "
-           << hex << range.mask() << dec
-           << " action mirred egress redirect dev " << lo << "\n";
+    tc << "filter add dev " << eth0 << " parent " << ingress::HANDLE
+       << " protocol ip"
+       << " prio " << Priority(IP_FILTER_PRIORITY, NORMAL).get() << " u32"
+       << " flowid ffff:0"
+       << " match ip dst "
+       << net::IPNetwork::LOOPBACK_V4().address()
+       << " match ip dport " << range.begin() << " "
+       << hex << range.mask() << dec
+       << " action mirred egress redirect dev " << lo << "\n";
   }
 
   // Do not forward the ICMP packet if the destination IP is self.
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip protocol 1 0xff"
-         << " match ip dst " << hostIPNetwork.address() << "\n";
-
-  script << "tc filter add dev " << lo << " parent " << ingress::HANDLE
-         << " protocol ip"
-         << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
-         << " flowid ffff:0"
-         << " match ip protocol 1 0xff"
-         << " match ip dst "
-         << net::IPNetwork::LOOPBACK_V4().address() << "\n";
+  tc << "filter add dev " << lo << " parent " << ingress::HANDLE
+     << " protocol ip"
+     << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
+     << " flowid ffff:0"
+     << " match ip protocol 1 0xff"
+     << " match ip dst " << hostIPNetwork.address() << "\n";
+
+  tc << "filter add dev " << lo << " parent " << ingress::HANDLE
+     << " protocol ip"
+     << " prio " << Priority(ICMP_FILTER_PRIORITY, NORMAL).get() << " u32"
+     << " flowid ffff:0"
+     << " match ip protocol 1 0xff"
+     << " match ip dst "
+     << net::IPNetwork::LOOPBACK_V4().address() << "\n";
 
   // Display the filters created on eth0 and lo.
-  script << "tc filter show dev " << eth0
-         << " parent " << ingress::HANDLE << "\n";
-  script << "tc filter show dev " << lo
-         << " parent " << ingress::HANDLE << "\n";
+  tc << "filter show dev " << eth0
+     << " parent " << ingress::HANDLE << "\n";
+  tc << "filter show dev " << lo
+     << " parent " << ingress::HANDLE << "\n";
 
   // If throughput limit for container egress traffic exists, use HTB
   // qdisc to achieve traffic shaping.
@@ -4046,12 +4157,12 @@ string PortMappingIsolatorProcess::scripts(Info* info)
   // throughput. TBF requires other parameters such as 'burst' that
   // HTB already has default values for.
   if (egressRateLimitPerContainer.isSome()) {
-    script << "tc qdisc add dev " << eth0 << " root handle "
-           << CONTAINER_TX_HTB_HANDLE << " htb default 1\n";
-    script << "tc class add dev " << eth0 << " parent "
-           << CONTAINER_TX_HTB_HANDLE << " classid "
-           << CONTAINER_TX_HTB_CLASS_ID << " htb rate "
-           << egressRateLimitPerContainer.get().bytes() * 8 << "bit\n";
+    tc << "qdisc add dev " << eth0 << " root handle "
+       << CONTAINER_TX_HTB_HANDLE << " htb default 1\n";
+    tc << "class add dev " << eth0 << " parent "
+       << CONTAINER_TX_HTB_HANDLE << " classid "
+       << CONTAINER_TX_HTB_CLASS_ID << " htb rate "
+       << egressRateLimitPerContainer.get().bytes() * 8 << "bit\n";
 
     // Packets are buffered at the leaf qdisc if we send them faster
     // than the HTB rate limit and may be dropped when the queue is
@@ -4059,14 +4170,18 @@ string PortMappingIsolatorProcess::scripts(Info* info)
     // fq_codel, which has a larger buffer and better control on
     // buffer bloat.
     // TODO(cwang): Verity that fq_codel qdisc is available.
-    script << "tc qdisc add dev " << eth0
-           << " parent " << CONTAINER_TX_HTB_CLASS_ID << " fq_codel\n";
+    tc << "qdisc add dev " << eth0
+       << " parent " << CONTAINER_TX_HTB_CLASS_ID << " fq_codel\n";
 
     // Display the htb qdisc and class created on eth0.
-    script << "tc qdisc show dev " << eth0 << "\n";
-    script << "tc class show dev " << eth0 << "\n";
+    tc << "qdisc show dev " << eth0 << "\n";
+    tc << "class show dev " << eth0 << "\n";
   }
 
+  // NOTE: The commands are passed through a (quoted) here document so
+  // that the shell does not expand their contents.
+  script << "tc -batch - <<'EOF'\n" << tc.str() << "EOF\n";
+
   return script.str();
 }
 
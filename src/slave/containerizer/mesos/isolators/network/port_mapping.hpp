@@ -23,11 +23,13 @@
 
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <process/id.hpp>
 #include <process/owned.hpp>
 #include <process/subprocess.hpp>
+#include <process/time.hpp>
 
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/counter.hpp>
@@ -286,12 +288,20 @@ private:
       const process::Future<Option<int>>& status);
 
   process::Future<ResourceStatistics> _usage(
-      const ResourceStatistics& result,
-      const process::Subprocess& s);
-
-  process::Future<ResourceStatistics> __usage(
       ResourceStatistics result,
-      const process::Future<std::string>& out);
+      pid_t pid,
+      const hashmap<pid_t, ResourceStatistics>& statistics);
+
+  // Collects the network statistics from inside all the containers
+  // with a single invocation of the statistics subcommand, keyed by
+  // the container pid. The collected batch is shared by all the
+  // 'usage()' calls within one resource monitoring interval.
+  process::Future<hashmap<pid_t, ResourceStatistics>> collectStatistics();
+
+  process::Future<hashmap<pid_t, ResourceStatistics>> _collectStatistics(
+      const std::tuple<
+          process::Future<Option<int>>,
+          process::Future<std::string>>& t);
 
   // Helper functions.
   Try<Nothing> addHostIPFilters(
@@ -339,6 +349,12 @@ private:
 
   hashmap<ContainerID, Info*> infos;
 
+  // The network statistics batch collected by the last run of the
+  // statistics subcommand and the time at which that run was started
+  // (see 'collectStatistics()').
+  Option<process::Future<hashmap<pid_t, ResourceStatistics>>> statisticsBatch;
+  Option<process::Time> statisticsBatchStart;
+
   // Recovered containers from a previous run that weren't managed by
   // the network isolator.
   hashset<ContainerID> unmanaged;
@@ -386,7 +402,7 @@ public:
     Flags();
 
     Option<std::string> eth0_name;
-    Option<pid_t> pid;
+    Option<std::string> pids;
     bool enable_socket_statistics_summary;
     bool enable_socket_statistics_details;
     bool enable_snmp_statistics;
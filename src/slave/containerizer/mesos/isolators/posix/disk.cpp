@@ -49,6 +49,10 @@
 
 #include "slave/containerizer/mesos/isolators/posix/disk.hpp"
 
+#if ENABLE_XFS_DISK_ISOLATOR
+#include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
+#endif
+
 namespace io = process::io;
 
 using std::deque;
@@ -84,6 +88,30 @@ namespace slave {
 
 Try<Isolator*> PosixDiskIsolatorProcess::create(const Flags& flags)
 {
+#if ENABLE_XFS_DISK_ISOLATOR
+  // Prefer XFS project quotas to 'du' where supported: the kernel
+  // maintains per-project block counters so usage is a single
+  // quotactl(2) away, while scanning a big sandbox with 'du' can take
+  // minutes and evicts useful data from the page cache.
+  //
+  // We only delegate when quota enforcement is requested because the
+  // kernel always enforces the hard limit it accounts against: a task
+  // over quota sees EDQUOT on write instead of being killed with a
+  // disk limitation.
+  if (flags.enforce_container_disk_quota && xfs::pathIsXfs(flags.work_dir)) {
+    Try<Isolator*> isolator = XfsDiskIsolatorProcess::create(flags);
+    if (isolator.isSome()) {
+      LOG(INFO) << "Using XFS project quotas instead of 'du' for"
+                << " disk usage accounting";
+      return isolator;
+    }
+
+    LOG(WARNING) << "Failed to create the XFS disk isolator, falling"
+                 << " back to 'du' based disk usage accounting: "
+                 << isolator.error();
+  }
+#endif
+
   // TODO(jieyu): Check the availability of command 'du'.
 
   return new MesosIsolator(process::Owned<MesosIsolatorProcess>(
@@ -175,6 +175,8 @@ Future<Nothing> XfsDiskIsolatorProcess::recover(
   // concerned with the on-disk state. We scan all the sandbox directories
   // for project IDs that we have not recovered and make a best effort to
   // remove all the corresponding on-disk state.
+  // NOTE: The extra level under 'executors' is the hashed shard
+  // directory that bounds executor directory fan-out.
   Try<list<string>> sandboxes = os::glob(path::join(
       paths::getSandboxRootDir(flags.work_dir),
       "*",
@@ -182,6 +184,7 @@ Future<Nothing> XfsDiskIsolatorProcess::recover(
       "*",
       "executors",
       "*",
+      "*",
       "runs",
       "*"));
 
@@ -78,7 +78,7 @@ Future<hashset<ContainerID>> PosixLauncher::recover(
 }
 
 
-Try<pid_t> PosixLauncher::fork(
+Future<pid_t> PosixLauncher::fork(
     const ContainerID& containerId,
     const string& path,
     const vector<string>& argv,
@@ -91,12 +91,12 @@ Try<pid_t> PosixLauncher::fork(
     vector<process::Subprocess::ParentHook> parentHooks)
 {
   if (namespaces.isSome() && namespaces.get() != 0) {
-    return Error("Posix launcher does not support namespaces");
+    return Failure("Posix launcher does not support namespaces");
   }
 
   if (pids.contains(containerId)) {
-    return Error("Process has already been forked for container " +
-                 stringify(containerId));
+    return Failure("Process has already been forked for container " +
+                   stringify(containerId));
   }
 
   // If we are on systemd, then extend the life of the child. Any
@@ -121,7 +121,7 @@ Try<pid_t> PosixLauncher::fork(
       {Subprocess::ChildHook::SETSID()});
 
   if (child.isError()) {
-    return Error("Failed to fork a child process: " + child.error());
+    return Failure("Failed to fork a child process: " + child.error());
   }
 
   LOG(INFO) << "Forked child with pid '" << child.get().pid()
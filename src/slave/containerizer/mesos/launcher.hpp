@@ -58,9 +58,12 @@ public:
   // exec the binary at the given path with the given argv, flags and
   // environment. The I/O of the child will be redirected according to
   // the specified I/O descriptors. The parentHooks will be executed
-  // in the parent process before the child execs. The parent will return
-  // the child's pid if the fork is successful.
-  virtual Try<pid_t> fork(
+  // in the parent process before the child execs. The returned future
+  // contains the child's pid if the fork is successful. NOTE: the
+  // fork may happen asynchronously (and, for concurrent launches,
+  // in parallel), so the caller must not assume the child exists
+  // before the future is ready.
+  virtual process::Future<pid_t> fork(
       const ContainerID& containerId,
       const std::string& path,
       const std::vector<std::string>& argv,
@@ -96,7 +99,7 @@ public:
   virtual process::Future<hashset<ContainerID>> recover(
       const std::list<mesos::slave::ContainerState>& states);
 
-  virtual Try<pid_t> fork(
+  virtual process::Future<pid_t> fork(
       const ContainerID& containerId,
       const std::string& path,
       const std::vector<std::string>& argv,
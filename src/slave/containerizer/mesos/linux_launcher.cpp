@@ -21,7 +21,9 @@
 
 #include <vector>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
+#include <process/defer.hpp>
 
 #include <stout/abort.hpp>
 #include <stout/check.hpp>
@@ -70,14 +72,13 @@ public:
   virtual process::Future<hashset<ContainerID>> recover(
       const std::list<mesos::slave::ContainerState>& states);
 
-  virtual Try<pid_t> fork(
+  virtual process::Future<pid_t> fork(
       const ContainerID& containerId,
       const std::string& path,
       const std::vector<std::string>& argv,
       const process::Subprocess::IO& in,
       const process::Subprocess::IO& out,
       const process::Subprocess::IO& err,
-      const flags::FlagsBase* flags,
       const Option<std::map<std::string, std::string>>& environment,
       const Option<int>& namespaces,
       std::vector<process::Subprocess::ParentHook> parentHooks);
@@ -88,6 +89,12 @@ public:
       const ContainerID& containerId);
 
 private:
+  // Continuation of `fork` that records the cloned child (or cleans
+  // up after a failed clone) once the worker thread is done.
+  process::Future<pid_t> _fork(
+      const ContainerID& containerId,
+      const Try<pid_t>& child);
+
   // Helper struct for storing information about each container. A
   // "container" here means a cgroup in the freezer subsystem that is
   // used to represent a collection of processes. This container may
@@ -202,7 +209,7 @@ Future<hashset<ContainerID>> LinuxLauncher::recover(
 }
 
 
-Try<pid_t> LinuxLauncher::fork(
+Future<pid_t> LinuxLauncher::fork(
     const ContainerID& containerId,
     const string& path,
     const vector<std::string>& argv,
@@ -214,19 +221,33 @@ Try<pid_t> LinuxLauncher::fork(
     const Option<int>& namespaces,
     vector<Subprocess::ParentHook> parentHooks)
 {
+  // Stringify the flags and append them to the arguments now (just
+  // like `subprocess` would) since the pointer is not guaranteed to
+  // remain valid after we return to the caller.
+  vector<string> _argv = argv;
+
+  if (flags != nullptr) {
+    foreachvalue (const flags::Flag& flag, *flags) {
+      Option<string> value = flag.stringify(*flags);
+      if (value.isSome()) {
+        _argv.push_back(
+            "--" + flag.effective_name().value + "=" + value.get());
+      }
+    }
+  }
+
   return dispatch(
       process.get(),
       &LinuxLauncherProcess::fork,
       containerId,
       path,
-      argv,
+      _argv,
       in,
       out,
       err,
-      flags,
       environment,
       namespaces,
-      parentHooks).get();
+      parentHooks);
 }
 
 
@@ -379,21 +400,77 @@ Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
 }
 
 
-Try<pid_t> LinuxLauncherProcess::fork(
+// Clones the container's "init" process. This runs on one of the
+// worker threads (see `LinuxLauncherProcess::fork`): cloning a
+// process with a large address space can take a long time due to
+// the page table copy, and running it here both keeps the launcher
+// responsive and lets the clones for concurrent container launches
+// proceed in parallel.
+static Try<pid_t> forkChild(
+    const string& path,
+    const vector<string>& argv,
+    const Subprocess::IO& in,
+    const Subprocess::IO& out,
+    const Subprocess::IO& err,
+    const Option<map<string, string>>& environment,
+    const Option<pid_t>& target,
+    int cloneFlags,
+    const vector<Subprocess::ParentHook>& parentHooks)
+{
+  Try<Subprocess> child = subprocess(
+      path,
+      argv,
+      in,
+      out,
+      err,
+      nullptr,
+      environment,
+      [target, cloneFlags](const lambda::function<int()>& child) {
+        if (target.isSome()) {
+          // TODO(benh): Factor out this set of namespaces that we
+          // enter and give a healthy comment for why these are the
+          // only ones we enter.
+          Try<pid_t> pid = ns::clone(
+              target.get(),
+              CLONE_NEWUTS | CLONE_NEWNET | CLONE_NEWPID,
+              child,
+              cloneFlags);
+          if (pid.isError()) {
+            LOG(WARNING) << "Failed to enter namespaces and clone: "
+                         << pid.error();
+            return -1;
+          }
+          return pid.get();
+        } else {
+          return os::clone(child, cloneFlags);
+        }
+      },
+      parentHooks,
+      {Subprocess::ChildHook::SETSID()});
+
+  if (child.isError()) {
+    return Error(child.error());
+  }
+
+  return child->pid();
+}
+
+
+Future<pid_t> LinuxLauncherProcess::fork(
     const ContainerID& containerId,
     const string& path,
     const vector<string>& argv,
     const process::Subprocess::IO& in,
     const process::Subprocess::IO& out,
     const process::Subprocess::IO& err,
-    const flags::FlagsBase* flags,
     const Option<map<string, string>>& environment,
     const Option<int>& namespaces,
     vector<Subprocess::ParentHook> parentHooks)
 {
   // Make sure this container (nested or not) is unique.
   if (containers.contains(containerId)) {
-    return Error("Container '" + stringify(containerId) + "' already exists");
+    return Failure(
+        "Container '" + stringify(containerId) + "' already exists");
   }
 
   Option<pid_t> target = None();
@@ -402,7 +479,7 @@ Try<pid_t> LinuxLauncherProcess::fork(
   if (containerId.has_parent()) {
     Option<Container> container = containers.get(containerId.parent());
     if (container.isNone()) {
-      return Error("Unknown parent container");
+      return Failure("Unknown parent container");
     }
 
     if (container->pid.isNone()) {
@@ -410,7 +487,7 @@ Try<pid_t> LinuxLauncherProcess::fork(
       // that in order to enter the namespaces? This would be best
       // effort because we don't know the namespaces that had been
       // created for the original pid.
-      return Error("Unknown parent container pid, can not enter namespaces");
+      return Failure("Unknown parent container pid, can not enter namespaces");
     }
 
     target = container->pid.get();
@@ -441,55 +518,63 @@ Try<pid_t> LinuxLauncherProcess::fork(
   }
 
   // Hook for creating and assigning the child into a freezer cgroup.
+  //
+  // NOTE: The hook may run off the launcher process (see below) so
+  // we capture everything it needs by value rather than touching
+  // `this` from another thread.
+  const string hierarchy = freezerHierarchy;
+  const string freezerCgroup = cgroup(containerId);
+
   parentHooks.emplace_back(Subprocess::ParentHook([=](pid_t child) {
-    return cgroups::isolate(
-        freezerHierarchy,
-        cgroup(containerId),
-        child);
+    return cgroups::isolate(hierarchy, freezerCgroup, child);
   }));
 
-  Try<Subprocess> child = subprocess(
+  // Register the container before cloning so that concurrent forks
+  // for the same container (or nested containers of it) observe it.
+  // The pid is recorded in `_fork` once the clone is done.
+  Container container;
+  container.id = containerId;
+
+  containers.put(container.id, container);
+
+  return async(
+      &forkChild,
       path,
       argv,
       in,
       out,
       err,
-      flags,
       environment,
-      [target, cloneFlags](const lambda::function<int()>& child) {
-        if (target.isSome()) {
-          // TODO(benh): Factor out this set of namespaces that we
-          // enter and give a healthy comment for why these are the
-          // only ones we enter.
-          Try<pid_t> pid = ns::clone(
-              target.get(),
-              CLONE_NEWUTS | CLONE_NEWNET | CLONE_NEWPID,
-              child,
-              cloneFlags);
-          if (pid.isError()) {
-            LOG(WARNING) << "Failed to enter namespaces and clone: "
-                         << pid.error();
-            return -1;
-          }
-          return pid.get();
-        } else {
-          return os::clone(child, cloneFlags);
-        }
-      },
-      parentHooks,
-      {Subprocess::ChildHook::SETSID()});
+      target,
+      cloneFlags,
+      parentHooks)
+    .then(defer(self(), &Self::_fork, containerId, lambda::_1));
+}
+
 
+Future<pid_t> LinuxLauncherProcess::_fork(
+    const ContainerID& containerId,
+    const Try<pid_t>& child)
+{
   if (child.isError()) {
-    return Error("Failed to clone child process: " + child.error());
+    containers.erase(containerId);
+    return Failure("Failed to clone child process: " + child.error());
   }
 
-  Container container;
-  container.id = containerId;
-  container.pid = child.get().pid();
+  if (!containers.contains(containerId)) {
+    // The container was destroyed while we were cloning, so there is
+    // nobody left to manage the child; kill it straight away.
+    LOG(WARNING) << "Killing child " << child.get() << " of container "
+                 << containerId << " which was destroyed during the fork";
 
-  containers.put(container.id, container);
+    os::kill(child.get(), SIGKILL);
+
+    return Failure("Container destroyed during fork");
+  }
+
+  containers.at(containerId).pid = child.get();
 
-  return container.pid.get();
+  return child.get();
 }
 
 
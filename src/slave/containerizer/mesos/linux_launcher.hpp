@@ -42,7 +42,7 @@ public:
   virtual process::Future<hashset<ContainerID>> recover(
       const std::list<mesos::slave::ContainerState>& states);
 
-  virtual Try<pid_t> fork(
+  virtual process::Future<pid_t> fork(
       const ContainerID& containerId,
       const std::string& path,
       const std::vector<std::string>& argv,
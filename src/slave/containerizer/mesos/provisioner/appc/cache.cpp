@@ -80,6 +80,12 @@ Try<Nothing> Cache::recover()
 
 Try<Nothing> Cache::add(const string& imageId)
 {
+  // Re-fetching an image that is already in the store resolves to the
+  // same image id; skip re-reading and re-parsing its manifest.
+  if (imageIds.containsValue(imageId)) {
+    return Nothing();
+  }
+
   const Path imageDir(paths::getImagePath(storeDir, imageId));
 
   Try<string> read = os::read(spec::getImageManifestPath(imageDir));
@@ -109,10 +109,9 @@ Try<Owned<slave::Store>> Store::create(const Flags& flags)
     return Error("Failed to create image cache: " + cache.error());
   }
 
-  Try<Nothing> recover = cache.get()->recover();
-  if (recover.isError()) {
-    return Error("Failed to load image cache: " + recover.error());
-  }
+  // NOTE: The cache index is built from the stored images during
+  // recovery (see 'StoreProcess::recover'). Building it here as well
+  // would scan the store (and parse every image manifest) twice.
 
   // TODO(jojy): Uri fetcher has 'shared' semantics for the
   // provisioner. It's a shared pointer which needs to be injected
@@ -73,6 +73,15 @@ Try<Owned<Backend>> AufsBackend::create(const Flags&)
       "but is running as user " + user.get());
   }
 
+  Try<bool> supported = fs::supported("aufs");
+  if (supported.isError()) {
+    return Error(supported.error());
+  }
+
+  if (!supported.get()) {
+    return Error("Aufs is not supported by the kernel");
+  }
+
   return Owned<Backend>(new AufsBackend(
       Owned<AufsBackendProcess>(new AufsBackendProcess())));
 }
@@ -204,7 +213,7 @@ Future<Nothing> AufsBackendProcess::provision(
 
 Future<bool> AufsBackendProcess::destroy(const string& rootfs)
 {
-  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::cachedRead();
   if (mountTable.isError()) {
     return Failure("Failed to read mount table: " + mountTable.error());
   }
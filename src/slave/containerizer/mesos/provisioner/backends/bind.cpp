@@ -190,7 +190,7 @@ Future<Nothing> BindBackendProcess::provision(
 
 Future<bool> BindBackendProcess::destroy(const string& rootfs)
 {
-  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::cachedRead();
 
   if (mountTable.isError()) {
     return Failure("Failed to read mount table: " + mountTable.error());
@@ -76,6 +76,15 @@ Try<Owned<Backend>> OverlayBackend::create(const Flags&)
       "but is running as user " + user.get());
   }
 
+  Try<bool> supported = fs::supported("overlayfs");
+  if (supported.isError()) {
+    return Error(supported.error());
+  }
+
+  if (!supported.get()) {
+    return Error("Overlayfs is not supported by the kernel");
+  }
+
   return Owned<Backend>(new OverlayBackend(
       Owned<OverlayBackendProcess>(new OverlayBackendProcess())));
 }
@@ -250,7 +259,7 @@ Future<bool> OverlayBackendProcess::destroy(
     const string& rootfs,
     const string& backendDir)
 {
-  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::cachedRead();
   if (mountTable.isError()) {
     return Failure("Failed to read mount table: " + mountTable.error());
   }
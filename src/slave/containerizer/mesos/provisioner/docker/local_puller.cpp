@@ -32,6 +32,8 @@
 
 #include "common/command_utils.hpp"
 
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/local_puller.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 
@@ -96,7 +98,7 @@ Try<Owned<Puller>> LocalPuller::create(const Flags& flags)
 
   Owned<LocalPullerProcess> process(new LocalPullerProcess(
       flags.docker_registry,
-      flags.image_provisioner_backend));
+      flags.image_provisioner_backend.getOrElse(COPY_BACKEND)));
 
   return Owned<Puller>(new LocalPuller(process));
 }
@@ -32,6 +32,8 @@
 
 #include "slave/state.hpp"
 
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/message.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/metadata_manager.hpp"
@@ -66,18 +68,31 @@ public:
       const spec::ImageReference& reference,
       bool cached);
 
+  Future<hashset<string>> referencedLayers();
+
   // TODO(chenlily): Implement removal of unreferenced images.
 
 private:
   // Write out metadata manager state to persistent store.
   Try<Nothing> persist();
 
+  // Adjust the layer reference counts for an image being added or
+  // removed from 'storedImages'.
+  void ref(const Image& image);
+  void unref(const Image& image);
+
   const Flags flags;
 
   // This is a lookup table for images that are stored in memory. It is keyed
   // by image name.
   // For example, "ubuntu:14.04" -> ubuntu14:04 Image.
   hashmap<string, Image> storedImages;
+
+  // Number of images in 'storedImages' referencing each layer. The
+  // counts are derived from the checkpointed image index (rather than
+  // persisted separately) so there is a single source of truth; they
+  // are rebuilt in 'recover()' and maintained in 'put()'.
+  hashmap<string, size_t> layerRefs;
 };
 
 
@@ -133,6 +148,12 @@ Future<Option<Image>> MetadataManager::get(
 }
 
 
+Future<hashset<string>> MetadataManager::referencedLayers()
+{
+  return dispatch(process.get(), &MetadataManagerProcess::referencedLayers);
+}
+
+
 Future<Image> MetadataManagerProcess::put(
     const spec::ImageReference& reference,
     const vector<string>& layerIds)
@@ -145,6 +166,15 @@ Future<Image> MetadataManagerProcess::put(
     dockerImage.add_layer_ids(layerId);
   }
 
+  // If we are overwriting a cached image (e.g., a re-pulled tag),
+  // drop the references to the old image's layers so that they can
+  // be garbage collected.
+  if (storedImages.contains(imageReference)) {
+    unref(storedImages[imageReference]);
+  }
+
+  ref(dockerImage);
+
   storedImages[imageReference] = dockerImage;
 
   Try<Nothing> status = persist();
@@ -179,6 +209,32 @@ Future<Option<Image>> MetadataManagerProcess::get(
 }
 
 
+Future<hashset<string>> MetadataManagerProcess::referencedLayers()
+{
+  return layerRefs.keys();
+}
+
+
+void MetadataManagerProcess::ref(const Image& image)
+{
+  foreach (const string& layerId, image.layer_ids()) {
+    layerRefs[layerId]++;
+  }
+}
+
+
+void MetadataManagerProcess::unref(const Image& image)
+{
+  foreach (const string& layerId, image.layer_ids()) {
+    CHECK(layerRefs.contains(layerId)) << "Unknown layer '" << layerId << "'";
+
+    if (--layerRefs[layerId] == 0) {
+      layerRefs.erase(layerId);
+    }
+  }
+}
+
+
 Try<Nothing> MetadataManagerProcess::persist()
 {
   Images images;
@@ -226,7 +282,7 @@ Future<Nothing> MetadataManagerProcess::recover()
       const string rootfsPath = paths::getImageLayerRootfsPath(
           flags.docker_store_dir,
           layerId,
-          flags.image_provisioner_backend);
+          flags.image_provisioner_backend.getOrElse(COPY_BACKEND));
 
       if (!os::exists(rootfsPath)) {
         missingLayerIds.push_back(layerId);
@@ -245,6 +301,7 @@ Future<Nothing> MetadataManagerProcess::recover()
                    << imageReference << "'";
     } else {
       storedImages[imageReference] = image;
+      ref(image);
     }
 
     VLOG(1) << "Successfully loaded image '" << imageReference << "'";
@@ -21,6 +21,7 @@
 #include <string>
 
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/option.hpp>
 #include <stout/protobuf.hpp>
@@ -51,8 +52,9 @@ class MetadataManagerProcess;
  * provisioner that are stored on disk. It keeps track of the layers
  * that Docker images are composed of and recovers Image objects
  * upon initialization by checking for dependent layers stored on disk.
- * Currently, image layers are stored indefinitely, with no garbage
- * collection of unreferenced image layers.
+ * Per-layer reference counts are maintained (and rebuilt from the
+ * checkpointed image index on recovery) so that the store can garbage
+ * collect layers that are no longer referenced by any cached image.
  */
 class MetadataManager
 {
@@ -92,6 +94,14 @@ public:
       const ::docker::spec::ImageReference& reference,
       bool cached);
 
+  /**
+   * Returns the ids of the layers that are referenced by at least one
+   * stored image. Layers on disk that are not in this set are not
+   * needed by any cached image (e.g., they belonged to an image that
+   * was re-pulled with new layers) and can be garbage collected.
+   */
+  process::Future<hashset<std::string>> referencedLayers();
+
 private:
   explicit MetadataManager(process::Owned<MetadataManagerProcess> process);
 
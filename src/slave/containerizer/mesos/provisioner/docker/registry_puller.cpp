@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <queue>
+
 #include <glog/logging.h>
 
 #include <process/collect.hpp>
@@ -21,6 +23,8 @@
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
 
+#include <stout/hashmap.hpp>
+
 #include <stout/os/exists.hpp>
 #include <stout/os/mkdir.hpp>
 #include <stout/os/rm.hpp>
@@ -30,6 +34,8 @@
 
 #include "uri/schemes/docker.hpp"
 
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/registry_puller.hpp"
 
@@ -44,6 +50,7 @@ using process::Failure;
 using process::Future;
 using process::Owned;
 using process::Process;
+using process::Promise;
 using process::Shared;
 
 using process::defer;
@@ -56,6 +63,14 @@ namespace internal {
 namespace slave {
 namespace docker {
 
+// The maximum number of layer blobs that are downloaded at the same
+// time. Bounding the downloads avoids saturating the network and the
+// registry for images with many layers; each layer is extracted as
+// soon as its own blob has arrived, while the remaining blobs are
+// still in flight.
+static const size_t MAX_CONCURRENT_BLOB_FETCHES = 3;
+
+
 class RegistryPullerProcess : public Process<RegistryPullerProcess>
 {
 public:
@@ -74,16 +89,18 @@ private:
       const spec::ImageReference& reference,
       const string& directory);
 
-  Future<vector<string>> __pull(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums);
+  Try<URI> getBlobUri(
+      const spec::ImageReference& reference,
+      const string& blobSum);
 
-  Future<hashset<string>> fetchBlobs(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest);
+  Future<Nothing> fetchBlob(const URI& uri, const string& directory);
+
+  void fetchNext();
+
+  Future<Nothing> extractLayer(
+      const string& directory,
+      const spec::v1::ImageManifest& v1,
+      const string& blobSum);
 
   RegistryPullerProcess(const RegistryPullerProcess&) = delete;
   RegistryPullerProcess& operator=(const RegistryPullerProcess&) = delete;
@@ -96,6 +113,20 @@ private:
   const http::URL defaultRegistryUrl;
 
   Shared<uri::Fetcher> fetcher;
+
+  // A blob download that is waiting for a free download slot.
+  struct PendingFetch
+  {
+    URI uri;
+    string directory;
+    Owned<Promise<Nothing>> promise;
+  };
+
+  std::queue<PendingFetch> fetchQueue;
+
+  // The number of blob downloads currently in flight. This never
+  // exceeds MAX_CONCURRENT_BLOB_FETCHES.
+  size_t activeFetches;
 };
 
 
@@ -116,7 +147,7 @@ Try<Owned<Puller>> RegistryPuller::create(
   Owned<RegistryPullerProcess> process(
       new RegistryPullerProcess(
           flags.docker_store_dir,
-          flags.image_provisioner_backend,
+          flags.image_provisioner_backend.getOrElse(COPY_BACKEND),
           defaultRegistryUrl.get(),
           fetcher));
 
@@ -159,7 +190,8 @@ RegistryPullerProcess::RegistryPullerProcess(
     storeDir(_storeDir),
     backend(_backend),
     defaultRegistryUrl(_defaultRegistryUrl),
-    fetcher(_fetcher) {}
+    fetcher(_fetcher),
+    activeFetches(0) {}
 
 
 static spec::ImageReference normalize(
@@ -270,29 +302,21 @@ Future<vector<string>> RegistryPullerProcess::_pull(
     return Failure("'fsLayers' and 'history' have different size in manifest");
   }
 
-  return fetchBlobs(reference, directory, manifest.get())
-    .then(defer(self(),
-                &Self::__pull,
-                reference,
-                directory,
-                manifest.get(),
-                lambda::_1));
-}
-
-
-Future<vector<string>> RegistryPullerProcess::__pull(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums)
-{
   vector<string> layerIds;
   list<Future<Nothing>> futures;
 
-  for (int i = 0; i < manifest.fslayers_size(); i++) {
-    CHECK(manifest.history(i).has_v1());
-    const spec::v1::ImageManifest& v1 = manifest.history(i).v1();
-    const string& blobSum = manifest.fslayers(i).blobsum();
+  // Blob downloads are bounded (see `fetchBlob`) and each layer is
+  // extracted right after its own blob has been downloaded, while
+  // the remaining blobs are still being downloaded.
+  //
+  // NOTE: There might exist duplicated blob sums in 'fsLayers'. We
+  // just need to fetch each of them once.
+  hashmap<string, Future<Nothing>> fetching;
+
+  for (int i = 0; i < manifest->fslayers_size(); i++) {
+    CHECK(manifest->history(i).has_v1());
+    const spec::v1::ImageManifest& v1 = manifest->history(i).v1();
+    const string& blobSum = manifest->fslayers(i).blobsum();
 
     // NOTE: We put parent layer ids in front because that's what the
     // provisioner backends assume.
@@ -304,32 +328,25 @@ Future<vector<string>> RegistryPullerProcess::__pull(
       continue;
     }
 
-    const string layerPath = path::join(directory, v1.id());
-    const string tar = path::join(directory, blobSum);
-    const string rootfs = paths::getImageLayerRootfsPath(layerPath, backend);
-    const string json = paths::getImageLayerManifestPath(layerPath);
-
-    VLOG(1) << "Extracting layer tar ball '" << tar
-            << " to rootfs '" << rootfs << "'";
+    if (!fetching.contains(blobSum)) {
+      Try<URI> blobUri = getBlobUri(reference, blobSum);
+      if (blobUri.isError()) {
+        return Failure(blobUri.error());
+      }
 
-    // NOTE: This will create 'layerPath' as well.
-    Try<Nothing> mkdir = os::mkdir(rootfs, true);
-    if (mkdir.isError()) {
-      return Failure(
-          "Failed to create rootfs directory '" + rootfs + "' "
-          "for layer '" + v1.id() + "': " + mkdir.error());
-    }
+      VLOG(1) << "Fetching blob '" << blobSum << "' for layer '"
+              << v1.id() << "' of image '" << reference << "'";
 
-    Try<Nothing> write = os::write(json, stringify(JSON::protobuf(v1)));
-    if (write.isError()) {
-      return Failure(
-          "Failed to save the layer manifest for layer '" +
-          v1.id() + "': " + write.error());
+      fetching[blobSum] = fetchBlob(blobUri.get(), directory);
     }
 
-    futures.push_back(command::untar(Path(tar), Path(rootfs)));
+    futures.push_back(
+        fetching.at(blobSum)
+          .then(defer(self(), &Self::extractLayer, directory, v1, blobSum)));
   }
 
+  const hashset<string> blobSums = fetching.keys();
+
   return collect(futures)
     .then([=]() -> Future<vector<string>> {
       // Remove the tarballs after the extraction.
@@ -349,84 +366,111 @@ Future<vector<string>> RegistryPullerProcess::__pull(
 }
 
 
-Future<hashset<string>> RegistryPullerProcess::fetchBlobs(
+Try<URI> RegistryPullerProcess::getBlobUri(
     const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest)
+    const string& blobSum)
 {
-  // First, find all the blobs that need to be fetched.
-  //
-  // NOTE: There might exist duplicated blob sums in 'fsLayers'. We
-  // just need to fetch one of them.
-  hashset<string> blobSums;
-
-  for (int i = 0; i < manifest.fslayers_size(); i++) {
-    CHECK(manifest.history(i).has_v1());
-    const spec::v1::ImageManifest& v1 = manifest.history(i).v1();
+  if (reference.has_registry()) {
+    Result<int> port = spec::getRegistryPort(reference.registry());
+    if (port.isError()) {
+      return Error("Failed to get registry port: " + port.error());
+    }
 
-    // Check if the layer is in the store or not. If yes, skip the
-    // unnecessary fetching.
-    if (os::exists(
-        paths::getImageLayerRootfsPath(storeDir, v1.id(), backend))) {
-      continue;
+    Try<string> scheme = spec::getRegistryScheme(reference.registry());
+    if (scheme.isError()) {
+      return Error("Failed to get registry scheme: " + scheme.error());
     }
 
-    const string& blobSum = manifest.fslayers(i).blobsum();
+    // If users want to use the registry specified in '--docker_image',
+    // an URL scheme must be specified in '--docker_registry', because
+    // there is no scheme allowed in docker image name.
+    return uri::docker::blob(
+        reference.repository(),
+        blobSum,
+        spec::getRegistryHost(reference.registry()),
+        scheme.get(),
+        port.isSome() ? port.get() : Option<int>());
+  }
 
-    VLOG(1) << "Fetching blob '" << blobSum << "' for layer '"
-            << v1.id() << "' of image '" << reference << "'";
+  const string registry = defaultRegistryUrl.domain.isSome()
+    ? defaultRegistryUrl.domain.get()
+    : stringify(defaultRegistryUrl.ip.get());
 
-    blobSums.insert(blobSum);
-  }
+  const Option<int> port = defaultRegistryUrl.port.isSome()
+    ? static_cast<int>(defaultRegistryUrl.port.get())
+    : Option<int>();
 
-  // Now, actually fetch the blobs.
-  list<Future<Nothing>> futures;
+  return uri::docker::blob(
+      reference.repository(),
+      blobSum,
+      registry,
+      defaultRegistryUrl.scheme,
+      port);
+}
 
-  foreach (const string& blobSum, blobSums) {
-    URI blobUri;
 
-    if (reference.has_registry()) {
-      Result<int> port = spec::getRegistryPort(reference.registry());
-      if (port.isError()) {
-        return Failure("Failed to get registry port: " + port.error());
-      }
+Future<Nothing> RegistryPullerProcess::fetchBlob(
+    const URI& uri,
+    const string& directory)
+{
+  Owned<Promise<Nothing>> promise(new Promise<Nothing>());
 
-      Try<string> scheme = spec::getRegistryScheme(reference.registry());
-      if (scheme.isError()) {
-        return Failure("Failed to get registry scheme: " + scheme.error());
-      }
+  fetchQueue.push(PendingFetch{uri, directory, promise});
+  fetchNext();
 
-      // If users want to use the registry specified in '--docker_image',
-      // an URL scheme must be specified in '--docker_registry', because
-      // there is no scheme allowed in docker image name.
-      blobUri = uri::docker::blob(
-          reference.repository(),
-          blobSum,
-          spec::getRegistryHost(reference.registry()),
-          scheme.get(),
-          port.isSome() ? port.get() : Option<int>());
-    } else {
-      const string registry = defaultRegistryUrl.domain.isSome()
-        ? defaultRegistryUrl.domain.get()
-        : stringify(defaultRegistryUrl.ip.get());
-
-      const Option<int> port = defaultRegistryUrl.port.isSome()
-        ? static_cast<int>(defaultRegistryUrl.port.get())
-        : Option<int>();
-
-      blobUri = uri::docker::blob(
-          reference.repository(),
-          blobSum,
-          registry,
-          defaultRegistryUrl.scheme,
-          port);
-    }
+  return promise->future();
+}
 
-    futures.push_back(fetcher->fetch(blobUri, directory));
+
+void RegistryPullerProcess::fetchNext()
+{
+  while (activeFetches < MAX_CONCURRENT_BLOB_FETCHES && !fetchQueue.empty()) {
+    PendingFetch pending = fetchQueue.front();
+    fetchQueue.pop();
+
+    activeFetches++;
+
+    Owned<Promise<Nothing>> promise = pending.promise;
+
+    fetcher->fetch(pending.uri, pending.directory)
+      .onAny(defer(self(), [=](const Future<Nothing>& fetch) {
+        activeFetches--;
+        promise->associate(fetch);
+        fetchNext();
+      }));
   }
+}
 
-  return collect(futures)
-    .then([blobSums]() -> hashset<string> { return blobSums; });
+
+Future<Nothing> RegistryPullerProcess::extractLayer(
+    const string& directory,
+    const spec::v1::ImageManifest& v1,
+    const string& blobSum)
+{
+  const string layerPath = path::join(directory, v1.id());
+  const string tar = path::join(directory, blobSum);
+  const string rootfs = paths::getImageLayerRootfsPath(layerPath, backend);
+  const string json = paths::getImageLayerManifestPath(layerPath);
+
+  VLOG(1) << "Extracting layer tar ball '" << tar
+          << " to rootfs '" << rootfs << "'";
+
+  // NOTE: This will create 'layerPath' as well.
+  Try<Nothing> mkdir = os::mkdir(rootfs, true);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create rootfs directory '" + rootfs + "' "
+        "for layer '" + v1.id() + "': " + mkdir.error());
+  }
+
+  Try<Nothing> write = os::write(json, stringify(JSON::protobuf(v1)));
+  if (write.isError()) {
+    return Failure(
+        "Failed to save the layer manifest for layer '" +
+        v1.id() + "': " + write.error());
+  }
+
+  return command::untar(Path(tar), Path(rootfs));
 }
 
 } // namespace docker {
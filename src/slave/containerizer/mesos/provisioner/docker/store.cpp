@@ -20,6 +20,7 @@
 #include <glog/logging.h>
 
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
 
@@ -28,8 +29,13 @@
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
 
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
 #include <mesos/docker/spec.hpp>
 
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/metadata_manager.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/puller.hpp"
@@ -60,7 +66,8 @@ public:
     : ProcessBase(process::ID::generate("docker-provisioner-store")),
       flags(_flags),
       metadataManager(_metadataManager),
-      puller(_puller) {}
+      puller(_puller),
+      provisioning(0) {}
 
   ~StoreProcess() {}
 
@@ -68,6 +75,8 @@ public:
 
   Future<ImageInfo> get(const mesos::Image& image);
 
+  void release(const ImageInfo& imageInfo);
+
 private:
   Future<Image> _get(
       const spec::ImageReference& reference,
@@ -83,14 +92,59 @@ private:
       const string& staging,
       const string& layerId);
 
+  // Garbage collects layers on disk that are not referenced by any
+  // cached image (see `MetadataManager::referencedLayers`). `gc`
+  // computes the candidates and `_gc` removes them one layer per
+  // dispatch so that collection does not monopolize the store
+  // process. GC is skipped (and abandoned) while a pull or a
+  // provisioning is in flight: pulled layers appear on disk before
+  // the metadata manager references them, and layers handed out by
+  // `get` may be unreferenced (e.g., their tag was re-pulled) while
+  // a backend is still reading them. It is re-triggered when they
+  // complete.
+  void gc();
+  void _gc(const vector<string>& candidates);
+
   const Flags flags;
 
   Owned<MetadataManager> metadataManager;
   Owned<Puller> puller;
   hashmap<string, Owned<Promise<Image>>> pulling;
+
+  // Number of `get()` results whose layers are still being
+  // provisioned into a container rootfs; the provisioner signals
+  // completion via `release`.
+  size_t provisioning;
+
+  struct Metrics
+  {
+    Metrics();
+    ~Metrics();
+
+    process::metrics::Counter image_cache_hits;
+    process::metrics::Counter image_cache_misses;
+  } metrics;
 };
 
 
+StoreProcess::Metrics::Metrics()
+  : image_cache_hits(
+      "containerizer/mesos/provisioner/docker_store/image_cache_hits"),
+    image_cache_misses(
+      "containerizer/mesos/provisioner/docker_store/image_cache_misses")
+{
+  process::metrics::add(image_cache_hits);
+  process::metrics::add(image_cache_misses);
+}
+
+
+StoreProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(image_cache_hits);
+  process::metrics::remove(image_cache_misses);
+}
+
+
 Try<Owned<slave::Store>> Store::create(const Flags& flags)
 {
   // TODO(jieyu): We should inject URI fetcher from top level, instead
@@ -174,9 +228,22 @@ Future<ImageInfo> Store::get(const mesos::Image& image)
 }
 
 
+void Store::release(const ImageInfo& imageInfo)
+{
+  dispatch(process.get(), &StoreProcess::release, imageInfo);
+}
+
+
 Future<Nothing> StoreProcess::recover()
 {
-  return metadataManager->recover();
+  return metadataManager->recover()
+    .then(defer(self(), [=]() {
+      // Collect any layers orphaned before the restart (e.g., by
+      // re-pulled tags) so they do not accumulate across agent
+      // lifetimes.
+      gc();
+      return Nothing();
+    }));
 }
 
 
@@ -211,9 +278,12 @@ Future<Image> StoreProcess::_get(
   // situation where a layer was returned to the provisioner but is
   // later evicted.
   if (image.isSome()) {
+    ++metrics.image_cache_hits;
     return image.get();
   }
 
+  ++metrics.image_cache_misses;
+
   Try<string> staging =
     os::mkdtemp(paths::getStagingTempDir(flags.docker_store_dir));
 
@@ -241,6 +311,11 @@ Future<Image> StoreProcess::_get(
           LOG(WARNING) << "Failed to remove staging directory: "
                        << rmdir.error();
         }
+
+        // A completed pull may have overwritten a cached image and
+        // orphaned its layers (e.g., a re-pulled tag), so trigger a
+        // collection.
+        gc();
       }));
 
     promise->associate(future);
@@ -262,7 +337,7 @@ Future<ImageInfo> StoreProcess::__get(const Image& image)
     layerPaths.push_back(paths::getImageLayerRootfsPath(
         flags.docker_store_dir,
         layerId,
-        flags.image_provisioner_backend));
+        flags.image_provisioner_backend.getOrElse(COPY_BACKEND)));
   }
 
   // Read the manifest from the last layer because all runtime config
@@ -283,10 +358,27 @@ Future<ImageInfo> StoreProcess::__get(const Image& image)
     return Failure("Failed to parse docker v1 manifest: " + v1.error());
   }
 
+  // The caller provisions a container rootfs from the returned
+  // layers; keep them from being garbage collected until `release`
+  // is called.
+  ++provisioning;
+
   return ImageInfo{layerPaths, v1.get()};
 }
 
 
+void StoreProcess::release(const ImageInfo& imageInfo)
+{
+  CHECK_GT(provisioning, 0u);
+
+  if (--provisioning == 0) {
+    // Layers orphaned while the provisioning was in flight (e.g., by
+    // a re-pulled tag) had their collection deferred until now.
+    gc();
+  }
+}
+
+
 Future<vector<string>> StoreProcess::moveLayers(
     const string& staging,
     const vector<string>& layerIds)
@@ -318,7 +410,7 @@ Future<Nothing> StoreProcess::moveLayer(
   const string targetRootfs = paths::getImageLayerRootfsPath(
       flags.docker_store_dir,
       layerId,
-      flags.image_provisioner_backend);
+      flags.image_provisioner_backend.getOrElse(COPY_BACKEND));
 
   // NOTE: Since the layer id is supposed to be unique. If the layer
   // already exists in the store, we'll skip the moving since they are
@@ -351,7 +443,7 @@ Future<Nothing> StoreProcess::moveLayer(
     // different backend.
     const string sourceRootfs = paths::getImageLayerRootfsPath(
         source,
-        flags.image_provisioner_backend);
+        flags.image_provisioner_backend.getOrElse(COPY_BACKEND));
 
     Try<Nothing> rename = os::rename(sourceRootfs, targetRootfs);
     if (rename.isError()) {
@@ -364,6 +456,104 @@ Future<Nothing> StoreProcess::moveLayer(
   return Nothing();
 }
 
+
+void StoreProcess::gc()
+{
+  // With non-copy backends (e.g., bind, overlay) the rootfs of a
+  // running container references the layers in the store directly,
+  // and the store has no knowledge of which containers are still
+  // running, so collecting layers is only safe with the copy backend.
+  if (flags.image_provisioner_backend.getOrElse(COPY_BACKEND) !=
+      COPY_BACKEND) {
+    VLOG(1) << "Skipping layer garbage collection because the image"
+            << " provisioner backend is not '" << COPY_BACKEND << "'";
+    return;
+  }
+
+  // Layers pulled by an in-flight pull appear on disk before the
+  // metadata manager references them, and layers handed out by `get`
+  // may be unreferenced (e.g., their tag was re-pulled) while a
+  // backend is still reading them; try again once pulls and
+  // provisioning complete.
+  if (!pulling.empty() || provisioning > 0) {
+    return;
+  }
+
+  const string layersDir = paths::getImageLayersDir(flags.docker_store_dir);
+
+  if (!os::exists(layersDir)) {
+    return;
+  }
+
+  Try<list<string>> layerIds = os::ls(layersDir);
+  if (layerIds.isError()) {
+    LOG(WARNING) << "Failed to list layers in '" << layersDir
+                 << "' for garbage collection: " << layerIds.error();
+    return;
+  }
+
+  metadataManager->referencedLayers()
+    .onAny(defer(self(), [=](const Future<hashset<string>>& referenced) {
+      if (!referenced.isReady()) {
+        LOG(WARNING) << "Failed to get the referenced layers for garbage"
+                     << " collection: "
+                     << (referenced.isFailed()
+                         ? referenced.failure()
+                         : "discarded");
+        return;
+      }
+
+      vector<string> candidates;
+      foreach (const string& layerId, layerIds.get()) {
+        if (!referenced->contains(layerId)) {
+          candidates.push_back(layerId);
+        }
+      }
+
+      if (!candidates.empty()) {
+        LOG(INFO) << "Garbage collecting " << candidates.size()
+                  << " unreferenced layers";
+
+        _gc(candidates);
+      }
+    }));
+}
+
+
+void StoreProcess::_gc(const vector<string>& candidates)
+{
+  if (candidates.empty()) {
+    return;
+  }
+
+  // A pull or a provisioning might have started since the candidates
+  // were computed and could resurrect or still be reading one of
+  // them, so abandon this collection; a fresh one is triggered when
+  // they complete.
+  if (!pulling.empty() || provisioning > 0) {
+    return;
+  }
+
+  const string layerId = candidates.back();
+
+  Try<Nothing> rmdir = os::rmdir(
+      paths::getImageLayerPath(flags.docker_store_dir, layerId));
+
+  if (rmdir.isError()) {
+    LOG(WARNING) << "Failed to remove unreferenced layer '" << layerId
+                 << "': " << rmdir.error();
+  } else {
+    VLOG(1) << "Removed unreferenced layer '" << layerId << "'";
+  }
+
+  vector<string> remaining = candidates;
+  remaining.pop_back();
+
+  // Remove one layer per dispatch so that garbage collection is
+  // interleaved with the store's regular work.
+  dispatch(self(), &Self::_gc, remaining);
+}
+
 } // namespace docker {
 } // namespace slave {
 } // namespace internal {
@@ -52,6 +52,8 @@ public:
 
   virtual process::Future<ImageInfo> get(const mesos::Image& image);
 
+  virtual void release(const ImageInfo& imageInfo);
+
 private:
   explicit Store(process::Owned<StoreProcess> process);
 
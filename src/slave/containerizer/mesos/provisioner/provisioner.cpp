@@ -37,6 +37,7 @@
 #include "slave/paths.hpp"
 
 #include "slave/containerizer/mesos/provisioner/backend.hpp"
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
 #include "slave/containerizer/mesos/provisioner/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/provisioner.hpp"
 #include "slave/containerizer/mesos/provisioner/store.hpp"
@@ -55,8 +56,10 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
-Try<Owned<Provisioner>> Provisioner::create(const Flags& flags)
+Try<Owned<Provisioner>> Provisioner::create(const Flags& _flags)
 {
+  Flags flags = _flags;
+
   string _rootDir = slave::paths::getProvisionerDir(flags.work_dir);
 
   Try<Nothing> mkdir = os::mkdir(_rootDir);
@@ -75,20 +78,42 @@ Try<Owned<Provisioner>> Provisioner::create(const Flags& flags)
 
   CHECK_SOME(rootDir); // Can't be None since we just created it.
 
-  Try<hashmap<Image::Type, Owned<Store>>> stores = Store::create(flags);
-  if (stores.isError()) {
-    return Error("Failed to create image stores: " + stores.error());
-  }
-
   hashmap<string, Owned<Backend>> backends = Backend::create(flags);
   if (backends.empty()) {
     return Error("No usable provisioner backend created");
   }
 
-  if (!backends.contains(flags.image_provisioner_backend)) {
+  if (flags.image_provisioner_backend.isNone()) {
+    // Pick the best backend that is usable on this host: `overlay`
+    // and `aufs` share the read-only image layers across containers
+    // while `copy` duplicates them for every container, so prefer
+    // them in that order. `bind` is never picked by default since it
+    // only supports single layer images and read-only rootfses.
+    foreach (const string& backend,
+             vector<string>({OVERLAY_BACKEND, AUFS_BACKEND, COPY_BACKEND})) {
+      if (backends.contains(backend)) {
+        flags.image_provisioner_backend = backend;
+        break;
+      }
+    }
+
+    if (flags.image_provisioner_backend.isNone()) {
+      return Error("No usable default provisioner backend found");
+    }
+
+    LOG(INFO) << "Using default backend '"
+              << flags.image_provisioner_backend.get() << "'";
+  } else if (!backends.contains(flags.image_provisioner_backend.get())) {
     return Error(
         "The specified provisioner backend '" +
-        flags.image_provisioner_backend + "' is unsupported");
+        flags.image_provisioner_backend.get() + "' is unsupported");
+  }
+
+  // NOTE: The stores are created after the backend is resolved since
+  // the layout of the layers in the store depends on the backend.
+  Try<hashmap<Image::Type, Owned<Store>>> stores = Store::create(flags);
+  if (stores.isError()) {
+    return Error("Failed to create image stores: " + stores.error());
   }
 
   return Owned<Provisioner>(new Provisioner(
@@ -277,10 +302,11 @@ Future<ProvisionInfo> ProvisionerProcess::_provision(
     const Image& image,
     const ImageInfo& imageInfo)
 {
-  // TODO(jieyu): Choose a backend smartly. For instance, if there is
-  // only one layer returned from the store, prefer to use bind
-  // backend because it's the simplest.
-  const string& backend = flags.image_provisioner_backend;
+  // The backend is resolved in `Provisioner::create` (either the
+  // operator specified it or the best supported one was picked).
+  CHECK_SOME(flags.image_provisioner_backend);
+
+  const string& backend = flags.image_provisioner_backend.get();
   CHECK(backends.contains(backend));
 
   string rootfsId = UUID::random().toString();
@@ -307,10 +333,21 @@ Future<ProvisionInfo> ProvisionerProcess::_provision(
       containerId,
       backend);
 
-  return backends.get(backend).get()->provision(
+  Future<Nothing> provisioning = backends.get(backend).get()->provision(
       imageInfo.layers,
       rootfs,
-      backendDir)
+      backendDir);
+
+  // The store keeps the image's layers referenced until the backend
+  // is done reading them: a concurrent re-pull of the image's tag
+  // could otherwise orphan the layers and have them garbage
+  // collected mid-copy.
+  provisioning
+    .onAny(defer(self(), [=](const Future<Nothing>&) {
+      stores.get(image.type()).get()->release(imageInfo);
+    }));
+
+  return provisioning
     .then(defer(self(), &Self::__provision, rootfs, image, imageInfo));
 }
 
@@ -82,6 +82,13 @@ public:
   // The returned future fails if the requested image or any of its
   // dependencies cannot be found or failed to be fetched.
   virtual process::Future<ImageInfo> get(const Image& image) = 0;
+
+  // Called by the provisioner once the layers returned by a previous
+  // successful `get()` are no longer being read, i.e., provisioning
+  // of the container rootfs has completed (or failed). Stores that
+  // garbage collect cached layers use this to keep the layers of an
+  // in-flight provisioning referenced.
+  virtual void release(const ImageInfo& imageInfo) {}
 };
 
 } // namespace slave {
@@ -34,8 +34,6 @@
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #endif // __linux__
 
-#include "slave/containerizer/mesos/provisioner/constants.hpp"
-
 using std::string;
 
 mesos::internal::slave::Flags::Flags()
@@ -129,8 +127,10 @@ mesos::internal::slave::Flags::Flags()
   add(&Flags::image_provisioner_backend,
       "image_provisioner_backend",
       "Strategy for provisioning container rootfs from images,\n"
-      "e.g., `aufs`, `bind`, `copy`, `overlay`.",
-      COPY_BACKEND);
+      "e.g., `aufs`, `bind`, `copy`, `overlay`. If not set, the agent\n"
+      "picks the best backend that is supported on the host: `overlay`\n"
+      "(which shares the read-only image layers across containers), then\n"
+      "`aufs`, then `copy`.");
 
   add(&Flags::appc_simple_discovery_uri_prefix,
       "appc_simple_discovery_uri_prefix",
@@ -340,6 +340,14 @@ mesos::internal::slave::Flags::Flags()
       "information and sandboxes.",
       DISK_WATCH_INTERVAL);
 
+  add(&Flags::resource_monitoring_interval,
+      "resource_monitoring_interval",
+      "Maximum age of the resource usage sample served from the\n"
+      "`/monitor/statistics` and `/containers` endpoints. Usage is\n"
+      "collected from the containerizer at most once per interval,\n"
+      "regardless of how many monitoring clients are polling.",
+      RESOURCE_MONITORING_INTERVAL);
+
   add(&Flags::container_logger,
       "container_logger",
       "The name of the container logger to use for logging container\n"
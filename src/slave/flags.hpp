@@ -48,7 +48,7 @@ public:
   std::string launcher;
 
   Option<std::string> image_providers;
-  std::string image_provisioner_backend;
+  Option<std::string> image_provisioner_backend;
 
   std::string appc_simple_discovery_uri_prefix;
   std::string appc_store_dir;
@@ -79,6 +79,7 @@ public:
   Duration gc_delay;
   double gc_disk_headroom;
   Duration disk_watch_interval;
+  Duration resource_monitoring_interval;
 
   Option<std::string> container_logger;
 
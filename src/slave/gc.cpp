@@ -16,10 +16,15 @@
 
 #include <list>
 
+#include <process/async.hpp>
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
 
 #include <stout/os/rmdir.hpp>
 
@@ -45,6 +50,23 @@ GarbageCollectorProcess::~GarbageCollectorProcess()
   foreachvalue (const PathInfo& info, paths) {
     info.promise->discard();
   }
+
+  while (!deleting.empty()) {
+    deleting.front().promise->discard();
+    deleting.pop();
+  }
+}
+
+
+// Deletes the specified path on a worker thread (see
+// `GarbageCollectorProcess::_remove`).
+static Try<Nothing> rmdir(const string& path)
+{
+  // Run rmdir with 'continueOnError = true'. It's possible for
+  // tasks and isolators to lay down files that are not deletable by
+  // GC. In the face of such errors GC needs to free up disk space
+  // wherever it can because it's already re-offered to frameworks.
+  return os::rmdir(path, true, true, true);
 }
 
 
@@ -57,7 +79,7 @@ Future<Nothing> GarbageCollectorProcess::schedule(
   // If there's an existing schedule for this path, we must remove
   // it here in order to reschedule.
   if (timeouts.contains(path)) {
-    CHECK(unschedule(path));
+    CHECK(erase(path));
   }
 
   Owned<Promise<Nothing>> promise(new Promise<Nothing>());
@@ -78,10 +100,8 @@ Future<Nothing> GarbageCollectorProcess::schedule(
 }
 
 
-bool GarbageCollectorProcess::unschedule(const string& path)
+bool GarbageCollectorProcess::erase(const string& path)
 {
-  LOG(INFO) << "Unscheduling '" << path << "' from gc";
-
   if (!timeouts.contains(path)) {
     return false;
   }
@@ -108,6 +128,64 @@ bool GarbageCollectorProcess::unschedule(const string& path)
 }
 
 
+Future<bool> GarbageCollectorProcess::unschedule(const string& path)
+{
+  LOG(INFO) << "Unscheduling '" << path << "' from gc";
+
+  bool unscheduled = erase(path);
+
+  // The path might (also) be queued for deletion on the worker
+  // thread: its timer already fired but the deletion has not
+  // finished yet. The caller is about to reuse the path, so it must
+  // not race with a concurrent rmdir: an entry whose deletion has
+  // not started is simply dequeued, while an in-flight deletion
+  // cannot be cancelled and the caller has to wait for it to finish.
+  Option<Future<Nothing>> inflight = None();
+
+  if (!deleting.empty()) {
+    std::queue<PathInfo> remaining;
+    bool first = true;
+
+    while (!deleting.empty()) {
+      const PathInfo info = deleting.front();
+      deleting.pop();
+
+      if (info.path != path) {
+        remaining.push(info);
+      } else if (first && removing) {
+        // This deletion is already running on the worker thread;
+        // note that `__remove` expects the entry to remain at the
+        // front of the queue.
+        inflight = info.promise->future();
+        remaining.push(info);
+      } else {
+        info.promise->discard();
+        unscheduled = true;
+      }
+
+      first = false;
+    }
+
+    // Note that PathInfo is not assignable (it has const members),
+    // so the rebuilt queue is swapped in rather than assigned.
+    deleting.swap(remaining);
+  }
+
+  if (inflight.isSome()) {
+    // Wait for the concurrent deletion to finish, regardless of its
+    // outcome: all the caller needs to know is that nothing is
+    // touching the path anymore.
+    const bool result = unscheduled;
+
+    return inflight.get()
+      .then([result]() { return result; })
+      .repair([result](const Future<bool>&) { return result; });
+  }
+
+  return unscheduled;
+}
+
+
 // Fires a message to self for the next event. This also cancels any
 // existing timer.
 void GarbageCollectorProcess::reset()
@@ -125,32 +203,19 @@ void GarbageCollectorProcess::reset()
 
 void GarbageCollectorProcess::remove(const Timeout& removalTime)
 {
-  // TODO(bmahler): Other dispatches can block waiting for a removal
-  // operation. To fix this, the removal operation can be done
-  // asynchronously in another thread.
   if (paths.count(removalTime) > 0) {
+    // Queue the paths: the deletions run off the gc actor, on a
+    // worker thread, so that removing a large sandbox tree does not
+    // block the other gc timers or the `schedule` and `unschedule`
+    // dispatches while it is in progress.
     foreach (const PathInfo& info, paths.get(removalTime)) {
-      LOG(INFO) << "Deleting " << info.path;
-
-      // Run rmdir with 'continueOnError = true'. It's possible for
-      // tasks and isolators to lay down files that are not deletable by
-      // GC. In the face of such errors GC needs to free up disk space
-      // wherever it can because it's already re-offered to frameworks.
-      Try<Nothing> rmdir = os::rmdir(info.path, true, true, true);
-
-      if (rmdir.isError()) {
-        LOG(WARNING) << "Failed to delete '" << info.path << "': "
-                     << rmdir.error();
-        info.promise->fail(rmdir.error());
-      } else {
-        LOG(INFO) << "Deleted '" << info.path << "'";
-        info.promise->set(rmdir.get());
-      }
-
+      deleting.push(info);
       timeouts.erase(info.path);
     }
 
     paths.remove(removalTime);
+
+    _remove();
   } else {
     // This occurs when either:
     //   1. The path(s) has already been removed (e.g. by prune()).
@@ -163,6 +228,58 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
 }
 
 
+void GarbageCollectorProcess::_remove()
+{
+  if (removing || deleting.empty()) {
+    return;
+  }
+
+  removing = true;
+
+  const PathInfo& info = deleting.front();
+
+  LOG(INFO) << "Deleting " << info.path;
+
+  // NOTE: Deletions run one at a time, so gc competes with task I/O
+  // for at most a single disk queue slot regardless of how many paths
+  // expire together.
+  async(&rmdir, info.path)
+    .onAny(defer(self(), &Self::__remove, info, lambda::_1));
+}
+
+
+void GarbageCollectorProcess::__remove(
+    const PathInfo& info,
+    const Future<Try<Nothing>>& result)
+{
+  CHECK(removing);
+  CHECK(!deleting.empty());
+  CHECK(deleting.front() == info);
+
+  deleting.pop();
+  removing = false;
+
+  // The future carries the result of `os::rmdir`; the future itself
+  // only fails or gets discarded if the gc is being torn down.
+  if (!result.isReady()) {
+    const string failure =
+      result.isFailed() ? result.failure() : "Deletion was discarded";
+
+    LOG(WARNING) << "Failed to delete '" << info.path << "': " << failure;
+    info.promise->fail(failure);
+  } else if (result.get().isError()) {
+    LOG(WARNING) << "Failed to delete '" << info.path << "': "
+                 << result.get().error();
+    info.promise->fail(result.get().error());
+  } else {
+    LOG(INFO) << "Deleted '" << info.path << "'";
+    info.promise->set(Nothing());
+  }
+
+  _remove();
+}
+
+
 void GarbageCollectorProcess::prune(const Duration& d)
 {
   foreach (const Timeout& removalTime, paths.keys()) {
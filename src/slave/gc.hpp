@@ -17,6 +17,7 @@
 #ifndef __SLAVE_GC_HPP__
 #define __SLAVE_GC_HPP__
 
+#include <queue>
 #include <string>
 #include <vector>
 
@@ -70,7 +71,10 @@ public:
   // Unschedules the specified path for removal.
   // The future will be true if the path has been unscheduled.
   // The future will be false if the path is not scheduled for
-  // removal, or the path has already being removed.
+  // removal, or the path has already being removed. If a removal of
+  // the path is currently in progress on a worker thread the future
+  // only completes once that removal has finished, so that the
+  // caller can safely reuse the path afterwards.
   // Note that you currently cannot discard a returned future.
   virtual process::Future<bool> unschedule(const std::string& path);
 
@@ -88,7 +92,8 @@ class GarbageCollectorProcess :
 {
 public:
   GarbageCollectorProcess()
-    : ProcessBase(process::ID::generate("agent-garbage-collector")) {}
+    : ProcessBase(process::ID::generate("agent-garbage-collector")),
+      removing(false) {}
 
   virtual ~GarbageCollectorProcess();
 
@@ -96,11 +101,16 @@ public:
       const Duration& d,
       const std::string& path);
 
-  bool unschedule(const std::string& path);
+  process::Future<bool> unschedule(const std::string& path);
 
   void prune(const Duration& d);
 
 private:
+  // Removes the path from 'paths' and 'timeouts' if it is scheduled
+  // there, discarding its promise; returns whether the path was
+  // found. Does not touch the 'deleting' queue.
+  bool erase(const std::string& path);
+
   void reset();
 
   void remove(const process::Timeout& removalTime);
@@ -120,6 +130,22 @@ private:
     const process::Owned<process::Promise<Nothing>> promise;
   };
 
+  // Starts deleting the next queued path on a worker thread, unless a
+  // deletion is already in progress.
+  void _remove();
+
+  // Invoked on the gc actor when a worker thread has finished
+  // deleting 'info.path'.
+  void __remove(
+      const PathInfo& info,
+      const process::Future<Try<Nothing>>& result);
+
+  // Paths queued for deletion on a worker thread, in deletion order.
+  std::queue<PathInfo> deleting;
+
+  // Whether a deletion is currently running on a worker thread.
+  bool removing;
+
   // Store all the timeouts and corresponding paths to delete.
   // NOTE: We are using Multimap here instead of Multihashmap, because
   // we need the keys of the map (deletion time) to be sorted.
@@ -168,12 +168,13 @@ struct ExecutorWriter
     });
 
     writer->field("queued_tasks", [this](JSON::ArrayWriter* writer) {
-      foreach (const TaskInfo& task, executor_->queuedTasks.values()) {
-        if (!approveViewTaskInfo(taskApprover_, task, framework_->info)) {
+      foreach (const std::shared_ptr<const TaskInfo>& task,
+               executor_->queuedTasks.values()) {
+        if (!approveViewTaskInfo(taskApprover_, *task, framework_->info)) {
           continue;
         }
 
-        writer->element(task);
+        writer->element(*task);
       }
     });
 
@@ -450,7 +451,7 @@ Future<Response> Slave::Http::executor(const Request& request) const
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::executor::Call v1Call;
+  executor::Call call;
 
   Option<string> contentType = request.headers.get("Content-Type");
   if (contentType.isNone()) {
@@ -458,10 +459,17 @@ Future<Response> Slave::Http::executor(const Request& request) const
   }
 
   if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
+    // NOTE: The unversioned `executor::Call` is wire compatible with
+    // `v1::executor::Call`, so we parse the body directly into the
+    // devolved type. This avoids the serialize/re-parse round trip
+    // that devolving would otherwise add, which matters for calls
+    // carrying large payloads (e.g., MESSAGE data).
+    if (!call.ParseFromString(request.body)) {
       return BadRequest("Failed to parse body into Call protobuf");
     }
   } else if (contentType.get() == APPLICATION_JSON) {
+    // NOTE: Unlike the protobuf encoding above, JSON is parsed
+    // against the v1 field names and then devolved.
     Try<JSON::Value> value = JSON::parse(request.body);
     if (value.isError()) {
       return BadRequest("Failed to parse body into JSON: " + value.error());
@@ -475,15 +483,13 @@ Future<Response> Slave::Http::executor(const Request& request) const
                         parse.error());
     }
 
-    v1Call = parse.get();
+    call = devolve(parse.get());
   } else {
     return UnsupportedMediaType(
         string("Expecting 'Content-Type' of ") +
         APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
   }
 
-  const executor::Call call = devolve(v1Call);
-
   Option<Error> error = validation::executor::call::validate(call);
 
   if (error.isSome()) {
@@ -1383,16 +1389,17 @@ agent::Response::GetTasks Slave::Http::_getTasks(
 
   foreach (const Framework* framework, frameworks) {
     // Pending tasks.
-    typedef hashmap<TaskID, TaskInfo> TaskMap;
+    typedef hashmap<TaskID, std::shared_ptr<const TaskInfo>> TaskMap;
     foreachvalue (const TaskMap& taskInfos, framework->pending) {
-      foreachvalue (const TaskInfo& taskInfo, taskInfos) {
+      foreachvalue (const std::shared_ptr<const TaskInfo>& taskInfo,
+                    taskInfos) {
         // Skip unauthorized tasks.
-        if (!approveViewTaskInfo(tasksApprover, taskInfo, framework->info)) {
+        if (!approveViewTaskInfo(tasksApprover, *taskInfo, framework->info)) {
           continue;
         }
 
         const Task& task =
-          protobuf::createTask(taskInfo, TASK_STAGING, framework->id());
+          protobuf::createTask(*taskInfo, TASK_STAGING, framework->id());
 
         getTasks.add_pending_tasks()->CopyFrom(task);
       }
@@ -1403,14 +1410,15 @@ agent::Response::GetTasks Slave::Http::_getTasks(
                const Framework* framework,
                executors) {
     // Queued tasks.
-    foreach (const TaskInfo& taskInfo, executor->queuedTasks.values()) {
+    foreach (const std::shared_ptr<const TaskInfo>& taskInfo,
+             executor->queuedTasks.values()) {
       // Skip unauthorized tasks.
-      if (!approveViewTaskInfo(tasksApprover, taskInfo, framework->info)) {
+      if (!approveViewTaskInfo(tasksApprover, *taskInfo, framework->info)) {
         continue;
       }
 
       const Task& task =
-        protobuf::createTask(taskInfo, TASK_STAGING, framework->id());
+        protobuf::createTask(*taskInfo, TASK_STAGING, framework->id());
 
       getTasks.add_queued_tasks()->CopyFrom(task);
     }
@@ -1762,6 +1770,16 @@ Future<Response> Slave::Http::_containers(const Request& request) const
 
 Future<JSON::Array> Slave::Http::__containers() const
 {
+  // Serve the previous result while it is fresh (see the analogous
+  // caching in `Slave::usage()`); collecting status and statistics
+  // reaches into every container.
+  if (slave->containersCache.isSome() &&
+      !slave->containersCache->isFailed() &&
+      Clock::now() - slave->containersCacheTime <
+        slave->flags.resource_monitoring_interval) {
+    return slave->containersCache.get();
+  }
+
   Owned<list<JSON::Object>> metadata(new list<JSON::Object>());
   list<Future<ContainerStatus>> statusFutures;
   list<Future<ResourceStatistics>> statsFutures;
@@ -1790,7 +1808,9 @@ Future<JSON::Array> Slave::Http::__containers() const
     }
   }
 
-  return await(await(statusFutures), await(statsFutures)).then(
+  slave->containersCacheTime = Clock::now();
+  slave->containersCache =
+    await(await(statusFutures), await(statsFutures)).then(
       [metadata](const tuple<
           Future<list<Future<ContainerStatus>>>,
           Future<list<Future<ResourceStatistics>>>>& t)
@@ -1844,6 +1864,8 @@ Future<JSON::Array> Slave::Http::__containers() const
 
         return result;
       });
+
+  return slave->containersCache.get();
 }
 
 
@@ -1903,13 +1925,16 @@ Future<Response> Slave::Http::readFile(
         UNREACHABLE();
       }
 
-      mesos::agent::Response response;
-      response.set_type(mesos::agent::Response::READ_FILE);
+      // Constructing the versioned response directly (rather than
+      // evolving an unversioned one) avoids serializing and
+      // re-parsing the file data.
+      v1::agent::Response response;
+      response.set_type(v1::agent::Response::READ_FILE);
 
       response.mutable_read_file()->set_size(std::get<0>(result.get()));
       response.mutable_read_file()->set_data(std::get<1>(result.get()));
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serialize(contentType, response),
                 stringify(contentType));
     });
 }
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdint.h>
+
 #include <list>
 #include <string>
 #include <vector>
@@ -22,6 +24,8 @@
 #include <mesos/type_utils.hpp>
 
 #include <stout/check.hpp>
+#include <stout/foreach.hpp>
+#include <stout/format.hpp>
 #include <stout/fs.hpp>
 #include <stout/nothing.hpp>
 #include <stout/os.hpp>
@@ -65,6 +69,11 @@ const char EXECUTORS_DIR[] = "executors";
 const char CONTAINERS_DIR[] = "runs";
 
 
+// The number of hashed intermediate directories that the executor
+// directories of a framework are spread across.
+static const size_t EXECUTOR_SHARDS = 256;
+
+
 Try<ExecutorRunPath> parseExecutorRunPath(
     const string& _rootDir,
     const string& dir)
@@ -83,8 +92,10 @@ Try<ExecutorRunPath> parseExecutorRunPath(
 
   vector<string> tokens = strings::tokenize(dir.substr(rootDir.size()), "/");
 
-  // A complete executor run path consists of at least 8 tokens, which
-  // includes the four named directories and the four IDs.
+  // A complete executor run path consists of at least 9 tokens, which
+  // includes the four named directories, the hashed shard directory
+  // and the four IDs. Paths laid out by agents that predate directory
+  // sharding lack the shard directory and have 8.
   if (tokens.size() < 8) {
     return Error(
         "Path after root directory is not long enough to be an "
@@ -92,6 +103,21 @@ Try<ExecutorRunPath> parseExecutorRunPath(
   }
 
   // All four named directories much match.
+  if (tokens.size() >= 9 &&
+      tokens[0] == SLAVES_DIR &&
+      tokens[2] == FRAMEWORKS_DIR &&
+      tokens[4] == EXECUTORS_DIR &&
+      tokens[7] == CONTAINERS_DIR) {
+    ExecutorRunPath path;
+
+    path.slaveId.set_value(tokens[1]);
+    path.frameworkId.set_value(tokens[3]);
+    path.executorId.set_value(tokens[6]);
+    path.containerId.set_value(tokens[8]);
+
+    return path;
+  }
+
   if (tokens[0] == SLAVES_DIR &&
       tokens[2] == FRAMEWORKS_DIR &&
       tokens[4] == EXECUTORS_DIR &&
@@ -209,10 +235,26 @@ Try<list<string>> getExecutorPaths(
   return fs::list(path::join(
       getFrameworkPath(rootDir, slaveId, frameworkId),
       EXECUTORS_DIR,
+      "*",
       "*"));
 }
 
 
+string getExecutorShard(const ExecutorID& executorId)
+{
+  // FNV-1a. We cannot use `std::hash` here because the shard of an
+  // executor must be stable across agent restarts and upgrades, which
+  // `std::hash` does not guarantee.
+  uint32_t hash = 2166136261u;
+
+  foreach (char c, executorId.value()) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+
+  return strings::format("%02x", hash % EXECUTOR_SHARDS).get();
+}
+
+
 string getExecutorPath(
     const string& rootDir,
     const SlaveID& slaveId,
@@ -222,6 +264,7 @@ string getExecutorPath(
   return path::join(
         getFrameworkPath(rootDir, slaveId, frameworkId),
         EXECUTORS_DIR,
+        getExecutorShard(executorId),
         stringify(executorId));
 }
 
@@ -492,6 +535,113 @@ string getPersistentVolumePath(
 }
 
 
+Try<Nothing> migrateExecutorDirectories(
+    const string& rootDir,
+    const SlaveID& slaveId)
+{
+  // Layouts written before executor directory sharding keep all
+  // executors of a framework directly under 'executors'; move each
+  // one into its hashed shard directory. Renames stay within the
+  // file system, so migrating the sandbox of a live executor does
+  // not invalidate its working directory, open file descriptors or
+  // any mounts underneath it.
+  Try<list<string>> frameworks = getFrameworkPaths(rootDir, slaveId);
+
+  if (frameworks.isError()) {
+    return Error("Failed to list framework directories: " +
+                 frameworks.error());
+  }
+
+  foreach (const string& framework, frameworks.get()) {
+    Try<list<string>> entries =
+      fs::list(path::join(framework, EXECUTORS_DIR, "*"));
+
+    if (entries.isError()) {
+      return Error("Failed to list executor directories under '" +
+                   framework + "': " + entries.error());
+    }
+
+    foreach (const string& entry, entries.get()) {
+      if (!os::stat::isdir(entry)) {
+        continue;
+      }
+
+      // Shard directories contain executor directories, while an
+      // executor directory contains its 'runs' (and, in the meta
+      // tree, its checkpointed 'executor.info'). Entries with
+      // neither are shard directories (or strays) and are left
+      // alone.
+      if (!os::exists(path::join(entry, CONTAINERS_DIR)) &&
+          !os::exists(path::join(entry, EXECUTOR_INFO_FILE))) {
+        continue;
+      }
+
+      ExecutorID executorId;
+      executorId.set_value(Path(entry).basename());
+
+      // The 'latest' symlink holds an absolute path into the old
+      // location, so remember which run it points to in order to
+      // re-create it after the move.
+      Option<string> latestRun;
+
+      const string link =
+        path::join(entry, CONTAINERS_DIR, LATEST_SYMLINK);
+
+      if (os::exists(link)) {
+        Result<string> resolved = os::realpath(link);
+        if (resolved.isSome()) {
+          latestRun = Path(resolved.get()).basename();
+        }
+      }
+
+      FrameworkID frameworkId;
+      frameworkId.set_value(Path(framework).basename());
+
+      const string target =
+        getExecutorPath(rootDir, slaveId, frameworkId, executorId);
+
+      Try<Nothing> mkdir = os::mkdir(Path(target).dirname());
+      if (mkdir.isError()) {
+        return Error("Failed to create shard directory for '" +
+                     target + "': " + mkdir.error());
+      }
+
+      if (os::exists(target)) {
+        return Error("Refusing to migrate '" + entry + "': '" +
+                     target + "' already exists");
+      }
+
+      Try<Nothing> rename = os::rename(entry, target);
+      if (rename.isError()) {
+        return Error("Failed to move '" + entry + "' to '" +
+                     target + "': " + rename.error());
+      }
+
+      if (latestRun.isSome()) {
+        const string latest =
+          path::join(target, CONTAINERS_DIR, LATEST_SYMLINK);
+
+        Try<Nothing> rm = os::rm(latest);
+        if (rm.isError()) {
+          return Error("Failed to remove latest symlink '" + latest +
+                       "': " + rm.error());
+        }
+
+        Try<Nothing> symlink = ::fs::symlink(
+            path::join(target, CONTAINERS_DIR, latestRun.get()), latest);
+
+        if (symlink.isError()) {
+          return Error("Failed to symlink latest run of '" + target +
+                       "': " + symlink.error());
+        }
+      }
+    }
+  }
+
+  return Nothing();
+}
+
+
 string createExecutorDirectory(
     const string& rootDir,
     const SlaveID& slaveId,
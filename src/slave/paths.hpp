@@ -22,6 +22,7 @@
 
 #include <mesos/mesos.hpp>
 
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
@@ -49,6 +50,14 @@ namespace paths {
 //
 // The file system layout is as follows:
 //
+// Executor directories are spread across hashed intermediate "shard"
+// directories (see `getExecutorShard`) so that frameworks with very
+// large numbers of executors keep the fan-out of any one directory
+// bounded; large directories slow down every directory scan during
+// recovery and garbage collection. Layouts written by agents that
+// predate sharding are migrated transparently during recovery (see
+// `migrateExecutorDirectories`).
+//
 //   root ('--work_dir' flag)
 //   |-- slaves
 //   |   |-- latest (symlink)
@@ -56,10 +65,11 @@ namespace paths {
 //   |       |-- frameworks
 //   |           |-- <framework_id>
 //   |               |-- executors
-//   |                   |-- <executor_id>
-//   |                       |-- runs
-//   |                           |-- latest (symlink)
-//   |                           |-- <container_id> (sandbox)
+//   |                   |-- <shard>
+//   |                       |-- <executor_id>
+//   |                           |-- runs
+//   |                               |-- latest (symlink)
+//   |                               |-- <container_id> (sandbox)
 //   |-- meta
 //   |   |-- boot_id
 //   |   |-- resources
@@ -74,12 +84,14 @@ namespace paths {
 //   |                   |-- framework.info
 //   |                   |-- framework.pid
 //   |                   |-- executors
-//   |                       |-- <executor_id>
-//   |                           |-- executor.info
-//   |                           |-- runs
-//   |                               |-- latest (symlink)
-//   |                               |-- <container_id> (sandbox)
+//   |                       |-- <shard>
+//   |                           |-- <executor_id>
+//   |                               |-- executor.info
+//   |                               |-- runs
+//   |                                   |-- latest (symlink)
+//   |                                   |-- <container_id> (sandbox)
 //   |                                   |-- executor.sentinel (if completed)
+//   |                                   |-- checkpoint.bundle
 //   |                                   |-- pids
 //   |                                   |   |-- forked.pid
 //   |                                   |   |-- libprocess.pid
@@ -110,6 +122,11 @@ Try<ExecutorRunPath> parseExecutorRunPath(
 
 const char LATEST_SYMLINK[] = "latest";
 
+// Name of the file within an executor run's meta directory to which
+// the run's checkpoints are additionally appended, so that recovery
+// can read them back in a single pass (see slave/state.hpp).
+const char CHECKPOINT_BUNDLE_FILE[] = "checkpoint.bundle";
+
 // Helpers for obtaining paths in the layout:
 
 std::string getMetaRootDir(const std::string& rootDir);
@@ -169,6 +186,11 @@ Try<std::list<std::string>> getExecutorPaths(
     const FrameworkID& frameworkId);
 
 
+// Returns the name of the hashed intermediate directory under
+// 'executors' that the given executor's directory lives in.
+std::string getExecutorShard(const ExecutorID& executorId);
+
+
 std::string getExecutorPath(
     const std::string& rootDir,
     const SlaveID& slaveId,
@@ -299,6 +321,14 @@ std::string getPersistentVolumePath(
     const Resource& resource);
 
 
+// Moves any executor directories laid out by an agent that predates
+// directory sharding into their hashed shard directories. Called
+// during recovery, before the executor directories are listed.
+Try<Nothing> migrateExecutorDirectories(
+    const std::string& rootDir,
+    const SlaveID& slaveId);
+
+
 std::string createExecutorDirectory(
     const std::string& rootDir,
     const SlaveID& slaveId,
@@ -66,11 +66,11 @@ public:
 
   Future<list<QoSCorrection>> corrections()
   {
-    return usage().then(defer(self(), &Self::_corrections, lambda::_1));
-  }
-
-  Future<list<QoSCorrection>> _corrections(const ResourceUsage& usage)
-  {
+    // Check the load averages before requesting resource usage: the
+    // snapshot (which contains the statistics of every executor on
+    // the agent) is only needed to locate the revocable executors
+    // once the agent is actually overloaded, so the common case does
+    // not collect usage at all.
     Try<os::Load> load = loadAverage();
     if (load.isError()) {
       LOG(ERROR) << "Failed to fetch system load: " + load.error();
@@ -95,28 +95,33 @@ public:
       }
     }
 
-    if (overloaded) {
-      list<QoSCorrection> corrections;
+    if (!overloaded) {
+      return list<QoSCorrection>();
+    }
+
+    return usage().then(defer(self(), &Self::_corrections, lambda::_1));
+  }
 
-      foreach (const ResourceUsage::Executor& executor, usage.executors()) {
-        // Set kill correction for all revocable executors.
-        if (!Resources(executor.allocated()).revocable().empty()) {
-          QoSCorrection correction;
+  Future<list<QoSCorrection>> _corrections(const ResourceUsage& usage)
+  {
+    list<QoSCorrection> corrections;
 
-          correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
-          correction.mutable_kill()->mutable_framework_id()->CopyFrom(
-            executor.executor_info().framework_id());
-          correction.mutable_kill()->mutable_executor_id()->CopyFrom(
-            executor.executor_info().executor_id());
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      // Set kill correction for all revocable executors.
+      if (!Resources(executor.allocated()).revocable().empty()) {
+        QoSCorrection correction;
 
-          corrections.push_back(correction);
-        }
-      }
+        correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
+        correction.mutable_kill()->mutable_framework_id()->CopyFrom(
+          executor.executor_info().framework_id());
+        correction.mutable_kill()->mutable_executor_id()->CopyFrom(
+          executor.executor_info().executor_id());
 
-      return corrections;
+        corrections.push_back(correction);
+      }
     }
 
-    return list<QoSCorrection>();
+    return corrections;
   }
 
 private:
@@ -27,6 +27,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/type_utils.hpp>
@@ -115,6 +116,7 @@ using std::list;
 using std::map;
 using std::ostringstream;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::tuple;
 using std::vector;
@@ -125,6 +127,7 @@ using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
+using process::Promise;
 using process::Time;
 using process::UPID;
 
@@ -568,6 +571,9 @@ void Slave::initialize()
       &SlaveReregisteredMessage::reconciliations,
       &SlaveReregisteredMessage::connection);
 
+  install<ReregisterSlaveFullStateMessage>(
+      &Slave::fullStateRequested);
+
   install<RunTaskMessage>(
       &Slave::runTask,
       &RunTaskMessage::framework,
@@ -616,6 +622,9 @@ void Slave::initialize()
       &StatusUpdateAcknowledgementMessage::task_id,
       &StatusUpdateAcknowledgementMessage::uuid);
 
+  install<StatusUpdateAcknowledgementsMessage>(
+      &Slave::statusUpdateAcknowledgements);
+
   install<RegisterExecutorMessage>(
       &Slave::registerExecutor,
       &RegisterExecutorMessage::framework_id,
@@ -648,6 +657,16 @@ void Slave::initialize()
       &Slave::ping,
       &PingSlaveMessage::connected);
 
+  install<AuthenticationTokenMessage>(
+      &Slave::cacheAuthenticationToken,
+      &AuthenticationTokenMessage::token);
+
+  install<AuthenticationCompletedMessage>(
+      &Slave::authenticationCompleted);
+
+  install<AuthenticationFailedMessage>(
+      &Slave::authenticationFailed);
+
 
   route("/api/v1",
         // TODO(benh): Is this authentication realm sufficient or do
@@ -910,7 +929,16 @@ void Slave::detected(const Future<Option<MasterInfo>>& _master)
     master = None();
   } else {
     latest = _master.get();
-    master = UPID(_master.get().get().pid());
+
+    UPID pid = UPID(_master.get().get().pid());
+
+    // An authentication token is only honored by the master that
+    // issued it.
+    if (master != pid) {
+      authenticationToken = None();
+    }
+
+    master = pid;
 
     LOG(INFO) << "New master detected at " << master.get();
 
@@ -977,6 +1005,38 @@ void Slave::authenticate()
   // communicating with it.
   link(master.get());
 
+  if (authenticationToken.isSome()) {
+    // Present the token from our previous successful authentication
+    // rather than running the SASL exchange. The master replies with
+    // AuthenticationCompletedMessage if the token is still valid and
+    // AuthenticationFailedMessage otherwise, in which case we retry
+    // with the full exchange.
+    LOG(INFO) << "Presenting authentication token to master " << master.get();
+
+    AuthenticateMessage message;
+    message.set_pid(self());
+    message.set_token(authenticationToken.get());
+    send(master.get(), message);
+
+    tokenAuthentication.reset(new Promise<bool>());
+
+    authenticating = tokenAuthentication->future()
+      .onAny(defer(self(), &Self::_authenticate));
+
+    // Propagate a discard (e.g., from the authentication timeout
+    // below) into the promise so that '_authenticate' retries.
+    tokenAuthentication->future()
+      .onDiscard(defer(self(), &Self::tokenAuthenticationDiscarded));
+
+    delay(
+        Seconds(5),
+        self(),
+        &Self::authenticationTimeout,
+        authenticating.get());
+
+    return;
+  }
+
   CHECK(authenticatee == nullptr);
 
 #ifdef HAS_AUTHENTICATION
@@ -1011,8 +1071,15 @@ void Slave::authenticate()
 
 void Slave::_authenticate()
 {
-  delete CHECK_NOTNULL(authenticatee);
-  authenticatee = nullptr;
+  // Depending on whether this was a token authentication or a full
+  // SASL exchange, exactly one of these is in use.
+  if (authenticatee != nullptr) {
+    delete authenticatee;
+    authenticatee = nullptr;
+  } else {
+    CHECK_NOTNULL(tokenAuthentication.get());
+    tokenAuthentication.reset();
+  }
 
   CHECK_SOME(authenticating);
   const Future<bool>& future = authenticating.get();
@@ -1090,6 +1157,61 @@ void Slave::authenticationTimeout(Future<bool> future)
 }
 
 
+void Slave::authenticationCompleted(const UPID& from)
+{
+  if (master != from) {
+    LOG(WARNING) << "Ignoring authentication completed message from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  if (tokenAuthentication.get() != nullptr) {
+    tokenAuthentication->set(true);
+  }
+}
+
+
+void Slave::authenticationFailed(const UPID& from)
+{
+  if (master != from) {
+    LOG(WARNING) << "Ignoring authentication failed message from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  if (tokenAuthentication.get() != nullptr) {
+    // The token was rejected (e.g., it expired or the master failed
+    // over); drop it so that the retry performs the full SASL
+    // exchange.
+    authenticationToken = None();
+    tokenAuthentication->fail("Authentication token rejected by master");
+  }
+}
+
+
+void Slave::cacheAuthenticationToken(const UPID& from, const string& token)
+{
+  if (master != from) {
+    LOG(WARNING) << "Ignoring authentication token from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  authenticationToken = token;
+}
+
+
+void Slave::tokenAuthenticationDiscarded()
+{
+  if (tokenAuthentication.get() != nullptr) {
+    tokenAuthentication->discard();
+  }
+}
+
+
 void Slave::registered(
     const UPID& from,
     const SlaveID& slaveId,
@@ -1110,6 +1232,15 @@ void Slave::registered(
     masterPingTimeout = DEFAULT_MASTER_PING_TIMEOUT();
   }
 
+  // Remember whether this master supports the delta re-registration
+  // handshake; it now holds our full state. See
+  // `ReregisterSlaveMessage.state_fingerprint`.
+  if (connection.delta_reregistration()) {
+    deltaReregistrationMaster = master;
+  } else {
+    deltaReregistrationMaster = None();
+  }
+
   switch (state) {
     case DISCONNECTED: {
       LOG(INFO) << "Registered with master " << master.get()
@@ -1212,6 +1343,15 @@ void Slave::reregistered(
     masterPingTimeout = DEFAULT_MASTER_PING_TIMEOUT();
   }
 
+  // Remember whether this master supports the delta re-registration
+  // handshake; it now holds our full state. See
+  // `ReregisterSlaveMessage.state_fingerprint`.
+  if (connection.delta_reregistration()) {
+    deltaReregistrationMaster = master;
+  } else {
+    deltaReregistrationMaster = None();
+  }
+
   switch (state) {
     case DISCONNECTED:
       LOG(INFO) << "Re-registered with master " << master.get();
@@ -1326,6 +1466,31 @@ void Slave::reregistered(
 }
 
 
+void Slave::fullStateRequested(const UPID& from)
+{
+  if (master != from) {
+    LOG(WARNING) << "Ignoring full state request from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  LOG(INFO) << "Master " << master.get() << " requested a re-registration"
+            << " with full state";
+
+  // The master could not match our delta re-registration against its
+  // own state (e.g., it already removed us or our views diverged
+  // while we were disconnected), so fall back to full
+  // re-registrations until it acknowledges one.
+  deltaReregistrationMaster = None();
+
+  // Re-register right away rather than waiting for the next backoff
+  // retry. Note that this is a no-op unless we are still
+  // disconnected.
+  doReliableRegistration(flags.registration_backoff_factor * 2);
+}
+
+
 void Slave::doReliableRegistration(Duration maxBackoff)
 {
   if (master.isNone()) {
@@ -1362,16 +1527,79 @@ void Slave::doReliableRegistration(Duration maxBackoff)
     // Registering for the first time.
     RegisterSlaveMessage message;
     message.set_version(MESOS_VERSION);
+    message.set_batched_acknowledgements(true);
     message.mutable_slave()->CopyFrom(info);
 
     // Include checkpointed resources.
     message.mutable_checkpointed_resources()->CopyFrom(checkpointedResources);
 
+    send(master.get(), message);
+  } else if (deltaReregistrationMaster.isSome() &&
+             deltaReregistrationMaster == master) {
+    // Re-registering with a master that already holds our full task
+    // and executor state, so we only send a fingerprint of the state
+    // a full message would carry. If the master's view diverged from
+    // ours while we were disconnected, it will ask for the full
+    // state via `ReregisterSlaveFullStateMessage`.
+    ReregisterSlaveMessage message;
+    message.set_version(MESOS_VERSION);
+    message.set_batched_acknowledgements(true);
+
+    // Include checkpointed resources.
+    message.mutable_checkpointed_resources()->CopyFrom(checkpointedResources);
+
+    message.mutable_slave()->CopyFrom(info);
+
+    // NOTE: The identifiers collected here must stay in sync with
+    // the tasks and executors a full re-registration (below) would
+    // include in the message.
+    std::vector<std::pair<std::string, std::string>> taskIds;
+    std::vector<std::pair<std::string, std::string>> executorIds;
+
+    foreachvalue (Framework* framework, frameworks) {
+      typedef hashmap<TaskID, shared_ptr<const TaskInfo>> TaskMap;
+      foreachvalue (const TaskMap& tasks, framework->pending) {
+        foreachkey (const TaskID& taskId, tasks) {
+          taskIds.push_back(
+              std::make_pair(framework->id().value(), taskId.value()));
+        }
+      }
+
+      foreachvalue (Executor* executor, framework->executors) {
+        foreach (const TaskID& taskId, executor->launchedTasks.keys()) {
+          taskIds.push_back(
+              std::make_pair(framework->id().value(), taskId.value()));
+        }
+
+        foreach (const TaskID& taskId, executor->terminatedTasks.keys()) {
+          taskIds.push_back(
+              std::make_pair(framework->id().value(), taskId.value()));
+        }
+
+        foreach (const TaskID& taskId, executor->queuedTasks.keys()) {
+          taskIds.push_back(
+              std::make_pair(framework->id().value(), taskId.value()));
+        }
+
+        // The master doesn't store command executors or terminated
+        // executors, so they are not part of the fingerprint.
+        if (!executor->isCommandExecutor() &&
+            executor->state != Executor::TERMINATED) {
+          executorIds.push_back(
+              std::make_pair(framework->id().value(), executor->id.value()));
+        }
+      }
+    }
+
+    message.set_state_fingerprint(protobuf::getStateFingerprint(
+        std::move(taskIds), std::move(executorIds)));
+
     send(master.get(), message);
   } else {
     // Re-registering, so send tasks running.
     ReregisterSlaveMessage message;
     message.set_version(MESOS_VERSION);
+    message.set_batched_acknowledgements(true);
 
     // Include checkpointed resources.
     message.mutable_checkpointed_resources()->CopyFrom(checkpointedResources);
@@ -1384,11 +1612,11 @@ void Slave::doReliableRegistration(Duration maxBackoff)
       // TODO(bmahler): We need to send the executors for these
       // pending tasks, and we need to send exited events if they
       // cannot be launched, see MESOS-1715, MESOS-1720, MESOS-1800.
-      typedef hashmap<TaskID, TaskInfo> TaskMap;
+      typedef hashmap<TaskID, shared_ptr<const TaskInfo>> TaskMap;
       foreachvalue (const TaskMap& tasks, framework->pending) {
-        foreachvalue (const TaskInfo& task, tasks) {
+        foreachvalue (const shared_ptr<const TaskInfo>& task, tasks) {
           message.add_tasks()->CopyFrom(protobuf::createTask(
-              task, TASK_STAGING, framework->id()));
+              *task, TASK_STAGING, framework->id()));
         }
       }
 
@@ -1406,9 +1634,10 @@ void Slave::doReliableRegistration(Duration maxBackoff)
           message.add_tasks()->CopyFrom(*task);
         }
 
-        foreach (const TaskInfo& task, executor->queuedTasks.values()) {
+        foreach (const shared_ptr<const TaskInfo>& task,
+                 executor->queuedTasks.values()) {
           message.add_tasks()->CopyFrom(protobuf::createTask(
-              task, TASK_STAGING, framework->id()));
+              *task, TASK_STAGING, framework->id()));
         }
 
         // Do not re-register with Command Executors because the
@@ -1650,7 +1879,8 @@ void Slave::run(
   // are not scheduled for deletion before '_run()' is called.
   CHECK_NOTNULL(framework);
   foreach (const TaskInfo& task, tasks) {
-    framework->pending[executorId][task.task_id()] = task;
+    framework->pending[executorId][task.task_id()] =
+      std::make_shared<const TaskInfo>(task);
   }
 
   // If we are about to create a new executor, unschedule the top
@@ -1695,12 +1925,15 @@ void Slave::_run(
   CHECK_NE(task.isSome(), taskGroup.isSome())
     << "Either task or task group should be set but not both";
 
-  vector<TaskInfo> tasks;
+  // One shared immutable copy of each task: the queued task
+  // bookkeeping below references these handles rather than storing
+  // further copies of the TaskInfos.
+  vector<shared_ptr<const TaskInfo>> tasks;
   if (task.isSome()) {
-    tasks.push_back(task.get());
+    tasks.push_back(std::make_shared<const TaskInfo>(task.get()));
   } else {
     foreach (const TaskInfo& task, taskGroup->tasks()) {
-      tasks.push_back(task);
+      tasks.push_back(std::make_shared<const TaskInfo>(task));
     }
   }
 
@@ -1723,10 +1956,10 @@ void Slave::_run(
   // tasks in the task group have been killed in the interim, we
   // send a TASK_KILLED for all the other tasks in the group.
   bool killed = false;
-  foreach (const TaskInfo& task, tasks) {
+  foreach (const shared_ptr<const TaskInfo>& task, tasks) {
     if (framework->pending.contains(executorId) &&
-        framework->pending[executorId].contains(task.task_id())) {
-      framework->pending[executorId].erase(task.task_id());
+        framework->pending[executorId].contains(task->task_id())) {
+      framework->pending[executorId].erase(task->task_id());
       if (framework->pending[executorId].empty()) {
         framework->pending.erase(executorId);
         // NOTE: Ideally we would perform the following check here:
@@ -1750,11 +1983,11 @@ void Slave::_run(
                  << " of framework " << frameworkId
                  << " because it has been killed in the meantime";
 
-    foreach (const TaskInfo& task, tasks) {
+    foreach (const shared_ptr<const TaskInfo>& task, tasks) {
       const StatusUpdate update = protobuf::createStatusUpdate(
           frameworkId,
           info.id(),
-          task.task_id(),
+          task->task_id(),
           TASK_KILLED,
           TaskStatus::SOURCE_SLAVE,
           UUID::random(),
@@ -1800,11 +2033,11 @@ void Slave::_run(
       taskState = TASK_LOST;
     }
 
-    foreach (const TaskInfo& task, tasks) {
+    foreach (const shared_ptr<const TaskInfo>& task, tasks) {
       const StatusUpdate update = protobuf::createStatusUpdate(
           frameworkId,
           info.id(),
-          task.task_id(),
+          task->task_id(),
           taskState,
           TaskStatus::SOURCE_SLAVE,
           UUID::random(),
@@ -1836,14 +2069,14 @@ void Slave::_run(
   // may succeed in the event that CheckpointResourcesMessage arrives
   // out of order.
   bool kill = false;
-  foreach (const TaskInfo& task, tasks) {
+  foreach (const shared_ptr<const TaskInfo>& task, tasks) {
     Resources checkpointedTaskResources =
-      Resources(task.resources()).filter(needCheckpointing);
+      Resources(task->resources()).filter(needCheckpointing);
 
     foreach (const Resource& resource, checkpointedTaskResources) {
       if (!checkpointedResources.contains(resource)) {
         LOG(WARNING) << "Unknown checkpointed resource " << resource
-                     << " for task " << task
+                     << " for task " << *task
                      << " of framework " << frameworkId;
 
         kill = true;
@@ -1862,11 +2095,11 @@ void Slave::_run(
       taskState = TASK_LOST;
     }
 
-    foreach (const TaskInfo& task, tasks) {
+    foreach (const shared_ptr<const TaskInfo>& task, tasks) {
       const StatusUpdate update = protobuf::createStatusUpdate(
           frameworkId,
           info.id(),
-          task.task_id(),
+          task->task_id(),
           taskState,
           TaskStatus::SOURCE_SLAVE,
           UUID::random(),
@@ -1911,11 +2144,11 @@ void Slave::_run(
       taskState = TASK_LOST;
     }
 
-    foreach (const TaskInfo& task, tasks) {
+    foreach (const shared_ptr<const TaskInfo>& task, tasks) {
       const StatusUpdate update = protobuf::createStatusUpdate(
           frameworkId,
           info.id(),
-          task.task_id(),
+          task->task_id(),
           taskState,
           TaskStatus::SOURCE_SLAVE,
           UUID::random(),
@@ -1996,11 +2229,11 @@ void Slave::_run(
         taskState = TASK_LOST;
       }
 
-      foreach (const TaskInfo& task, tasks) {
+      foreach (const shared_ptr<const TaskInfo>& task, tasks) {
         const StatusUpdate update = protobuf::createStatusUpdate(
             frameworkId,
             info.id(),
-            task.task_id(),
+            task->task_id(),
             taskState,
             TaskStatus::SOURCE_SLAVE,
             UUID::random(),
@@ -2013,14 +2246,14 @@ void Slave::_run(
       break;
     }
     case Executor::REGISTERING:
-      foreach (const TaskInfo& task, tasks) {
+      foreach (const shared_ptr<const TaskInfo>& task, tasks) {
         // Checkpoint the task before we do anything else.
         if (executor->checkpoint) {
-          executor->checkpointTask(task);
+          executor->checkpointTask(*task);
         }
 
         // Queue task if the executor has not yet registered.
-        executor->queuedTasks[task.task_id()] = task;
+        executor->queuedTasks[task->task_id()] = task;
       }
 
       if (taskGroup.isSome()) {
@@ -2033,15 +2266,15 @@ void Slave::_run(
 
       break;
     case Executor::RUNNING: {
-      foreach (const TaskInfo& task, tasks) {
+      foreach (const shared_ptr<const TaskInfo>& task, tasks) {
         // Checkpoint the task before we do anything else.
         if (executor->checkpoint) {
-          executor->checkpointTask(task);
+          executor->checkpointTask(*task);
         }
 
         // Queue task until the containerizer is updated with new
         // resource limits (MESOS-998).
-        executor->queuedTasks[task.task_id()] = task;
+        executor->queuedTasks[task->task_id()] = task;
       }
 
       if (taskGroup.isSome()) {
@@ -2053,29 +2286,30 @@ void Slave::_run(
       LOG(INFO) << "Queued " << taskOrTaskGroup(task, taskGroup)
                 << " for executor " << *executor;
 
-      // Update the resource limits for the container. Note that the
-      // resource limits include the currently queued tasks because we
-      // want the container to have enough resources to hold the
-      // upcoming tasks.
-      Resources resources = executor->resources;
+      // If a containerizer update is already in flight, park this
+      // launch on it: it is folded into a single follow-up update
+      // when the current one completes, so a burst of launches on the
+      // same executor results in one update per batch rather than one
+      // per task.
+      if (executor->updating) {
+        if (task.isSome()) {
+          executor->deferredTasks.push_back(tasks.front());
+        }
 
-      // TODO(jieyu): Use foreachvalue instead once LinkedHashmap
-      // supports it.
-      foreach (const TaskInfo& task, executor->queuedTasks.values()) {
-        resources += task.resources();
+        if (taskGroup.isSome()) {
+          executor->deferredTaskGroups.push_back(taskGroup.get());
+        }
+
+        break;
       }
 
-      containerizer->update(executor->containerId, resources)
-        .onAny(defer(self(),
-                     &Self::__run,
-                     lambda::_1,
-                     frameworkId,
-                     executorId,
-                     executor->containerId,
-                     task.isSome() ? list<TaskInfo>({task.get()})
-                                   : list<TaskInfo>(),
-                     taskGroup.isSome() ? list<TaskGroupInfo>({taskGroup.get()})
-                                        : list<TaskGroupInfo>()));
+      updateExecutor(
+          framework,
+          executor,
+          task.isSome() ? list<shared_ptr<const TaskInfo>>({tasks.front()})
+                        : list<shared_ptr<const TaskInfo>>(),
+          taskGroup.isSome() ? list<TaskGroupInfo>({taskGroup.get()})
+                             : list<TaskGroupInfo>());
 
       break;
     }
@@ -2092,12 +2326,47 @@ void Slave::_run(
 }
 
 
+void Slave::updateExecutor(
+    Framework* framework,
+    Executor* executor,
+    const list<shared_ptr<const TaskInfo>>& tasks,
+    const list<TaskGroupInfo>& taskGroups)
+{
+  CHECK(!executor->updating);
+
+  executor->updating = true;
+
+  // Update the resource limits for the container. Note that the
+  // resource limits include the currently queued tasks because we
+  // want the container to have enough resources to hold the
+  // upcoming tasks.
+  Resources resources = executor->resources;
+
+  // TODO(jieyu): Use foreachvalue instead once LinkedHashmap
+  // supports it.
+  foreach (const shared_ptr<const TaskInfo>& task,
+           executor->queuedTasks.values()) {
+    resources += task->resources();
+  }
+
+  containerizer->update(executor->containerId, resources)
+    .onAny(defer(self(),
+                 &Self::__run,
+                 lambda::_1,
+                 framework->id(),
+                 executor->id,
+                 executor->containerId,
+                 tasks,
+                 taskGroups));
+}
+
+
 void Slave::__run(
     const Future<Nothing>& future,
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
     const ContainerID& containerId,
-    const list<TaskInfo>& tasks,
+    const list<shared_ptr<const TaskInfo>>& tasks,
     const list<TaskGroupInfo>& taskGroups)
 {
   if (!future.isReady()) {
@@ -2111,6 +2380,12 @@ void Slave::__run(
 
     Executor* executor = getExecutor(frameworkId, executorId);
     if (executor != nullptr) {
+      // The container is being destroyed, so drop any launches parked
+      // on this update; their tasks are handled by 'executorTerminated'.
+      executor->updating = false;
+      executor->deferredTasks.clear();
+      executor->deferredTaskGroups.clear();
+
       Framework* framework = getFramework(frameworkId);
       CHECK_NOTNULL(framework);
 
@@ -2143,8 +2418,8 @@ void Slave::__run(
     ostringstream out;
     if (!tasks.empty()) {
       vector<TaskID> taskIds;
-      foreach (const TaskInfo& task, tasks) {
-        taskIds.push_back(task.task_id());
+      foreach (const shared_ptr<const TaskInfo>& task, tasks) {
+        taskIds.push_back(task->task_id());
       }
       out << "tasks " << stringify(taskIds);
     }
@@ -2229,33 +2504,44 @@ void Slave::__run(
     return;
   }
 
-  foreach (const TaskInfo& task, tasks) {
+  // Batch the queued tasks and deliver them with a single send below:
+  // an executor that registers with hundreds of queued tasks then
+  // receives them in one write on its connection, rather than paying
+  // for a write per task.
+  vector<RunTaskMessage> messages;
+  messages.reserve(tasks.size());
+
+  foreach (const shared_ptr<const TaskInfo>& task, tasks) {
     // This is the case where the task is killed. No need to send
     // status update because it should be handled in 'killTask'.
-    if (!executor->queuedTasks.contains(task.task_id())) {
-      LOG(WARNING) << "Ignoring sending queued task '" << task.task_id()
+    if (!executor->queuedTasks.contains(task->task_id())) {
+      LOG(WARNING) << "Ignoring sending queued task '" << task->task_id()
                    << "' to executor " << *executor
                    << " because the task has been killed";
       continue;
     }
 
-    executor->queuedTasks.erase(task.task_id());
+    executor->queuedTasks.erase(task->task_id());
 
-    // Add the task and send it to the executor.
-    executor->addTask(task);
+    // Add the task and queue it for the executor.
+    executor->addTask(*task);
 
-    LOG(INFO) << "Sending queued task '" << task.task_id()
+    LOG(INFO) << "Sending queued task '" << task->task_id()
               << "' to executor " << *executor;
 
-    RunTaskMessage message;
+    messages.push_back(RunTaskMessage());
+
+    RunTaskMessage& message = messages.back();
     message.mutable_framework()->MergeFrom(framework->info);
-    message.mutable_task()->MergeFrom(task);
+    message.mutable_task()->MergeFrom(*task);
 
     // Note that 0.23.x executors require the 'pid' to be set
     // to decode the message, but do not use the field.
     message.set_pid(framework->pid.getOrElse(UPID()));
+  }
 
-    executor->send(message);
+  if (!messages.empty()) {
+    executor->send(messages);
   }
 
   foreach (const TaskGroupInfo& taskGroup, taskGroups) {
@@ -2294,6 +2580,21 @@ void Slave::__run(
 
     executor->send(event);
   }
+
+  executor->updating = false;
+
+  // Flush any launches that arrived while this update was in flight
+  // with a single follow-up update.
+  if (!executor->deferredTasks.empty() ||
+      !executor->deferredTaskGroups.empty()) {
+    list<shared_ptr<const TaskInfo>> deferredTasks;
+    deferredTasks.swap(executor->deferredTasks);
+
+    list<TaskGroupInfo> deferredTaskGroups;
+    deferredTaskGroups.swap(executor->deferredTaskGroups);
+
+    updateExecutor(framework, executor, deferredTasks, deferredTaskGroups);
+  }
 }
 
 
@@ -3004,6 +3305,22 @@ void Slave::statusUpdateAcknowledgement(
 }
 
 
+void Slave::statusUpdateAcknowledgements(
+    const UPID& from,
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           message.acknowledgements()) {
+    statusUpdateAcknowledgement(
+        from,
+        acknowledgement.slave_id(),
+        acknowledgement.framework_id(),
+        acknowledgement.task_id(),
+        acknowledgement.uuid());
+  }
+}
+
+
 void Slave::_statusUpdateAcknowledgement(
     const Future<bool>& future,
     const TaskID& taskId,
@@ -3199,22 +3516,10 @@ void Slave::subscribe(
             None());
       }
 
-      // Update the resource limits for the container. Note that the
-      // resource limits include the currently queued tasks because we
-      // want the container to have enough resources to hold the
-      // upcoming tasks.
-      Resources resources = executor->resources;
-
-      // TODO(jieyu): Use foreachvalue instead once LinkedHashmap
-      // supports it.
-      foreach (const TaskInfo& task, executor->queuedTasks.values()) {
-        resources += task.resources();
-      }
-
       // We maintain a copy of the tasks in `queuedTaskGroups` also in
       // `queuedTasks`. Hence, we need to ensure that we don't send the same
       // tasks to the executor twice.
-      LinkedHashMap<TaskID, TaskInfo> queuedTasks;
+      LinkedHashMap<TaskID, shared_ptr<const TaskInfo>> queuedTasks;
       foreach (const TaskID& taskId, executor->queuedTasks.keys()) {
         queuedTasks[taskId] = executor->queuedTasks[taskId];
       }
@@ -3228,15 +3533,11 @@ void Slave::subscribe(
         }
       }
 
-      containerizer->update(executor->containerId, resources)
-        .onAny(defer(self(),
-                     &Self::__run,
-                     lambda::_1,
-                     framework->id(),
-                     executor->id,
-                     executor->containerId,
-                     queuedTasks.values(),
-                     executor->queuedTaskGroups));
+      updateExecutor(
+          framework,
+          executor,
+          queuedTasks.values(),
+          executor->queuedTaskGroups);
 
       hashmap<TaskID, TaskInfo> unackedTasks;
       foreach (const TaskInfo& task, subscribe.unacknowledged_tasks()) {
@@ -3390,7 +3691,15 @@ void Slave::registerExecutor(
 
         VLOG(1) << "Checkpointing executor pid '"
                 << executor->pid.get() << "' to '" << path << "'";
-        CHECK_SOME(state::checkpoint(path, executor->pid.get()));
+        CHECK_SOME(state::checkpoint(
+            path,
+            executor->pid.get(),
+            paths::getExecutorRunPath(
+                metaDir,
+                info.id(),
+                executor->frameworkId,
+                executor->id,
+                executor->containerId)));
       }
 
       // Here, we kill the executor if it no longer has any task to run
@@ -3424,22 +3733,10 @@ void Slave::registerExecutor(
       message.mutable_slave_info()->MergeFrom(info);
       executor->send(message);
 
-      // Update the resource limits for the container. Note that the
-      // resource limits include the currently queued tasks because we
-      // want the container to have enough resources to hold the
-      // upcoming tasks.
-      Resources resources = executor->resources;
-
-      // TODO(jieyu): Use foreachvalue instead once LinkedHashmap
-      // supports it.
-      foreach (const TaskInfo& task, executor->queuedTasks.values()) {
-        resources += task.resources();
-      }
-
       // We maintain a copy of the tasks in `queuedTaskGroups` also in
       // `queuedTasks`. Hence, we need to ensure that we don't send the same
       // tasks to the executor twice.
-      LinkedHashMap<TaskID, TaskInfo> queuedTasks;
+      LinkedHashMap<TaskID, shared_ptr<const TaskInfo>> queuedTasks;
       foreach (const TaskID& taskId, executor->queuedTasks.keys()) {
         queuedTasks[taskId] = executor->queuedTasks[taskId];
       }
@@ -3453,15 +3750,11 @@ void Slave::registerExecutor(
         }
       }
 
-      containerizer->update(executor->containerId, resources)
-        .onAny(defer(self(),
-                     &Self::__run,
-                     lambda::_1,
-                     frameworkId,
-                     executorId,
-                     executor->containerId,
-                     queuedTasks.values(),
-                     executor->queuedTaskGroups));
+      updateExecutor(
+          framework,
+          executor,
+          queuedTasks.values(),
+          executor->queuedTaskGroups);
 
       break;
     }
@@ -3737,8 +4030,21 @@ void Slave::reregisterExecutorTimeout()
 // acknowledgement for it.
 void Slave::statusUpdate(StatusUpdate update, const Option<UPID>& pid)
 {
-  LOG(INFO) << "Handling status update " << update
+  // Logging every status update gets expensive for agents running
+  // high churn frameworks, so we periodically log one along with the
+  // number of updates elided and keep the per-update line at a higher
+  // verbosity level.
+  static logging::Throttle statusUpdateThrottle(Seconds(1));
+
+  if (statusUpdateThrottle.permit()) {
+    LOG(INFO) << "Handling status update " << update
+              << (pid.isSome() ? " from " + stringify(pid.get()) : "")
+              << " (" << statusUpdateThrottle.suppressed()
+              << " updates since last logged)";
+  } else {
+    VLOG(1) << "Handling status update " << update
             << (pid.isSome() ? " from " + stringify(pid.get()) : "");
+  }
 
   CHECK(state == RECOVERING || state == DISCONNECTED ||
         state == RUNNING || state == TERMINATING)
@@ -3896,7 +4202,23 @@ void Slave::statusUpdate(StatusUpdate update, const Option<UPID>& pid)
   metrics.valid_status_updates++;
 
   // Before sending update, we need to retrieve the container status.
-  containerizer->status(executor->containerId)
+  //
+  // A burst of updates from the same executor (e.g., its tasks being
+  // bulk-killed during a maintenance drain) shares a single in-flight
+  // containerizer query instead of issuing one query per task.
+  if (!containerStatuses.contains(executor->containerId)) {
+    const ContainerID containerId = executor->containerId;
+
+    containerStatuses[containerId] = containerizer->status(containerId);
+
+    containerStatuses[containerId]
+      .onAny(defer(self(), [this, containerId](
+          const Future<ContainerStatus>&) {
+        containerStatuses.erase(containerId);
+      }));
+  }
+
+  containerStatuses[executor->containerId]
     .onAny(defer(self(),
                  &Slave::_statusUpdate,
                  update,
@@ -4166,7 +4488,17 @@ void Slave::forward(StatusUpdate update)
   }
 
   CHECK_SOME(master);
-  LOG(INFO) << "Forwarding the update " << update << " to " << master.get();
+
+  // See the rationale at the similar throttle in `statusUpdate()`.
+  static logging::Throttle forwardThrottle(Seconds(1));
+
+  if (forwardThrottle.permit()) {
+    LOG(INFO) << "Forwarding the update " << update << " to " << master.get()
+              << " (" << forwardThrottle.suppressed()
+              << " updates since last logged)";
+  } else {
+    VLOG(1) << "Forwarding the update " << update << " to " << master.get();
+  }
 
   // NOTE: We forward the update even if framework/executor/task
   // doesn't exist because the status update manager will be expecting
@@ -4713,9 +5045,10 @@ void Slave::executorTerminated(
         // Transition all queued tasks.
         // TODO(vinod): Use foreachvalue instead once LinkedHashmap
         // supports it.
-        foreach (const TaskInfo& task, executor->queuedTasks.values()) {
+        foreach (const shared_ptr<const TaskInfo>& task,
+                 executor->queuedTasks.values()) {
           sendExecutorTerminatedStatusUpdate(
-              task.task_id(), termination, frameworkId, executor);
+              task->task_id(), termination, frameworkId, executor);
         }
       }
 
@@ -5293,6 +5626,19 @@ Future<Nothing> Slave::recover(const Result<state::State>& state)
       return Failure(recovered.error());
     }
 
+    // Move any sandbox directories laid out by an agent that predates
+    // the sharded 'executors' layout into their shard directories.
+    // The meta tree was migrated during state recovery; this covers
+    // the sandboxes in the work directory.
+    Try<Nothing> migrated = paths::migrateExecutorDirectories(
+        flags.work_dir, slaveState.get().id);
+
+    if (migrated.isError()) {
+      return Failure(
+          "Failed to migrate executor sandbox directories: " +
+          migrated.error());
+    }
+
     // Recover the frameworks.
     foreachvalue (const FrameworkState& frameworkState,
                   slaveState.get().frameworks) {
@@ -5785,6 +6131,15 @@ void Slave::_qosCorrections(const Future<list<QoSCorrection>>& future)
 
 Future<ResourceUsage> Slave::usage()
 {
+  // Serve the previous sample while it is fresh: monitoring clients
+  // poll frequently (often every few seconds, per client) and every
+  // sample reads the statistics of all containers.
+  if (usageCache.isSome() &&
+      !usageCache->isFailed() &&
+      Clock::now() - usageCacheTime < flags.resource_monitoring_interval) {
+    return usageCache.get();
+  }
+
   // NOTE: We use 'Owned' here trying to avoid the expensive copy.
   // C++11 lambda only supports capturing variables that have copy
   // constructors. Revisit once we remove the copy constructor for
@@ -5823,7 +6178,8 @@ Future<ResourceUsage> Slave::usage()
 
   usage->mutable_total()->CopyFrom(totalResources);
 
-  return await(futures).then(
+  usageCacheTime = Clock::now();
+  usageCache = await(futures).then(
       [usage](const list<Future<ResourceStatistics>>& futures) {
         // NOTE: We add ResourceUsage::Executor to 'usage' the same
         // order as we push future to 'futures'. So the variables
@@ -5848,6 +6204,8 @@ Future<ResourceUsage> Slave::usage()
 
         return Future<ResourceUsage>(*usage);
       });
+
+  return usageCache.get();
 }
 
 
@@ -5856,7 +6214,7 @@ double Slave::_tasks_staging()
 {
   double count = 0.0;
   foreachvalue (Framework* framework, frameworks) {
-    typedef hashmap<TaskID, TaskInfo> TaskMap;
+    typedef hashmap<TaskID, shared_ptr<const TaskInfo>> TaskMap;
     foreachvalue (const TaskMap& tasks, framework->pending) {
       count += tasks.size();
     }
@@ -6625,6 +6983,7 @@ Executor::Executor(
     http(None()),
     pid(None()),
     resources(_info.resources()),
+    updating(false),
     completedTasks(MAX_COMPLETED_TASKS_PER_EXECUTOR)
 {
   CHECK_NOTNULL(slave);
@@ -6721,7 +7080,15 @@ void Executor::checkpointTask(const TaskInfo& task)
       t.task_id());
 
   VLOG(1) << "Checkpointing TaskInfo to '" << path << "'";
-  CHECK_SOME(state::checkpoint(path, t));
+  CHECK_SOME(state::checkpoint(
+      path,
+      t,
+      paths::getExecutorRunPath(
+          slave->metaDir,
+          slave->info.id(),
+          frameworkId,
+          id,
+          containerId)));
 }
 
 
@@ -6820,7 +7187,7 @@ Try<Nothing> Executor::updateTaskState(const TaskStatus& status)
     }
 
     task = new Task(protobuf::createTask(
-        queuedTasks.at(taskId),
+        *queuedTasks.at(taskId),
         status.state(),
         frameworkId));
 
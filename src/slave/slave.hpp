@@ -52,6 +52,7 @@
 #include <process/shared.hpp>
 
 #include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
 #include <stout/linkedhashmap.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -63,6 +64,7 @@
 
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
+#include "common/recordio.hpp"
 
 #include "files/files.hpp"
 
@@ -130,6 +132,12 @@ public:
       const std::vector<ReconcileTasksMessage>& reconciliations,
       const MasterSlaveConnection& connection);
 
+  // Invoked when the master asks us to re-register with our full
+  // task and executor state because it could not match a delta
+  // re-registration against its own state. See
+  // `ReregisterSlaveMessage.state_fingerprint`.
+  void fullStateRequested(const process::UPID& from);
+
   void doReliableRegistration(Duration maxBackoff);
 
   // Made 'virtual' for Slave mocking.
@@ -275,6 +283,12 @@ public:
       const TaskID& taskId,
       const std::string& uuid);
 
+  // Handles a batch of acknowledgements coalesced by the master by
+  // processing each one as if it had arrived individually.
+  void statusUpdateAcknowledgements(
+      const process::UPID& from,
+      const StatusUpdateAcknowledgementsMessage& message);
+
   void _statusUpdateAcknowledgement(
       const process::Future<bool>& future,
       const TaskID& taskId,
@@ -336,6 +350,19 @@ public:
   virtual void finalize();
   virtual void exited(const process::UPID& pid);
 
+  // Starts a containerizer update sized for the executor's current
+  // and queued tasks, and delivers the given tasks and task groups to
+  // the executor once it completes (see `__run`). While the update is
+  // in flight further launches for the executor are parked on it and
+  // folded into a single follow-up update, so a burst of launches
+  // costs one containerizer round trip per batch rather than one per
+  // task.
+  void updateExecutor(
+      Framework* framework,
+      Executor* executor,
+      const std::list<std::shared_ptr<const TaskInfo>>& tasks,
+      const std::list<TaskGroupInfo>& taskGroups);
+
   // This is called when the resource limits of the container have
   // been updated for the given tasks and task groups. If the update is
   // successful, we flush the given tasks to the executor by sending
@@ -345,7 +372,7 @@ public:
       const FrameworkID& frameworkId,
       const ExecutorID& executorId,
       const ContainerID& containerId,
-      const std::list<TaskInfo>& tasks,
+      const std::list<std::shared_ptr<const TaskInfo>>& tasks,
       const std::list<TaskGroupInfo>& taskGroups);
 
   void fileAttached(const process::Future<Nothing>& result,
@@ -444,6 +471,20 @@ private:
   void _authenticate();
   void authenticationTimeout(process::Future<bool> future);
 
+  // Handlers for the master's replies when re-authenticating with a
+  // token. During the full SASL exchange these messages are delivered
+  // to the authenticatee instead.
+  void authenticationCompleted(const process::UPID& from);
+  void authenticationFailed(const process::UPID& from);
+
+  // Stores the token handed out by the master after a successful
+  // authentication.
+  void cacheAuthenticationToken(
+      const process::UPID& from,
+      const std::string& token);
+
+  void tokenAuthenticationDiscarded();
+
   // Shut down an executor. This is a two phase process. First, an
   // executor receives a shut down message (shut down phase), then
   // after a configurable timeout the slave actually forces a kill
@@ -705,6 +746,14 @@ private:
 
   Option<process::UPID> master;
 
+  // The master that has most recently acknowledged one of our
+  // (re-)registrations and advertised support for the delta
+  // re-registration handshake. We only omit our full task and
+  // executor state when re-registering with this master, since only
+  // it is known to hold that state. See
+  // `ReregisterSlaveMessage.state_fingerprint`.
+  Option<process::UPID> deltaReregistrationMaster;
+
   hashmap<FrameworkID, Framework*> frameworks;
 
   boost::circular_buffer<process::Owned<Framework>> completedFrameworks;
@@ -731,6 +780,12 @@ private:
 
   StatusUpdateManager* statusUpdateManager;
 
+  // In-flight containerizer status queries, keyed by container. A
+  // burst of status updates from the same executor (e.g., its tasks
+  // being bulk-killed during a maintenance drain) shares a single
+  // query instead of issuing one per update.
+  hashmap<ContainerID, process::Future<ContainerStatus>> containerStatuses;
+
   // Master detection future.
   process::Future<Option<MasterInfo>> detection;
 
@@ -754,6 +809,16 @@ private:
 
   Authenticatee* authenticatee;
 
+  // Token handed out by the master on the last successful
+  // authentication; presented when re-authenticating in order to
+  // skip the SASL exchange. Only honored by the master that issued
+  // it.
+  Option<std::string> authenticationToken;
+
+  // Satisfied by the master's reply when re-authenticating with a
+  // token; not set when no token authentication is in progress.
+  process::Owned<process::Promise<bool>> tokenAuthentication;
+
   // Indicates if an authentication attempt is in progress.
   Option<Future<bool>> authenticating;
 
@@ -779,6 +844,19 @@ private:
   // The most recent estimate of the total amount of oversubscribed
   // (allocated and oversubscribable) resources.
   Option<Resources> oversubscribedResources;
+
+  // The most recent result of `usage()` and the time at which the
+  // sample was taken. While the sample is younger than
+  // `flags.resource_monitoring_interval` further callers are served
+  // from it, so the rate at which container statistics are collected
+  // is bounded regardless of the number of monitoring clients.
+  Option<process::Future<ResourceUsage>> usageCache;
+  process::Time usageCacheTime;
+
+  // Ditto for the container status and statistics assembled by
+  // `Http::__containers()`.
+  Option<process::Future<JSON::Array>> containersCache;
+  process::Time containersCacheTime;
 };
 
 
@@ -788,8 +866,7 @@ struct HttpConnection
   HttpConnection(const process::http::Pipe::Writer& _writer,
                  ContentType _contentType)
     : writer(_writer),
-      contentType(_contentType),
-      encoder(lambda::bind(serialize, contentType, lambda::_1)) {}
+      contentType(_contentType) {}
 
   // Converts the message to an Event before sending.
   template <typename Message>
@@ -797,7 +874,31 @@ struct HttpConnection
   {
     // We need to evolve the internal 'message' into a
     // 'v1::executor::Event'.
-    return writer.write(encoder.encode(evolve(message)));
+    const v1::executor::Event event = evolve(message);
+
+    // Write the length header and the serialized event to the pipe
+    // as separate chunks so that the payload is moved rather than
+    // copied into a contiguous "Record-IO" frame.
+    return recordio::write(writer, serialize(contentType, event));
+  }
+
+  // Sends a batch of messages with a single write on the connection.
+  // Each record is still framed individually, so the wire format is
+  // the same as sending the messages one at a time, but a large batch
+  // (e.g., the queued tasks flushed when an executor registers)
+  // results in one write rather than one per message.
+  template <typename Message>
+  bool send(const std::vector<Message>& messages)
+  {
+    std::string payload;
+    foreach (const Message& message, messages) {
+      const v1::executor::Event event = evolve(message);
+      const std::string record = serialize(contentType, event);
+
+      payload += ::recordio::header(record.size());
+      payload += record;
+    }
+    return writer.write(std::move(payload));
   }
 
   bool close()
@@ -812,7 +913,6 @@ struct HttpConnection
 
   process::http::Pipe::Writer writer;
   ContentType contentType;
-  ::recordio::Encoder<v1::executor::Event> encoder;
 };
 
 
@@ -865,6 +965,33 @@ struct Executor
     }
   }
 
+  // Sends a batch of messages to the connected executor. On an HTTP
+  // connection the batch goes out as a single write (see
+  // `HttpConnection::send`); a driver-based executor receives the
+  // messages individually, as before.
+  template <typename Message>
+  void send(const std::vector<Message>& messages)
+  {
+    if (state == REGISTERING || state == TERMINATED) {
+      LOG(WARNING) << "Attempting to send messages to disconnected"
+                   << " executor " << *this << " in state " << state;
+    }
+
+    if (http.isSome()) {
+      if (!http->send(messages)) {
+        LOG(WARNING) << "Unable to send events to executor " << *this
+                     << ": connection closed";
+      }
+    } else if (pid.isSome()) {
+      foreach (const Message& message, messages) {
+        slave->send(pid.get(), message);
+      }
+    } else {
+      LOG(WARNING) << "Unable to send events to executor " << *this
+                   << ": unknown connection type";
+    }
+  }
+
   // Returns true if this is a command executor.
   bool isCommandExecutor() const;
 
@@ -936,9 +1063,15 @@ struct Executor
   Resources resources;
 
   // Tasks can be found in one of the following four data structures:
+  //
+  // NOTE: Queued tasks are stored behind shared immutable handles: a
+  // queued task is typically also referenced from `deferredTasks`, a
+  // queued task group and the in-flight containerizer update
+  // callbacks, and sharing a single copy avoids duplicating the
+  // (potentially large) TaskInfo trees in the agent's bookkeeping.
 
   // Not yet launched tasks. This also includes tasks from `queuedTaskGroups`.
-  LinkedHashMap<TaskID, TaskInfo> queuedTasks;
+  LinkedHashMap<TaskID, std::shared_ptr<const TaskInfo>> queuedTasks;
 
   // Not yet launched task groups. This is needed for correctly sending
   // TASK_KILLED status updates for all tasks in the group if any of the
@@ -947,6 +1080,14 @@ struct Executor
   // TODO(anand): Replace this with `LinkedHashSet` when it is available.
   std::list<TaskGroupInfo> queuedTaskGroups;
 
+  // Whether a containerizer update is in flight for this executor
+  // (see `Slave::updateExecutor`). While it is, newly queued tasks
+  // and task groups are parked below and delivered by a single
+  // follow-up update once the current one completes.
+  bool updating;
+  std::list<std::shared_ptr<const TaskInfo>> deferredTasks;
+  std::list<TaskGroupInfo> deferredTaskGroups;
+
   // Running.
   LinkedHashMap<TaskID, Task*> launchedTasks;
 
@@ -1018,8 +1159,10 @@ struct Framework
   // sent through the master.
   Option<UPID> pid;
 
-  // Executors with pending tasks.
-  hashmap<ExecutorID, hashmap<TaskID, TaskInfo>> pending;
+  // Executors with pending tasks. As with `Executor::queuedTasks`,
+  // the TaskInfos are stored behind shared immutable handles.
+  hashmap<ExecutorID,
+          hashmap<TaskID, std::shared_ptr<const TaskInfo>>> pending;
 
   // Current running executors.
   hashmap<ExecutorID, Executor*> executors;
@@ -14,10 +14,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <string.h>
+
 #include <glog/logging.h>
 
 #include <iostream>
+#include <vector>
 
+#include <process/async.hpp>
+#include <process/check.hpp>
+#include <process/collect.hpp>
+#include <process/future.hpp>
 #include <process/pid.hpp>
 
 #include <stout/check.hpp>
@@ -34,8 +41,10 @@
 #include <stout/os/close.hpp>
 #include <stout/os/exists.hpp>
 #include <stout/os/ftruncate.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/read.hpp>
 #include <stout/os/realpath.hpp>
+#include <stout/os/write.hpp>
 
 #include "messages/messages.hpp"
 
@@ -50,6 +59,212 @@ namespace state {
 using std::list;
 using std::string;
 using std::max;
+using std::vector;
+
+using process::Future;
+using process::async;
+
+
+// CRC-32 (IEEE) of the data, used to frame the records of the
+// checkpoint bundle.
+static uint32_t crc32(const string& data)
+{
+  static const uint32_t* table = []() {
+    static uint32_t table_[256];
+
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int j = 0; j < 8; j++) {
+        c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+      }
+      table_[i] = c;
+    }
+
+    return table_;
+  }();
+
+  uint32_t crc = 0xffffffff;
+
+  for (size_t i = 0; i < data.size(); i++) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc ^ 0xffffffff;
+}
+
+
+namespace internal {
+
+void append(const string& bundleDir, const string& path, const string& data)
+{
+  // The record is keyed by the path of the checkpointed file
+  // relative to the directory holding the bundle.
+  if (!strings::startsWith(path, bundleDir + "/")) {
+    LOG(WARNING) << "Not bundling checkpoint '" << path << "'"
+                 << " outside of directory '" << bundleDir << "'";
+    return;
+  }
+
+  const string key = path.substr(bundleDir.size() + 1);
+
+  // Frame the record: the sizes and bytes of the key and the data,
+  // preceded by a CRC over all of them so that a torn append is
+  // detected when the bundle is read back.
+  uint32_t keySize = key.size();
+  uint32_t dataSize = data.size();
+
+  string record;
+  record.append((char*) &keySize, sizeof(keySize));
+  record.append((char*) &dataSize, sizeof(dataSize));
+  record += key;
+  record += data;
+
+  uint32_t crc = crc32(record);
+
+  string framed((char*) &crc, sizeof(crc));
+  framed += record;
+
+  Try<int> fd = os::open(
+      path::join(bundleDir, paths::CHECKPOINT_BUNDLE_FILE),
+      O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    LOG(WARNING) << "Failed to open checkpoint bundle in '" << bundleDir
+                 << "': " << fd.error();
+    return;
+  }
+
+  // NOTE: The record is appended with a single write so that
+  // concurrent checkpoints into the same directory (e.g., the
+  // containerizer checkpointing the forked pid while the slave
+  // checkpoints a task) do not interleave records.
+  Try<Nothing> write = os::write(fd.get(), framed);
+
+  if (write.isError()) {
+    LOG(WARNING) << "Failed to append to checkpoint bundle in '" << bundleDir
+                 << "': " << write.error();
+  }
+
+  os::close(fd.get());
+}
+
+} // namespace internal {
+
+
+hashmap<string, string> readBundle(const string& bundleDir)
+{
+  hashmap<string, string> records;
+
+  const string path = path::join(bundleDir, paths::CHECKPOINT_BUNDLE_FILE);
+
+  if (!os::exists(path)) {
+    return records;
+  }
+
+  Try<string> read = os::read(path);
+
+  if (read.isError()) {
+    LOG(WARNING) << "Failed to read checkpoint bundle '" << path
+                 << "': " << read.error();
+    return records;
+  }
+
+  const string& data = read.get();
+
+  size_t offset = 0;
+  while (data.size() - offset >= 3 * sizeof(uint32_t)) {
+    uint32_t crc, keySize, dataSize;
+    memcpy(&crc, data.data() + offset, sizeof(crc));
+    memcpy(&keySize,
+           data.data() + offset + sizeof(uint32_t),
+           sizeof(keySize));
+    memcpy(&dataSize,
+           data.data() + offset + 2 * sizeof(uint32_t),
+           sizeof(dataSize));
+
+    uint64_t size =
+      3 * sizeof(uint32_t) + (uint64_t) keySize + (uint64_t) dataSize;
+
+    if (data.size() - offset < size) {
+      break;
+    }
+
+    // The CRC covers everything after itself.
+    const string record =
+      data.substr(offset + sizeof(uint32_t), size - sizeof(uint32_t));
+
+    if (crc32(record) != crc) {
+      LOG(WARNING) << "Found corrupt record in checkpoint bundle '" << path
+                   << "' at offset " << offset;
+      return records;
+    }
+
+    records.put(
+        record.substr(2 * sizeof(uint32_t), keySize),
+        record.substr(2 * sizeof(uint32_t) + keySize));
+
+    offset += size;
+  }
+
+  if (offset != data.size()) {
+    // This is expected if the slave crashed while appending a
+    // record; the affected entry is recovered from its file.
+    LOG(WARNING) << "Ignoring torn record at the end of checkpoint bundle '"
+                 << path << "'";
+  }
+
+  return records;
+}
+
+
+// Returns the bundled checkpoint data for 'path', if any. The
+// records of a bundle are keyed by the path relative to the
+// directory holding the bundle.
+static Option<string> bundled(
+    const hashmap<string, string>& bundle,
+    const string& bundleDir,
+    const string& path)
+{
+  if (strings::startsWith(path, bundleDir + "/")) {
+    return bundle.get(path.substr(bundleDir.size() + 1));
+  }
+
+  return None();
+}
+
+
+// Parses a protobuf message from bundled checkpoint data, which has
+// the framing of '::protobuf::write': the size of the message
+// followed by its contents. Returns none if the data is empty,
+// mirroring a read of an empty checkpoint file.
+template <typename T>
+static Result<T> parse(const string& data)
+{
+  if (data.empty()) {
+    return None();
+  }
+
+  if (data.size() < sizeof(uint32_t)) {
+    return Error("Failed to read size: found truncated record");
+  }
+
+  uint32_t size;
+  memcpy(&size, data.data(), sizeof(size));
+
+  if (data.size() - sizeof(uint32_t) < size) {
+    return Error("Failed to read message: found truncated record");
+  }
+
+  T message;
+
+  if (!message.ParseFromArray(data.data() + sizeof(uint32_t), size)) {
+    return Error("Failed to deserialize " +
+                 message.GetDescriptor()->full_name());
+  }
+
+  return message;
+}
 
 
 Result<State> recover(const string& rootDir, bool strict)
@@ -164,6 +379,16 @@ Try<SlaveState> SlaveState::recover(
 
   state.info = slaveInfo.get();
 
+  // Move any executor directories checkpointed by an agent that
+  // predates the sharded 'executors' layout into their shard
+  // directories, before the executor directories are listed below.
+  Try<Nothing> migrate = paths::migrateExecutorDirectories(rootDir, slaveId);
+
+  if (migrate.isError()) {
+    return Error("Failed to migrate executor directories for agent " +
+                 slaveId.value() + ": " + migrate.error());
+  }
+
   // Find the frameworks.
   Try<list<string>> frameworks = paths::getFrameworkPaths(rootDir, slaveId);
 
@@ -281,20 +506,45 @@ Try<FrameworkState> FrameworkState::recover(
         ": " + executors.error());
   }
 
-  // Recover the executors.
+  // Recover the executors. Recovering an executor is dominated by
+  // reading the checkpoints of its runs, so the recoveries are fanned
+  // out onto worker threads and merged below. Each worker performs
+  // only synchronous file I/O and the concurrency is bounded by the
+  // size of the libprocess worker pool, so recovery time scales with
+  // the disk's ability to serve concurrent reads rather than with the
+  // number of executor directories.
+  vector<ExecutorID> executorIds;
+  vector<Future<Try<ExecutorState>>> futures;
+
   foreach (const string& path, executors.get()) {
     ExecutorID executorId;
     executorId.set_value(Path(path).basename());
 
-    Try<ExecutorState> executor =
-      ExecutorState::recover(rootDir, slaveId, frameworkId, executorId, strict);
+    executorIds.push_back(executorId);
+    futures.push_back(async(
+        &ExecutorState::recover,
+        rootDir,
+        slaveId,
+        frameworkId,
+        executorId,
+        strict));
+  }
+
+  // NOTE: Waiting here is safe: recovery runs on a thread dedicated
+  // to it and the workers do not depend on this thread.
+  process::collect(futures).await();
+
+  for (size_t i = 0; i < futures.size(); i++) {
+    CHECK_READY(futures[i]);
+
+    const Try<ExecutorState>& executor = futures[i].get();
 
     if (executor.isError()) {
-      return Error("Failed to recover executor '" + executorId.value() +
+      return Error("Failed to recover executor '" + executorIds[i].value() +
                    "': " + executor.error());
     }
 
-    state.executors[executorId] = executor.get();
+    state.executors[executorIds[i]] = executor.get();
     state.errors += executor.get().errors;
   }
 
@@ -430,6 +680,18 @@ Try<RunState> RunState::recover(
 
   state.completed = os::exists(path);
 
+  // Read the checkpoint bundle of this run, if present: it serves
+  // the metadata checkpointed for the run from a single sequential
+  // read, rather than with one open/read/close per checkpointed
+  // file. The individual checkpoint files remain authoritative and
+  // any entry without a valid bundled record is read from its file
+  // below, e.g., for runs checkpointed by an agent that predates
+  // bundling.
+  const string runDir = paths::getExecutorRunPath(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
+  const hashmap<string, string> bundle = readBundle(runDir);
+
   // Find the tasks.
   Try<list<string>> tasks = paths::getTaskPaths(
       rootDir,
@@ -450,7 +712,14 @@ Try<RunState> RunState::recover(
     taskId.set_value(Path(path).basename());
 
     Try<TaskState> task = TaskState::recover(
-        rootDir, slaveId, frameworkId, executorId, containerId, taskId, strict);
+        rootDir,
+        slaveId,
+        frameworkId,
+        executorId,
+        containerId,
+        taskId,
+        bundle,
+        strict);
 
     if (task.isError()) {
       return Error(
@@ -464,14 +733,17 @@ Try<RunState> RunState::recover(
   // Read the forked pid.
   path = paths::getForkedPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
-  if (!os::exists(path)) {
+
+  Option<string> data = bundled(bundle, runDir, path);
+
+  if (data.isNone() && !os::exists(path)) {
     // This could happen if the slave died before the isolator
     // checkpointed the forked pid.
     LOG(WARNING) << "Failed to find executor forked pid file '" << path << "'";
     return state;
   }
 
-  Try<string> pid = os::read(path);
+  Try<string> pid = data.isSome() ? Try<string>(data.get()) : os::read(path);
 
   if (pid.isError()) {
     message = "Failed to read executor forked pid from '" + path +
@@ -505,8 +777,10 @@ Try<RunState> RunState::recover(
   path = paths::getLibprocessPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  if (os::exists(path)) {
-    pid = os::read(path);
+  data = bundled(bundle, runDir, path);
+
+  if (data.isSome() || os::exists(path)) {
+    pid = data.isSome() ? Try<string>(data.get()) : os::read(path);
 
     if (pid.isError()) {
       message = "Failed to read executor libprocess pid from '" + path +
@@ -558,23 +832,32 @@ Try<TaskState> TaskState::recover(
     const ExecutorID& executorId,
     const ContainerID& containerId,
     const TaskID& taskId,
+    const hashmap<string, string>& bundle,
     bool strict)
 {
   TaskState state;
   state.id = taskId;
   string message;
 
+  const string runDir = paths::getExecutorRunPath(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
   // Read the task info.
   string path = paths::getTaskInfoPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+
+  Option<string> data = bundled(bundle, runDir, path);
+
+  if (data.isNone() && !os::exists(path)) {
     // This could happen if the slave died after creating the task
     // directory but before it checkpointed the task info.
     LOG(WARNING) << "Failed to find task info file '" << path << "'";
     return state;
   }
 
-  const Result<Task>& task = ::protobuf::read<Task>(path);
+  const Result<Task>& task = data.isSome()
+    ? parse<Task>(data.get())
+    : ::protobuf::read<Task>(path);
 
   if (task.isError()) {
     message = "Failed to read task info from '" + path + "': " + task.error();
@@ -17,10 +17,13 @@
 #ifndef __SLAVE_STATE_HPP__
 #define __SLAVE_STATE_HPP__
 
+#include <stdint.h>
+
 #ifndef __WINDOWS__
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <string>
 #include <vector>
 
 #include <mesos/resources.hpp>
@@ -31,6 +34,8 @@
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/strings.hpp>
@@ -76,46 +81,89 @@ Result<State> recover(const std::string& rootDir, bool strict);
 
 namespace internal {
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
-    const std::string& message)
+inline Try<std::string> serialize(const std::string& message)
 {
-  return ::os::write(path, message);
+  return message;
 }
 
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
-    const google::protobuf::Message& message)
+inline Try<std::string> serialize(const google::protobuf::Message& message)
 {
-  return ::protobuf::write(path, message);
+  if (!message.IsInitialized()) {
+    return Error(message.InitializationErrorString() +
+                 " is required but not initialized");
+  }
+
+  // Serialize the way '::protobuf::write' does: the size of the
+  // message followed by its contents.
+  uint32_t size = message.ByteSize();
+
+  std::string data((char*) &size, sizeof(size));
+
+  if (!message.AppendToString(&data)) {
+    return Error("Failed to serialize message");
+  }
+
+  return data;
 }
 
 
 template <typename T>
-Try<Nothing> checkpoint(
-    const std::string& path,
+Try<std::string> serialize(
     const google::protobuf::RepeatedPtrField<T>& messages)
 {
-  return ::protobuf::write(path, messages);
+  std::string data;
+
+  foreach (const T& message, messages) {
+    Try<std::string> serialized =
+      serialize(static_cast<const google::protobuf::Message&>(message));
+
+    if (serialized.isError()) {
+      return Error(serialized.error());
+    }
+
+    data += serialized.get();
+  }
+
+  return data;
 }
 
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
-    const Resources& resources)
+inline Try<std::string> serialize(const Resources& resources)
 {
   const google::protobuf::RepeatedPtrField<Resource>& messages = resources;
-  return checkpoint(path, messages);
+  return serialize(messages);
 }
 
+
+// Appends the data checkpointed at 'path' to the checkpoint bundle
+// in 'bundleDir', framed with a CRC so that a torn append (e.g., the
+// slave crashed mid-write) is detected at recovery. Append failures
+// are logged and otherwise ignored: the checkpointed file remains
+// authoritative and recovery falls back to reading it whenever the
+// bundle does not contain a valid record for it.
+void append(
+    const std::string& bundleDir,
+    const std::string& path,
+    const std::string& data);
+
 }  // namespace internal {
 
 
+// Reads the checkpoint bundle in 'bundleDir', if present, returning
+// the checkpointed data keyed by the checkpointed file's path
+// relative to 'bundleDir'. Later records override earlier ones, so a
+// re-checkpointed entry resolves to its latest data, just like the
+// file it mirrors. Reading stops at the first record that is torn or
+// fails its CRC; the entries read up to that point are still
+// returned and the remainder is recovered from the individual files.
+hashmap<std::string, std::string> readBundle(const std::string& bundleDir);
+
+
 // Thin wrapper to checkpoint data to disk and perform the necessary
 // error checking. It checkpoints an instance of T at the given path.
 // We can checkpoint anything as long as T is supported by
-// internal::checkpoint. Currently the list of supported Ts are:
+// internal::serialize. Currently the list of supported Ts are:
 //   - std::string
 //   - google::protobuf::Message
 //   - google::protobuf::RepeatedPtrField<T>
@@ -124,9 +172,25 @@ inline Try<Nothing> checkpoint(
 // NOTE: We provide atomic (all-or-nothing) semantics here by always
 // writing to a temporary file first then using os::rename to atomically
 // move it to the desired path.
+//
+// If 'bundleDir' is given, the checkpointed data is additionally
+// appended to the checkpoint bundle in that directory so that
+// recovery can read back all of the directory's checkpoints in a
+// single pass instead of with one open/read/close per file (see
+// 'readBundle' above).
 template <typename T>
-Try<Nothing> checkpoint(const std::string& path, const T& t)
+Try<Nothing> checkpoint(
+    const std::string& path,
+    const T& t,
+    const Option<std::string>& bundleDir = None())
 {
+  // Serialize the instance of T upfront: the same data is written to
+  // the file and, when requested, appended to the bundle.
+  Try<std::string> data = internal::serialize(t);
+  if (data.isError()) {
+    return Error("Failed to serialize to '" + path + "': " + data.error());
+  }
+
   // Create the base directory.
   std::string base = Path(path).dirname();
 
@@ -146,14 +210,14 @@ Try<Nothing> checkpoint(const std::string& path, const T& t)
     return Error("Failed to create temporary file: " + temp.error());
   }
 
-  // Now checkpoint the instance of T to the temporary file.
-  Try<Nothing> checkpoint = internal::checkpoint(temp.get(), t);
-  if (checkpoint.isError()) {
+  // Now checkpoint the serialized data to the temporary file.
+  Try<Nothing> write = ::os::write(temp.get(), data.get());
+  if (write.isError()) {
     // Try removing the temporary file on error.
     os::rm(temp.get());
 
     return Error("Failed to write temporary file '" + temp.get() +
-                 "': " + checkpoint.error());
+                 "': " + write.error());
   }
 
   // Rename the temporary file to the path.
@@ -166,6 +230,10 @@ Try<Nothing> checkpoint(const std::string& path, const T& t)
                  path + "': " + rename.error());
   }
 
+  if (bundleDir.isSome()) {
+    internal::append(bundleDir.get(), path, data.get());
+  }
+
   return Nothing();
 }
 
@@ -187,6 +255,7 @@ struct TaskState
       const ExecutorID& executorId,
       const ContainerID& containerId,
       const TaskID& taskId,
+      const hashmap<std::string, std::string>& bundle,
       bool strict);
 
   TaskID id;
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <process/clock.hpp>
 #include <process/delay.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
@@ -47,10 +48,14 @@ using lambda::function;
 using std::string;
 
 using process::wait; // Necessary on some OS's to disambiguate.
+using process::Clock;
 using process::Failure;
 using process::Future;
+using process::Owned;
 using process::PID;
+using process::Promise;
 using process::Timeout;
+using process::Timer;
 using process::UPID;
 
 namespace mesos {
@@ -110,14 +115,31 @@ private:
       const Option<ExecutorID>& executorId,
       const Option<ContainerID>& containerId);
 
-  // Status update timeout.
-  void timeout(const Duration& duration);
-
-  // Forwards the status update to the master and starts a timer based
-  // on the 'duration' to check for ACK from the scheduler.
+  // Status update retry timeout: resends the pending updates whose
+  // deadline has expired and re-arms the retry timer for the next
+  // deadline, if any.
+  void timeout();
+
+  // Writes the records buffered by the status update streams to their
+  // updates files, one write per stream per group. This runs as a
+  // separate message to self, so the records of all the updates and
+  // acknowledgements processed in the interim are coalesced into a
+  // single group.
+  void flush();
+
+  // Forwards the status update to the master and records the retry
+  // deadline and interval on the stream. A single timer serves all
+  // the streams (see 'schedule()').
   // NOTE: This should only be used for those messages that expect an
   // ACK (e.g updates from the executor).
-  Timeout forward(const StatusUpdate& update, const Duration& duration);
+  void forward(
+      StatusUpdateStream* stream,
+      const StatusUpdate& update,
+      const Duration& duration);
+
+  // (Re)arms the retry timer so that it fires no later than the
+  // given deadline.
+  void schedule(const Timeout& timeout);
 
   // Helper functions.
 
@@ -142,6 +164,15 @@ private:
   const Flags flags;
   bool paused;
 
+  // Whether a `flush()` has been dispatched but has not run yet.
+  bool flushScheduled;
+
+  // The single timer used to retry the pending updates of all the
+  // streams, armed for the earliest retry deadline. Each stream
+  // tracks its own deadline and backoff interval, so this avoids
+  // creating one timer per forwarded update.
+  Option<Timer> retryTimer;
+
   function<void(StatusUpdate)> forward_;
 
   hashmap<FrameworkID, hashmap<TaskID, StatusUpdateStream*>> streams;
@@ -151,7 +182,8 @@ private:
 StatusUpdateManagerProcess::StatusUpdateManagerProcess(const Flags& _flags)
   : ProcessBase(process::ID::generate("status-update-manager")),
     flags(_flags),
-    paused(false) {}
+    paused(false),
+    flushScheduled(false) {}
 
 
 StatusUpdateManagerProcess::~StatusUpdateManagerProcess()
@@ -189,7 +221,7 @@ void StatusUpdateManagerProcess::resume()
       if (!stream->pending.empty()) {
         const StatusUpdate& update = stream->pending.front();
         LOG(WARNING) << "Resending status update " << update;
-        stream->timeout = forward(update, STATUS_UPDATE_RETRY_INTERVAL_MIN);
+        forward(stream, update, STATUS_UPDATE_RETRY_INTERVAL_MIN);
       }
     }
   }
@@ -361,14 +393,59 @@ Future<Nothing> StatusUpdateManagerProcess::_update(
     }
 
     CHECK_SOME(next);
-    stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+    forward(stream, next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+  }
+
+  // If the update's record was buffered for checkpointing, schedule a
+  // flush and tie the returned future to it. This preserves the
+  // contract that an update is checkpointed before the executor is
+  // sent an acknowledgement, while letting the records of all the
+  // updates processed in the interim share a single write.
+  if (stream->dirty()) {
+    if (!flushScheduled) {
+      flushScheduled = true;
+      dispatch(self(), &StatusUpdateManagerProcess::flush);
+    }
+
+    return stream->flushed();
   }
 
   return Nothing();
 }
 
 
-Timeout StatusUpdateManagerProcess::forward(
+void StatusUpdateManagerProcess::flush()
+{
+  flushScheduled = false;
+
+  foreachkey (const FrameworkID& frameworkId, streams) {
+    foreachvalue (StatusUpdateStream* stream, streams[frameworkId]) {
+      if (stream->dirty()) {
+        Try<Nothing> flush = stream->flush();
+        if (flush.isError()) {
+          LOG(ERROR) << "Failed to flush status update records: "
+                     << flush.error();
+          continue;
+        }
+      }
+
+      // Compact the stream's updates file if it has accumulated a
+      // large acknowledged prefix, e.g., a long-running task that
+      // emits frequent updates.
+      if (stream->shouldCompact()) {
+        Try<Nothing> compact = stream->compact();
+        if (compact.isError()) {
+          LOG(ERROR) << "Failed to compact status update stream: "
+                     << compact.error();
+        }
+      }
+    }
+  }
+}
+
+
+void StatusUpdateManagerProcess::forward(
+    StatusUpdateStream* stream,
     const StatusUpdate& update,
     const Duration& duration)
 {
@@ -379,11 +456,27 @@ Timeout StatusUpdateManagerProcess::forward(
   // Forward the update.
   forward_(update);
 
-  // Send a message to self to resend after some delay if no ACK is received.
-  return delay(duration,
-               self(),
-               &StatusUpdateManagerProcess::timeout,
-               duration).timeout();
+  // Record the deadline for resending the update if no ACK is
+  // received, and make sure the retry timer covers it.
+  stream->timeout = Timeout::in(duration);
+  stream->interval = duration;
+
+  schedule(stream->timeout.get());
+}
+
+
+void StatusUpdateManagerProcess::schedule(const Timeout& timeout)
+{
+  if (retryTimer.isSome() && retryTimer.get().timeout() <= timeout) {
+    return;
+  }
+
+  if (retryTimer.isSome()) {
+    Clock::cancel(retryTimer.get());
+  }
+
+  retryTimer = delay(
+      timeout.remaining(), self(), &StatusUpdateManagerProcess::timeout);
 }
 
 
@@ -433,6 +526,14 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
     return Failure("Duplicate acknowledgement");
   }
 
+  // Schedule a flush for the ACK's record, if it was buffered for
+  // checkpointing. If the stream is cleaned up below instead, its
+  // destructor writes the record out.
+  if (stream->dirty() && !flushScheduled) {
+    flushScheduled = true;
+    dispatch(self(), &StatusUpdateManagerProcess::flush);
+  }
+
   // Reset the timeout.
   stream->timeout = None();
 
@@ -453,7 +554,7 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
     cleanupStatusUpdateStream(taskId, frameworkId);
   } else if (!paused && next.isSome()) {
     // Forward the next queued status update.
-    stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+    forward(stream, next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
   }
 
   return !terminated;
@@ -461,13 +562,19 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
 
 
 // TODO(vinod): There should be a limit on the retries.
-void StatusUpdateManagerProcess::timeout(const Duration& duration)
+void StatusUpdateManagerProcess::timeout()
 {
+  retryTimer = None();
+
   if (paused) {
     return;
   }
 
-  // Check and see if we should resend any status updates.
+  // Check and see if we should resend any status updates, tracking
+  // the earliest deadline among the streams that are still waiting
+  // for an ACK.
+  Option<Timeout> next = None();
+
   foreachkey (const FrameworkID& frameworkId, streams) {
     foreachvalue (StatusUpdateStream* stream, streams[frameworkId]) {
       CHECK_NOTNULL(stream);
@@ -478,14 +585,20 @@ void StatusUpdateManagerProcess::timeout(const Duration& duration)
           LOG(WARNING) << "Resending status update " << update;
 
           // Bounded exponential backoff.
-          Duration duration_ =
-            std::min(duration * 2, STATUS_UPDATE_RETRY_INTERVAL_MAX);
+          Duration duration =
+            std::min(stream->interval * 2, STATUS_UPDATE_RETRY_INTERVAL_MAX);
 
-          stream->timeout = forward(update, duration_);
+          forward(stream, update, duration);
+        } else if (next.isNone() || stream->timeout.get() < next.get()) {
+          next = stream->timeout;
         }
       }
     }
   }
+
+  if (next.isSome()) {
+    schedule(next.get());
+  }
 }
 
 
@@ -650,6 +763,7 @@ StatusUpdateStream::StatusUpdateStream(
     const Option<ContainerID>& containerId)
     : checkpoint(_checkpoint),
       terminated(false),
+      interval(STATUS_UPDATE_RETRY_INTERVAL_MIN),
       taskId(_taskId),
       frameworkId(_frameworkId),
       slaveId(_slaveId),
@@ -693,6 +807,16 @@ StatusUpdateStream::StatusUpdateStream(
     // We keep the file open through the lifetime of the task, because it
     // makes it easy to append status update records to the file.
     fd = result.get();
+
+    // Keep track of the size of the updates file in order to decide
+    // when to compact it.
+    Try<Bytes> size = os::stat::size(path.get());
+    if (size.isError()) {
+      error = "Failed to stat '" + path.get() + "': " + size.error();
+      return;
+    }
+
+    written = size.get();
   }
 }
 
@@ -700,6 +824,16 @@ StatusUpdateStream::StatusUpdateStream(
 StatusUpdateStream::~StatusUpdateStream()
 {
   if (fd.isSome()) {
+    // Write out any records that have not been flushed yet, e.g., the
+    // ACK that terminated this stream.
+    if (dirty()) {
+      Try<Nothing> write = flush();
+      if (write.isError()) {
+        LOG(ERROR) << "Failed to flush status update records: "
+                   << write.error();
+      }
+    }
+
     Try<Nothing> close = os::close(fd.get());
     if (close.isError()) {
       CHECK_SOME(path);
@@ -817,6 +951,17 @@ Try<Nothing> StatusUpdateStream::replay(
     }
   }
 
+  // ACK records whose corresponding update has been dropped by
+  // compaction still mark the update as received and acknowledged, so
+  // that a duplicate resent by the executor after the recovery is
+  // suppressed.
+  foreach (const UUID& uuid, acks) {
+    if (!received.contains(uuid)) {
+      received.insert(uuid);
+      acknowledged.insert(uuid);
+    }
+  }
+
   return Nothing();
 }
 
@@ -842,12 +987,21 @@ Try<Nothing> StatusUpdateStream::handle(
       record.set_uuid(update.uuid());
     }
 
-    Try<Nothing> write = ::protobuf::write(fd.get(), record);
-    if (write.isError()) {
-      error = "Failed to write status update " + stringify(update) +
-              " to '" + path.get() + "': " + write.error();
+    // Buffer the serialized record instead of writing it out
+    // directly; the manager schedules a `flush()` which writes all
+    // the records buffered in the interim with a single write. The
+    // format matches `protobuf::write`: a 32 bit size followed by the
+    // serialized record.
+    uint32_t size = record.ByteSize();
+    string bytes((char*) &size, sizeof(size));
+
+    if (!record.AppendToString(&bytes)) {
+      error = "Failed to serialize status update " + stringify(update) +
+              " for '" + path.get() + "'";
       return Error(error.get());
     }
+
+    buffer.append(bytes);
   }
 
   // Now actually handle the update.
@@ -882,6 +1036,144 @@ void StatusUpdateStream::_handle(
   }
 }
 
+
+Future<Nothing> StatusUpdateStream::flushed()
+{
+  Owned<Promise<Nothing>> promise(new Promise<Nothing>());
+  flushing.push_back(promise);
+  return promise->future();
+}
+
+
+Try<Nothing> StatusUpdateStream::flush()
+{
+  if (buffer.empty()) {
+    return Nothing();
+  }
+
+  CHECK_SOME(fd);
+  CHECK_SOME(path);
+
+  Try<Nothing> write = os::write(fd.get(), buffer);
+
+  if (write.isError()) {
+    error = "Failed to write status update records to '" + path.get() +
+            "': " + write.error();
+
+    foreach (const Owned<Promise<Nothing>>& promise, flushing) {
+      promise->fail(error.get());
+    }
+
+    flushing.clear();
+
+    return Error(error.get());
+  }
+
+  written += buffer.size();
+  buffer.clear();
+
+  foreach (const Owned<Promise<Nothing>>& promise, flushing) {
+    promise->set(Nothing());
+  }
+
+  flushing.clear();
+
+  return Nothing();
+}
+
+
+bool StatusUpdateStream::shouldCompact() const
+{
+  // Compacting only pays off once everything received has been
+  // acknowledged: the acknowledged updates are then represented by
+  // their (much smaller) ACK records alone. Requiring the file to
+  // have doubled since the last compaction prevents repeated
+  // compactions with diminishing returns once the ACK records
+  // themselves exceed the threshold.
+  return checkpoint &&
+         error.isNone() &&
+         pending.empty() &&
+         !acknowledged.empty() &&
+         written >= STATUS_UPDATE_STREAM_COMPACTION_THRESHOLD &&
+         written.bytes() >= 2 * compacted.bytes();
+}
+
+
+Try<Nothing> StatusUpdateStream::compact()
+{
+  CHECK(checkpoint);
+  CHECK_SOME(path);
+  CHECK_SOME(fd);
+  CHECK(buffer.empty());
+
+  LOG(INFO) << "Compacting status update stream file '" << path.get()
+            << "' of size " << written;
+
+  string records;
+
+  foreach (const UUID& uuid, acknowledged) {
+    StatusUpdateRecord record;
+    record.set_type(StatusUpdateRecord::ACK);
+    record.set_uuid(uuid.toBytes());
+
+    uint32_t size = record.ByteSize();
+    records.append((char*) &size, sizeof(size));
+
+    if (!record.AppendToString(&records)) {
+      return Error("Failed to serialize ACK record");
+    }
+  }
+
+  std::queue<StatusUpdate> updates = pending;
+  while (!updates.empty()) {
+    StatusUpdateRecord record;
+    record.set_type(StatusUpdateRecord::UPDATE);
+    record.mutable_update()->CopyFrom(updates.front());
+    updates.pop();
+
+    uint32_t size = record.ByteSize();
+    records.append((char*) &size, sizeof(size));
+
+    if (!record.AppendToString(&records)) {
+      return Error("Failed to serialize UPDATE record");
+    }
+  }
+
+  // Atomically replace the file, then re-open it for appending.
+  Try<Nothing> checkpointed = state::checkpoint(path.get(), records);
+  if (checkpointed.isError()) {
+    return Error(
+        "Failed to checkpoint compacted stream: " + checkpointed.error());
+  }
+
+  Try<Nothing> close = os::close(fd.get());
+  if (close.isError()) {
+    LOG(ERROR) << "Failed to close file '" << path.get() << "': "
+               << close.error();
+  }
+
+  Try<int> open = os::open(
+      path.get(),
+      O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (open.isError()) {
+    fd = None();
+    error = "Failed to open '" + path.get() + "' for status updates";
+    return Error(error.get());
+  }
+
+  fd = open.get();
+
+  written = Bytes(records.size());
+  compacted = written;
+
+  LOG(INFO) << "Compacted status update stream file '" << path.get()
+            << "' to size " << written;
+
+  return Nothing();
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
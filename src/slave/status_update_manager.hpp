@@ -19,13 +19,17 @@
 
 #include <queue>
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
 #include <process/future.hpp>
+#include <process/owned.hpp>
 #include <process/pid.hpp>
 #include <process/timeout.hpp>
 
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/option.hpp>
@@ -166,19 +170,49 @@ struct StatusUpdateStream
       const std::vector<StatusUpdate>& updates,
       const hashset<UUID>& acks);
 
+  // Returns true if there are checkpointed records buffered in memory
+  // that have not yet been written to the updates file.
+  bool dirty() const { return !buffer.empty(); }
+
+  // Returns a future that is satisfied once all the records currently
+  // buffered have been written to the updates file by `flush()`.
+  process::Future<Nothing> flushed();
+
+  // Writes the buffered records to the updates file with a single
+  // write, satisfying the futures returned by `flushed()`. The
+  // manager schedules the flush as a separate message to itself, so
+  // that the records of all the updates and acknowledgements handled
+  // in the interim are written out as one group.
+  Try<Nothing> flush();
+
+  // Returns true if the updates file has grown enough that rewriting
+  // it would reclaim significant space (see `compact()`).
+  bool shouldCompact() const;
+
+  // Rewrites the updates file, representing acknowledged updates by
+  // their ACK records alone (which are sufficient to suppress
+  // duplicates resent by the executor after a recovery) and pending
+  // updates in full, and re-opens the file for appending. The rewrite
+  // goes through a temporary file and a rename, so a crash during
+  // compaction cannot lose records.
+  Try<Nothing> compact();
+
   // TODO(vinod): Explore semantics to make these private.
   const bool checkpoint;
   bool terminated;
   Option<process::Timeout> timeout; // Timeout for resending status update.
+
+  // The retry interval that was used when the update at the head of
+  // the queue was last forwarded; doubled (bounded) on every resend.
+  Duration interval;
+
   std::queue<StatusUpdate> pending;
 
 private:
-  // Handles the status update and writes it to disk, if necessary.
-  // TODO(vinod): The write has to be asynchronous to avoid status updates that
-  // are being checkpointed, blocking the processing of other updates.
-  // One solution is to wrap the protobuf::write inside async, but its probably
-  // too much of an overhead to spin up a new libprocess per status update?
-  // A better solution might be to be have async write capability for file io.
+  // Handles the status update and buffers its serialized record, if
+  // checkpointing is enabled. Records are written to disk in groups
+  // by `flush()`, so a burst of updates results in a single write
+  // rather than one write per record.
   Try<Nothing> handle(
       const StatusUpdate& update,
       const StatusUpdateRecord::Type& type);
@@ -199,6 +233,14 @@ private:
   Option<std::string> path; // File path of the update stream.
   Option<int> fd; // File descriptor to the update stream.
 
+  std::string buffer; // Serialized records not yet written to 'fd'.
+
+  // Promises satisfied when the buffered records are flushed.
+  std::vector<process::Owned<process::Promise<Nothing>>> flushing;
+
+  Bytes written; // Approximate size of the updates file.
+  Bytes compacted; // Size of the updates file after the last compaction.
+
   Option<std::string> error; // Potential non-retryable error.
 };
 
@@ -16,6 +16,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/in_memory.hpp>
 #include <mesos/state/storage.hpp>
@@ -25,6 +26,8 @@
 #include <process/id.hpp>
 #include <process/process.hpp>
 
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/uuid.hpp>
@@ -34,6 +37,7 @@ using namespace process;
 // Note that we don't add 'using std::set' here because we need
 // 'std::' to disambiguate the 'set' member.
 using std::string;
+using std::vector;
 
 using mesos::internal::state::Entry;
 
@@ -65,6 +69,43 @@ public:
     return true;
   }
 
+  // NOTE: the bulk operations are named 'getAll' and 'setAll' rather
+  // than overloading 'get' and 'set' so that they can be dispatched
+  // to without having to disambiguate the member function pointers.
+  vector<Option<Entry>> getAll(const vector<string>& names)
+  {
+    vector<Option<Entry>> options;
+    options.reserve(names.size());
+
+    foreach (const string& name, names) {
+      options.push_back(entries.get(name));
+    }
+
+    return options;
+  }
+
+  bool setAll(const vector<Entry>& _entries, const vector<UUID>& uuids)
+  {
+    CHECK_EQ(_entries.size(), uuids.size());
+
+    // Check all the versions first so that either all of the entries
+    // are set or none of them are.
+    for (size_t i = 0; i < _entries.size(); i++) {
+      const Option<Entry>& option = entries.get(_entries[i].name());
+
+      if (option.isSome() &&
+          UUID::fromBytes(option.get().uuid()).get() != uuids[i]) {
+        return false;
+      }
+    }
+
+    foreach (const Entry& entry, _entries) {
+      entries.put(entry.name(), entry);
+    }
+
+    return true;
+  }
+
   bool expunge(const Entry& entry)
   {
     const Option<Entry>& option = entries.get(entry.name());
@@ -121,6 +162,20 @@ Future<bool> InMemoryStorage::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> InMemoryStorage::get(const vector<string>& names)
+{
+  return dispatch(process, &InMemoryStorageProcess::getAll, names);
+}
+
+
+Future<bool> InMemoryStorage::set(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  return dispatch(process, &InMemoryStorageProcess::setAll, entries, uuids);
+}
+
+
 Future<bool> InMemoryStorage::expunge(const Entry& entry)
 {
   return dispatch(process, &InMemoryStorageProcess::expunge, entry);
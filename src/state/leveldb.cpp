@@ -14,7 +14,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
+#include <leveldb/write_batch.h>
 
 #include <google/protobuf/message.h>
 
@@ -22,6 +25,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/leveldb.hpp>
 #include <mesos/state/storage.hpp>
@@ -31,7 +35,9 @@
 #include <process/id.hpp>
 #include <process/process.hpp>
 
+#include <stout/check.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/some.hpp>
@@ -45,6 +51,7 @@ using namespace process;
 // Note that we don't add 'using std::set' here because we need
 // 'std::' to disambiguate the 'set' member.
 using std::string;
+using std::vector;
 
 using mesos::internal::state::Entry;
 
@@ -55,7 +62,10 @@ namespace state {
 class LevelDBStorageProcess : public Process<LevelDBStorageProcess>
 {
 public:
-  explicit LevelDBStorageProcess(const string& path);
+  LevelDBStorageProcess(
+      const string& path,
+      size_t bloomFilterBitsPerKey,
+      const Bytes& blockCacheSize);
   virtual ~LevelDBStorageProcess();
 
   virtual void initialize();
@@ -63,6 +73,8 @@ public:
   // Storage implementation.
   Future<Option<Entry>> get(const string& name);
   Future<bool> set(const Entry& entry, const UUID& uuid);
+  Future<vector<Option<Entry>>> getAll(const vector<string>& names);
+  Future<bool> setAll(const vector<Entry>& entries, const vector<UUID>& uuids);
   Future<bool> expunge(const Entry& entry);
   Future<std::set<string>> names();
 
@@ -72,21 +84,39 @@ private:
   Try<bool> write(const Entry& entry);
 
   const string path;
+  const size_t bloomFilterBitsPerKey;
+  const Bytes blockCacheSize;
+
   leveldb::DB* db;
 
+  // Referenced by 'db' and hence must outlive it.
+  const leveldb::FilterPolicy* filterPolicy;
+  leveldb::Cache* blockCache;
+
   Option<string> error;
 };
 
 
-LevelDBStorageProcess::LevelDBStorageProcess(const string& _path)
+LevelDBStorageProcess::LevelDBStorageProcess(
+    const string& _path,
+    size_t _bloomFilterBitsPerKey,
+    const Bytes& _blockCacheSize)
   : ProcessBase(process::ID::generate("leveldb-storage")),
     path(_path),
-    db(nullptr) {}
+    bloomFilterBitsPerKey(_bloomFilterBitsPerKey),
+    blockCacheSize(_blockCacheSize),
+    db(nullptr),
+    filterPolicy(nullptr),
+    blockCache(nullptr) {}
 
 
 LevelDBStorageProcess::~LevelDBStorageProcess()
 {
   delete db; // nullptr if open failed in LevelDBStorageProcess::initialize.
+
+  // NOTE: Deleted after 'db' since the database references them.
+  delete filterPolicy;
+  delete blockCache;
 }
 
 
@@ -95,6 +125,20 @@ void LevelDBStorageProcess::initialize()
   leveldb::Options options;
   options.create_if_missing = true;
 
+  // Use a bloom filter to avoid the disk reads otherwise needed to
+  // determine that a key is not present.
+  if (bloomFilterBitsPerKey > 0) {
+    filterPolicy = leveldb::NewBloomFilterPolicy(bloomFilterBitsPerKey);
+    options.filter_policy = filterPolicy;
+  }
+
+  // Use a larger than default (8 MB) block cache so that reads of
+  // recently used blocks are served from memory.
+  if (blockCacheSize.bytes() > 0) {
+    blockCache = leveldb::NewLRUCache(blockCacheSize.bytes());
+    options.block_cache = blockCache;
+  }
+
   leveldb::Status status = leveldb::DB::Open(options, path, &db);
 
   if (!status.ok()) {
@@ -181,6 +225,84 @@ Future<bool> LevelDBStorageProcess::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> LevelDBStorageProcess::getAll(
+    const vector<string>& names)
+{
+  if (error.isSome()) {
+    return Failure(error.get());
+  }
+
+  vector<Option<Entry>> options;
+  options.reserve(names.size());
+
+  foreach (const string& name, names) {
+    Try<Option<Entry>> option = read(name);
+
+    if (option.isError()) {
+      return Failure(option.error());
+    }
+
+    options.push_back(option.get());
+  }
+
+  return options;
+}
+
+
+Future<bool> LevelDBStorageProcess::setAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  CHECK_EQ(entries.size(), uuids.size());
+
+  if (error.isSome()) {
+    return Failure(error.get());
+  }
+
+  // Check all the versions before writing anything so that either
+  // all of the entries are set or none of them are. As with 'set',
+  // the reads and the write are inherently "atomic" because only one
+  // db can be opened at a time.
+  for (size_t i = 0; i < entries.size(); i++) {
+    Try<Option<Entry>> option = read(entries[i].name());
+
+    if (option.isError()) {
+      return Failure(option.error());
+    }
+
+    if (option.get().isSome() &&
+        UUID::fromBytes(option.get().get().uuid()).get() != uuids[i]) {
+      return false;
+    }
+  }
+
+  // Write all the entries in a single (synchronous) batch so that
+  // they hit the disk together.
+  leveldb::WriteBatch batch;
+
+  foreach (const Entry& entry, entries) {
+    string value;
+
+    if (!entry.SerializeToString(&value)) {
+      return Failure("Failed to serialize Entry");
+    }
+
+    batch.Put(entry.name(), value);
+  }
+
+  leveldb::WriteOptions options;
+  options.sync = true;
+
+  leveldb::Status status = db->Write(options, &batch);
+
+  if (!status.ok()) {
+    return Failure(status.ToString());
+  }
+
+  return true;
+}
+
+
 Future<bool> LevelDBStorageProcess::expunge(const Entry& entry)
 {
   if (error.isSome()) {
@@ -273,9 +395,13 @@ Try<bool> LevelDBStorageProcess::write(const Entry& entry)
 }
 
 
-LevelDBStorage::LevelDBStorage(const string& path)
+LevelDBStorage::LevelDBStorage(
+    const string& path,
+    size_t bloomFilterBitsPerKey,
+    const Bytes& blockCacheSize)
 {
-  process = new LevelDBStorageProcess(path);
+  process = new LevelDBStorageProcess(
+      path, bloomFilterBitsPerKey, blockCacheSize);
   spawn(process);
 }
 
@@ -300,6 +426,20 @@ Future<bool> LevelDBStorage::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> LevelDBStorage::get(const vector<string>& names)
+{
+  return dispatch(process, &LevelDBStorageProcess::getAll, names);
+}
+
+
+Future<bool> LevelDBStorage::set(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  return dispatch(process, &LevelDBStorageProcess::setAll, entries, uuids);
+}
+
+
 Future<bool> LevelDBStorage::expunge(const Entry& entry)
 {
   return dispatch(process, &LevelDBStorageProcess::expunge, entry);
@@ -21,12 +21,14 @@
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/log/log.hpp>
 
 #include <mesos/state/log.hpp>
 
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
@@ -56,6 +58,7 @@ using namespace process;
 // 'std::' to disambiguate the 'set' member.
 using std::list;
 using std::string;
+using std::vector;
 
 using mesos::log::Log;
 
@@ -77,6 +80,12 @@ namespace state {
 // implying the operation was not atomic and subsequent operations
 // will re-'start()' which will again read all positions to make sure
 // operations are consistent.
+//
+// Optionally, while the writer has not been started, a "standby
+// catch-up" loop periodically replays the entries that the local
+// replica has already learned into the cache, so that 'start()' only
+// needs to read the tail of the log (e.g., so that a newly elected
+// master recovers a mostly warm registry).
 // TODO(benh): Log demotion does not necessarily imply a non-atomic
 // read/modify/write. An alternative strategy might be to retry after
 // restarting via 'start' (and holding on to the mutex so no other
@@ -84,20 +93,43 @@ namespace state {
 class LogStorageProcess : public Process<LogStorageProcess>
 {
 public:
-  LogStorageProcess(Log* log, size_t diffsBetweenSnapshots);
+  LogStorageProcess(
+      Log* log,
+      size_t diffsBetweenSnapshots,
+      const Option<Duration>& standbyCatchupInterval);
 
   virtual ~LogStorageProcess();
 
-  // Storage implementation.
+  // Storage implementation. NOTE: the bulk operations are named
+  // 'getAll' and 'setAll' rather than overloading 'get' and 'set' so
+  // that they can be dispatched to without having to disambiguate the
+  // member function pointers.
   Future<Option<Entry>> get(const string& name);
   Future<bool> set(const Entry& entry, const UUID& uuid);
+  Future<vector<Option<Entry>>> getAll(const vector<string>& names);
+  Future<bool> setAll(const vector<Entry>& entries, const vector<UUID>& uuids);
   Future<bool> expunge(const Entry& entry);
   Future<std::set<string>> names();
 
 protected:
+  virtual void initialize();
   virtual void finalize();
 
 private:
+  // Helpers for the standby catch-up loop: periodically replays the
+  // entries that the local replica has already learned into the
+  // snapshot cache without starting a writer (and thus without
+  // interfering with the current writer, e.g., the leading master).
+  // Note that learned positions are immutable so applying them here
+  // cannot diverge from what a subsequently started writer will read
+  // at the same positions.
+  void catchup();
+  Future<Nothing> _catchup(const Log::Position& beginning);
+  Future<Nothing> __catchup(
+      const Log::Position& beginning,
+      const Log::Position& ending);
+  void ___catchup(const Future<Nothing>& future);
+
   Future<Nothing> start();
   Future<Nothing> _start(const Option<Log::Position>& position);
   Future<Nothing> __start(
@@ -124,6 +156,16 @@ private:
       size_t diff,
       Option<Log::Position> position);
 
+  Future<vector<Option<Entry>>> _getAll(const vector<string>& names);
+
+  Future<bool> _setAll(const vector<Entry>& entries, const vector<UUID>& uuids);
+  Future<bool> __setAll(
+      const vector<Entry>& entries,
+      const vector<UUID>& uuids);
+  Future<bool> ___setAll(
+      const vector<Entry>& entries,
+      const Option<Log::Position>& position);
+
   Future<bool> _expunge(const Entry& entry);
   Future<bool> __expunge(const Entry& entry);
   Future<bool> ___expunge(
@@ -137,6 +179,11 @@ private:
 
   const size_t diffsBetweenSnapshots;
 
+  // If set, the interval at which the standby catch-up loop runs
+  // (see 'catchup' above); the loop stops once the writer has been
+  // started since 'start()' then keeps the cache up to date itself.
+  const Option<Duration> standbyCatchupInterval;
+
   // Used to serialize Log::Writer::append/truncate operations.
   Mutex mutex;
 
@@ -222,16 +269,31 @@ private:
 };
 
 
-LogStorageProcess::LogStorageProcess(Log* log, size_t diffsBetweenSnapshots)
+LogStorageProcess::LogStorageProcess(
+    Log* log,
+    size_t diffsBetweenSnapshots,
+    const Option<Duration>& standbyCatchupInterval)
   : ProcessBase(process::ID::generate("log-storage")),
     reader(log),
     writer(log),
-    diffsBetweenSnapshots(diffsBetweenSnapshots) {}
+    diffsBetweenSnapshots(diffsBetweenSnapshots),
+    standbyCatchupInterval(standbyCatchupInterval) {}
 
 
 LogStorageProcess::~LogStorageProcess() {}
 
 
+void LogStorageProcess::initialize()
+{
+  // Kick off the standby catch-up loop (if enabled) so that by the
+  // time the writer gets started (i.e., this instance starts
+  // leading) only the tail of the log needs to be read.
+  if (standbyCatchupInterval.isSome()) {
+    catchup();
+  }
+}
+
+
 void LogStorageProcess::finalize()
 {
   if (starting.isSome()) {
@@ -240,6 +302,70 @@ void LogStorageProcess::finalize()
 }
 
 
+void LogStorageProcess::catchup()
+{
+  // Once the writer is starting (or has started) the cache is kept
+  // up to date by 'start()' itself and the standby catch-up is no
+  // longer needed.
+  if (starting.isSome()) {
+    return;
+  }
+
+  reader.beginning()
+    .then(defer(self(), &Self::_catchup, lambda::_1))
+    .onAny(defer(self(), &Self::___catchup, lambda::_1));
+}
+
+
+Future<Nothing> LogStorageProcess::_catchup(const Log::Position& beginning)
+{
+  if (starting.isSome()) {
+    return Nothing();
+  }
+
+  return reader.ending()
+    .then(defer(self(), &Self::__catchup, beginning, lambda::_1));
+}
+
+
+Future<Nothing> LogStorageProcess::__catchup(
+    const Log::Position& beginning,
+    const Log::Position& ending)
+{
+  if (starting.isSome()) {
+    return Nothing();
+  }
+
+  if (index.isSome() && index.get() >= ending) {
+    return Nothing(); // Already caught up to the local replica.
+  }
+
+  // Cache the beginning for future truncations; note that 'apply'
+  // sets 'index' and 'start()' expects 'truncated' to be cached
+  // whenever 'index' is.
+  truncated = max(truncated, beginning);
+
+  return reader.read(index.isSome() ? index.get() : beginning, ending)
+    .then(defer(self(), &Self::apply, lambda::_1));
+}
+
+
+void LogStorageProcess::___catchup(const Future<Nothing>& future)
+{
+  if (future.isFailed()) {
+    // Reads may transiently fail, e.g., if the range includes
+    // entries that the local replica has not yet learned; we'll
+    // retry at the next interval.
+    VLOG(2) << "Standby catch-up of the log failed: " << future.failure();
+  }
+
+  if (starting.isNone()) {
+    CHECK_SOME(standbyCatchupInterval);
+    delay(standbyCatchupInterval.get(), self(), &Self::catchup);
+  }
+}
+
+
 Future<Nothing> LogStorageProcess::start()
 {
   if (starting.isSome()) {
@@ -360,6 +486,18 @@ Future<Nothing> LogStorageProcess::apply(const list<Log::Entry>& entries)
           break;
         }
 
+        case Operation::BATCH: {
+          CHECK(operation.has_batch());
+
+          // Each entry in the batch is a full snapshot located at the
+          // position of the batch itself.
+          foreach (const Entry& entry_, operation.batch().entries()) {
+            Snapshot snapshot(entry.position, entry_);
+            snapshots.put(snapshot.entry.name(), snapshot);
+          }
+          break;
+        }
+
         default:
           return Failure("Unknown operation: " + stringify(operation.type()));
       }
@@ -459,6 +597,34 @@ Future<Option<Entry>> LogStorageProcess::_get(const string& name)
 }
 
 
+Future<vector<Option<Entry>>> LogStorageProcess::getAll(
+    const vector<string>& names)
+{
+  return start()
+    .then(defer(self(), &Self::_getAll, names));
+}
+
+
+Future<vector<Option<Entry>>> LogStorageProcess::_getAll(
+    const vector<string>& names)
+{
+  vector<Option<Entry>> options;
+  options.reserve(names.size());
+
+  foreach (const string& name, names) {
+    Option<Snapshot> snapshot = snapshots.get(name);
+
+    if (snapshot.isNone()) {
+      options.push_back(None());
+    } else {
+      options.push_back(snapshot.get().entry);
+    }
+  }
+
+  return options;
+}
+
+
 Future<bool> LogStorageProcess::set(
     const Entry& entry,
     const UUID& uuid)
@@ -582,6 +748,89 @@ Future<bool> LogStorageProcess::___set(
 }
 
 
+Future<bool> LogStorageProcess::setAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  CHECK_EQ(entries.size(), uuids.size());
+
+  return mutex.lock()
+    .then(defer(self(), &Self::_setAll, entries, uuids))
+    .onAny(lambda::bind(&Mutex::unlock, mutex));
+}
+
+
+Future<bool> LogStorageProcess::_setAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  return start()
+    .then(defer(self(), &Self::__setAll, entries, uuids));
+}
+
+
+Future<bool> LogStorageProcess::__setAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  // Check all the versions first so that either all of the entries
+  // are stored or none of them are.
+  for (size_t i = 0; i < entries.size(); i++) {
+    Option<Snapshot> snapshot = snapshots.get(entries[i].name());
+
+    if (snapshot.isSome() &&
+        UUID::fromBytes(snapshot.get().entry.uuid()).get() != uuids[i]) {
+      return false;
+    }
+  }
+
+  // Serialize a single batch operation so that all the entries get
+  // appended (and hence replicated) together. Note that we always
+  // write full snapshots here rather than diffs: the entries share a
+  // single log position so a diff against a snapshot that is part of
+  // a previous batch would not save any truncation.
+  Operation operation;
+  operation.set_type(Operation::BATCH);
+
+  foreach (const Entry& entry, entries) {
+    operation.mutable_batch()->add_entries()->CopyFrom(entry);
+  }
+
+  string value;
+  if (!operation.SerializeToString(&value)) {
+    return Failure("Failed to serialize BATCH Operation");
+  }
+
+  return writer.append(value)
+    .then(defer(self(), &Self::___setAll, entries, lambda::_1));
+}
+
+
+Future<bool> LogStorageProcess::___setAll(
+    const vector<Entry>& entries,
+    const Option<Log::Position>& position)
+{
+  if (position.isNone()) {
+    starting = None(); // Reset 'starting' so we try again.
+    return false;
+  }
+
+  // Update index so we don't bother reading anything before this
+  // position again (if we don't have to).
+  index = max(index, position);
+
+  foreach (const Entry& entry, entries) {
+    Snapshot snapshot(position.get(), entry);
+    snapshots.put(snapshot.entry.name(), snapshot);
+  }
+
+  // And truncate the log if necessary.
+  truncate();
+
+  return true;
+}
+
+
 Future<bool> LogStorageProcess::expunge(const Entry& entry)
 {
   return mutex.lock()
@@ -658,9 +907,16 @@ Future<std::set<string>> LogStorageProcess::_names()
 }
 
 
-LogStorage::LogStorage(Log* log, size_t diffsBetweenSnapshots)
+LogStorage::LogStorage(
+    Log* log,
+    size_t diffsBetweenSnapshots,
+    const Option<Duration>& standbyCatchupInterval)
 {
-  process = new LogStorageProcess(log, diffsBetweenSnapshots);
+  process = new LogStorageProcess(
+      log,
+      diffsBetweenSnapshots,
+      standbyCatchupInterval);
+
   spawn(process);
 }
 
@@ -685,6 +941,20 @@ Future<bool> LogStorage::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> LogStorage::get(const vector<string>& names)
+{
+  return dispatch(process, &LogStorageProcess::getAll, names);
+}
+
+
+Future<bool> LogStorage::set(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  return dispatch(process, &LogStorageProcess::setAll, entries, uuids);
+}
+
+
 Future<bool> LogStorage::expunge(const Entry& entry)
 {
   return dispatch(process, &LogStorageProcess::expunge, entry);
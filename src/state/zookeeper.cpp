@@ -37,7 +37,9 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
+#include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/some.hpp>
@@ -75,9 +77,14 @@ public:
 
   virtual void initialize();
 
-  // Storage implementation.
+  // Storage implementation. NOTE: the bulk operations are named
+  // 'getAll' and 'setAll' rather than overloading 'get' and 'set' so
+  // that they can be dispatched to without having to disambiguate the
+  // member function pointers.
   Future<Option<Entry>> get(const string& name);
   Future<bool> set(const Entry& entry, const UUID& uuid);
+  Future<vector<Option<Entry>>> getAll(const vector<string>& names);
+  Future<bool> setAll(const vector<Entry>& entries, const vector<UUID>& uuids);
   virtual Future<bool> expunge(const Entry& entry);
   Future<std::set<string>> names();
 
@@ -95,8 +102,16 @@ private:
   Result<std::set<string>> doNames();
   Result<Option<Entry>> doGet(const string& name);
   Result<bool> doSet(const Entry& entry, const UUID& uuid);
+  Result<vector<Option<Entry>>> doGetAll(const vector<string>& names);
+  Result<bool> doSetAll(
+      const vector<Entry>& entries,
+      const vector<UUID>& uuids);
   Result<bool> doExpunge(const Entry& entry);
 
+  // Helper for creating the directory path znodes up to (and
+  // including) the storage znode itself.
+  Result<Nothing> createPath();
+
   const string servers;
 
   // The session timeout requested by the client.
@@ -141,6 +156,24 @@ private:
     Promise<bool> promise;
   };
 
+  struct BulkGet
+  {
+    explicit BulkGet(const vector<string>& _names) : names(_names) {}
+
+    vector<string> names;
+    Promise<vector<Option<Entry>>> promise;
+  };
+
+  struct BulkSet
+  {
+    BulkSet(const vector<Entry>& _entries, const vector<UUID>& _uuids)
+      : entries(_entries), uuids(_uuids) {}
+
+    vector<Entry> entries;
+    vector<UUID> uuids;
+    Promise<bool> promise;
+  };
+
   struct Expunge
   {
     explicit Expunge(const Entry& _entry) : entry(_entry) {}
@@ -155,6 +188,8 @@ private:
     queue<Names*> names;
     queue<Get*> gets;
     queue<Set*> sets;
+    queue<BulkGet*> bulkGets;
+    queue<BulkSet*> bulkSets;
     queue<Expunge*> expunges;
   } pending;
 
@@ -199,6 +234,8 @@ ZooKeeperStorageProcess::~ZooKeeperStorageProcess()
   fail(&pending.names, "No longer managing storage");
   fail(&pending.gets, "No longer managing storage");
   fail(&pending.sets, "No longer managing storage");
+  fail(&pending.bulkGets, "No longer managing storage");
+  fail(&pending.bulkSets, "No longer managing storage");
 
   delete zk;
   delete watcher;
@@ -286,6 +323,57 @@ Future<bool> ZooKeeperStorageProcess::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> ZooKeeperStorageProcess::getAll(
+    const vector<string>& names)
+{
+  if (error.isSome()) {
+    return Failure(error.get());
+  } else if (state != CONNECTED) {
+    BulkGet* bulkGet = new BulkGet(names);
+    pending.bulkGets.push(bulkGet);
+    return bulkGet->promise.future();
+  }
+
+  Result<vector<Option<Entry>>> result = doGetAll(names);
+
+  if (result.isNone()) { // Try again later.
+    BulkGet* bulkGet = new BulkGet(names);
+    pending.bulkGets.push(bulkGet);
+    return bulkGet->promise.future();
+  } else if (result.isError()) {
+    return Failure(result.error());
+  }
+
+  return result.get();
+}
+
+
+Future<bool> ZooKeeperStorageProcess::setAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  if (error.isSome()) {
+    return Failure(error.get());
+  } else if (state != CONNECTED) {
+    BulkSet* bulkSet = new BulkSet(entries, uuids);
+    pending.bulkSets.push(bulkSet);
+    return bulkSet->promise.future();
+  }
+
+  Result<bool> result = doSetAll(entries, uuids);
+
+  if (result.isNone()) { // Try again later.
+    BulkSet* bulkSet = new BulkSet(entries, uuids);
+    pending.bulkSets.push(bulkSet);
+    return bulkSet->promise.future();
+  } else if (result.isError()) {
+    return Failure(result.error());
+  }
+
+  return result.get();
+}
+
+
 Future<bool> ZooKeeperStorageProcess::expunge(const Entry& entry)
 {
   if (error.isSome()) {
@@ -374,6 +462,34 @@ void ZooKeeperStorageProcess::connected(int64_t sessionId, bool reconnect)
     pending.sets.pop();
     delete set;
   }
+
+  while (!pending.bulkGets.empty()) {
+    BulkGet* bulkGet = pending.bulkGets.front();
+    Result<vector<Option<Entry>>> result = doGetAll(bulkGet->names);
+    if (result.isNone()) {
+      return; // Try again later.
+    } else if (result.isError()) {
+      bulkGet->promise.fail(result.error());
+    } else {
+      bulkGet->promise.set(result.get());
+    }
+    pending.bulkGets.pop();
+    delete bulkGet;
+  }
+
+  while (!pending.bulkSets.empty()) {
+    BulkSet* bulkSet = pending.bulkSets.front();
+    Result<bool> result = doSetAll(bulkSet->entries, bulkSet->uuids);
+    if (result.isNone()) {
+      return; // Try again later.
+    } else if (result.isError()) {
+      bulkSet->promise.fail(result.error());
+    } else {
+      bulkSet->promise.set(result.get());
+    }
+    pending.bulkSets.pop();
+    delete bulkSet;
+  }
 }
 
 
@@ -501,25 +617,12 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
 
   if (code == ZNONODE) {
     // Create directory path znodes as necessary.
-    CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
-    size_t index = znode.find("/", 0);
+    Result<Nothing> created = createPath();
 
-    while (index < string::npos) {
-      // Get out the prefix to create.
-      index = znode.find("/", index + 1);
-      string prefix = znode.substr(0, index);
-
-      // Create the znode (even if it already exists).
-      code = zk->create(prefix, "", acl, 0, nullptr);
-
-      if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-        CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
-        return None(); // Try again later.
-      } else if (code != ZOK && code != ZNODEEXISTS) {
-        return Error(
-            "Failed to create '" + prefix +
-            "' in ZooKeeper: " + zk->message(code));
-      }
+    if (created.isNone()) {
+      return None(); // Try again later.
+    } else if (created.isError()) {
+      return Error(created.error());
     }
 
     code = zk->create(znode + "/" + entry.name(), data, acl, 0, nullptr);
@@ -575,6 +678,191 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
 }
 
 
+Result<vector<Option<Entry>>> ZooKeeperStorageProcess::doGetAll(
+    const vector<string>& names)
+{
+  CHECK_NONE(error) << ": " << error.get();
+  CHECK(state == CONNECTED);
+
+  if (names.empty()) {
+    return vector<Option<Entry>>();
+  }
+
+  vector<string> paths;
+  paths.reserve(names.size());
+
+  foreach (const string& name, names) {
+    paths.push_back(znode + "/" + name);
+  }
+
+  // Issue all of the reads at once: they get pipelined over the
+  // single ZooKeeper connection, so the fetch latency is bounded by
+  // the slowest read rather than by one round trip per variable.
+  vector<string> results;
+  vector<int> codes = zk->get(paths, false, &results, nullptr);
+
+  vector<Option<Entry>> options;
+  options.reserve(names.size());
+
+  for (size_t i = 0; i < names.size(); i++) {
+    int code = codes[i];
+
+    if (code == ZNONODE) {
+      options.push_back(Option<Entry>::none());
+      continue;
+    } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK) {
+      return Error(
+          "Failed to get '" + paths[i] +
+          "' in ZooKeeper: " + zk->message(code));
+    }
+
+    google::protobuf::io::ArrayInputStream stream(
+        results[i].data(), results[i].size());
+
+    Entry entry;
+
+    if (!entry.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize Entry");
+    }
+
+    options.push_back(Some(entry));
+  }
+
+  return options;
+}
+
+
+Result<bool> ZooKeeperStorageProcess::doSetAll(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  CHECK_NONE(error) << ": " << error.get();
+  CHECK(state == CONNECTED);
+  CHECK_EQ(entries.size(), uuids.size());
+
+  if (entries.empty()) {
+    return true;
+  }
+
+  // First read all the current entries to check the versions and
+  // collect the znode versions that we'll require in the multi-op
+  // below, then do all the creates/sets in a single atomic multi-op.
+  vector<ZooKeeper::Op> ops;
+  ops.reserve(entries.size());
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    // Serialize to make sure we're under the 1 MB limit.
+    string data;
+
+    if (!entries[i].SerializeToString(&data)) {
+      return Error("Failed to serialize Entry");
+    }
+
+    if (data.size() > 1024 * 1024) { // 1 MB
+      // TODO(benh): Use stout/gzip.hpp for compression.
+      return Error("Serialized data is too big (> 1 MB)");
+    }
+
+    string result;
+    Stat stat;
+
+    int code = zk->get(znode + "/" + entries[i].name(), false, &result, &stat);
+
+    if (code == ZNONODE) {
+      // Create directory path znodes as necessary. Note that we can't
+      // create the missing entry znode as part of the multi-op since
+      // a subsequent 'zk->get' for another entry might then fail with
+      // something other than ZNONODE, but creating the directory path
+      // here is idempotent.
+      Result<Nothing> created = createPath();
+
+      if (created.isNone()) {
+        return None(); // Try again later.
+      } else if (created.isError()) {
+        return Error(created.error());
+      }
+
+      ops.push_back(ZooKeeper::Op::create(
+          znode + "/" + entries[i].name(), data, acl, 0));
+
+      continue;
+    } else if (code == ZINVALIDSTATE ||
+               (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK) {
+      return Error(
+          "Failed to get '" + znode + "/" + entries[i].name() +
+          "' in ZooKeeper: " + zk->message(code));
+    }
+
+    google::protobuf::io::ArrayInputStream stream(
+        result.data(), result.size());
+
+    Entry current;
+
+    if (!current.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize Entry");
+    }
+
+    if (UUID::fromBytes(current.uuid()).get() != uuids[i]) {
+      return false;
+    }
+
+    // We get atomicity by requiring 'stat.version' in the multi-op.
+    ops.push_back(ZooKeeper::Op::set(
+        znode + "/" + entries[i].name(), data, stat.version));
+  }
+
+  // Okay, do all the creates/sets at once: either every op succeeds
+  // or none of them do.
+  int code = zk->multi(ops);
+
+  if (code == ZBADVERSION || code == ZNODEEXISTS || code == ZNONODE) {
+    return false; // Lost a race with someone else.
+  } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+    CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+    return None(); // Try again later.
+  } else if (code != ZOK) {
+    return Error(
+        "Failed to set entries below '" + znode +
+        "' in ZooKeeper: " + zk->message(code));
+  }
+
+  return true;
+}
+
+
+Result<Nothing> ZooKeeperStorageProcess::createPath()
+{
+  CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
+  size_t index = znode.find("/", 0);
+
+  while (index < string::npos) {
+    // Get out the prefix to create.
+    index = znode.find("/", index + 1);
+    string prefix = znode.substr(0, index);
+
+    // Create the znode (even if it already exists).
+    int code = zk->create(prefix, "", acl, 0, nullptr);
+
+    if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK && code != ZNODEEXISTS) {
+      return Error(
+          "Failed to create '" + prefix +
+          "' in ZooKeeper: " + zk->message(code));
+    }
+  }
+
+  return Nothing();
+}
+
+
 Result<bool> ZooKeeperStorageProcess::doExpunge(const Entry& entry)
 {
   CHECK_NONE(error) << ": " << error.get();
@@ -658,6 +946,20 @@ Future<bool> ZooKeeperStorage::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<vector<Option<Entry>>> ZooKeeperStorage::get(const vector<string>& names)
+{
+  return dispatch(process, &ZooKeeperStorageProcess::getAll, names);
+}
+
+
+Future<bool> ZooKeeperStorage::set(
+    const vector<Entry>& entries,
+    const vector<UUID>& uuids)
+{
+  return dispatch(process, &ZooKeeperStorageProcess::setAll, entries, uuids);
+}
+
+
 Future<bool> ZooKeeperStorage::expunge(const Entry& entry)
 {
   return dispatch(process, &ZooKeeperStorageProcess::expunge, entry);
@@ -692,6 +692,48 @@ TEST_F(AuthenticationTest, LeaderElectionDuringSlaveAuthentication)
 }
 
 
+// This test verifies that without an encrypted channel the master
+// does not hand out re-authentication tokens (they are bearer
+// credentials and must not cross the wire in cleartext), and that
+// the agent consequently re-authenticates with the full SASL
+// exchange.
+TEST_F(AuthenticationTest, NoAuthenticationTokenWithoutEncryption)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  EXPECT_NO_FUTURE_PROTOBUFS(AuthenticationTokenMessage(), _, _);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Future<AuthenticateMessage> authenticateMessage =
+    FUTURE_PROTOBUF(AuthenticateMessage(), _, _);
+
+  // Re-authentication should run the full SASL exchange.
+  Future<AuthenticationMechanismsMessage> mechanismsMessage =
+    FUTURE_PROTOBUF(AuthenticationMechanismsMessage(), _, _);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, _);
+
+  // Appoint the same master again, which triggers re-authentication.
+  detector.appoint(master.get()->pid);
+
+  AWAIT_READY(authenticateMessage);
+  EXPECT_FALSE(authenticateMessage.get().has_token());
+
+  AWAIT_READY(mechanismsMessage);
+  AWAIT_READY(slaveReregisteredMessage);
+}
+
+
 // This test verifies that if a scheduler fails over in the midst of
 // authentication it successfully re-authenticates and re-registers
 // with the master when it comes back up.
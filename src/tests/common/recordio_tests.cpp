@@ -159,3 +159,29 @@ TEST(RecordIOReaderTest, PipeFailure)
   // Subsequent reads should return a failure.
   AWAIT_EXPECT_FAILED(reader.read());
 }
+
+
+// Tests that records written with 'recordio::write' (which writes
+// the length header and the payload as separate pipe chunks) decode
+// the same as records encoded into contiguous frames.
+TEST(RecordIOWriteTest, Write)
+{
+  process::http::Pipe pipe;
+
+  EXPECT_TRUE(internal::recordio::write(pipe.writer(), string("HELLO")));
+  EXPECT_TRUE(internal::recordio::write(pipe.writer(), string("WORLD!")));
+
+  internal::recordio::Reader<string> reader(
+      ::recordio::Decoder<string>(strings::lower),
+      pipe.reader());
+
+  AWAIT_EXPECT_EQ(Result<string>::some("hello"), reader.read());
+  AWAIT_EXPECT_EQ(Result<string>::some("world!"), reader.read());
+
+  pipe.writer().close();
+
+  AWAIT_EXPECT_EQ(Result<string>::none(), reader.read());
+
+  // Writes to a closed pipe should be rejected.
+  EXPECT_FALSE(internal::recordio::write(pipe.writer(), string("goodbye")));
+}
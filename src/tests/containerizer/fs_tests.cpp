@@ -217,6 +217,53 @@ TEST_F(FsTest, MountInfoTableReadSortedParentOfSelf)
 }
 
 
+TEST_F(FsTest, ROOT_CachedMountInfoTableRead)
+{
+  string directory = os::getcwd();
+
+  // The cached table should match a direct read of the mount table.
+  Try<MountInfoTable> cached = MountInfoTable::cachedRead();
+  ASSERT_SOME(cached);
+
+  Try<MountInfoTable> table = MountInfoTable::read();
+  ASSERT_SOME(table);
+
+  EXPECT_EQ(table->entries.size(), cached->entries.size());
+
+  // Do a self bind mount of the temporary directory and verify that
+  // the cache is invalidated, i.e., the new mount is visible.
+  ASSERT_SOME(fs::mount(directory, directory, None(), MS_BIND, None()));
+
+  cached = MountInfoTable::cachedRead();
+  ASSERT_SOME(cached);
+
+  Option<MountInfoTable::Entry> entry;
+  foreach (const MountInfoTable::Entry& _entry, cached->entries) {
+    if (_entry.target == directory) {
+      entry = _entry;
+    }
+  }
+
+  EXPECT_SOME(entry);
+
+  // Clean up the mount and verify that it disappears from the cached
+  // table as well.
+  EXPECT_SOME(fs::unmount(directory));
+
+  cached = MountInfoTable::cachedRead();
+  ASSERT_SOME(cached);
+
+  entry = None();
+  foreach (const MountInfoTable::Entry& _entry, cached->entries) {
+    if (_entry.target == directory) {
+      entry = _entry;
+    }
+  }
+
+  EXPECT_NONE(entry);
+}
+
+
 TEST_F(FsTest, ROOT_SharedMount)
 {
   string directory = os::getcwd();
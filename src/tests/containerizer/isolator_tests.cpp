@@ -169,7 +169,7 @@ TEST_F(SharedFilesystemIsolatorTest, DISABLED_ROOT_RelativeVolume)
   args.push_back(
       prepare.get().get().pre_exec_commands(0).value() + " && touch " + file);
 
-  Try<pid_t> pid = launcher->fork(
+  Future<pid_t> pid = launcher->fork(
       containerId,
       "sh",
       args,
@@ -179,7 +179,7 @@ TEST_F(SharedFilesystemIsolatorTest, DISABLED_ROOT_RelativeVolume)
       nullptr,
       None(),
       prepare.get().get().namespaces());
-  ASSERT_SOME(pid);
+  AWAIT_READY(pid);
 
   // Set up the reaper to wait on the forked child.
   Future<Option<int>> status = process::reap(pid.get());
@@ -275,7 +275,7 @@ TEST_F(SharedFilesystemIsolatorTest, DISABLED_ROOT_AbsoluteVolume)
                  " && touch " +
                  path::join(containerPath, filename));
 
-  Try<pid_t> pid = launcher->fork(
+  Future<pid_t> pid = launcher->fork(
       containerId,
       "sh",
       args,
@@ -285,7 +285,7 @@ TEST_F(SharedFilesystemIsolatorTest, DISABLED_ROOT_AbsoluteVolume)
       nullptr,
       None(),
       prepare.get().get().namespaces());
-  ASSERT_SOME(pid);
+  AWAIT_READY(pid);
 
   // Set up the reaper to wait on the forked child.
   Future<Option<int>> status = process::reap(pid.get());
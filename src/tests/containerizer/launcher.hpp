@@ -58,7 +58,7 @@ public:
 
   MOCK_METHOD10(
       fork,
-      Try<pid_t>(
+      process::Future<pid_t>(
           const ContainerID& containerId,
           const std::string& path,
           const std::vector<std::string>& argv,
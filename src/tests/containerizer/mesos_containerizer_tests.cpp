@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <iostream>
 #include <list>
 #include <map>
 #include <string>
@@ -30,7 +32,9 @@
 #include <process/owned.hpp>
 #include <process/shared.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/net.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 #include <stout/uuid.hpp>
 
@@ -79,6 +83,8 @@ using mesos::slave::ContainerState;
 using mesos::slave::ContainerTermination;
 using mesos::slave::Isolator;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::map;
 using std::string;
@@ -88,6 +94,7 @@ using testing::_;
 using testing::DoAll;
 using testing::Invoke;
 using testing::Return;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -1351,7 +1358,7 @@ TEST_F(MesosLauncherStatusTest, ExecutorPIDTest)
   ContainerID invalidContainerId;
   invalidContainerId.set_value(UUID::random().toString());
 
-  Try<pid_t> forked = launcher.get()->fork(
+  Future<pid_t> forked = launcher.get()->fork(
       containerId,
       path::join(flags.launcher_dir, MESOS_CONTAINERIZER),
       vector<string>(),
@@ -1362,7 +1369,7 @@ TEST_F(MesosLauncherStatusTest, ExecutorPIDTest)
       None(),
       None());
 
-  ASSERT_SOME(forked);
+  AWAIT_READY(forked);
 
   Future<ContainerStatus> validStatus = launcher.get()->status(containerId);
 
@@ -1407,6 +1414,133 @@ TEST_F(MesosContainerizerWaitTest, WaitUnknownContainer)
   EXPECT_NONE(wait.get());
 }
 
+
+// Returns the given percentile of a sorted list of durations.
+static Duration percentile(const vector<Duration>& durations, size_t percent)
+{
+  CHECK(!durations.empty());
+
+  size_t index =
+    std::min(durations.size() - 1, (durations.size() * percent) / 100);
+
+  return durations[index];
+}
+
+
+class MesosContainerizerLaunch_BENCHMARK_Test
+  : public ContainerizerTest<slave::MesosContainerizer>,
+    public WithParamInterface<std::tr1::tuple<size_t, const char*>> {};
+
+
+// The launch benchmark is parameterized by the number of containers
+// and the isolation flag to exercise, so that the cost of individual
+// isolator sets (e.g., with and without a filesystem isolator) can
+// be compared across releases.
+INSTANTIATE_TEST_CASE_P(
+    ContainerCountAndIsolation,
+    MesosContainerizerLaunch_BENCHMARK_Test,
+    ::testing::Combine(
+        ::testing::Values(10U, 50U),
+        ::testing::Values(
+            "posix/cpu,posix/mem",
+            "filesystem/posix,posix/cpu,posix/mem")));
+
+
+// Measures end-to-end launch and destroy latencies through the
+// containerizer (launch -> wait -> destroy) and reports the p50 and
+// p99 of each, which is how we track launch latency regressions.
+TEST_P(MesosContainerizerLaunch_BENCHMARK_Test, LaunchDestroy)
+{
+  size_t containerCount = std::tr1::get<0>(GetParam());
+  string isolation = std::tr1::get<1>(GetParam());
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+  flags.isolation = isolation;
+
+  Fetcher fetcher;
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher);
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  SlaveState state;
+  state.id = SlaveID();
+
+  AWAIT_READY(containerizer->recover(state));
+
+  cout << "Launching " << containerCount << " containers"
+       << " with isolation '" << isolation << "'" << endl;
+
+  vector<ContainerID> containerIds;
+  containerIds.reserve(containerCount);
+
+  vector<Duration> launchLatencies;
+  launchLatencies.reserve(containerCount);
+
+  for (size_t i = 0; i < containerCount; i++) {
+    ContainerID containerId;
+    containerId.set_value(UUID::random().toString());
+    containerIds.push_back(containerId);
+
+    Try<string> directory = environment->mkdtemp();
+    ASSERT_SOME(directory);
+
+    Stopwatch watch;
+    watch.start();
+
+    Future<bool> launch = containerizer->launch(
+        containerId,
+        None(),
+        createExecutorInfo("executor", "sleep 1000", "cpus:0.1"),
+        directory.get(),
+        None(),
+        SlaveID(),
+        map<string, string>(),
+        true);
+
+    AWAIT_ASSERT_TRUE(launch);
+
+    watch.stop();
+    launchLatencies.push_back(watch.elapsed());
+  }
+
+  vector<Duration> destroyLatencies;
+  destroyLatencies.reserve(containerCount);
+
+  foreach (const ContainerID& containerId, containerIds) {
+    Future<Option<ContainerTermination>> wait =
+      containerizer->wait(containerId);
+
+    Stopwatch watch;
+    watch.start();
+
+    containerizer->destroy(containerId);
+
+    AWAIT_READY(wait);
+    ASSERT_SOME(wait.get());
+
+    watch.stop();
+    destroyLatencies.push_back(watch.elapsed());
+  }
+
+  std::sort(launchLatencies.begin(), launchLatencies.end());
+  std::sort(destroyLatencies.begin(), destroyLatencies.end());
+
+  cout << "Launch latency for " << containerCount << " containers"
+       << ": p50 " << percentile(launchLatencies, 50)
+       << ", p99 " << percentile(launchLatencies, 99) << endl;
+
+  cout << "Destroy latency for " << containerCount << " containers"
+       << ": p50 " << percentile(destroyLatencies, 50)
+       << ", p99 " << percentile(destroyLatencies, 99) << endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
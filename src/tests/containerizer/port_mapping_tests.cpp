@@ -338,7 +338,7 @@ protected:
     argv[0] = MESOS_CONTAINERIZER;
     argv[1] = MesosContainerizerLaunch::NAME;
 
-    Try<pid_t> pid = launcher->fork(
+    Future<pid_t> pid = launcher->fork(
         containerId,
         path::join(flags.launcher_dir, MESOS_CONTAINERIZER),
         argv,
@@ -349,7 +349,13 @@ protected:
         None(),
         CLONE_NEWNET | CLONE_NEWNS);
 
-    return pid;
+    pid.await();
+
+    if (!pid.isReady()) {
+      return Error(pid.isFailed() ? pid.failure() : "Fork discarded");
+    }
+
+    return pid.get();
   }
 
   Result<ResourceStatistics> statisticsHelper(
@@ -360,7 +366,7 @@ protected:
   {
     // Retrieve the socket information from inside the container.
     PortMappingStatistics statistics;
-    statistics.flags.pid = pid;
+    statistics.flags.pids = stringify(pid);
     statistics.flags.eth0_name = eth0;
     statistics.flags.enable_socket_statistics_summary = enable_summary;
     statistics.flags.enable_socket_statistics_details = enable_details;
@@ -392,7 +398,15 @@ protected:
     Try<JSON::Object> object = JSON::parse<JSON::Object>(out.get());
     CHECK_SOME(object);
 
-    return ::protobuf::parse<ResourceStatistics>(object.get());
+    // The statistics subcommand outputs one entry per container pid.
+    Result<JSON::Object> value =
+      object.get().find<JSON::Object>(stringify(pid));
+
+    if (!value.isSome()) {
+      return Error("No statistics found for pid " + stringify(pid));
+    }
+
+    return ::protobuf::parse<ResourceStatistics>(value.get());
   }
 
   slave::Flags flags;
@@ -328,9 +328,9 @@ TEST_F(ProvisionerAppcTest, ROOT_Provision)
   ASSERT_SOME(rootfses);
 
   // Verify that the rootfs is successfully provisioned.
-  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend));
-  ASSERT_EQ(1u, rootfses->get(flags.image_provisioner_backend)->size());
-  EXPECT_EQ(*rootfses->get(flags.image_provisioner_backend)->begin(),
+  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend.get()));
+  ASSERT_EQ(1u, rootfses->get(flags.image_provisioner_backend.get())->size());
+  EXPECT_EQ(*rootfses->get(flags.image_provisioner_backend.get())->begin(),
             Path(provisionInfo.get().rootfs).basename());
 
   Future<bool> destroy = provisioner.get()->destroy(containerId);
@@ -396,9 +396,9 @@ TEST_F(ProvisionerAppcTest, ROOT_ProvisionNestedContainer)
   ASSERT_SOME(rootfses);
 
   // Verify that the rootfs is successfully provisioned.
-  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend));
-  ASSERT_EQ(1u, rootfses->get(flags.image_provisioner_backend)->size());
-  EXPECT_EQ(*rootfses->get(flags.image_provisioner_backend)->begin(),
+  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend.get()));
+  ASSERT_EQ(1u, rootfses->get(flags.image_provisioner_backend.get())->size());
+  EXPECT_EQ(*rootfses->get(flags.image_provisioner_backend.get())->begin(),
             Path(provisionInfo.get().rootfs).basename());
 
   // TODO(jieyu): Verify that 'containerDir' is nested under its
@@ -473,8 +473,8 @@ TEST_F(ProvisionerAppcTest, Recover)
   ASSERT_SOME(rootfses);
 
   // Verify that the rootfs is successfully provisioned.
-  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend));
-  EXPECT_EQ(2u, rootfses->get(flags.image_provisioner_backend)->size());
+  ASSERT_TRUE(rootfses->contains(flags.image_provisioner_backend.get()));
+  EXPECT_EQ(2u, rootfses->get(flags.image_provisioner_backend.get())->size());
 
   Future<bool> destroy = provisioner.get()->destroy(containerId);
   AWAIT_READY(destroy);
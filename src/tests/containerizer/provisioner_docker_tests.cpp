@@ -28,6 +28,8 @@
 
 #include <mesos/docker/spec.hpp>
 
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/metadata_manager.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/puller.hpp"
@@ -76,15 +78,17 @@ public:
       const vector<string>& layers)
   {
     // Verify contents of the image in store directory.
+    // The store lays out the layers for the 'copy' backend when the
+    // backend is left unset; see docker::Store.
     const string layerPath1 = paths::getImageLayerRootfsPath(
         flags.docker_store_dir,
         "123",
-        flags.image_provisioner_backend);
+        flags.image_provisioner_backend.getOrElse(slave::COPY_BACKEND));
 
     const string layerPath2 = paths::getImageLayerRootfsPath(
         flags.docker_store_dir,
         "456",
-        flags.image_provisioner_backend);
+        flags.image_provisioner_backend.getOrElse(slave::COPY_BACKEND));
 
     EXPECT_TRUE(os::exists(layerPath1));
     EXPECT_TRUE(os::exists(layerPath2));
@@ -613,6 +613,7 @@ TEST_F(ROOT_XFS_QuotaTest, NoCheckpointRecovery)
       "*",
       "executors",
       "*",
+      "*",
       "runs",
       "*"));
 
@@ -719,6 +720,7 @@ TEST_F(ROOT_XFS_QuotaTest, CheckpointRecovery)
       "*",
       "executors",
       "*",
+      "*",
       "runs",
       "*"));
 
@@ -253,6 +253,151 @@ TYPED_TEST(LogStorageTest, Truncate)
 }
 
 
+TYPED_TEST(LogStorageTest, PersistMany)
+{
+  TypeParam storage;
+
+  Try<Storage::State> state = storage.restore(os::getcwd() + "/.log");
+  ASSERT_SOME(state);
+
+  // Append from position 0 to position 9 in a single batch,
+  // including a learned truncate to position 3.
+  std::list<Action> actions;
+
+  for (uint64_t i = 0; i < 10; i++) {
+    Action action;
+    action.set_position(i);
+    action.set_promised(1);
+    action.set_performed(1);
+    action.set_learned(true);
+    action.set_type(Action::APPEND);
+    action.mutable_append()->set_bytes(stringify(i));
+
+    actions.push_back(action);
+  }
+
+  Action truncate;
+  truncate.set_position(10);
+  truncate.set_promised(1);
+  truncate.set_performed(1);
+  truncate.set_learned(true);
+  truncate.set_type(Action::TRUNCATE);
+  truncate.mutable_truncate()->set_to(3);
+
+  actions.push_back(truncate);
+
+  ASSERT_SOME(storage.persist(actions));
+
+  for (uint64_t i = 0; i < 11; i++) {
+    Try<Action> action = storage.read(i);
+
+    if (i < 3) {
+      // Position 0, 1 and 2 have been truncated.
+      EXPECT_ERROR(action);
+    } else if (i == 10) {
+      // Position 10 is a truncate.
+      EXPECT_EQ(i, action.get().position());
+      EXPECT_EQ(Action::TRUNCATE, action.get().type());
+      ASSERT_TRUE(action.get().has_truncate());
+      EXPECT_EQ(3u, action.get().truncate().to());
+    } else {
+      EXPECT_EQ(i, action.get().position());
+      EXPECT_EQ(Action::APPEND, action.get().type());
+      ASSERT_TRUE(action.get().has_append());
+      EXPECT_EQ(stringify(i), action.get().append().bytes());
+    }
+  }
+}
+
+
+TYPED_TEST(LogStorageTest, Restore)
+{
+  // Write some actions and metadata, then restore the log with a
+  // fresh storage instance and verify that the recovered state
+  // matches what was persisted.
+  {
+    TypeParam storage;
+
+    Try<Storage::State> state = storage.restore(os::getcwd() + "/.log");
+    ASSERT_SOME(state);
+
+    Metadata metadata;
+    metadata.set_status(Metadata::VOTING);
+    metadata.set_promised(8);
+
+    ASSERT_SOME(storage.persist(metadata));
+
+    // Append from position 0 to position 9.
+    for (uint64_t i = 0; i < 10; i++) {
+      Action action;
+      action.set_position(i);
+      action.set_promised(1);
+      action.set_performed(1);
+      action.set_learned(true);
+      action.set_type(Action::APPEND);
+      action.mutable_append()->set_bytes(stringify(i));
+
+      ASSERT_SOME(storage.persist(action));
+    }
+
+    // Truncate to position 3 (at position 10).
+    Action truncate;
+    truncate.set_position(10);
+    truncate.set_promised(1);
+    truncate.set_performed(1);
+    truncate.set_learned(true);
+    truncate.set_type(Action::TRUNCATE);
+    truncate.mutable_truncate()->set_to(3);
+
+    ASSERT_SOME(storage.persist(truncate));
+
+    // An unlearned write at position 11.
+    Action action;
+    action.set_position(11);
+    action.set_promised(1);
+    action.set_performed(1);
+    action.set_type(Action::APPEND);
+    action.mutable_append()->set_bytes(stringify(11));
+
+    ASSERT_SOME(storage.persist(action));
+  }
+
+  TypeParam storage;
+
+  Try<Storage::State> state = storage.restore(os::getcwd() + "/.log");
+  ASSERT_SOME(state);
+
+  EXPECT_EQ(Metadata::VOTING, state.get().metadata.status());
+  EXPECT_EQ(8u, state.get().metadata.promised());
+  EXPECT_EQ(3u, state.get().begin);
+  EXPECT_EQ(11u, state.get().end);
+
+  for (uint64_t i = 0; i < 3; i++) {
+    // Position 0, 1 and 2 have been truncated.
+    EXPECT_FALSE(state.get().learned.contains(i));
+    EXPECT_FALSE(state.get().unlearned.contains(i));
+  }
+
+  for (uint64_t i = 3; i < 11; i++) {
+    EXPECT_TRUE(state.get().learned.contains(i));
+    EXPECT_FALSE(state.get().unlearned.contains(i));
+  }
+
+  EXPECT_FALSE(state.get().learned.contains(11u));
+  EXPECT_TRUE(state.get().unlearned.contains(11u));
+
+  for (uint64_t i = 3; i < 10; i++) {
+    Try<Action> action = storage.read(i);
+    ASSERT_SOME(action);
+
+    EXPECT_EQ(i, action.get().position());
+    EXPECT_EQ(Action::APPEND, action.get().type());
+    ASSERT_TRUE(action.get().has_append());
+    EXPECT_EQ(stringify(i), action.get().append().bytes());
+  }
+}
+
+
 TYPED_TEST(LogStorageTest, TruncateWithEmptyLog)
 {
   TypeParam storage;
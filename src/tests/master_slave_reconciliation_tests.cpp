@@ -448,10 +448,20 @@ TEST_F(MasterSlaveReconciliationTest, ReconcileRace)
       slave.get()->pid,
       master.get()->pid);
 
+  // The captured re-registration is a delta: it carries a (now
+  // stale) fingerprint of the agent's state instead of the state
+  // itself. Clear the fingerprint so that the master treats the
+  // replay as a full re-registration, as sent by an agent predating
+  // the delta handshake; a stale delta would instead make the master
+  // ask the agent for its full state.
+  ReregisterSlaveMessage staleReregisterSlaveMessage =
+    reregisterSlaveMessage.get();
+  staleReregisterSlaveMessage.clear_state_fingerprint();
+
   process::post(
       slave.get()->pid,
       master.get()->pid,
-      reregisterSlaveMessage.get());
+      staleReregisterSlaveMessage);
 
   AWAIT_READY(slaveReregisteredMessage);
 
@@ -694,19 +704,48 @@ TEST_F(MasterSlaveReconciliationTest, SlaveReregisterFrameworks)
   AWAIT_READY(status);
   EXPECT_EQ(TASK_RUNNING, status.get().state());
 
-  Future<ReregisterSlaveMessage> reregisterSlave =
-    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
+  // Keep the agent disconnected so that we can ask it for its full
+  // state below, and pause the clock so that it does not retry the
+  // re-registration on its own in the meantime.
+  Clock::pause();
+
+  DROP_PROTOBUFS(
+      SlaveReregisteredMessage(), master.get()->pid, slave.get()->pid);
+
+  Future<ReregisterSlaveMessage> deltaReregisterSlave =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveMessage(), slave.get()->pid, master.get()->pid);
 
   // Simulate a spurious master change event (e.g., due to ZooKeeper
   // expiration) at the slave to force re-registration.
   detector.appoint(master.get()->pid);
 
+  // Re-registering with the same master only carries a fingerprint
+  // of the agent's state; see
+  // `ReregisterSlaveMessage.state_fingerprint`.
+  AWAIT_READY(deltaReregisterSlave);
+  EXPECT_TRUE(deltaReregisterSlave.get().has_state_fingerprint());
+  EXPECT_EQ(0, deltaReregisterSlave.get().frameworks().size());
+
+  Future<ReregisterSlaveMessage> reregisterSlave =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveMessage(), slave.get()->pid, master.get()->pid);
+
+  // Ask the agent for its full state, as the master does when the
+  // fingerprint does not match its own view of the agent.
+  process::post(
+      master.get()->pid,
+      slave.get()->pid,
+      ReregisterSlaveFullStateMessage());
+
   // Expect to receive the 'ReregisterSlaveMessage' containing the
   // active frameworks.
   AWAIT_READY(reregisterSlave);
 
   EXPECT_EQ(1u, reregisterSlave.get().frameworks().size());
 
+  Clock::resume();
+
   EXPECT_CALL(exec, shutdown(_))
     .Times(AtMost(1));
 
@@ -714,6 +753,259 @@ TEST_F(MasterSlaveReconciliationTest, SlaveReregisterFrameworks)
   driver.join();
 }
 
+
+// This test verifies the delta re-registration fast path: an agent
+// that re-registers with the same master sends only a fingerprint of
+// its task and executor state. When the fingerprint matches the
+// master's view of the agent, the master re-admits the agent without
+// asking for its full state, and still re-sends the framework pids.
+TEST_F(MasterSlaveReconciliationTest, DeltaReregistration)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, 1, 1, 512, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  // Wait until the acknowledgement reaches the slave, so that no
+  // status update retry races with the re-registration below.
+  Future<StatusUpdateAcknowledgementMessage> statusUpdateAcknowledgementMessage
+    = FUTURE_PROTOBUF(
+        StatusUpdateAcknowledgementMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  driver.start();
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  AWAIT_READY(statusUpdateAcknowledgementMessage);
+
+  // The fingerprints match, so the master must not ask the agent for
+  // its full state.
+  EXPECT_NO_FUTURE_PROTOBUFS(ReregisterSlaveFullStateMessage(), _, _);
+
+  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveMessage(), slave.get()->pid, master.get()->pid);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(
+        SlaveReregisteredMessage(), master.get()->pid, slave.get()->pid);
+
+  Future<UpdateFrameworkMessage> updateFrameworkMessage =
+    FUTURE_PROTOBUF(
+        UpdateFrameworkMessage(), master.get()->pid, slave.get()->pid);
+
+  // Simulate a spurious master change event (e.g., due to ZooKeeper
+  // expiration) at the slave to force re-registration.
+  detector.appoint(master.get()->pid);
+
+  AWAIT_READY(reregisterSlaveMessage);
+
+  // The agent should have sent only the fingerprint of its state.
+  EXPECT_TRUE(reregisterSlaveMessage.get().has_state_fingerprint());
+  EXPECT_EQ(0, reregisterSlaveMessage.get().tasks_size());
+  EXPECT_EQ(0, reregisterSlaveMessage.get().executor_infos_size());
+  EXPECT_EQ(0, reregisterSlaveMessage.get().frameworks_size());
+
+  AWAIT_READY(slaveReregisteredMessage);
+
+  // The framework pid is re-sent even on the fast path.
+  AWAIT_READY(updateFrameworkMessage);
+
+  // The master's view of the task is intact: implicit reconciliation
+  // reports it as running.
+  Future<TaskStatus> reconciled;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&reconciled));
+
+  driver.reconcileTasks({});
+
+  AWAIT_READY(reconciled);
+  EXPECT_EQ(status.get().task_id(), reconciled.get().task_id());
+  EXPECT_EQ(TASK_RUNNING, reconciled.get().state());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that a delta re-registration whose fingerprint
+// does not match the master's view of the agent falls back to a full
+// re-registration. We drop a RunTaskMessage so that only the master
+// knows about the task; the full re-registration then goes through
+// the usual reconciliation, which marks the task lost.
+TEST_F(MasterSlaveReconciliationTest, DeltaReregistrationFingerprintMismatch)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task;
+  task.set_name("test task");
+  task.mutable_task_id()->set_value("1");
+  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
+  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  // We now launch a task and drop the corresponding RunTaskMessage on
+  // the slave, to ensure that only the master knows about this task.
+  Future<RunTaskMessage> runTaskMessage =
+    DROP_PROTOBUF(RunTaskMessage(), _, _);
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(runTaskMessage);
+
+  // NOTE: Expectations are matched newest first, so the delta
+  // re-registration attempt, which arrives first, is declared last.
+  Future<ReregisterSlaveMessage> fullReregisterSlaveMessage =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveMessage(), slave.get()->pid, master.get()->pid);
+
+  Future<ReregisterSlaveMessage> deltaReregisterSlaveMessage =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveMessage(), slave.get()->pid, master.get()->pid);
+
+  Future<ReregisterSlaveFullStateMessage> fullStateRequest =
+    FUTURE_PROTOBUF(
+        ReregisterSlaveFullStateMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, _);
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  // Simulate a spurious master change event (e.g., due to ZooKeeper
+  // expiration) at the slave to force re-registration.
+  detector.appoint(master.get()->pid);
+
+  AWAIT_READY(deltaReregisterSlaveMessage);
+  EXPECT_TRUE(deltaReregisterSlaveMessage.get().has_state_fingerprint());
+  EXPECT_EQ(0, deltaReregisterSlaveMessage.get().tasks_size());
+
+  // The master's view contains the dropped task, so it asks the
+  // agent for its full state.
+  AWAIT_READY(fullStateRequest);
+
+  AWAIT_READY(fullReregisterSlaveMessage);
+  EXPECT_FALSE(fullReregisterSlaveMessage.get().has_state_fingerprint());
+
+  AWAIT_READY(slaveReregisteredMessage);
+
+  // The full re-registration went through the usual reconciliation,
+  // which declares the dropped task lost.
+  AWAIT_READY(status);
+  EXPECT_EQ(task.task_id(), status.get().task_id());
+  EXPECT_EQ(TASK_LOST, status.get().state());
+  EXPECT_EQ(TaskStatus::SOURCE_SLAVE, status.get().source());
+  EXPECT_EQ(TaskStatus::REASON_RECONCILIATION, status.get().reason());
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that an agent does not attempt a delta
+// re-registration against a master that has not acknowledged one of
+// its (re-)registrations, e.g., after a master failover: only the
+// acknowledging master is known to hold the agent's state. The same
+// rule keeps agents talking to old masters, which never advertise
+// support via `MasterSlaveConnection`, on the full re-registration
+// path.
+TEST_F(MasterSlaveReconciliationTest, NoDeltaReregistrationAfterMasterFailover)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  // Simulate a failed over master by restarting the master.
+  master->reset();
+  master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, master.get()->pid);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, _);
+
+  // Simulate a new master detected event on the slave.
+  detector.appoint(master.get()->pid);
+
+  AWAIT_READY(reregisterSlaveMessage);
+
+  // The new master never acknowledged one of this agent's
+  // (re-)registrations, so the agent must not attempt the delta
+  // handshake even though the previous master supported it.
+  EXPECT_FALSE(reregisterSlaveMessage.get().has_state_fingerprint());
+
+  AWAIT_READY(slaveReregisteredMessage);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
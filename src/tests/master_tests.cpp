@@ -47,6 +47,7 @@
 #include <stout/try.hpp>
 
 #include "common/build.hpp"
+#include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
 
 #include "master/flags.hpp"
@@ -97,6 +98,7 @@ using process::Promise;
 
 using process::http::OK;
 using process::http::Response;
+using process::http::ServiceUnavailable;
 using process::http::Unauthorized;
 
 using std::shared_ptr;
@@ -107,6 +109,7 @@ using testing::_;
 using testing::AtMost;
 using testing::DoAll;
 using testing::Eq;
+using testing::InvokeWithoutArgs;
 using testing::Not;
 using testing::Return;
 using testing::SaveArg;
@@ -5333,6 +5336,232 @@ TEST_F(MasterTest, RecoverResourcesOrphanedTask)
     .Times(AtMost(1));
 }
 
+
+// This test verifies that a framework with more tasks than
+// `REMOVE_FRAMEWORK_TASKS_PER_DISPATCH` is removed in chunks: the
+// framework stays registered but deactivated between chunks, during
+// which re-subscription under the same framework id is refused, and
+// the removal completes once the remaining chunks have run.
+TEST_F(MasterTest, RemoveFrameworkManyTasks)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  // Enough resources on the agent for all of the tasks below.
+  slave::Flags flags = CreateSlaveFlags();
+  flags.resources = "cpus:16;mem:2048;disk:1024;ports:[31000-32000]";
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer, flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  // One task more than fits in a single removal dispatch.
+  const size_t numTasks = master::REMOVE_FRAMEWORK_TASKS_PER_DISPATCH + 1;
+
+  vector<TaskInfo> tasks;
+  for (size_t i = 0; i < numTasks; i++) {
+    TaskInfo task;
+    task.set_name("test-task-" + stringify(i));
+    task.mutable_task_id()->set_value(stringify(i));
+    task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+    task.mutable_resources()->MergeFrom(
+        Resources::parse("cpus:0.01;mem:1").get());
+    task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+    tasks.push_back(task);
+  }
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(Return());
+
+  driver.launchTasks(offers.get()[0].id(), tasks);
+
+  // Ensure the master has added all of the framework's tasks.
+  Clock::pause();
+  Clock::settle();
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(
+      static_cast<int>(numTasks),
+      metrics.values["master/tasks_staging"]);
+
+  // Keep the agent from tearing down the framework's executor, so
+  // that the only task transitions the master observes are the ones
+  // made by the removal itself.
+  DROP_PROTOBUFS(ShutdownFrameworkMessage(), _, _);
+
+  // Drop the continuation so that the framework can be observed in
+  // the window between removal chunks.
+  Future<Nothing> removeFrameworkContinuation =
+    DROP_DISPATCH(master.get()->pid, &Master::_removeFramework);
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(removeFrameworkContinuation);
+  Clock::settle();
+
+  // The first chunk of tasks has been removed; the framework remains
+  // registered (but deactivated) with the rest of its tasks.
+  metrics = Metrics();
+  EXPECT_EQ(0, metrics.values["master/frameworks_active"]);
+  EXPECT_EQ(1, metrics.values["master/frameworks_inactive"]);
+  EXPECT_EQ(
+      static_cast<int>(master::REMOVE_FRAMEWORK_TASKS_PER_DISPATCH),
+      metrics.values["master/tasks_killed"]);
+
+  Clock::resume();
+
+  // Re-subscription under the same framework id is refused while the
+  // removal is in progress.
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.mutable_id()->CopyFrom(frameworkId.get());
+
+  MockScheduler sched2;
+  MesosSchedulerDriver driver2(
+      &sched2, frameworkInfo, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<string> error;
+  EXPECT_CALL(sched2, error(&driver2, _))
+    .WillOnce(FutureArg<1>(&error));
+
+  driver2.start();
+
+  AWAIT_READY(error);
+  EXPECT_EQ("Framework is being removed", error.get());
+
+  driver2.stop();
+  driver2.join();
+
+  // Replay the dropped continuation to let the removal complete.
+  Clock::pause();
+
+  process::dispatch(
+      master.get()->pid, &Master::_removeFramework, frameworkId.get());
+
+  Clock::settle();
+
+  metrics = Metrics();
+  EXPECT_EQ(0, metrics.values["master/frameworks_active"]);
+  EXPECT_EQ(0, metrics.values["master/frameworks_inactive"]);
+  EXPECT_EQ(
+      static_cast<int>(numTasks),
+      metrics.values["master/tasks_killed"]);
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+}
+
+
+// This test verifies that the master sheds operator reads beyond
+// `MAX_OUTSTANDING_OPERATOR_READS` with '503 Service Unavailable',
+// and that the budget is released once the outstanding responses
+// complete.
+TEST_F(MasterTest, OperatorReadAdmissionControl)
+{
+  MockAuthorizer authorizer;
+
+  Try<Owned<cluster::Master>> master = StartMaster(&authorizer);
+  ASSERT_SOME(master);
+
+  // Hold every approver request so that the '/state' requests below
+  // remain outstanding until the promise is satisfied. Each '/state'
+  // request collects three approvers (frameworks, tasks, executors);
+  // the count of approver requests therefore tells us when the
+  // master has admitted all of the reads.
+  Promise<Owned<ObjectApprover>> approvers;
+  Promise<Nothing> admitted;
+  size_t approverRequests = 0;
+
+  EXPECT_CALL(authorizer, getObjectApprover(_, _))
+    .WillRepeatedly(DoAll(
+        InvokeWithoutArgs([&approverRequests, &admitted]() {
+          if (++approverRequests ==
+              3 * master::MAX_OUTSTANDING_OPERATOR_READS) {
+            admitted.set(Nothing());
+          }
+        }),
+        Return(approvers.future())));
+
+  vector<Future<Response>> responses;
+  for (size_t i = 0; i < master::MAX_OUTSTANDING_OPERATOR_READS; i++) {
+    responses.push_back(process::http::get(
+        master.get()->pid,
+        "state",
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL)));
+  }
+
+  // Ensure the master has admitted all of the requests; they remain
+  // outstanding while their approvers are pending.
+  AWAIT_READY(admitted.future());
+
+  foreach (const Future<Response>& response, responses) {
+    EXPECT_TRUE(response.isPending());
+  }
+
+  // The budget is exhausted, so an additional read is shed.
+  Future<Response> rejected = process::http::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(ServiceUnavailable().status, rejected);
+
+  Clock::pause();
+
+  // Release the outstanding requests.
+  approvers.set(Owned<ObjectApprover>(new AcceptingObjectApprover()));
+
+  foreach (const Future<Response>& response, responses) {
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  }
+
+  // Process the deferred budget releases, after which reads are
+  // admitted again.
+  Clock::settle();
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Clock::resume();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <stout/check.hpp>
+#include <stout/fs.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/stringify.hpp>
@@ -95,6 +96,7 @@ TEST_F(PathsTest, CreateExecutorDirectory)
       "frameworks",
       frameworkId.value(),
       "executors",
+      paths::getExecutorShard(executorId),
       executorId.value(),
       "runs",
       containerId.value());
@@ -112,6 +114,19 @@ TEST_F(PathsTest, ParseExecutorRunPath)
       executorId,
       containerId);
 
+  // An executor run path laid out by an agent that predates
+  // directory sharding, i.e., without the shard directory.
+  string legacyDir = path::join(
+      rootDir,
+      "slaves",
+      slaveId.value(),
+      "frameworks",
+      frameworkId.value(),
+      "executors",
+      executorId.value(),
+      "runs",
+      containerId.value());
+
   string badDir1 = paths::getExecutorPath(
       "/some/other/root",
       slaveId,
@@ -143,6 +158,14 @@ TEST_F(PathsTest, ParseExecutorRunPath)
   EXPECT_EQ(executorId, path->executorId);
   EXPECT_EQ(containerId, path->containerId);
 
+  path = paths::parseExecutorRunPath(rootDir, legacyDir);
+  ASSERT_SOME(path);
+
+  EXPECT_EQ(slaveId, path->slaveId);
+  EXPECT_EQ(frameworkId, path->frameworkId);
+  EXPECT_EQ(executorId, path->executorId);
+  EXPECT_EQ(containerId, path->containerId);
+
   path = paths::parseExecutorRunPath(rootDir, badDir1);
   ASSERT_ERROR(path);
 
@@ -154,6 +177,50 @@ TEST_F(PathsTest, ParseExecutorRunPath)
 }
 
 
+TEST_F(PathsTest, MigrateExecutorDirectories)
+{
+  // Lay out an executor run the way an agent that predates directory
+  // sharding would, with the executor directly under 'executors'.
+  const string legacyRun = path::join(
+      rootDir,
+      "slaves",
+      slaveId.value(),
+      "frameworks",
+      frameworkId.value(),
+      "executors",
+      executorId.value(),
+      "runs",
+      containerId.value());
+
+  ASSERT_SOME(os::mkdir(legacyRun));
+
+  ASSERT_SOME(::fs::symlink(
+      legacyRun,
+      path::join(Path(legacyRun).dirname(), "latest")));
+
+  ASSERT_SOME(paths::migrateExecutorDirectories(rootDir, slaveId));
+
+  // The run must now be at the sharded location and the 'latest'
+  // symlink must have been re-created to point into it.
+  const string run = paths::getExecutorRunPath(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
+  EXPECT_TRUE(os::exists(run));
+  EXPECT_FALSE(os::exists(Path(legacyRun).dirname()));
+
+  const Result<string> latest = os::realpath(
+      paths::getExecutorLatestRunPath(
+          rootDir, slaveId, frameworkId, executorId));
+
+  ASSERT_SOME(latest);
+  EXPECT_EQ(run, latest.get());
+
+  // A second pass must leave the sharded layout alone.
+  ASSERT_SOME(paths::migrateExecutorDirectories(rootDir, slaveId));
+  EXPECT_TRUE(os::exists(run));
+}
+
+
 TEST_F(PathsTest, Meta)
 {
   EXPECT_EQ(path::join(rootDir, "meta"), paths::getMetaRootDir(rootDir));
@@ -211,12 +278,17 @@ TEST_F(PathsTest, Executor)
               frameworkId),
           "executors");
 
-  EXPECT_EQ(path::join(executorsRoot, executorId.value()),
-            paths::getExecutorPath(rootDir, slaveId, frameworkId, executorId));
+  EXPECT_EQ(
+      path::join(
+          executorsRoot,
+          paths::getExecutorShard(executorId),
+          executorId.value()),
+      paths::getExecutorPath(rootDir, slaveId, frameworkId, executorId));
 
   EXPECT_EQ(
       path::join(
           executorsRoot,
+          paths::getExecutorShard(executorId),
           executorId.value(),
           "runs",
           containerId.value()),
@@ -89,6 +89,7 @@ using mesos::internal::protobuf::maintenance::createUnavailability;
 using mesos::internal::protobuf::maintenance::createWindow;
 
 using testing::_;
+using testing::An;
 using testing::DoAll;
 using testing::Eq;
 using testing::Return;
@@ -265,6 +266,66 @@ TEST_F(RegistrarTest, Admit)
 }
 
 
+// The registrar stores identical resource/attribute blocks only once
+// (see the shape tables in registry.proto); verify that the blocks
+// survive a store/fetch round trip intact.
+TEST_F(RegistrarTest, InternSlaveInfos)
+{
+  SlaveInfo info1 = slave;
+  info1.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:4;mem:1024").get());
+  info1.mutable_attributes()->CopyFrom(
+      Attributes::parse("rack:a;host:x"));
+
+  // Same resource/attribute "shape" as 'info1', different id.
+  SlaveInfo info2 = info1;
+  info2.mutable_id()->set_value("2");
+
+  // A distinct shape.
+  SlaveInfo info3 = slave;
+  info3.mutable_id()->set_value("3");
+  info3.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:32;mem:65536").get());
+
+  {
+    Registrar registrar(flags, state);
+    AWAIT_READY(registrar.recover(master));
+
+    AWAIT_TRUE(registrar.apply(Owned<Operation>(new AdmitSlave(info1))));
+    AWAIT_TRUE(registrar.apply(Owned<Operation>(new AdmitSlave(info2))));
+    AWAIT_TRUE(registrar.apply(Owned<Operation>(new AdmitSlave(info3))));
+  }
+
+  {
+    Registrar registrar(flags, state);
+    Future<Registry> registry = registrar.recover(master);
+    AWAIT_READY(registry);
+
+    ASSERT_EQ(3, registry.get().slaves().slaves().size());
+
+    hashmap<string, SlaveInfo> infos;
+    foreach (const Registry::Slave& slave_, registry.get().slaves().slaves()) {
+      infos[slave_.info().id().value()] = slave_.info();
+    }
+
+    ASSERT_TRUE(infos.contains("1"));
+    ASSERT_TRUE(infos.contains("2"));
+    ASSERT_TRUE(infos.contains("3"));
+
+    EXPECT_EQ(Resources(info1.resources()), Resources(infos["1"].resources()));
+    EXPECT_EQ(Resources(info2.resources()), Resources(infos["2"].resources()));
+    EXPECT_EQ(Resources(info3.resources()), Resources(infos["3"].resources()));
+
+    EXPECT_EQ(
+        Attributes(info1.attributes()), Attributes(infos["1"].attributes()));
+    EXPECT_EQ(
+        Attributes(info2.attributes()), Attributes(infos["2"].attributes()));
+    EXPECT_EQ(
+        Attributes(info3.attributes()), Attributes(infos["3"].attributes()));
+  }
+}
+
+
 TEST_F(RegistrarTest, MarkReachable)
 {
   Registrar registrar(flags, state);
@@ -1074,6 +1135,10 @@ class MockStorage : public Storage
 public:
   MOCK_METHOD1(get, Future<Option<Entry>>(const string&));
   MOCK_METHOD2(set, Future<bool>(const Entry&, const UUID&));
+  MOCK_METHOD1(get, Future<std::vector<Option<Entry>>>(
+      const std::vector<string>&));
+  MOCK_METHOD2(set, Future<bool>(
+      const std::vector<Entry>&, const std::vector<UUID>&));
   MOCK_METHOD1(expunge, Future<bool>(const Entry&));
   MOCK_METHOD0(names, Future<std::set<string>>());
 };
@@ -1087,7 +1152,7 @@ TEST_F(RegistrarTest, FetchTimeout)
   State state(&storage);
 
   Future<Nothing> get;
-  EXPECT_CALL(storage, get(_))
+  EXPECT_CALL(storage, get(An<const string&>()))
     .WillOnce(DoAll(FutureSatisfy(&get),
                     Return(Future<Option<Entry>>())));
 
@@ -1117,11 +1182,11 @@ TEST_F(RegistrarTest, StoreTimeout)
 
   Registrar registrar(flags, &state);
 
-  EXPECT_CALL(storage, get(_))
+  EXPECT_CALL(storage, get(An<const string&>()))
     .WillOnce(Return(None()));
 
   Future<Nothing> set;
-  EXPECT_CALL(storage, set(_, _))
+  EXPECT_CALL(storage, set(An<const Entry&>(), An<const UUID&>()))
     .WillOnce(DoAll(FutureSatisfy(&set),
                     Return(Future<bool>())));
 
@@ -1147,10 +1212,10 @@ TEST_F(RegistrarTest, Abort)
 
   Registrar registrar(flags, &state);
 
-  EXPECT_CALL(storage, get(_))
+  EXPECT_CALL(storage, get(An<const string&>()))
     .WillOnce(Return(None()));
 
-  EXPECT_CALL(storage, set(_, _))
+  EXPECT_CALL(storage, set(An<const Entry&>(), An<const UUID&>()))
     .WillOnce(Return(Future<bool>(true)))              // Recovery.
     .WillOnce(Return(Future<bool>::failed("failure"))) // Failure.
     .WillRepeatedly(Return(Future<bool>(true)));       // Success.
@@ -146,6 +146,43 @@ TEST_F(SlaveStateTest, CheckpointRepeatedProtobufMessages)
 }
 
 
+TEST_F(SlaveStateTest, CheckpointBundle)
+{
+  SlaveID expected;
+  expected.set_value("agent1");
+
+  const string directory = "run";
+  const string file = path::join(directory, "slave.id");
+
+  slave::state::checkpoint(file, expected, directory);
+  slave::state::checkpoint(
+      path::join(directory, "pid"), string("executor@localhost"), directory);
+
+  // The individual checkpoint files remain authoritative.
+  EXPECT_SOME_EQ(expected, ::protobuf::read<SlaveID>(file));
+
+  // Both records can be read back from the bundle.
+  hashmap<string, string> bundle = slave::state::readBundle(directory);
+
+  EXPECT_TRUE(bundle.contains("slave.id"));
+  EXPECT_SOME_EQ(string("executor@localhost"), bundle.get("pid"));
+
+  // A torn record at the end of the bundle (e.g., from an agent that
+  // crashed while appending) does not discard the valid records.
+  const string bundlePath =
+    path::join(directory, slave::paths::CHECKPOINT_BUNDLE_FILE);
+
+  Try<string> data = os::read(bundlePath);
+  ASSERT_SOME(data);
+  ASSERT_SOME(os::write(bundlePath, data.get() + "torn"));
+
+  bundle = slave::state::readBundle(directory);
+
+  EXPECT_TRUE(bundle.contains("slave.id"));
+  EXPECT_SOME_EQ(string("executor@localhost"), bundle.get("pid"));
+}
+
+
 template <typename T>
 class SlaveRecoveryTest : public ContainerizerTest<T>
 {
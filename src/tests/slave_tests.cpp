@@ -3660,7 +3660,15 @@ TEST_F(SlaveTest, ReregisterWithStatusUpdateTaskState)
   // Ensure status update manager handles TASK_FINISHED update.
   AWAIT_READY(___statusUpdate2);
 
-  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+  // The slave re-registers with the same master, so its first
+  // attempt is a delta that carries only a fingerprint of its state.
+  // Keep the slave disconnected by dropping the master's responses
+  // and explicitly ask for its full state, so that we can inspect
+  // the task state a full re-registration carries.
+  DROP_PROTOBUFS(
+      SlaveReregisteredMessage(), master.get()->pid, slave.get()->pid);
+
+  Future<ReregisterSlaveMessage> deltaReregisterSlaveMessage =
     FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
 
   // Drop any updates to the failed over master.
@@ -3670,6 +3678,14 @@ TEST_F(SlaveTest, ReregisterWithStatusUpdateTaskState)
   // so that the slave will do a re-registration.
   detector.appoint(master.get()->pid);
 
+  AWAIT_READY(deltaReregisterSlaveMessage);
+  EXPECT_TRUE(deltaReregisterSlaveMessage.get().has_state_fingerprint());
+
+  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
+
+  post(master.get()->pid, slave.get()->pid, ReregisterSlaveFullStateMessage());
+
   // Capture and inspect the slave reregistration message.
   AWAIT_READY(reregisterSlaveMessage);
 
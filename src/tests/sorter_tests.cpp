@@ -17,6 +17,16 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#ifdef __linux__
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/perf_event.h>
+
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
 #include <iostream>
 #include <string>
 #include <vector>
@@ -45,6 +55,108 @@ namespace mesos {
 namespace internal {
 namespace tests {
 
+#ifdef __linux__
+
+// Counts hardware cache and branch misses for the calling thread
+// between start() and stop() using perf_event_open(2). Self
+// profiling needs no elevated privileges, but the counters may still
+// be unavailable (e.g., in containers or virtual machines without
+// PMU access), in which case the benchmarks simply omit them.
+class PerfCounters
+{
+public:
+  PerfCounters()
+    : cacheMisses(open(PERF_COUNT_HW_CACHE_MISSES)),
+      branchMisses(open(PERF_COUNT_HW_BRANCH_MISSES)) {}
+
+  ~PerfCounters()
+  {
+    if (cacheMisses >= 0) {
+      ::close(cacheMisses);
+    }
+    if (branchMisses >= 0) {
+      ::close(branchMisses);
+    }
+  }
+
+  void start()
+  {
+    reset(cacheMisses);
+    reset(branchMisses);
+  }
+
+  void stop()
+  {
+    disable(cacheMisses);
+    disable(branchMisses);
+  }
+
+  // Prints the counter values gathered between the last start() and
+  // stop() pair.
+  void report()
+  {
+    Option<uint64_t> cache = value(cacheMisses);
+    Option<uint64_t> branch = value(branchMisses);
+
+    if (cache.isSome() && branch.isSome()) {
+      cout << "Hardware counters: " << cache.get() << " cache misses, "
+           << branch.get() << " branch misses" << endl;
+    } else {
+      cout << "Hardware counters unavailable" << endl;
+    }
+  }
+
+private:
+  static int open(uint64_t config)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  static void reset(int fd)
+  {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  static void disable(int fd)
+  {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  static Option<uint64_t> value(int fd)
+  {
+    if (fd < 0) {
+      return None();
+    }
+
+    uint64_t count = 0;
+    if (::read(fd, &count, sizeof(count)) != sizeof(count)) {
+      return None();
+    }
+
+    return count;
+  }
+
+  int cacheMisses;
+  int branchMisses;
+};
+
+#endif // __linux__
+
 
 TEST(SorterTest, DRFSorter)
 {
@@ -635,6 +747,122 @@ TEST_P(Sorter_BENCHMARK_Test, FullSort)
 }
 
 
+class SorterUpdate_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<std::tr1::tuple<size_t, size_t>> {};
+
+
+// The update benchmark tests are parameterized by the number of
+// clients and the number of allocation cycles to drive.
+INSTANTIATE_TEST_CASE_P(
+    ClientAndCycleCount,
+    SorterUpdate_BENCHMARK_Test,
+    ::testing::Combine(
+      ::testing::Values(1000U, 5000U, 10000U),
+      ::testing::Values(100U, 1000U))
+    );
+
+
+// This benchmark mirrors how the allocator drives the sorter in the
+// steady state: skewed client weights, a sort at the top of every
+// allocation cycle, and a burst of allocation updates against the
+// clients that the sort put first. Unlike FullSort above, which is
+// dominated by bulk insertion and removal, this is the update-then-
+// re-sort pattern whose cost gates sorter data structure changes.
+TEST_P(SorterUpdate_BENCHMARK_Test, AllocationCycles)
+{
+  size_t clientCount = std::tr1::get<0>(GetParam());
+  size_t cycleCount = std::tr1::get<1>(GetParam());
+
+  // Number of clients that receive an allocation in each cycle.
+  const size_t allocationsPerCycle = 10;
+
+  cout << "Using " << clientCount << " clients and "
+       << cycleCount << " allocation cycles" << endl;
+
+  DRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("agent");
+
+  // A single large pool so that shares stay well below one no matter
+  // how many allocations the cycles below make.
+  Resources totalResources = Resources::parse(
+      "cpus:10000000;mem:1000000000;disk:1000000000").get();
+
+  sorter.add(slaveId, totalResources);
+
+  // Differently sized seed allocations so that the initial sort
+  // order is non-trivial.
+  vector<Resources> seeds;
+  seeds.reserve(10);
+
+  for (size_t i = 0; i < 10; i++) {
+    seeds.push_back(Resources::parse(
+        "cpus:" + stringify(i + 1) +
+        ";mem:" + stringify(128 * (i + 1))).get());
+  }
+
+  vector<string> clients;
+  clients.reserve(clientCount);
+
+  for (size_t i = 0; i < clientCount; i++) {
+    const string clientId = stringify(i);
+
+    clients.push_back(clientId);
+
+    sorter.add(clientId);
+
+    // Skew the weights: a few heavyweight clients, some mid sized
+    // ones and a long tail of weight one, which is roughly what
+    // production role weight distributions look like.
+    if (i % 100 == 0) {
+      sorter.update(clientId, 10.0);
+    } else if (i % 10 == 0) {
+      sorter.update(clientId, 2.0);
+    }
+
+    sorter.allocated(clientId, slaveId, seeds[i % seeds.size()]);
+  }
+
+  Resources slice = Resources::parse("cpus:0.1;mem:32").get();
+
+#ifdef __linux__
+  PerfCounters counters;
+#endif
+
+  Stopwatch watch;
+
+#ifdef __linux__
+  counters.start();
+#endif
+  watch.start();
+
+  for (size_t cycle = 0; cycle < cycleCount; cycle++) {
+    vector<string> sorted = sorter.sort();
+
+    for (size_t i = 0; i < allocationsPerCycle && i < sorted.size(); i++) {
+      sorter.allocated(sorted[i], slaveId, slice);
+    }
+  }
+
+  watch.stop();
+#ifdef __linux__
+  counters.stop();
+#endif
+
+  cout << cycleCount << " allocation cycles with "
+       << allocationsPerCycle << " updates each took "
+       << watch.elapsed() << " ("
+       << cycleCount * allocationsPerCycle / watch.elapsed().secs()
+       << " updates/sec)" << endl;
+
+#ifdef __linux__
+  counters.report();
+#endif
+}
+
+
 // This test verifies that shared resources are properly accounted for in
 // the DRF sorter.
 TEST(SorterTest, SharedResources)
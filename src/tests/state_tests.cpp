@@ -327,6 +327,93 @@ void Names(State* state)
 }
 
 
+void BulkFetchAndStoreAndFetch(State* state)
+{
+  vector<string> names;
+  names.push_back("slaves1");
+  names.push_back("slaves2");
+
+  Future<vector<Variable<Slaves>>> future1 = state->fetch<Slaves>(names);
+  AWAIT_READY(future1);
+
+  vector<Variable<Slaves>> variables = future1.get();
+  ASSERT_EQ(2u, variables.size());
+
+  Slaves slaves1 = variables[0].get();
+  ASSERT_EQ(0, slaves1.slaves().size());
+  slaves1.add_slaves()->mutable_info()->set_hostname("localhost1");
+  variables[0] = variables[0].mutate(slaves1);
+
+  Slaves slaves2 = variables[1].get();
+  ASSERT_EQ(0, slaves2.slaves().size());
+  slaves2.add_slaves()->mutable_info()->set_hostname("localhost2");
+  variables[1] = variables[1].mutate(slaves2);
+
+  Future<Option<vector<Variable<Slaves>>>> future2 = state->store(variables);
+  AWAIT_READY(future2);
+  ASSERT_SOME(future2.get());
+  ASSERT_EQ(2u, future2.get().get().size());
+
+  future1 = state->fetch<Slaves>(names);
+  AWAIT_READY(future1);
+
+  ASSERT_EQ(2u, future1.get().size());
+  ASSERT_EQ(1, future1.get()[0].get().slaves().size());
+  EXPECT_EQ("localhost1", future1.get()[0].get().slaves(0).info().hostname());
+  ASSERT_EQ(1, future1.get()[1].get().slaves().size());
+  EXPECT_EQ("localhost2", future1.get()[1].get().slaves(0).info().hostname());
+}
+
+
+void BulkFetchAndStoreAndStoreFailAndFetch(State* state)
+{
+  vector<string> names;
+  names.push_back("slaves1");
+  names.push_back("slaves2");
+
+  Future<vector<Variable<Slaves>>> future1 = state->fetch<Slaves>(names);
+  AWAIT_READY(future1);
+
+  vector<Variable<Slaves>> variables = future1.get();
+  ASSERT_EQ(2u, variables.size());
+
+  Slaves slaves1 = variables[0].get();
+  slaves1.add_slaves()->mutable_info()->set_hostname("localhost1");
+  variables[0] = variables[0].mutate(slaves1);
+
+  Future<Option<vector<Variable<Slaves>>>> future2 = state->store(variables);
+  AWAIT_READY(future2);
+  ASSERT_SOME(future2.get());
+
+  vector<Variable<Slaves>> stored = future2.get().get();
+
+  // Now attempt another bulk store where the first variable is fresh
+  // but the second one is stale: nothing should get stored.
+  Slaves slaves2 = stored[0].get();
+  slaves2.add_slaves()->mutable_info()->set_hostname("localhost2");
+
+  Slaves slaves3 = variables[1].get();
+  slaves3.add_slaves()->mutable_info()->set_hostname("localhost3");
+
+  vector<Variable<Slaves>> stale;
+  stale.push_back(stored[0].mutate(slaves2));    // Fresh.
+  stale.push_back(variables[1].mutate(slaves3)); // Stale.
+
+  future2 = state->store(stale);
+  AWAIT_READY(future2);
+  EXPECT_TRUE(future2.get().isNone());
+
+  // Neither of the variables should have been updated.
+  future1 = state->fetch<Slaves>(names);
+  AWAIT_READY(future1);
+
+  ASSERT_EQ(2u, future1.get().size());
+  ASSERT_EQ(1, future1.get()[0].get().slaves().size());
+  EXPECT_EQ("localhost1", future1.get()[0].get().slaves(0).info().hostname());
+  ASSERT_EQ(0, future1.get()[1].get().slaves().size());
+}
+
+
 class InMemoryStateTest : public ::testing::Test
 {
 public:
@@ -370,6 +457,18 @@ TEST_F(InMemoryStateTest, FetchAndStoreAndStoreFailAndFetch)
 }
 
 
+TEST_F(InMemoryStateTest, BulkFetchAndStoreAndFetch)
+{
+  BulkFetchAndStoreAndFetch(state);
+}
+
+
+TEST_F(InMemoryStateTest, BulkFetchAndStoreAndStoreFailAndFetch)
+{
+  BulkFetchAndStoreAndStoreFailAndFetch(state);
+}
+
+
 TEST_F(InMemoryStateTest, FetchAndStoreAndExpungeAndFetch)
 {
   FetchAndStoreAndExpungeAndFetch(state);
@@ -447,6 +546,18 @@ TEST_F(LevelDBStateTest, FetchAndStoreAndStoreFailAndFetch)
 }
 
 
+TEST_F(LevelDBStateTest, BulkFetchAndStoreAndFetch)
+{
+  BulkFetchAndStoreAndFetch(state);
+}
+
+
+TEST_F(LevelDBStateTest, BulkFetchAndStoreAndStoreFailAndFetch)
+{
+  BulkFetchAndStoreAndStoreFailAndFetch(state);
+}
+
+
 TEST_F(LevelDBStateTest, FetchAndStoreAndExpungeAndFetch)
 {
   FetchAndStoreAndExpungeAndFetch(state);
@@ -546,6 +657,18 @@ TEST_F(LogStateTest, FetchAndStoreAndStoreFailAndFetch)
 }
 
 
+TEST_F(LogStateTest, BulkFetchAndStoreAndFetch)
+{
+  BulkFetchAndStoreAndFetch(state);
+}
+
+
+TEST_F(LogStateTest, BulkFetchAndStoreAndStoreFailAndFetch)
+{
+  BulkFetchAndStoreAndStoreFailAndFetch(state);
+}
+
+
 TEST_F(LogStateTest, FetchAndStoreAndExpungeAndFetch)
 {
   FetchAndStoreAndExpungeAndFetch(state);
@@ -570,6 +693,38 @@ TEST_F(LogStateTest, Names)
 }
 
 
+// Tests that a storage created with a standby catch-up interval
+// warms its cache from the locally learned portion of the log and
+// still performs a consistent fetch once its writer gets started.
+TEST_F(LogStateTest, StandbyCatchup)
+{
+  FetchAndStoreAndFetch(state);
+
+  // Simulate a failover: re-open the log and create a storage that
+  // catches up from the local replica while not yet "leading".
+  delete state;
+  delete storage;
+  delete log;
+
+  set<UPID> pids;
+  pids.insert(replica2->pid());
+
+  log = new Log(2, os::getcwd() + "/.log1", pids);
+  storage = new mesos::state::LogStorage(log, 1024, Milliseconds(1));
+  state = new State(storage);
+
+  // Allow the standby catch-up loop to run a few times.
+  os::sleep(Milliseconds(50));
+
+  Future<Variable<Slaves>> future = state->fetch<Slaves>("slaves");
+  AWAIT_READY(future);
+
+  Slaves slaves = future.get().get();
+  ASSERT_EQ(1, slaves.slaves().size());
+  EXPECT_EQ("localhost", slaves.slaves(0).info().hostname());
+}
+
+
 Future<Option<Variable<Slaves>>> timeout(
     Future<Option<Variable<Slaves>>> future)
 {
@@ -740,6 +895,18 @@ TEST_F(ZooKeeperStateTest, FetchAndStoreAndStoreFailAndFetch)
 }
 
 
+TEST_F(ZooKeeperStateTest, BulkFetchAndStoreAndFetch)
+{
+  BulkFetchAndStoreAndFetch(state);
+}
+
+
+TEST_F(ZooKeeperStateTest, BulkFetchAndStoreAndStoreFailAndFetch)
+{
+  BulkFetchAndStoreAndStoreFailAndFetch(state);
+}
+
+
 TEST_F(ZooKeeperStateTest, FetchAndStoreAndExpungeAndFetch)
 {
   FetchAndStoreAndExpungeAndFetch(state);
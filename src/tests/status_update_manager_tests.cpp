@@ -20,6 +20,7 @@
 #include <gmock/gmock.h>
 
 #include <mesos/executor.hpp>
+#include <mesos/resources.hpp>
 #include <mesos/scheduler.hpp>
 
 #include <process/clock.hpp>
@@ -849,6 +850,257 @@ TEST_F(StatusUpdateManagerTest, DuplicatedTerminalStatusUpdate)
   driver.join();
 }
 
+
+// Returns two tasks for the offered agent, so that two status update
+// acknowledgements head to the agent; see the batching tests below.
+static vector<TaskInfo> createTwoTasks(const Offer& offer)
+{
+  vector<TaskInfo> tasks;
+
+  for (int i = 0; i < 2; i++) {
+    TaskInfo task;
+    task.set_name("test-task-" + stringify(i));
+    task.mutable_task_id()->set_value(stringify(i));
+    task.mutable_slave_id()->MergeFrom(offer.slave_id());
+    task.mutable_resources()->MergeFrom(
+        Resources::parse("cpus:0.1;mem:32").get());
+    task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+    tasks.push_back(task);
+  }
+
+  return tasks;
+}
+
+
+// This test verifies that the master coalesces status update
+// acknowledgements that arrive within the batching window into a
+// single `StatusUpdateAcknowledgementsMessage` for an agent that
+// advertised support for it, and only sends them once the window
+// expires.
+TEST_F(StatusUpdateManagerTest, BatchedAcknowledgements)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(_, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  // Pause the clock so that the batching window does not expire
+  // before both acknowledgements have been queued on the master.
+  Clock::pause();
+
+  // The agent advertised support, so no per-update acknowledgements
+  // should be sent to it.
+  EXPECT_NO_FUTURE_PROTOBUFS(
+      StatusUpdateAcknowledgementMessage(),
+      master.get()->pid,
+      slave.get()->pid);
+
+  Future<StatusUpdateAcknowledgementsMessage> acknowledgements =
+    FUTURE_PROTOBUF(
+        StatusUpdateAcknowledgementsMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  driver.launchTasks(offers.get()[0].id(), createTwoTasks(offers.get()[0]));
+
+  AWAIT_READY(status1);
+  AWAIT_READY(status2);
+
+  // Ensure the master has queued both acknowledgements sent by the
+  // scheduler driver.
+  Clock::settle();
+
+  // Nothing heads to the agent until the batching window expires.
+  EXPECT_TRUE(acknowledgements.isPending());
+
+  // NOTE: Expectations are matched newest first, hence the reversed
+  // numbering.
+  Future<Nothing> _statusUpdateAcknowledgement2 =
+    FUTURE_DISPATCH(slave.get()->pid, &Slave::_statusUpdateAcknowledgement);
+
+  Future<Nothing> _statusUpdateAcknowledgement1 =
+    FUTURE_DISPATCH(slave.get()->pid, &Slave::_statusUpdateAcknowledgement);
+
+  Clock::advance(master::STATUS_UPDATE_ACKNOWLEDGEMENT_BATCH_WINDOW);
+
+  AWAIT_READY(acknowledgements);
+  EXPECT_EQ(2, acknowledgements.get().acknowledgements_size());
+
+  // The agent processes both acknowledgements from the batch.
+  AWAIT_READY(_statusUpdateAcknowledgement1);
+  AWAIT_READY(_statusUpdateAcknowledgement2);
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that the master falls back to per-update
+// `StatusUpdateAcknowledgementMessage`s for an agent that did not
+// advertise support for the batched message, as is the case for old
+// agents during a rolling upgrade.
+TEST_F(StatusUpdateManagerTest, AcknowledgementsWithoutAgentCapability)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  // Capture the agent's registration and strip the capability before
+  // forwarding it, masquerading as an agent from before batched
+  // acknowledgements were introduced. The clock is paused so that
+  // the agent does not retry the (dropped) registration, which would
+  // re-advertise the capability.
+  Future<RegisterSlaveMessage> registerSlaveMessage =
+    DROP_PROTOBUF(RegisterSlaveMessage(), _, master.get()->pid);
+
+  Clock::pause();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(registerSlaveMessage);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  RegisterSlaveMessage strippedRegisterSlaveMessage =
+    registerSlaveMessage.get();
+  strippedRegisterSlaveMessage.clear_batched_acknowledgements();
+
+  process::post(
+      slave.get()->pid,
+      master.get()->pid,
+      strippedRegisterSlaveMessage);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Clock::resume();
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(_, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  // Pause the clock so that the batching window does not expire
+  // before both acknowledgements have been queued on the master.
+  Clock::pause();
+
+  // The agent did not advertise support, so it must not be sent the
+  // batched message.
+  EXPECT_NO_FUTURE_PROTOBUFS(
+      StatusUpdateAcknowledgementsMessage(),
+      master.get()->pid,
+      slave.get()->pid);
+
+  // NOTE: Expectations are matched newest first, hence the reversed
+  // numbering.
+  Future<StatusUpdateAcknowledgementMessage> acknowledgement2 =
+    FUTURE_PROTOBUF(
+        StatusUpdateAcknowledgementMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  Future<StatusUpdateAcknowledgementMessage> acknowledgement1 =
+    FUTURE_PROTOBUF(
+        StatusUpdateAcknowledgementMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  driver.launchTasks(offers.get()[0].id(), createTwoTasks(offers.get()[0]));
+
+  AWAIT_READY(status1);
+  AWAIT_READY(status2);
+
+  // Ensure the master has queued both acknowledgements sent by the
+  // scheduler driver.
+  Clock::settle();
+
+  // Nothing heads to the agent until the batching window expires.
+  EXPECT_TRUE(acknowledgement1.isPending());
+  EXPECT_TRUE(acknowledgement2.isPending());
+
+  Clock::advance(master::STATUS_UPDATE_ACKNOWLEDGEMENT_BATCH_WINDOW);
+
+  // The flush sends one message per acknowledgement.
+  AWAIT_READY(acknowledgement1);
+  AWAIT_READY(acknowledgement2);
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -14,19 +14,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifndef __WINDOWS__
-#include <sys/wait.h>
-#endif // __WINDOWS__
+#include <stdio.h>
+
+#include <curl/curl.h>
 
 #include <string>
-#include <tuple>
-#include <vector>
 
 #include <process/check.hpp>
-#include <process/collect.hpp>
-#include <process/io.hpp>
-#include <process/subprocess.hpp>
-
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/net.hpp>
 #include <stout/path.hpp>
 #include <stout/strings.hpp>
 
@@ -35,50 +40,103 @@
 #include "uri/fetchers/curl.hpp"
 
 namespace http = process::http;
-namespace io = process::io;
 
 using std::set;
 using std::string;
-using std::tuple;
-using std::vector;
 
-using process::await;
-using process::subprocess;
+using process::delay;
+using process::dispatch;
+using process::spawn;
+using process::terminate;
+using process::wait;
 
 using process::Failure;
 using process::Future;
 using process::Owned;
-using process::Subprocess;
+using process::Process;
+using process::ProcessBase;
+using process::Promise;
 
 namespace mesos {
 namespace uri {
 
-const char CurlFetcherPlugin::NAME[] = "curl";
+// The interval at which the shared multi handle is driven while
+// transfers are active, when libcurl does not ask for an earlier
+// wakeup. We cannot hand libcurl's socket set to libprocess to
+// watch, so the multi handle is polled off a timer instead; each
+// pass drains all sockets with pending data, so the interval bounds
+// added latency rather than throughput.
+static const Duration CURL_POLL_INTERVAL = Milliseconds(10);
 
 
-Try<Owned<Fetcher::Plugin>> CurlFetcherPlugin::create(const Flags& flags)
+class CurlFetcherPluginProcess : public Process<CurlFetcherPluginProcess>
 {
-  // TODO(jieyu): Make sure curl is available.
+public:
+  CurlFetcherPluginProcess()
+    : ProcessBase(process::ID::generate("curl-fetcher-plugin")),
+      multi(nullptr) {}
+
+  Future<Nothing> fetch(const URI& uri, const string& directory);
+
+protected:
+  virtual void initialize()
+  {
+    // 'curl_global_init' is not thread safe; stout performs it
+    // exactly once.
+    net::initialize();
+
+    multi = CHECK_NOTNULL(curl_multi_init());
+
+    // All transfers run on this one multi handle so that they share
+    // its connection pool. Where the libcurl in use supports it,
+    // concurrent transfers to the same host (e.g., registry blob
+    // fetches during an image pull) are multiplexed over a single
+    // HTTP/2 connection instead of each opening their own.
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x071e00 // 7.30.0.
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, 8L);
+#endif
+  }
 
-  return Owned<Fetcher::Plugin>(new CurlFetcherPlugin());
-}
+  virtual void finalize()
+  {
+    foreachvalue (const Owned<Transfer>& transfer, transfers) {
+      transfer->promise.fail("The curl fetcher is terminating");
 
+      curl_multi_remove_handle(multi, transfer->easy);
+      curl_easy_cleanup(transfer->easy);
+      fclose(transfer->file);
+    }
 
-set<string> CurlFetcherPlugin::schemes() const
-{
-  return {"http", "https", "ftp", "ftps"};
-}
+    transfers.clear();
+
+    curl_multi_cleanup(multi);
+  }
 
+private:
+  struct Transfer
+  {
+    CURL* easy;
+    FILE* file;
+    string output;
+    char error[CURL_ERROR_SIZE];
+    Promise<Nothing> promise;
+  };
 
-string CurlFetcherPlugin::name() const
-{
-  return NAME;
-}
+  void perform();
 
+  CURLM* multi;
 
-Future<Nothing> CurlFetcherPlugin::fetch(
+  hashmap<CURL*, Owned<Transfer>> transfers;
+};
+
+
+Future<Nothing> CurlFetcherPluginProcess::fetch(
     const URI& uri,
-    const string& directory) const
+    const string& directory)
 {
   // TODO(jieyu): Validate the given URI.
 
@@ -96,78 +154,177 @@ Future<Nothing> CurlFetcherPlugin::fetch(
   // TODO(jieyu): Allow user to specify the name of the output file.
   const string output = path::join(directory, Path(uri.path()).basename());
 
-  const vector<string> argv = {
-    "curl",
-    "-s",                 // Don't show progress meter or error messages.
-    "-S",                 // Makes curl show an error message if it fails.
-    "-L",                 // Follow HTTP 3xx redirects.
-    "-w", "%{http_code}", // Display HTTP response code on stdout.
-    "-o", output,         // Write output to the file.
-    strings::trim(stringify(uri))
-  };
+  Owned<Transfer> transfer(new Transfer());
+  transfer->output = output;
+  transfer->error[0] = '\0';
 
-  Try<Subprocess> s = subprocess(
-      "curl",
-      argv,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE());
+  transfer->file = fopen(output.c_str(), "w");
+  if (transfer->file == nullptr) {
+    return Failure(ErrnoError("Failed to open '" + output + "'").message);
+  }
+
+  CURL* easy = curl_easy_init();
+  if (easy == nullptr) {
+    fclose(transfer->file);
+    return Failure("Failed to initialize libcurl");
+  }
+
+  curl_easy_setopt(easy, CURLOPT_URL, strings::trim(stringify(uri)).c_str());
+  curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, nullptr);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer->file);
+  curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->error);
+
+#if LIBCURL_VERSION_NUM >= 0x072f00 // 7.47.0.
+  // Negotiate HTTP/2 over TLS where the server supports it; this is
+  // what allows the multi handle to multiplex transfers to the same
+  // host over one connection.
+  curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
+
+  transfer->easy = easy;
+
+  CURLMcode code = curl_multi_add_handle(multi, easy);
+  if (code != CURLM_OK) {
+    curl_easy_cleanup(easy);
+    fclose(transfer->file);
+    return Failure(
+        "Failed to add the transfer to the curl multi handle: " +
+        string(curl_multi_strerror(code)));
+  }
+
+  transfers[easy] = transfer;
+
+  // Start driving the multi handle if it was idle. While transfers
+  // are active a 'perform' pass is always scheduled, so an added
+  // transfer is picked up by the pending pass.
+  if (transfers.size() == 1) {
+    dispatch(self(), &CurlFetcherPluginProcess::perform);
+  }
+
+  return transfer->promise.future();
+}
 
-  if (s.isError()) {
-    return Failure("Failed to exec the curl subprocess: " + s.error());
+
+void CurlFetcherPluginProcess::perform()
+{
+  if (transfers.empty()) {
+    return;
   }
 
-  return await(
-      s.get().status(),
-      io::read(s.get().out().get()),
-      io::read(s.get().err().get()))
-    .then([](const tuple<
-        Future<Option<int>>,
-        Future<string>,
-        Future<string>>& t) -> Future<Nothing> {
-      Future<Option<int>> status = std::get<0>(t);
-      if (!status.isReady()) {
-        return Failure(
-            "Failed to get the exit status of the curl subprocess: " +
-            (status.isFailed() ? status.failure() : "discarded"));
-      }
-
-      if (status->isNone()) {
-        return Failure("Failed to reap the curl subprocess");
-      }
-
-      if (status->get() != 0) {
-        Future<string> error = std::get<2>(t);
-        if (!error.isReady()) {
-          return Failure(
-              "Failed to perform 'curl'. Reading stderr failed: " +
-              (error.isFailed() ? error.failure() : "discarded"));
-        }
-
-        return Failure("Failed to perform 'curl': " + error.get());
-      }
-
-      Future<string> output = std::get<1>(t);
-      if (!output.isReady()) {
-        return Failure(
-            "Failed to read stdout from 'curl': " +
-            (output.isFailed() ? output.failure() : "discarded"));
-      }
-
-      // Parse the output and get the HTTP response code.
-      Try<int> code = numify<int>(output.get());
-      if (code.isError()) {
-        return Failure("Unexpected output from 'curl': " + output.get());
-      }
-
-      if (code.get() != http::Status::OK) {
-        return Failure(
-            "Unexpected HTTP response code: " +
-            http::Status::string(code.get()));
-      }
-
-      return Nothing();
-    });
+  int running = 0;
+  curl_multi_perform(multi, &running);
+
+  // Reap the completed transfers.
+  int pending = 0;
+  while (CURLMsg* message = curl_multi_info_read(multi, &pending)) {
+    if (message->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    CURL* easy = message->easy_handle;
+    const CURLcode result = message->data.result;
+
+    CHECK(transfers.contains(easy));
+
+    Owned<Transfer> transfer = transfers.at(easy);
+    transfers.erase(easy);
+
+    long code = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+
+    curl_multi_remove_handle(multi, easy);
+    curl_easy_cleanup(easy);
+
+    if (fclose(transfer->file) != 0) {
+      transfer->promise.fail(
+          ErrnoError("Failed to close '" + transfer->output + "'").message);
+      continue;
+    }
+
+    if (result != CURLE_OK) {
+      transfer->promise.fail(
+          "Failed to perform 'curl': " +
+          (transfer->error[0] != '\0'
+             ? string(transfer->error)
+             : string(curl_easy_strerror(result))));
+      continue;
+    }
+
+    if (code != http::Status::OK) {
+      transfer->promise.fail(
+          "Unexpected HTTP response code: " + http::Status::string(code));
+      continue;
+    }
+
+    transfer->promise.set(Nothing());
+  }
+
+  if (transfers.empty()) {
+    return;
+  }
+
+  // Schedule the next pass when libcurl wants to be called again,
+  // bounded by the poll interval so socket activity is picked up
+  // promptly.
+  long timeout = -1;
+  curl_multi_timeout(multi, &timeout);
+
+  if (timeout < 0 || Milliseconds(timeout) > CURL_POLL_INTERVAL) {
+    delay(CURL_POLL_INTERVAL, self(), &CurlFetcherPluginProcess::perform);
+  } else {
+    delay(Milliseconds(timeout), self(), &CurlFetcherPluginProcess::perform);
+  }
+}
+
+
+const char CurlFetcherPlugin::NAME[] = "curl";
+
+
+Try<Owned<Fetcher::Plugin>> CurlFetcherPlugin::create(const Flags& flags)
+{
+  Owned<CurlFetcherPluginProcess> process(new CurlFetcherPluginProcess());
+
+  return Owned<Fetcher::Plugin>(new CurlFetcherPlugin(process));
+}
+
+
+CurlFetcherPlugin::CurlFetcherPlugin(
+    Owned<CurlFetcherPluginProcess> _process)
+  : process(_process)
+{
+  spawn(CHECK_NOTNULL(process.get()));
+}
+
+
+CurlFetcherPlugin::~CurlFetcherPlugin()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+set<string> CurlFetcherPlugin::schemes() const
+{
+  return {"http", "https", "ftp", "ftps"};
+}
+
+
+string CurlFetcherPlugin::name() const
+{
+  return NAME;
+}
+
+
+Future<Nothing> CurlFetcherPlugin::fetch(
+    const URI& uri,
+    const string& directory) const
+{
+  return dispatch(
+      process.get(),
+      &CurlFetcherPluginProcess::fetch,
+      uri,
+      directory);
 }
 
 } // namespace uri {
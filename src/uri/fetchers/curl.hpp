@@ -27,6 +27,10 @@
 namespace mesos {
 namespace uri {
 
+// Forward declarations.
+class CurlFetcherPluginProcess;
+
+
 class CurlFetcherPlugin : public Fetcher::Plugin
 {
 public:
@@ -36,7 +40,7 @@ public:
 
   static Try<process::Owned<Fetcher::Plugin>> create(const Flags& flags);
 
-  virtual ~CurlFetcherPlugin() {}
+  virtual ~CurlFetcherPlugin();
 
   virtual std::set<std::string> schemes() const;
 
@@ -47,7 +51,10 @@ public:
       const std::string& directory) const;
 
 private:
-  CurlFetcherPlugin() {}
+  explicit CurlFetcherPlugin(
+      process::Owned<CurlFetcherPluginProcess> _process);
+
+  process::Owned<CurlFetcherPluginProcess> process;
 };
 
 } // namespace uri {
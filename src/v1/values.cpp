@@ -322,82 +322,41 @@ ostream& operator<<(ostream& stream, const Value::Ranges& ranges)
 
 bool operator==(const Value::Ranges& _left, const Value::Ranges& _right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  if (left.range_size() == right.range_size()) {
-    for (int i = 0; i < left.range_size(); i++) {
-      // Make sure this range is equal to a range in the right.
-      bool found = false;
-      for (int j = 0; j < right.range_size(); j++) {
-        if (left.range(i).begin() == right.range(j).begin() &&
-            left.range(i).end() == right.range(j).end()) {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
-  return false;
+  // IntervalSet is canonical (coalesced and ordered), so set equality
+  // captures range equality without the nested scan over subranges.
+  return rangesToIntervalSet(_left) == rangesToIntervalSet(_right);
 }
 
 
 bool operator<=(const Value::Ranges& _left, const Value::Ranges& _right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  for (int i = 0; i < left.range_size(); i++) {
-    // Make sure this range is a subset of a range in right.
-    bool matched = false;
-    for (int j = 0; j < right.range_size(); j++) {
-      if (left.range(i).begin() >= right.range(j).begin() &&
-          left.range(i).end() <= right.range(j).end()) {
-        matched = true;
-        break;
-      }
-    }
-    if (!matched) {
-      return false;
-    }
-  }
-
-  return true;
+  return rangesToIntervalSet(_right).contains(rangesToIntervalSet(_left));
 }
 
 
 Value::Ranges operator+(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
-  coalesce(&result, {left, right});
-  return result;
+  IntervalSet<uint64_t> set = rangesToIntervalSet(left);
+  set += rangesToIntervalSet(right);
+  return intervalSetToRanges(set);
 }
 
 
 Value::Ranges operator-(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges result;
-  coalesce(&result, {left});
-  return result -= right;
+  IntervalSet<uint64_t> set = rangesToIntervalSet(left);
+  set -= rangesToIntervalSet(right);
+  return intervalSetToRanges(set);
 }
 
 
 Value::Ranges& operator+=(Value::Ranges& left, const Value::Ranges& right)
 {
-  coalesce(&left, {right});
+  // IntervalSet merges each added interval in place in O(log n),
+  // which avoids re-coalescing the combined range list from scratch.
+  IntervalSet<uint64_t> set = rangesToIntervalSet(left);
+  set += rangesToIntervalSet(right);
+  left = intervalSetToRanges(set);
   return left;
 }
 
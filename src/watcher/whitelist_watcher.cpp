@@ -86,19 +86,41 @@ void WhitelistWatcher::initialize()
 
 void WhitelistWatcher::watch()
 {
+  CHECK_SOME(path);
+
+  // Skip re-reading (and re-parsing) the whitelist if the file has
+  // not changed since it was last read; with a large whitelist the
+  // periodic parse and set comparison below are needlessly expensive.
+  //
+  // NOTE: The modification time has second granularity, so we
+  // additionally compare the size to better detect multiple writes
+  // within the same second; a change that alters neither is only
+  // picked up together with the change that follows it.
+  Try<long> mtime = os::stat::mtime(path.get().string());
+  Try<Bytes> size = os::stat::size(path.get().string());
+
+  if (mtime.isSome() && size.isSome() &&
+      lastMtime == mtime.get() && lastSize == size.get()) {
+    delay(watchInterval, self(), &WhitelistWatcher::watch);
+    return;
+  }
+
   // Read the list of white listed nodes from local file.
   // TODO(vinod): Add support for reading from ZooKeeper.
   // TODO(vinod): Ensure this read is atomic w.r.t external
   // writes/updates to this file.
   Option<hashset<string>> whitelist;
 
-  CHECK_SOME(path);
   Try<string> read = os::read(path.get().string());
 
   if (read.isError()) {
     LOG(ERROR) << "Error reading whitelist file: " << read.error() << ". "
                << "Retrying";
     whitelist = lastWhitelist;
+
+    // Force a re-read on the next check.
+    lastMtime = None();
+    lastSize = None();
   } else if (read.get().empty()) {
     VLOG(1) << "Empty whitelist file " << path.get().string();
     whitelist = hashset<string>();
@@ -111,6 +133,14 @@ void WhitelistWatcher::watch()
     whitelist = hostnames;
   }
 
+  if (read.isSome()) {
+    // NOTE: We record the values statted before the read; if the
+    // file changed in between, they will not match the next stat
+    // and the file is simply read again.
+    lastMtime = mtime.isSome() ? Option<long>(mtime.get()) : Option<long>();
+    lastSize = size.isSome() ? Option<Bytes>(size.get()) : Option<Bytes>();
+  }
+
   // Send the whitelist to subscriber, if necessary.
   if (whitelist != lastWhitelist) {
     subscriber(whitelist);
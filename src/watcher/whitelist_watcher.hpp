@@ -21,6 +21,7 @@
 
 #include <process/process.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
@@ -67,6 +68,12 @@ private:
   lambda::function<void(const Option<hashset<std::string>>& whitelist)>
     subscriber;
   Option<hashset<std::string>> lastWhitelist;
+
+  // Modification time and size of the whitelist file when it was
+  // last read, used to skip re-reading (and re-parsing) the file
+  // when it has not changed.
+  Option<long> lastMtime;
+  Option<Bytes> lastSize;
 };
 
 } // namespace internal {
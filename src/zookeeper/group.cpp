@@ -101,7 +101,8 @@ GroupProcess::GroupProcess(
     watcher(nullptr),
     zk(nullptr),
     state(DISCONNECTED),
-    retrying(false)
+    retrying(false),
+    dirty(false)
 {}
 
 
@@ -530,8 +531,11 @@ void GroupProcess::expired(int64_t sessionId)
   update();
 
   // Invalidate the cache so that we'll sync with ZK after
-  // reconnection.
+  // reconnection. The membership data cache is dropped as well since
+  // sequence numbers are only unique within a single incarnation of
+  // the group znode.
   memberships = None();
+  dataCache.clear();
 
   // Set all owned memberships as cancelled.
   foreachpair (int32_t sequence, Promise<bool>* cancelled, utils::copy(owned)) {
@@ -563,6 +567,32 @@ void GroupProcess::updated(int64_t sessionId, const string& path)
 
   CHECK_EQ(znode, path);
 
+  // Re-cache via a dispatch so that any further watch events already
+  // queued behind this one find 'dirty' set and piggyback on the
+  // pending re-cache, rather than each issuing its own read against
+  // ZooKeeper.
+  if (!dirty) {
+    dirty = true;
+    dispatch(self(), &GroupProcess::recache);
+  }
+}
+
+
+void GroupProcess::recache()
+{
+  if (error.isSome() || !dirty) {
+    return;
+  }
+
+  dirty = false;
+
+  if (state != READY) {
+    // The session expired between the watch event and this dispatch;
+    // the memberships will be re-cached by sync() once the group is
+    // ready again.
+    return;
+  }
+
   Try<bool> cached = cache(); // Update cache (will invalidate first).
 
   if (cached.isError()) {
@@ -638,6 +668,10 @@ Result<Group::Membership> GroupProcess::doJoin(
   Promise<bool>* cancelled = new Promise<bool>();
   owned[sequence.get()] = cancelled;
 
+  // We already know the data this member was created with, so there
+  // is no need to read it back from ZooKeeper.
+  dataCache[sequence.get()] = data;
+
   return Group::Membership(sequence.get(), label, cancelled->future());
 }
 
@@ -689,6 +723,14 @@ Result<Option<string>> GroupProcess::doData(
 {
   CHECK_EQ(state, READY);
 
+  // A member's znode data is written once when it joins and never
+  // modified, so repeated reads (e.g., by clients that re-fetch
+  // every member's data on each membership change) are served from
+  // the cache without a round trip to ZooKeeper.
+  if (dataCache.count(membership.id()) > 0) {
+    return Some(dataCache[membership.id()]);
+  }
+
   string path = path::join(
       znode,
       zkBasename(membership),
@@ -712,6 +754,8 @@ Result<Option<string>> GroupProcess::doData(
         "' in ZooKeeper: " + zk->message(code));
   }
 
+  dataCache[membership.id()] = result;
+
   return Some(result);
 }
 
@@ -760,6 +804,15 @@ Try<bool> GroupProcess::cache()
     sequences[sequence.get()] = label;
   }
 
+  // Evict cached data for memberships that are no longer present.
+  // The data of a live member never changes, so entries for
+  // sequences that are still present remain valid.
+  foreachkey (int32_t sequence, utils::copy(dataCache)) {
+    if (!sequences.contains(sequence)) {
+      dataCache.erase(sequence); // Okay since iterating over a copy.
+    }
+  }
+
   // Cache current memberships, cancelling those that are now missing.
   set<Group::Membership> current;
 
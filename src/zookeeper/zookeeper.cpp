@@ -405,7 +405,97 @@ public:
     return future;
   }
 
+  Future<int> multi(const vector<ZooKeeper::Op>& ops)
+  {
+    CHECK(!ops.empty());
+
+    Promise<int>* promise = new Promise<int>();
+
+    Future<int> future = promise->future();
+
+    // The C API requires that the paths and data of the operations
+    // stay valid until the completion has been invoked, so we bundle
+    // a copy of the operations with the promise.
+    MultiCall* call = new MultiCall(ops);
+
+    for (size_t i = 0; i < call->ops.size(); i++) {
+      const ZooKeeper::Op& op = call->ops[i];
+
+      switch (op.type) {
+        case ZooKeeper::Op::CREATE: {
+          zoo_create_op_init(
+              &call->zops[i],
+              op.path.c_str(),
+              op.data.data(),
+              op.data.size(),
+              op.acl,
+              op.flags,
+              nullptr,
+              0);
+          break;
+        }
+
+        case ZooKeeper::Op::REMOVE: {
+          zoo_delete_op_init(&call->zops[i], op.path.c_str(), op.version);
+          break;
+        }
+
+        case ZooKeeper::Op::SET: {
+          zoo_set_op_init(
+              &call->zops[i],
+              op.path.c_str(),
+              op.data.data(),
+              op.data.size(),
+              op.version,
+              nullptr);
+          break;
+        }
+      }
+    }
+
+    tuple<Promise<int>*, MultiCall*>* args =
+      new tuple<Promise<int>*, MultiCall*>(promise, call);
+
+    int ret = zoo_amulti(
+        zh,
+        call->ops.size(),
+        call->zops,
+        call->results,
+        multiCompletion,
+        args);
+
+    if (ret != ZOK) {
+      delete promise;
+      delete call;
+      delete args;
+      return ret;
+    }
+
+    return future;
+  }
+
 private:
+  // Holds the operations of a pending 'multi' as well as the arrays
+  // handed to the C API, which must stay valid until the completion
+  // has been invoked.
+  struct MultiCall
+  {
+    explicit MultiCall(const vector<ZooKeeper::Op>& _ops)
+      : ops(_ops),
+        zops(new zoo_op_t[ops.size()]),
+        results(new zoo_op_result_t[ops.size()]) {}
+
+    ~MultiCall()
+    {
+      delete[] zops;
+      delete[] results;
+    }
+
+    const vector<ZooKeeper::Op> ops;
+    zoo_op_t* zops;
+    zoo_op_result_t* results;
+  };
+
   // This method is registered as a watcher callback function and is
   // invoked by a single ZooKeeper event thread.
   static void event(
@@ -505,6 +595,21 @@ private:
     delete args;
   }
 
+  static void multiCompletion(int ret, const void* data)
+  {
+    const tuple<Promise<int>*, MultiCall*>* args =
+      reinterpret_cast<const tuple<Promise<int>*, MultiCall*>*>(data);
+
+    Promise<int>* promise = std::get<0>(*args);
+    MultiCall* call = std::get<1>(*args);
+
+    promise->set(ret);
+
+    delete promise;
+    delete call;
+    delete args;
+  }
+
   static void stringsCompletion(
       int ret,
       const String_vector* values,
@@ -639,6 +744,46 @@ int ZooKeeper::get(const string& path, bool watch, string* result, Stat* stat)
 }
 
 
+vector<int> ZooKeeper::get(
+    const vector<string>& paths,
+    bool watch,
+    vector<string>* results,
+    vector<Stat>* stats)
+{
+  CHECK_NOTNULL(results)->resize(paths.size());
+
+  if (stats != nullptr) {
+    stats->resize(paths.size());
+  }
+
+  // Issue all of the reads before waiting on any of them. Note that
+  // the result (and stat) pointers passed to the asynchronous calls
+  // remain valid since the vectors have been sized above and are not
+  // resized until every completion has run.
+  vector<Future<int>> futures;
+  futures.reserve(paths.size());
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    futures.push_back(dispatch(
+        process,
+        &ZooKeeperProcess::get,
+        paths[i],
+        watch,
+        &(*results)[i],
+        stats == nullptr ? nullptr : &(*stats)[i]));
+  }
+
+  vector<int> codes;
+  codes.reserve(paths.size());
+
+  foreach (const Future<int>& future, futures) {
+    codes.push_back(future.get());
+  }
+
+  return codes;
+}
+
+
 int ZooKeeper::getChildren(
     const string& path,
     bool watch,
@@ -664,6 +809,58 @@ int ZooKeeper::set(const string& path, const string& data, int version)
 }
 
 
+int ZooKeeper::multi(const vector<Op>& ops)
+{
+  return dispatch(process, &ZooKeeperProcess::multi, ops).get();
+}
+
+
+ZooKeeper::Op ZooKeeper::Op::create(
+    const string& path,
+    const string& data,
+    const ACL_vector& acl,
+    int flags)
+{
+  Op op;
+  op.type = CREATE;
+  op.path = path;
+  op.data = data;
+  op.acl = &acl;
+  op.flags = flags;
+  op.version = -1;
+  return op;
+}
+
+
+ZooKeeper::Op ZooKeeper::Op::remove(const string& path, int version)
+{
+  Op op;
+  op.type = REMOVE;
+  op.path = path;
+  op.data = "";
+  op.acl = nullptr;
+  op.flags = 0;
+  op.version = version;
+  return op;
+}
+
+
+ZooKeeper::Op ZooKeeper::Op::set(
+    const string& path,
+    const string& data,
+    int version)
+{
+  Op op;
+  op.type = SET;
+  op.path = path;
+  op.data = data;
+  op.acl = nullptr;
+  op.flags = 0;
+  op.version = version;
+  return op;
+}
+
+
 string ZooKeeper::message(int code) const
 {
   return string(zerror(code));